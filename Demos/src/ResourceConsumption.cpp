@@ -117,9 +117,9 @@ int main(int argc, char* argv[])
     databaseParameter.SetAreaAreaIndexCacheSize(0);
     databaseParameter.SetAreaNodeIndexCacheSize(0);
 
-    databaseParameter.SetNodeCacheSize(0);
-    databaseParameter.SetWayCacheSize(0);
-    databaseParameter.SetAreaCacheSize(0);
+    databaseParameter.SetNodeCacheSizeBytes(0);
+    databaseParameter.SetWayCacheSizeBytes(0);
+    databaseParameter.SetAreaCacheSizeBytes(0);
 
     osmscout::Database database(databaseParameter);
 
@@ -413,6 +413,10 @@ int main(int argc, char* argv[])
   size_t                                    targetNodeIndex;
 
   bool                                      outputGPX = false;
+  osmscout::OpenListType                    openListType=osmscout::openListHeap;
+  bool                                      useCH=false;
+  bool                                      bidirectional=false;
+  bool                                      useRouteGraph=false;
 
   int currentArg=1;
   while (currentArg<argc) {
@@ -433,6 +437,22 @@ int main(int argc, char* argv[])
       outputGPX=true;
       currentArg++;
     }
+    else if (strcmp(argv[currentArg],"--radixheap")==0) {
+      openListType=osmscout::openListRadixHeap;
+      currentArg++;
+    }
+    else if (strcmp(argv[currentArg],"--ch")==0) {
+      useCH=true;
+      currentArg++;
+    }
+    else if (strcmp(argv[currentArg],"--bidirectional")==0) {
+      bidirectional=true;
+      currentArg++;
+    }
+    else if (strcmp(argv[currentArg],"--graph")==0) {
+      useRouteGraph=true;
+      currentArg++;
+    }
     else {
       // No more "special" arguments
       break;
@@ -502,6 +522,9 @@ int main(int argc, char* argv[])
     routerParameter.SetDebugPerformance(true);
   }
 
+  routerParameter.SetOpenListType(openListType);
+  routerParameter.SetUseRouteGraph(useRouteGraph);
+
   osmscout::Router          router(routerParameter,
                                    vehicle);
 
@@ -571,12 +594,34 @@ int main(int argc, char* argv[])
     std::cerr << "Cannot find start node for target location!" << std::endl;
   }
 
-  if (!router.CalculateRoute(routingProfile,
-                             startObject,
-                             startNodeIndex,
-                             targetObject,
-                             targetNodeIndex,
-                             data)) {
+  bool success;
+
+  if (useCH) {
+    success=router.CalculateRouteCH(routingProfile,
+                                    startObject,
+                                    startNodeIndex,
+                                    targetObject,
+                                    targetNodeIndex,
+                                    data);
+  }
+  else if (bidirectional) {
+    success=router.CalculateRouteBidirectional(routingProfile,
+                                               startObject,
+                                               startNodeIndex,
+                                               targetObject,
+                                               targetNodeIndex,
+                                               data);
+  }
+  else {
+    success=router.CalculateRoute(routingProfile,
+                                  startObject,
+                                  startNodeIndex,
+                                  targetObject,
+                                  targetNodeIndex,
+                                  data);
+  }
+
+  if (!success) {
     std::cerr << "There was an error while calculating the route!" << std::endl;
     router.Close();
     return 1;
@@ -17,13 +17,16 @@
   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 */
 
+#include <cstring>
 #include <iostream>
 #include <iomanip>
 #include <limits>
+#include <vector>
 
 #include <osmscout/Database.h>
 #include <osmscout/MapPainterAgg.h>
 #include <osmscout/StyleConfigLoader.h>
+#include <osmscout/TileRenderer.h>
 
 #include <osmscout/util/StopClock.h>
 
@@ -31,37 +34,9 @@
   Example for the nordrhein-westfalen.osm (to be executed in the Demos top
   level directory), drawing the "Ruhrgebiet":
 
-  src/Tiler ../TravelJinni/ ../TravelJinni/standard.oss 51.2 6.5 51.7 8 10 13
+  src/Tiler --threads 4 ../TravelJinni/ ../TravelJinni/standard.oss 51.2 6.5 51.7 8 10 13
 */
 
-static unsigned long tileWidth=256;
-static unsigned long tileHeight=256;
-
-// See http://wiki.openstreetmap.org/wiki/Slippy_map_tilenames for details about
-// coordinate transformation
-
-size_t long2tilex(double lon, double z)
-{
-  return (size_t)(floor((lon + 180.0) / 360.0 *pow(2.0,z)));
-}
-
-size_t lat2tiley(double lat, double z)
-{
-  return (size_t)(floor((1.0 - log( tan(lat * M_PI/180.0) + 1.0 / cos(lat * M_PI/180.0)) / M_PI) / 2.0 * pow(2.0,z)));
-}
-
-double tilex2long(int x, double z)
-{
-  return x / pow(2.0,z) * 360.0 - 180;
-}
-
-double tiley2lat(int y, double z)
-{
-  double n = M_PI - 2.0 * M_PI * y / pow(2.0,z);
-
-  return 180.0 / M_PI * atan(0.5 * (exp(n) - exp(-n)));
-}
-
 bool write_ppm(const agg::rendering_buffer& buffer,
                const char* file_name)
 {
@@ -84,17 +59,131 @@ bool write_ppm(const agg::rendering_buffer& buffer,
   return false;
 }
 
+/**
+  Draws meta tiles using the agg backend and writes the tiles as PPM files.
+  */
+class TileWorkerAgg : public osmscout::TileRenderer::Worker
+{
+private:
+  osmscout::MapPainterAgg    painter;
+  std::vector<unsigned char> buffer;
+  size_t                     width;
+  size_t                     height;
+
+public:
+  TileWorkerAgg()
+  : width(0),
+    height(0)
+  {
+    // no code
+  }
+
+  bool DrawMetaTile(const osmscout::StyleConfig& styleConfig,
+                    const osmscout::Projection& projection,
+                    const osmscout::MapParameter& parameter,
+                    const osmscout::MapData& data,
+                    size_t width,
+                    size_t height)
+  {
+    this->width=width;
+    this->height=height;
+
+    buffer.resize(width*height*3);
+    memset(&buffer[0],0,buffer.size());
+
+    agg::rendering_buffer rbuf(&buffer[0],
+                               width,
+                               height,
+                               width*3);
+    agg::pixfmt_rgb24     pf(rbuf);
+
+    return painter.DrawMap(styleConfig,
+                           projection,
+                           parameter,
+                           data,
+                           &pf);
+  }
+
+  bool WriteTile(size_t zoom,
+                 size_t x,
+                 size_t y,
+                 size_t pixelX,
+                 size_t pixelY,
+                 size_t width,
+                 size_t height)
+  {
+    agg::rendering_buffer rbuf(&buffer[0]+pixelY*this->width*3+pixelX*3,
+                               width,
+                               height,
+                               this->width*3);
+
+    std::string output=osmscout::NumberToString(zoom)+"_"+osmscout::NumberToString(x)+"_"+osmscout::NumberToString(y)+".ppm";
+
+    return write_ppm(rbuf,output.c_str());
+  }
+};
+
+class TileRendererAgg : public osmscout::TileRenderer
+{
+protected:
+  Worker* CreateWorker()
+  {
+    return new TileWorkerAgg();
+  }
+
+public:
+  TileRendererAgg(const osmscout::Database& database,
+                  const osmscout::StyleConfig& styleConfig)
+  : TileRenderer(database,styleConfig)
+  {
+    // no code
+  }
+};
+
 int main(int argc, char* argv[])
 {
   std::string   map;
   std::string   style;
   double        latTop,latBottom,lonLeft,lonRight;
-  unsigned long xTileStart,xTileEnd,xTileCount,yTileStart,yTileEnd,yTileCount;
   unsigned long startZoom;
   unsigned long endZoom;
+  unsigned long threadCount=1;
+  unsigned long metaTileSize=8;
+  bool          singleTiles=false;
+
+  int currentArg=1;
+  while (currentArg<argc) {
+    if (strcmp(argv[currentArg],"--threads")==0 &&
+        currentArg+1<argc) {
+      if (sscanf(argv[currentArg+1],"%lu",&threadCount)!=1) {
+        std::cerr << "thread count is not numeric!" << std::endl;
+        return 1;
+      }
+
+      currentArg+=2;
+    }
+    else if (strcmp(argv[currentArg],"--metatile")==0 &&
+             currentArg+1<argc) {
+      if (sscanf(argv[currentArg+1],"%lu",&metaTileSize)!=1) {
+        std::cerr << "meta tile size is not numeric!" << std::endl;
+        return 1;
+      }
+
+      currentArg+=2;
+    }
+    else if (strcmp(argv[currentArg],"--singletiles")==0) {
+      singleTiles=true;
 
-  if (argc!=9) {
-    std::cerr << "DrawMap ";
+      currentArg++;
+    }
+    else {
+      // No more "special" arguments
+      break;
+    }
+  }
+
+  if (argc-currentArg!=8) {
+    std::cerr << "Tiler [--threads <count>] [--metatile <size>] [--singletiles] ";
     std::cerr << "<map directory> <style-file> ";
     std::cerr << "<lat_top> <lon_left> <lat_bottom> <lon_right> ";
     std::cerr << "<start_zoom>" << std::endl;
@@ -102,35 +191,35 @@ int main(int argc, char* argv[])
     return 1;
   }
 
-  map=argv[1];
-  style=argv[2];
+  map=argv[currentArg];
+  style=argv[currentArg+1];
 
-  if (sscanf(argv[3],"%lf",&latTop)!=1) {
+  if (sscanf(argv[currentArg+2],"%lf",&latTop)!=1) {
     std::cerr << "lon is not numeric!" << std::endl;
     return 1;
   }
 
-  if (sscanf(argv[4],"%lf",&lonLeft)!=1) {
+  if (sscanf(argv[currentArg+3],"%lf",&lonLeft)!=1) {
     std::cerr << "lat is not numeric!" << std::endl;
     return 1;
   }
 
-  if (sscanf(argv[5],"%lf",&latBottom)!=1) {
+  if (sscanf(argv[currentArg+4],"%lf",&latBottom)!=1) {
     std::cerr << "lon is not numeric!" << std::endl;
     return 1;
   }
 
-  if (sscanf(argv[6],"%lf",&lonRight)!=1) {
+  if (sscanf(argv[currentArg+5],"%lf",&lonRight)!=1) {
     std::cerr << "lat is not numeric!" << std::endl;
     return 1;
   }
 
-  if (sscanf(argv[7],"%lu",&startZoom)!=1) {
+  if (sscanf(argv[currentArg+6],"%lu",&startZoom)!=1) {
     std::cerr << "start zoom is not numeric!" << std::endl;
     return 1;
   }
 
-  if (sscanf(argv[8],"%lu",&endZoom)!=1) {
+  if (sscanf(argv[currentArg+7],"%lu",&endZoom)!=1) {
     std::cerr << "end zoom is not numeric!" << std::endl;
     return 1;
   }
@@ -150,10 +239,8 @@ int main(int argc, char* argv[])
     std::cerr << "Cannot open style" << std::endl;
   }
 
-  osmscout::MercatorProjection  projection;
   osmscout::MapParameter        drawParameter;
   osmscout::AreaSearchParameter searchParameter;
-  osmscout::MapData             data;
 
   // Change this, to match your system
   drawParameter.SetFontName("/usr/share/fonts/truetype/msttcorefonts/Verdana.ttf");
@@ -171,145 +258,28 @@ int main(int argc, char* argv[])
   searchParameter.SetMaximumWays(std::numeric_limits<unsigned long>::max());
   searchParameter.SetMaximumAreas(std::numeric_limits<unsigned long>::max());
 
-  for (size_t zoom=std::min(startZoom,endZoom);
-       zoom<=std::max(startZoom,endZoom);
-       zoom++) {
-    xTileStart=long2tilex(std::min(lonLeft,lonRight),zoom);
-    xTileEnd=long2tilex(std::max(lonLeft,lonRight),zoom);
-    xTileCount=xTileEnd-xTileStart+1;
-
-    yTileStart=lat2tiley(std::max(latTop,latBottom),zoom);
-    yTileEnd=lat2tiley(std::min(latTop,latBottom),zoom);
-    yTileCount=yTileEnd-yTileStart+1;
-
-    std::cout << "Drawing zoom " << zoom << ", " << (xTileCount)*(yTileCount) << " tiles [" << xTileStart << "," << yTileStart << " - " <<  xTileEnd << "," << yTileEnd << "]" << std::endl;
-
-    unsigned long           bitmapSize=tileWidth*tileHeight*3*xTileCount*yTileCount;
-    unsigned char           *buffer=new unsigned char[bitmapSize];
-    osmscout::MapPainterAgg painter;
-    osmscout::Magnification magnification;
-
-    magnification.SetLevel(zoom);
-
-    memset(buffer,0,bitmapSize);
-
-    agg::rendering_buffer rbuf(buffer,
-                               tileWidth*xTileCount,
-                               tileHeight*yTileCount,
-                               tileWidth*xTileCount*3);
-
-    double minTime=std::numeric_limits<double>::max();
-    double maxTime=0.0;
-    double totalTime=0.0;
-
-    osmscout::TypeSet              nodeTypes;
-    std::vector<osmscout::TypeSet> wayTypes;
-    osmscout::TypeSet              areaTypes;
-
-    styleConfig.GetNodeTypesWithMaxMag(magnification,
-                                       nodeTypes);
-
-    styleConfig.GetWayTypesByPrioWithMaxMag(magnification,
-                                            wayTypes);
-
-    styleConfig.GetAreaTypesWithMaxMag(magnification,
-                                       areaTypes);
-
-    for (size_t y=yTileStart; y<=yTileEnd; y++) {
-      for (size_t x=xTileStart; x<=xTileEnd; x++) {
-        double              minLat2,minLat,lat,maxLat,maxLat2;
-        double              minLon2,minLon,lon,maxLon,maxLon2;
-        agg::pixfmt_rgb24   pf(rbuf);
-        osmscout::StopClock timer;
-
-        minLat2=tiley2lat(y+2,zoom);
-        minLat=tiley2lat(y+1,zoom);
-        maxLat=tiley2lat(y,zoom);
-        maxLat2=tiley2lat(y-1,zoom);
-
-        minLon2=tilex2long(x-1,zoom);
-        minLon=tilex2long(x,zoom);
-        maxLon=tilex2long(x+1,zoom);
-        maxLon2=tilex2long(x+2,zoom);
-
-        lat=(minLat+maxLat)/2;
-        lon=(minLon+maxLon)/2;
-
-        std::cout << "Drawing tile [" << minLat << "," << lat << "," << maxLat << "]x[" << minLon << "," << lon << "," << maxLon << "]" << std::endl;
-        //std::cout << x << "," << y << "/";
-        //std::cout << x-xTileStart << "," << y-yTileStart << std::endl;
-
-        projection.Set(lon,lat,
-                       magnification,
-                       tileWidth,
-                       tileHeight);
-
-
-        database.GetObjects(searchParameter,
-                            projection.GetMagnification(),
-                            nodeTypes,
-                            minLon2,
-                            minLat2,
-                            maxLon2,
-                            maxLat2,
-                            data.nodes,
-                            wayTypes,
-                            minLon,
-                            minLat,
-                            maxLon,
-                            maxLat,
-                            data.ways,
-                            areaTypes,
-                            minLon2,
-                            minLat2,
-                            maxLon2,
-                            maxLat2,
-                            data.areas);
-
-        size_t bufferOffset=xTileCount*tileWidth*3*(y-yTileStart)*tileHeight+
-                            (x-xTileStart)*tileWidth*3;
-
-        rbuf.attach(buffer+bufferOffset,
-                    tileWidth,tileHeight,
-                    tileWidth*xTileCount*3);
-
-        painter.DrawMap(styleConfig,
-                        projection,
-                        drawParameter,
-                        data,
-                        &pf);
-
-        timer.Stop();
-
-        double time=timer.GetMilliseconds();
-
-        minTime=std::min(minTime,time);
-        maxTime=std::max(maxTime,time);
-        totalTime+=time;
-
-        std::string output=osmscout::NumberToString(zoom)+"_"+osmscout::NumberToString(x)+"_"+osmscout::NumberToString(y)+".ppm";
-
-        write_ppm(rbuf,output.c_str());
-      }
-    }
-
-    rbuf.attach(buffer,
-                tileWidth*xTileCount,
-                tileHeight*yTileCount,
-                tileWidth*xTileCount*3);
-
-    std::string output=osmscout::NumberToString(zoom)+"_full_map.ppm";
-
-    write_ppm(rbuf,output.c_str());
+  TileRendererAgg     renderer(database,
+                               styleConfig);
+  osmscout::StopClock timer;
+
+  renderer.SetThreadCount(threadCount);
+  renderer.SetMetaTileSize(metaTileSize);
+  renderer.SetRenderMetaTiles(!singleTiles);
+
+  if (!renderer.Render(drawParameter,
+                       searchParameter,
+                       std::min(lonLeft,lonRight),
+                       std::min(latTop,latBottom),
+                       std::max(lonLeft,lonRight),
+                       std::max(latTop,latBottom),
+                       startZoom,
+                       endZoom)) {
+    std::cerr << "Error while rendering tiles" << std::endl;
+  }
 
-    delete[] buffer;
+  timer.Stop();
 
-    std::cout << "=> Time: ";
-    std::cout << "total: " << totalTime << " msec ";
-    std::cout << "min: " << minTime << " msec ";
-    std::cout << "avg: " << totalTime/(xTileCount*yTileCount) << " msec ";
-    std::cout << "max: " << maxTime << " msec" << std::endl;
-  }
+  std::cout << "=> " << renderer.GetTileCount() << " tiles, time: " << timer.GetMilliseconds() << " msec" << std::endl;
 
   database.Close();
 
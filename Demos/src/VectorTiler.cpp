@@ -0,0 +1,183 @@
+/*
+  VectorTiler - a demo program for libosmscout
+  Copyright (C) 2013  Tim Teulings
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+#include <cstring>
+#include <iostream>
+#include <iomanip>
+#include <limits>
+
+#include <osmscout/Database.h>
+#include <osmscout/StyleConfigLoader.h>
+#include <osmscout/VectorTileRenderer.h>
+
+#include <osmscout/util/StopClock.h>
+
+/*
+  Example for the nordrhein-westfalen.osm (to be executed in the Demos top
+  level directory), exporting the "Ruhrgebiet" as vector tiles to the
+  directory "tiles":
+
+  src/VectorTiler --threads 4 ../TravelJinni/ ../TravelJinni/standard.oss 51.2 6.5 51.7 8 10 13 tiles
+*/
+
+int main(int argc, char* argv[])
+{
+  std::string   map;
+  std::string   style;
+  std::string   output;
+  double        latTop,latBottom,lonLeft,lonRight;
+  unsigned long startZoom;
+  unsigned long endZoom;
+  unsigned long threadCount=1;
+  unsigned long metaTileSize=8;
+  bool          singleTiles=false;
+
+  int currentArg=1;
+  while (currentArg<argc) {
+    if (strcmp(argv[currentArg],"--threads")==0 &&
+        currentArg+1<argc) {
+      if (sscanf(argv[currentArg+1],"%lu",&threadCount)!=1) {
+        std::cerr << "thread count is not numeric!" << std::endl;
+        return 1;
+      }
+
+      currentArg+=2;
+    }
+    else if (strcmp(argv[currentArg],"--metatile")==0 &&
+             currentArg+1<argc) {
+      if (sscanf(argv[currentArg+1],"%lu",&metaTileSize)!=1) {
+        std::cerr << "meta tile size is not numeric!" << std::endl;
+        return 1;
+      }
+
+      currentArg+=2;
+    }
+    else if (strcmp(argv[currentArg],"--singletiles")==0) {
+      singleTiles=true;
+
+      currentArg++;
+    }
+    else {
+      // No more "special" arguments
+      break;
+    }
+  }
+
+  if (argc-currentArg!=9) {
+    std::cerr << "VectorTiler [--threads <count>] [--metatile <size>] [--singletiles] ";
+    std::cerr << "<map directory> <style-file> ";
+    std::cerr << "<lat_top> <lon_left> <lat_bottom> <lon_right> ";
+    std::cerr << "<start_zoom> <end_zoom> ";
+    std::cerr << "<output directory>" << std::endl;
+    return 1;
+  }
+
+  map=argv[currentArg];
+  style=argv[currentArg+1];
+
+  if (sscanf(argv[currentArg+2],"%lf",&latTop)!=1) {
+    std::cerr << "lon is not numeric!" << std::endl;
+    return 1;
+  }
+
+  if (sscanf(argv[currentArg+3],"%lf",&lonLeft)!=1) {
+    std::cerr << "lat is not numeric!" << std::endl;
+    return 1;
+  }
+
+  if (sscanf(argv[currentArg+4],"%lf",&latBottom)!=1) {
+    std::cerr << "lon is not numeric!" << std::endl;
+    return 1;
+  }
+
+  if (sscanf(argv[currentArg+5],"%lf",&lonRight)!=1) {
+    std::cerr << "lat is not numeric!" << std::endl;
+    return 1;
+  }
+
+  if (sscanf(argv[currentArg+6],"%lu",&startZoom)!=1) {
+    std::cerr << "start zoom is not numeric!" << std::endl;
+    return 1;
+  }
+
+  if (sscanf(argv[currentArg+7],"%lu",&endZoom)!=1) {
+    std::cerr << "end zoom is not numeric!" << std::endl;
+    return 1;
+  }
+
+  output=argv[currentArg+8];
+
+  osmscout::DatabaseParameter databaseParameter;
+  osmscout::Database          database(databaseParameter);
+
+  if (!database.Open(map.c_str())) {
+    std::cerr << "Cannot open database" << std::endl;
+
+    return 1;
+  }
+
+  osmscout::StyleConfig styleConfig(database.GetTypeConfig());
+
+  if (!osmscout::LoadStyleConfig(style.c_str(),styleConfig)) {
+    std::cerr << "Cannot open style" << std::endl;
+  }
+
+  osmscout::MapParameter        drawParameter;
+  osmscout::AreaSearchParameter searchParameter;
+
+  searchParameter.SetUseLowZoomOptimization(false);
+  searchParameter.SetMaximumAreaLevel(3);
+  searchParameter.SetMaximumNodes(std::numeric_limits<unsigned long>::max());
+  searchParameter.SetMaximumWays(std::numeric_limits<unsigned long>::max());
+  searchParameter.SetMaximumAreas(std::numeric_limits<unsigned long>::max());
+
+  osmscout::VectorTileRenderer renderer(database,
+                                        styleConfig);
+  osmscout::StopClock          timer;
+
+  renderer.SetThreadCount(threadCount);
+  renderer.SetMetaTileSize(metaTileSize);
+  renderer.SetRenderMetaTiles(!singleTiles);
+
+  if (!renderer.Export(drawParameter,
+                       searchParameter,
+                       std::min(lonLeft,lonRight),
+                       std::min(latTop,latBottom),
+                       std::max(lonLeft,lonRight),
+                       std::max(latTop,latBottom),
+                       startZoom,
+                       endZoom,
+                       output)) {
+    std::cerr << "Error while exporting tiles" << std::endl;
+  }
+
+  timer.Stop();
+
+  std::cout << "=> " << renderer.GetTileCount() << " tiles, time: " << timer.GetMilliseconds() << " msec";
+
+  if (timer.GetMilliseconds()>0) {
+    std::cout << ", " << std::fixed << std::setprecision(1) << renderer.GetTileCount()*1000.0/timer.GetMilliseconds() << " tiles/sec";
+  }
+
+  std::cout << ", " << renderer.GetByteCount() << " bytes" << std::endl;
+
+  database.Close();
+
+  return 0;
+}
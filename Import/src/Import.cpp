@@ -62,23 +62,29 @@ void DumpHelp(osmscout::ImportParameter& parameter)
   std::cout << " --typefile <path>                    path and name of the map.ost file (default: " << parameter.GetTypefile() << ")" << std::endl;
   std::cout << " --destinationDirectory <path>        destination for generated map files (default: " << parameter.GetDestinationDirectory() << ")" << std::endl;
 
+  std::cout << " --moduleThreadCount <number>         number of import steps executed in parallel (default: " << parameter.GetModuleThreadCount() << ")" << std::endl;
+  std::cout << " --preprocessThreadCount <number>     number of threads decoding PBF files (default: " << parameter.GetPreprocessThreadCount() << ")" << std::endl;
+
   std::cout << " --strictAreas true|false             assure that areas are simple (default: " << BoolToString(parameter.GetStrictAreas()) << ")" << std::endl;
 
   std::cout << " --numericIndexPageSize <number>      size of an numeric index page in bytes (default: " << parameter.GetNumericIndexPageSize() << ")" << std::endl;
 
   std::cout << " --coordDataMemoryMaped true|false    memory maped coord data file access (default: " << BoolToString(parameter.GetCoordDataMemoryMaped()) << ")" << std::endl;
+  std::cout << " --coordDataCompressed true|false     store coord data in compressed blocks (default: " << BoolToString(parameter.GetCoordDataCompressed()) << ")" << std::endl;
+  std::cout << " --coordDeltaEncoding true|false      store way and area nodes delta encoded (default: " << BoolToString(parameter.GetCoordDeltaEncoding()) << ")" << std::endl;
 
   std::cout << " --rawNodeDataMemoryMaped true|false  memory maped raw node data file access (default: " << BoolToString(parameter.GetRawNodeDataMemoryMaped()) << ")" << std::endl;
   std::cout << " --rawNodeDataCacheSize <number>      raw node data cache size (default: " << parameter.GetRawNodeDataCacheSize() << ")" << std::endl;
 
   std::cout << " --rawWayIndexMemoryMaped true|false  memory maped raw way index file access (default: " << BoolToString(parameter.GetRawWayIndexMemoryMaped()) << ")" << std::endl;
   std::cout << " --rawWayDataMemoryMaped true|false   memory maped raw way data file access (default: " << BoolToString(parameter.GetRawWayDataMemoryMaped()) << ")" << std::endl;
-  std::cout << " --rawWayDataCacheSize <number>       raw way data cache size (default: " << parameter.GetRawWayDataCacheSize() << ")" << std::endl;
+  std::cout << " --rawWayDataCacheSizeBytes <number>  raw way data cache size in bytes (default: " << parameter.GetRawWayDataCacheSizeBytes() << ")" << std::endl;
   std::cout << " --rawWayIndexCacheSize <number>      raw way index cache size (default: " << parameter.GetRawWayIndexCacheSize() << ")" << std::endl;
   std::cout << " --rawWayBlockSize <number>           number of raw ways resolved in block (default: " << parameter.GetRawWayBlockSize() << ")" << std::endl;
 
   std::cout << " --noSort                             do not sort objects" << std::endl;
   std::cout << " --sortBlockSize <number>             size of one data block during sorting (default: " << parameter.GetSortBlockSize() << ")" << std::endl;
+  std::cout << " --sortCompressRuns true|false        compress temporary data during sorting (default: " << BoolToString(parameter.GetSortCompressRuns()) << ")" << std::endl;
 
   std::cout << " --areaDataMemoryMaped true|false     memory maped area data file access (default: " << BoolToString(parameter.GetAreaDataMemoryMaped()) << ")" << std::endl;
   std::cout << " --areaDataCacheSize <number>         area data cache size (default: " << parameter.GetAreaDataCacheSize() << ")" << std::endl;
@@ -86,7 +92,12 @@ void DumpHelp(osmscout::ImportParameter& parameter)
   std::cout << " --wayDataMemoryMaped true|false      memory maped way data file access (default: " << BoolToString(parameter.GetWayDataMemoryMaped()) << ")" << std::endl;
   std::cout << " --wayDataCacheSize <number>          way data cache size (default: " << parameter.GetWayDataCacheSize() << ")" << std::endl;
 
+  std::cout << " --optimizationAllTypes true|false    generate low zoom data for all area and way types (default: " << BoolToString(parameter.GetOptimizationAllTypes()) << ")" << std::endl;
+  std::cout << " --optimizationLevelStep <number>     distance between low zoom levels of these types (default: " << parameter.GetOptimizationLevelStep() << ")" << std::endl;
+
   std::cout << " --routeNodeBlockSize <number>        number of route nodes resolved in block (default: " << BoolToString(parameter.GetRouteNodeBlockSize()) << ")" << std::endl;
+  std::cout << " --routeGraph true|false              generate compact routing graphs (default: " << BoolToString(parameter.GetRouteGraph()) << ")" << std::endl;
+  std::cout << " --routeCH true|false                 generate contraction hierarchy for car routing (default: " << BoolToString(parameter.GetRouteCH()) << ")" << std::endl;
 }
 
 bool ParseBoolArgument(int argc,
@@ -173,20 +184,26 @@ int main(int argc, char* argv[])
   size_t                    startStep=parameter.GetStartStep();
   size_t                    endStep=parameter.GetEndStep();
 
+  size_t                    moduleThreadCount=parameter.GetModuleThreadCount();
+  size_t                    preprocessThreadCount=parameter.GetPreprocessThreadCount();
+
   bool                      strictAreas=parameter.GetStrictAreas();
 
   size_t                    numericIndexPageSize=parameter.GetNumericIndexPageSize();
 
   size_t                    sortBlockSize=parameter.GetSortBlockSize();
+  bool                      sortCompressRuns=parameter.GetSortCompressRuns();
 
   bool                      coordDataMemoryMaped=parameter.GetCoordDataMemoryMaped();
+  bool                      coordDataCompressed=parameter.GetCoordDataCompressed();
+  bool                      coordDeltaEncoding=parameter.GetCoordDeltaEncoding();
 
   bool                      rawNodeDataMemoryMaped=parameter.GetRawNodeDataMemoryMaped();
   size_t                    rawNodeDataCacheSize=parameter.GetRawNodeDataCacheSize();
 
   bool                      rawWayIndexMemoryMaped=parameter.GetRawWayIndexMemoryMaped();
   bool                      rawWayDataMemoryMaped=parameter.GetRawWayDataMemoryMaped();
-  size_t                    rawWayDataCacheSize=parameter.GetRawWayDataCacheSize();
+  size_t                    rawWayDataCacheSizeBytes=parameter.GetRawWayDataCacheSizeBytes();
   size_t                    rawWayIndexCacheSize=parameter.GetRawWayIndexCacheSize();
   size_t                    rawWayBlockSize=parameter.GetRawWayBlockSize();
 
@@ -196,7 +213,12 @@ int main(int argc, char* argv[])
   bool                      wayDataMemoryMaped=parameter.GetWayDataMemoryMaped();
   size_t                    wayDataCacheSize=parameter.GetWayDataCacheSize();
 
+  bool                      optimizationAllTypes=parameter.GetOptimizationAllTypes();
+  size_t                    optimizationLevelStep=parameter.GetOptimizationLevelStep();
+
   size_t                    routeNodeBlockSize=parameter.GetRouteNodeBlockSize();
+  bool                      routeGraph=parameter.GetRouteGraph();
+  bool                      routeCH=parameter.GetRouteCH();
 
   // Simple way to analyse command line parameters, but enough for now...
   int i=1;
@@ -240,6 +262,18 @@ int main(int argc, char* argv[])
                                           i,
                                           destinationDirectory);
     }
+    else if (strcmp(argv[i],"--moduleThreadCount")==0) {
+      parameterError=!ParseSizeTArgument(argc,
+                                         argv,
+                                         i,
+                                         moduleThreadCount);
+    }
+    else if (strcmp(argv[i],"--preprocessThreadCount")==0) {
+      parameterError=!ParseSizeTArgument(argc,
+                                         argv,
+                                         i,
+                                         preprocessThreadCount);
+    }
     else if (strcmp(argv[i],"--strictAreas")==0) {
       parameterError=!ParseBoolArgument(argc,
                                         argv,
@@ -258,6 +292,18 @@ int main(int argc, char* argv[])
                                         i,
                                         coordDataMemoryMaped);
     }
+    else if (strcmp(argv[i],"--coordDataCompressed")==0) {
+      parameterError=!ParseBoolArgument(argc,
+                                        argv,
+                                        i,
+                                        coordDataCompressed);
+    }
+    else if (strcmp(argv[i],"--coordDeltaEncoding")==0) {
+      parameterError=!ParseBoolArgument(argc,
+                                        argv,
+                                        i,
+                                        coordDeltaEncoding);
+    }
     else if (strcmp(argv[i],"--rawNodeDataMemoryMaped")==0) {
       parameterError=!ParseBoolArgument(argc,
                                         argv,
@@ -282,11 +328,11 @@ int main(int argc, char* argv[])
                                         i,
                                         rawWayDataMemoryMaped);
     }
-    else if (strcmp(argv[i],"--rawWayDataCacheSize")==0) {
+    else if (strcmp(argv[i],"--rawWayDataCacheSizeBytes")==0) {
       parameterError=!ParseSizeTArgument(argc,
                                          argv,
                                          i,
-                                         rawWayDataCacheSize);
+                                         rawWayDataCacheSizeBytes);
     }
     else if (strcmp(argv[i],"--rawWayIndexCacheSize")==0) {
       parameterError=!ParseSizeTArgument(argc,
@@ -311,6 +357,12 @@ int main(int argc, char* argv[])
                                          i,
                                          sortBlockSize);
     }
+    else if (strcmp(argv[i],"--sortCompressRuns")==0) {
+      parameterError=!ParseBoolArgument(argc,
+                                        argv,
+                                        i,
+                                        sortCompressRuns);
+    }
     else if (strcmp(argv[i],"--areaDataMemoryMaped")==0) {
       parameterError=!ParseBoolArgument(argc,
                                         argv,
@@ -335,12 +387,36 @@ int main(int argc, char* argv[])
                                          i,
                                          wayDataCacheSize);
     }
+    else if (strcmp(argv[i],"--optimizationAllTypes")==0) {
+      parameterError=!ParseBoolArgument(argc,
+                                        argv,
+                                        i,
+                                        optimizationAllTypes);
+    }
+    else if (strcmp(argv[i],"--optimizationLevelStep")==0) {
+      parameterError=!ParseSizeTArgument(argc,
+                                         argv,
+                                         i,
+                                         optimizationLevelStep);
+    }
     else if (strcmp(argv[i],"--routeNodeBlockSize")==0) {
       parameterError=!ParseSizeTArgument(argc,
                                          argv,
                                          i,
                                          routeNodeBlockSize);
     }
+    else if (strcmp(argv[i],"--routeGraph")==0) {
+      parameterError=!ParseBoolArgument(argc,
+                                        argv,
+                                        i,
+                                        routeGraph);
+    }
+    else if (strcmp(argv[i],"--routeCH")==0) {
+      parameterError=!ParseBoolArgument(argc,
+                                        argv,
+                                        i,
+                                        routeCH);
+    }
     else if (mapfile.empty()) {
       mapfile=argv[i];
 
@@ -369,20 +445,26 @@ int main(int argc, char* argv[])
   parameter.SetDestinationDirectory(destinationDirectory);
   parameter.SetSteps(startStep,endStep);
 
+  parameter.SetModuleThreadCount(moduleThreadCount);
+  parameter.SetPreprocessThreadCount(preprocessThreadCount);
+
   parameter.SetStrictAreas(strictAreas);
 
   parameter.SetNumericIndexPageSize(numericIndexPageSize);
 
   parameter.SetSortBlockSize(sortBlockSize);
+  parameter.SetSortCompressRuns(sortCompressRuns);
 
   parameter.SetCoordDataMemoryMaped(coordDataMemoryMaped);
+  parameter.SetCoordDataCompressed(coordDataCompressed);
+  parameter.SetCoordDeltaEncoding(coordDeltaEncoding);
 
   parameter.SetRawNodeDataMemoryMaped(rawNodeDataMemoryMaped);
   parameter.SetRawNodeDataCacheSize(rawNodeDataCacheSize);
 
   parameter.SetRawWayIndexMemoryMaped(rawWayIndexMemoryMaped);
   parameter.SetRawWayDataMemoryMaped(rawWayDataMemoryMaped);
-  parameter.SetRawWayDataCacheSize(rawWayDataCacheSize);
+  parameter.SetRawWayDataCacheSizeBytes(rawWayDataCacheSizeBytes);
   parameter.SetRawWayIndexCacheSize(rawWayIndexCacheSize);
   parameter.SetRawWayBlockSize(rawWayBlockSize);
 
@@ -392,7 +474,12 @@ int main(int argc, char* argv[])
   parameter.SetWayDataMemoryMaped(wayDataMemoryMaped);
   parameter.SetWayDataCacheSize(wayDataCacheSize);
 
+  parameter.SetOptimizationAllTypes(optimizationAllTypes);
+  parameter.SetOptimizationLevelStep(optimizationLevelStep);
+
   parameter.SetRouteNodeBlockSize(routeNodeBlockSize);
+  parameter.SetRouteGraph(routeGraph);
+  parameter.SetRouteCH(routeCH);
 
   parameter.SetOptimizationWayMethod(osmscout::TransPolygon::quality);
 
@@ -413,6 +500,10 @@ int main(int argc, char* argv[])
 
   progress.Info(std::string("CoordDataMemoryMaped: ")+
                 (parameter.GetCoordDataMemoryMaped() ? "true" : "false"));
+  progress.Info(std::string("CoordDataCompressed: ")+
+                (parameter.GetCoordDataCompressed() ? "true" : "false"));
+  progress.Info(std::string("CoordDeltaEncoding: ")+
+                (parameter.GetCoordDeltaEncoding() ? "true" : "false"));
 
   progress.Info(std::string("RawNodeDataMemoryMaped: ")+
                 (parameter.GetRawNodeDataMemoryMaped() ? "true" : "false"));
@@ -423,8 +514,8 @@ int main(int argc, char* argv[])
                 (parameter.GetRawWayIndexMemoryMaped() ? "true" : "false"));
   progress.Info(std::string("RawWayDataMemoryMaped: ")+
                 (parameter.GetRawWayDataMemoryMaped() ? "true" : "false"));
-  progress.Info(std::string("RawWayDataCacheSize: ")+
-                osmscout::NumberToString(parameter.GetRawWayDataCacheSize()));
+  progress.Info(std::string("RawWayDataCacheSizeBytes: ")+
+                osmscout::NumberToString(parameter.GetRawWayDataCacheSizeBytes()));
   progress.Info(std::string("RawWayIndexCacheSize: ")+
                 osmscout::NumberToString(parameter.GetRawWayIndexCacheSize()));
   progress.Info(std::string("RawWayBlockSize: ")+
@@ -435,6 +526,8 @@ int main(int argc, char* argv[])
                 (parameter.GetSortObjects() ? "true" : "false"));
   progress.Info(std::string("SortBlockSize: ")+
                 osmscout::NumberToString(parameter.GetSortBlockSize()));
+  progress.Info(std::string("SortCompressRuns: ")+
+                (parameter.GetSortCompressRuns() ? "true" : "false"));
 
   progress.Info(std::string("AreaDataMemoryMaped: ")+
                 (parameter.GetAreaDataMemoryMaped() ? "true" : "false"));
@@ -446,8 +539,17 @@ int main(int argc, char* argv[])
   progress.Info(std::string("WayDataCacheSize: ")+
                 osmscout::NumberToString(parameter.GetWayDataCacheSize()));
 
+  progress.Info(std::string("OptimizationAllTypes: ")+
+                (parameter.GetOptimizationAllTypes() ? "true" : "false"));
+  progress.Info(std::string("OptimizationLevelStep: ")+
+                osmscout::NumberToString(parameter.GetOptimizationLevelStep()));
+
   progress.Info(std::string("RouteNodeBlockSize: ")+
                 osmscout::NumberToString(parameter.GetRouteNodeBlockSize()));
+  progress.Info(std::string("RouteGraph: ")+
+                (parameter.GetRouteGraph() ? "true" : "false"));
+  progress.Info(std::string("RouteCH: ")+
+                (parameter.GetRouteCH() ? "true" : "false"));
 
   if (osmscout::Import(parameter,progress)) {
     std::cout << "Import OK!" << std::endl;
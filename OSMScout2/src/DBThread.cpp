@@ -19,6 +19,7 @@
 
 #include "DBThread.h"
 
+#include <algorithm>
 #include <cmath>
 #include <iostream>
 
@@ -58,15 +59,8 @@ DBThread::DBThread(const SettingsRef& settings)
  : settings(settings),
    database(databaseParameter),
    styleConfig(NULL),
-   iconDirectory(),
-   currentImage(NULL)
-   ,currentLat(0.0)
-   ,currentLon(0.0)
-   ,currentMagnification(0)
-   ,finishedImage(NULL)
-   ,finishedLat(0.0)
-   ,finishedLon(0.0)
-   ,finishedMagnification(0)
+   tileCache(database,256,256),
+   iconDirectory()
    ,currentRenderRequest()
    ,doRender(false)
    , renderBreaker(new QBreaker())
@@ -74,13 +68,35 @@ DBThread::DBThread(const SettingsRef& settings)
 {
 }
 
-void DBThread::FreeMaps()
+/**
+  The part of the map shown for the given request
+  */
+static osmscout::MapTileCache::View GetView(const RenderMapRequest& request)
 {
-  delete currentImage;
-  currentImage=NULL;
+  osmscout::MapTileCache::View view;
 
-  delete finishedImage;
-  finishedImage=NULL;
+  view.lon=request.lon;
+  view.lat=request.lat;
+  view.magnification=request.magnification;
+  view.width=request.width;
+  view.height=request.height;
+
+  return view;
+}
+
+/**
+  The number of tiles the cache must hold for the given request: the tiles of
+  the view with the ring around it and the tiles of the view at the next zoom
+  level (see MapTileCache::Prefetch()), and the same again for the previous
+  view. Else prefetching drops the tiles currently shown.
+  */
+static size_t GetMaxTiles(const RenderMapRequest& request,
+                          size_t tileSize)
+{
+  size_t columns=(request.width+tileSize-1)/tileSize+3;
+  size_t rows=(request.height+tileSize-1)/tileSize+3;
+
+  return std::max((size_t)256,4*columns*rows);
 }
 
 bool DBThread::AssureRouter(osmscout::Vehicle vehicle)
@@ -156,7 +172,7 @@ void DBThread::Initialize()
 
 void DBThread::Finalize()
 {
-  FreeMaps();
+  tileCache.Flush();
 
   if (router.Valid() && router->IsOpen()) {
     router->Close();
@@ -193,27 +209,18 @@ void DBThread::TriggerMapRendering()
     renderBreaker->Reset();
   }
 
-  if (currentImage==NULL ||
-      currentImage->width()!=(int)request.width ||
-      currentImage->height()!=(int)request.height) {
-    delete currentImage;
-
-    currentImage=new QImage(QSize(request.width,request.height),QImage::Format_RGB32);
-  }
-
-  currentLon=request.lon;
-  currentLat=request.lat;
-  currentMagnification=request.magnification;
-
   if (database.IsOpen() &&
       styleConfig!=NULL) {
-    osmscout::MercatorProjection  projection;
+    osmscout::MapTileCache::View  view=GetView(request);
     osmscout::MapParameter        drawParameter;
     osmscout::AreaSearchParameter searchParameter;
 
+    tileCache.SetMaxTiles(GetMaxTiles(request,
+                                      tileCache.GetTileSize()));
+
     searchParameter.SetBreaker(renderBreakerRef);
 
-    searchParameter.SetUseMultithreading(currentMagnification.GetMagnification()<=osmscout::Magnification::magCity);
+    searchParameter.SetUseMultithreading(view.magnification.GetMagnification()<=osmscout::Magnification::magCity);
 
     std::list<std::string>        paths;
 
@@ -222,120 +229,39 @@ void DBThread::TriggerMapRendering()
     drawParameter.SetDPI(settings->GetDPI());
     drawParameter.SetIconPaths(paths);
     drawParameter.SetPatternPaths(paths);
-    drawParameter.SetDebugPerformance(true);
     drawParameter.SetOptimizeWayNodes(osmscout::TransPolygon::quality);
     drawParameter.SetOptimizeAreaNodes(osmscout::TransPolygon::quality);
     drawParameter.SetRenderSeaLand(true);
     drawParameter.SetBreaker(renderBreakerRef);
 
-    std::cout << std::endl;
-
-    osmscout::StopClock overallTimer;
+    osmscout::StopClock renderTimer;
 
-    projection.Set(currentLon,
-                   currentLat,
-                   currentMagnification,
-                   request.width,
-                   request.height);
-
-    osmscout::TypeSet              nodeTypes;
-    std::vector<osmscout::TypeSet> wayTypes;
-    osmscout::TypeSet              areaTypes;
-
-    styleConfig->GetNodeTypesWithMaxMag(projection.GetMagnification(),
-                                        nodeTypes);
-
-    styleConfig->GetWayTypesByPrioWithMaxMag(projection.GetMagnification(),
-                                             wayTypes);
-
-    styleConfig->GetAreaTypesWithMaxMag(projection.GetMagnification(),
-                                        areaTypes);
-
-    osmscout::StopClock dataRetrievalTimer;
-
-    database.GetObjects(nodeTypes,
-                        wayTypes,
-                        areaTypes,
-                        projection.GetLonMin(),
-                        projection.GetLatMin(),
-                        projection.GetLonMax(),
-                        projection.GetLatMax(),
-                        projection.GetMagnification(),
-                        searchParameter,
-                        data.nodes,
-                        data.ways,
-                        data.areas);
-
-    if (drawParameter.GetRenderSeaLand()) {
-      database.GetGroundTiles(projection.GetLonMin(),
-                              projection.GetLatMin(),
-                              projection.GetLonMax(),
-                              projection.GetLatMax(),
-                              projection.GetMagnification(),
-                              data.groundTiles);
+    // Only the tiles not already cached are rendered. If rendering is
+    // aborted, a new request is pending and the tiles completed so far
+    // are kept
+    if (!tileCache.RenderTiles(*styleConfig,
+                               view,
+                               drawParameter,
+                               searchParameter)) {
+      return;
     }
 
-    dataRetrievalTimer.Stop();
-
-    osmscout::StopClock drawTimer;
-
-    QPainter p;
-
-    p.begin(currentImage);
-    p.setRenderHint(QPainter::Antialiasing);
-    p.setRenderHint(QPainter::TextAntialiasing);
-    p.setRenderHint(QPainter::SmoothPixmapTransform);
-
-    painter.DrawMap(*styleConfig,
-                    projection,
-                    drawParameter,
-                    data,
-                    &p);
+    renderTimer.Stop();
 
-    p.end();
+    std::cout << "Render: " << renderTimer << std::endl;
 
-    drawTimer.Stop();
-    overallTimer.Stop();
+    emit HandleMapRenderingResult();
 
-    std::cout << "All: " << overallTimer << " Data: " << dataRetrievalTimer << " Draw: " << drawTimer << std::endl;
+    // Render the tiles likely to be requested next until the next request
+    // breaks the renderer
+    tileCache.Prefetch(*styleConfig,
+                       view,
+                       drawParameter,
+                       searchParameter);
   }
   else {
     std::cout << "Cannot draw map: " << database.IsOpen() << " " << (styleConfig!=NULL) << std::endl;
-
-    QPainter p;
-
-    p.begin(currentImage);
-    p.setRenderHint(QPainter::Antialiasing);
-    p.setRenderHint(QPainter::TextAntialiasing);
-    p.setRenderHint(QPainter::SmoothPixmapTransform);
-
-    p.fillRect(0,0,request.width,request.height,
-               QColor::fromRgbF(0.0,0.0,0.0,1.0));
-
-    p.setPen(QColor::fromRgbF(1.0,1.0,1.0,1.0));
-
-    QString text("not initialized (yet)");
-
-    p.drawText(QRect(0,0,request.width,request.height),
-               Qt::AlignCenter|Qt::AlignVCenter,
-               text,
-               NULL);
-
-    p.end();
   }
-
-  QMutexLocker locker(&mutex);
-
-  if (renderBreaker->IsAborted()) {
-    return;
-  }
-
-  std::swap(currentImage,finishedImage);
-  std::swap(currentLon,finishedLon);
-  std::swap(currentLat,finishedLat);
-  std::swap(currentMagnification,finishedMagnification);
-
-  emit HandleMapRenderingResult();
 }
 
 bool DBThread::RenderMap(QPainter& painter,
@@ -343,7 +269,7 @@ bool DBThread::RenderMap(QPainter& painter,
 {
   QMutexLocker locker(&mutex);
 
-  if (finishedImage==NULL) {
+  if (styleConfig==NULL) {
     painter.fillRect(0,0,request.width,request.height,
                      QColor::fromRgbF(0.0,0.0,0.0,1.0));
 
@@ -360,10 +286,10 @@ bool DBThread::RenderMap(QPainter& painter,
 
   osmscout::MercatorProjection projection;
 
-  projection.Set(finishedLon,finishedLat,
-                 finishedMagnification,
-                 finishedImage->width(),
-                 finishedImage->height());
+  projection.Set(request.lon,request.lat,
+                 request.magnification,
+                 request.width,
+                 request.height);
 
   double lonMin,lonMax,latMin,latMax;
 
@@ -395,41 +321,27 @@ bool DBThread::RenderMap(QPainter& painter,
 
   //std::cout << "VisualScale: value: " << scaleValue << " pixel: " << scaleSize << std::endl;
 
-  double dx=0;
-  double dy=0;
-  if (request.lon!=finishedLon || request.lat!=finishedLat) {
-    dx-=(request.lon-finishedLon)*request.width/(lonMax-lonMin);
-    dy+=(request.lat-finishedLat)*request.height/(latMax-latMin);
-  }
+  // Tiles not rendered yet show the background
+  osmscout::FillStyleRef unknownFillStyle;
+  osmscout::Color        backgroundColor;
 
-  if (dx!=0 ||
-      dy!=0) {
-    osmscout::FillStyleRef unknownFillStyle;
-    osmscout::Color        backgroundColor;
-
-    styleConfig->GetUnknownFillStyle(projection,
-                                     settings->GetDPI(),
-                                     unknownFillStyle);
-
-    backgroundColor=unknownFillStyle->GetFillColor();
-
-    painter.fillRect(0,
-                     0,
-                     request.width,
-                     request.height,
-                     QColor::fromRgbF(backgroundColor.GetR(),
-                                      backgroundColor.GetG(),
-                                      backgroundColor.GetB(),
-                                      backgroundColor.GetA()));
-  }
+  styleConfig->GetUnknownFillStyle(projection,
+                                   settings->GetDPI(),
+                                   unknownFillStyle);
 
-  painter.drawImage(dx,dy,*finishedImage);
+  backgroundColor=unknownFillStyle->GetFillColor();
 
-  return finishedImage->width()==(int)request.width &&
-         finishedImage->height()==(int)request.height &&
-         finishedLon==request.lon &&
-         finishedLat==request.lat &&
-         finishedMagnification==request.magnification;
+  painter.fillRect(0,
+                   0,
+                   request.width,
+                   request.height,
+                   QColor::fromRgbF(backgroundColor.GetR(),
+                                    backgroundColor.GetG(),
+                                    backgroundColor.GetB(),
+                                    backgroundColor.GetA()));
+
+  return tileCache.DrawViewTiles(GetView(request),
+                                 &painter);
 }
 
 osmscout::TypeConfig* DBThread::GetTypeConfig() const
@@ -567,9 +479,9 @@ void DBThread::ClearRoute()
 {
   QMutexLocker locker(&mutex);
 
-  data.poiWays.clear();
+  poiWays.clear();
 
-  FreeMaps();
+  tileCache.SetPOIWays(poiWays);
 
   emit Redraw();
 }
@@ -578,9 +490,9 @@ void DBThread::AddRoute(const osmscout::Way& way)
 {
   QMutexLocker locker(&mutex);
 
-  data.poiWays.push_back(new osmscout::Way(way));
+  poiWays.push_back(new osmscout::Way(way));
 
-  FreeMaps();
+  tileCache.SetPOIWays(poiWays);
 
   emit Redraw();
 }
@@ -29,7 +29,7 @@
 #include <osmscout/Router.h>
 #include <osmscout/RoutePostprocessor.h>
 
-#include <osmscout/MapPainterQt.h>
+#include <osmscout/MapTileCacheQt.h>
 
 #include <osmscout/util/Breaker.h>
 
@@ -92,24 +92,14 @@ private:
   osmscout::DatabaseParameter  databaseParameter;
   osmscout::Database           database;
   osmscout::StyleConfig        *styleConfig;
-  osmscout::MapData            data;
-  osmscout::MapPainterQt       painter;
+  std::list<osmscout::WayRef>  poiWays;
+  osmscout::MapTileCacheQt     tileCache;
   osmscout::RouterParameter    routerParameter;
   osmscout::RouterRef          router;
   osmscout::RoutePostprocessor routePostprocessor;
   QString                      iconDirectory;
   QString                      m_stylesheetFilename;
 
-  QImage                       *currentImage;
-  double                       currentLat;
-  double                       currentLon;
-  osmscout::Magnification      currentMagnification;
-
-  QImage                       *finishedImage;
-  double                       finishedLat;
-  double                       finishedLon;
-  osmscout::Magnification      finishedMagnification;
-
   RenderMapRequest             currentRenderRequest;
   bool                         doRender;
   QBreaker*                    renderBreaker;
@@ -118,7 +108,6 @@ private:
 private:
   DBThread(const SettingsRef& settings);
 
-  void FreeMaps();
   bool AssureRouter(osmscout::Vehicle vehicle);
 public:
   QString stylesheetFilename();
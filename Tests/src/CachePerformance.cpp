@@ -21,8 +21,16 @@
 #include <iostream>
 #include <vector>
 
+#include <osmscout/CoreFeatures.h>
+
+#if defined(OSMSCOUT_HAVE_THREAD)
+#include <thread>
+#endif
+
 #include <osmscout/util/Cache.h>
 #include <osmscout/util/FileScanner.h>
+#include <osmscout/util/Mutex.h>
+#include <osmscout/util/ObjectCache.h>
 #include <osmscout/util/Reference.h>
 #include <osmscout/util/StopClock.h>
 
@@ -31,6 +39,9 @@
   * cache insertion
   * cache hit
   * cache miss
+  for Cache and ObjectCache, and compare
+  * hit rate of the working set while scanning over a large number of other objects
+  * throughput if accessed from multiple threads
 */
 
 /**
@@ -54,6 +65,7 @@ public:
 
 private:
   Data2(Data2& other)
+  : osmscout::Referencable(other)
   {
   }
 
@@ -67,8 +79,25 @@ typedef osmscout::LazyRef<Data2> Data2Ref;
 
 static const size_t cacheSize=2000000;
 
-typedef osmscout::Cache<osmscout::Id,Data>     DataCache;
-typedef osmscout::Cache<osmscout::Id,Data2Ref> Data2Cache;
+typedef osmscout::Cache<osmscout::Id,Data>           DataCache;
+typedef osmscout::Cache<osmscout::Id,Data2Ref>       Data2Cache;
+typedef osmscout::ObjectCache<osmscout::Id,Data2Ref> Data2ObjectCache;
+
+static unsigned long GetData2Size(const Data2Ref& data)
+{
+  return sizeof(Data2)+data->value2.capacity()*sizeof(size_t);
+}
+
+/**
+  Simple linear congruential generator, so that each thread can have its own
+  random number sequence.
+  */
+static inline size_t NextRandom(size_t& seed)
+{
+  seed=seed*1103515245+12345;
+
+  return (seed/65536) % 32768;
+}
 
 void TestData()
 {
@@ -278,10 +307,303 @@ void TestData2()
   std::cout << "Copy time: "  << copyTimer << std::endl;
 }
 
+void TestData2ObjectCache()
+{
+  std::cout << "*** Caching of Reference<struct> in ObjectCache ***" << std::endl;
+
+  Data2Ref         sample;
+
+  sample->value2.resize(10,0);
+
+  // Memory for cacheSize entries including the administrative overhead
+  Data2ObjectCache cache(cacheSize*(GetData2Size(sample)+256));
+
+  std::cout << "Inserting values into cache..." << std::endl;
+
+  osmscout::StopClock insertTimer;
+
+  for (size_t i=cacheSize; i<2*cacheSize; i++) {
+    Data2Ref data;
+    data->value=i;
+    data->value2.resize(10,i);
+
+    cache.SetEntry(i,data,GetData2Size(data));
+  }
+
+  insertTimer.Stop();
+
+  assert(cache.GetSize()==cacheSize);
+
+  std::cout << "Updating values in cache..." << std::endl;
+
+  osmscout::StopClock updateTimer;
+
+  for (size_t i=cacheSize; i<2*cacheSize; i++) {
+    Data2Ref data;
+    data->value=i;
+    data->value2.resize(10,i);
+
+    cache.SetEntry(i,data,GetData2Size(data));
+  }
+
+  updateTimer.Stop();
+
+  assert(cache.GetSize()==cacheSize);
+
+  std::cout << "Searching for entries not in cache..." << std::endl;
+
+  osmscout::StopClock missTimer;
+
+  for (size_t i=0; i<cacheSize; i++) {
+    Data2Ref entry;
+
+    if (cache.GetEntry(i,entry)) {
+      assert(false);
+    }
+  }
+
+  for (size_t i=2*cacheSize; i<3*cacheSize; i++) {
+    Data2Ref entry;
+
+    if (cache.GetEntry(i,entry)) {
+      assert(false);
+    }
+  }
+
+  missTimer.Stop();
+
+  std::cout << "Searching for entries in cache..." << std::endl;
+
+  osmscout::StopClock hitTimer;
+
+  for (size_t t=1; t<=2; t++) {
+    for (size_t i=cacheSize; i<2*cacheSize; i++) {
+      Data2Ref entry;
+
+      if (!cache.GetEntry(i,entry)) {
+        assert(false);
+      }
+    }
+  }
+
+  hitTimer.Stop();
+
+  std::cout << "Insert time: "  << insertTimer << std::endl;
+  std::cout << "Update time: "  << updateTimer << std::endl;
+  std::cout << "Miss time: "  << missTimer << std::endl;
+  std::cout << "Hit time (includes copy): "  << hitTimer << std::endl;
+  cache.DumpStatistics("ObjectCache");
+}
+
+static const size_t workingSetSize=20000;
+static const size_t workingSetRequests=1000000;
+static const size_t scanRequests=2;
+
+/**
+  Randomly request objects of a working set, each request followed by requests for
+  objects that are only requested once (like objects loaded by a scan over a large
+  area). Both caches can hold the complete working set plus some spare room.
+  Hit rate for the working set is measured.
+  */
+void TestScanResistance()
+{
+  std::cout << "*** Working set hit rate while scanning ***" << std::endl;
+
+  Data2Ref sample;
+
+  sample->value2.resize(100,0);
+
+  Data2Cache       cache(workingSetSize*3/2);
+  Data2ObjectCache objectCache(workingSetSize*3/2*(GetData2Size(sample)+256));
+  size_t           cacheHits=0;
+  size_t           objectCacheHits=0;
+  size_t           scanId=workingSetSize;
+  size_t           seed=1;
+
+  osmscout::StopClock timer;
+
+  for (size_t r=0; r<workingSetRequests; r++) {
+    size_t               key=(NextRandom(seed)*32768+NextRandom(seed)) % workingSetSize;
+    Data2Cache::CacheRef entry;
+
+    if (cache.GetEntry(key,entry)) {
+      cacheHits++;
+    }
+    else {
+      Data2Ref data;
+
+      data->value2.resize(100,key);
+
+      cache.SetEntry(Data2Cache::CacheEntry(key,data));
+    }
+
+    for (size_t i=0; i<scanRequests; i++) {
+      if (!cache.GetEntry(scanId,entry)) {
+        Data2Ref data;
+
+        data->value2.resize(100,scanId);
+
+        cache.SetEntry(Data2Cache::CacheEntry(scanId,data));
+      }
+
+      scanId++;
+    }
+  }
+
+  timer.Stop();
+
+  std::cout << "Cache hit rate: " << cacheHits*100/workingSetRequests << "%, time: " << timer << std::endl;
+
+  scanId=workingSetSize;
+  seed=1;
+
+  osmscout::StopClock objectTimer;
+
+  for (size_t r=0; r<workingSetRequests; r++) {
+    size_t   key=(NextRandom(seed)*32768+NextRandom(seed)) % workingSetSize;
+    Data2Ref data;
+
+    if (objectCache.GetEntry(key,data)) {
+      objectCacheHits++;
+    }
+    else {
+      data->value2.resize(100,key);
+
+      objectCache.SetEntry(key,data,GetData2Size(data));
+    }
+
+    for (size_t i=0; i<scanRequests; i++) {
+      Data2Ref scanData;
+
+      if (!objectCache.GetEntry(scanId,scanData)) {
+        scanData->value2.resize(100,scanId);
+
+        objectCache.SetEntry(scanId,scanData,GetData2Size(scanData));
+      }
+
+      scanId++;
+    }
+  }
+
+  objectTimer.Stop();
+
+  std::cout << "ObjectCache hit rate: " << objectCacheHits*100/workingSetRequests << "%, time: " << objectTimer << std::endl;
+  objectCache.DumpStatistics("ObjectCache");
+}
+
+#if defined(OSMSCOUT_HAVE_THREAD)
+static const size_t threadCount=8;
+static const size_t threadRequests=1000000;
+static const size_t threadKeyRange=32768;
+
+/**
+  Random requests from one thread against a Cache guarded by a single mutex
+  */
+void CacheWorker(Data2Cache* cache,
+                 osmscout::Mutex* mutex,
+                 size_t seed)
+{
+  for (size_t r=0; r<threadRequests; r++) {
+    size_t   key=NextRandom(seed) % threadKeyRange;
+    Data2Ref data;
+    bool     found;
+
+    {
+      osmscout::MutexLocker locker(*mutex);
+      Data2Cache::CacheRef  entry;
+
+      found=cache->GetEntry(key,entry);
+
+      if (found) {
+        data=entry->value;
+      }
+    }
+
+    if (!found) {
+      data->value=key;
+      data->value2.resize(10,key);
+
+      osmscout::MutexLocker locker(*mutex);
+
+      cache->SetEntry(Data2Cache::CacheEntry(key,data));
+    }
+  }
+}
+
+/**
+  Random requests from one thread against a (internally synchronized) ObjectCache
+  */
+void ObjectCacheWorker(Data2ObjectCache* cache,
+                       size_t seed)
+{
+  for (size_t r=0; r<threadRequests; r++) {
+    size_t   key=NextRandom(seed) % threadKeyRange;
+    Data2Ref data;
+
+    if (!cache->GetEntry(key,data)) {
+      data->value=key;
+      data->value2.resize(10,key);
+
+      cache->SetEntry(key,data,GetData2Size(data));
+    }
+  }
+}
+
+void TestThreads()
+{
+  std::cout << "*** Concurrent access from " << threadCount << " threads ***" << std::endl;
+
+  Data2Ref sample;
+
+  sample->value2.resize(10,0);
+
+  Data2Cache       cache(threadKeyRange/2);
+  osmscout::Mutex  mutex;
+  Data2ObjectCache objectCache(threadKeyRange/2*(GetData2Size(sample)+256));
+
+  std::vector<std::thread> threads;
+
+  osmscout::StopClock cacheTimer;
+
+  for (size_t t=0; t<threadCount; t++) {
+    threads.push_back(std::thread(CacheWorker,&cache,&mutex,t+1));
+  }
+
+  for (size_t t=0; t<threadCount; t++) {
+    threads[t].join();
+  }
+
+  cacheTimer.Stop();
+
+  threads.clear();
+
+  osmscout::StopClock objectCacheTimer;
+
+  for (size_t t=0; t<threadCount; t++) {
+    threads.push_back(std::thread(ObjectCacheWorker,&objectCache,t+1));
+  }
+
+  for (size_t t=0; t<threadCount; t++) {
+    threads[t].join();
+  }
+
+  objectCacheTimer.Stop();
+
+  std::cout << "Cache with global lock: " << cacheTimer << std::endl;
+  std::cout << "ObjectCache: " << objectCacheTimer << std::endl;
+  objectCache.DumpStatistics("ObjectCache");
+}
+#endif
+
 int main(int argc, char* argv[])
 {
   TestData();
   TestData2();
+  TestData2ObjectCache();
+  TestScanResistance();
+#if defined(OSMSCOUT_HAVE_THREAD)
+  TestThreads();
+#endif
 
   return 0;
 }
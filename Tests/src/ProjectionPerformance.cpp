@@ -0,0 +1,157 @@
+/*
+  ProjectionPerformance - a test program for libosmscout
+  Copyright (C) 2013  Tim Teulings
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+#include <osmscout/util/Projection.h>
+#include <osmscout/util/StopClock.h>
+#include <osmscout/util/Transformation.h>
+
+/**
+  Transform a number of ways around a map center to pixel coordinates,
+  using the single coordinate call, the BatchTransformer, the batch call of
+  the projection and TransPolygon (which uses the batch call) and compare
+  the runtime.
+*/
+
+#define WAY_COUNT   10000
+#define NODE_COUNT  100
+#define ROUNDS      20
+
+int main(int argc, char* argv[])
+{
+  osmscout::MercatorProjection              projection;
+  osmscout::Magnification                   magnification;
+  std::vector<std::vector<osmscout::GeoCoord> > ways;
+  std::vector<double>                       xs(NODE_COUNT);
+  std::vector<double>                       ys(NODE_COUNT);
+  double                                    sum;
+
+  magnification.SetLevel(15);
+
+  projection.Set(7.46,51.57,magnification,1024,768);
+
+  ways.resize(WAY_COUNT);
+
+  for (size_t w=0; w<ways.size(); w++) {
+    double lat=51.57+(rand()/(RAND_MAX+1.0)-0.5)/50.0;
+    double lon=7.46+(rand()/(RAND_MAX+1.0)-0.5)/50.0;
+
+    for (size_t n=0; n<NODE_COUNT; n++) {
+      lat+=(rand()/(RAND_MAX+1.0)-0.5)/10000.0;
+      lon+=(rand()/(RAND_MAX+1.0)-0.5)/10000.0;
+
+      ways[w].push_back(osmscout::GeoCoord(lat,lon));
+    }
+  }
+
+  sum=0.0;
+
+  osmscout::StopClock singleTimer;
+
+  for (size_t r=0; r<ROUNDS; r++) {
+    for (size_t w=0; w<ways.size(); w++) {
+      for (size_t n=0; n<ways[w].size(); n++) {
+        projection.GeoToPixel(ways[w][n].GetLon(),
+                              ways[w][n].GetLat(),
+                              xs[n],
+                              ys[n]);
+      }
+
+      sum+=xs[0]+ys[NODE_COUNT-1];
+    }
+  }
+
+  singleTimer.Stop();
+
+  std::cout << "Checksum single: " << sum << std::endl;
+
+  sum=0.0;
+
+  osmscout::StopClock batchTransformerTimer;
+
+  for (size_t r=0; r<ROUNDS; r++) {
+    for (size_t w=0; w<ways.size(); w++) {
+      {
+        osmscout::Projection::BatchTransformer batchTransformer(projection);
+
+        for (size_t n=0; n<ways[w].size(); n++) {
+          batchTransformer.GeoToPixel(ways[w][n],
+                                      xs[n],
+                                      ys[n]);
+        }
+      }
+
+      sum+=xs[0]+ys[NODE_COUNT-1];
+    }
+  }
+
+  batchTransformerTimer.Stop();
+
+  std::cout << "Checksum BatchTransformer: " << sum << std::endl;
+
+  sum=0.0;
+
+  osmscout::StopClock batchTimer;
+
+  for (size_t r=0; r<ROUNDS; r++) {
+    for (size_t w=0; w<ways.size(); w++) {
+      projection.GeoToPixel(&ways[w][0],
+                            ways[w].size(),
+                            &xs[0],
+                            &ys[0],
+                            sizeof(double));
+
+      sum+=xs[0]+ys[NODE_COUNT-1];
+    }
+  }
+
+  batchTimer.Stop();
+
+  std::cout << "Checksum batch: " << sum << std::endl;
+
+  sum=0.0;
+
+  osmscout::TransPolygon polygon;
+  osmscout::StopClock    polygonTimer;
+
+  for (size_t r=0; r<ROUNDS; r++) {
+    for (size_t w=0; w<ways.size(); w++) {
+      polygon.TransformWay(projection,
+                           osmscout::TransPolygon::none,
+                           ways[w],
+                           0.0);
+
+      sum+=polygon.points[0].x+polygon.points[NODE_COUNT-1].y;
+    }
+  }
+
+  polygonTimer.Stop();
+
+  std::cout << "Checksum TransPolygon: " << sum << std::endl;
+
+  std::cout << "Transforming " << ROUNDS*WAY_COUNT*NODE_COUNT << " coordinates one by one took " << singleTimer << std::endl;
+  std::cout << "Transforming " << ROUNDS*WAY_COUNT*NODE_COUNT << " coordinates using BatchTransformer took " << batchTransformerTimer << std::endl;
+  std::cout << "Transforming " << ROUNDS*WAY_COUNT*NODE_COUNT << " coordinates using the batch call took " << batchTimer << std::endl;
+  std::cout << "Transforming " << ROUNDS*WAY_COUNT*NODE_COUNT << " coordinates using TransPolygon took " << polygonTimer << std::endl;
+
+  return 0;
+}
@@ -0,0 +1,448 @@
+#ifndef OSMSCOUT_IMPORT_EXTERNALSORT_H
+#define OSMSCOUT_IMPORT_EXTERNALSORT_H
+
+/*
+  This source is part of the libosmscout library
+  Copyright (C) 2013  Tim Teulings
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+#include <algorithm>
+#include <functional>
+#include <string>
+#include <vector>
+
+#if defined(_OPENMP)
+  #include <omp.h>
+#endif
+
+#include <osmscout/private/ImportImportExport.h>
+
+#include <osmscout/system/Assert.h>
+#include <osmscout/system/Types.h>
+
+#include <osmscout/util/FileScanner.h>
+#include <osmscout/util/FileWriter.h>
+
+namespace osmscout {
+
+  /**
+    Temporary file holding the sorted runs of an ExternalSorter.
+
+    A run is written as a sequence of blocks. Each block starts with its size
+    in bytes and the number of records followed by the records. If
+    compression is enabled, each record is stored as a bitmask of the bytes
+    differing from the previous record of the block followed by these bytes.
+    Since records of a run are sorted, neighbouring records usually share
+    most of their key bytes.
+    */
+  class OSMSCOUT_IMPORT_API SortRunFile
+  {
+  public:
+    /**
+      Position of a run within the file
+      */
+    struct Run
+    {
+      FileOffset offset;    //! Offset of the first block
+      FileOffset endOffset; //! Offset behind the last block
+    };
+
+  private:
+    std::string         filename;
+    size_t              recordSize;
+    bool                compress;
+    FileWriter          writer;
+    mutable FileScanner scanner;
+    std::vector<char>   buffer;
+
+  private:
+    void EncodeBlock(const char* records,
+                     size_t count);
+    bool DecodeBlock(size_t count,
+                     std::vector<char>& records) const;
+
+  public:
+    SortRunFile();
+    virtual ~SortRunFile();
+
+    bool Open(const std::string& filename,
+              size_t recordSize,
+              bool compress);
+    bool WriteRun(const char* records,
+                  size_t count,
+                  Run& run);
+    bool StartReading();
+    bool ReadBlock(FileOffset& offset,
+                   std::vector<char>& records,
+                   size_t& count);
+    bool Close();
+  };
+
+  /**
+    Sorting of an arbitrary number of fixed size records with bounded memory
+    usage.
+
+    Records are collected in blocks of blockSize records. Each full block is
+    sorted in memory and written as one or more sorted runs (if the library
+    is built with OpenMP support, the block is split into one run per thread
+    and the runs are sorted in parallel) into a temporary file. After all
+    records have been added, the runs are merged using a loser tree.
+
+    Records must be plain data without pointers, they are copied byte by byte
+    into the temporary file. The sort is stable, records that compare equal
+    are returned in the order they were added.
+
+    Usage:
+
+    * Open()
+    * Add() for each record
+    * Sort()
+    * Next() until it returns false
+    * Close()
+    */
+  template<class R, class Less=std::less<R> >
+  class ExternalSorter
+  {
+  private:
+    /**
+      Reading position within a run during merging
+      */
+    struct RunCursor
+    {
+      FileOffset        offset;
+      FileOffset        endOffset;
+      std::vector<char> records;
+      size_t            count;
+      size_t            pos;
+      bool              exhausted;
+
+      inline const R& GetRecord() const
+      {
+        return *reinterpret_cast<const R*>(&records[pos*sizeof(R)]);
+      }
+    };
+
+  private:
+    SortRunFile                    runFile;
+    size_t                         blockSize;
+    Less                           less;
+    bool                           hasError;
+
+    std::vector<R>                 records;
+    std::vector<SortRunFile::Run>  runs;
+
+    std::vector<RunCursor>         cursors;
+    std::vector<size_t>            tree;     //! Loser tree, tree[0] holds the current winner
+
+  private:
+    bool WriteRuns();
+    bool Advance(RunCursor& cursor);
+    bool Beats(size_t a,
+               size_t b) const;
+    void Adjust(size_t run);
+
+  public:
+    ExternalSorter(size_t blockSize,
+                   const Less& less=Less());
+
+    bool Open(const std::string& filename,
+              bool compressRuns);
+    bool Add(const R& record);
+    bool Sort();
+    bool Next(R& record);
+    bool Close();
+
+    inline bool HasError() const
+    {
+      return hasError;
+    }
+
+    inline size_t GetRunCount() const
+    {
+      return runs.size();
+    }
+  };
+
+  template<class R, class Less>
+  ExternalSorter<R,Less>::ExternalSorter(size_t blockSize,
+                                         const Less& less)
+  : blockSize(std::max((size_t)1,blockSize)),
+    less(less),
+    hasError(false)
+  {
+    // no code
+  }
+
+  template<class R, class Less>
+  bool ExternalSorter<R,Less>::Open(const std::string& filename,
+                                    bool compressRuns)
+  {
+    hasError=false;
+    records.clear();
+    runs.clear();
+    cursors.clear();
+    tree.clear();
+
+    if (!runFile.Open(filename,
+                      sizeof(R),
+                      compressRuns)) {
+      hasError=true;
+      return false;
+    }
+
+    return true;
+  }
+
+  /**
+    Sort the collected records and write them as runs.
+    */
+  template<class R, class Less>
+  bool ExternalSorter<R,Less>::WriteRuns()
+  {
+    if (records.empty()) {
+      return true;
+    }
+
+    size_t chunkCount=1;
+
+#if defined(_OPENMP)
+    chunkCount=std::max(1,omp_get_max_threads());
+#endif
+
+    size_t chunkSize=(records.size()+chunkCount-1)/chunkCount;
+
+    chunkCount=(records.size()+chunkSize-1)/chunkSize;
+
+#pragma omp parallel for
+    for (int c=0; c<(int)chunkCount; c++) {
+      size_t start=c*chunkSize;
+      size_t end=std::min(start+chunkSize,records.size());
+
+      std::stable_sort(records.begin()+start,
+                       records.begin()+end,
+                       less);
+    }
+
+    for (size_t c=0; c<chunkCount; c++) {
+      size_t           start=c*chunkSize;
+      size_t           end=std::min(start+chunkSize,records.size());
+      SortRunFile::Run run;
+
+      if (!runFile.WriteRun(reinterpret_cast<const char*>(&records[start]),
+                            end-start,
+                            run)) {
+        hasError=true;
+        return false;
+      }
+
+      runs.push_back(run);
+    }
+
+    records.clear();
+
+    return true;
+  }
+
+  template<class R, class Less>
+  bool ExternalSorter<R,Less>::Add(const R& record)
+  {
+    records.push_back(record);
+
+    if (records.size()>=blockSize) {
+      return WriteRuns();
+    }
+
+    return true;
+  }
+
+  /**
+    Move the cursor to the next record of its run, reading the next block
+    if necessary.
+    */
+  template<class R, class Less>
+  bool ExternalSorter<R,Less>::Advance(RunCursor& cursor)
+  {
+    cursor.pos++;
+
+    while (cursor.pos>=cursor.count) {
+      if (cursor.offset>=cursor.endOffset) {
+        cursor.exhausted=true;
+        cursor.records.clear();
+        return true;
+      }
+
+      if (!runFile.ReadBlock(cursor.offset,
+                             cursor.records,
+                             cursor.count)) {
+        hasError=true;
+        return false;
+      }
+
+      cursor.pos=0;
+    }
+
+    return true;
+  }
+
+  /**
+    Return true, if the current record of run a comes before the current
+    record of run b. An index of cursors.size() denotes a virtual run,
+    that beats all others (used while building the tree).
+    */
+  template<class R, class Less>
+  bool ExternalSorter<R,Less>::Beats(size_t a,
+                                     size_t b) const
+  {
+    if (a==cursors.size()) {
+      return true;
+    }
+
+    if (b==cursors.size()) {
+      return false;
+    }
+
+    if (cursors[a].exhausted) {
+      return false;
+    }
+
+    if (cursors[b].exhausted) {
+      return true;
+    }
+
+    if (less(cursors[a].GetRecord(),cursors[b].GetRecord())) {
+      return true;
+    }
+
+    if (less(cursors[b].GetRecord(),cursors[a].GetRecord())) {
+      return false;
+    }
+
+    // Runs were written in the order of the records, so this keeps the
+    // sort stable
+    return a<b;
+  }
+
+  /**
+    Replay the matches on the path from the leaf of the given run to the
+    root of the loser tree.
+    */
+  template<class R, class Less>
+  void ExternalSorter<R,Less>::Adjust(size_t run)
+  {
+    size_t winner=run;
+    size_t node=(run+cursors.size())/2;
+
+    while (node>0) {
+      if (Beats(tree[node],winner)) {
+        std::swap(tree[node],winner);
+      }
+
+      node/=2;
+    }
+
+    tree[0]=winner;
+  }
+
+  /**
+    Write the remaining records and prepare merging of all runs.
+    */
+  template<class R, class Less>
+  bool ExternalSorter<R,Less>::Sort()
+  {
+    if (hasError) {
+      return false;
+    }
+
+    if (!WriteRuns()) {
+      return false;
+    }
+
+    std::vector<R>().swap(records);
+
+    if (!runFile.StartReading()) {
+      hasError=true;
+      return false;
+    }
+
+    cursors.resize(runs.size());
+
+    for (size_t r=0; r<runs.size(); r++) {
+      cursors[r].offset=runs[r].offset;
+      cursors[r].endOffset=runs[r].endOffset;
+      cursors[r].count=0;
+      cursors[r].exhausted=false;
+
+      // Position before the first record, so that Advance() loads the first
+      // block
+      cursors[r].pos=(size_t)-1;
+
+      if (!Advance(cursors[r])) {
+        return false;
+      }
+    }
+
+    tree.assign(std::max((size_t)1,cursors.size()),cursors.size());
+
+    for (size_t r=cursors.size(); r>0; r--) {
+      Adjust(r-1);
+    }
+
+    return true;
+  }
+
+  /**
+    Return the next record in sort order. Returns false, if there are no more
+    records or an error occured (see HasError()).
+    */
+  template<class R, class Less>
+  bool ExternalSorter<R,Less>::Next(R& record)
+  {
+    if (hasError ||
+        cursors.empty()) {
+      return false;
+    }
+
+    size_t winner=tree[0];
+
+    if (cursors[winner].exhausted) {
+      return false;
+    }
+
+    record=cursors[winner].GetRecord();
+
+    if (!Advance(cursors[winner])) {
+      return false;
+    }
+
+    Adjust(winner);
+
+    return true;
+  }
+
+  template<class R, class Less>
+  bool ExternalSorter<R,Less>::Close()
+  {
+    std::vector<R>().swap(records);
+    runs.clear();
+    cursors.clear();
+    tree.clear();
+
+    return runFile.Close() && !hasError;
+  }
+}
+
+#endif
@@ -25,6 +25,7 @@
 #include <map>
 
 #include <osmscout/import/Import.h>
+#include <osmscout/import/LowZoomSimplifier.h>
 
 #include <osmscout/Area.h>
 
@@ -72,7 +73,8 @@ namespace osmscout {
     };
 
   private:
-    void GetAreaTypesToOptimize(const TypeConfig& typeConfig,
+    void GetAreaTypesToOptimize(const ImportParameter& parameter,
+                                const TypeConfig& typeConfig,
                                 std::set<TypeId>& types);
 
     bool WriteTypeData(FileWriter& writer,
@@ -109,7 +111,8 @@ namespace osmscout {
                      const std::set<TypeId>& types,
                      std::list<TypeData>& typesData);
 
-    void OptimizeAreas(const std::list<AreaRef>& areas,
+    void OptimizeAreas(LowZoomSimplifier& simplifier,
+                       const std::list<AreaRef>& areas,
                        std::list<AreaRef>& optimizedAreas,
                        size_t width,
                        size_t height,
@@ -25,6 +25,7 @@
 #include <map>
 
 #include <osmscout/import/Import.h>
+#include <osmscout/import/LowZoomSimplifier.h>
 
 #include <osmscout/Area.h>
 #include <osmscout/Way.h>
@@ -73,7 +74,8 @@ namespace osmscout {
     };
 
   private:
-    void GetWayTypesToOptimize(const TypeConfig& typeConfig,
+    void GetWayTypesToOptimize(const ImportParameter& parameter,
+                               const TypeConfig& typeConfig,
                                std::set<TypeId>& types);
 
     bool WriteTypeData(FileWriter& writer,
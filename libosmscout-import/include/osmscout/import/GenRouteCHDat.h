@@ -0,0 +1,104 @@
+#ifndef OSMSCOUT_IMPORT_GENROUTECHDAT_H
+#define OSMSCOUT_IMPORT_GENROUTECHDAT_H
+
+/*
+  This source is part of the libosmscout library
+  Copyright (C) 2013  Tim Teulings
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+#include <string>
+#include <vector>
+
+#include <osmscout/ContractionHierarchy.h>
+#include <osmscout/RoutingProfile.h>
+#include <osmscout/Types.h>
+
+#include <osmscout/util/PriorityQueue.h>
+
+#include <osmscout/import/Import.h>
+
+namespace osmscout {
+
+  /**
+    Generates a contraction hierarchy for the routing graph of the given vehicle
+    (see ContractionHierarchy).
+
+    Nodes are contracted in the order of their edge difference (number of
+    shortcuts needed minus number of edges removed) plus the number of already
+    contracted neighbours. For each pair of neighbours a local Dijkstra search
+    (the witness search) decides, if the shortcut is necessary.
+
+    The costs are calculated using a FastestPathRoutingProfile for the vehicle.
+    The generator is only active, if ImportParameter::GetRouteCH() is true.
+    */
+  class RouteCHDataGenerator : public ImportModule
+  {
+  private:
+    typedef ContractionHierarchy::Edge Edge;
+
+    Vehicle                            vehicle;
+    std::string                        dataFilename;
+    std::string                        chFilename;
+
+    std::vector<std::vector<Edge> >    outEdges;      //! Edges to not yet contracted nodes by node index
+    std::vector<std::vector<Edge> >    inEdges;       //! Edges from not yet contracted nodes by node index (target is the source)
+    std::vector<uint32_t>              contractedNeighbours;
+
+    std::vector<uint64_t>              witnessCosts;  //! Costs of the witness search by node index
+    std::vector<uint32_t>              witnessTouched;
+    DAryHeap<4>                        witnessHeap;
+
+  private:
+    void ParametrizeProfile(const ImportParameter& parameter,
+                            const TypeConfig& typeConfig,
+                            Progress& progress,
+                            FastestPathRoutingProfile& profile) const;
+
+    bool LoadGraph(const ImportParameter& parameter,
+                   Progress& progress,
+                   const RoutingProfile& profile,
+                   std::vector<FileOffset>& nodeOffsets);
+
+    void AddEdge(uint32_t source,
+                 uint32_t target,
+                 uint64_t costs,
+                 uint32_t middle,
+                 uint32_t pathIndex);
+    void RemoveEdgesTo(std::vector<Edge>& edges,
+                       uint32_t target);
+
+    void RunWitnessSearch(uint32_t source,
+                          uint32_t skip,
+                          uint64_t maxCosts,
+                          size_t maxSettled);
+    size_t ContractNode(uint32_t node,
+                        bool simulate);
+    double GetPriority(uint32_t node);
+
+  public:
+    RouteCHDataGenerator(Vehicle vehicle,
+                         const std::string& dataFilename,
+                         const std::string& chFilename);
+
+    std::string GetDescription() const;
+    bool Import(const ImportParameter& parameter,
+                Progress& progress,
+                const TypeConfig& typeConfig);
+  };
+}
+
+#endif
@@ -0,0 +1,52 @@
+#ifndef OSMSCOUT_IMPORT_GENROUTEGRAPHDAT_H
+#define OSMSCOUT_IMPORT_GENROUTEGRAPHDAT_H
+
+/*
+  This source is part of the libosmscout library
+  Copyright (C) 2013  Tim Teulings
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+#include <string>
+
+#include <osmscout/Types.h>
+
+#include <osmscout/import/Import.h>
+
+namespace osmscout {
+
+  /**
+    Generates the compact routing graph (see RouteGraph) for the routing graph
+    file of the given vehicle.
+    */
+  class RouteGraphDataGenerator : public ImportModule
+  {
+  private:
+    std::string dataFilename;
+    std::string graphFilename;
+
+  public:
+    RouteGraphDataGenerator(const std::string& dataFilename,
+                            const std::string& graphFilename);
+
+    std::string GetDescription() const;
+    bool Import(const ImportParameter& parameter,
+                Progress& progress,
+                const TypeConfig& typeConfig);
+  };
+}
+
+#endif
@@ -80,7 +80,9 @@ namespace osmscout {
                   const TypeConfig& typeConfig,
                   FileWriter& writer,
                   uint32_t& writtenWayCount,
-                  const CoordDataFile::CoordResultMap& coordsMap,
+                  const std::vector<OSMId>& nodeIds,
+                  const std::vector<Point>& coords,
+                  const std::vector<bool>& found,
                   const RawWay& rawWay);
 
   public:
@@ -20,6 +20,8 @@
   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
 */
 
+#include <list>
+#include <map>
 #include <string>
 
 #include <osmscout/ImportFeatures.h>
@@ -49,23 +51,29 @@ namespace osmscout {
     std::string                  destinationDirectory;     //! Name of the destination directory
     size_t                       startStep;                //! Starting step for import
     size_t                       endStep;                  //! End step for import
+    size_t                       moduleThreadCount;        //! Number of import steps executed in parallel
+
+    size_t                       preprocessThreadCount;    //! Number of threads for decoding PBF files
 
     bool                         strictAreas;              //! Assure that areas conform to "simple" definition
 
     bool                         sortObjects;              //! Sort all objects
     size_t                       sortBlockSize;            //! Number of entries loaded in one sort iteration
     size_t                       sortTileMag;              //! Zoom level for individual sorting cells
+    bool                         sortCompressRuns;         //! Compress the temporary sort runs
 
     size_t                       numericIndexPageSize;     //! Size of an numeric index page in bytes
 
     bool                         coordDataMemoryMaped;     //! Use memory mapping for coord data file access
+    bool                         coordDataCompressed;      //! Write the coord data file using compressed blocks (not readable by older versions, so off by default)
+    bool                         coordDeltaEncoding;       //! Write the nodes of ways and areas delta encoded (not readable by older versions, so off by default)
 
     bool                         rawNodeDataMemoryMaped;   //! Use memory mapping for raw node data file access
     size_t                       rawNodeDataCacheSize;     //! Size of the raw node data cache
 
     bool                         rawWayIndexMemoryMaped;   //! Use memory mapping for raw way index file access
     bool                         rawWayDataMemoryMaped;    //! Use memory mapping for raw way data file access
-    size_t                       rawWayDataCacheSize;      //! Size of the raw way data cache
+    size_t                       rawWayDataCacheSizeBytes; //! Size of the raw way data cache in bytes
     size_t                       rawWayIndexCacheSize;     //! Size of the raw way index cache
     size_t                       rawWayBlockSize;          //! Number of ways loaded during import until nodes get resolved
 
@@ -96,9 +104,17 @@ namespace osmscout {
     size_t                       optimizationCellSizeAverage; //! Average entries per index cell
     size_t                       optimizationCellSizeMax;  //! Maximum number of entries  per index cell
     TransPolygon::OptimizeMethod optimizationWayMethod;    //! what method to use to optimize ways
+    bool                         optimizationAllTypes;     //! Optimize all area and way types, not only types marked with OPTIMIZE_LOW_ZOOM (faster low zoom rendering, but much larger areasopt.dat and waysopt.dat)
+    size_t                       optimizationLevelStep;    //! Distance between the optimized magnification levels of types not marked with OPTIMIZE_LOW_ZOOM
 
     size_t                       routeNodeBlockSize;       //! Number of route nodes loaded during import until ways get resolved
 
+    bool                         routeGraph;               //! Generate the compact routing graphs (see RouteGraph)
+
+    bool                         routeCH;                  //! Generate a contraction hierarchy for car routing
+    std::map<std::string,double> routeCHSpeedTable;        //! Speed by type name for the contraction hierarchy
+    double                       routeCHMaxSpeed;          //! Maximum speed of the car for the contraction hierarchy
+
     bool                         assumeLand;               //! During sea/land detection,we either trust coastlines only or make some
                                                            //! assumptions which tiles are sea and which are land.
 
@@ -111,23 +127,29 @@ namespace osmscout {
 
     size_t GetStartStep() const;
     size_t GetEndStep() const;
+    size_t GetModuleThreadCount() const;
+
+    size_t GetPreprocessThreadCount() const;
 
     bool GetStrictAreas() const;
 
     bool GetSortObjects() const;
     size_t GetSortBlockSize() const;
     size_t GetSortTileMag() const;
+    bool GetSortCompressRuns() const;
 
     size_t GetNumericIndexPageSize() const;
 
     bool GetCoordDataMemoryMaped() const;
+    bool GetCoordDataCompressed() const;
+    bool GetCoordDeltaEncoding() const;
 
     bool GetRawNodeDataMemoryMaped() const;
     size_t GetRawNodeDataCacheSize() const;
 
     bool GetRawWayIndexMemoryMaped() const;
     bool GetRawWayDataMemoryMaped() const;
-    size_t GetRawWayDataCacheSize() const;
+    size_t GetRawWayDataCacheSizeBytes() const;
     size_t GetRawWayIndexCacheSize() const;
     size_t GetRawWayBlockSize() const;
 
@@ -158,9 +180,17 @@ namespace osmscout {
     size_t GetOptimizationCellSizeAverage() const;
     size_t GetOptimizationCellSizeMax() const;
     TransPolygon::OptimizeMethod GetOptimizationWayMethod() const;
+    bool GetOptimizationAllTypes() const;
+    size_t GetOptimizationLevelStep() const;
 
     size_t GetRouteNodeBlockSize() const;
 
+    bool GetRouteGraph() const;
+
+    bool GetRouteCH() const;
+    const std::map<std::string,double>& GetRouteCHSpeedTable() const;
+    double GetRouteCHMaxSpeed() const;
+
     bool GetAssumeLand() const;
 
     void SetMapfile(const std::string& mapfile);
@@ -169,23 +199,29 @@ namespace osmscout {
 
     void SetStartStep(size_t startStep);
     void SetSteps(size_t startStep, size_t endStep);
+    void SetModuleThreadCount(size_t moduleThreadCount);
+
+    void SetPreprocessThreadCount(size_t preprocessThreadCount);
 
     void SetStrictAreas(bool strictAreas);
 
     void SetSortObjects(bool sortObjects);
     void SetSortBlockSize(size_t sortBlockSize);
     void SetSortTileMag(size_t sortTileMag);
+    void SetSortCompressRuns(bool sortCompressRuns);
 
     void SetNumericIndexPageSize(size_t numericIndexPageSize);
 
     void SetCoordDataMemoryMaped(bool memoryMaped);
+    void SetCoordDataCompressed(bool compressed);
+    void SetCoordDeltaEncoding(bool deltaEncoding);
 
     void SetRawNodeDataMemoryMaped(bool memoryMaped);
     void SetRawNodeDataCacheSize(size_t nodeDataCacheSize);
 
     void SetRawWayIndexMemoryMaped(bool memoryMaped);
     void SetRawWayDataMemoryMaped(bool memoryMaped);
-    void SetRawWayDataCacheSize(size_t wayDataCacheSize);
+    void SetRawWayDataCacheSizeBytes(size_t wayDataCacheSizeBytes);
     void SetRawWayIndexCacheSize(size_t wayIndexCacheSize);
     void SetRawWayBlockSize(size_t blockSize);
 
@@ -216,9 +252,17 @@ namespace osmscout {
     void SetOptimizationCellSizeAverage(size_t optimizationCellSizeAverage);
     void SetOptimizationCellSizeMax(size_t optimizationCellSizeMax);
     void SetOptimizationWayMethod(TransPolygon::OptimizeMethod optimizationWayMethod);
+    void SetOptimizationAllTypes(bool optimizationAllTypes);
+    void SetOptimizationLevelStep(size_t optimizationLevelStep);
 
     void SetRouteNodeBlockSize(size_t blockSize);
 
+    void SetRouteGraph(bool routeGraph);
+
+    void SetRouteCH(bool routeCH);
+    void SetRouteCHSpeedTable(const std::map<std::string,double>& speedTable);
+    void SetRouteCHMaxSpeed(double maxSpeed);
+
     void SetAssumeLand(bool assumeLand);
   };
 
@@ -228,11 +272,26 @@ namespace osmscout {
     An import consists of a number of sequentially executed steps. A step normally
     works on one object type and generates one output file (though this is just
     an suggestion). Such a step is realized by a ImportModule.
+
+    Each module declares the files (relative to the destination directory) it
+    reads and writes. Steps that do not depend on each other via these files
+    may be executed in parallel (see ImportParameter::SetModuleThreadCount()).
     */
   class OSMSCOUT_IMPORT_API ImportModule
   {
+  private:
+    std::list<std::string> requiredFiles; //! Files read by the module
+    std::list<std::string> providedFiles; //! Files written by the module
+
   public:
     virtual ~ImportModule();
+
+    ImportModule& Requires(const std::string& filename);
+    ImportModule& Provides(const std::string& filename);
+
+    const std::list<std::string>& GetRequiredFiles() const;
+    const std::list<std::string>& GetProvidedFiles() const;
+
     virtual std::string GetDescription() const = 0;
     virtual bool Import(const ImportParameter& parameter,
                         Progress& progress,
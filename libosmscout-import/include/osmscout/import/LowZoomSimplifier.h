@@ -0,0 +1,97 @@
+#ifndef OSMSCOUT_IMPORT_LOWZOOMSIMPLIFIER_H
+#define OSMSCOUT_IMPORT_LOWZOOMSIMPLIFIER_H
+
+/*
+  This source is part of the libosmscout library
+  Copyright (C) 2013  Tim Teulings
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+#include <utility>
+#include <vector>
+
+#include <osmscout/private/ImportImportExport.h>
+
+#include <osmscout/GeoCoord.h>
+#include <osmscout/TypeConfig.h>
+
+#include <osmscout/import/Import.h>
+
+#include <osmscout/util/Projection.h>
+#include <osmscout/util/Transformation.h>
+
+namespace osmscout {
+
+  /**
+    Simplifies area rings for the low zoom optimizations (see
+    OptimizeAreasLowZoomGenerator) while preserving the topology of shared
+    borders. Also decides which types and magnification levels get low zoom
+    data (for areas and ways).
+
+    The rings of all areas are registered using AddRing() first. Junctions,
+    nodes where the borders of rings meet or split, are never dropped. The
+    parts of a ring between two junctions are simplified on their own and
+    always in the same direction, so a border shared by two areas is
+    simplified identically for both areas and does not open gaps or
+    overlaps at low zoom.
+    */
+  class OSMSCOUT_IMPORT_API LowZoomSimplifier
+  {
+  private:
+    std::vector<std::pair<Id,Id> > edges;     //! Edges of the rings registered, cleared by CalculateJunctions()
+    std::vector<Id>                junctions; //! Sorted ids of the junctions
+    std::vector<GeoCoord>          chain;     //! Scratch buffer for the nodes of one part of a ring
+    std::vector<bool>              keep;      //! Scratch buffer for the nodes to keep
+    TransPolygon                   polygon;
+
+  private:
+    bool IsJunction(Id id) const;
+
+    void SimplifyChain(const Projection& projection,
+                       TransPolygon::OptimizeMethod optimizeMethod,
+                       const std::vector<Id>& ids,
+                       const std::vector<GeoCoord>& nodes,
+                       size_t start,
+                       size_t count);
+
+    void GetKeptNodes(const Projection& projection,
+                      const std::vector<GeoCoord>& nodes,
+                      std::vector<GeoCoord>& simplified,
+                      double& width,
+                      double& height) const;
+
+  public:
+    void Clear();
+    void AddRing(const std::vector<Id>& ids);
+    void CalculateJunctions();
+
+    void SimplifyRing(const Projection& projection,
+                      TransPolygon::OptimizeMethod optimizeMethod,
+                      const std::vector<Id>& ids,
+                      const std::vector<GeoCoord>& nodes,
+                      std::vector<GeoCoord>& simplified,
+                      double& width,
+                      double& height);
+
+    static bool IsTypeToOptimize(const ImportParameter& parameter,
+                                 const TypeInfo& type);
+    static void GetOptimizationLevels(const ImportParameter& parameter,
+                                      const TypeInfo& type,
+                                      std::vector<uint32_t>& levels);
+  };
+}
+
+#endif
@@ -33,41 +33,53 @@ namespace osmscout {
     typedef OSMSCOUT_HASHMAP<PageId,FileOffset> CoordPageOffsetMap;
 
   private:
-    FileWriter          nodeWriter;
-    FileWriter          wayWriter;
-    FileWriter          relationWriter;
-    FileWriter          coastlineWriter;
-
-    std::vector<Tag>    tags;
-
-    uint32_t            nodeCount;
-    uint32_t            wayCount;
-    uint32_t            areaCount;
-    uint32_t            relationCount;
-    uint32_t            coastlineCount;
-
-    OSMId               lastNodeId;
-    OSMId               lastWayId;
-    OSMId               lastRelationId;
-
-    bool                nodeSortingError;
-    bool                waySortingError;
-    bool                relationSortingError;
-
-    Id                  coordPageCount;
-    CoordPageOffsetMap  coordIndex;
-    FileWriter          coordWriter;
-    PageId              currentPageId;
-    FileOffset          currentPageOffset;
-    std::vector<double> lats;
-    std::vector<double> lons;
-    std::vector<bool>   isSet;
+    FileWriter              nodeWriter;
+    FileWriter              wayWriter;
+    FileWriter              relationWriter;
+    FileWriter              coastlineWriter;
+
+    std::vector<Tag>        tags;
+
+    uint32_t                nodeCount;
+    uint32_t                wayCount;
+    uint32_t                areaCount;
+    uint32_t                relationCount;
+    uint32_t                coastlineCount;
+
+    OSMId                   lastNodeId;
+    OSMId                   lastWayId;
+    OSMId                   lastRelationId;
+
+    bool                    nodeSortingError;
+    bool                    waySortingError;
+    bool                    relationSortingError;
+
+    Id                      coordPageCount;
+    CoordPageOffsetMap      coordIndex;
+    FileWriter              coordWriter;
+    PageId                  currentPageId;
+    FileOffset              currentPageOffset;
+    std::vector<double>     lats;
+    std::vector<double>     lons;
+    std::vector<bool>       isSet;
+
+    bool                    coordCompressed;
+    uint32_t                coordCount;
+    std::vector<OSMId>      blockIds;
+    std::vector<FileOffset> blockOffsets;
+    std::vector<OSMId>      blockEntryIds;
+    std::vector<uint32_t>   blockLats;
+    std::vector<uint32_t>   blockLons;
+    std::vector<char>       blockBuffer;
 
   private:
     bool StoreCurrentPage();
+    bool StoreCurrentBlock();
     bool StoreCoord(OSMId id,
                     double lat,
                     double lon);
+    bool WriteCoordPageIndex();
+    bool WriteCoordBlockDirectory();
 
   public:
     std::string GetDescription() const;
@@ -80,15 +92,15 @@ namespace osmscout {
     void ProcessNode(const TypeConfig& typeConfig,
                      const OSMId& id,
                      const double& lon, const double& lat,
-                     const std::map<TagId,std::string>& tags);
+                     const TagView& tags);
     void ProcessWay(const TypeConfig& typeConfig,
                     const OSMId& id,
                     std::vector<OSMId>& nodes,
-                    const std::map<TagId,std::string>& tags);
+                    const TagView& tags);
     void ProcessRelation(const TypeConfig& typeConfig,
                          const OSMId& id,
                          const std::vector<RawRelation::Member>& members,
-                         const std::map<TagId,std::string>& tags);
+                         const TagView& tags);
 
     bool Cleanup(Progress& progress);
   };
@@ -20,6 +20,7 @@
   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
 */
 
+#include <cstdio>
 #include <map>
 #include <string>
 #include <vector>
@@ -38,26 +39,92 @@ namespace osmscout {
   class PreprocessPBF : public Preprocess
   {
   private:
-    std::map<TagId,std::string>      tagMap;
+    struct NodeData
+    {
+      OSMId  id;
+      double lon;
+      double lat;
+      size_t tagsStart;
+      size_t tagsEnd;
+    };
+
+    struct WayData
+    {
+      OSMId  id;
+      size_t nodesStart;
+      size_t nodesEnd;
+      size_t tagsStart;
+      size_t tagsEnd;
+    };
+
+    struct RelationData
+    {
+      OSMId  id;
+      size_t membersStart;
+      size_t membersEnd;
+      size_t tagsStart;
+      size_t tagsEnd;
+    };
+
+    /**
+      The decoded content of one primitive block, tags are already resolved.
+      Tags, way nodes and relation members of all objects are stored in
+      shared arrays, objects reference their range. Tag values point into
+      the string table of the block, so the block is kept, too.
+      */
+    struct BlockData
+    {
+      PBF::PrimitiveBlock              block;
+      std::vector<uint32_t>            keyIds;          //! Resolved tag id by string table index
+      TagBuffer                        tags;
+      std::vector<NodeData>            nodes;
+      std::vector<WayData>             ways;
+      std::vector<OSMId>               wayNodes;
+      std::vector<RelationData>        relations;
+      std::vector<RawRelation::Member> relationMembers;
+    };
+
+    struct Pipeline;
+
+  private:
     std::vector<OSMId>               nodes;
     std::vector<RawRelation::Member> members;
 
   private:
-    void ReadNodes(const TypeConfig& typeConfig,
-                   const PBF::PrimitiveBlock& block,
-                   const PBF::PrimitiveGroup &group);
-
-    void ReadDenseNodes(const TypeConfig& typeConfig,
-                        const PBF::PrimitiveBlock& block,
-                        const PBF::PrimitiveGroup &group);
-
-    void ReadWays(const TypeConfig& typeConfig,
-                  const PBF::PrimitiveBlock& block,
-                  const PBF::PrimitiveGroup &group);
-
-    void ReadRelations(const TypeConfig& typeConfig,
-                       const PBF::PrimitiveBlock& block,
-                       const PBF::PrimitiveGroup &group);
+    static TagId GetTagId(const TypeConfig& typeConfig,
+                          BlockData& data,
+                          uint32_t key);
+    static void ReadNodes(const TypeConfig& typeConfig,
+                          const PBF::PrimitiveGroup &group,
+                          BlockData& data);
+
+    static void ReadDenseNodes(const TypeConfig& typeConfig,
+                               const PBF::PrimitiveGroup &group,
+                               BlockData& data);
+
+    static void ReadWays(const TypeConfig& typeConfig,
+                         const PBF::PrimitiveGroup &group,
+                         BlockData& data);
+
+    static void ReadRelations(const TypeConfig& typeConfig,
+                              const PBF::PrimitiveGroup &group,
+                              BlockData& data);
+
+    static bool DecodeBlock(const TypeConfig& typeConfig,
+                            const std::string& blobData,
+                            BlockData& data,
+                            std::string& error);
+
+    void ProcessBlock(const TypeConfig& typeConfig,
+                      BlockData& data);
+
+    bool ReadBlocks(Progress& progress,
+                    const TypeConfig& typeConfig,
+                    FILE* file);
+    bool ReadBlocksParallel(const ImportParameter& parameter,
+                            Progress& progress,
+                            const TypeConfig& typeConfig,
+                            FILE* file);
 
   public:
     std::string GetDescription() const;
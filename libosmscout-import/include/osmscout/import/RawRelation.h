@@ -73,6 +73,8 @@ namespace osmscout {
     void SetId(OSMId id);
     void SetType(TypeId type);
 
+    unsigned long GetMemorySize() const;
+
     bool Read(FileScanner& scanner);
     bool Write(FileWriter& writer) const;
   };
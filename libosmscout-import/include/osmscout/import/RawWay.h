@@ -106,6 +106,8 @@ namespace osmscout {
     void SetTags(const std::vector<Tag>& tags);
     void SetNodes(const std::vector<OSMId>& nodes);
 
+    unsigned long GetMemorySize() const;
+
     bool Read(FileScanner& scanner);
     bool Write(FileWriter& writer) const;
   };
@@ -23,6 +23,7 @@
 #include <cmath>
 #include <list>
 
+#include <osmscout/import/ExternalSort.h>
 #include <osmscout/import/Import.h>
 
 #include <osmscout/DataFile.h>
@@ -46,36 +47,42 @@ namespace osmscout {
       FileScanner scanner;
     };
 
-    struct CellEntry
+    /**
+      Sort key and position of an entry. Entries are sorted by cell, then by
+      the top left coordinate and then by their position in the sources.
+      */
+    struct SortEntry
     {
-      Id                                   id;
-      typename std::list<Source>::iterator source;
-      FileOffset                           fileOffset;
-      double                               lat;
-      double                               lon;
-
-      inline CellEntry(Id id,
-                       const typename std::list<Source>::iterator source,
-                       FileOffset fileOffset,
-                       double lat,
-                       double lon)
-      : id(id),
-        source(source),
-        fileOffset(fileOffset),
-        lat(lat),
-        lon(lon)
-      {
-        // no code
-      }
+      uint64_t   cellIndex;
+      double     lon;
+      double     lat;
+      uint64_t   source;     //! Index of the source
+      FileOffset fileOffset; //! Offset of the entry in the source
+      uint64_t   id;
+    };
 
-      inline bool operator<(const CellEntry& other) const
+    struct SortEntryLess
+    {
+      inline bool operator()(const SortEntry& a,
+                             const SortEntry& b) const
       {
-        if (lon==other.lon) {
-          return lat>other.lat;
+        if (a.cellIndex!=b.cellIndex) {
+          return a.cellIndex<b.cellIndex;
+        }
+
+        if (a.lon!=b.lon) {
+          return a.lon<b.lon;
+        }
+
+        if (a.lat!=b.lat) {
+          return a.lat>b.lat;
         }
-        else {
-          return lon<other.lon;
+
+        if (a.source!=b.source) {
+          return a.source<b.source;
         }
+
+        return a.fileOffset<b.fileOffset;
       }
     };
 
@@ -129,6 +136,11 @@ namespace osmscout {
     sources.push_back(source);
   }
 
+  /**
+    Sort the entries of all sources by cell and position using an external
+    merge sort and write them in this order. Memory usage is bounded by the
+    sort block size.
+    */
   template <class N>
   bool SortDataGenerator<N>::Renumber(const ImportParameter& parameter,
                                       Progress& progress)
@@ -138,9 +150,12 @@ namespace osmscout {
     uint32_t    overallDataCount=0;
     uint32_t    dataCopyiedCount=0;
     double      zoomLevel=pow(2.0,(double)parameter.GetSortTileMag());
-    size_t      cellCount=zoomLevel*zoomLevel;
-    size_t      minIndex=0;
-    size_t      maxIndex=cellCount-1;
+    // Each generator uses its own temporary file, so that they can run in parallel
+    std::string runFilename=dataFilename.substr(0,dataFilename.rfind('.'))+"sort.tmp";
+
+    std::vector<typename std::list<Source>::iterator> sourceByIndex;
+
+    ExternalSorter<SortEntry,SortEntryLess>           sorter(parameter.GetSortBlockSize());
 
     progress.SetAction("Sorting data");
 
@@ -163,6 +178,7 @@ namespace osmscout {
       }
 
       overallDataCount+=dataCount;
+      sourceByIndex.push_back(source);
     }
 
 
@@ -172,6 +188,7 @@ namespace osmscout {
       return false;
     }
 
+    dataWriter.SetCoordDeltaEncoding(parameter.GetCoordDeltaEncoding());
     dataWriter.Write(overallDataCount);
 
     if (!mapWriter.Open(AppendFileToDir(parameter.GetDestinationDirectory(),
@@ -182,178 +199,141 @@ namespace osmscout {
 
     mapWriter.Write(overallDataCount);
 
-    while (true) {
-      progress.Info("Reading ways in cell range "+NumberToString(minIndex)+ "-"+NumberToString(maxIndex));
+    if (!sorter.Open(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                     runFilename),
+                     parameter.GetSortCompressRuns())) {
+      progress.Error("Cannot create '"+runFilename+"'");
+      return false;
+    }
 
-      size_t                                currentEntries=0;
-      std::map<size_t,std::list<CellEntry> > dataByCellMap;
+    for (size_t s=0; s<sourceByIndex.size(); s++) {
+      typename std::list<Source>::iterator source=sourceByIndex[s];
+      uint32_t                             dataCount;
 
-      for (typename std::list<Source>::iterator source=sources.begin();
-              source!=sources.end();
-              ++source) {
-        uint32_t dataCount;
-        progress.Info("Reading data from file '"+source->scanner.GetFilename()+"'");
+      progress.Info("Reading data from file '"+source->scanner.GetFilename()+"'");
 
-        if (!source->scanner.GotoBegin()) {
-          progress.Error(std::string("Error while setting current position in file '")+
+      if (!source->scanner.GotoBegin()) {
+        progress.Error(std::string("Error while setting current position in file '")+
+                       source->scanner.GetFilename()+"'");
+      }
+
+      if (!source->scanner.Read(dataCount)) {
+        progress.Error("Error while reading number of data entries in file'"+
+                       source->scanner.GetFilename()+"'");
+        return false;
+      }
+
+      for (uint32_t current=1; current<=dataCount; current++) {
+        Id  id;
+        N   data;
+
+        progress.SetProgress(current,dataCount);
+
+        if (!source->scanner.Read(id)) {
+          progress.Error(std::string("Error while reading data entry ")+
+                         NumberToString(current)+" of "+
+                         NumberToString(dataCount)+
+                         " in file '"+
                          source->scanner.GetFilename()+"'");
+
+          return false;
         }
 
-        if (!source->scanner.Read(dataCount)) {
-          progress.Error("Error while reading number of data entries in file'"+
+        if (!data.Read(source->scanner)) {
+          progress.Error(std::string("Error while reading data entry ")+
+                         NumberToString(current)+" of "+
+                         NumberToString(dataCount)+
+                         " in file '"+
                          source->scanner.GetFilename()+"'");
           return false;
         }
 
-        uint32_t current=1;
-
-        while (current<=dataCount) {
-          Id  id;
-          N   data;
-
-          progress.SetProgress(current,dataCount);
-
-          if (!source->scanner.Read(id)) {
-            progress.Error(std::string("Error while reading data entry ")+
-                           NumberToString(current)+" of "+
-                           NumberToString(dataCount)+
-                           " in file '"+
-                           source->scanner.GetFilename()+"'");
-
-            return false;
-          }
-
-          if (!data.Read(source->scanner)) {
-            progress.Error(std::string("Error while reading data entry ")+
-                           NumberToString(current)+" of "+
-                           NumberToString(dataCount)+
-                           " in file '"+
-                           source->scanner.GetFilename()+"'");
-            return false;
-          }
-
-          double maxLat;
-          double minLon;
-
-          GetTopLeftCoordinate(data,maxLat,minLon);
-
-          size_t cellY=(size_t)((maxLat+90.0)/zoomLevel);
-          size_t cellX=(size_t)((minLon+180.0)/zoomLevel);
-          size_t cellIndex=cellY*zoomLevel+cellX;
-
-          if (cellIndex>=minIndex &&
-              cellIndex<=maxIndex) {
-            dataByCellMap[cellIndex].push_back(CellEntry(id,
-                                                         source,
-                                                         data.GetFileOffset(),
-                                                         maxLat,
-                                                         minLon));
-            currentEntries++;
-          }
-
-          // Reduce cell interval,deleting all already stored nodes beyond the new
-          // cell range end.
-          if (currentEntries>parameter.GetSortBlockSize()) {
-            size_t                                                    count=0;
-            typename std::map<size_t,std::list<CellEntry> >::iterator cutOff=dataByCellMap.end();
-
-            for (typename std::map<size_t,std::list<CellEntry> >::iterator iter=dataByCellMap.begin();
-                iter!=dataByCellMap.end();
-                ++iter) {
-              if (count<=parameter.GetSortBlockSize() &&
-                  count+iter->second.size()>parameter.GetSortBlockSize()) {
-                cutOff=iter;
-                break;
-              }
-              else {
-                count+=iter->second.size();
-                maxIndex=iter->first;
-              }
-            }
-
-            assert(cutOff!=dataByCellMap.end());
-
-            currentEntries=count;
-            dataByCellMap.erase(cutOff,dataByCellMap.end());
-
-            progress.Debug("Reducing cell range to "+NumberToString(minIndex)+ "-"+NumberToString(maxIndex));
-          }
-
-          current++;
-        }
-      }
+        double maxLat;
+        double minLon;
 
-      if (maxIndex<cellCount-1) {
-        progress.Info("Cell range was reduced to "+NumberToString(minIndex)+ "-"+NumberToString(maxIndex));
-      }
+        GetTopLeftCoordinate(data,maxLat,minLon);
 
-      progress.Info(std::string("Copy renumbered data to '")+dataWriter.GetFilename()+"'");
+        size_t cellY=(size_t)((maxLat+90.0)/zoomLevel);
+        size_t cellX=(size_t)((minLon+180.0)/zoomLevel);
 
-      size_t copyCount=0;
-      for (typename std::map<size_t,std::list<CellEntry> >::iterator iter=dataByCellMap.begin();
-          iter!=dataByCellMap.end();
-          ++iter) {
+        SortEntry entry;
 
-        iter->second.sort();
+        entry.cellIndex=cellY*zoomLevel+cellX;
+        entry.lon=minLon;
+        entry.lat=maxLat;
+        entry.source=s;
+        entry.fileOffset=data.GetFileOffset();
+        entry.id=id;
 
-        for (typename std::list<CellEntry>::const_iterator entry=iter->second.begin();
-            entry!=iter->second.end();
-            ++entry) {
-          progress.SetProgress(copyCount,currentEntries);
+        if (!sorter.Add(entry)) {
+          progress.Error("Error while writing to file '"+runFilename+"'");
+          return false;
+        }
+      }
+    }
 
-          N data;
+    if (!sorter.Sort()) {
+      progress.Error("Error while sorting data");
+      return false;
+    }
 
-          if (!entry->source->scanner.SetPos(entry->fileOffset)) {
-            progress.Error(std::string("Error while setting current position in file '")+
-                           entry->source->scanner.GetFilename()+"'");
+    progress.Info(std::string("Merging ")+NumberToString(sorter.GetRunCount())+" sorted run(s)");
+    progress.Info(std::string("Copy renumbered data to '")+dataWriter.GetFilename()+"'");
 
-            return false;
-          }
+    SortEntry entry;
 
-          if (!data.Read(entry->source->scanner))  {
-            progress.Error(std::string("Error while reading data entry at offset ")+
-                           NumberToString(entry->fileOffset)+
-                           " in file '"+
-                           entry->source->scanner.GetFilename()+"'");
+    while (sorter.Next(entry)) {
+      typename std::list<Source>::iterator source=sourceByIndex[entry.source];
 
-            return false;
-          }
+      progress.SetProgress(dataCopyiedCount,overallDataCount);
 
-          FileOffset fileOffset;
+      N data;
 
-          if (!dataWriter.GetPos(fileOffset)) {
-            progress.Error(std::string("Error while reading current fileOffset in file '")+
-                           dataWriter.GetFilename()+"'");
-            return false;
-          }
+      if (!source->scanner.SetPos(entry.fileOffset)) {
+        progress.Error(std::string("Error while setting current position in file '")+
+                       source->scanner.GetFilename()+"'");
 
-          if (!data.Write(dataWriter)) {
-            progress.Error(std::string("Error while writing data entry to file '")+
-                           dataWriter.GetFilename()+"'");
-            return false;
-          }
+        return false;
+      }
 
-          mapWriter.Write(entry->id);
-          mapWriter.Write((uint8_t)entry->source->type);
-          mapWriter.WriteFileOffset(fileOffset);
+      if (!data.Read(source->scanner))  {
+        progress.Error(std::string("Error while reading data entry at offset ")+
+                       NumberToString(entry.fileOffset)+
+                       " in file '"+
+                       source->scanner.GetFilename()+"'");
 
-          copyCount++;
-          dataCopyiedCount++;
-        }
+        return false;
       }
 
-      if (currentEntries==0) {
-        progress.Info("No more entries found");
-        break;
+      FileOffset fileOffset;
+
+      if (!dataWriter.GetPos(fileOffset)) {
+        progress.Error(std::string("Error while reading current fileOffset in file '")+
+                       dataWriter.GetFilename()+"'");
+        return false;
       }
 
-      if (maxIndex==cellCount-1) {
-        // We are finished
-        break;
+      if (!data.Write(dataWriter)) {
+        progress.Error(std::string("Error while writing data entry to file '")+
+                       dataWriter.GetFilename()+"'");
+        return false;
       }
 
-      minIndex=maxIndex+1;
-      maxIndex=cellCount-1;
+      mapWriter.Write((Id)entry.id);
+      mapWriter.Write((uint8_t)source->type);
+      mapWriter.WriteFileOffset(fileOffset);
+
+      dataCopyiedCount++;
+    }
+
+    if (sorter.HasError()) {
+      progress.Error("Error while reading from file '"+runFilename+"'");
+      return false;
+    }
+
+    if (!sorter.Close()) {
+      progress.Error("Error while closing file '"+runFilename+"'");
+      return false;
     }
 
     assert(overallDataCount==dataCopyiedCount);
@@ -387,6 +367,7 @@ namespace osmscout {
       return false;
     }
 
+    dataWriter.SetCoordDeltaEncoding(parameter.GetCoordDeltaEncoding());
     dataWriter.Write(overallDataCount);
 
     if (!mapWriter.Open(AppendFileToDir(parameter.GetDestinationDirectory(),
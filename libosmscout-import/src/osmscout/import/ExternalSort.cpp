@@ -0,0 +1,253 @@
+/*
+  This source is part of the libosmscout library
+  Copyright (C) 2013  Tim Teulings
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+#include <osmscout/import/ExternalSort.h>
+
+#include <cstring>
+
+#include <osmscout/util/File.h>
+
+namespace osmscout {
+
+  /**
+    Maximum number of records in one block of a run
+    */
+  static const size_t maxBlockRecords=4096;
+
+  SortRunFile::SortRunFile()
+  : recordSize(0),
+    compress(false)
+  {
+    // no code
+  }
+
+  SortRunFile::~SortRunFile()
+  {
+    Close();
+  }
+
+  bool SortRunFile::Open(const std::string& filename,
+                         size_t recordSize,
+                         bool compress)
+  {
+    Close();
+
+    this->filename=filename;
+    this->recordSize=recordSize;
+    this->compress=compress;
+
+    return writer.Open(filename);
+  }
+
+  /**
+    Store the given records into the buffer, each record as a bitmask of
+    the bytes differing from the previous record followed by these bytes.
+    */
+  void SortRunFile::EncodeBlock(const char* records,
+                                size_t count)
+  {
+    size_t            maskSize=(recordSize+7)/8;
+    std::vector<char> previous(recordSize,0);
+
+    buffer.clear();
+
+    for (size_t r=0; r<count; r++) {
+      const char* record=records+r*recordSize;
+      size_t      maskPos=buffer.size();
+
+      buffer.resize(buffer.size()+maskSize,0);
+
+      for (size_t b=0; b<recordSize; b++) {
+        if (record[b]!=previous[b]) {
+          buffer[maskPos+b/8]|=(char)(1 << (b%8));
+          buffer.push_back(record[b]);
+        }
+      }
+
+      memcpy(&previous[0],record,recordSize);
+    }
+  }
+
+  /**
+    Decode count records from the buffer.
+    */
+  bool SortRunFile::DecodeBlock(size_t count,
+                                std::vector<char>& records) const
+  {
+    size_t maskSize=(recordSize+7)/8;
+    size_t pos=0;
+
+    records.assign(count*recordSize,0);
+
+    for (size_t r=0; r<count; r++) {
+      char* record=&records[r*recordSize];
+
+      if (r>0) {
+        memcpy(record,record-recordSize,recordSize);
+      }
+
+      if (pos+maskSize>buffer.size()) {
+        return false;
+      }
+
+      size_t maskPos=pos;
+
+      pos+=maskSize;
+
+      for (size_t b=0; b<recordSize; b++) {
+        if (buffer[maskPos+b/8] & (1 << (b%8))) {
+          if (pos>=buffer.size()) {
+            return false;
+          }
+
+          record[b]=buffer[pos];
+          pos++;
+        }
+      }
+    }
+
+    return pos==buffer.size();
+  }
+
+  bool SortRunFile::WriteRun(const char* records,
+                             size_t count,
+                             Run& run)
+  {
+    if (!writer.GetPos(run.offset)) {
+      return false;
+    }
+
+    for (size_t start=0; start<count; start+=maxBlockRecords) {
+      size_t blockCount=std::min(maxBlockRecords,count-start);
+
+      if (compress) {
+        EncodeBlock(records+start*recordSize,
+                    blockCount);
+
+        writer.Write((uint32_t)buffer.size());
+        writer.Write((uint32_t)blockCount);
+        writer.Write(&buffer[0],buffer.size());
+      }
+      else {
+        writer.Write((uint32_t)(blockCount*recordSize));
+        writer.Write((uint32_t)blockCount);
+        writer.Write(records+start*recordSize,blockCount*recordSize);
+      }
+    }
+
+    if (!writer.GetPos(run.endOffset)) {
+      return false;
+    }
+
+    return !writer.HasError();
+  }
+
+  /**
+    Finish writing of runs, runs can be read afterwards.
+    */
+  bool SortRunFile::StartReading()
+  {
+    if (!writer.Close()) {
+      return false;
+    }
+
+    return scanner.Open(filename,
+                        FileScanner::Normal,
+                        false);
+  }
+
+  /**
+    Read the block at the given offset and move the offset behind the
+    block.
+    */
+  bool SortRunFile::ReadBlock(FileOffset& offset,
+                              std::vector<char>& records,
+                              size_t& count)
+  {
+    uint32_t bytes;
+    uint32_t recordCount;
+
+    if (!scanner.SetPos(offset) ||
+        !scanner.Read(bytes) ||
+        !scanner.Read(recordCount)) {
+      return false;
+    }
+
+    // Reject corrupted block headers before allocating memory for the block
+    if (recordCount>maxBlockRecords ||
+        bytes>recordCount*((recordSize+7)/8+recordSize)) {
+      return false;
+    }
+
+    if (compress) {
+      buffer.resize(bytes);
+
+      if (bytes>0 &&
+          !scanner.Read(&buffer[0],bytes)) {
+        return false;
+      }
+
+      if (!DecodeBlock(recordCount,
+                       records)) {
+        return false;
+      }
+    }
+    else {
+      if (bytes!=recordCount*recordSize) {
+        return false;
+      }
+
+      records.resize(bytes);
+
+      if (bytes>0 &&
+          !scanner.Read(&records[0],bytes)) {
+        return false;
+      }
+    }
+
+    count=recordCount;
+
+    return scanner.GetPos(offset);
+  }
+
+  /**
+    Close and delete the file.
+    */
+  bool SortRunFile::Close()
+  {
+    bool success=true;
+
+    if (writer.IsOpen() &&
+        !writer.Close()) {
+      success=false;
+    }
+
+    if (scanner.IsOpen() &&
+        !scanner.Close()) {
+      success=false;
+    }
+
+    if (!filename.empty()) {
+      RemoveFile(filename);
+      filename.clear();
+    }
+
+    return success;
+  }
+}
@@ -59,13 +59,14 @@ namespace osmscout
     return "Generate '"+std::string(FILE_AREASOPT_DAT)+"'";
   }
 
-  void OptimizeAreasLowZoomGenerator::GetAreaTypesToOptimize(const TypeConfig& typeConfig,
-                                                       std::set<TypeId>& types)
+  void OptimizeAreasLowZoomGenerator::GetAreaTypesToOptimize(const ImportParameter& parameter,
+                                                             const TypeConfig& typeConfig,
+                                                             std::set<TypeId>& types)
   {
     for (std::vector<TypeInfo>::const_iterator type=typeConfig.GetTypes().begin();
         type!=typeConfig.GetTypes().end();
         type++) {
-      if (type->GetOptimizeLowZoom() &&
+      if (LowZoomSimplifier::IsTypeToOptimize(parameter,*type) &&
           type->CanBeArea()) {
         types.insert(type->GetId());
       }
@@ -183,14 +184,16 @@ namespace osmscout
     return true;
   }
 
-  void OptimizeAreasLowZoomGenerator::OptimizeAreas(const std::list<AreaRef>& areas,
+  void OptimizeAreasLowZoomGenerator::OptimizeAreas(LowZoomSimplifier& simplifier,
+                                                    const std::list<AreaRef>& areas,
                                                     std::list<AreaRef>& optimizedAreas,
                                                     size_t width,
                                                     size_t height,
                                                     const Magnification& magnification,
                                                     TransPolygon::OptimizeMethod optimizeWayMethod)
   {
-    MercatorProjection projection;
+    MercatorProjection    projection;
+    std::vector<GeoCoord> nodes;
 
     projection.Set(0,0,magnification,width,height);
 
@@ -198,26 +201,25 @@ namespace osmscout
          a!=areas.end();
          ++a) {
       AreaRef                 area(*a);
-      TransPolygon            polygon;
       std::vector<Area::Ring> newRings;
-      double                  xmin;
-      double                  xmax;
-      double                  ymin;
-      double                  ymax;
 
       size_t r=0;
       while (r<area->rings.size()) {
         if (area->rings[r].ring!=Area::masterRingId) {
-          polygon.TransformArea(projection,
-                                optimizeWayMethod,
-                                area->rings[r].nodes,
-                                1.0);
-
-          polygon.GetBoundingBox(xmin,ymin,xmax,ymax);
-
-          if (polygon.IsEmpty() ||
-              (xmax-xmin<=6.0 &&
-               ymax-ymin<=6.0)) {
+          double ringWidth;
+          double ringHeight;
+
+          simplifier.SimplifyRing(projection,
+                                  optimizeWayMethod,
+                                  area->rings[r].ids,
+                                  area->rings[r].nodes,
+                                  nodes,
+                                  ringWidth,
+                                  ringHeight);
+
+          if (nodes.size()<3 ||
+              (ringWidth<=6.0 &&
+               ringHeight<=6.0)) {
             // We drop all sub roles of the current role, too
             size_t s=r;
 
@@ -233,16 +235,11 @@ namespace osmscout
 
         newRings.push_back(area->rings[r]);
 
+        newRings.back().ids.clear();
         newRings.back().nodes.clear();
 
         if (area->rings[r].ring!=Area::masterRingId) {
-          for (size_t i=polygon.GetStart();
-               i<=polygon.GetEnd();
-               i++) {
-            if (polygon.points[i].draw) {
-              newRings.back().nodes.push_back(area->rings[r].nodes[i]);
-            }
-          }
+          newRings.back().nodes=nodes;
         }
 
         r++;
@@ -536,6 +533,8 @@ namespace osmscout
 
     std::set<TypeId>                 typesToProcess(types);
     std::vector<std::list<AreaRef> > allAreas(typeConfig.GetTypes().size());
+    LowZoomSimplifier                simplifier;
+    std::vector<uint32_t>            levels;
 
     while (true) {
       //
@@ -550,6 +549,22 @@ namespace osmscout
         return false;
       }
 
+      // Borders shared by the areas loaded are simplified the same way for
+      // all of them
+      simplifier.Clear();
+
+      for (size_t type=0; type<allAreas.size(); type++) {
+        for (std::list<AreaRef>::const_iterator a=allAreas[type].begin();
+             a!=allAreas[type].end();
+             ++a) {
+          for (size_t r=0; r<(*a)->rings.size(); r++) {
+            simplifier.AddRing((*a)->rings[r].ids);
+          }
+        }
+      }
+
+      simplifier.CalculateJunctions();
+
       for (size_t type=0; type<allAreas.size(); type++) {
         if (allAreas[type].empty()) {
           continue;
@@ -574,15 +589,19 @@ namespace osmscout
           }
         }*/
 
-        for (uint32_t level=parameter.GetOptimizationMinMag();
-             level<=parameter.GetOptimizationMaxMag();
-             level++) {
+        LowZoomSimplifier::GetOptimizationLevels(parameter,
+                                                 typeConfig.GetTypeInfo(type),
+                                                 levels);
+
+        for (size_t l=0; l<levels.size(); l++) {
+          uint32_t           level=levels[l];
           Magnification      magnification; // Magnification, we optimize for
           std::list<AreaRef> optimizedAreas;
 
           magnification.SetLevel(level);
 
-          OptimizeAreas(allAreas[type],
+          OptimizeAreas(simplifier,
+                        allAreas[type],
                         optimizedAreas,
                         800,640,
                         magnification,
@@ -674,7 +693,9 @@ namespace osmscout
     std::set<TypeId>     areaTypes;     // Types we optimize
     std::list<TypeData>  areaTypesData;
 
-    GetAreaTypesToOptimize(typeConfig,areaTypes);
+    GetAreaTypesToOptimize(parameter,
+                           typeConfig,
+                           areaTypes);
 
     if (!writer.Open(AppendFileToDir(parameter.GetDestinationDirectory(),
                                      FILE_AREASOPT_DAT))) {
@@ -682,6 +703,8 @@ namespace osmscout
       return false;
     }
 
+    writer.SetCoordDeltaEncoding(parameter.GetCoordDeltaEncoding());
+
     //
     // Write header
     //
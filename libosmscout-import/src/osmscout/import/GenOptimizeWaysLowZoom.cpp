@@ -59,13 +59,14 @@ namespace osmscout
     return "Generate '"+std::string(FILE_WAYSOPT_DAT)+"'";
   }
 
-  void OptimizeWaysLowZoomGenerator::GetWayTypesToOptimize(const TypeConfig& typeConfig,
+  void OptimizeWaysLowZoomGenerator::GetWayTypesToOptimize(const ImportParameter& parameter,
+                                                           const TypeConfig& typeConfig,
                                                            std::set<TypeId>& types)
   {
     for (std::vector<TypeInfo>::const_iterator type=typeConfig.GetTypes().begin();
         type!=typeConfig.GetTypes().end();
         type++) {
-      if (type->GetOptimizeLowZoom() &&
+      if (LowZoomSimplifier::IsTypeToOptimize(parameter,*type) &&
           type->CanBeWay()) {
         types.insert(type->GetId());
       }
@@ -691,6 +692,7 @@ namespace osmscout
 
     std::set<TypeId>                typesToProcess(types);
     std::vector<std::list<WayRef> > allWays(typeConfig.GetTypes().size());
+    std::vector<uint32_t>           levels;
 
     while (true) {
       //
@@ -718,9 +720,16 @@ namespace osmscout
 
         std::list<WayRef> newWays;
 
-        MergeWays(progress,
-                  allWays[type],
-                  newWays);
+        // Merging ignores all attributes but the ref, so we only merge ways
+        // of types explicitly marked for low zoom optimization
+        if (typeConfig.GetTypeInfo(type).GetOptimizeLowZoom()) {
+          MergeWays(progress,
+                    allWays[type],
+                    newWays);
+        }
+        else {
+          newWays.swap(allWays[type]);
+        }
 
         allWays[type].clear();
 
@@ -744,9 +753,12 @@ namespace osmscout
         // Transform/Optimize the way and store it
         //
 
-        for (uint32_t level=parameter.GetOptimizationMinMag();
-             level<=parameter.GetOptimizationMaxMag();
-             level++) {
+        LowZoomSimplifier::GetOptimizationLevels(parameter,
+                                                 typeConfig.GetTypeInfo(type),
+                                                 levels);
+
+        for (size_t l=0; l<levels.size(); l++) {
+          uint32_t          level=levels[l];
           Magnification     magnification; // Magnification, we optimize for
           std::list<WayRef> optimizedWays;
 
@@ -839,7 +851,9 @@ namespace osmscout
     std::set<TypeId>     wayTypes;         // Types we optimize
     std::list<TypeData>  wayTypesData;
 
-    GetWayTypesToOptimize(typeConfig,wayTypes);
+    GetWayTypesToOptimize(parameter,
+                          typeConfig,
+                          wayTypes);
 
     if (!writer.Open(AppendFileToDir(parameter.GetDestinationDirectory(),
                                      FILE_WAYSOPT_DAT))) {
@@ -847,6 +861,8 @@ namespace osmscout
       return false;
     }
 
+    writer.SetCoordDeltaEncoding(parameter.GetCoordDeltaEncoding());
+
     //
     // Write header
     //
@@ -1019,12 +1019,12 @@ namespace osmscout {
 
     IndexedDataFile<OSMId,RawWay>      wayDataFile("rawways.dat",
                                                    "rawway.idx",
-                                                   parameter.GetRawWayDataCacheSize(),
+                                                   parameter.GetRawWayDataCacheSizeBytes(),
                                                    parameter.GetRawWayIndexCacheSize());
 
     IndexedDataFile<OSMId,RawRelation> relDataFile("rawrels.dat",
                                                    "rawrel.idx",
-                                                   parameter.GetRawWayDataCacheSize(),
+                                                   parameter.GetRawWayDataCacheSizeBytes(),
                                                    parameter.GetRawWayIndexCacheSize());
 
     if (!coordDataFile.Open(parameter.GetDestinationDirectory(),
@@ -0,0 +1,537 @@
+/*
+  This source is part of the libosmscout library
+  Copyright (C) 2013  Tim Teulings
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+#include <osmscout/import/GenRouteCHDat.h>
+
+#include <algorithm>
+
+#include <osmscout/RouteNode.h>
+
+#include <osmscout/util/File.h>
+#include <osmscout/util/FileScanner.h>
+#include <osmscout/util/HashMap.h>
+#include <osmscout/util/String.h>
+
+namespace osmscout {
+
+  static const uint32_t costScale=1000000;
+  static const uint64_t noCosts=(uint64_t)-1;
+
+  /**
+    Maximum number of nodes settled during a witness search. If no witness is
+    found within this limit, the shortcut is added (which is never wrong, but
+    results in more shortcuts).
+    */
+  static const size_t maxWitnessSettled=500;
+
+  /**
+    Maximum number of nodes settled during a witness search while calculating
+    the priority of a node.
+    */
+  static const size_t maxPriorityWitnessSettled=50;
+
+  RouteCHDataGenerator::RouteCHDataGenerator(Vehicle vehicle,
+                                             const std::string& dataFilename,
+                                             const std::string& chFilename)
+  : vehicle(vehicle),
+    dataFilename(dataFilename),
+    chFilename(chFilename)
+  {
+    // no code
+  }
+
+  std::string RouteCHDataGenerator::GetDescription() const
+  {
+    return "Generate '"+chFilename+"'";
+  }
+
+  void RouteCHDataGenerator::ParametrizeProfile(const ImportParameter& parameter,
+                                                const TypeConfig& typeConfig,
+                                                Progress& progress,
+                                                FastestPathRoutingProfile& profile) const
+  {
+    switch (vehicle) {
+    case vehicleFoot:
+      profile.ParametrizeForFoot(typeConfig,
+                                 5.0);
+      break;
+    case vehicleBicycle:
+      profile.ParametrizeForBicycle(typeConfig,
+                                    20.0);
+      break;
+    case vehicleCar:
+      if (!profile.ParametrizeForCar(typeConfig,
+                                     parameter.GetRouteCHSpeedTable(),
+                                     parameter.GetRouteCHMaxSpeed())) {
+        progress.Warning("Not all routable types have a speed, these types will not be used");
+      }
+      break;
+    }
+  }
+
+  /**
+    Load all route nodes and create an edge for each path usable by the profile.
+    Nodes get an index in the order of the routing graph file. The file is
+    scanned twice, the first pass collects the file offsets of all nodes, the
+    second one the edges.
+    */
+  bool RouteCHDataGenerator::LoadGraph(const ImportParameter& parameter,
+                                       Progress& progress,
+                                       const RoutingProfile& profile,
+                                       std::vector<FileOffset>& nodeOffsets)
+  {
+    FileScanner                           scanner;
+    uint32_t                              nodeCount;
+    OSMSCOUT_HASHMAP<FileOffset,uint32_t> nodeIndexMap;
+    RouteNode                             node;
+
+    progress.SetAction("Scanning '"+dataFilename+"'");
+
+    if (!scanner.Open(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                      dataFilename),
+                      FileScanner::Sequential,
+                      true)) {
+      progress.Error("Cannot open '"+scanner.GetFilename()+"'");
+      return false;
+    }
+
+    if (!scanner.Read(nodeCount)) {
+      progress.Error("Error while reading number of data entries in file");
+      return false;
+    }
+
+    nodeOffsets.resize(nodeCount);
+#if defined(OSMSCOUT_HASHMAP_HAS_RESERVE)
+    nodeIndexMap.reserve(nodeCount);
+#endif
+
+    for (uint32_t n=0; n<nodeCount; n++) {
+      progress.SetProgress(n,nodeCount);
+
+      if (!node.Read(scanner)) {
+        progress.Error(std::string("Error while reading data entry ")+
+                       NumberToString(n)+" of "+
+                       NumberToString(nodeCount)+
+                       " in file '"+
+                       scanner.GetFilename()+"'");
+        return false;
+      }
+
+      nodeOffsets[n]=node.GetFileOffset();
+      nodeIndexMap[node.GetFileOffset()]=n;
+    }
+
+    outEdges.resize(nodeCount);
+    inEdges.resize(nodeCount);
+
+    progress.SetAction("Building graph");
+
+    if (!scanner.GotoBegin() ||
+        !scanner.Read(nodeCount)) {
+      progress.Error("Cannot rewind '"+scanner.GetFilename()+"'");
+      return false;
+    }
+
+    size_t edgeCount=0;
+
+    for (uint32_t n=0; n<nodeCount; n++) {
+      progress.SetProgress(n,nodeCount);
+
+      if (!node.Read(scanner)) {
+        progress.Error(std::string("Error while reading data entry ")+
+                       NumberToString(n)+" of "+
+                       NumberToString(nodeCount)+
+                       " in file '"+
+                       scanner.GetFilename()+"'");
+        return false;
+      }
+
+      for (size_t p=0; p<node.paths.size(); p++) {
+        if (!profile.CanUse(node,p)) {
+          continue;
+        }
+
+        OSMSCOUT_HASHMAP<FileOffset,uint32_t>::const_iterator target=nodeIndexMap.find(node.paths[p].offset);
+
+        if (target==nodeIndexMap.end()) {
+          progress.Error("Cannot resolve target of path from route node "+NumberToString(node.GetId()));
+          return false;
+        }
+
+        if (target->second==n) {
+          continue;
+        }
+
+        uint64_t costs=(uint64_t)(profile.GetCosts(node,p)*costScale+0.5);
+
+        AddEdge(n,
+                target->second,
+                costs,
+                ContractionHierarchy::noNode,
+                (uint32_t)p);
+
+        edgeCount++;
+      }
+    }
+
+    scanner.Close();
+
+    progress.Info(NumberToString(nodeCount)+" nodes, "+NumberToString(edgeCount)+" edges");
+
+    return true;
+  }
+
+  /**
+    Add a new edge, or replace an existing edge between the same nodes, if the new
+    edge is cheaper.
+    */
+  void RouteCHDataGenerator::AddEdge(uint32_t source,
+                                     uint32_t target,
+                                     uint64_t costs,
+                                     uint32_t middle,
+                                     uint32_t pathIndex)
+  {
+    for (std::vector<Edge>::iterator edge=outEdges[source].begin();
+         edge!=outEdges[source].end();
+         ++edge) {
+      if (edge->target==target) {
+        if (costs<edge->costs) {
+          edge->costs=costs;
+          edge->middle=middle;
+          edge->pathIndex=pathIndex;
+
+          for (std::vector<Edge>::iterator inEdge=inEdges[target].begin();
+               inEdge!=inEdges[target].end();
+               ++inEdge) {
+            if (inEdge->target==source) {
+              *inEdge=*edge;
+              inEdge->target=source;
+              break;
+            }
+          }
+        }
+
+        return;
+      }
+    }
+
+    Edge edge;
+
+    edge.costs=costs;
+    edge.target=target;
+    edge.middle=middle;
+    edge.pathIndex=pathIndex;
+
+    outEdges[source].push_back(edge);
+
+    edge.target=source;
+
+    inEdges[target].push_back(edge);
+  }
+
+  void RouteCHDataGenerator::RemoveEdgesTo(std::vector<Edge>& edges,
+                                           uint32_t target)
+  {
+    for (size_t i=0; i<edges.size(); i++) {
+      if (edges[i].target==target) {
+        edges[i]=edges.back();
+        edges.pop_back();
+        return;
+      }
+    }
+  }
+
+  /**
+    Dijkstra search from source over all not yet contracted nodes except skip,
+    stopping at costs greater than maxCosts or after settling maxSettled nodes.
+    */
+  void RouteCHDataGenerator::RunWitnessSearch(uint32_t source,
+                                              uint32_t skip,
+                                              uint64_t maxCosts,
+                                              size_t maxSettled)
+  {
+    for (std::vector<uint32_t>::const_iterator node=witnessTouched.begin();
+         node!=witnessTouched.end();
+         ++node) {
+      witnessCosts[*node]=noCosts;
+    }
+
+    witnessTouched.clear();
+    witnessHeap.Clear();
+
+    witnessCosts[source]=0;
+    witnessTouched.push_back(source);
+    witnessHeap.Push(source,0.0);
+
+    size_t settled=0;
+
+    while (!witnessHeap.IsEmpty() &&
+           settled<maxSettled) {
+      uint32_t node=(uint32_t)witnessHeap.Pop();
+      uint64_t costs=witnessCosts[node];
+
+      if (costs>maxCosts) {
+        break;
+      }
+
+      settled++;
+
+      for (std::vector<Edge>::const_iterator edge=outEdges[node].begin();
+           edge!=outEdges[node].end();
+           ++edge) {
+        if (edge->target==skip) {
+          continue;
+        }
+
+        uint64_t targetCosts=costs+edge->costs;
+
+        if (witnessCosts[edge->target]==noCosts) {
+          witnessCosts[edge->target]=targetCosts;
+          witnessTouched.push_back(edge->target);
+          witnessHeap.Push(edge->target,(double)targetCosts);
+        }
+        else if (targetCosts<witnessCosts[edge->target] &&
+                 witnessHeap.Contains(edge->target)) {
+          witnessCosts[edge->target]=targetCosts;
+          witnessHeap.Update(edge->target,(double)targetCosts);
+        }
+      }
+    }
+  }
+
+  /**
+    Calculate the shortcuts needed to remove the given node from the graph. If
+    simulate is false, the shortcuts are added and the node is removed from the
+    graph, its remaining edges are the final edges of the node in the hierarchy.
+    Returns the number of shortcuts.
+    */
+  size_t RouteCHDataGenerator::ContractNode(uint32_t node,
+                                            bool simulate)
+  {
+    size_t shortcutCount=0;
+    size_t maxSettled=simulate ? maxPriorityWitnessSettled : maxWitnessSettled;
+
+    // Copy, AddEdge() may modify the edges of the neighbours
+    std::vector<Edge> in(inEdges[node]);
+    std::vector<Edge> out(outEdges[node]);
+
+    for (std::vector<Edge>::const_iterator inEdge=in.begin();
+         inEdge!=in.end();
+         ++inEdge) {
+      uint64_t maxCosts=0;
+
+      for (std::vector<Edge>::const_iterator outEdge=out.begin();
+           outEdge!=out.end();
+           ++outEdge) {
+        if (outEdge->target!=inEdge->target) {
+          maxCosts=std::max(maxCosts,inEdge->costs+outEdge->costs);
+        }
+      }
+
+      if (maxCosts==0) {
+        continue;
+      }
+
+      RunWitnessSearch(inEdge->target,
+                       node,
+                       maxCosts,
+                       maxSettled);
+
+      for (std::vector<Edge>::const_iterator outEdge=out.begin();
+           outEdge!=out.end();
+           ++outEdge) {
+        if (outEdge->target==inEdge->target) {
+          continue;
+        }
+
+        uint64_t costs=inEdge->costs+outEdge->costs;
+
+        if (witnessCosts[outEdge->target]!=noCosts &&
+            witnessCosts[outEdge->target]<=costs) {
+          continue;
+        }
+
+        shortcutCount++;
+
+        if (!simulate) {
+          AddEdge(inEdge->target,
+                  outEdge->target,
+                  costs,
+                  node,
+                  0);
+        }
+      }
+    }
+
+    if (!simulate) {
+      for (std::vector<Edge>::const_iterator edge=inEdges[node].begin();
+           edge!=inEdges[node].end();
+           ++edge) {
+        RemoveEdgesTo(outEdges[edge->target],node);
+        contractedNeighbours[edge->target]++;
+      }
+
+      for (std::vector<Edge>::const_iterator edge=outEdges[node].begin();
+           edge!=outEdges[node].end();
+           ++edge) {
+        RemoveEdgesTo(inEdges[edge->target],node);
+        contractedNeighbours[edge->target]++;
+      }
+    }
+
+    return shortcutCount;
+  }
+
+  double RouteCHDataGenerator::GetPriority(uint32_t node)
+  {
+    double shortcuts=(double)ContractNode(node,true);
+    double removed=(double)(inEdges[node].size()+outEdges[node].size());
+
+    return shortcuts-removed+contractedNeighbours[node];
+  }
+
+  bool RouteCHDataGenerator::Import(const ImportParameter& parameter,
+                                    Progress& progress,
+                                    const TypeConfig& typeConfig)
+  {
+    std::string chPath=AppendFileToDir(parameter.GetDestinationDirectory(),
+                                       chFilename);
+
+    if (!parameter.GetRouteCH()) {
+      FileOffset size;
+
+      // Make sure that the router does not use a contraction hierarchy of an older import
+      if (GetFileSize(chPath,size) &&
+          !RemoveFile(chPath)) {
+        progress.Error("Cannot delete outdated '"+chFilename+"'");
+        return false;
+      }
+
+      progress.Info("Contraction hierarchy disabled, skipping");
+
+      return true;
+    }
+
+    FastestPathRoutingProfile profile;
+    std::vector<FileOffset>   nodeOffsets;
+
+    ParametrizeProfile(parameter,
+                       typeConfig,
+                       progress,
+                       profile);
+
+    if (!LoadGraph(parameter,
+                   progress,
+                   profile,
+                   nodeOffsets)) {
+      return false;
+    }
+
+    uint32_t    nodeCount=(uint32_t)nodeOffsets.size();
+    DAryHeap<4> queue;
+
+    contractedNeighbours.assign(nodeCount,0);
+    witnessCosts.assign(nodeCount,noCosts);
+
+    progress.SetAction("Calculating initial node order");
+
+    for (uint32_t n=0; n<nodeCount; n++) {
+      progress.SetProgress(n,nodeCount);
+
+      queue.Push(n,GetPriority(n));
+    }
+
+    progress.SetAction("Contracting nodes");
+
+    size_t   contractedCount=0;
+    size_t   shortcutCount=0;
+
+    while (!queue.IsEmpty()) {
+      uint32_t node=(uint32_t)queue.Pop();
+
+      // Lazy update: the priority may have changed since the node was queued
+      double priority=GetPriority(node);
+
+      if (!queue.IsEmpty() &&
+          priority>queue.GetMinPriority()) {
+        queue.Push(node,priority);
+        continue;
+      }
+
+      progress.SetProgress(contractedCount,nodeCount);
+
+      std::vector<uint32_t> neighbours;
+
+      for (std::vector<Edge>::const_iterator edge=inEdges[node].begin();
+           edge!=inEdges[node].end();
+           ++edge) {
+        neighbours.push_back(edge->target);
+      }
+
+      for (std::vector<Edge>::const_iterator edge=outEdges[node].begin();
+           edge!=outEdges[node].end();
+           ++edge) {
+        neighbours.push_back(edge->target);
+      }
+
+      shortcutCount+=ContractNode(node,false);
+      contractedCount++;
+
+      std::sort(neighbours.begin(),neighbours.end());
+      neighbours.erase(std::unique(neighbours.begin(),neighbours.end()),
+                       neighbours.end());
+
+      for (std::vector<uint32_t>::const_iterator neighbour=neighbours.begin();
+           neighbour!=neighbours.end();
+           ++neighbour) {
+        if (queue.Contains(*neighbour)) {
+          queue.Update(*neighbour,GetPriority(*neighbour));
+        }
+      }
+    }
+
+    progress.Info(NumberToString(shortcutCount)+" shortcuts added");
+
+    progress.SetAction("Writing '"+chFilename+"'");
+
+    ContractionHierarchy ch;
+
+    ch.SetCostScale(costScale);
+    ch.SetProfile(profile);
+
+    for (uint32_t n=0; n<nodeCount; n++) {
+      ch.AddNode(nodeOffsets[n],
+                 outEdges[n],
+                 inEdges[n]);
+    }
+
+    std::vector<std::vector<Edge> >().swap(outEdges);
+    std::vector<std::vector<Edge> >().swap(inEdges);
+    std::vector<uint32_t>().swap(contractedNeighbours);
+    std::vector<uint64_t>().swap(witnessCosts);
+    witnessTouched.clear();
+
+    if (!ch.Write(chPath)) {
+      progress.Error("Cannot write '"+chFilename+"'");
+      return false;
+    }
+
+    return true;
+  }
+}
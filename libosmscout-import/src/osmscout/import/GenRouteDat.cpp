@@ -922,8 +922,7 @@ namespace osmscout {
       //path.bearing=CalculateEncodedBearing(way,currentNode,nextNode,true);
       path.flags=CopyFlags(typeConfig,
                            ring);
-      path.lat=ring.nodes[nextNode].GetLat();
-      path.lon=ring.nodes[nextNode].GetLon();
+      path.coord=ring.nodes[nextNode];
       path.distance=distance;
 
       routeNode.paths.push_back(path);
@@ -986,8 +985,7 @@ namespace osmscout {
       //path.bearing=CalculateEncodedBearing(way,currentNode,prevNode,false);
       path.flags=CopyFlags(typeConfig,
                            ring);
-      path.lat=ring.nodes[prevNode].GetLat();
-      path.lon=ring.nodes[prevNode].GetLon();
+      path.coord=ring.nodes[prevNode];
       path.distance=distance;
 
       routeNode.paths.push_back(path);
@@ -1067,8 +1065,7 @@ namespace osmscout {
         path.grade=way.GetGrade();
         //path.bearing=CalculateEncodedBearing(way,currentNode,nextNode,true);
         path.flags=CopyFlagsForward(way);
-        path.lat=way.nodes[nextNode].GetLat();
-        path.lon=way.nodes[nextNode].GetLon();
+        path.coord=way.nodes[nextNode];
         path.distance=distance;
 
         routeNode.paths.push_back(path);
@@ -1130,8 +1127,7 @@ namespace osmscout {
         path.grade=way.GetGrade();
         //path.bearing=CalculateEncodedBearing(way,prevNode,nextNode,false);
         path.flags=CopyFlagsBackward(way);
-        path.lat=way.nodes[prevNode].GetLat();
-        path.lon=way.nodes[prevNode].GetLon();
+        path.coord=way.nodes[prevNode];
         path.distance=distance;
 
         routeNode.paths.push_back(path);
@@ -1187,8 +1183,7 @@ namespace osmscout {
             path.grade=way.GetGrade();
             //path.bearing=CalculateEncodedBearing(way,i,j,false);
             path.flags=CopyFlagsBackward(way);
-            path.lat=way.nodes[j].GetLat();
-            path.lon=way.nodes[j].GetLon();
+            path.coord=way.nodes[j];
 
             path.distance=0.0;
             for (size_t d=j;d<i; d++) {
@@ -1242,8 +1237,7 @@ namespace osmscout {
             path.grade=way.GetGrade();
             //path.bearing=CalculateEncodedBearing(way,i,j,true);
             path.flags=CopyFlagsForward(way);
-            path.lat=way.nodes[j].GetLat();
-            path.lon=way.nodes[j].GetLon();
+            path.coord=way.nodes[j];
 
             path.distance=0.0;
             for (size_t d=i;d<j; d++) {
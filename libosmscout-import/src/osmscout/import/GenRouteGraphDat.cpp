@@ -0,0 +1,297 @@
+/*
+  This source is part of the libosmscout library
+  Copyright (C) 2013  Tim Teulings
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+#include <osmscout/import/GenRouteGraphDat.h>
+
+#include <algorithm>
+#include <cmath>
+
+#include <osmscout/RouteGraph.h>
+#include <osmscout/RouteNode.h>
+
+#include <osmscout/system/Assert.h>
+
+#include <osmscout/util/File.h>
+#include <osmscout/util/FileScanner.h>
+#include <osmscout/util/String.h>
+
+namespace osmscout {
+
+  RouteGraphDataGenerator::RouteGraphDataGenerator(const std::string& dataFilename,
+                                                   const std::string& graphFilename)
+  : dataFilename(dataFilename),
+    graphFilename(graphFilename)
+  {
+    // no code
+  }
+
+  std::string RouteGraphDataGenerator::GetDescription() const
+  {
+    return "Generate '"+graphFilename+"'";
+  }
+
+  static uint32_t GetNodeIndex(const std::vector<RouteGraph::Node>& nodes,
+                               FileOffset offset)
+  {
+    size_t begin=0;
+    size_t end=nodes.size();
+
+    while (begin<end) {
+      size_t middle=begin+(end-begin)/2;
+
+      if (nodes[middle].offset<offset) {
+        begin=middle+1;
+      }
+      else {
+        end=middle;
+      }
+    }
+
+    if (begin<nodes.size() &&
+        nodes[begin].offset==offset) {
+      return (uint32_t)begin;
+    }
+
+    return RouteGraph::noNode;
+  }
+
+  static uint32_t GetObjectIndex(const std::vector<ObjectFileRef>& objects,
+                                 const ObjectFileRef& object)
+  {
+    std::vector<ObjectFileRef>::const_iterator entry=std::lower_bound(objects.begin(),
+                                                                      objects.end(),
+                                                                      object);
+
+    assert(entry!=objects.end() && *entry==object);
+
+    return (uint32_t)(entry-objects.begin());
+  }
+
+  /**
+    The routing graph file is scanned twice. The first pass collects the nodes,
+    their coordinates (from the paths leading to them) and all referenced
+    objects, the second pass the edges and excludes.
+    */
+  bool RouteGraphDataGenerator::Import(const ImportParameter& parameter,
+                                       Progress& progress,
+                                       const TypeConfig& /*typeConfig*/)
+  {
+    FileScanner                      scanner;
+    uint32_t                         nodeCount;
+    RouteNode                        routeNode;
+    std::vector<RouteGraph::Node>    nodes;
+    std::vector<RouteGraph::Edge>    edges;
+    std::vector<RouteGraph::Exclude> excludes;
+    std::vector<ObjectFileRef>       objectRefs;
+    std::vector<RouteGraph::Object>  objects;
+    std::vector<bool>                hasCoord;
+
+    if (!parameter.GetRouteGraph()) {
+      std::string graphPath=AppendFileToDir(parameter.GetDestinationDirectory(),
+                                            graphFilename);
+      FileOffset  size;
+
+      // Make sure that the router does not use a routing graph of an older import
+      if (GetFileSize(graphPath,size) &&
+          !RemoveFile(graphPath)) {
+        progress.Error("Cannot delete outdated '"+graphFilename+"'");
+        return false;
+      }
+
+      progress.Info("Compact routing graph disabled, skipping");
+
+      return true;
+    }
+
+    progress.SetAction("Scanning '"+dataFilename+"'");
+
+    if (!scanner.Open(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                      dataFilename),
+                      FileScanner::Sequential,
+                      true)) {
+      progress.Error("Cannot open '"+scanner.GetFilename()+"'");
+      return false;
+    }
+
+    if (!scanner.Read(nodeCount)) {
+      progress.Error("Error while reading number of data entries in file");
+      return false;
+    }
+
+    nodes.reserve(nodeCount+1);
+
+    for (uint32_t n=0; n<nodeCount; n++) {
+      progress.SetProgress(n,nodeCount);
+
+      if (!routeNode.Read(scanner)) {
+        progress.Error(std::string("Error while reading data entry ")+
+                       NumberToString(n)+" of "+
+                       NumberToString(nodeCount)+
+                       " in file '"+
+                       scanner.GetFilename()+"'");
+        return false;
+      }
+
+      RouteGraph::Node node;
+
+      node.offset=routeNode.GetFileOffset();
+      node.lat=0;
+      node.lon=0;
+      node.firstEdge=0;
+      node.firstExclude=0;
+
+      nodes.push_back(node);
+
+      objectRefs.insert(objectRefs.end(),
+                        routeNode.objects.begin(),
+                        routeNode.objects.end());
+
+      for (std::vector<RouteNode::Exclude>::const_iterator exclude=routeNode.excludes.begin();
+           exclude!=routeNode.excludes.end();
+           ++exclude) {
+        objectRefs.push_back(exclude->source);
+      }
+    }
+
+    std::sort(objectRefs.begin(),objectRefs.end());
+    objectRefs.erase(std::unique(objectRefs.begin(),objectRefs.end()),
+                     objectRefs.end());
+
+    progress.SetAction("Building graph");
+
+    if (!scanner.GotoBegin() ||
+        !scanner.Read(nodeCount)) {
+      progress.Error("Cannot rewind '"+scanner.GetFilename()+"'");
+      return false;
+    }
+
+    hasCoord.resize(nodeCount,false);
+
+    for (uint32_t n=0; n<nodeCount; n++) {
+      progress.SetProgress(n,nodeCount);
+
+      if (!routeNode.Read(scanner)) {
+        progress.Error(std::string("Error while reading data entry ")+
+                       NumberToString(n)+" of "+
+                       NumberToString(nodeCount)+
+                       " in file '"+
+                       scanner.GetFilename()+"'");
+        return false;
+      }
+
+      nodes[n].firstEdge=(uint32_t)edges.size();
+      nodes[n].firstExclude=(uint32_t)excludes.size();
+
+      for (std::vector<RouteNode::Path>::const_iterator path=routeNode.paths.begin();
+           path!=routeNode.paths.end();
+           ++path) {
+        RouteGraph::Edge edge;
+
+        edge.target=GetNodeIndex(nodes,path->offset);
+
+        if (edge.target==RouteGraph::noNode) {
+          progress.Error("Cannot resolve target of path from route node "+NumberToString(routeNode.GetId()));
+          return false;
+        }
+
+        edge.distance=(uint32_t)floor(path->distance*100000.0+0.5);
+        edge.object=GetObjectIndex(objectRefs,routeNode.objects[path->objectIndex]);
+        edge.type=path->type;
+        edge.flags=path->flags;
+        edge.maxSpeed=path->maxSpeed;
+
+        edges.push_back(edge);
+
+        // The route node itself does not store its coordinates, but each path stores
+        // the coordinates of its target
+        if (!hasCoord[edge.target]) {
+          nodes[edge.target].lat=(uint32_t)floor((path->coord.GetLat()+90.0)*conversionFactor+0.5);
+          nodes[edge.target].lon=(uint32_t)floor((path->coord.GetLon()+180.0)*conversionFactor+0.5);
+          hasCoord[edge.target]=true;
+        }
+      }
+
+      for (std::vector<RouteNode::Exclude>::const_iterator exclude=routeNode.excludes.begin();
+           exclude!=routeNode.excludes.end();
+           ++exclude) {
+        RouteGraph::Exclude entry;
+
+        entry.source=GetObjectIndex(objectRefs,exclude->source);
+        entry.targetEdge=exclude->targetIndex;
+
+        excludes.push_back(entry);
+      }
+    }
+
+    scanner.Close();
+
+    // Nodes without incoming paths can only be the start of a route, where the
+    // coordinates are not used. We take those of the first neighbour.
+    for (uint32_t n=0; n<nodeCount; n++) {
+      if (!hasCoord[n] &&
+          nodes[n].firstEdge<(n+1<nodeCount ? nodes[n+1].firstEdge : edges.size())) {
+        nodes[n].lat=nodes[edges[nodes[n].firstEdge].target].lat;
+        nodes[n].lon=nodes[edges[nodes[n].firstEdge].target].lon;
+      }
+    }
+
+    RouteGraph::Node sentinel;
+
+    sentinel.offset=0;
+    sentinel.lat=0;
+    sentinel.lon=0;
+    sentinel.firstEdge=(uint32_t)edges.size();
+    sentinel.firstExclude=(uint32_t)excludes.size();
+
+    nodes.push_back(sentinel);
+
+    objects.reserve(objectRefs.size());
+
+    for (std::vector<ObjectFileRef>::const_iterator ref=objectRefs.begin();
+         ref!=objectRefs.end();
+         ++ref) {
+      RouteGraph::Object object;
+
+      object.offset=ref->GetFileOffset();
+      object.type=ref->GetType();
+      object.reserved=0;
+
+      objects.push_back(object);
+    }
+
+    progress.Info(NumberToString(nodeCount)+" nodes, "+
+                  NumberToString(edges.size())+" edges, "+
+                  NumberToString(excludes.size())+" excludes, "+
+                  NumberToString(objects.size())+" objects");
+
+    progress.SetAction("Writing '"+graphFilename+"'");
+
+    if (!RouteGraph::Write(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                           graphFilename),
+                           nodes,
+                           edges,
+                           excludes,
+                           objects)) {
+      progress.Error("Cannot write '"+graphFilename+"'");
+      return false;
+    }
+
+    return true;
+  }
+}
@@ -35,6 +35,28 @@
 
 namespace osmscout {
 
+  /**
+    Return the coordinate of the given node, nodeIds is the sorted list of
+    node ids passed to CoordDataFile::Get().
+    */
+  static const Point* FindCoord(const std::vector<OSMId>& nodeIds,
+                                const std::vector<Point>& coords,
+                                const std::vector<bool>& found,
+                                OSMId nodeId)
+  {
+    std::vector<OSMId>::const_iterator id=std::lower_bound(nodeIds.begin(),
+                                                           nodeIds.end(),
+                                                           nodeId);
+
+    if (id==nodeIds.end() ||
+        *id!=nodeId ||
+        !found[id-nodeIds.begin()]) {
+      return NULL;
+    }
+
+    return &coords[id-nodeIds.begin()];
+  }
+
   void WayAreaDataGenerator::GetWayTypes(const TypeConfig& typeConfig,
                                          std::set<TypeId>& types) const
   {
@@ -213,7 +235,9 @@ namespace osmscout {
                                       const TypeConfig& typeConfig,
                                       FileWriter& writer,
                                       uint32_t& writtenWayCount,
-                                      const CoordDataFile::CoordResultMap& coordsMap,
+                                      const std::vector<OSMId>& nodeIds,
+                                      const std::vector<Point>& coords,
+                                      const std::vector<bool>& found,
                                       const RawWay& rawWay)
   {
     std::vector<Tag> tags(rawWay.GetTags());
@@ -234,9 +258,12 @@ namespace osmscout {
 
     bool success=true;
     for (size_t n=0; n<rawWay.GetNodeCount(); n++) {
-      CoordDataFile::CoordResultMap::const_iterator coord=coordsMap.find(rawWay.GetNodeId(n));
+      const Point* coord=FindCoord(nodeIds,
+                                   coords,
+                                   found,
+                                   rawWay.GetNodeId(n));
 
-      if (coord==coordsMap.end()) {
+      if (coord==NULL) {
         progress.Error("Cannot resolve node with id "+
                        NumberToString(rawWay.GetNodeId(n))+
                        " for Way "+
@@ -245,9 +272,9 @@ namespace osmscout {
         break;
       }
 
-      ring.ids[n]=coord->second.point.GetId();
+      ring.ids[n]=coord->GetId();
 
-      ring.nodes[n]=coord->second.point.GetCoords();
+      ring.nodes[n]=coord->GetCoords();
     }
 
     if (!success) {
@@ -330,26 +357,31 @@ namespace osmscout {
 
       collectedWaysCount++;
 
-      std::set<OSMId>               nodeIds;
-      CoordDataFile::CoordResultMap coordsMap;
+      std::vector<OSMId> nodeIds;
+      std::vector<Point> coords;
+      std::vector<bool>  found;
 
       for (size_t n=0; n<way->GetNodeCount(); n++) {
-        nodeIds.insert(way->GetNodeId(n));
+        nodeIds.push_back(way->GetNodeId(n));
       }
 
-      if (!coordDataFile.Get(nodeIds,coordsMap)) {
+      std::sort(nodeIds.begin(),nodeIds.end());
+      nodeIds.erase(std::unique(nodeIds.begin(),nodeIds.end()),
+                    nodeIds.end());
+
+      if (!coordDataFile.Get(nodeIds,coords,found)) {
         std::cerr << "Cannot read nodes!" << std::endl;
         return false;
       }
 
-      nodeIds.clear();
-
       if (!WriteWay(parameter,
                     progress,
                     typeConfig,
                     writer,
                     writtenWayCount,
-                    coordsMap,
+                    nodeIds,
+                    coords,
+                    found,
                     way)) {
         return false;
       }
@@ -445,8 +477,9 @@ namespace osmscout {
 
       progress.SetAction("Collecting node ids");
 
-      std::set<OSMId>               nodeIds;
-      CoordDataFile::CoordResultMap coordsMap;
+      std::vector<OSMId> nodeIds;
+      std::vector<Point> coords;
+      std::vector<bool>  found;
 
       for (size_t type=0; type<areasByType.size(); type++) {
         for (std::list<RawWayRef>::const_iterator w=areasByType[type].begin();
@@ -455,19 +488,21 @@ namespace osmscout {
           RawWayRef areas(*w);
 
           for (size_t n=0; n<areas->GetNodeCount(); n++) {
-            nodeIds.insert(areas->GetNodeId(n));
+            nodeIds.push_back(areas->GetNodeId(n));
           }
         }
       }
 
       if (!nodeIds.empty()) {
+        std::sort(nodeIds.begin(),nodeIds.end());
+        nodeIds.erase(std::unique(nodeIds.begin(),nodeIds.end()),
+                      nodeIds.end());
+
         progress.SetAction("Loading "+NumberToString(nodeIds.size())+" nodes");
-        if (!coordDataFile.Get(nodeIds,coordsMap)) {
+        if (!coordDataFile.Get(nodeIds,coords,found)) {
           std::cerr << "Cannot read nodes!" << std::endl;
           return false;
         }
-
-        nodeIds.clear();
       }
 
       progress.SetAction("Writing ways");
@@ -483,7 +518,9 @@ namespace osmscout {
                    typeConfig,
                    wayWriter,
                    writtenWayCount,
-                   coordsMap,
+                   nodeIds,
+                   coords,
+                   found,
                    *rawWay);
         }
 
@@ -35,6 +35,28 @@
 
 namespace osmscout {
 
+  /**
+    Return the coordinate of the given node, nodeIds is the sorted list of
+    node ids passed to CoordDataFile::Get().
+    */
+  static const Point* FindCoord(const std::vector<OSMId>& nodeIds,
+                                const std::vector<Point>& coords,
+                                const std::vector<bool>& found,
+                                OSMId nodeId)
+  {
+    std::vector<OSMId>::const_iterator id=std::lower_bound(nodeIds.begin(),
+                                                           nodeIds.end(),
+                                                           nodeId);
+
+    if (id==nodeIds.end() ||
+        *id!=nodeId ||
+        !found[id-nodeIds.begin()]) {
+      return NULL;
+    }
+
+    return &coords[id-nodeIds.begin()];
+  }
+
   static inline bool WayByNodeCountSorter(const RawWayRef& a,
                                           const RawWayRef& b)
   {
@@ -455,7 +477,9 @@ namespace osmscout {
                                      const TypeConfig& typeConfig,
                                      FileWriter& writer,
                                      uint32_t& writtenWayCount,
-                                     const CoordDataFile::CoordResultMap& coordsMap,
+                                     const std::vector<OSMId>& nodeIds,
+                                     const std::vector<Point>& coords,
+                                     const std::vector<bool>& found,
                                      const RawWay& rawWay)
   {
     std::vector<Tag> tags(rawWay.GetTags());
@@ -476,9 +500,12 @@ namespace osmscout {
 
     bool success=true;
     for (size_t n=0; n<rawWay.GetNodeCount(); n++) {
-      CoordDataFile::CoordResultMap::const_iterator coord=coordsMap.find(rawWay.GetNodeId(n));
+      const Point* coord=FindCoord(nodeIds,
+                                   coords,
+                                   found,
+                                   rawWay.GetNodeId(n));
 
-      if (coord==coordsMap.end()) {
+      if (coord==NULL) {
         progress.Error("Cannot resolve node with id "+
                        NumberToString(rawWay.GetNodeId(n))+
                        " for Way "+
@@ -487,9 +514,9 @@ namespace osmscout {
         break;
       }
 
-      way.ids[n]=coord->second.point.GetId();
+      way.ids[n]=coord->GetId();
 
-      way.nodes[n]=coord->second.point.GetCoords();
+      way.nodes[n]=coord->GetCoords();
     }
 
     if (!success) {
@@ -615,8 +642,9 @@ namespace osmscout {
 
       progress.SetAction("Collecting node ids");
 
-      std::set<OSMId>               nodeIds;
-      CoordDataFile::CoordResultMap coordsMap;
+      std::vector<OSMId> nodeIds;
+      std::vector<Point> coords;
+      std::vector<bool>  found;
 
       for (size_t type=0; type<waysByType.size(); type++) {
         for (std::list<RawWayRef>::const_iterator w=waysByType[type].begin();
@@ -625,19 +653,21 @@ namespace osmscout {
           RawWayRef way(*w);
 
           for (size_t n=0; n<way->GetNodeCount(); n++) {
-            nodeIds.insert(way->GetNodeId(n));
+            nodeIds.push_back(way->GetNodeId(n));
           }
         }
       }
 
+      std::sort(nodeIds.begin(),nodeIds.end());
+      nodeIds.erase(std::unique(nodeIds.begin(),nodeIds.end()),
+                    nodeIds.end());
+
       progress.SetAction("Loading "+NumberToString(nodeIds.size())+" nodes");
-      if (!coordDataFile.Get(nodeIds,coordsMap)) {
+      if (!coordDataFile.Get(nodeIds,coords,found)) {
         std::cerr << "Cannot read nodes!" << std::endl;
         return false;
       }
 
-      nodeIds.clear();
-
       progress.SetAction("Writing ways");
 
       for (size_t type=0; type<waysByType.size(); type++) {
@@ -650,7 +680,9 @@ namespace osmscout {
                    typeConfig,
                    wayWriter,
                    writtenWayCount,
-                   coordsMap,
+                   nodeIds,
+                   coords,
+                   found,
                    *rawWay);
         }
 
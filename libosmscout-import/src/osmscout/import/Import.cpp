@@ -19,7 +19,17 @@
 
 #include <osmscout/import/Import.h>
 
+#include <algorithm>
 #include <iostream>
+#include <vector>
+
+#include <osmscout/CoreFeatures.h>
+
+#if defined(OSMSCOUT_HAVE_THREAD)
+  #include <condition_variable>
+  #include <mutex>
+  #include <thread>
+#endif
 
 #include <osmscout/TypeConfigLoader.h>
 #include <osmscout/Types.h>
@@ -32,6 +42,7 @@
 #include <osmscout/Router.h>
 #include <osmscout/RouteNode.h>
 #include <osmscout/Intersection.h>
+#include <osmscout/LocationIndex.h>
 
 #include <osmscout/import/GenTypeDat.h>
 
@@ -64,6 +75,8 @@
 
 // Routing
 #include <osmscout/import/GenRouteDat.h>
+#include <osmscout/import/GenRouteCHDat.h>
+#include <osmscout/import/GenRouteGraphDat.h>
 
 #if defined(OSMSCOUT_IMPORT_HAVE_LIB_MARISA)
 #include <osmscout/import/GenTextIndex.h>
@@ -76,26 +89,31 @@ namespace osmscout {
 
   static const size_t defaultStartStep=1;
 #if defined(OSMSCOUT_IMPORT_HAVE_LIB_MARISA)
-  static const size_t defaultEndStep=27;
+  static const size_t defaultEndStep=31;
 #else
-  static const size_t defaultEndStep=26;
+  static const size_t defaultEndStep=30;
 #endif
 
   ImportParameter::ImportParameter()
    : typefile("map.ost"),
      startStep(defaultStartStep),
      endStep(defaultEndStep),
+     moduleThreadCount(1),
+     preprocessThreadCount(1),
      strictAreas(false),
      sortObjects(true),
      sortBlockSize(40000000),
      sortTileMag(13),
+     sortCompressRuns(false),
      numericIndexPageSize(4096),
      coordDataMemoryMaped(false),
+     coordDataCompressed(false),
+     coordDeltaEncoding(false),
      rawNodeDataMemoryMaped(false),
      rawNodeDataCacheSize(10000),
      rawWayIndexMemoryMaped(true),
      rawWayDataMemoryMaped(false),
-     rawWayDataCacheSize(5000),
+     rawWayDataCacheSizeBytes(5*1024*1024),
      rawWayIndexCacheSize(10000),
      rawWayBlockSize(500000),
      areaDataMemoryMaped(false),
@@ -119,10 +137,34 @@ namespace osmscout {
      optimizationCellSizeAverage(64),
      optimizationCellSizeMax(255),
      optimizationWayMethod(TransPolygon::quality),
+     optimizationAllTypes(false),
+     optimizationLevelStep(2),
      routeNodeBlockSize(500000),
+     routeGraph(false),
+     routeCH(false),
+     routeCHMaxSpeed(160.0),
      assumeLand(true)
   {
-    // no code
+    // Same speeds as the car profile of the Routing demo, the costs of the
+    // contraction hierarchy must match the costs of the query profile
+    routeCHSpeedTable["highway_motorway"]=110.0;
+    routeCHSpeedTable["highway_motorway_trunk"]=100.0;
+    routeCHSpeedTable["highway_motorway_primary"]=70.0;
+    routeCHSpeedTable["highway_motorway_link"]=60.0;
+    routeCHSpeedTable["highway_motorway_junction"]=60.0;
+    routeCHSpeedTable["highway_trunk"]=100.0;
+    routeCHSpeedTable["highway_trunk_link"]=60.0;
+    routeCHSpeedTable["highway_primary"]=70.0;
+    routeCHSpeedTable["highway_primary_link"]=60.0;
+    routeCHSpeedTable["highway_secondary"]=60.0;
+    routeCHSpeedTable["highway_secondary_link"]=50.0;
+    routeCHSpeedTable["highway_tertiary"]=55.0;
+    routeCHSpeedTable["highway_unclassified"]=50.0;
+    routeCHSpeedTable["highway_road"]=50.0;
+    routeCHSpeedTable["highway_residential"]=40.0;
+    routeCHSpeedTable["highway_roundabout"]=40.0;
+    routeCHSpeedTable["highway_living_street"]=10.0;
+    routeCHSpeedTable["highway_service"]=30.0;
   }
 
   std::string ImportParameter::GetMapfile() const
@@ -150,6 +192,16 @@ namespace osmscout {
     return endStep;
   }
 
+  size_t ImportParameter::GetModuleThreadCount() const
+  {
+    return moduleThreadCount;
+  }
+
+  size_t ImportParameter::GetPreprocessThreadCount() const
+  {
+    return preprocessThreadCount;
+  }
+
   bool ImportParameter::GetStrictAreas() const
   {
     return strictAreas;
@@ -170,6 +222,11 @@ namespace osmscout {
     return sortTileMag;
   }
 
+  bool ImportParameter::GetSortCompressRuns() const
+  {
+    return sortCompressRuns;
+  }
+
   size_t ImportParameter::GetNumericIndexPageSize() const
   {
     return numericIndexPageSize;
@@ -180,6 +237,16 @@ namespace osmscout {
     return coordDataMemoryMaped;
   }
 
+  bool ImportParameter::GetCoordDataCompressed() const
+  {
+    return coordDataCompressed;
+  }
+
+  bool ImportParameter::GetCoordDeltaEncoding() const
+  {
+    return coordDeltaEncoding;
+  }
+
   bool ImportParameter::GetRawNodeDataMemoryMaped() const
   {
     return rawNodeDataMemoryMaped;
@@ -190,9 +257,9 @@ namespace osmscout {
     return rawWayIndexMemoryMaped;
   }
 
-  size_t ImportParameter::GetRawWayDataCacheSize() const
+  size_t ImportParameter::GetRawWayDataCacheSizeBytes() const
   {
-    return rawWayDataCacheSize;
+    return rawWayDataCacheSizeBytes;
   }
 
   size_t ImportParameter::GetRawWayIndexCacheSize() const
@@ -320,11 +387,41 @@ namespace osmscout {
     return optimizationWayMethod;
   }
 
+  bool ImportParameter::GetOptimizationAllTypes() const
+  {
+    return optimizationAllTypes;
+  }
+
+  size_t ImportParameter::GetOptimizationLevelStep() const
+  {
+    return optimizationLevelStep;
+  }
+
   size_t ImportParameter::GetRouteNodeBlockSize() const
   {
     return routeNodeBlockSize;
   }
 
+  bool ImportParameter::GetRouteGraph() const
+  {
+    return routeGraph;
+  }
+
+  bool ImportParameter::GetRouteCH() const
+  {
+    return routeCH;
+  }
+
+  const std::map<std::string,double>& ImportParameter::GetRouteCHSpeedTable() const
+  {
+    return routeCHSpeedTable;
+  }
+
+  double ImportParameter::GetRouteCHMaxSpeed() const
+  {
+    return routeCHMaxSpeed;
+  }
+
   bool ImportParameter::GetAssumeLand() const
   {
     return assumeLand;
@@ -357,6 +454,16 @@ namespace osmscout {
     this->endStep=endStep;
   }
 
+  void ImportParameter::SetModuleThreadCount(size_t moduleThreadCount)
+  {
+    this->moduleThreadCount=std::max((size_t)1,moduleThreadCount);
+  }
+
+  void ImportParameter::SetPreprocessThreadCount(size_t preprocessThreadCount)
+  {
+    this->preprocessThreadCount=std::max((size_t)1,preprocessThreadCount);
+  }
+
   void ImportParameter::SetStrictAreas(bool strictAreas)
   {
     this->strictAreas=strictAreas;
@@ -377,6 +484,11 @@ namespace osmscout {
     this->sortTileMag=sortTileMag;
   }
 
+  void ImportParameter::SetSortCompressRuns(bool sortCompressRuns)
+  {
+    this->sortCompressRuns=sortCompressRuns;
+  }
+
   void ImportParameter::SetNumericIndexPageSize(size_t numericIndexPageSize)
   {
     this->numericIndexPageSize=numericIndexPageSize;
@@ -387,6 +499,16 @@ namespace osmscout {
     this->coordDataMemoryMaped=memoryMaped;
   }
 
+  void ImportParameter::SetCoordDataCompressed(bool compressed)
+  {
+    this->coordDataCompressed=compressed;
+  }
+
+  void ImportParameter::SetCoordDeltaEncoding(bool deltaEncoding)
+  {
+    this->coordDeltaEncoding=deltaEncoding;
+  }
+
   void ImportParameter::SetRawNodeDataMemoryMaped(bool memoryMaped)
   {
     this->rawNodeDataMemoryMaped=memoryMaped;
@@ -402,9 +524,9 @@ namespace osmscout {
     this->rawWayDataMemoryMaped=memoryMaped;
   }
 
-  void ImportParameter::SetRawWayDataCacheSize(size_t wayDataCacheSize)
+  void ImportParameter::SetRawWayDataCacheSizeBytes(size_t wayDataCacheSizeBytes)
   {
-    this->rawWayDataCacheSize=wayDataCacheSize;
+    this->rawWayDataCacheSizeBytes=wayDataCacheSizeBytes;
   }
 
   void ImportParameter::SetRawWayIndexCacheSize(size_t wayIndexCacheSize)
@@ -530,11 +652,41 @@ namespace osmscout {
     this->optimizationWayMethod=optimizationWayMethod;
   }
 
+  void ImportParameter::SetOptimizationAllTypes(bool optimizationAllTypes)
+  {
+    this->optimizationAllTypes=optimizationAllTypes;
+  }
+
+  void ImportParameter::SetOptimizationLevelStep(size_t optimizationLevelStep)
+  {
+    this->optimizationLevelStep=optimizationLevelStep;
+  }
+
   void ImportParameter::SetRouteNodeBlockSize(size_t blockSize)
   {
     this->routeNodeBlockSize=blockSize;
   }
 
+  void ImportParameter::SetRouteGraph(bool routeGraph)
+  {
+    this->routeGraph=routeGraph;
+  }
+
+  void ImportParameter::SetRouteCH(bool routeCH)
+  {
+    this->routeCH=routeCH;
+  }
+
+  void ImportParameter::SetRouteCHSpeedTable(const std::map<std::string,double>& speedTable)
+  {
+    this->routeCHSpeedTable=speedTable;
+  }
+
+  void ImportParameter::SetRouteCHMaxSpeed(double maxSpeed)
+  {
+    this->routeCHMaxSpeed=maxSpeed;
+  }
+
   void ImportParameter::SetAssumeLand(bool assumeLand)
   {
     this->assumeLand=assumeLand;
@@ -545,13 +697,42 @@ namespace osmscout {
     // no code
   }
 
-  static bool ExecuteModules(std::list<ImportModule*>& modules,
-                            const ImportParameter& parameter,
-                            Progress& progress,
-                            const TypeConfig& typeConfig)
+  /**
+    Declare that the module reads the given file
+    */
+  ImportModule& ImportModule::Requires(const std::string& filename)
   {
-    StopClock overAllTimer;
-    size_t    currentStep=1;
+    requiredFiles.push_back(filename);
+
+    return *this;
+  }
+
+  /**
+    Declare that the module writes the given file
+    */
+  ImportModule& ImportModule::Provides(const std::string& filename)
+  {
+    providedFiles.push_back(filename);
+
+    return *this;
+  }
+
+  const std::list<std::string>& ImportModule::GetRequiredFiles() const
+  {
+    return requiredFiles;
+  }
+
+  const std::list<std::string>& ImportModule::GetProvidedFiles() const
+  {
+    return providedFiles;
+  }
+
+  static bool ExecuteModulesSequential(std::list<ImportModule*>& modules,
+                                      const ImportParameter& parameter,
+                                      Progress& progress,
+                                      const TypeConfig& typeConfig)
+  {
+    size_t currentStep=1;
 
     for (std::list<ImportModule*>::const_iterator module=modules.begin();
          module!=modules.end();
@@ -581,6 +762,330 @@ namespace osmscout {
       currentStep++;
     }
 
+    return true;
+  }
+
+#if defined(OSMSCOUT_HAVE_THREAD)
+  /**
+    Progress collecting the output of a module running in parallel to other
+    modules. The output is passed on after the module has finished, so that
+    the output of different modules does not get mixed. Progress updates are
+    dropped.
+    */
+  class BufferedProgress : public Progress
+  {
+  private:
+    enum Type
+    {
+      typeAction,
+      typeDebug,
+      typeInfo,
+      typeWarning,
+      typeError
+    };
+
+    struct Message
+    {
+      Type        type;
+      std::string text;
+    };
+
+  private:
+    std::list<Message> messages;
+
+  private:
+    void Add(Type type,
+             const std::string& text)
+    {
+      Message message;
+
+      message.type=type;
+      message.text=text;
+
+      messages.push_back(message);
+    }
+
+  public:
+    void SetAction(const std::string& action)
+    {
+      Add(typeAction,action);
+    }
+
+    void Debug(const std::string& text)
+    {
+      Add(typeDebug,text);
+    }
+
+    void Info(const std::string& text)
+    {
+      Add(typeInfo,text);
+    }
+
+    void Warning(const std::string& text)
+    {
+      Add(typeWarning,text);
+    }
+
+    void Error(const std::string& text)
+    {
+      Add(typeError,text);
+    }
+
+    void Replay(Progress& progress) const
+    {
+      for (std::list<Message>::const_iterator message=messages.begin();
+           message!=messages.end();
+           ++message) {
+        switch (message->type) {
+        case typeAction:
+          progress.SetAction(message->text);
+          break;
+        case typeDebug:
+          progress.Debug(message->text);
+          break;
+        case typeInfo:
+          progress.Info(message->text);
+          break;
+        case typeWarning:
+          progress.Warning(message->text);
+          break;
+        case typeError:
+          progress.Error(message->text);
+          break;
+        }
+      }
+    }
+  };
+
+  /**
+    State of the parallel execution of import modules.
+
+    A step depends on each earlier step in the selected range that writes a
+    file it reads, that reads a file it writes or that writes the same file.
+    Steps outside the selected range are assumed to have been executed
+    before. Worker threads pick the first step whose dependencies have
+    finished.
+    */
+  struct ModuleScheduler
+  {
+    struct Task
+    {
+      ImportModule*       module;
+      size_t              step;
+      std::vector<size_t> dependencies; //! Indexes of the tasks that must finish before
+      bool                started;
+      bool                finished;
+    };
+
+    const ImportParameter&  parameter;
+    const TypeConfig&       typeConfig;
+    Progress&               progress;
+    std::vector<Task>       tasks;
+
+    std::mutex              mutex;     //! Guards all following members and progress
+    std::condition_variable changed;
+    size_t                  startedCount;
+    bool                    success;
+
+    ModuleScheduler(const ImportParameter& parameter,
+                    const TypeConfig& typeConfig,
+                    Progress& progress)
+    : parameter(parameter),
+      typeConfig(typeConfig),
+      progress(progress),
+      startedCount(0),
+      success(true)
+    {
+      // no code
+    }
+
+    static bool Intersects(const std::list<std::string>& a,
+                           const std::list<std::string>& b)
+    {
+      for (std::list<std::string>::const_iterator file=a.begin();
+           file!=a.end();
+           ++file) {
+        if (std::find(b.begin(),b.end(),*file)!=b.end()) {
+          return true;
+        }
+      }
+
+      return false;
+    }
+
+    void AddTask(ImportModule* module,
+                 size_t step)
+    {
+      Task task;
+
+      task.module=module;
+      task.step=step;
+      task.started=false;
+      task.finished=false;
+
+      for (size_t t=0; t<tasks.size(); t++) {
+        const ImportModule* other=tasks[t].module;
+
+        if (Intersects(other->GetProvidedFiles(),module->GetRequiredFiles()) ||
+            Intersects(other->GetRequiredFiles(),module->GetProvidedFiles()) ||
+            Intersects(other->GetProvidedFiles(),module->GetProvidedFiles())) {
+          task.dependencies.push_back(t);
+        }
+      }
+
+      tasks.push_back(task);
+    }
+
+    /**
+      Return the index of a task that can be started or tasks.size(), if
+      there currently is none.
+      */
+    size_t GetExecutableTask() const
+    {
+      for (size_t t=0; t<tasks.size(); t++) {
+        if (tasks[t].started) {
+          continue;
+        }
+
+        bool executable=true;
+
+        for (size_t d=0; d<tasks[t].dependencies.size(); d++) {
+          if (!tasks[tasks[t].dependencies[d]].finished) {
+            executable=false;
+            break;
+          }
+        }
+
+        if (executable) {
+          return t;
+        }
+      }
+
+      return tasks.size();
+    }
+
+    void Execute()
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+
+      while (success &&
+             startedCount<tasks.size()) {
+        size_t t=GetExecutableTask();
+
+        if (t==tasks.size()) {
+          changed.wait(lock);
+          continue;
+        }
+
+        Task& task=tasks[t];
+
+        task.started=true;
+        startedCount++;
+
+        lock.unlock();
+
+        BufferedProgress moduleProgress;
+        StopClock        timer;
+        bool             moduleSuccess;
+
+        moduleProgress.SetOutputDebug(progress.OutputDebug());
+
+        moduleSuccess=task.module->Import(parameter,
+                                          moduleProgress,
+                                          typeConfig);
+
+        timer.Stop();
+
+        lock.lock();
+
+        progress.SetStep(std::string("Step #")+
+                         NumberToString(task.step)+
+                         " - "+
+                         task.module->GetDescription());
+
+        moduleProgress.Replay(progress);
+
+        progress.Info(std::string("=> ")+timer.ResultString()+" second(s)");
+
+        if (!moduleSuccess) {
+          progress.Error(std::string("Error while executing step '")+task.module->GetDescription()+"'!");
+          success=false;
+        }
+
+        task.finished=true;
+        changed.notify_all();
+      }
+    }
+  };
+
+  static bool ExecuteModulesParallel(std::list<ImportModule*>& modules,
+                                     const ImportParameter& parameter,
+                                     Progress& progress,
+                                     const TypeConfig& typeConfig)
+  {
+    ModuleScheduler          scheduler(parameter,
+                                       typeConfig,
+                                       progress);
+    std::vector<std::thread> threads;
+    size_t                   currentStep=1;
+
+    for (std::list<ImportModule*>::const_iterator module=modules.begin();
+         module!=modules.end();
+         ++module) {
+      if (currentStep>=parameter.GetStartStep() &&
+          currentStep<=parameter.GetEndStep()) {
+        scheduler.AddTask(*module,
+                          currentStep);
+      }
+
+      currentStep++;
+    }
+
+    for (size_t i=0; i<parameter.GetModuleThreadCount(); i++) {
+      threads.push_back(std::thread(&ModuleScheduler::Execute,
+                                    &scheduler));
+    }
+
+    for (size_t i=0; i<threads.size(); i++) {
+      threads[i].join();
+    }
+
+    return scheduler.success;
+  }
+#endif
+
+  static bool ExecuteModules(std::list<ImportModule*>& modules,
+                             const ImportParameter& parameter,
+                             Progress& progress,
+                             const TypeConfig& typeConfig)
+  {
+    StopClock overAllTimer;
+    bool      success;
+
+#if defined(OSMSCOUT_HAVE_THREAD)
+    if (parameter.GetModuleThreadCount()>1) {
+      success=ExecuteModulesParallel(modules,
+                                     parameter,
+                                     progress,
+                                     typeConfig);
+    }
+    else {
+      success=ExecuteModulesSequential(modules,
+                                       parameter,
+                                       progress,
+                                       typeConfig);
+    }
+#else
+    success=ExecuteModulesSequential(modules,
+                                     parameter,
+                                     progress,
+                                     typeConfig);
+#endif
+
+    if (!success) {
+      return false;
+    }
+
     overAllTimer.Stop();
     progress.Info(std::string("=> ")+overAllTimer.ResultString()+" second(s)");
 
@@ -607,9 +1112,15 @@ namespace osmscout {
 
     /* 1 */
     modules.push_back(new TypeDataGenerator());
+    modules.back()->Provides("types.dat");
 
     /* 2 */
     modules.push_back(new Preprocess());
+    modules.back()->Provides("rawnodes.dat")
+                  .Provides("rawways.dat")
+                  .Provides("rawrels.dat")
+                  .Provides("rawcoastline.dat")
+                  .Provides("coord.dat");
 
     /* 3 */
     modules.push_back(new NumericIndexGenerator<OSMId,RawNode>("Generating 'rawnode.idx'",
@@ -617,68 +1128,142 @@ namespace osmscout {
                                                                                "rawnodes.dat"),
                                                                AppendFileToDir(parameter.GetDestinationDirectory(),
                                                                                "rawnode.idx")));
+    modules.back()->Requires("rawnodes.dat")
+                  .Provides("rawnode.idx");
     /* 4 */
     modules.push_back(new NumericIndexGenerator<OSMId,RawWay>("Generating 'rawway.idx'",
                                                               AppendFileToDir(parameter.GetDestinationDirectory(),
                                                                               "rawways.dat"),
                                                               AppendFileToDir(parameter.GetDestinationDirectory(),
                                                                               "rawway.idx")));
+    modules.back()->Requires("rawways.dat")
+                  .Provides("rawway.idx");
     /* 5 */
     modules.push_back(new NumericIndexGenerator<OSMId,RawRelation>("Generating 'rawrel.idx'",
                                                                    AppendFileToDir(parameter.GetDestinationDirectory(),
                                                                                    "rawrels.dat"),
                                                                    AppendFileToDir(parameter.GetDestinationDirectory(),
                                                                                    "rawrel.idx")));
+    modules.back()->Requires("rawrels.dat")
+                  .Provides("rawrel.idx");
     /* 6 */
     modules.push_back(new TurnRestrictionDataGenerator());
+    modules.back()->Requires("rawrels.dat")
+                  .Provides("rawturnrestr.dat");
 
     /* 7 */
     modules.push_back(new RelAreaDataGenerator());
+    modules.back()->Requires("coord.dat")
+                  .Requires("rawways.dat")
+                  .Requires("rawway.idx")
+                  .Requires("rawrels.dat")
+                  .Requires("rawrel.idx")
+                  .Provides("relarea.tmp")
+                  .Provides("wayareablack.dat");
 
     /* 8 */
     modules.push_back(new WayAreaDataGenerator());
+    modules.back()->Requires("coord.dat")
+                  .Requires("rawways.dat")
+                  .Requires("wayareablack.dat")
+                  .Provides("wayarea.tmp");
 
     /* 9 */
     modules.push_back(new WayWayDataGenerator());
+    modules.back()->Requires("coord.dat")
+                  .Requires("rawways.dat")
+                  .Requires("rawturnrestr.dat")
+                  .Provides("wayway.tmp")
+                  .Provides("turnrestr.dat");
 
     /* 10 */
     modules.push_back(new OptimizeAreaWayIdsGenerator());
+    modules.back()->Requires("relarea.tmp")
+                  .Requires("wayarea.tmp")
+                  .Requires("wayway.tmp")
+                  .Provides("relarea.dat")
+                  .Provides("wayarea.dat")
+                  .Provides("wayway.dat");
 
     /* 11 */
     modules.push_back(new NodeDataGenerator());
+    modules.back()->Requires("rawnodes.dat")
+                  .Provides("nodes.tmp")
+                  .Provides("bounding.dat");
 
     /* 12 */
     modules.push_back(new SortNodeDataGenerator());
+    modules.back()->Requires("nodes.tmp")
+                  .Provides("nodes.dat")
+                  .Provides("nodes.idmap")
+                  .Provides("nodessort.tmp");
 
     /* 13 */
     modules.push_back(new SortAreaDataGenerator());
+    modules.back()->Requires("wayarea.dat")
+                  .Requires("relarea.dat")
+                  .Provides("areas.dat")
+                  .Provides("areas.idmap")
+                  .Provides("areassort.tmp");
 
     /* 14 */
     modules.push_back(new SortWayDataGenerator());
+    modules.back()->Requires("wayway.dat")
+                  .Provides("ways.dat")
+                  .Provides("ways.idmap")
+                  .Provides("wayssort.tmp");
 
     /* 15 */
     modules.push_back(new AreaNodeIndexGenerator());
+    modules.back()->Requires("nodes.dat")
+                  .Provides("areanode.idx");
 
     /* 16 */
     modules.push_back(new AreaWayIndexGenerator());
+    modules.back()->Requires("ways.dat")
+                  .Provides("areaway.idx");
 
     /* 17 */
     modules.push_back(new AreaAreaIndexGenerator());
+    modules.back()->Requires("areas.dat")
+                  .Provides("areaarea.idx");
 
     /* 18 */
     modules.push_back(new WaterIndexGenerator());
+    modules.back()->Requires("rawcoastline.dat")
+                  .Requires("coord.dat")
+                  .Requires("ways.dat")
+                  .Requires("bounding.dat")
+                  .Provides("water.idx");
 
     /* 19 */
     modules.push_back(new OptimizeAreasLowZoomGenerator());
+    modules.back()->Requires("areas.dat")
+                  .Provides(OptimizeAreasLowZoomGenerator::FILE_AREASOPT_DAT);
 
     /* 20 */
     modules.push_back(new OptimizeWaysLowZoomGenerator());
+    modules.back()->Requires("ways.dat")
+                  .Provides(OptimizeWaysLowZoomGenerator::FILE_WAYSOPT_DAT);
 
     /* 21 */
     modules.push_back(new LocationIndexGenerator());
+    modules.back()->Requires("nodes.dat")
+                  .Requires("ways.dat")
+                  .Requires("areas.dat")
+                  .Provides(LocationIndex::FILENAME_LOCATION_IDX)
+                  .Provides("location.txt");
 
     /* 22 */
     modules.push_back(new RouteDataGenerator());
+    modules.back()->Requires("turnrestr.dat")
+                  .Requires("ways.idmap")
+                  .Requires("ways.dat")
+                  .Requires("areas.dat")
+                  .Provides(Router::FILENAME_INTERSECTIONS_DAT)
+                  .Provides(Router::FILENAME_FOOT_DAT)
+                  .Provides(Router::FILENAME_BICYCLE_DAT)
+                  .Provides(Router::FILENAME_CAR_DAT);
 
     /* 23 */
     modules.push_back(new NumericIndexGenerator<Id,Intersection>(std::string("Generating '")+Router::FILENAME_INTERSECTIONS_IDX+"'",
@@ -686,6 +1271,8 @@ namespace osmscout {
                                                                                  Router::FILENAME_INTERSECTIONS_DAT),
                                                                  AppendFileToDir(parameter.GetDestinationDirectory(),
                                                                                  Router::FILENAME_INTERSECTIONS_IDX)));
+    modules.back()->Requires(Router::FILENAME_INTERSECTIONS_DAT)
+                  .Provides(Router::FILENAME_INTERSECTIONS_IDX);
 
     /* 24 */
     modules.push_back(new NumericIndexGenerator<Id,RouteNode>(std::string("Generating '")+Router::FILENAME_FOOT_IDX+"'",
@@ -693,6 +1280,8 @@ namespace osmscout {
                                                                               Router::FILENAME_FOOT_DAT),
                                                               AppendFileToDir(parameter.GetDestinationDirectory(),
                                                                               Router::FILENAME_FOOT_IDX)));
+    modules.back()->Requires(Router::FILENAME_FOOT_DAT)
+                  .Provides(Router::FILENAME_FOOT_IDX);
 
     /* 25 */
     modules.push_back(new NumericIndexGenerator<Id,RouteNode>(std::string("Generating '")+Router::FILENAME_BICYCLE_IDX+"'",
@@ -700,6 +1289,8 @@ namespace osmscout {
                                                                               Router::FILENAME_BICYCLE_DAT),
                                                               AppendFileToDir(parameter.GetDestinationDirectory(),
                                                                               Router::FILENAME_BICYCLE_IDX)));
+    modules.back()->Requires(Router::FILENAME_BICYCLE_DAT)
+                  .Provides(Router::FILENAME_BICYCLE_IDX);
 
     /* 26 */
     modules.push_back(new NumericIndexGenerator<Id,RouteNode>(std::string("Generating '")+Router::FILENAME_CAR_IDX+"'",
@@ -707,12 +1298,48 @@ namespace osmscout {
                                                                               Router::FILENAME_CAR_DAT),
                                                               AppendFileToDir(parameter.GetDestinationDirectory(),
                                                                               Router::FILENAME_CAR_IDX)));
+    modules.back()->Requires(Router::FILENAME_CAR_DAT)
+                  .Provides(Router::FILENAME_CAR_IDX);
 
 #if defined(OSMSCOUT_IMPORT_HAVE_LIB_MARISA)
     /* 27 */
     modules.push_back(new TextIndexGenerator());
+    modules.back()->Requires("nodes.dat")
+                  .Requires("ways.dat")
+                  .Requires("areas.dat")
+                  .Provides("textpoi.dat")
+                  .Provides("textloc.dat")
+                  .Provides("textregion.dat")
+                  .Provides("textother.dat");
 #endif
 
+    // New steps are appended, so the numbers of the existing steps do not change
+
+    /* 28 */
+    modules.push_back(new RouteCHDataGenerator(vehicleCar,
+                                               Router::FILENAME_CAR_DAT,
+                                               Router::FILENAME_CAR_CH_DAT));
+    modules.back()->Requires(Router::FILENAME_CAR_DAT)
+                  .Provides(Router::FILENAME_CAR_CH_DAT);
+
+    /* 29 */
+    modules.push_back(new RouteGraphDataGenerator(Router::FILENAME_FOOT_DAT,
+                                                  Router::FILENAME_FOOT_GRAPH_DAT));
+    modules.back()->Requires(Router::FILENAME_FOOT_DAT)
+                  .Provides(Router::FILENAME_FOOT_GRAPH_DAT);
+
+    /* 30 */
+    modules.push_back(new RouteGraphDataGenerator(Router::FILENAME_BICYCLE_DAT,
+                                                  Router::FILENAME_BICYCLE_GRAPH_DAT));
+    modules.back()->Requires(Router::FILENAME_BICYCLE_DAT)
+                  .Provides(Router::FILENAME_BICYCLE_GRAPH_DAT);
+
+    /* 31 */
+    modules.push_back(new RouteGraphDataGenerator(Router::FILENAME_CAR_DAT,
+                                                  Router::FILENAME_CAR_GRAPH_DAT));
+    modules.back()->Requires(Router::FILENAME_CAR_DAT)
+                  .Provides(Router::FILENAME_CAR_GRAPH_DAT);
+
     bool result=ExecuteModules(modules,parameter,progress,typeConfig);
 
     for (std::list<ImportModule*>::iterator module=modules.begin();
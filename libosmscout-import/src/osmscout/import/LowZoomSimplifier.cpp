@@ -0,0 +1,334 @@
+/*
+  This source is part of the libosmscout library
+  Copyright (C) 2013  Tim Teulings
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+#include <osmscout/import/LowZoomSimplifier.h>
+
+#include <algorithm>
+
+namespace osmscout {
+
+  bool LowZoomSimplifier::IsJunction(Id id) const
+  {
+    return id!=0 &&
+           std::binary_search(junctions.begin(),
+                              junctions.end(),
+                              id);
+  }
+
+  /**
+    Simplifies the count nodes starting at start (wrapping around at the end
+    of nodes) and marks the nodes to keep. The first and the last node are
+    always kept.
+    */
+  void LowZoomSimplifier::SimplifyChain(const Projection& projection,
+                                        TransPolygon::OptimizeMethod optimizeMethod,
+                                        const std::vector<Id>& ids,
+                                        const std::vector<GeoCoord>& nodes,
+                                        size_t start,
+                                        size_t count)
+  {
+    size_t size=nodes.size();
+    size_t end=(start+count-1)%size;
+
+    keep[start]=true;
+    keep[end]=true;
+
+    if (count<=2) {
+      return;
+    }
+
+    // Simplify always in the direction of the smaller id, so both objects
+    // sharing this part get the same result
+    bool reverse=ids[start]>ids[end] ||
+                 (ids[start]==ids[end] &&
+                  ids[(start+1)%size]>ids[(start+count-2)%size]);
+
+    chain.clear();
+
+    for (size_t i=0; i<count; i++) {
+      chain.push_back(nodes[(start+i)%size]);
+    }
+
+    if (reverse) {
+      std::reverse(chain.begin(),chain.end());
+    }
+
+    polygon.TransformWay(projection,
+                         optimizeMethod,
+                         chain,
+                         1.0);
+
+    if (polygon.IsEmpty()) {
+      return;
+    }
+
+    for (size_t i=polygon.GetStart(); i<=polygon.GetEnd(); i++) {
+      if (polygon.points[i].draw) {
+        keep[(start+(reverse ? count-1-i : i))%size]=true;
+      }
+    }
+  }
+
+  void LowZoomSimplifier::GetKeptNodes(const Projection& projection,
+                                       const std::vector<GeoCoord>& nodes,
+                                       std::vector<GeoCoord>& simplified,
+                                       double& width,
+                                       double& height) const
+  {
+    double xmin=0.0;
+    double xmax=0.0;
+    double ymin=0.0;
+    double ymax=0.0;
+
+    simplified.clear();
+
+    for (size_t i=0; i<nodes.size(); i++) {
+      if (!keep[i]) {
+        continue;
+      }
+
+      double x;
+      double y;
+
+      projection.GeoToPixel(nodes[i].GetLon(),
+                            nodes[i].GetLat(),
+                            x,y);
+
+      if (simplified.empty()) {
+        xmin=x;
+        xmax=x;
+        ymin=y;
+        ymax=y;
+      }
+      else {
+        xmin=std::min(xmin,x);
+        xmax=std::max(xmax,x);
+        ymin=std::min(ymin,y);
+        ymax=std::max(ymax,y);
+      }
+
+      simplified.push_back(nodes[i]);
+    }
+
+    width=xmax-xmin;
+    height=ymax-ymin;
+  }
+
+  void LowZoomSimplifier::Clear()
+  {
+    edges.clear();
+    junctions.clear();
+  }
+
+  /**
+    Registers the (not explicitly closed) ring with the given node ids.
+    */
+  void LowZoomSimplifier::AddRing(const std::vector<Id>& ids)
+  {
+    for (size_t i=0; i<ids.size(); i++) {
+      Id a=ids[i];
+      Id b=ids[(i+1)%ids.size()];
+
+      if (a==0 ||
+          b==0 ||
+          a==b) {
+        continue;
+      }
+
+      edges.push_back(std::make_pair(std::min(a,b),
+                                     std::max(a,b)));
+    }
+  }
+
+  /**
+    Calculates the junctions of the rings registered using AddRing(). A
+    junction is a node connected to more than two other nodes, so it is the
+    start or the end of a border shared by rings (or the meeting point of
+    rings). Nodes within a shared border are not junctions.
+    */
+  void LowZoomSimplifier::CalculateJunctions()
+  {
+    std::sort(edges.begin(),edges.end());
+    edges.erase(std::unique(edges.begin(),edges.end()),
+                edges.end());
+
+    junctions.clear();
+    junctions.reserve(edges.size()*2);
+
+    for (std::vector<std::pair<Id,Id> >::const_iterator edge=edges.begin();
+         edge!=edges.end();
+         ++edge) {
+      junctions.push_back(edge->first);
+      junctions.push_back(edge->second);
+    }
+
+    edges.clear();
+
+    std::sort(junctions.begin(),junctions.end());
+
+    size_t junctionCount=0;
+    size_t i=0;
+
+    while (i<junctions.size()) {
+      size_t j=i+1;
+
+      while (j<junctions.size() &&
+             junctions[j]==junctions[i]) {
+        j++;
+      }
+
+      if (j-i>2) {
+        junctions[junctionCount]=junctions[i];
+        junctionCount++;
+      }
+
+      i=j;
+    }
+
+    junctions.resize(junctionCount);
+  }
+
+  /**
+    Simplifies the given (not explicitly closed) area ring for the given
+    projection. Junctions are kept. width and height return the size of
+    the bounding box of the result in pixel.
+    */
+  void LowZoomSimplifier::SimplifyRing(const Projection& projection,
+                                       TransPolygon::OptimizeMethod optimizeMethod,
+                                       const std::vector<Id>& ids,
+                                       const std::vector<GeoCoord>& nodes,
+                                       std::vector<GeoCoord>& simplified,
+                                       double& width,
+                                       double& height)
+  {
+    size_t first=nodes.size();
+
+    if (ids.size()==nodes.size()) {
+      // Start at a junction or, if there is none, at the node with the
+      // smallest id, so identical rings (like the outer ring of an area
+      // filling the hole of another area) get identical results
+      for (size_t i=0; i<ids.size(); i++) {
+        if (ids[i]==0) {
+          first=nodes.size();
+          break;
+        }
+
+        if (IsJunction(ids[i])) {
+          first=i;
+          break;
+        }
+
+        if (first>=nodes.size() ||
+            ids[i]<ids[first]) {
+          first=i;
+        }
+      }
+    }
+
+    keep.assign(nodes.size(),false);
+
+    if (first>=nodes.size()) {
+      // No node ids, simplify the ring as a whole
+      polygon.TransformArea(projection,
+                            optimizeMethod,
+                            nodes,
+                            1.0);
+
+      if (!polygon.IsEmpty()) {
+        for (size_t i=polygon.GetStart(); i<=polygon.GetEnd(); i++) {
+          keep[i]=polygon.points[i].draw;
+        }
+      }
+    }
+    else {
+      size_t start=0;
+
+      for (size_t i=1; i<=nodes.size(); i++) {
+        if (i==nodes.size() ||
+            IsJunction(ids[(first+i)%nodes.size()])) {
+          SimplifyChain(projection,
+                        optimizeMethod,
+                        ids,
+                        nodes,
+                        (first+start)%nodes.size(),
+                        i-start+1);
+
+          start=i;
+        }
+      }
+    }
+
+    GetKeptNodes(projection,
+                 nodes,
+                 simplified,
+                 width,
+                 height);
+  }
+
+  /**
+    Returns true, if low zoom data should be generated for the given type.
+    */
+  bool LowZoomSimplifier::IsTypeToOptimize(const ImportParameter& parameter,
+                                           const TypeInfo& type)
+  {
+    if (type.GetId()==typeIgnore ||
+        type.GetIgnore()) {
+      return false;
+    }
+
+    return type.GetOptimizeLowZoom() ||
+           parameter.GetOptimizationAllTypes();
+  }
+
+  /**
+    Returns the magnification levels to generate low zoom data for. Types
+    marked with OPTIMIZE_LOW_ZOOM get all levels between the minimum and
+    the maximum optimization level, all other types only every
+    GetOptimizationLevelStep()th level, counted down from the maximum level.
+    Queries use the data of the next level not below the requested one.
+    */
+  void LowZoomSimplifier::GetOptimizationLevels(const ImportParameter& parameter,
+                                                const TypeInfo& type,
+                                                std::vector<uint32_t>& levels)
+  {
+    size_t minLevel=parameter.GetOptimizationMinMag();
+    size_t maxLevel=parameter.GetOptimizationMaxMag();
+    size_t step=type.GetOptimizeLowZoom() ? 1 : std::max((size_t)1,parameter.GetOptimizationLevelStep());
+
+    levels.clear();
+
+    if (maxLevel<minLevel) {
+      return;
+    }
+
+    size_t level=maxLevel;
+
+    while (true) {
+      levels.push_back((uint32_t)level);
+
+      if (level<minLevel+step) {
+        break;
+      }
+
+      level-=step;
+    }
+
+    std::reverse(levels.begin(),levels.end());
+  }
+}
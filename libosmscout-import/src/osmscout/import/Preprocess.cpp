@@ -21,9 +21,12 @@
 
 #include <limits>
 
+#include <osmscout/CoordDataFile.h>
+
 #include <osmscout/system/Math.h>
 
 #include <osmscout/util/File.h>
+#include <osmscout/util/Number.h>
 #include <osmscout/util/String.h>
 
 #include <osmscout/import/RawCoastline.h>
@@ -44,6 +47,7 @@
 namespace osmscout {
 
   static uint32_t coordPageSize=64;
+  static uint32_t coordBlockSize=256;
 
   bool Preprocess::StoreCurrentPage()
   {
@@ -70,10 +74,77 @@ namespace osmscout {
     return !coordWriter.HasError();
   }
 
+  /**
+    Encode the collected coordinates as a block of the compressed
+    coord.dat format (see CoordDataFile) and write it.
+    */
+  bool Preprocess::StoreCurrentBlock()
+  {
+    if (blockEntryIds.empty()) {
+      return true;
+    }
+
+    FileOffset blockOffset;
+    char       buffer[10];
+    int64_t    lastLat=0;
+    int64_t    lastLon=0;
+
+    if (!coordWriter.GetPos(blockOffset)) {
+      return false;
+    }
+
+    blockBuffer.clear();
+
+    for (size_t i=0; i<blockEntryIds.size(); i++) {
+      unsigned int bytes;
+
+      if (i>0) {
+        bytes=EncodeNumber((uint64_t)(blockEntryIds[i]-blockEntryIds[i-1]),
+                           buffer);
+        blockBuffer.insert(blockBuffer.end(),buffer,buffer+bytes);
+      }
+
+      bytes=EncodeNumber((int64_t)blockLats[i]-lastLat,
+                         buffer);
+      blockBuffer.insert(blockBuffer.end(),buffer,buffer+bytes);
+
+      bytes=EncodeNumber((int64_t)blockLons[i]-lastLon,
+                         buffer);
+      blockBuffer.insert(blockBuffer.end(),buffer,buffer+bytes);
+
+      lastLat=blockLats[i];
+      lastLon=blockLons[i];
+    }
+
+    blockIds.push_back(blockEntryIds.front());
+    blockOffsets.push_back(blockOffset);
+
+    blockEntryIds.clear();
+    blockLats.clear();
+    blockLons.clear();
+
+    return coordWriter.Write(&blockBuffer[0],blockBuffer.size());
+  }
+
   bool Preprocess::StoreCoord(OSMId id,
                               double lat,
                               double lon)
   {
+    if (coordCompressed) {
+      // Nodes are sorted by id, so coordinates are just appended
+      blockEntryIds.push_back(id);
+      blockLats.push_back((uint32_t)floor((lat+90.0)*conversionFactor+0.5));
+      blockLons.push_back((uint32_t)floor((lon+180.0)*conversionFactor+0.5));
+
+      coordCount++;
+
+      if (blockEntryIds.size()==coordBlockSize) {
+        return StoreCurrentBlock();
+      }
+
+      return true;
+    }
+
     PageId relatedId=id-std::numeric_limits<Id>::min();
     PageId pageId=relatedId/coordPageSize;
     FileOffset coordPageOffset=relatedId%coordPageSize;
@@ -163,9 +234,15 @@ namespace osmscout {
 
   bool Preprocess::Initialize(const ImportParameter& parameter)
   {
+    coordCompressed=parameter.GetCoordDataCompressed();
+
     coordPageCount=0;
     currentPageId=std::numeric_limits<PageId>::max();
 
+    coordCount=0;
+    blockIds.clear();
+    blockOffsets.clear();
+
     nodeCount=0;
     wayCount=0;
     areaCount=0;
@@ -201,15 +278,26 @@ namespace osmscout {
 
     FileOffset offset=0;
 
-    coordWriter.Write(coordPageSize);
-    coordWriter.Write(offset);
-    coordWriter.FlushCurrentBlockWithZeros(coordPageSize*2*sizeof(uint32_t));
+    if (coordCompressed) {
+      coordWriter.Write(CoordDataFile::compressedFormatMarker);
+      coordWriter.Write(coordBlockSize);
+      coordWriter.Write(offset);
+
+      blockEntryIds.reserve(coordBlockSize);
+      blockLats.reserve(coordBlockSize);
+      blockLons.reserve(coordBlockSize);
+    }
+    else {
+      coordWriter.Write(coordPageSize);
+      coordWriter.Write(offset);
+      coordWriter.FlushCurrentBlockWithZeros(coordPageSize*2*sizeof(uint32_t));
 
-    coordPageCount++;
+      coordPageCount++;
 
-    lats.resize(coordPageSize);
-    lons.resize(coordPageSize);
-    isSet.resize(coordPageSize);
+      lats.resize(coordPageSize);
+      lons.resize(coordPageSize);
+      isSet.resize(coordPageSize);
+    }
 
     return !nodeWriter.HasError() &&
            !wayWriter.HasError() &&
@@ -222,7 +310,7 @@ namespace osmscout {
                                const OSMId& id,
                                const double& lon,
                                const double& lat,
-                               const std::map<TagId,std::string>& tagMap)
+                               const TagView& tagView)
   {
     RawNode    node;
     TypeId     type=typeIgnore;
@@ -232,10 +320,10 @@ namespace osmscout {
       nodeSortingError=true;
     }
 
-    typeConfig.GetNodeTypeId(tagMap,type);
+    typeConfig.GetNodeTypeId(tagView,type);
 
     if (type!=typeIgnore) {
-      typeConfig.ResolveTags(tagMap,tags);
+      typeConfig.ResolveTags(tagView,tags);
 
       nodeWriter.GetPos(nodeOffset);
 
@@ -262,15 +350,15 @@ namespace osmscout {
   void Preprocess::ProcessWay(const TypeConfig& typeConfig,
                               const OSMId& id,
                               std::vector<OSMId>& nodes,
-                              const std::map<TagId,std::string>& tagMap)
+                              const TagView& tagView)
   {
-    TypeId                                      areaType=typeIgnore;
-    TypeId                                      wayType=typeIgnore;
-    int                                         isArea=0; // 0==unknown, 1==true, -1==false
-    std::map<TagId,std::string>::const_iterator areaTag;
-    std::map<TagId,std::string>::const_iterator naturalTag;
-    RawWay                                      way;
-    bool                                        isCoastline=false;
+    TypeId        areaType=typeIgnore;
+    TypeId        wayType=typeIgnore;
+    int           isArea=0; // 0==unknown, 1==true, -1==false
+    const TagRef* areaTag;
+    const TagRef* naturalTag;
+    RawWay        way;
+    bool          isCoastline=false;
 
     if (id<lastWayId) {
       waySortingError=true;
@@ -278,29 +366,29 @@ namespace osmscout {
 
     way.SetId(id);
 
-    areaTag=tagMap.find(typeConfig.tagArea);
+    areaTag=tagView.Find(typeConfig.tagArea);
 
-    if (areaTag==tagMap.end()) {
+    if (areaTag==NULL) {
       isArea=0;
     }
-    else if (areaTag->second=="no" ||
-             areaTag->second=="false" ||
-             areaTag->second=="0") {
+    else if (*areaTag=="no" ||
+             *areaTag=="false" ||
+             *areaTag=="0") {
       isArea=-1;
     }
     else {
       isArea=1;
     }
 
-    naturalTag=tagMap.find(typeConfig.tagNatural);
+    naturalTag=tagView.Find(typeConfig.tagNatural);
 
-    if (naturalTag!=tagMap.end() &&
-        naturalTag->second=="coastline") {
+    if (naturalTag!=NULL &&
+        *naturalTag=="coastline") {
       isCoastline=true;
     }
 
-    typeConfig.GetWayAreaTypeId(tagMap,wayType,areaType);
-    typeConfig.ResolveTags(tagMap,tags);
+    typeConfig.GetWayAreaTypeId(tagView,wayType,areaType);
+    typeConfig.ResolveTags(tagView,tags);
 
     if (isArea==1 &&
         areaType==typeIgnore) {
@@ -392,7 +480,7 @@ namespace osmscout {
   void Preprocess::ProcessRelation(const TypeConfig& typeConfig,
                                    const OSMId& id,
                                    const std::vector<RawRelation::Member>& members,
-                                   const std::map<TagId,std::string>& tagMap)
+                                   const TagView& tagView)
   {
     RawRelation relation;
     TypeId      type;
@@ -404,8 +492,8 @@ namespace osmscout {
     relation.SetId(id);
     relation.members=members;
 
-    typeConfig.GetRelationTypeId(tagMap,type);
-    typeConfig.ResolveTags(tagMap,relation.tags);
+    typeConfig.GetRelationTypeId(tagView,type);
+    typeConfig.ResolveTags(tagView,relation.tags);
 
     relation.SetType(type);
 
@@ -415,24 +503,12 @@ namespace osmscout {
     lastRelationId=id;
   }
 
-  bool Preprocess::Cleanup(Progress& progress)
+  bool Preprocess::WriteCoordPageIndex()
   {
     if (currentPageId!=0) {
       StoreCurrentPage();
     }
 
-    nodeWriter.SetPos(0);
-    nodeWriter.Write(nodeCount);
-
-    wayWriter.SetPos(0);
-    wayWriter.Write(wayCount+areaCount);
-
-    relationWriter.SetPos(0);
-    relationWriter.Write(relationCount);
-
-    coastlineWriter.SetPos(0);
-    coastlineWriter.Write(coastlineCount);
-
     coordWriter.SetPos(0);
 
     coordWriter.Write(coordPageSize);
@@ -451,6 +527,57 @@ namespace osmscout {
       coordWriter.Write(entry->second);
     }
 
+    return !coordWriter.HasError();
+  }
+
+  bool Preprocess::WriteCoordBlockDirectory()
+  {
+    FileOffset directoryOffset;
+
+    if (!StoreCurrentBlock()) {
+      return false;
+    }
+
+    if (!coordWriter.GetPos(directoryOffset)) {
+      return false;
+    }
+
+    coordWriter.Write((uint32_t)blockIds.size());
+    coordWriter.Write(coordCount);
+
+    for (size_t i=0; i<blockIds.size(); i++) {
+      coordWriter.Write(blockIds[i]);
+      coordWriter.Write(blockOffsets[i]);
+    }
+
+    coordWriter.SetPos(sizeof(uint32_t)+sizeof(uint32_t));
+    coordWriter.Write(directoryOffset);
+
+    return !coordWriter.HasError();
+  }
+
+  bool Preprocess::Cleanup(Progress& progress)
+  {
+
+    nodeWriter.SetPos(0);
+    nodeWriter.Write(nodeCount);
+
+    wayWriter.SetPos(0);
+    wayWriter.Write(wayCount+areaCount);
+
+    relationWriter.SetPos(0);
+    relationWriter.Write(relationCount);
+
+    coastlineWriter.SetPos(0);
+    coastlineWriter.Write(coastlineCount);
+
+    if (coordCompressed) {
+      WriteCoordBlockDirectory();
+    }
+    else {
+      WriteCoordPageIndex();
+    }
+
     nodeWriter.Close();
     wayWriter.Close();
     relationWriter.Close();
@@ -463,7 +590,12 @@ namespace osmscout {
                   NumberToString(wayCount+areaCount));
     progress.Info(std::string("Relations:      ")+NumberToString(relationCount));
     progress.Info(std::string("Coastlines:     ")+NumberToString(coastlineCount));
-    progress.Info(std::string("Coord pages:    ")+NumberToString(coordIndex.size()));
+    if (coordCompressed) {
+      progress.Info(std::string("Coord blocks:   ")+NumberToString(blockIds.size()));
+    }
+    else {
+      progress.Info(std::string("Coord pages:    ")+NumberToString(coordIndex.size()));
+    }
 
     if (nodeSortingError) {
       progress.Error("Nodes are not sorted by increasing id");
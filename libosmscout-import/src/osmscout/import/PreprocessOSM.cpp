@@ -53,15 +53,49 @@ namespace osmscout {
     const TypeConfig&                typeConfig;
     OSMId                            id;
     double                           lon,lat;
-    std::map<TagId,std::string>      tags;
+    std::vector<TagId>               tagKeys;
+    std::vector<std::string>         tagValues;  //! Reused to avoid allocations
+    size_t                           tagCount;
+    TagBuffer                        tagBuffer;
     std::vector<OSMId>               nodes;
     std::vector<RawRelation::Member> members;
 
+  private:
+    void AddTag(TagId key,
+                const char* value)
+    {
+      // Later values for the same tag win, duplicates get removed in GetTags()
+      if (tagCount<tagValues.size()) {
+        tagKeys[tagCount]=key;
+        tagValues[tagCount]=value;
+      }
+      else {
+        tagKeys.push_back(key);
+        tagValues.push_back(value);
+      }
+
+      tagCount++;
+    }
+
+    TagView GetTags()
+    {
+      tagBuffer.Clear();
+
+      for (size_t i=0; i<tagCount; i++) {
+        tagBuffer.AddTag(tagKeys[i],
+                         tagValues[i]);
+      }
+
+      return tagBuffer.GetView(0,
+                               tagBuffer.SortTags(0));
+    }
+
   public:
     Parser(PreprocessOSM& pp,
            const TypeConfig& typeConfig)
     : pp(pp),
-      typeConfig(typeConfig)
+      typeConfig(typeConfig),
+      tagCount(0)
     {
       context=contextUnknown;
     }
@@ -74,7 +108,7 @@ namespace osmscout {
         const xmlChar *lonValue=NULL;
 
         context=contextNode;
-        tags.clear();
+        tagCount=0;
 
         for (size_t i=0; atts[i]!=NULL && atts[i+1]!=NULL; i+=2) {
           if (strcmp((const char*)atts[i],"id")==0) {
@@ -111,7 +145,7 @@ namespace osmscout {
         context=contextWay;
         nodes.clear();
         members.clear();
-        tags.clear();
+        tagCount=0;
 
         for (size_t i=0; atts[i]!=NULL && atts[i+1]!=NULL; i+=2) {
           if (strcmp((const char*)atts[i],"id")==0) {
@@ -128,7 +162,7 @@ namespace osmscout {
         const xmlChar *idValue=NULL;
 
         context=contextRelation;
-        tags.clear();
+        tagCount=0;
         nodes.clear();
         members.clear();
 
@@ -168,7 +202,8 @@ namespace osmscout {
         TagId id=typeConfig.GetTagId((const char*)keyValue);
 
         if (id!=tagIgnore) {
-          tags[id]=(const char*)valueValue;
+          AddTag(id,
+                 (const char*)valueValue);
         }
       }
       else if (strcmp((const char*)name,"nd")==0) {
@@ -262,26 +297,26 @@ namespace osmscout {
                        id,
                        lon,
                        lat,
-                       tags);
-        tags.clear();
+                       GetTags());
+        tagCount=0;
         context=contextUnknown;
       }
       else if (strcmp((const char*)name,"way")==0) {
         pp.ProcessWay(typeConfig,
                       id,
                       nodes,
-                      tags);
+                      GetTags());
         nodes.clear();
-        tags.clear();
+        tagCount=0;
         context=contextUnknown;
       }
       else if (strcmp((const char*)name,"relation")==0) {
         pp.ProcessRelation(typeConfig,
                            id,
                            members,
-                           tags);
+                           GetTags());
         members.clear();
-        tags.clear();
+        tagCount=0;
         context=contextUnknown;
       }
     }
@@ -328,7 +363,9 @@ namespace osmscout {
     }
 
     memset(&saxParser,0,sizeof(xmlSAXHandler));
-    saxParser.initialized=XML_SAX2_MAGIC;
+    // We only use the SAX1 element callbacks, libxml2 does not call them
+    // for a handler marked as SAX2
+    saxParser.initialized=1;
     saxParser.getEntity=GetEntity;
     saxParser.startElement=StartElement;
     saxParser.endElement=EndElement;
@@ -22,6 +22,15 @@
 #include <osmscout/import/PreprocessPBF.h>
 
 #include <cstdio>
+#include <limits>
+
+#include <osmscout/CoreFeatures.h>
+
+#if defined(OSMSCOUT_HAVE_THREAD)
+  #include <condition_variable>
+  #include <mutex>
+  #include <thread>
+#endif
 
 // We should try to get rid of this!
 #if defined(__WIN32__) || defined(WIN32)
@@ -45,16 +54,23 @@
 
 namespace osmscout {
 
-  bool ReadBlockHeader(Progress& progress,
-                       FILE* file,
-                       PBF::BlockHeader& blockHeader,
-                       bool silent)
+  /**
+    Read the next block header. Returns false on error or at the end of the
+    file. error is empty, if the end of the file was reached and silent
+    is true.
+    */
+  static bool ReadBlockHeader(FILE* file,
+                              PBF::BlockHeader& blockHeader,
+                              bool silent,
+                              std::string& error)
   {
     char blockHeaderLength[4];
 
+    error.clear();
+
     if (fread(blockHeaderLength,sizeof(char),4,file)!=4) {
       if (!silent) {
-        progress.Error("Cannot read block header length!");
+        error="Cannot read block header length!";
       }
       return false;
     }
@@ -63,20 +79,20 @@ namespace osmscout {
     uint32_t length=ntohl(*((uint32_t*)&blockHeaderLength));
 
     if (length==0 || length>MAX_BLOCK_HEADER_SIZE) {
-      progress.Error("Block header size invalid!");
+      error="Block header size invalid!";
       return false;
     }
 
     char *buffer=new char[length];
 
     if (fread(buffer,sizeof(char),length,file)!=length) {
-      progress.Error("Cannot read block header!");
+      error="Cannot read block header!";
       delete[] buffer;
       return false;
     }
 
     if (!blockHeader.ParseFromArray(buffer,length)) {
-      progress.Error("Cannot parse block header!");
+      error="Cannot parse block header!";
       delete[] buffer;
       return false;
     }
@@ -86,236 +102,376 @@ namespace osmscout {
     return true;
   }
 
-  bool ReadHeaderBlock(Progress& progress,
-                       FILE* file,
+  /**
+    Read the (still encoded) blob following the given block header.
+    */
+  static bool ReadBlob(FILE* file,
                        const PBF::BlockHeader& blockHeader,
-                       PBF::HeaderBlock& headerBlock)
+                       std::string& blobData,
+                       std::string& error)
   {
-    PBF::Blob blob;
-
     uint32_t length = blockHeader.datasize();
 
     if (length==0 || length>MAX_BLOB_SIZE) {
-      progress.Error("Blob size invalid!");
+      error="Blob size invalid!";
       return false;
     }
 
-    char *buffer=new char[length];
+    blobData.resize(length);
 
-    if (fread(buffer,sizeof(char),length,file)!=length) {
-      progress.Error("Cannot read blob!");
-      delete[] buffer;
+    if (fread(&blobData[0],sizeof(char),length,file)!=length) {
+      error="Cannot read blob!";
       return false;
     }
 
-    if (!blob.ParseFromArray(buffer,length)) {
-      progress.Error("Cannot parse blob!");
-      delete[] buffer;
+    return true;
+  }
+
+  /**
+    Parse the blob and return its uncompressed content.
+    */
+  static bool DecodeBlob(const std::string& blobData,
+                         std::string& data,
+                         std::string& error)
+  {
+    PBF::Blob blob;
+
+    if (!blob.ParseFromArray(blobData.data(),(int)blobData.length())) {
+      error="Cannot parse blob!";
       return false;
     }
 
-    delete [] buffer;
-
     if (blob.has_raw()) {
-      length=(uint32_t)blob.raw().length();
-      buffer = new char[length];
-      memcpy(buffer,blob.raw().data(),length);
+      data=blob.raw();
     }
     else if (blob.has_zlib_data()){
 #if defined(HAVE_LIB_ZLIB)
-      length=blob.raw_size();
-      buffer=new char[length];
+      data.resize(blob.raw_size());
 
       z_stream compressedStream;
 
       compressedStream.next_in=(Bytef*)const_cast<char*>(blob.zlib_data().data());
       compressedStream.avail_in=(uint32_t)blob.zlib_data().size();
-      compressedStream.next_out=(Bytef*)buffer;
-      compressedStream.avail_out=length;
+      compressedStream.next_out=(Bytef*)&data[0];
+      compressedStream.avail_out=(uint32_t)data.length();
       compressedStream.zalloc=Z_NULL;
       compressedStream.zfree=Z_NULL;
       compressedStream.opaque=Z_NULL;
 
       if (inflateInit( &compressedStream)!=Z_OK) {
-        progress.Error("Cannot decode zlib compressed blob data!");
-        delete[] buffer;
+        error="Cannot decode zlib compressed blob data!";
         return false;
       }
 
       if (inflate(&compressedStream,Z_FINISH)!=Z_STREAM_END) {
-        progress.Error("Cannot decode zlib compressed blob data!");
-        delete[] buffer;
+        inflateEnd(&compressedStream);
+        error="Cannot decode zlib compressed blob data!";
         return false;
       }
 
       if (inflateEnd(&compressedStream)!=Z_OK) {
-        progress.Error("Cannot decode zlib compressed blob data!");
-        delete[] buffer;
+        error="Cannot decode zlib compressed blob data!";
         return false;
       }
 #else
-      progress.Error("Data is zlib encoded but zlib support is not enabled!");
+      error="Data is zlib encoded but zlib support is not enabled!";
       return false;
 #endif
     }
     else if (blob.has_bzip2_data()){
-      progress.Error("Data is bzip2 encoded but bzip2 support is not enabled!");
+      error="Data is bzip2 encoded but bzip2 support is not enabled!";
       return false;
     }
     else if (blob.has_lzma_data()){
-      progress.Error("Data is lzma encoded but lzma support is not enabled!");
+      error="Data is lzma encoded but lzma support is not enabled!";
       return false;
     }
-
-    if (!headerBlock.ParseFromArray(buffer,length)) {
-      progress.Error("Cannot parse header block!");
-      delete[] buffer;
+    else {
+      error="Blob does not contain any data!";
       return false;
     }
 
-    delete[] buffer;
-
     return true;
   }
 
-  bool ReadPrimitiveBlock(Progress& progress,
-                          FILE* file,
-                          const PBF::BlockHeader& blockHeader,
-                          PBF::PrimitiveBlock& primitiveBlock)
+  static bool ReadHeaderBlock(FILE* file,
+                              const PBF::BlockHeader& blockHeader,
+                              PBF::HeaderBlock& headerBlock,
+                              std::string& error)
   {
-    PBF::Blob blob;
+    std::string blobData;
+    std::string data;
 
-    uint32_t length = blockHeader.datasize();
-
-    if (length==0 || length>MAX_BLOB_SIZE) {
-      progress.Error("Blob size invalid!");
+    if (!ReadBlob(file,
+                  blockHeader,
+                  blobData,
+                  error)) {
       return false;
     }
 
-    char *buffer=new char[length];
-
-    if (fread(buffer,sizeof(char),length,file)!=length) {
-      progress.Error("Cannot read blob!");
-      delete[] buffer;
+    if (!DecodeBlob(blobData,
+                    data,
+                    error)) {
       return false;
     }
 
-    if (!blob.ParseFromArray(buffer,length)) {
-      progress.Error("Cannot parse blob!");
-      delete[] buffer;
+    if (!headerBlock.ParseFromArray(data.data(),(int)data.length())) {
+      error="Cannot parse header block!";
       return false;
     }
 
-    delete [] buffer;
+    return true;
+  }
 
-    if (blob.has_raw()) {
-      length=(uint32_t)blob.raw().length();
-      buffer = new char[length];
-      memcpy(buffer,blob.raw().data(),length);
+#if defined(OSMSCOUT_HAVE_THREAD)
+  /**
+    State of the pipeline for parallel PBF decoding.
+
+    The reader thread reads blobs in file order into a ring of slots, the
+    decoder threads decode any read block and the calling thread processes
+    the decoded blocks strictly in file order. A slot is reused only after
+    its block has been processed, so the number of blocks in memory is
+    limited by the number of slots.
+    */
+  struct PreprocessPBF::Pipeline
+  {
+    enum State
+    {
+      slotFree,
+      slotRead,
+      slotDecoding,
+      slotDecoded
+    };
+
+    struct Slot
+    {
+      State       state;
+      bool        readError;
+      std::string blobData;
+      BlockData   data;
+      bool        success;
+      std::string error;
+    };
+
+    const TypeConfig&       typeConfig;
+    FILE*                   file;
+
+    std::mutex              mutex;     //! Guards all following members
+    std::condition_variable changed;
+    std::vector<Slot>       slots;
+    size_t                  readCount;    //! Number of blocks read
+    size_t                  decodeCount;  //! Number of blocks taken for decoding
+    size_t                  processCount; //! Number of blocks processed
+    bool                    readFinished; //! No more blocks will be read
+    bool                    aborted;      //! Processing was aborted because of an error
+    std::string             readError;
+
+    Pipeline(const TypeConfig& typeConfig,
+             FILE* file,
+             size_t slotCount)
+    : typeConfig(typeConfig),
+      file(file),
+      slots(slotCount),
+      readCount(0),
+      decodeCount(0),
+      processCount(0),
+      readFinished(false),
+      aborted(false)
+    {
+      for (size_t i=0; i<slots.size(); i++) {
+        slots[i].state=slotFree;
+        slots[i].readError=false;
+        slots[i].success=false;
+      }
     }
-    else if (blob.has_zlib_data()){
-#if defined(HAVE_LIB_ZLIB)
-      length=blob.raw_size();
-      buffer=new char[length];
 
-      z_stream compressedStream;
+    void Read()
+    {
+      while (true) {
+        Slot* slot;
 
-      compressedStream.next_in=(Bytef*)const_cast<char*>(blob.zlib_data().data());
-      compressedStream.avail_in=(uint32_t)blob.zlib_data().size();
-      compressedStream.next_out=(Bytef*)buffer;
-      compressedStream.avail_out=length;
-      compressedStream.zalloc=Z_NULL;
-      compressedStream.zfree=Z_NULL;
-      compressedStream.opaque=Z_NULL;
+        {
+          std::unique_lock<std::mutex> lock(mutex);
 
-      if (inflateInit( &compressedStream)!=Z_OK) {
-        progress.Error("Cannot decode zlib compressed blob data!");
-        delete[] buffer;
-        return false;
-      }
+          while (!aborted &&
+                 readCount-processCount>=slots.size()) {
+            changed.wait(lock);
+          }
 
-      if (inflate(&compressedStream,Z_FINISH)!=Z_STREAM_END) {
-        progress.Error("Cannot decode zlib compressed blob data!");
-        delete[] buffer;
-        return false;
-      }
+          if (aborted) {
+            return;
+          }
 
-      if (inflateEnd(&compressedStream)!=Z_OK) {
-        progress.Error("Cannot decode zlib compressed blob data!");
-        delete[] buffer;
-        return false;
+          // The slot is free and thus only used by this thread until we
+          // mark it as read
+          slot=&slots[readCount%slots.size()];
+        }
+
+        PBF::BlockHeader blockHeader;
+        std::string      error;
+        bool             success=true;
+
+        if (!ReadBlockHeader(file,
+                             blockHeader,
+                             true,
+                             error)) {
+          std::unique_lock<std::mutex> lock(mutex);
+
+          readError=error;
+          readFinished=true;
+          changed.notify_all();
+
+          return;
+        }
+
+        if (blockHeader.type()!="OSMData") {
+          error="File is not an OSM PBF file!";
+          success=false;
+        }
+        else if (!ReadBlob(file,
+                           blockHeader,
+                           slot->blobData,
+                           error)) {
+          success=false;
+        }
+
+        std::unique_lock<std::mutex> lock(mutex);
+
+        // A block that could not be read is passed on as failed block, so
+        // that the error is reported in order
+        slot->readError=!success;
+        slot->error=error;
+        slot->state=slotRead;
+        readCount++;
+
+        if (!success) {
+          readFinished=true;
+        }
+
+        changed.notify_all();
+
+        if (!success) {
+          return;
+        }
       }
-#else
-      progress.Error("Data is zlib encoded but zlib support is not enabled!");
-      return false;
-#endif
-    }
-    else if (blob.has_bzip2_data()){
-      progress.Error("Data is bzip2 encoded but bzip2 support is not enabled!");
-      return false;
-    }
-    else if (blob.has_lzma_data()){
-      progress.Error("Data is lzma encoded but lzma support is not enabled!");
-      return false;
     }
 
-    if (!primitiveBlock.ParseFromArray(buffer,length)) {
-      progress.Error("Cannot parse primitive block!");
-      delete[] buffer;
-      return false;
-    }
+    void Decode()
+    {
+      while (true) {
+        Slot* slot;
 
-    delete[] buffer;
+        {
+          std::unique_lock<std::mutex> lock(mutex);
 
-    return true;
-  }
+          while (!aborted &&
+                 decodeCount>=readCount &&
+                 !readFinished) {
+            changed.wait(lock);
+          }
+
+          if (aborted ||
+              decodeCount>=readCount) {
+            return;
+          }
+
+          slot=&slots[decodeCount%slots.size()];
+          slot->state=slotDecoding;
+          decodeCount++;
+        }
+
+        if (slot->readError) {
+          slot->success=false;
+        }
+        else {
+          slot->success=DecodeBlock(typeConfig,
+                                    slot->blobData,
+                                    slot->data,
+                                    slot->error);
+        }
+
+        std::unique_lock<std::mutex> lock(mutex);
+
+        slot->state=slotDecoded;
+        changed.notify_all();
+      }
+    }
+  };
+#endif
 
   std::string PreprocessPBF::GetDescription() const
   {
     return "PreprocessPBF";
   }
 
+  /**
+    Return the tag id for the given string table index of the block. Tag
+    ids are resolved only once per block and string.
+    */
+  TagId PreprocessPBF::GetTagId(const TypeConfig& typeConfig,
+                                BlockData& data,
+                                uint32_t key)
+  {
+    if (data.keyIds[key]==std::numeric_limits<uint32_t>::max()) {
+      data.keyIds[key]=typeConfig.GetTagId(data.block.stringtable().s(key).c_str());
+    }
+
+    return (TagId)data.keyIds[key];
+  }
+
   void PreprocessPBF::ReadNodes(const TypeConfig& typeConfig,
-                                const PBF::PrimitiveBlock& block,
-                                const PBF::PrimitiveGroup& group)
+                                const PBF::PrimitiveGroup& group,
+                                BlockData& data)
   {
+    const PBF::PrimitiveBlock &block=data.block;
+    size_t                    offset=data.nodes.size();
+
+    data.nodes.resize(offset+group.nodes_size());
+
     for (int n=0; n<group.nodes_size(); n++) {
       const PBF::Node &inputNode=group.nodes(n);
+      NodeData        &node=data.nodes[offset+n];
 
-      tagMap.clear();
+      node.tagsStart=data.tags.GetSize();
 
       for (int t=0; t<inputNode.keys_size(); t++) {
-        TagId id=typeConfig.GetTagId(block.stringtable().s(inputNode.keys(t)).c_str());
+        TagId id=GetTagId(typeConfig,data,inputNode.keys(t));
 
         if (id!=tagIgnore) {
-          tagMap[id]=block.stringtable().s(inputNode.vals(t));
+          data.tags.AddTag(id,block.stringtable().s(inputNode.vals(t)));
         }
       }
 
-      ProcessNode(typeConfig,
-                  inputNode.id(),
-                  (inputNode.lon()*block.granularity()+block.lon_offset())/NANO,
-                  (inputNode.lat()*block.granularity()+block.lat_offset())/NANO,
-                  tagMap);
+      node.tagsEnd=data.tags.SortTags(node.tagsStart);
+
+      node.id=inputNode.id();
+      node.lon=(inputNode.lon()*block.granularity()+block.lon_offset())/NANO;
+      node.lat=(inputNode.lat()*block.granularity()+block.lat_offset())/NANO;
     }
   }
 
   void PreprocessPBF::ReadDenseNodes(const TypeConfig& typeConfig,
-                                     const PBF::PrimitiveBlock& block,
-                                     const PBF::PrimitiveGroup& group)
+                                     const PBF::PrimitiveGroup& group,
+                                     BlockData& data)
   {
-    const PBF::DenseNodes &dense=group.dense();
+    const PBF::PrimitiveBlock &block=data.block;
+    const PBF::DenseNodes     &dense=group.dense();
     Id     dId=0;
     double dLat=0;
     double dLon=0;
     int    t=0;
+    size_t offset=data.nodes.size();
+
+    data.nodes.resize(offset+dense.id_size());
 
     for (int d=0; d<dense.id_size();d++) {
+      NodeData &node=data.nodes[offset+d];
+
       dId+=dense.id(d);
       dLat+=dense.lat(d);
       dLon+=dense.lon(d);
 
-      tagMap.clear();
+      node.tagsStart=data.tags.GetSize();
 
       while (true) {
         if (t>=dense.keys_vals_size()) {
@@ -327,73 +483,90 @@ namespace osmscout {
           break;
         }
 
-        TagId id=typeConfig.GetTagId(block.stringtable().s(dense.keys_vals(t)).c_str());
+        TagId id=GetTagId(typeConfig,data,dense.keys_vals(t));
 
         if (id!=tagIgnore) {
-          tagMap[id]=block.stringtable().s(dense.keys_vals(t+1));
+          data.tags.AddTag(id,block.stringtable().s(dense.keys_vals(t+1)));
         }
 
         t+=2;
       }
 
-      ProcessNode(typeConfig,
-                  dId,
-                  (dLon*block.granularity()+block.lon_offset())/NANO,
-                  (dLat*block.granularity()+block.lat_offset())/NANO,
-                  tagMap);
+      node.tagsEnd=data.tags.SortTags(node.tagsStart);
+
+      node.id=dId;
+      node.lon=(dLon*block.granularity()+block.lon_offset())/NANO;
+      node.lat=(dLat*block.granularity()+block.lat_offset())/NANO;
     }
   }
 
   void PreprocessPBF::ReadWays(const TypeConfig& typeConfig,
-                               const PBF::PrimitiveBlock& block,
-                               const PBF::PrimitiveGroup& group)
+                               const PBF::PrimitiveGroup& group,
+                               BlockData& data)
   {
+    const PBF::PrimitiveBlock &block=data.block;
+    size_t                    offset=data.ways.size();
+
+    data.ways.resize(offset+group.ways_size());
+
     for (int w=0; w<group.ways_size(); w++) {
       const PBF::Way &inputWay=group.ways(w);
+      WayData        &way=data.ways[offset+w];
 
-      nodes.clear();
-      tagMap.clear();
+      way.tagsStart=data.tags.GetSize();
 
       for (int t=0; t<inputWay.keys_size(); t++) {
-        TagId id=typeConfig.GetTagId(block.stringtable().s(inputWay.keys(t)).c_str());
+        TagId id=GetTagId(typeConfig,data,inputWay.keys(t));
 
         if (id!=tagIgnore) {
-          tagMap[id]=block.stringtable().s(inputWay.vals(t));
+          data.tags.AddTag(id,block.stringtable().s(inputWay.vals(t)));
         }
       }
 
+      way.tagsEnd=data.tags.SortTags(way.tagsStart);
+
+      way.nodesStart=data.wayNodes.size();
+
       unsigned long ref=0;
       for (int r=0; r<inputWay.refs_size(); r++) {
         ref+=inputWay.refs(r);
 
-        nodes.push_back(ref);
+        data.wayNodes.push_back(ref);
       }
 
-      ProcessWay(typeConfig,
-                 inputWay.id(),
-                 nodes,
-                 tagMap);
+      way.nodesEnd=data.wayNodes.size();
+
+      way.id=inputWay.id();
     }
   }
 
   void PreprocessPBF::ReadRelations(const TypeConfig& typeConfig,
-                                    const PBF::PrimitiveBlock& block,
-                                    const PBF::PrimitiveGroup& group)
+                                    const PBF::PrimitiveGroup& group,
+                                    BlockData& data)
   {
+    const PBF::PrimitiveBlock &block=data.block;
+    size_t                    offset=data.relations.size();
+
+    data.relations.resize(offset+group.relations_size());
+
     for (int r=0; r<group.relations_size(); r++) {
       const PBF::Relation &inputRelation=group.relations(r);
+      RelationData        &relation=data.relations[offset+r];
 
-      members.clear();
-      tagMap.clear();
+      relation.tagsStart=data.tags.GetSize();
 
       for (int t=0; t<inputRelation.keys_size(); t++) {
-        TagId id=typeConfig.GetTagId(block.stringtable().s(inputRelation.keys(t)).c_str());
+        TagId id=GetTagId(typeConfig,data,inputRelation.keys(t));
 
         if (id!=tagIgnore) {
-          tagMap[id]=block.stringtable().s(inputRelation.vals(t));
+          data.tags.AddTag(id,block.stringtable().s(inputRelation.vals(t)));
         }
       }
 
+      relation.tagsEnd=data.tags.SortTags(relation.tagsStart);
+
+      relation.membersStart=data.relationMembers.size();
+
       Id ref=0;
       for (int r=0; r<inputRelation.types_size();r++) {
         RawRelation::Member member;
@@ -415,14 +588,253 @@ namespace osmscout {
         member.id=ref;
         member.role=block.stringtable().s(inputRelation.roles_sid(r));
 
-        members.push_back(member);
+        data.relationMembers.push_back(member);
+      }
+
+      relation.membersEnd=data.relationMembers.size();
+
+      relation.id=inputRelation.id();
+    }
+  }
+
+  /**
+    Decode the given blob, parse the primitive block and convert its
+    content, resolving tags using the type config. This method does not
+    touch any state of the preprocessor and may be called from multiple
+    threads at the same time.
+    */
+  bool PreprocessPBF::DecodeBlock(const TypeConfig& typeConfig,
+                                  const std::string& blobData,
+                                  BlockData& data,
+                                  std::string& error)
+  {
+    std::string buffer;
+
+    data.tags.Clear();
+    data.nodes.clear();
+    data.ways.clear();
+    data.wayNodes.clear();
+    data.relations.clear();
+    data.relationMembers.clear();
+
+    if (!DecodeBlob(blobData,
+                    buffer,
+                    error)) {
+      return false;
+    }
+
+    if (!data.block.ParseFromArray(buffer.data(),(int)buffer.length())) {
+      error="Cannot parse primitive block!";
+      return false;
+    }
+
+    data.keyIds.assign(data.block.stringtable().s_size(),
+                       std::numeric_limits<uint32_t>::max());
+
+    for (int currentGroup=0;
+         currentGroup<data.block.primitivegroup_size();
+         currentGroup++) {
+      const PBF::PrimitiveGroup &group=data.block.primitivegroup(currentGroup);
+
+      if (group.nodes_size()>0) {
+        ReadNodes(typeConfig,
+                  group,
+                  data);
+      }
+      else if (group.ways_size()>0) {
+        ReadWays(typeConfig,
+                 group,
+                 data);
+      }
+      else if (group.relations_size()>0) {
+        ReadRelations(typeConfig,
+                      group,
+                      data);
+      }
+      else if (group.has_dense()) {
+        ReadDenseNodes(typeConfig,
+                       group,
+                       data);
       }
+    }
+
+    return true;
+  }
+
+  /**
+    Pass the decoded objects of a block to the preprocessor.
+    */
+  void PreprocessPBF::ProcessBlock(const TypeConfig& typeConfig,
+                                   BlockData& data)
+  {
+    for (std::vector<NodeData>::const_iterator node=data.nodes.begin();
+         node!=data.nodes.end();
+         ++node) {
+      ProcessNode(typeConfig,
+                  node->id,
+                  node->lon,
+                  node->lat,
+                  data.tags.GetView(node->tagsStart,node->tagsEnd));
+    }
+
+    for (std::vector<WayData>::const_iterator way=data.ways.begin();
+         way!=data.ways.end();
+         ++way) {
+      nodes.assign(data.wayNodes.begin()+way->nodesStart,
+                   data.wayNodes.begin()+way->nodesEnd);
+
+      ProcessWay(typeConfig,
+                 way->id,
+                 nodes,
+                 data.tags.GetView(way->tagsStart,way->tagsEnd));
+    }
+
+    for (std::vector<RelationData>::const_iterator relation=data.relations.begin();
+         relation!=data.relations.end();
+         ++relation) {
+      members.assign(data.relationMembers.begin()+relation->membersStart,
+                     data.relationMembers.begin()+relation->membersEnd);
 
       ProcessRelation(typeConfig,
-                      inputRelation.id(),
+                      relation->id,
                       members,
-                      tagMap);
+                      data.tags.GetView(relation->tagsStart,relation->tagsEnd));
+    }
+  }
+
+  /**
+    Read, decode and process all data blocks on the calling thread.
+    */
+  bool PreprocessPBF::ReadBlocks(Progress& progress,
+                                 const TypeConfig& typeConfig,
+                                 FILE* file)
+  {
+    std::string blobData;
+    BlockData   data;
+    std::string error;
+
+    while (true) {
+      PBF::BlockHeader blockHeader;
+
+      if (!ReadBlockHeader(file,
+                           blockHeader,
+                           true,
+                           error)) {
+        if (!error.empty()) {
+          progress.Error(error);
+        }
+        break;
+      }
+
+      if (blockHeader.type()!="OSMData") {
+        progress.Error("File is not an OSM PBF file!");
+        return false;
+      }
+
+      if (!ReadBlob(file,
+                    blockHeader,
+                    blobData,
+                    error)) {
+        progress.Error(error);
+        return false;
+      }
+
+      if (!DecodeBlock(typeConfig,
+                       blobData,
+                       data,
+                       error)) {
+        progress.Error(error);
+        return false;
+      }
+
+      ProcessBlock(typeConfig,
+                   data);
+    }
+
+    return true;
+  }
+
+  /**
+    Read the data blocks using a reader thread, decode them using a pool of
+    decoder threads and process them in file order on the calling thread.
+    */
+  bool PreprocessPBF::ReadBlocksParallel(const ImportParameter& parameter,
+                                         Progress& progress,
+                                         const TypeConfig& typeConfig,
+                                         FILE* file)
+  {
+#if defined(OSMSCOUT_HAVE_THREAD)
+    size_t                   threadCount=parameter.GetPreprocessThreadCount();
+    Pipeline                 pipeline(typeConfig,
+                                      file,
+                                      4*threadCount);
+    std::vector<std::thread> threads;
+    bool                     success=true;
+
+    threads.push_back(std::thread(&Pipeline::Read,
+                                  &pipeline));
+
+    for (size_t i=0; i<threadCount; i++) {
+      threads.push_back(std::thread(&Pipeline::Decode,
+                                    &pipeline));
+    }
+
+    while (true) {
+      Pipeline::Slot* slot;
+
+      {
+        std::unique_lock<std::mutex> lock(pipeline.mutex);
+
+        while (!(pipeline.processCount<pipeline.readCount &&
+                 pipeline.slots[pipeline.processCount%pipeline.slots.size()].state==Pipeline::slotDecoded) &&
+               !(pipeline.readFinished &&
+                 pipeline.processCount>=pipeline.readCount)) {
+          pipeline.changed.wait(lock);
+        }
+
+        if (pipeline.processCount>=pipeline.readCount) {
+          if (!pipeline.readError.empty()) {
+            progress.Error(pipeline.readError);
+          }
+
+          break;
+        }
+
+        slot=&pipeline.slots[pipeline.processCount%pipeline.slots.size()];
+      }
+
+      if (!slot->success) {
+        progress.Error(slot->error);
+        success=false;
+
+        std::unique_lock<std::mutex> lock(pipeline.mutex);
+
+        pipeline.aborted=true;
+        pipeline.changed.notify_all();
+
+        break;
+      }
+
+      ProcessBlock(typeConfig,
+                   slot->data);
+
+      std::unique_lock<std::mutex> lock(pipeline.mutex);
+
+      slot->state=Pipeline::slotFree;
+      pipeline.processCount++;
+      pipeline.changed.notify_all();
+    }
+
+    for (size_t i=0; i<threads.size(); i++) {
+      threads[i].join();
     }
+
+    return success;
+#else
+    return ReadBlocks(progress,
+                      typeConfig,
+                      file);
+#endif
   }
 
   bool PreprocessPBF::Import(const ImportParameter& parameter,
@@ -431,7 +843,8 @@ namespace osmscout {
   {
     progress.SetAction(std::string("Parsing PBF file '")+parameter.GetMapfile()+"'");
 
-    FILE* file;
+    FILE*       file;
+    std::string error;
 
     file=fopen(parameter.GetMapfile().c_str(),"rb");
 
@@ -441,6 +854,7 @@ namespace osmscout {
     }
 
     if (!Initialize(parameter)) {
+      fclose(file);
       return false;
     }
 
@@ -448,7 +862,11 @@ namespace osmscout {
 
     PBF::BlockHeader blockHeader;
 
-    if (!ReadBlockHeader(progress,file,blockHeader,false)) {
+    if (!ReadBlockHeader(file,
+                         blockHeader,
+                         false,
+                         error)) {
+      progress.Error(error);
       fclose(file);
       return false;
     }
@@ -461,10 +879,11 @@ namespace osmscout {
 
     PBF::HeaderBlock headerBlock;
 
-    if (!ReadHeaderBlock(progress,
-                         file,
+    if (!ReadHeaderBlock(file,
                          blockHeader,
-                         headerBlock)) {
+                         headerBlock,
+                         error)) {
+      progress.Error(error);
       fclose(file);
       return false;
     }
@@ -479,65 +898,26 @@ namespace osmscout {
       }
     }
 
-    nodes.reserve(20000);
-    members.reserve(2000);
-
-    while (true) {
-      PBF::BlockHeader blockHeader;
+    bool success;
 
-      if (!ReadBlockHeader(progress,
-                           file,
-                           blockHeader,
-                           true)) {
-        fclose(file);
-        break;
-      }
-
-      if (blockHeader.type()!="OSMData") {
-        progress.Error("File is not an OSM PBF file!");
-        fclose(file);
-        return false;
-      }
-
-      PBF::PrimitiveBlock block;
-
-      if (!ReadPrimitiveBlock(progress,
-                              file,
-                              blockHeader,
-                              block)) {
-        fclose(file);
-        return false;
-      }
+    if (parameter.GetPreprocessThreadCount()>1) {
+      success=ReadBlocksParallel(parameter,
+                                 progress,
+                                 typeConfig,
+                                 file);
+    }
+    else {
+      success=ReadBlocks(progress,
+                         typeConfig,
+                         file);
+    }
 
-      for (int currentGroup=0;
-           currentGroup<block.primitivegroup_size();
-           currentGroup++) {
-        const PBF::PrimitiveGroup &group=block.primitivegroup(currentGroup);
+    fclose(file);
 
-        if (group.nodes_size()>0) {
-          ReadNodes(typeConfig,
-                    block,
-                    group);
-        }
-        else if (group.ways_size()>0) {
-          ReadWays(typeConfig,
-                   block,
-                   group);
-        }
-        else if (group.relations_size()>0) {
-          ReadRelations(typeConfig,
-                        block,
-                        group);
-        }
-        else if (group.has_dense()) {
-          ReadDenseNodes(typeConfig,
-                         block,
-                         group);
-        }
-      }
+    if (!success) {
+      return false;
     }
 
     return Cleanup(progress);
   }
 }
-
@@ -33,6 +33,27 @@ namespace osmscout {
     this->type=type;
   }
 
+  unsigned long RawRelation::GetMemorySize() const
+  {
+    unsigned long memory=sizeof(RawRelation)+
+                         tags.capacity()*sizeof(Tag)+
+                         members.capacity()*sizeof(Member);
+
+    for (std::vector<Tag>::const_iterator tag=tags.begin();
+         tag!=tags.end();
+         ++tag) {
+      memory+=tag->value.capacity();
+    }
+
+    for (std::vector<Member>::const_iterator member=members.begin();
+         member!=members.end();
+         ++member) {
+      memory+=member->role.capacity();
+    }
+
+    return memory;
+  }
+
   bool RawRelation::Read(FileScanner& scanner)
   {
     uint32_t tagCount;
@@ -52,6 +52,21 @@ namespace osmscout {
     this->nodes=nodes;
   }
 
+  unsigned long RawWay::GetMemorySize() const
+  {
+    unsigned long memory=sizeof(RawWay)+
+                         tags.capacity()*sizeof(Tag)+
+                         nodes.capacity()*sizeof(OSMId);
+
+    for (std::vector<Tag>::const_iterator tag=tags.begin();
+         tag!=tags.end();
+         ++tag) {
+      memory+=tag->value.capacity();
+    }
+
+    return memory;
+  }
+
   bool RawWay::Read(FileScanner& scanner)
   {
     if (!scanner.ReadNumber(id)) {
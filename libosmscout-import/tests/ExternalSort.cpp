@@ -0,0 +1,179 @@
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+#include <osmscout/import/ExternalSort.h>
+
+/*
+  Sorts records with ExternalSorter and checks, that a corrupted run file
+  is reported as an error instead of silently ending the merge early.
+  */
+
+static const char* runFilename="ExternalSort.tmp";
+
+static const size_t recordCount=200000;
+static const size_t blockSize=50000;
+
+int errors=0;
+
+void Check(bool condition,
+           const char* message)
+{
+  if (!condition) {
+    std::cerr << "Check failed: " << message << std::endl;
+    errors++;
+  }
+}
+
+/**
+  Simple deterministic random numbers, so every run sorts the same records
+  */
+static unsigned long seed=1;
+
+uint32_t Random()
+{
+  seed=(seed*1103515245+12345)%2147483648UL;
+
+  return (uint32_t)(seed >> 8);
+}
+
+struct Record
+{
+  uint32_t key;
+  uint32_t index; //! Position in input order, to check stability
+};
+
+struct RecordLess
+{
+  inline bool operator()(const Record& a,
+                         const Record& b) const
+  {
+    return a.key<b.key;
+  }
+};
+
+typedef osmscout::ExternalSorter<Record,RecordLess> Sorter;
+
+bool AddRecords(Sorter& sorter,
+                bool compress)
+{
+  if (!sorter.Open(runFilename,
+                   compress)) {
+    std::cerr << "Cannot create '" << runFilename << "'" << std::endl;
+    return false;
+  }
+
+  for (size_t i=0; i<recordCount; i++) {
+    Record record;
+
+    record.key=Random()%10000;
+    record.index=(uint32_t)i;
+
+    if (!sorter.Add(record)) {
+      std::cerr << "Cannot add record " << i << std::endl;
+      return false;
+    }
+  }
+
+  return sorter.Sort();
+}
+
+/**
+  Overwrite the second half of the run file with garbage
+  */
+bool CorruptRunFile()
+{
+  std::fstream file(runFilename,std::ios::in|std::ios::out|std::ios::binary);
+
+  file.seekg(0,std::ios::end);
+
+  std::streamoff size=file.tellg();
+
+  if (size<=0) {
+    return false;
+  }
+
+  std::vector<char> garbage((size_t)(size-size/2),(char)0xff);
+
+  file.seekp(size/2);
+  file.write(&garbage[0],garbage.size());
+  file.close();
+
+  return !file.fail();
+}
+
+void CheckSort(bool compress)
+{
+  Sorter sorter(blockSize);
+
+  if (!AddRecords(sorter,compress)) {
+    Check(false,"Sorting records");
+    return;
+  }
+
+  Check(sorter.GetRunCount()>1,"Records are merged from multiple runs");
+
+  Record previous;
+  Record record;
+  size_t count=0;
+
+  previous.key=0;
+  previous.index=0;
+
+  while (sorter.Next(record)) {
+    if (count>0) {
+      Check(previous.key<record.key ||
+            (previous.key==record.key && previous.index<record.index),
+            "Records are sorted stable");
+    }
+
+    previous=record;
+    count++;
+  }
+
+  Check(!sorter.HasError(),"No error while merging runs");
+  Check(count==recordCount,"All records are returned");
+  Check(sorter.Close(),"Closing the sorter");
+}
+
+void CheckCorruptedRunFile(bool compress)
+{
+  Sorter sorter(blockSize);
+
+  if (!AddRecords(sorter,compress)) {
+    Check(false,"Sorting records");
+    return;
+  }
+
+  if (!CorruptRunFile()) {
+    Check(false,"Corrupting run file");
+    return;
+  }
+
+  Record record;
+  size_t count=0;
+
+  while (sorter.Next(record)) {
+    count++;
+  }
+
+  Check(sorter.HasError(),"Corrupted run file is reported as error");
+  Check(count<recordCount,"Merging stops at the corrupted block");
+  Check(!sorter.Close(),"Closing the sorter reports the error");
+}
+
+int main(int /*argc*/, char* /*argv*/[])
+{
+  CheckSort(false);
+  CheckSort(true);
+
+  CheckCorruptedRunFile(false);
+  CheckCorruptedRunFile(true);
+
+  if (errors!=0) {
+    std::cerr << errors << " check(s) failed" << std::endl;
+    return 1;
+  }
+
+  return 0;
+}
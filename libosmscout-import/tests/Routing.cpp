@@ -0,0 +1,542 @@
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <list>
+#include <map>
+#include <vector>
+
+#include <osmscout/Database.h>
+#include <osmscout/Router.h>
+#include <osmscout/RoutePostprocessor.h>
+#include <osmscout/RoutingProfile.h>
+
+#include <osmscout/import/Import.h>
+
+#include <osmscout/util/File.h>
+#include <osmscout/util/Geometry.h>
+#include <osmscout/util/Progress.h>
+
+/*
+  Imports a synthetic street grid and compares the costs of the routes
+  calculated by the different routing algorithms.
+  */
+
+static const char* directory="RoutingGrid";
+
+static const size_t gridSize=24;
+static const double gridStep=0.002;
+
+int errors=0;
+
+void Check(bool condition,
+           const char* message)
+{
+  if (!condition) {
+    std::cerr << "Check failed: " << message << std::endl;
+    errors++;
+  }
+}
+
+/**
+  Simple deterministic random numbers, so every run uses the same grid
+  */
+static unsigned long seed=1;
+
+double Random()
+{
+  seed=(seed*1103515245+12345)%2147483648UL;
+
+  return seed/2147483648.0;
+}
+
+bool WriteTypeFile(const std::string& filename)
+{
+  std::ofstream file(filename.c_str());
+
+  file << "OST" << std::endl;
+  file << std::endl;
+  file << "TYPES" << std::endl;
+  file << "  TYPE highway_primary = WAY (\"highway\"==\"primary\") OPTIONS ROUTE[FOOT BICYCLE CAR]" << std::endl;
+  file << "  TYPE highway_secondary = WAY (\"highway\"==\"secondary\") OPTIONS ROUTE[FOOT BICYCLE CAR]" << std::endl;
+  file << "  TYPE highway_residential = WAY (\"highway\"==\"residential\") OPTIONS ROUTE[FOOT BICYCLE CAR]" << std::endl;
+  file << "  TYPE landuse_residential = AREA (\"landuse\"==\"residential\")" << std::endl;
+  // Required by the location index
+  file << "  TYPE boundary_administrative = WAY AREA (\"boundary\"==\"administrative\") OPTIONS MULTIPOLYGON" << std::endl;
+  file << "END" << std::endl;
+
+  file.close();
+
+  return !file.fail();
+}
+
+size_t GetNodeId(size_t row,
+                 size_t column)
+{
+  return 1+row*gridSize+column;
+}
+
+/**
+  Id of the node halfway between the given column and the next column of a row
+  */
+size_t GetMiddleNodeId(size_t row,
+                       size_t column)
+{
+  return 1+gridSize*gridSize+row*(gridSize-1)+column;
+}
+
+void WriteWay(std::ofstream& file,
+              size_t id,
+              const std::list<size_t>& nodes,
+              const char* highway,
+              bool oneway)
+{
+  file << "<way id=\"" << id << "\" version=\"1\">" << std::endl;
+
+  for (std::list<size_t>::const_iterator node=nodes.begin();
+       node!=nodes.end();
+       ++node) {
+    file << "<nd ref=\"" << *node << "\"/>" << std::endl;
+  }
+
+  file << "<tag k=\"highway\" v=\"" << highway << "\"/>" << std::endl;
+
+  if (oneway) {
+    file << "<tag k=\"oneway\" v=\"yes\"/>" << std::endl;
+  }
+
+  file << "</way>" << std::endl;
+}
+
+/**
+  Streets of different speeds on a slightly distorted grid. Some rows are one
+  way streets, the columns consist of several ways. The rows have an additional
+  node between each two crossings, so that positions can lie between route nodes.
+  A residential area fills a part of the grid.
+  */
+bool WriteGrid(const std::string& filename)
+{
+  std::ofstream       file(filename.c_str());
+  size_t              wayId=1;
+  std::vector<double> lats(gridSize*gridSize);
+  std::vector<double> lons(gridSize*gridSize);
+
+  file << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>" << std::endl;
+  file << "<osm version=\"0.6\">" << std::endl;
+
+  file << std::fixed << std::setprecision(7);
+
+  for (size_t row=0; row<gridSize; row++) {
+    for (size_t column=0; column<gridSize; column++) {
+      double lat=50.0+row*gridStep+(Random()-0.5)*gridStep/4;
+      double lon=7.0+column*gridStep+(Random()-0.5)*gridStep/4;
+
+      lats[row*gridSize+column]=lat;
+      lons[row*gridSize+column]=lon;
+
+      file << "<node id=\"" << GetNodeId(row,column) << "\" lat=\"" << lat << "\" lon=\"" << lon << "\" version=\"1\"/>" << std::endl;
+    }
+  }
+
+  for (size_t row=0; row<gridSize; row++) {
+    for (size_t column=0; column+1<gridSize; column++) {
+      double lat=(lats[row*gridSize+column]+lats[row*gridSize+column+1])/2;
+      double lon=(lons[row*gridSize+column]+lons[row*gridSize+column+1])/2;
+
+      file << "<node id=\"" << GetMiddleNodeId(row,column) << "\" lat=\"" << lat << "\" lon=\"" << lon << "\" version=\"1\"/>" << std::endl;
+    }
+  }
+
+  for (size_t row=0; row<gridSize; row++) {
+    std::list<size_t> nodes;
+
+    for (size_t column=0; column<gridSize; column++) {
+      nodes.push_back(GetNodeId(row,column));
+
+      if (column+1<gridSize) {
+        nodes.push_back(GetMiddleNodeId(row,column));
+      }
+    }
+
+    WriteWay(file,
+             wayId++,
+             nodes,
+             row%8==0 ? "primary" : (row%4==0 ? "secondary" : "residential"),
+             row%7==3);
+  }
+
+  for (size_t column=0; column<gridSize; column++) {
+    for (size_t start=0; start+1<gridSize; start+=8) {
+      std::list<size_t> nodes;
+
+      for (size_t row=start; row<=start+8 && row<gridSize; row++) {
+        nodes.push_back(GetNodeId(row,column));
+      }
+
+      WriteWay(file,
+               wayId++,
+               nodes,
+               column%8==5 ? "primary" : (column%3==0 ? "secondary" : "residential"),
+               false);
+    }
+  }
+
+  std::list<size_t> nodes;
+
+  nodes.push_back(GetNodeId(2,2));
+  nodes.push_back(GetNodeId(2,6));
+  nodes.push_back(GetNodeId(6,6));
+  nodes.push_back(GetNodeId(6,2));
+  nodes.push_back(GetNodeId(2,2));
+
+  file << "<way id=\"" << wayId++ << "\" version=\"1\">" << std::endl;
+
+  for (std::list<size_t>::const_iterator node=nodes.begin();
+       node!=nodes.end();
+       ++node) {
+    file << "<nd ref=\"" << *node << "\"/>" << std::endl;
+  }
+
+  file << "<tag k=\"landuse\" v=\"residential\"/>" << std::endl;
+  file << "</way>" << std::endl;
+
+  file << "</osm>" << std::endl;
+
+  file.close();
+
+  return !file.fail();
+}
+
+bool ImportGrid(const std::map<std::string,double>& speeds,
+                double maxSpeed)
+{
+  osmscout::ImportParameter parameter;
+  osmscout::SilentProgress  progress;
+
+  if (!osmscout::MakeDirectory(directory)) {
+    std::cerr << "Cannot create directory '" << directory << "'" << std::endl;
+    return false;
+  }
+
+  if (!WriteTypeFile(osmscout::AppendFileToDir(directory,"grid.ost")) ||
+      !WriteGrid(osmscout::AppendFileToDir(directory,"grid.osm"))) {
+    std::cerr << "Cannot write grid" << std::endl;
+    return false;
+  }
+
+  parameter.SetMapfile(osmscout::AppendFileToDir(directory,"grid.osm"));
+  parameter.SetTypefile(osmscout::AppendFileToDir(directory,"grid.ost"));
+  parameter.SetDestinationDirectory(directory);
+  parameter.SetRouteCH(true);
+  parameter.SetRouteCHSpeedTable(speeds);
+  parameter.SetRouteCHMaxSpeed(maxSpeed);
+
+  return osmscout::Import(parameter,
+                          progress);
+}
+
+/**
+  Returns the travel time of the route, which is its cost for the fastest
+  path profile, or a negative value, if no route was found.
+  */
+double GetRouteTime(osmscout::Router& router,
+                    osmscout::Database& database,
+                    const osmscout::RoutingProfile& profile,
+                    osmscout::RouteData& data)
+{
+  osmscout::RouteDescription                                 description;
+  osmscout::RoutePostprocessor                               postprocessor;
+  std::list<osmscout::RoutePostprocessor::PostprocessorRef>  postprocessors;
+
+  if (data.IsEmpty()) {
+    return -1.0;
+  }
+
+  postprocessors.push_back(new osmscout::RoutePostprocessor::DistanceAndTimePostprocessor());
+
+  router.TransformRouteDataToRouteDescription(data,description);
+
+  if (!postprocessor.PostprocessRouteDescription(description,
+                                                 profile,
+                                                 database,
+                                                 postprocessors) ||
+      description.Nodes().empty()) {
+    return -1.0;
+  }
+
+  return description.Nodes().back().GetTime();
+}
+
+/**
+  Returns the costs of the route as calculated by the router (the sum of the
+  costs of all way segments), or a negative value, if no route was found.
+  */
+double GetRouteCosts(osmscout::Database& database,
+                     const osmscout::RoutingProfile& profile,
+                     const osmscout::RouteData& data)
+{
+  double costs=0.0;
+
+  if (data.Entries().empty()) {
+    return -1.0;
+  }
+
+  for (std::list<osmscout::RouteData::RouteEntry>::const_iterator entry=data.Entries().begin();
+       entry!=data.Entries().end();
+       ++entry) {
+    // The last entry does not have a path object
+    if (!entry->GetPathObject().Valid()) {
+      continue;
+    }
+
+    osmscout::WayRef way;
+
+    if (entry->GetPathObject().GetType()!=osmscout::refWay ||
+        !database.GetWayByOffset(entry->GetPathObject().GetFileOffset(),
+                                 way)) {
+      return -1.0;
+    }
+
+    const osmscout::GeoCoord& from=way->nodes[entry->GetCurrentNodeIndex()];
+    const osmscout::GeoCoord& to=way->nodes[entry->GetTargetNodeIndex()];
+
+    costs+=profile.GetCosts(*way,
+                            osmscout::GetSphericalDistance(from.GetLon(),
+                                                           from.GetLat(),
+                                                           to.GetLon(),
+                                                           to.GetLat()));
+  }
+
+  return costs;
+}
+
+int main(int /*argc*/, char* /*argv*/[])
+{
+  std::map<std::string,double> speeds;
+  double                       maxSpeed=160.0;
+
+  speeds["highway_primary"]=70.0;
+  speeds["highway_secondary"]=60.0;
+  speeds["highway_residential"]=40.0;
+
+  // The contraction hierarchy uses the same speeds as the routing profile, so
+  // all algorithms have to return routes with (nearly) the same costs
+  if (!ImportGrid(speeds,maxSpeed)) {
+    std::cerr << "Import of the grid failed" << std::endl;
+    return 1;
+  }
+
+  osmscout::DatabaseParameter databaseParameter;
+  osmscout::Database          database(databaseParameter);
+
+  if (!database.Open(directory)) {
+    std::cerr << "Cannot open database" << std::endl;
+    return 1;
+  }
+
+  osmscout::RouterParameter routerParameter;
+
+  // Small enough, that the matrix calculation has to evict route nodes
+  routerParameter.SetMatrixCacheSize(16*1024);
+  osmscout::Router          router(routerParameter,
+                                   osmscout::vehicleCar);
+
+  if (!router.Open(directory)) {
+    std::cerr << "Cannot open router" << std::endl;
+    return 1;
+  }
+
+  if (!router.HasContractionHierarchy()) {
+    std::cerr << "No contraction hierarchy imported" << std::endl;
+    return 1;
+  }
+
+  osmscout::FastestPathRoutingProfile profile;
+
+  profile.ParametrizeForCar(*router.GetTypeConfig(),
+                            speeds,
+                            maxSpeed);
+
+  // A profile with other speeds than used during import, the contraction
+  // hierarchy must not be used for it
+  std::map<std::string,double>        otherSpeeds;
+  osmscout::FastestPathRoutingProfile otherProfile;
+
+  otherSpeeds["highway_primary"]=30.0;
+  otherSpeeds["highway_secondary"]=60.0;
+  otherSpeeds["highway_residential"]=50.0;
+
+  otherProfile.ParametrizeForCar(*router.GetTypeConfig(),
+                                 otherSpeeds,
+                                 maxSpeed);
+
+  size_t                               routeCount=0;
+  std::vector<osmscout::RoutePosition> sources;
+  std::vector<osmscout::RoutePosition> targets;
+
+  for (size_t i=0; i<40; i++) {
+    osmscout::ObjectFileRef startObject;
+    size_t                  startNodeIndex;
+    osmscout::ObjectFileRef targetObject;
+    size_t                  targetNodeIndex;
+
+    if (!database.GetClosestRoutableNode(50.0+Random()*(gridSize-1)*gridStep,
+                                         7.0+Random()*(gridSize-1)*gridStep,
+                                         osmscout::vehicleCar,
+                                         1000,
+                                         startObject,
+                                         startNodeIndex) ||
+        !database.GetClosestRoutableNode(50.0+Random()*(gridSize-1)*gridStep,
+                                         7.0+Random()*(gridSize-1)*gridStep,
+                                         osmscout::vehicleCar,
+                                         1000,
+                                         targetObject,
+                                         targetNodeIndex) ||
+        startObject.Invalid() ||
+        targetObject.Invalid()) {
+      Check(false,"No routable node found");
+      continue;
+    }
+
+    if (sources.size()<8) {
+      sources.push_back(osmscout::RoutePosition(startObject,startNodeIndex));
+      targets.push_back(osmscout::RoutePosition(targetObject,targetNodeIndex));
+    }
+
+    osmscout::RouteData aStarData;
+    osmscout::RouteData bidirectionalData;
+    osmscout::RouteData chData;
+
+    if (!router.CalculateRoute(profile,
+                               startObject,
+                               startNodeIndex,
+                               targetObject,
+                               targetNodeIndex,
+                               aStarData) ||
+        !router.CalculateRouteBidirectional(profile,
+                                            startObject,
+                                            startNodeIndex,
+                                            targetObject,
+                                            targetNodeIndex,
+                                            bidirectionalData) ||
+        !router.CalculateRouteCH(profile,
+                                 startObject,
+                                 startNodeIndex,
+                                 targetObject,
+                                 targetNodeIndex,
+                                 chData)) {
+      Check(false,"Route calculation failed");
+      continue;
+    }
+
+    double aStarTime=GetRouteTime(router,database,profile,aStarData);
+    double bidirectionalTime=GetRouteTime(router,database,profile,bidirectionalData);
+    double chTime=GetRouteTime(router,database,profile,chData);
+
+    if (aStarTime<0.0) {
+      Check(bidirectionalTime<0.0,"Bidirectional search found a route, A* did not");
+      Check(chTime<0.0,"Contraction hierarchy found a route, A* did not");
+      continue;
+    }
+
+    routeCount++;
+
+    // A* stops at the first target route node taken from the open list and
+    // thus can be slightly more expensive, but never cheaper
+    if (bidirectionalTime<0.0 ||
+        bidirectionalTime>aStarTime+0.000001) {
+      std::cerr << "Route " << i << ": A* " << aStarTime << " bidirectional " << bidirectionalTime << std::endl;
+      Check(false,"Bidirectional route more expensive than A* route");
+    }
+
+    // The costs of the contraction hierarchy are rounded to integers, else
+    // both searches are exact
+    if (chTime<0.0 ||
+        fabs(chTime-bidirectionalTime)>0.0001) {
+      std::cerr << "Route " << i << ": bidirectional " << bidirectionalTime << " contraction hierarchy " << chTime << std::endl;
+      Check(false,"Contraction hierarchy route differs from bidirectional route");
+    }
+
+    osmscout::RouteData otherAStarData;
+    osmscout::RouteData otherCHData;
+
+    if (!router.CalculateRoute(otherProfile,
+                               startObject,
+                               startNodeIndex,
+                               targetObject,
+                               targetNodeIndex,
+                               otherAStarData) ||
+        !router.CalculateRouteCH(otherProfile,
+                                 startObject,
+                                 startNodeIndex,
+                                 targetObject,
+                                 targetNodeIndex,
+                                 otherCHData)) {
+      Check(false,"Route calculation for other profile failed");
+      continue;
+    }
+
+    double otherAStarTime=GetRouteTime(router,database,otherProfile,otherAStarData);
+    double otherCHTime=GetRouteTime(router,database,otherProfile,otherCHData);
+
+    if (fabs(otherCHTime-otherAStarTime)>0.000001) {
+      std::cerr << "Route " << i << ": A* " << otherAStarTime << " contraction hierarchy " << otherCHTime << " for other profile" << std::endl;
+      Check(false,"Contraction hierarchy used for other routing profile");
+    }
+  }
+
+  Check(routeCount>=30,"Too few routes found");
+
+  // Each cell of the matrix must have the costs of the bidirectional route,
+  // for the fastest path profile the costs are the time
+  osmscout::RouteMatrix matrix;
+
+  if (!router.CalculateMatrix(profile,
+                              sources,
+                              targets,
+                              matrix,
+                              2)) {
+    Check(false,"Matrix calculation failed");
+  }
+  else {
+    for (size_t s=0; s<sources.size(); s++) {
+      for (size_t t=0; t<targets.size(); t++) {
+        osmscout::RouteData data;
+
+        if (!router.CalculateRouteBidirectional(profile,
+                                                sources[s].GetObject(),
+                                                sources[s].GetNodeIndex(),
+                                                targets[t].GetObject(),
+                                                targets[t].GetNodeIndex(),
+                                                data)) {
+          Check(false,"Route calculation failed");
+          continue;
+        }
+
+        double costs=GetRouteCosts(database,profile,data);
+
+        if (costs<0.0) {
+          Check(!matrix.IsReachable(s,t),"Matrix found a route, bidirectional search did not");
+          continue;
+        }
+
+        if (!matrix.IsReachable(s,t) ||
+            fabs(matrix.GetCosts(s,t)-costs)>0.000001 ||
+            fabs(matrix.GetTime(s,t)-costs)>0.000001) {
+          std::cerr << "Matrix " << s << "x" << t << ": bidirectional " << costs << " matrix " << matrix.GetCosts(s,t) << " " << matrix.GetTime(s,t) << std::endl;
+          Check(false,"Matrix differs from bidirectional route");
+        }
+      }
+    }
+  }
+
+  router.Close();
+  database.Close();
+
+  if (errors!=0) {
+    return 1;
+  }
+  else {
+    return 0;
+  }
+}
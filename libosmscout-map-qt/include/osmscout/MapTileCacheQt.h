@@ -0,0 +1,70 @@
+#ifndef OSMSCOUT_MAP_MAPTILECACHEQT_H
+#define OSMSCOUT_MAP_MAPTILECACHEQT_H
+
+/*
+  This source is part of the libosmscout-map library
+  Copyright (C) 2013  Tim Teulings
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+#include <QImage>
+#include <QPainter>
+
+#include <osmscout/private/MapQtImportExport.h>
+
+#include <osmscout/MapPainterQt.h>
+#include <osmscout/MapTileCache.h>
+
+namespace osmscout {
+
+  /**
+    MapTileCache drawing tiles into QImages using MapPainterQt
+    */
+  class OSMSCOUT_MAP_QT_API MapTileCacheQt : public MapTileCache
+  {
+  public:
+    class OSMSCOUT_MAP_QT_API TileQt : public Tile
+    {
+    public:
+      QImage image;
+
+    public:
+      TileQt(size_t width,
+             size_t height);
+    };
+
+  private:
+    MapPainterQt painter;
+
+  protected:
+    Tile* DrawTile(const StyleConfig& styleConfig,
+                   const Projection& projection,
+                   const MapParameter& parameter,
+                   const MapData& data,
+                   size_t width,
+                   size_t height);
+
+  public:
+    MapTileCacheQt(const Database& database,
+                   size_t tileSize,
+                   size_t maxTiles);
+
+    bool DrawViewTiles(const View& view,
+                       QPainter* painter);
+  };
+}
+
+#endif
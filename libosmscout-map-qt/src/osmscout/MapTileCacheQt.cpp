@@ -0,0 +1,99 @@
+/*
+  This source is part of the libosmscout-map library
+  Copyright (C) 2013  Tim Teulings
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+#include <osmscout/MapTileCacheQt.h>
+
+namespace osmscout {
+
+  MapTileCacheQt::TileQt::TileQt(size_t width,
+                                 size_t height)
+  : image(QSize(width,height),QImage::Format_RGB32)
+  {
+    // no code
+  }
+
+  MapTileCacheQt::MapTileCacheQt(const Database& database,
+                                 size_t tileSize,
+                                 size_t maxTiles)
+  : MapTileCache(database,
+                 tileSize,
+                 maxTiles)
+  {
+    // no code
+  }
+
+  MapTileCache::Tile* MapTileCacheQt::DrawTile(const StyleConfig& styleConfig,
+                                               const Projection& projection,
+                                               const MapParameter& parameter,
+                                               const MapData& data,
+                                               size_t width,
+                                               size_t height)
+  {
+    TileQt   *tile=new TileQt(width,height);
+    QPainter p;
+
+    p.begin(&tile->image);
+    p.setRenderHint(QPainter::Antialiasing);
+    p.setRenderHint(QPainter::TextAntialiasing);
+    p.setRenderHint(QPainter::SmoothPixmapTransform);
+
+    bool success=painter.DrawMap(styleConfig,
+                                 projection,
+                                 parameter,
+                                 data,
+                                 &p);
+
+    p.end();
+
+    if (!success) {
+      delete tile;
+
+      return NULL;
+    }
+
+    return tile;
+  }
+
+  /**
+    Draw the cached tiles of the view, parts of the view without a rendered
+    tile are left untouched. Returns true, if all tiles of the view were
+    available.
+    */
+  bool MapTileCacheQt::DrawViewTiles(const View& view,
+                                     QPainter* painter)
+  {
+    std::vector<ViewTile> viewTiles;
+
+    bool complete=GetViewTiles(view,
+                               viewTiles);
+
+    for (std::vector<ViewTile>::const_iterator viewTile=viewTiles.begin();
+         viewTile!=viewTiles.end();
+         ++viewTile) {
+      if (viewTile->tile.Valid()) {
+        const TileQt* tile=static_cast<const TileQt*>(viewTile->tile.Get());
+
+        painter->drawImage(QPointF(viewTile->x,viewTile->y),
+                           tile->image);
+      }
+    }
+
+    return complete;
+  }
+}
@@ -22,6 +22,7 @@
 
 #include <list>
 #include <string>
+#include <vector>
 
 #include <osmscout/private/MapImportExport.h>
 
@@ -32,9 +33,11 @@
 #include <osmscout/Way.h>
 #include <osmscout/GroundTile.h>
 #include <osmscout/ObjectRef.h>
+#include <osmscout/Pixel.h>
 #include <osmscout/StyleConfig.h>
 
 #include <osmscout/util/Breaker.h>
+#include <osmscout/util/HashMap.h>
 #include <osmscout/util/HashSet.h>
 #include <osmscout/util/Projection.h>
 #include <osmscout/util/Transformation.h>
@@ -60,6 +63,8 @@ namespace osmscout {
     TransPolygon::OptimizeMethod optimizeWayNodes;   //! Try to reduce the number of nodes for
     TransPolygon::OptimizeMethod optimizeAreaNodes;  //! Try to reduce the number of nodes for
     double                       optimizeErrorToleranceMm;//! The maximum error to allow when optimizing lines, in mm
+    bool                         clipGeometry;       //! Clip areas and ways to the visible region before transformation (default: true)
+    double                       clipMarginPixel;    //! Margin around the visible region kept when clipping, in pixel (default: 50)
     bool                         drawFadings;        //! Draw label fadings (default: true)
     bool                         drawWaysWithFixedWidth; //! Draw ways using the size of the style sheet, if if the way has a width explicitely given
 
@@ -70,6 +75,8 @@ namespace osmscout {
 
     bool                         renderSeaLand;      //! Rendering of sea/land tiles
 
+    size_t                       prepareThreadCount; //! Number of threads for preparing areas and ways (default 1)
+
     bool                         debugPerformance;   //! Print out some performance information
 
     BreakerRef                   breaker;            //! Breaker to abort processing on external request
@@ -92,6 +99,9 @@ namespace osmscout {
     void SetOptimizeAreaNodes(TransPolygon::OptimizeMethod optimize);
     void SetOptimizeErrorToleranceMm(double errorToleranceMm);
 
+    void SetClipGeometry(bool clipGeometry);
+    void SetClipMarginPixel(double clipMarginPixel);
+
     void SetDrawFadings(bool drawFadings);
     void SetDrawWaysWithFixedWidth(bool drawWaysWithFixedWidth);
 
@@ -102,6 +112,8 @@ namespace osmscout {
 
     void SetRenderSeaLand(bool render);
 
+    void SetPrepareThreadCount(size_t threadCount);
+
     void SetDebugPerformance(bool debug);
 
     void SetBreaker(const BreakerRef& breaker);
@@ -156,6 +168,16 @@ namespace osmscout {
       return dpi*optimizeErrorToleranceMm/25.4;
     }
 
+    inline bool GetClipGeometry() const
+    {
+      return clipGeometry;
+    }
+
+    inline double GetClipMarginPixel() const
+    {
+      return clipMarginPixel;
+    }
+
     inline bool GetDrawFadings() const
     {
       return drawFadings;
@@ -191,6 +213,11 @@ namespace osmscout {
       return renderSeaLand;
     }
 
+    inline size_t GetPrepareThreadCount() const
+    {
+      return prepareThreadCount;
+    }
+
     inline bool IsDebugPerformance() const
     {
       return debugPerformance;
@@ -304,8 +331,99 @@ namespace osmscout {
       std::string       text;     //! The label text
     };
 
+    /**
+      The labels of one layer (normal labels or overlays) in drawing order.
+
+      To find possibly colliding labels without iterating over all labels,
+      the bounding boxes of the labels are registered in a uniform grid over
+      the drawing area (labels outside the drawing area are assigned to the
+      border cells) and labels are indexed by their text.
+
+      Labels can be marked during conflict resolution, marked labels are
+      tracked, so that clearing marks and removing marked labels only touches
+      the marked labels.
+      */
+    class OSMSCOUT_MAP_API LabelLayer
+    {
+    public:
+      typedef std::list<LabelData>::iterator Iterator;
+
+    private:
+      std::list<LabelData>                                 labels;
+      double                                               cellSize;
+      size_t                                               xCount;
+      size_t                                               yCount;
+      std::vector<std::vector<Iterator> >                  cells;
+      OSMSCOUT_HASHMAP<std::string,std::vector<Iterator> > textIndex;
+      std::vector<Iterator>                                marked;
+
+    private:
+      void GetCellRange(double bx1,
+                        double by1,
+                        double bx2,
+                        double by2,
+                        size_t& cx1,
+                        size_t& cy1,
+                        size_t& cx2,
+                        size_t& cy2) const;
+
+    public:
+      LabelLayer();
+
+      void Initialize(double width,
+                      double height,
+                      double cellSize);
+
+      void Add(const LabelData& label);
+
+      void GetLabelsInBoundingBox(double bx1,
+                                  double by1,
+                                  double bx2,
+                                  double by2,
+                                  std::vector<Iterator>& result) const;
+      void GetLabelsWithText(const std::string& text,
+                             std::vector<Iterator>& result) const;
+
+      void Mark(const Iterator& label);
+      void ClearMarks();
+      void RemoveMarked();
+
+      inline const std::list<LabelData>& GetLabels() const
+      {
+        return labels;
+      }
+    };
+
+  private:
+    /**
+      Result of preparing a range of areas or ways for drawing
+      */
+    struct PrepareData
+    {
+      TransBuffer             *transBuffer;    //! Buffer the coordinates get transformed into
+      std::list<AreaData>     areaData;
+      std::list<WayData>      wayData;
+      std::list<WayPathData>  wayPathData;
+      size_t                  areasSegments;
+      size_t                  waysSegments;
+    };
+
+    /**
+      Buffers of one thread during parallel preparation of areas and ways.
+      They are kept between calls to Draw() to avoid reallocation.
+      */
+    struct PrepareWorker
+    {
+      CoordBufferImpl<Vertex2D> *coordBuffer;  //! Owned by transBuffer
+      TransBuffer               transBuffer;
+      PrepareData               data;
+
+      PrepareWorker();
+    };
+
   private:
     CoordBuffer               *coordBuffer;
+    std::vector<PrepareWorker*> prepareWorkers;
   protected:
     /**
        Scratch variables for path optimization algorithm
@@ -331,12 +449,27 @@ namespace osmscout {
       Temporary data structures for intelligent label positioning
       */
     //@{
-    std::list<LabelData>      labels;
-    std::list<LabelData>      overlayLabels;
+    LabelLayer                labels;
+    LabelLayer                overlayLabels;
+    std::vector<LabelLayer::Iterator> labelCandidates; //! Scratch buffer for labels in collision
     std::vector<ScanCell>     wayScanlines;
     //@}
 
-    std::vector<LineStyleRef> lineStyles;     //! Temporary storage for StyleConfig return value
+    StyleCache                styleCache;     //! Styles resolved for the current frame
+
+    /**
+      Styles resolved before preparing areas and ways, so that the
+      preparation does not need to access the style cache
+      */
+    //@{
+    std::vector<FillStyleRef>                      areaFillStyles;      //! Fill styles of all area rings
+    std::vector<size_t>                            areaFillStyleStart;  //! Index of the first ring fill style for each area
+    std::vector<bool>                              areaClip;            //! Clip the rings of each area before transformation
+    std::vector<const Way*>                        preparedWays;        //! Ways and POI ways
+    std::vector<const std::vector<LineStyleRef>*>  preparedLineStyles;  //! Line styles for each way in preparedWays
+    std::vector<bool>                              preparedClip;        //! Clip each way in preparedWays before transformation
+    //@}
+
     /**
       Statistics counter
      */
@@ -394,34 +527,46 @@ namespace osmscout {
      Label placement routines
      */
     //@{
-    void ClearLabelMarks(std::list<LabelData>& labels);
-    void RemoveMarkedLabels(std::list<LabelData>& labels);
     bool MarkAllInBoundingBox(double bx1,
                               double bx2,
                               double by1,
                               double by2,
                               const LabelStyle& style,
-                              std::list<LabelData>& labels);
+                              LabelLayer& labels);
     bool MarkCloseLabelsWithSameText(double bx1,
                                      double bx2,
                                      double by1,
                                      double by2,
                                      const LabelStyle& style,
                                      const std::string& text,
-                                     std::list<LabelData>& labels);
+                                     LabelLayer& labels);
     //@}
 
     /**
       Private draw algorithm implementation routines.
      */
     //@{
-    /*
-    bool PrepareAreaSegment(const StyleConfig& styleConfig,
-                            const Projection& projection,
-                            const MapParameter& parameter,
-                            const ObjectFileRef& ref,
-                            const AreaAttributes& attributes,
-                            const std::vector<GeoCoord>& nodes);*/
+    size_t GetPrepareThreadCount(const MapParameter& parameter,
+                                 size_t objectCount);
+    void CopyPreparedCoords(PrepareWorker& worker);
+
+    void GetLineWidth(const Projection& projection,
+                      const MapParameter& parameter,
+                      const WayAttributes& attributes,
+                      const LineStyle& lineStyle,
+                      double& lineWidth,
+                      double& lineOffset) const;
+    bool IsClippable(const Projection& projection,
+                     const MapParameter& parameter,
+                     const WayAttributes& attributes,
+                     const std::vector<LineStyleRef>& lineStyles);
+
+    void PrepareAreaRange(const Projection& projection,
+                          const MapParameter& parameter,
+                          const MapData& data,
+                          size_t start,
+                          size_t end,
+                          PrepareData& prepareData);
 
     void PrepareAreas(const StyleConfig& styleConfig,
                       const Projection& projection,
@@ -434,7 +579,16 @@ namespace osmscout {
                            const ObjectFileRef& ref,
                            const WayAttributes& attributes,
                            const std::vector<GeoCoord>& nodes,
-                           const std::vector<Id>& ids);
+                           const std::vector<Id>& ids,
+                           const std::vector<LineStyleRef>& lineStyles,
+                           PrepareData& prepareData);
+
+    void PrepareWayRange(const StyleConfig& styleConfig,
+                         const Projection& projection,
+                         const MapParameter& parameter,
+                         size_t start,
+                         size_t end,
+                         PrepareData& prepareData);
 
     void PrepareWays(const StyleConfig& styleConfig,
                      const Projection& projection,
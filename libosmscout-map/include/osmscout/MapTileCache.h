@@ -0,0 +1,210 @@
+#ifndef OSMSCOUT_MAPTILECACHE_H
+#define OSMSCOUT_MAPTILECACHE_H
+
+/*
+  This source is part of the libosmscout-map library
+  Copyright (C) 2013  Tim Teulings
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+#include <list>
+#include <vector>
+
+#include <osmscout/private/MapImportExport.h>
+
+#include <osmscout/Database.h>
+#include <osmscout/MapPainter.h>
+#include <osmscout/StyleConfig.h>
+
+#include <osmscout/util/Cache.h>
+#include <osmscout/util/Mutex.h>
+#include <osmscout/util/Projection.h>
+#include <osmscout/util/Reference.h>
+
+namespace osmscout {
+
+  /**
+    Cache of rendered map tiles for interactive map display.
+
+    For each map scale (the magnification together with the width of the
+    view, see View) the world is divided into a fixed grid of square tiles.
+    Tiles are rendered on demand and kept in a LRU cache, so moving the map
+    only requires the tiles newly exposed to be rendered.
+
+    Rendering (RenderTiles(), Prefetch()) and retrieving the rendered
+    tiles (GetViewTiles()) may happen in different threads, rendering however
+    should only be done by one thread at a time. Rendering can be aborted
+    using the breaker of the MapParameter or the AreaSearchParameter, all
+    tiles completed up to then stay in the cache.
+
+    The cache is flushed if the style configuration (or its generation, see
+    StyleConfig::GetGeneration()) or the POI ways change.
+
+    Since tiles are drawn independently, labels crossing tile borders may be
+    cut off. Nodes and areas of a border around each tile are loaded to
+    reduce the effect.
+
+    Drawing the tile bitmap is left to a concrete, backend specific subclass
+    (see DrawTile()).
+    */
+  class OSMSCOUT_MAP_API MapTileCache
+  {
+  public:
+    /**
+      A rendered tile. Backends derive from this class to hold their bitmap.
+      */
+    class OSMSCOUT_MAP_API Tile : public Referencable
+    {
+    public:
+      virtual ~Tile();
+    };
+
+    typedef Ref<Tile> TileRef;
+
+    /**
+      The visible part of the map
+      */
+    struct OSMSCOUT_MAP_API View
+    {
+      double        lon;           //! Longitude of the center of the view
+      double        lat;           //! Latitude of the center of the view
+      Magnification magnification;
+      size_t        width;         //! Width of the view in pixel
+      size_t        height;        //! Height of the view in pixel
+    };
+
+    /**
+      A tile of the view and its position in the view
+      */
+    struct OSMSCOUT_MAP_API ViewTile
+    {
+      TileRef tile;                //! Invalid, if the tile is not rendered yet
+      double  x;                   //! Position of the left edge of the tile in the view
+      double  y;                   //! Position of the top edge of the tile in the view
+    };
+
+  private:
+    typedef Cache<uint64_t,TileRef,uint64_t> TileCache;
+
+    /**
+      The tiles of a grid covering a view, positions are in pixel relative to
+      the top left corner of the world
+      */
+    struct TileRange
+    {
+      double worldSize;            //! Width and height of the world in pixel
+      double x;                    //! Left edge of the view
+      double y;                    //! Top edge of the view
+      size_t xStart;
+      size_t yStart;
+      size_t xEnd;
+      size_t yEnd;
+    };
+
+    /**
+      The types to load for the magnification rendered
+      */
+    struct Types
+    {
+      TypeSet              nodeTypes;
+      std::vector<TypeSet> wayTypes;
+      TypeSet              areaTypes;
+    };
+
+  private:
+    const Database&     database;
+    size_t              tileSize;
+
+    mutable Mutex       mutex;           //! Guards all following members
+    TileCache           tiles;
+    std::vector<double> grids;           //! The world size of each grid, the index is part of the tile key
+    const StyleConfig*  styleConfig;     //! The style configuration the cached tiles were rendered with
+    size_t              styleGeneration; //! The generation of the style configuration
+    std::list<WayRef>   poiWays;
+    size_t              flushCount;      //! Number of flushes, to drop tiles rendered before a flush
+
+  private:
+    static uint64_t GetTileKey(size_t grid,
+                               size_t x,
+                               size_t y);
+
+    void FlushTiles();
+    bool FindGrid(double worldSize,
+                  size_t& grid) const;
+    size_t GetGrid(double worldSize);
+
+    bool GetTileRange(const View& view,
+                      size_t border,
+                      TileRange& range) const;
+
+    bool RenderTile(const StyleConfig& styleConfig,
+                    const Magnification& magnification,
+                    const Types& types,
+                    const TileRange& range,
+                    size_t grid,
+                    size_t x,
+                    size_t y,
+                    const MapParameter& parameter,
+                    const AreaSearchParameter& searchParameter,
+                    MapData& data);
+    bool RenderTileRange(const StyleConfig& styleConfig,
+                         const View& view,
+                         size_t border,
+                         const MapParameter& parameter,
+                         const AreaSearchParameter& searchParameter);
+
+  protected:
+    /**
+      Draw the given data into a new tile of the given size in pixel. The
+      projection covers exactly the tile. Return NULL on error.
+
+      Only called by the thread rendering tiles.
+      */
+    virtual Tile* DrawTile(const StyleConfig& styleConfig,
+                           const Projection& projection,
+                           const MapParameter& parameter,
+                           const MapData& data,
+                           size_t width,
+                           size_t height) = 0;
+
+  public:
+    MapTileCache(const Database& database,
+                 size_t tileSize,
+                 size_t maxTiles);
+    virtual ~MapTileCache();
+
+    size_t GetTileSize() const;
+
+    void SetMaxTiles(size_t maxTiles);
+    void SetPOIWays(const std::list<WayRef>& poiWays);
+
+    void Flush();
+
+    bool GetViewTiles(const View& view,
+                      std::vector<ViewTile>& viewTiles);
+
+    bool RenderTiles(const StyleConfig& styleConfig,
+                     const View& view,
+                     const MapParameter& parameter,
+                     const AreaSearchParameter& searchParameter);
+    bool Prefetch(const StyleConfig& styleConfig,
+                  const View& view,
+                  const MapParameter& parameter,
+                  const AreaSearchParameter& searchParameter);
+  };
+}
+
+#endif
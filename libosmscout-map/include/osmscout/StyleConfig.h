@@ -36,6 +36,7 @@
 #include <osmscout/TypeConfig.h>
 
 #include <osmscout/util/Color.h>
+#include <osmscout/util/Projection.h>
 #include <osmscout/util/Reference.h>
 #include <osmscout/util/Transformation.h>
 
@@ -1149,6 +1150,7 @@ namespace osmscout {
   {
   private:
     TypeConfig                                 *typeConfig;
+    size_t                                     generation; //! Changes with every Postprocess()
 
     // Symbol
     OSMSCOUT_HASHMAP<std::string,SymbolRef>    symbols;
@@ -1221,6 +1223,15 @@ namespace osmscout {
 
     TypeConfig* GetTypeConfig() const;
 
+    /**
+      Return an id, that is unique for every postprocessed state of any
+      StyleConfig instance. It allows to detect style reloads.
+      */
+    inline size_t GetGeneration() const
+    {
+      return generation;
+    }
+
     StyleConfig& SetWayPrio(TypeId type, size_t prio);
 
     void AddNodeTextStyle(const StyleFilter& filter,
@@ -1321,6 +1332,124 @@ namespace osmscout {
                                double dpi,
                                LineStyleRef& lineStyle) const;
   };
+
+  /**
+    Memoizing front end for the object style lookup methods of StyleConfig.
+
+    For a given magnification level, pixel size and DPI the resulting styles
+    of an object only depend on its type and - for ways - on its bridge,
+    tunnel and oneway attributes. StyleCache thus resolves (and if necessary
+    composes) the style for each such combination only once and afterwards
+    returns the shared style instance.
+
+    Prepare() must be called before every frame, it flushes the cache if the
+    style configuration, its generation, the magnification level, the
+    pixel size or the DPI changed.
+
+    StyleCache is not thread safe, each MapPainter holds its own instance.
+    */
+  class OSMSCOUT_MAP_API StyleCache
+  {
+  private:
+    template<class S>
+    struct Entry
+    {
+      bool   resolved;
+      Ref<S> style;
+
+      inline Entry()
+      : resolved(false)
+      {
+        // no code
+      }
+    };
+
+    struct LineStylesEntry
+    {
+      bool                      resolved;
+      std::vector<LineStyleRef> styles;
+
+      inline LineStylesEntry()
+      : resolved(false)
+      {
+        // no code
+      }
+    };
+
+    static const size_t wayVariantCount=8; //! Number of bridge/tunnel/oneway combinations
+
+  private:
+    const StyleConfig                    *styleConfig;
+    const Projection                     *projection;
+    double                               dpi;
+
+    size_t                               generation;
+    size_t                               level;
+    double                               pixelSize;
+
+    std::vector<Entry<TextStyle> >       nodeTextStyles;
+    std::vector<Entry<IconStyle> >       nodeIconStyles;
+
+    std::vector<LineStylesEntry>         wayLineStyles;
+    std::vector<Entry<PathTextStyle> >   wayPathTextStyles;
+    std::vector<Entry<PathSymbolStyle> > wayPathSymbolStyles;
+    std::vector<Entry<PathShieldStyle> > wayPathShieldStyles;
+
+    std::vector<Entry<FillStyle> >       areaFillStyles;
+    std::vector<Entry<TextStyle> >       areaTextStyles;
+    std::vector<Entry<IconStyle> >       areaIconStyles;
+
+  private:
+    static inline size_t GetWayIndex(const WayAttributes& way)
+    {
+      size_t index=way.GetType()*wayVariantCount;
+
+      if (way.IsBridge()) {
+        index+=1;
+      }
+
+      if (way.IsTunnel()) {
+        index+=2;
+      }
+
+      if (way.GetAccess().IsOneway()) {
+        index+=4;
+      }
+
+      return index;
+    }
+
+  public:
+    StyleCache();
+
+    void Prepare(const StyleConfig& styleConfig,
+                 const Projection& projection,
+                 double dpi);
+    void Clear();
+
+    void GetNodeTextStyle(const Node& node,
+                          TextStyleRef& textStyle);
+    void GetNodeIconStyle(const Node& node,
+                          IconStyleRef& iconStyle);
+
+    const std::vector<LineStyleRef>& GetWayLineStyles(const WayAttributes& way);
+    void GetWayPathTextStyle(const WayAttributes& way,
+                             PathTextStyleRef& pathTextStyle);
+    void GetWayPathSymbolStyle(const WayAttributes& way,
+                               PathSymbolStyleRef& pathSymbolStyle);
+    void GetWayPathShieldStyle(const WayAttributes& way,
+                               PathShieldStyleRef& pathShieldStyle);
+
+    void GetAreaFillStyle(const TypeId& type,
+                          const AreaAttributes& area,
+                          FillStyleRef& fillStyle);
+    void GetAreaTextStyle(const TypeId& type,
+                          const AreaAttributes& area,
+                          TextStyleRef& textStyle);
+    void GetAreaIconStyle(const TypeId& type,
+                          const AreaAttributes& area,
+                          IconStyleRef& iconStyle);
+  };
 }
 
 #endif
@@ -0,0 +1,193 @@
+#ifndef OSMSCOUT_TILERENDERER_H
+#define OSMSCOUT_TILERENDERER_H
+
+/*
+  This source is part of the libosmscout-map library
+  Copyright (C) 2013  Tim Teulings
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+#include <vector>
+
+#include <osmscout/private/MapImportExport.h>
+
+#include <osmscout/Database.h>
+#include <osmscout/MapPainter.h>
+#include <osmscout/StyleConfig.h>
+#include <osmscout/TiledObjects.h>
+
+#include <osmscout/util/Mutex.h>
+#include <osmscout/util/Projection.h>
+
+namespace osmscout {
+
+  /**
+    Batch renderer for slippy map tiles (see
+    http://wiki.openstreetmap.org/wiki/Slippy_map_tilenames) of a given
+    bounding box and a range of zoom levels.
+
+    Tiles are rendered in blocks of metaTileSize x metaTileSize tiles (meta
+    tiles). The data of a meta tile is loaded from the database once and drawn
+    into one bitmap, which is then cut into the individual tiles. Labels
+    crossing tile borders within a meta tile are thus drawn consistently.
+
+    Alternatively (see SetRenderMetaTiles()) the data of a meta tile is still
+    loaded once, but each tile is drawn on its own using only the objects
+    relevant for the tile (see TiledObjects).
+
+    Meta tiles are distributed over a number of worker threads (if the library
+    was build with thread support). Each thread uses its own Worker, created by
+    CreateWorker(), so painter and bitmap are reused for all meta tiles of
+    the thread. Drawing and writing the bitmap is left to the Worker, so
+    concrete renderers are implemented for a specific backend.
+    */
+  class OSMSCOUT_MAP_API TileRenderer
+  {
+  public:
+    /**
+      Draws meta tiles and writes the individual tiles. Each instance is only
+      used by one thread at a time.
+      */
+    class OSMSCOUT_MAP_API Worker
+    {
+    public:
+      virtual ~Worker();
+
+      /**
+        Draw the given data. The projection covers the complete meta tile (or
+        a single tile, if meta tiles are not drawn at once), its width and
+        height are given in pixel.
+        */
+      virtual bool DrawMetaTile(const StyleConfig& styleConfig,
+                                const Projection& projection,
+                                const MapParameter& parameter,
+                                const MapData& data,
+                                size_t width,
+                                size_t height) = 0;
+
+      /**
+        Write the tile x,y of the given zoom level, it is located at the given
+        pixel position in the last meta tile drawn.
+        */
+      virtual bool WriteTile(size_t zoom,
+                             size_t x,
+                             size_t y,
+                             size_t pixelX,
+                             size_t pixelY,
+                             size_t width,
+                             size_t height) = 0;
+    };
+
+  private:
+    /**
+      A block of tiles that is loaded and drawn at once
+      */
+    struct MetaTile
+    {
+      size_t zoom;
+      size_t xStart;
+      size_t yStart;
+      size_t xEnd;
+      size_t yEnd;
+    };
+
+    /**
+      The types to load for a zoom level, shared by all workers
+      */
+    struct ZoomTypes
+    {
+      TypeSet              nodeTypes;
+      std::vector<TypeSet> wayTypes;
+      TypeSet              areaTypes;
+    };
+
+    /**
+      State of a Render() call shared by all threads
+      */
+    struct Job
+    {
+      const MapParameter*        parameter;
+      const AreaSearchParameter* searchParameter;
+      size_t                     startZoom;
+      std::vector<ZoomTypes>     types;      //! Types by zoom level, starting with startZoom
+      std::vector<MetaTile>      metaTiles;
+
+      Mutex                      mutex;      //! Guards all following members
+      size_t                     nextMetaTile;
+      bool                       success;
+      size_t                     tileCount;
+    };
+
+  private:
+    const Database&    database;
+    const StyleConfig& styleConfig;
+    size_t             tileWidth;
+    size_t             tileHeight;
+    size_t             metaTileSize;
+    size_t             threadCount;
+    bool               renderMetaTiles;
+    size_t             tileCount;     //! Number of tiles written by the last Render() call
+
+  private:
+    bool RenderMetaTile(Job& job,
+                        const MetaTile& metaTile,
+                        Worker& worker,
+                        MapData& data);
+    bool RenderTiles(Job& job,
+                     const MetaTile& metaTile,
+                     Worker& worker,
+                     TiledObjects& objects,
+                     MapData& data);
+    void RenderMetaTiles(Job& job,
+                         Worker* worker);
+
+  protected:
+    /**
+      Create a new worker. Render() creates one worker for each thread
+      before starting the threads and deletes them at the end.
+      */
+    virtual Worker* CreateWorker() = 0;
+
+  public:
+    TileRenderer(const Database& database,
+                 const StyleConfig& styleConfig);
+    virtual ~TileRenderer();
+
+    void SetTileSize(size_t width,
+                     size_t height);
+    void SetMetaTileSize(size_t metaTileSize);
+    void SetThreadCount(size_t threadCount);
+    void SetRenderMetaTiles(bool renderMetaTiles);
+
+    size_t GetTileWidth() const;
+    size_t GetTileHeight() const;
+    size_t GetMetaTileSize() const;
+    size_t GetThreadCount() const;
+    bool GetRenderMetaTiles() const;
+
+    size_t GetTileCount() const;
+
+    bool Render(const MapParameter& parameter,
+                const AreaSearchParameter& searchParameter,
+                double lonMin, double latMin,
+                double lonMax, double latMax,
+                size_t startZoom,
+                size_t endZoom);
+
+  };
+}
+
+#endif
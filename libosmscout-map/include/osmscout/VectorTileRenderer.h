@@ -0,0 +1,257 @@
+#ifndef OSMSCOUT_VECTORTILERENDERER_H
+#define OSMSCOUT_VECTORTILERENDERER_H
+
+/*
+  This source is part of the libosmscout-map library
+  Copyright (C) 2013  Tim Teulings
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include <osmscout/private/MapImportExport.h>
+
+#include <osmscout/Pixel.h>
+#include <osmscout/TileRenderer.h>
+
+#include <osmscout/util/Mutex.h>
+#include <osmscout/util/Transformation.h>
+
+namespace osmscout {
+
+  /**
+    Encoder for vector tiles in the Mapbox vector tile format (version 2,
+    see https://github.com/mapbox/vector-tile-spec), a protocol buffer
+    message. The message is written directly, so no protocol buffer library
+    is required.
+
+    Coordinates are given in tile coordinates (0 to extent, with y pointing
+    downwards).
+    */
+  class OSMSCOUT_MAP_API VectorTileEncoder
+  {
+  public:
+    enum GeometryType
+    {
+      point      = 1,
+      lineString = 2,
+      polygon    = 3
+    };
+
+    struct OSMSCOUT_MAP_API TilePoint
+    {
+      int32_t x;
+      int32_t y;
+    };
+
+    typedef std::vector<TilePoint>             TilePath;
+    typedef std::pair<std::string,std::string> Property; //! Key and encoded value (see Encode*Value())
+
+  private:
+    struct Layer
+    {
+      std::string                    name;
+      std::vector<std::string>       keys;
+      std::map<std::string,uint32_t> keyIndex;
+      std::vector<std::string>       values;     //! Encoded values
+      std::map<std::string,uint32_t> valueIndex;
+      std::string                    features;   //! Encoded features
+      size_t                         featureCount;
+    };
+
+  private:
+    size_t                extent;
+    std::vector<Layer>    layers;
+    std::vector<uint32_t> tags;     //! Scratch buffer for the tags of a feature
+    std::vector<uint32_t> geometry; //! Scratch buffer for the geometry of a feature
+
+  private:
+    static uint32_t GetIndex(const std::string& entry,
+                             std::vector<std::string>& entries,
+                             std::map<std::string,uint32_t>& index);
+
+    void AddPath(const TilePath& path,
+                 bool closed,
+                 bool reverse,
+                 int32_t& cursorX,
+                 int32_t& cursorY);
+
+  public:
+    VectorTileEncoder(size_t extent);
+
+    size_t GetExtent() const;
+
+    void Clear();
+
+    size_t AddLayer(const std::string& name);
+    void AddFeature(size_t layer,
+                    GeometryType type,
+                    uint64_t id,
+                    const std::vector<Property>& properties,
+                    const std::vector<TilePath>& paths);
+
+    bool IsEmpty() const;
+
+    void Encode(std::string& tile) const;
+
+    static std::string EncodeStringValue(const std::string& value);
+    static std::string EncodeIntValue(int64_t value);
+    static std::string EncodeBoolValue(bool value);
+  };
+
+  /**
+    Batch producer for vector tiles (see VectorTileEncoder) of a given
+    bounding box and a range of zoom levels, either written to a directory
+    (<directory>/<zoom>/<x>/<y>.pbf, together with a MBTiles style
+    metadata.json file) or returned for a single tile (GetTile()).
+
+    Tiles are produced by the TileRenderer, so the data is loaded using the
+    node, way and area types of the style configuration for the zoom level
+    and the work is distributed over meta tiles and threads the same way.
+    The objects of a meta tile are transformed and simplified (see
+    TransPolygon and the optimization settings of the MapParameter) once,
+    and then clipped and quantized for each of its tiles.
+
+    Each tile has the layers "areas", "ways" and "nodes". Features have the
+    name of their type ("type") and, if available, their name ("name"),
+    ways also their ref ("ref"), layer ("layer") and the flags "bridge" and
+    "tunnel".
+    */
+  class OSMSCOUT_MAP_API VectorTileRenderer : public TileRenderer
+  {
+  private:
+    /**
+      A object of a meta tile in pixel coordinates of the meta tile
+      */
+    struct Feature
+    {
+      size_t                                   layer;
+      VectorTileEncoder::GeometryType          type;
+      uint64_t                                 id;
+      std::vector<VectorTileEncoder::Property> properties;
+      std::vector<Vertex2D>                    points;
+      std::vector<size_t>                      pathStarts; //! Start of each path in points, for polygons the outer ring is first
+      double                                   xMin;
+      double                                   yMin;
+      double                                   xMax;
+      double                                   yMax;
+    };
+
+    /**
+      Converts the data of a meta tile into vector tiles
+      */
+    class VectorTileWorker : public Worker
+    {
+    private:
+      VectorTileRenderer&                      renderer;
+      VectorTileEncoder                        encoder;
+      TransPolygon                             transPolygon;
+      std::vector<Feature>                     features;
+      std::vector<Vertex2D>                    clipped;      //! Scratch buffer for clipping
+      std::vector<Vertex2D>                    clipBuffer;   //! Scratch buffer for clipping
+      std::vector<size_t>                      partStarts;   //! Scratch buffer for clipping
+      std::vector<VectorTileEncoder::TilePath> paths;        //! Scratch buffer for the paths of a feature
+      std::string                              tile;
+
+    private:
+      bool AddPath(Feature& feature,
+                   size_t minPoints);
+      void SetProperties(const TypeConfig& typeConfig,
+                         TypeId type,
+                         const std::string& name,
+                         Feature& feature);
+      void AddClippedFeature(const Feature& feature,
+                             double pixelX,
+                             double pixelY,
+                             double scaleX,
+                             double scaleY,
+                             double xMin,
+                             double yMin,
+                             double xMax,
+                             double yMax);
+
+    public:
+      VectorTileWorker(VectorTileRenderer& renderer);
+
+      bool DrawMetaTile(const StyleConfig& styleConfig,
+                        const Projection& projection,
+                        const MapParameter& parameter,
+                        const MapData& data,
+                        size_t width,
+                        size_t height);
+
+      bool WriteTile(size_t zoom,
+                     size_t x,
+                     size_t y,
+                     size_t pixelX,
+                     size_t pixelY,
+                     size_t width,
+                     size_t height);
+    };
+
+  private:
+    size_t       extent;
+    size_t       buffer;
+    std::string  directory;  //! Target directory of Export()
+    std::string* targetTile; //! Target of GetTile()
+    Mutex        mutex;      //! Guards byteCount
+    size_t       byteCount;  //! Number of bytes written by the last Export() call
+
+  private:
+    bool StoreTile(size_t zoom,
+                   size_t x,
+                   size_t y,
+                   const std::string& tile);
+    bool WriteMetadata(double lonMin, double latMin,
+                       double lonMax, double latMax,
+                       size_t startZoom,
+                       size_t endZoom) const;
+
+  protected:
+    Worker* CreateWorker();
+
+  public:
+    VectorTileRenderer(const Database& database,
+                       const StyleConfig& styleConfig);
+
+    void SetExtent(size_t extent);
+    void SetBuffer(size_t buffer);
+
+    size_t GetExtent() const;
+    size_t GetBuffer() const;
+
+    size_t GetByteCount() const;
+
+    bool Export(const MapParameter& parameter,
+                const AreaSearchParameter& searchParameter,
+                double lonMin, double latMin,
+                double lonMax, double latMax,
+                size_t startZoom,
+                size_t endZoom,
+                const std::string& directory);
+
+    bool GetTile(const MapParameter& parameter,
+                 const AreaSearchParameter& searchParameter,
+                 size_t zoom,
+                 size_t x,
+                 size_t y,
+                 std::string& tile);
+  };
+}
+
+#endif
@@ -19,9 +19,14 @@
 
 #include <osmscout/MapPainter.h>
 
+#include <functional>
 #include <iostream>
 #include <limits>
 
+#if defined(OSMSCOUT_HAVE_THREAD)
+#include <thread>
+#endif
+
 #include <osmscout/system/Math.h>
 
 #include <osmscout/util/HashSet.h>
@@ -70,6 +75,8 @@ namespace osmscout {
     optimizeWayNodes(TransPolygon::none),
     optimizeAreaNodes(TransPolygon::none),
     optimizeErrorToleranceMm(25.4/dpi), //1 pixel
+    clipGeometry(true),
+    clipMarginPixel(50.0),
     drawFadings(true),
     drawWaysWithFixedWidth(false),
     labelSpace(3.0),
@@ -77,6 +84,7 @@ namespace osmscout {
     sameLabelSpace(40.0),
     dropNotVisiblePointLabels(true),
     renderSeaLand(false),
+    prepareThreadCount(1),
     debugPerformance(false)
   {
     // no code
@@ -132,6 +140,16 @@ namespace osmscout {
     optimizeErrorToleranceMm=errorToleranceMm;
   }
 
+  void MapParameter::SetClipGeometry(bool clipGeometry)
+  {
+    this->clipGeometry=clipGeometry;
+  }
+
+  void MapParameter::SetClipMarginPixel(double clipMarginPixel)
+  {
+    this->clipMarginPixel=clipMarginPixel;
+  }
+
   void MapParameter::SetDrawFadings(bool drawFadings)
   {
     this->drawFadings=drawFadings;
@@ -168,6 +186,11 @@ namespace osmscout {
     this->renderSeaLand=render;
   }
 
+  void MapParameter::SetPrepareThreadCount(size_t threadCount)
+  {
+    prepareThreadCount=std::max((size_t)1,threadCount);
+  }
+
   void MapParameter::SetDebugPerformance(bool debug)
   {
     debugPerformance=debug;
@@ -178,6 +201,197 @@ namespace osmscout {
     this->breaker=breaker;
   }
 
+  /**
+    Size of a cell of the label grid in pixel
+    */
+  static const double labelCellSize=64.0;
+
+  /**
+    Remove the given label from the list of labels
+    */
+  static inline void RemoveLabel(std::vector<MapPainter::LabelLayer::Iterator>& labels,
+                                 const MapPainter::LabelLayer::Iterator& label)
+  {
+    for (size_t i=0; i<labels.size(); i++) {
+      if (labels[i]==label) {
+        labels[i]=labels.back();
+        labels.pop_back();
+        return;
+      }
+    }
+  }
+
+  MapPainter::LabelLayer::LabelLayer()
+  : cellSize(labelCellSize),
+    xCount(1),
+    yCount(1),
+    cells(1)
+  {
+    // no code
+  }
+
+  /**
+    Remove all labels and set up the grid for a drawing area of the given
+    size.
+    */
+  void MapPainter::LabelLayer::Initialize(double width,
+                                          double height,
+                                          double cellSize)
+  {
+    this->cellSize=cellSize;
+
+    xCount=std::max((size_t)1,(size_t)ceil(width/cellSize));
+    yCount=std::max((size_t)1,(size_t)ceil(height/cellSize));
+
+    // Keep the allocated cells from the last run
+    if (cells.size()!=xCount*yCount) {
+      cells.resize(xCount*yCount);
+    }
+
+    for (size_t i=0; i<cells.size(); i++) {
+      cells[i].clear();
+    }
+
+    labels.clear();
+    textIndex.clear();
+    marked.clear();
+  }
+
+  void MapPainter::LabelLayer::GetCellRange(double bx1,
+                                            double by1,
+                                            double bx2,
+                                            double by2,
+                                            size_t& cx1,
+                                            size_t& cy1,
+                                            size_t& cx2,
+                                            size_t& cy2) const
+  {
+    cx1=bx1<=0.0 ? 0 : std::min((size_t)(bx1/cellSize),xCount-1);
+    cx2=bx2<=0.0 ? 0 : std::min((size_t)(bx2/cellSize),xCount-1);
+    cy1=by1<=0.0 ? 0 : std::min((size_t)(by1/cellSize),yCount-1);
+    cy2=by2<=0.0 ? 0 : std::min((size_t)(by2/cellSize),yCount-1);
+  }
+
+  void MapPainter::LabelLayer::Add(const LabelData& label)
+  {
+    Iterator entry=labels.insert(labels.end(),label);
+    size_t   cx1,cy1,cx2,cy2;
+
+    // Only marks set using Mark() are cleared later on
+    entry->mark=false;
+
+    GetCellRange(label.bx1,label.by1,label.bx2,label.by2,
+                 cx1,cy1,cx2,cy2);
+
+    for (size_t y=cy1; y<=cy2; y++) {
+      for (size_t x=cx1; x<=cx2; x++) {
+        cells[y*xCount+x].push_back(entry);
+      }
+    }
+
+    textIndex[label.text].push_back(entry);
+  }
+
+  /**
+    Return all labels, that are registered in cells touched by the given
+    bounding box. A label may be returned more than once.
+    */
+  void MapPainter::LabelLayer::GetLabelsInBoundingBox(double bx1,
+                                                      double by1,
+                                                      double bx2,
+                                                      double by2,
+                                                      std::vector<Iterator>& result) const
+  {
+    size_t cx1,cy1,cx2,cy2;
+
+    GetCellRange(bx1,by1,bx2,by2,
+                 cx1,cy1,cx2,cy2);
+
+    result.clear();
+
+    for (size_t y=cy1; y<=cy2; y++) {
+      for (size_t x=cx1; x<=cx2; x++) {
+        const std::vector<Iterator>& cell=cells[y*xCount+x];
+
+        result.insert(result.end(),cell.begin(),cell.end());
+      }
+    }
+  }
+
+  void MapPainter::LabelLayer::GetLabelsWithText(const std::string& text,
+                                                 std::vector<Iterator>& result) const
+  {
+    OSMSCOUT_HASHMAP<std::string,std::vector<Iterator> >::const_iterator entry=textIndex.find(text);
+
+    if (entry!=textIndex.end()) {
+      result=entry->second;
+    }
+    else {
+      result.clear();
+    }
+  }
+
+  void MapPainter::LabelLayer::Mark(const Iterator& label)
+  {
+    if (!label->mark) {
+      label->mark=true;
+      marked.push_back(label);
+    }
+  }
+
+  void MapPainter::LabelLayer::ClearMarks()
+  {
+    for (size_t i=0; i<marked.size(); i++) {
+      marked[i]->mark=false;
+    }
+
+    marked.clear();
+  }
+
+  void MapPainter::LabelLayer::RemoveMarked()
+  {
+    for (size_t i=0; i<marked.size(); i++) {
+      Iterator label=marked[i];
+      size_t   cx1,cy1,cx2,cy2;
+
+      GetCellRange(label->bx1,label->by1,label->bx2,label->by2,
+                   cx1,cy1,cx2,cy2);
+
+      for (size_t y=cy1; y<=cy2; y++) {
+        for (size_t x=cx1; x<=cx2; x++) {
+          RemoveLabel(cells[y*xCount+x],label);
+        }
+      }
+
+      OSMSCOUT_HASHMAP<std::string,std::vector<Iterator> >::iterator entry=textIndex.find(label->text);
+
+      if (entry!=textIndex.end()) {
+        RemoveLabel(entry->second,label);
+
+        if (entry->second.empty()) {
+          textIndex.erase(entry);
+        }
+      }
+
+      labels.erase(label);
+    }
+
+    marked.clear();
+  }
+
+  /**
+    Minimum number of objects a thread has to prepare, to make parallel
+    preparation worth the thread overhead
+    */
+  static const size_t minPrepareObjectsPerThread=256;
+
+  MapPainter::PrepareWorker::PrepareWorker()
+  : coordBuffer(new CoordBufferImpl<Vertex2D>()),
+    transBuffer(coordBuffer)
+  {
+    // no code
+  }
+
   MapPainter::MapPainter(CoordBuffer *buffer)
   : coordBuffer(buffer),
     transBuffer(coordBuffer)
@@ -203,7 +417,9 @@ namespace osmscout {
 
   MapPainter::~MapPainter()
   {
-    // no code
+    for (size_t i=0; i<prepareWorkers.size(); i++) {
+      delete prepareWorkers[i];
+    }
   }
 
   bool MapPainter::IsVisible(const Projection& projection,
@@ -287,40 +503,25 @@ namespace osmscout {
     }
   }
 
-  void MapPainter::ClearLabelMarks(std::list<LabelData>& labels)
-  {
-    for (std::list<LabelData>::iterator label=labels.begin();
-         label!=labels.end();
-         ++label) {
-      label->mark=false;
-    }
-  }
-
-  void MapPainter::RemoveMarkedLabels(std::list<LabelData>& labels)
-  {
-    std::list<LabelData>::iterator label=labels.begin();
-
-    while (label!=labels.end()) {
-      if (label->mark) {
-        label=labels.erase(label);
-      }
-      else {
-        ++label;
-      }
-    }
-  }
-
   bool MapPainter::MarkAllInBoundingBox(double bx1,
                                         double bx2,
                                         double by1,
                                         double by2,
                                         const LabelStyle& style,
-                                        std::list<LabelData>& labels)
+                                        LabelLayer& labels)
   {
-    for (std::list<LabelData>::iterator l=labels.begin();
-        l!=labels.end();
+    double maxLabelSpace=std::max(labelSpace,shieldLabelSpace);
+
+    labels.GetLabelsInBoundingBox(bx1-maxLabelSpace,
+                                  by1-maxLabelSpace,
+                                  bx2+maxLabelSpace,
+                                  by2+maxLabelSpace,
+                                  labelCandidates);
+
+    for (std::vector<LabelLayer::Iterator>::const_iterator l=labelCandidates.begin();
+        l!=labelCandidates.end();
         ++l) {
-      LabelData& label=*l;
+      LabelData& label=**l;
 
       // We only look at labels, that are not already marked.
       if (label.mark) {
@@ -355,7 +556,7 @@ namespace osmscout {
           return false;
         }
 
-        label.mark=true;
+        labels.Mark(*l);
       }
     }
 
@@ -368,19 +569,25 @@ namespace osmscout {
                                                double by2,
                                                const LabelStyle& style,
                                                const std::string& text,
-                                               std::list<LabelData>& labels)
+                                               LabelLayer& labels)
   {
-    for (std::list<LabelData>::iterator l=labels.begin();
-        l!=labels.end();
+    if (dynamic_cast<const ShieldStyle*>(&style)==NULL) {
+      return true;
+    }
+
+    labels.GetLabelsWithText(text,
+                             labelCandidates);
+
+    for (std::vector<LabelLayer::Iterator>::const_iterator l=labelCandidates.begin();
+        l!=labelCandidates.end();
         ++l) {
-      LabelData& label=*l;
+      const LabelData& label=**l;
 
       if (label.mark) {
         continue;
       }
 
-      if (dynamic_cast<const ShieldStyle*>(&style)!=NULL &&
-          dynamic_cast<const ShieldStyle*>(label.style.Get())!=NULL) {
+      if (dynamic_cast<const ShieldStyle*>(label.style.Get())!=NULL) {
         double hx1=bx1-sameLabelSpace;
         double hx2=bx2+sameLabelSpace;
         double hy1=by1-sameLabelSpace;
@@ -744,12 +951,16 @@ namespace osmscout {
 
       labelData.x=px;
       labelData.y=py;
+      labelData.bx1=px;
+      labelData.by1=py;
+      labelData.bx2=px;
+      labelData.by2=py;
       labelData.alpha=0.5;
       labelData.fontSize=1.2;
       labelData.style=debugLabel;
       labelData.text=label;
 
-      labels.push_back(labelData);
+      labels.Add(labelData);
 
       drawnLabels.insert(Coord(x,y));
 #endif
@@ -805,10 +1016,10 @@ namespace osmscout {
     // Reset all marks on labels, because we needs marks
     // for our internal collision handling
     if (overlay) {
-      ClearLabelMarks(overlayLabels);
+      overlayLabels.ClearMarks();
     }
     else {
-      ClearLabelMarks(labels);
+      labels.ClearMarks();
     }
 
     // First rough minimum bounding box, estimated without calculating text dimensions (since this is expensive).
@@ -892,7 +1103,7 @@ namespace osmscout {
 
       // Remove every marked (aka "in conflict" or "intersecting but of lower
       // priority") label.
-      RemoveMarkedLabels(overlayLabels);
+      overlayLabels.RemoveMarked();
     }
     else {
       if (!MarkAllInBoundingBox(bx1,bx2,by1,by2,
@@ -917,7 +1128,7 @@ namespace osmscout {
 
       // Remove every marked (aka "in conflict" or "intersecting but of lower
       // priority") label.
-      RemoveMarkedLabels(labels);
+      labels.RemoveMarked();
     }
 
 
@@ -937,10 +1148,10 @@ namespace osmscout {
     label.text=text;
 
     if (overlay) {
-      overlayLabels.push_back(label);
+      overlayLabels.Add(label);
     }
     else {
-      labels.push_back(label);
+      labels.Add(label);
     }
 
     return true;
@@ -991,16 +1202,12 @@ namespace osmscout {
     TextStyleRef  textStyle;
     IconStyleRef  iconStyle;
 
-    styleConfig.GetAreaTextStyle(type,
-                                 attributes,
-                                 projection,
-                                 parameter.GetDPI(),
-                                 textStyle);
-    styleConfig.GetAreaIconStyle(type,
-                                 attributes,
-                                 projection,
-                                 parameter.GetDPI(),
-                                 iconStyle);
+    styleCache.GetAreaTextStyle(type,
+                                attributes,
+                                textStyle);
+    styleCache.GetAreaIconStyle(type,
+                                attributes,
+                                iconStyle);
 
     bool          hasLabel=textStyle.Valid();
     bool          hasSymbol=iconStyle.Valid() && iconStyle->GetSymbol().Valid();
@@ -1128,14 +1335,10 @@ namespace osmscout {
     TextStyleRef textStyle;
     IconStyleRef iconStyle;
 
-    styleConfig.GetNodeTextStyle(node,
-                                 projection,
-                                 parameter.GetDPI(),
-                                 textStyle);
-    styleConfig.GetNodeIconStyle(node,
-                                 projection,
-                                 parameter.GetDPI(),
-                                 iconStyle);
+    styleCache.GetNodeTextStyle(node,
+                                textStyle);
+    styleCache.GetNodeIconStyle(node,
+                                iconStyle);
 
     bool         hasLabel=textStyle.Valid();
     bool         hasSymbol=iconStyle.Valid() && iconStyle->GetSymbol().Valid();
@@ -1256,7 +1459,7 @@ namespace osmscout {
     }
   }
 
-  void MapPainter::DrawWayDecorations(const StyleConfig& styleConfig,
+  void MapPainter::DrawWayDecorations(const StyleConfig& /*styleConfig*/,
                                       const Projection& projection,
                                       const MapParameter& parameter,
                                       const MapData& /*data*/)
@@ -1267,10 +1470,8 @@ namespace osmscout {
     {
       PathSymbolStyleRef pathSymbolStyle;
 
-      styleConfig.GetWayPathSymbolStyle(*way->attributes,
-                                        projection,
-                                        parameter.GetDPI(),
-                                        pathSymbolStyle);
+      styleCache.GetWayPathSymbolStyle(*way->attributes,
+                                       pathSymbolStyle);
 
       if (pathSymbolStyle.Valid()) {
         double symbolSpace=ConvertWidthToPixel(parameter,
@@ -1285,7 +1486,7 @@ namespace osmscout {
     }
   }
 
-  void MapPainter::DrawWayLabel(const StyleConfig& styleConfig,
+  void MapPainter::DrawWayLabel(const StyleConfig& /*styleConfig*/,
                                 const Projection& projection,
                                 const MapParameter& parameter,
                                 const WayPathData& data)
@@ -1298,14 +1499,10 @@ namespace osmscout {
     PathShieldStyleRef shieldStyle;
     PathTextStyleRef   pathTextStyle;
 
-    styleConfig.GetWayPathShieldStyle(*data.attributes,
-                                      projection,
-                                      parameter.GetDPI(),
-                                      shieldStyle);
-    styleConfig.GetWayPathTextStyle(*data.attributes,
-                                    projection,
-                                    parameter.GetDPI(),
-                                    pathTextStyle);
+    styleCache.GetWayPathShieldStyle(*data.attributes,
+                                     shieldStyle);
+    styleCache.GetWayPathTextStyle(*data.attributes,
+                                   pathTextStyle);
 
     if (pathTextStyle.Valid()) {
       switch (pathTextStyle->GetLabel()) {
@@ -1406,8 +1603,8 @@ namespace osmscout {
     // Draw normal
     //
 
-    for (std::list<LabelData>::const_iterator label=labels.begin();
-         label!=labels.end();
+    for (std::list<LabelData>::const_iterator label=labels.GetLabels().begin();
+         label!=labels.GetLabels().end();
          ++label) {
       DrawLabel(projection,
                 parameter,
@@ -1419,8 +1616,8 @@ namespace osmscout {
     // Draw overlays
     //
 
-    for (std::list<LabelData>::const_iterator label=overlayLabels.begin();
-         label!=overlayLabels.end();
+    for (std::list<LabelData>::const_iterator label=overlayLabels.GetLabels().begin();
+         label!=overlayLabels.GetLabels().end();
          ++label) {
       DrawLabel(projection,
                 parameter,
@@ -1429,31 +1626,245 @@ namespace osmscout {
     }
   }
 
-  void MapPainter::PrepareAreas(const StyleConfig& styleConfig,
-                                const Projection& projection,
+  /**
+    Return the number of threads to use for preparing the given number of
+    objects and make sure, that there are enough workers.
+    */
+  size_t MapPainter::GetPrepareThreadCount(const MapParameter& parameter,
+                                           size_t objectCount)
+  {
+#if defined(OSMSCOUT_HAVE_THREAD)
+    size_t threads=std::min(parameter.GetPrepareThreadCount(),
+                            objectCount/minPrepareObjectsPerThread);
+
+    if (threads<=1) {
+      return 1;
+    }
+
+    while (prepareWorkers.size()<threads) {
+      prepareWorkers.push_back(new PrepareWorker());
+    }
+
+    for (size_t i=0; i<threads; i++) {
+      prepareWorkers[i]->transBuffer.Reset();
+      prepareWorkers[i]->data.transBuffer=&prepareWorkers[i]->transBuffer;
+      prepareWorkers[i]->data.areaData.clear();
+      prepareWorkers[i]->data.wayData.clear();
+      prepareWorkers[i]->data.wayPathData.clear();
+      prepareWorkers[i]->data.areasSegments=0;
+      prepareWorkers[i]->data.waysSegments=0;
+    }
+
+    return threads;
+#else
+    return 1;
+#endif
+  }
+
+  /**
+    Append the coordinates transformed by the given worker to the
+    coordinate buffer of the painter and rebase all coordinate indexes of
+    the worker's data accordingly.
+    */
+  void MapPainter::CopyPreparedCoords(PrepareWorker& worker)
+  {
+    size_t offset=coordBuffer->GetLength();
+
+    for (size_t i=0; i<worker.coordBuffer->GetLength(); i++) {
+      coordBuffer->PushCoord(worker.coordBuffer->buffer[i].GetX(),
+                             worker.coordBuffer->buffer[i].GetY());
+    }
+
+    if (offset==0) {
+      return;
+    }
+
+    PrepareData& data=worker.data;
+
+    for (std::list<AreaData>::iterator area=data.areaData.begin();
+         area!=data.areaData.end();
+         ++area) {
+      area->transStart+=offset;
+      area->transEnd+=offset;
+
+      for (std::list<PolyData>::iterator clipping=area->clippings.begin();
+           clipping!=area->clippings.end();
+           ++clipping) {
+        clipping->transStart+=offset;
+        clipping->transEnd+=offset;
+      }
+    }
+
+    for (std::list<WayData>::iterator way=data.wayData.begin();
+         way!=data.wayData.end();
+         ++way) {
+      way->transStart+=offset;
+      way->transEnd+=offset;
+    }
+
+    for (std::list<WayPathData>::iterator path=data.wayPathData.begin();
+         path!=data.wayPathData.end();
+         ++path) {
+      path->transStart+=offset;
+      path->transEnd+=offset;
+    }
+  }
+
+  /**
+    Return the width and the offset of the given line style for the given
+    way in pixel
+    */
+  void MapPainter::GetLineWidth(const Projection& projection,
                                 const MapParameter& parameter,
-                                const MapData& data)
+                                const WayAttributes& attributes,
+                                const LineStyle& lineStyle,
+                                double& lineWidth,
+                                double& lineOffset) const
   {
-    areaData.clear();
+    lineWidth=0.0;
+    lineOffset=0.0;
+
+    if (lineStyle.GetWidth()>0.0) {
+      if (attributes.GetWidth()>0.0) {
+        lineWidth+=GetProjectedWidth(projection,
+                                     attributes.GetWidth());
+      }
+      else {
+        lineWidth+=GetProjectedWidth(projection,
+                                     lineStyle.GetWidth());
+      }
+    }
+
+    if (lineStyle.GetDisplayWidth()>0.0) {
+      lineWidth+=ConvertWidthToPixel(parameter,
+                                     lineStyle.GetDisplayWidth());
+    }
+
+    if (lineStyle.GetOffset()!=0.0) {
+      lineOffset+=GetProjectedWidth(projection,
+                                    lineStyle.GetOffset());
+    }
+
+    if (lineStyle.GetDisplayOffset()!=0.0) {
+      lineOffset+=ConvertWidthToPixel(parameter,
+                                      lineStyle.GetDisplayOffset());
+    }
+  }
+
+  /**
+    Return true, if the way can be clipped to the visible region before
+    transformation without changing its look. Dashes, labels and symbols
+    are placed relative to the start of the path, so clipping would move
+    them (and break them at tile borders). Lines must not be wider than the
+    clip margin, so that the clipped ends stay invisible.
+
+    Accesses the style cache, so it must not be called during parallel
+    preparation.
+    */
+  bool MapPainter::IsClippable(const Projection& projection,
+                               const MapParameter& parameter,
+                               const WayAttributes& attributes,
+                               const std::vector<LineStyleRef>& lineStyles)
+  {
+    if (!parameter.GetClipGeometry()) {
+      return false;
+    }
+
+    for (std::vector<LineStyleRef>::const_iterator ls=lineStyles.begin();
+         ls!=lineStyles.end();
+         ++ls) {
+      const LineStyle& lineStyle=**ls;
+      double           lineWidth;
+      double           lineOffset;
+
+      if (lineStyle.HasDashes()) {
+        return false;
+      }
+
+      GetLineWidth(projection,
+                   parameter,
+                   attributes,
+                   lineStyle,
+                   lineWidth,
+                   lineOffset);
+
+      if (lineWidth/2+fabs(lineOffset)>parameter.GetClipMarginPixel()) {
+        return false;
+      }
+    }
+
+    PathTextStyleRef   pathTextStyle;
+    PathShieldStyleRef pathShieldStyle;
+    PathSymbolStyleRef pathSymbolStyle;
+
+    styleCache.GetWayPathTextStyle(attributes,
+                                   pathTextStyle);
+    styleCache.GetWayPathShieldStyle(attributes,
+                                     pathShieldStyle);
+    styleCache.GetWayPathSymbolStyle(attributes,
+                                     pathSymbolStyle);
+
+    return pathTextStyle.Invalid() &&
+           pathShieldStyle.Invalid() &&
+           pathSymbolStyle.Invalid();
+  }
+
+  /**
+    Switch clipping of the given polygon on or off
+    */
+  static void SetClipping(const Projection& projection,
+                          const MapParameter& parameter,
+                          bool clip,
+                          TransPolygon& transPolygon)
+  {
+    if (clip==transPolygon.HasClipRegion()) {
+      return;
+    }
 
-    //Areas
-    for (std::vector<AreaRef>::const_iterator a=data.areas.begin();
-         a!=data.areas.end();
-         ++a) {
-      const AreaRef& area=*a;
+    if (clip) {
+      transPolygon.SetClipRegion(projection,
+                                 parameter.GetClipMarginPixel());
+    }
+    else {
+      transPolygon.ClearClipRegion();
+    }
+  }
+
+  /**
+    Transform the areas [start,end[ of the given data and return the
+    sorted areas to draw. Does not access any state of the painter except
+    the styles resolved in advance, so it can be called from multiple
+    threads for distinct ranges.
+    */
+  void MapPainter::PrepareAreaRange(const Projection& projection,
+                                    const MapParameter& parameter,
+                                    const MapData& data,
+                                    size_t start,
+                                    size_t end,
+                                    PrepareData& prepareData)
+  {
+    for (size_t a=start; a<end; a++) {
+      const AreaRef&      area=data.areas[a];
+      const FillStyleRef* fillStyles=&areaFillStyles[areaFillStyleStart[a]];
 
       std::vector<PolyData> data(area->rings.size());
+      std::vector<bool>     transformed(area->rings.size(),false);
+
+      SetClipping(projection,
+                  parameter,
+                  areaClip[a],
+                  prepareData.transBuffer->transPolygon);
 
       for (size_t i=0; i<area->rings.size(); i++) {
         if (area->rings[i].ring==Area::masterRingId) {
           continue;
         }
 
-        transBuffer.TransformArea(projection,
-                                  parameter.GetOptimizeAreaNodes(),
-                                  area->rings[i].nodes,
-                                  data[i].transStart,data[i].transEnd,
-                                  parameter.GetOptimizeErrorToleranceDots());
+        transformed[i]=prepareData.transBuffer->TransformArea(projection,
+                                                              parameter.GetOptimizeAreaNodes(),
+                                                              area->rings[i].nodes,
+                                                              data[i].transStart,data[i].transEnd,
+                                                              parameter.GetOptimizeErrorToleranceDots());
       }
 
       size_t ringId=Area::outerRingId;
@@ -1466,22 +1877,7 @@ namespace osmscout {
           const Area::Ring& ring=area->rings[i];
 
           if (ring.ring==ringId) {
-            FillStyleRef fillStyle;
-
-            if (ring.ring==Area::outerRingId) {
-              styleConfig.GetAreaFillStyle(area->GetType(),
-                                           ring.GetAttributes(),
-                                           projection,
-                                           parameter.GetDPI(),
-                                           fillStyle);
-            }
-            else if (ring.GetType()!=typeIgnore) {
-              styleConfig.GetAreaFillStyle(ring.GetType(),
-                                           ring.GetAttributes(),
-                                           projection,
-                                           parameter.GetDPI(),
-                                           fillStyle);
-            }
+            const FillStyleRef& fillStyle=fillStyles[i];
 
             if (fillStyle.Invalid())
             {
@@ -1490,7 +1886,8 @@ namespace osmscout {
 
             foundRing=true;
 
-            if (!IsVisible(projection,
+            if (!transformed[i] ||
+                !IsVisible(projection,
                            ring.nodes,
                            fillStyle->GetBorderWidth()/2)) {
               continue;
@@ -1508,7 +1905,10 @@ namespace osmscout {
             while (j<area->rings.size() &&
                    area->rings[j].ring==ringId+1 &&
                    area->rings[j].GetType()==typeIgnore) {
-              a.clippings.push_back(data[j]);
+              // Clipped away holes do not affect the visible region
+              if (transformed[j]) {
+                a.clippings.push_back(data[j]);
+              }
 
               j++;
             }
@@ -1531,9 +1931,9 @@ namespace osmscout {
               a.maxLon=std::min(a.maxLon,ring.nodes[i].GetLon());
             }
 
-            areaData.push_back(a);
+            prepareData.areaData.push_back(a);
 
-            areasSegments++;
+            prepareData.areasSegments++;
           }
         }
 
@@ -1541,7 +1941,110 @@ namespace osmscout {
       }
     }
 
-    areaData.sort(AreaSorter);
+    prepareData.transBuffer->transPolygon.ClearClipRegion();
+
+    prepareData.areaData.sort(AreaSorter);
+  }
+
+  void MapPainter::PrepareAreas(const StyleConfig& /*styleConfig*/,
+                                const Projection& projection,
+                                const MapParameter& parameter,
+                                const MapData& data)
+  {
+    areaData.clear();
+
+    // Resolve the fill style of all rings in advance, since the style
+    // cache must not be accessed from multiple threads
+    areaFillStyles.clear();
+    areaFillStyleStart.resize(data.areas.size());
+    areaClip.resize(data.areas.size());
+
+    for (size_t a=0; a<data.areas.size(); a++) {
+      const AreaRef& area=data.areas[a];
+
+      areaFillStyleStart[a]=areaFillStyles.size();
+      areaClip[a]=parameter.GetClipGeometry();
+
+      for (size_t i=0; i<area->rings.size(); i++) {
+        const Area::Ring& ring=area->rings[i];
+        FillStyleRef      fillStyle;
+
+        if (ring.ring==Area::masterRingId) {
+          // no code
+        }
+        else if (ring.ring==Area::outerRingId) {
+          styleCache.GetAreaFillStyle(area->GetType(),
+                                      ring.GetAttributes(),
+                                      fillStyle);
+        }
+        else if (ring.GetType()!=typeIgnore) {
+          styleCache.GetAreaFillStyle(ring.GetType(),
+                                      ring.GetAttributes(),
+                                      fillStyle);
+        }
+
+        // Dashes are placed relative to the start of the ring, so clipping
+        // would move them, borders must not reach into the visible region
+        if (fillStyle.Valid() &&
+            (fillStyle->HasBorderDashes() ||
+             ConvertWidthToPixel(parameter,fillStyle->GetBorderWidth())/2>parameter.GetClipMarginPixel())) {
+          areaClip[a]=false;
+        }
+
+        areaFillStyles.push_back(fillStyle);
+      }
+    }
+
+    size_t threads=GetPrepareThreadCount(parameter,
+                                         data.areas.size());
+
+    if (threads<=1) {
+      PrepareData prepareData;
+
+      prepareData.transBuffer=&transBuffer;
+      prepareData.areasSegments=0;
+      prepareData.waysSegments=0;
+
+      PrepareAreaRange(projection,
+                       parameter,
+                       data,
+                       0,
+                       data.areas.size(),
+                       prepareData);
+
+      areaData.swap(prepareData.areaData);
+      areasSegments+=prepareData.areasSegments;
+
+      return;
+    }
+
+#if defined(OSMSCOUT_HAVE_THREAD)
+    std::vector<std::thread> threadList;
+
+    for (size_t i=0; i<threads; i++) {
+      threadList.push_back(std::thread(&MapPainter::PrepareAreaRange,
+                                       this,
+                                       std::cref(projection),
+                                       std::cref(parameter),
+                                       std::cref(data),
+                                       i*data.areas.size()/threads,
+                                       (i+1)*data.areas.size()/threads,
+                                       std::ref(prepareWorkers[i]->data)));
+    }
+
+    for (size_t i=0; i<threadList.size(); i++) {
+      threadList[i].join();
+    }
+
+    // Merging the sorted ranges in order is stable, so the result is the
+    // same as for serial preparation
+    for (size_t i=0; i<threads; i++) {
+      CopyPreparedCoords(*prepareWorkers[i]);
+
+      areaData.merge(prepareWorkers[i]->data.areaData,AreaSorter);
+      areasSegments+=prepareWorkers[i]->data.areasSegments;
+    }
+#endif
   }
 
   void MapPainter::PrepareWaySegment(const StyleConfig& styleConfig,
@@ -1550,13 +2053,10 @@ namespace osmscout {
                                      const ObjectFileRef& ref,
                                      const WayAttributes& attributes,
                                      const std::vector<GeoCoord>& nodes,
-                                     const std::vector<Id>& ids)
+                                     const std::vector<Id>& ids,
+                                     const std::vector<LineStyleRef>& lineStyles,
+                                     PrepareData& prepareData)
   {
-    styleConfig.GetWayLineStyles(attributes,
-                                 projection,
-                                 parameter.GetDPI(),
-                                 lineStyles);
-
     if (lineStyles.empty()) {
       return;
     }
@@ -1569,39 +2069,20 @@ namespace osmscout {
          ls!=lineStyles.end();
          ++ls) {
       LineStyleRef lineStyle(*ls);
-      double       lineWidth=0.0;
-      double       lineOffset=0.0;
-
-      if (lineStyle->GetWidth()>0.0) {
-        if (attributes.GetWidth()>0.0) {
-          lineWidth+=GetProjectedWidth(projection,
-                                       attributes.GetWidth());
-        }
-        else {
-          lineWidth+=GetProjectedWidth(projection,
-                                       lineStyle->GetWidth());
-        }
-      }
+      double       lineWidth;
+      double       lineOffset;
 
-      if (lineStyle->GetDisplayWidth()>0.0) {
-        lineWidth+=ConvertWidthToPixel(parameter,
-                                       lineStyle->GetDisplayWidth());
-      }
+      GetLineWidth(projection,
+                   parameter,
+                   attributes,
+                   *lineStyle,
+                   lineWidth,
+                   lineOffset);
 
       if (lineWidth==0.0) {
         continue;
       }
 
-      if (lineStyle->GetOffset()!=0.0) {
-        lineOffset+=GetProjectedWidth(projection,
-                                      lineStyle->GetOffset());
-      }
-
-      if (lineStyle->GetDisplayOffset()!=0.0) {
-        lineOffset+=ConvertWidthToPixel(parameter,
-                                        lineStyle->GetDisplayOffset());
-      }
-
       WayData data;
 
       data.ref=ref;
@@ -1614,12 +2095,12 @@ namespace osmscout {
       }
 
       if (!transformed) {
-        transBuffer.TransformWay(projection,
-                                 parameter.GetOptimizeWayNodes(),
-                                 nodes,
-                                 transStart,
-                                 transEnd,
-                                 parameter.GetOptimizeErrorToleranceDots());
+        prepareData.transBuffer->TransformWay(projection,
+                                              parameter.GetOptimizeWayNodes(),
+                                              nodes,
+                                              transStart,
+                                              transEnd,
+                                              parameter.GetOptimizeErrorToleranceDots());
 
         WayPathData pathData;
 
@@ -1628,7 +2109,7 @@ namespace osmscout {
         pathData.transStart=transStart;
         pathData.transEnd=transEnd;
 
-        wayPathData.push_back(pathData);
+        prepareData.wayPathData.push_back(pathData);
 
         transformed=true;
       }
@@ -1640,21 +2121,57 @@ namespace osmscout {
       data.endIsClosed=ids.empty() || ids[ids.size()-1]==0;
 
       if (lineOffset!=0.0) {
-        coordBuffer->GenerateParallelWay(transStart,transEnd,
-                                         lineOffset,
-                                         data.transStart,
-                                         data.transEnd);
+        prepareData.transBuffer->buffer->GenerateParallelWay(transStart,transEnd,
+                                                             lineOffset,
+                                                             data.transStart,
+                                                             data.transEnd);
       }
       else {
         data.transStart=transStart;
         data.transEnd=transEnd;
       }
 
-      waysSegments++;
-      wayData.push_back(data);
+      prepareData.waysSegments++;
+      prepareData.wayData.push_back(data);
     }
   }
 
+  /**
+    Transform the ways [start,end[ of preparedWays and return the sorted
+    way segments to draw. Like PrepareAreaRange() it can be called from
+    multiple threads for distinct ranges.
+    */
+  void MapPainter::PrepareWayRange(const StyleConfig& styleConfig,
+                                   const Projection& projection,
+                                   const MapParameter& parameter,
+                                   size_t start,
+                                   size_t end,
+                                   PrepareData& prepareData)
+  {
+    for (size_t w=start; w<end; w++) {
+      const Way& way=*preparedWays[w];
+
+      SetClipping(projection,
+                  parameter,
+                  preparedClip[w],
+                  prepareData.transBuffer->transPolygon);
+
+      PrepareWaySegment(styleConfig,
+                        projection,
+                        parameter,
+                        ObjectFileRef(way.GetFileOffset(),refWay),
+                        way.GetAttributes(),
+                        way.nodes,
+                        way.ids,
+                        *preparedLineStyles[w],
+                        prepareData);
+    }
+
+    prepareData.transBuffer->transPolygon.ClearClipRegion();
+
+    prepareData.wayData.sort();
+  }
+
   void MapPainter::PrepareWays(const StyleConfig& styleConfig,
                                const Projection& projection,
                                const MapParameter& parameter,
@@ -1663,18 +2180,27 @@ namespace osmscout {
     wayData.clear();
     wayPathData.clear();
 
+    // Resolve the line styles of all ways in advance, since the style
+    // cache must not be accessed from multiple threads
+    preparedWays.clear();
+    preparedLineStyles.clear();
+    preparedClip.clear();
+
+    preparedWays.reserve(data.ways.size()+data.poiWays.size());
+    preparedLineStyles.reserve(data.ways.size()+data.poiWays.size());
+    preparedClip.reserve(data.ways.size()+data.poiWays.size());
+
     for (std::vector<WayRef>::const_iterator w=data.ways.begin();
          w!=data.ways.end();
          ++w) {
       const WayRef& way=*w;
 
-      PrepareWaySegment(styleConfig,
-                        projection,
-                        parameter,
-                        ObjectFileRef(way->GetFileOffset(),refWay),
-                        way->GetAttributes(),
-                        way->nodes,
-                        way->ids);
+      preparedWays.push_back(way.Get());
+      preparedLineStyles.push_back(&styleCache.GetWayLineStyles(way->GetAttributes()));
+      preparedClip.push_back(IsClippable(projection,
+                                         parameter,
+                                         way->GetAttributes(),
+                                         *preparedLineStyles.back()));
     }
 
     for (std::list<WayRef>::const_iterator p=data.poiWays.begin();
@@ -1682,16 +2208,66 @@ namespace osmscout {
          ++p) {
       const WayRef& way=*p;
 
-      PrepareWaySegment(styleConfig,
-                        projection,
-                        parameter,
-                        ObjectFileRef(way->GetFileOffset(),refWay),
-                        way->GetAttributes(),
-                        way->nodes,
-                        way->ids);
+      preparedWays.push_back(way.Get());
+      preparedLineStyles.push_back(&styleCache.GetWayLineStyles(way->GetAttributes()));
+      preparedClip.push_back(IsClippable(projection,
+                                         parameter,
+                                         way->GetAttributes(),
+                                         *preparedLineStyles.back()));
     }
 
-    wayData.sort();
+    size_t threads=GetPrepareThreadCount(parameter,
+                                         preparedWays.size());
+
+    if (threads<=1) {
+      PrepareData prepareData;
+
+      prepareData.transBuffer=&transBuffer;
+      prepareData.areasSegments=0;
+      prepareData.waysSegments=0;
+
+      PrepareWayRange(styleConfig,
+                      projection,
+                      parameter,
+                      0,
+                      preparedWays.size(),
+                      prepareData);
+
+      wayData.swap(prepareData.wayData);
+      wayPathData.swap(prepareData.wayPathData);
+      waysSegments+=prepareData.waysSegments;
+
+      return;
+    }
+
+#if defined(OSMSCOUT_HAVE_THREAD)
+    std::vector<std::thread> threadList;
+
+    for (size_t i=0; i<threads; i++) {
+      threadList.push_back(std::thread(&MapPainter::PrepareWayRange,
+                                       this,
+                                       std::cref(styleConfig),
+                                       std::cref(projection),
+                                       std::cref(parameter),
+                                       i*preparedWays.size()/threads,
+                                       (i+1)*preparedWays.size()/threads,
+                                       std::ref(prepareWorkers[i]->data)));
+    }
+
+    for (size_t i=0; i<threadList.size(); i++) {
+      threadList[i].join();
+    }
+
+    // Merging the sorted ranges in order is stable, so the result is the
+    // same as for serial preparation
+    for (size_t i=0; i<threads; i++) {
+      CopyPreparedCoords(*prepareWorkers[i]);
+
+      wayData.merge(prepareWorkers[i]->data.wayData);
+      wayPathData.splice(wayPathData.end(),prepareWorkers[i]->data.wayPathData);
+      waysSegments+=prepareWorkers[i]->data.waysSegments;
+    }
+#endif
   }
 
   void MapPainter::GetLabelFrame(const LabelStyle& style,
@@ -1740,8 +2316,16 @@ namespace osmscout {
 
     labelsDrawn=0;
 
-    labels.clear();
-    overlayLabels.clear();
+    styleCache.Prepare(styleConfig,
+                       projection,
+                       parameter.GetDPI());
+
+    labels.Initialize(projection.GetWidth(),
+                      projection.GetHeight(),
+                      labelCellSize);
+    overlayLabels.Initialize(projection.GetWidth(),
+                             projection.GetHeight(),
+                             labelCellSize);
 
     transBuffer.Reset();
 
@@ -1966,7 +2550,7 @@ namespace osmscout {
       std::cout << data.nodes.size() <<"+" << data.poiNodes.size() << "/" << nodesDrawn << " (pcs) ";
       std::cout << nodesTimer << "/" << poisTimer << " (sec)" << std::endl;
 
-      std::cout << "Labels: " << labels.size() << "/" << overlayLabels.size() << "/" << labelsDrawn << " (pcs) ";
+      std::cout << "Labels: " << labels.GetLabels().size() << "/" << overlayLabels.GetLabels().size() << "/" << labelsDrawn << " (pcs) ";
       std::cout << labelsTimer << " (sec)" << std::endl;
     }
 
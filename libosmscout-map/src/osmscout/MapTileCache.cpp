@@ -0,0 +1,519 @@
+/*
+  This source is part of the libosmscout-map library
+  Copyright (C) 2013  Tim Teulings
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+#include <osmscout/MapTileCache.h>
+
+#include <algorithm>
+#include <iostream>
+
+#include <osmscout/system/Math.h>
+
+namespace osmscout {
+
+  static const double gradtorad=2*M_PI/360;
+
+  /**
+    Maximum number of grids in the cache, the grid index is stored in the
+    upper 8 bits of the tile key
+    */
+  static const size_t maxGridCount=256;
+
+  /**
+    Number of bits of the tile key used for the x and y coordinate
+    */
+  static const size_t tileCoordBits=28;
+
+  /**
+    Longitude of the given horizontal position in a world of the given size
+    */
+  static double GetWorldLon(double x,
+                            double worldSize)
+  {
+    return x/worldSize*360.0-180.0;
+  }
+
+  /**
+    Latitude of the given vertical position in a world of the given size
+    */
+  static double GetWorldLat(double y,
+                            double worldSize)
+  {
+    double n=M_PI-2.0*M_PI*y/worldSize;
+
+    return atan(sinh(n))/gradtorad;
+  }
+
+  MapTileCache::Tile::~Tile()
+  {
+    // no code
+  }
+
+  /**
+    Create a new cache for square tiles of the given size in pixel, holding
+    up to maxTiles tiles. Prefetch() renders the tiles of two views and a
+    border of tiles, so maxTiles should be chosen big enough to hold them
+    all.
+    */
+  MapTileCache::MapTileCache(const Database& database,
+                             size_t tileSize,
+                             size_t maxTiles)
+  : database(database),
+    tileSize(std::max((size_t)1,tileSize)),
+    tiles(maxTiles),
+    styleConfig(NULL),
+    styleGeneration(0),
+    flushCount(0)
+  {
+    // no code
+  }
+
+  MapTileCache::~MapTileCache()
+  {
+    // no code
+  }
+
+  uint64_t MapTileCache::GetTileKey(size_t grid,
+                                    size_t x,
+                                    size_t y)
+  {
+    return ((uint64_t)grid << (2*tileCoordBits)) |
+           ((uint64_t)y << tileCoordBits) |
+           (uint64_t)x;
+  }
+
+  /**
+    Drop all tiles and grids, the mutex must be held by the caller
+    */
+  void MapTileCache::FlushTiles()
+  {
+    tiles.Flush();
+    grids.clear();
+    flushCount++;
+  }
+
+  bool MapTileCache::FindGrid(double worldSize,
+                              size_t& grid) const
+  {
+    for (size_t i=0; i<grids.size(); i++) {
+      if (grids[i]==worldSize) {
+        grid=i;
+
+        return true;
+      }
+    }
+
+    return false;
+  }
+
+  /**
+    Return the index of the grid for the given world size, registering a new
+    grid if required. If there are too many grids the cache is flushed.
+    The mutex must be held by the caller.
+    */
+  size_t MapTileCache::GetGrid(double worldSize)
+  {
+    size_t grid;
+
+    if (FindGrid(worldSize,grid)) {
+      return grid;
+    }
+
+    if (grids.size()>=maxGridCount) {
+      FlushTiles();
+    }
+
+    grids.push_back(worldSize);
+
+    return grids.size()-1;
+  }
+
+  /**
+    Calculate the range of tiles covering the view, extended by the given
+    number of tiles on each side. Returns false, if the view does not
+    show any part of the world.
+    */
+  bool MapTileCache::GetTileRange(const View& view,
+                                  size_t border,
+                                  TileRange& range) const
+  {
+    // The view shows 360/magnification degrees over its complete width
+    range.worldSize=view.magnification.GetMagnification()*view.width;
+
+    if (range.worldSize<=0.0 ||
+        view.height==0) {
+      return false;
+    }
+
+    double tileCount=std::min(ceil(range.worldSize/tileSize),
+                              (double)((size_t)1 << tileCoordBits));
+
+    range.x=(view.lon+180.0)/360.0*range.worldSize-view.width/2.0;
+    range.y=(1.0-atanh(sin(view.lat*gradtorad))/M_PI)/2.0*range.worldSize-view.height/2.0;
+
+    double xStart=std::max(0.0,floor(range.x/tileSize)-border);
+    double xEnd=std::min(tileCount-1,floor((range.x+view.width-1)/tileSize)+border);
+    double yStart=std::max(0.0,floor(range.y/tileSize)-border);
+    double yEnd=std::min(tileCount-1,floor((range.y+view.height-1)/tileSize)+border);
+
+    if (xStart>xEnd ||
+        yStart>yEnd) {
+      return false;
+    }
+
+    range.xStart=(size_t)xStart;
+    range.xEnd=(size_t)xEnd;
+    range.yStart=(size_t)yStart;
+    range.yEnd=(size_t)yEnd;
+
+    return true;
+  }
+
+  /**
+    Load the data of the given tile, draw it and store it in the cache, if
+    the tile is not already cached. Returns false on error or if rendering
+    was aborted.
+    */
+  bool MapTileCache::RenderTile(const StyleConfig& styleConfig,
+                                const Magnification& magnification,
+                                const Types& types,
+                                const TileRange& range,
+                                size_t grid,
+                                size_t x,
+                                size_t y,
+                                const MapParameter& parameter,
+                                const AreaSearchParameter& searchParameter,
+                                MapData& data)
+  {
+    uint64_t key=GetTileKey(grid,x,y);
+    size_t   currentFlushCount;
+
+    {
+      MutexLocker         locker(mutex);
+      TileCache::CacheRef entry;
+
+      if (tiles.GetEntry(key,entry)) {
+        return true;
+      }
+
+      currentFlushCount=flushCount;
+      data.poiWays=poiWays;
+    }
+
+    double tileX=(double)x*tileSize;
+    double tileY=(double)y*tileSize;
+
+    double lonMin=GetWorldLon(tileX,range.worldSize);
+    double lonMax=GetWorldLon(tileX+tileSize,range.worldSize);
+    double latMin=GetWorldLat(tileY+tileSize,range.worldSize);
+    double latMax=GetWorldLat(tileY,range.worldSize);
+
+    // The last row and column of tiles may extend beyond the world
+    double queryLonMax=GetWorldLon(std::min(range.worldSize,tileX+tileSize),range.worldSize);
+    double queryLatMin=GetWorldLat(std::min(range.worldSize,tileY+tileSize),range.worldSize);
+
+    // To get accurate label drawing at the borders, we also load nodes and
+    // areas of half a tile around the tile
+    double borderLonMin=GetWorldLon(std::max(0.0,tileX-tileSize/2.0),range.worldSize);
+    double borderLonMax=GetWorldLon(std::min(range.worldSize,tileX+tileSize*1.5),range.worldSize);
+    double borderLatMin=GetWorldLat(std::min(range.worldSize,tileY+tileSize*1.5),range.worldSize);
+    double borderLatMax=GetWorldLat(std::max(0.0,tileY-tileSize/2.0),range.worldSize);
+
+    data.nodes.clear();
+    data.ways.clear();
+    data.areas.clear();
+    data.groundTiles.clear();
+
+    if (!database.GetObjects(searchParameter,
+                             magnification,
+                             types.nodeTypes,
+                             borderLonMin,
+                             borderLatMin,
+                             borderLonMax,
+                             borderLatMax,
+                             data.nodes,
+                             types.wayTypes,
+                             lonMin,
+                             queryLatMin,
+                             queryLonMax,
+                             latMax,
+                             data.ways,
+                             types.areaTypes,
+                             borderLonMin,
+                             borderLatMin,
+                             borderLonMax,
+                             borderLatMax,
+                             data.areas)) {
+      if (!searchParameter.IsAborted()) {
+        std::cerr << "Cannot load data for tile " << grid << "/" << x << "/" << y << std::endl;
+      }
+
+      return false;
+    }
+
+    if (parameter.GetRenderSeaLand() &&
+        !database.GetGroundTiles(lonMin,
+                                 queryLatMin,
+                                 queryLonMax,
+                                 latMax,
+                                 magnification,
+                                 data.groundTiles)) {
+      std::cerr << "Cannot load ground tiles for tile " << grid << "/" << x << "/" << y << std::endl;
+      return false;
+    }
+
+    if (parameter.IsAborted()) {
+      return false;
+    }
+
+    MercatorProjection projection;
+
+    // The projection scales to width-1 pixel, so the tile borders
+    // are exactly at multiples of the tile size
+    projection.Set(lonMin,latMin,
+                   lonMax,latMax,
+                   magnification,
+                   tileSize+1);
+
+    TileRef tile=DrawTile(styleConfig,
+                          projection,
+                          parameter,
+                          data,
+                          tileSize,
+                          tileSize);
+
+    // A tile drawn while rendering was aborted may be incomplete
+    if (parameter.IsAborted()) {
+      return false;
+    }
+
+    if (tile.Invalid()) {
+      std::cerr << "Cannot draw tile " << grid << "/" << x << "/" << y << std::endl;
+      return false;
+    }
+
+    MutexLocker locker(mutex);
+
+    // Tiles rendered before a flush may be based on outdated data
+    if (flushCount==currentFlushCount) {
+      tiles.SetEntry(TileCache::CacheEntry(key,tile));
+    }
+
+    return true;
+  }
+
+  /**
+    Render all tiles of the view (plus the given number of tiles around it)
+    that are not already cached.
+    */
+  bool MapTileCache::RenderTileRange(const StyleConfig& styleConfig,
+                                     const View& view,
+                                     size_t border,
+                                     const MapParameter& parameter,
+                                     const AreaSearchParameter& searchParameter)
+  {
+    TileRange range;
+    size_t    grid;
+
+    if (!GetTileRange(view,
+                      border,
+                      range)) {
+      return true;
+    }
+
+    {
+      MutexLocker locker(mutex);
+
+      if (this->styleConfig!=&styleConfig ||
+          styleGeneration!=styleConfig.GetGeneration()) {
+        FlushTiles();
+
+        this->styleConfig=&styleConfig;
+        styleGeneration=styleConfig.GetGeneration();
+      }
+
+      grid=GetGrid(range.worldSize);
+    }
+
+    Types   types;
+    MapData data;
+
+    styleConfig.GetNodeTypesWithMaxMag(view.magnification,
+                                       types.nodeTypes);
+    styleConfig.GetWayTypesByPrioWithMaxMag(view.magnification,
+                                            types.wayTypes);
+    styleConfig.GetAreaTypesWithMaxMag(view.magnification,
+                                       types.areaTypes);
+
+    for (size_t y=range.yStart; y<=range.yEnd; y++) {
+      for (size_t x=range.xStart; x<=range.xEnd; x++) {
+        if (parameter.IsAborted() ||
+            searchParameter.IsAborted()) {
+          return false;
+        }
+
+        if (!RenderTile(styleConfig,
+                        view.magnification,
+                        types,
+                        range,
+                        grid,
+                        x,
+                        y,
+                        parameter,
+                        searchParameter,
+                        data)) {
+          return false;
+        }
+      }
+    }
+
+    return true;
+  }
+
+  size_t MapTileCache::GetTileSize() const
+  {
+    return tileSize;
+  }
+
+  void MapTileCache::SetMaxTiles(size_t maxTiles)
+  {
+    MutexLocker locker(mutex);
+
+    tiles.SetMaxSize(maxTiles);
+  }
+
+  /**
+    Set the ways drawn on top of the database objects (for example a route).
+    Flushes the cache.
+    */
+  void MapTileCache::SetPOIWays(const std::list<WayRef>& poiWays)
+  {
+    MutexLocker locker(mutex);
+
+    this->poiWays=poiWays;
+
+    FlushTiles();
+  }
+
+  /**
+    Drop all tiles, for example if the database has changed
+    */
+  void MapTileCache::Flush()
+  {
+    MutexLocker locker(mutex);
+
+    FlushTiles();
+  }
+
+  /**
+    Return all tiles covering the view together with their position in the
+    view. Tiles not rendered yet are returned as invalid references. Returns
+    true, if all tiles are available.
+    */
+  bool MapTileCache::GetViewTiles(const View& view,
+                                  std::vector<ViewTile>& viewTiles)
+  {
+    TileRange range;
+    size_t    grid;
+    bool      complete=true;
+
+    viewTiles.clear();
+
+    if (!GetTileRange(view,
+                      0,
+                      range)) {
+      return true;
+    }
+
+    MutexLocker locker(mutex);
+
+    bool hasGrid=FindGrid(range.worldSize,
+                          grid);
+
+    viewTiles.reserve((range.xEnd-range.xStart+1)*(range.yEnd-range.yStart+1));
+
+    for (size_t y=range.yStart; y<=range.yEnd; y++) {
+      for (size_t x=range.xStart; x<=range.xEnd; x++) {
+        ViewTile            viewTile;
+        TileCache::CacheRef entry;
+
+        viewTile.x=(double)x*tileSize-range.x;
+        viewTile.y=(double)y*tileSize-range.y;
+
+        if (hasGrid &&
+            tiles.GetEntry(GetTileKey(grid,x,y),entry)) {
+          viewTile.tile=entry->value;
+        }
+        else {
+          complete=false;
+        }
+
+        viewTiles.push_back(viewTile);
+      }
+    }
+
+    return complete;
+  }
+
+  /**
+    Render all tiles of the view not already cached. Returns false on error or
+    if rendering was aborted.
+    */
+  bool MapTileCache::RenderTiles(const StyleConfig& styleConfig,
+                                 const View& view,
+                                 const MapParameter& parameter,
+                                 const AreaSearchParameter& searchParameter)
+  {
+    return RenderTileRange(styleConfig,
+                           view,
+                           0,
+                           parameter,
+                           searchParameter);
+  }
+
+  /**
+    Render tiles likely to be shown next: First the ring of tiles around the
+    view (for moving the map), then the tiles of the view at the next zoom
+    level (twice the magnification). Meant to be called after RenderTiles(),
+    while the view does not change. Returns false on error or if rendering
+    was aborted.
+    */
+  bool MapTileCache::Prefetch(const StyleConfig& styleConfig,
+                              const View& view,
+                              const MapParameter& parameter,
+                              const AreaSearchParameter& searchParameter)
+  {
+    if (!RenderTileRange(styleConfig,
+                         view,
+                         1,
+                         parameter,
+                         searchParameter)) {
+      return false;
+    }
+
+    View zoomedView(view);
+
+    zoomedView.magnification.SetMagnification(view.magnification.GetMagnification()*2);
+
+    return RenderTileRange(styleConfig,
+                           zoomedView,
+                           0,
+                           parameter,
+                           searchParameter);
+  }
+}
@@ -21,8 +21,23 @@
 
 #include <set>
 
+#include <osmscout/util/Mutex.h>
+
 namespace osmscout {
 
+  static Mutex  generationMutex;
+  static size_t nextGeneration=1;
+
+  /**
+    Return a new, unique style configuration generation
+    */
+  static size_t GetNextGeneration()
+  {
+    MutexLocker locker(generationMutex);
+
+    return nextGeneration++;
+  }
+
   StyleVariable::StyleVariable()
   {
     // no code
@@ -144,7 +159,8 @@ namespace osmscout {
   }
 
   LineStyle::LineStyle(const LineStyle& style)
-  : slot(style.slot),
+  : Referencable(style),
+    slot(style.slot),
     lineColor(style.lineColor),
     gapColor(style.gapColor),
     displayWidth(style.displayWidth),
@@ -383,6 +399,7 @@ namespace osmscout {
   }
 
   FillStyle::FillStyle(const FillStyle& style)
+  : Referencable(style)
   {
     this->fillColor=style.fillColor;
     this->pattern=style.pattern;
@@ -533,6 +550,7 @@ namespace osmscout {
   }
 
   LabelStyle::LabelStyle(const LabelStyle& style)
+  : Referencable(style)
   {
     this->priority=style.priority;
     this->size=style.size;
@@ -745,7 +763,8 @@ namespace osmscout {
   }
 
   PathShieldStyle::PathShieldStyle(const PathShieldStyle& style)
-   : shieldStyle(new ShieldStyle(*style.GetShieldStyle().Get())),
+   : Referencable(style),
+     shieldStyle(new ShieldStyle(*style.GetShieldStyle().Get())),
      shieldSpace(style.shieldSpace)
   {
     // no code
@@ -841,6 +860,7 @@ namespace osmscout {
   }
 
   PathTextStyle::PathTextStyle(const PathTextStyle& style)
+  : Referencable(style)
   {
     this->label=style.label;
     this->size=style.size;
@@ -1011,6 +1031,7 @@ namespace osmscout {
   }
 
   IconStyle::IconStyle(const IconStyle& style)
+  : Referencable(style)
   {
     this->iconName=style.iconName;
     this->iconId=style.iconId;
@@ -1062,7 +1083,8 @@ namespace osmscout {
   }
 
   PathSymbolStyle::PathSymbolStyle(const PathSymbolStyle& style)
-  : symbol(style.symbol),
+  : Referencable(style),
+    symbol(style.symbol),
     symbolSpace(style.symbolSpace)
   {
     // no code
@@ -1275,7 +1297,8 @@ namespace osmscout {
   }
 
   StyleConfig::StyleConfig(TypeConfig* typeConfig)
-   : typeConfig(typeConfig)
+   : typeConfig(typeConfig),
+     generation(GetNextGeneration())
   {
     wayPrio.resize(typeConfig->GetMaxTypeId()+1,std::numeric_limits<size_t>::max());
   }
@@ -1766,6 +1789,8 @@ namespace osmscout {
 
     PostprocessIconId();
     PostprocessPatternId();
+
+    generation=GetNextGeneration();
   }
 
   TypeConfig* StyleConfig::GetTypeConfig() const
@@ -2206,5 +2231,223 @@ namespace osmscout {
                lineStyle);
     }
   }
+
+  StyleCache::StyleCache()
+  : styleConfig(NULL),
+    projection(NULL),
+    dpi(0.0),
+    generation(0),
+    level(0),
+    pixelSize(0.0)
+  {
+    // no code
+  }
+
+  void StyleCache::Prepare(const StyleConfig& styleConfig,
+                           const Projection& projection,
+                           double dpi)
+  {
+    if (this->styleConfig!=&styleConfig ||
+        generation!=styleConfig.GetGeneration() ||
+        level!=projection.GetMagnification().GetLevel() ||
+        pixelSize!=projection.GetPixelSize() ||
+        this->dpi!=dpi) {
+      size_t typeCount=styleConfig.GetTypeConfig()->GetMaxTypeId()+1;
+
+      Clear();
+
+      nodeTextStyles.resize(typeCount);
+      nodeIconStyles.resize(typeCount);
+
+      wayLineStyles.resize(typeCount*wayVariantCount);
+      wayPathTextStyles.resize(typeCount*wayVariantCount);
+      wayPathSymbolStyles.resize(typeCount*wayVariantCount);
+      wayPathShieldStyles.resize(typeCount*wayVariantCount);
+
+      areaFillStyles.resize(typeCount);
+      areaTextStyles.resize(typeCount);
+      areaIconStyles.resize(typeCount);
+
+      generation=styleConfig.GetGeneration();
+      level=projection.GetMagnification().GetLevel();
+      pixelSize=projection.GetPixelSize();
+    }
+
+    // The projection instance may change even if the resulting styles do not
+    this->styleConfig=&styleConfig;
+    this->projection=&projection;
+    this->dpi=dpi;
+  }
+
+  /**
+    Drop all cached styles
+    */
+  void StyleCache::Clear()
+  {
+    nodeTextStyles.clear();
+    nodeIconStyles.clear();
+
+    wayLineStyles.clear();
+    wayPathTextStyles.clear();
+    wayPathSymbolStyles.clear();
+    wayPathShieldStyles.clear();
+
+    areaFillStyles.clear();
+    areaTextStyles.clear();
+    areaIconStyles.clear();
+
+    styleConfig=NULL;
+    projection=NULL;
+    generation=0;
+  }
+
+  void StyleCache::GetNodeTextStyle(const Node& node,
+                                    TextStyleRef& textStyle)
+  {
+    Entry<TextStyle>& entry=nodeTextStyles[node.GetType()];
+
+    if (!entry.resolved) {
+      styleConfig->GetNodeTextStyle(node,
+                                    *projection,
+                                    dpi,
+                                    entry.style);
+      entry.resolved=true;
+    }
+
+    textStyle=entry.style;
+  }
+
+  void StyleCache::GetNodeIconStyle(const Node& node,
+                                    IconStyleRef& iconStyle)
+  {
+    Entry<IconStyle>& entry=nodeIconStyles[node.GetType()];
+
+    if (!entry.resolved) {
+      styleConfig->GetNodeIconStyle(node,
+                                    *projection,
+                                    dpi,
+                                    entry.style);
+      entry.resolved=true;
+    }
+
+    iconStyle=entry.style;
+  }
+
+  const std::vector<LineStyleRef>& StyleCache::GetWayLineStyles(const WayAttributes& way)
+  {
+    LineStylesEntry& entry=wayLineStyles[GetWayIndex(way)];
+
+    if (!entry.resolved) {
+      styleConfig->GetWayLineStyles(way,
+                                    *projection,
+                                    dpi,
+                                    entry.styles);
+      entry.resolved=true;
+    }
+
+    return entry.styles;
+  }
+
+  void StyleCache::GetWayPathTextStyle(const WayAttributes& way,
+                                       PathTextStyleRef& pathTextStyle)
+  {
+    Entry<PathTextStyle>& entry=wayPathTextStyles[GetWayIndex(way)];
+
+    if (!entry.resolved) {
+      styleConfig->GetWayPathTextStyle(way,
+                                       *projection,
+                                       dpi,
+                                       entry.style);
+      entry.resolved=true;
+    }
+
+    pathTextStyle=entry.style;
+  }
+
+  void StyleCache::GetWayPathSymbolStyle(const WayAttributes& way,
+                                         PathSymbolStyleRef& pathSymbolStyle)
+  {
+    Entry<PathSymbolStyle>& entry=wayPathSymbolStyles[GetWayIndex(way)];
+
+    if (!entry.resolved) {
+      styleConfig->GetWayPathSymbolStyle(way,
+                                         *projection,
+                                         dpi,
+                                         entry.style);
+      entry.resolved=true;
+    }
+
+    pathSymbolStyle=entry.style;
+  }
+
+  void StyleCache::GetWayPathShieldStyle(const WayAttributes& way,
+                                         PathShieldStyleRef& pathShieldStyle)
+  {
+    Entry<PathShieldStyle>& entry=wayPathShieldStyles[GetWayIndex(way)];
+
+    if (!entry.resolved) {
+      styleConfig->GetWayPathShieldStyle(way,
+                                         *projection,
+                                         dpi,
+                                         entry.style);
+      entry.resolved=true;
+    }
+
+    pathShieldStyle=entry.style;
+  }
+
+  void StyleCache::GetAreaFillStyle(const TypeId& type,
+                                    const AreaAttributes& area,
+                                    FillStyleRef& fillStyle)
+  {
+    Entry<FillStyle>& entry=areaFillStyles[type];
+
+    if (!entry.resolved) {
+      styleConfig->GetAreaFillStyle(type,
+                                    area,
+                                    *projection,
+                                    dpi,
+                                    entry.style);
+      entry.resolved=true;
+    }
+
+    fillStyle=entry.style;
+  }
+
+  void StyleCache::GetAreaTextStyle(const TypeId& type,
+                                    const AreaAttributes& area,
+                                    TextStyleRef& textStyle)
+  {
+    Entry<TextStyle>& entry=areaTextStyles[type];
+
+    if (!entry.resolved) {
+      styleConfig->GetAreaTextStyle(type,
+                                    area,
+                                    *projection,
+                                    dpi,
+                                    entry.style);
+      entry.resolved=true;
+    }
+
+    textStyle=entry.style;
+  }
+
+  void StyleCache::GetAreaIconStyle(const TypeId& type,
+                                    const AreaAttributes& area,
+                                    IconStyleRef& iconStyle)
+  {
+    Entry<IconStyle>& entry=areaIconStyles[type];
+
+    if (!entry.resolved) {
+      styleConfig->GetAreaIconStyle(type,
+                                    area,
+                                    *projection,
+                                    dpi,
+                                    entry.style);
+      entry.resolved=true;
+    }
+
+    iconStyle=entry.style;
+  }
 }
 
@@ -0,0 +1,461 @@
+/*
+  This source is part of the libosmscout-map library
+  Copyright (C) 2013  Tim Teulings
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+#include <osmscout/TileRenderer.h>
+
+#include <algorithm>
+#include <functional>
+#include <iostream>
+
+#if defined(OSMSCOUT_HAVE_THREAD)
+#include <thread>
+#endif
+
+#include <osmscout/system/Assert.h>
+#include <osmscout/system/Math.h>
+
+namespace osmscout {
+
+  TileRenderer::Worker::~Worker()
+  {
+    // no code
+  }
+
+  TileRenderer::TileRenderer(const Database& database,
+                             const StyleConfig& styleConfig)
+  : database(database),
+    styleConfig(styleConfig),
+    tileWidth(256),
+    tileHeight(256),
+    metaTileSize(8),
+    threadCount(1),
+    renderMetaTiles(true),
+    tileCount(0)
+  {
+    // no code
+  }
+
+  TileRenderer::~TileRenderer()
+  {
+    // no code
+  }
+
+  void TileRenderer::SetTileSize(size_t width,
+                                 size_t height)
+  {
+    tileWidth=width;
+    tileHeight=height;
+  }
+
+  void TileRenderer::SetMetaTileSize(size_t metaTileSize)
+  {
+    this->metaTileSize=std::max((size_t)1,metaTileSize);
+  }
+
+  void TileRenderer::SetThreadCount(size_t threadCount)
+  {
+    this->threadCount=std::max((size_t)1,threadCount);
+  }
+
+  /**
+    If true (the default), each meta tile is drawn at once and cut into tiles,
+    else each tile is drawn separately using its part of the data of the
+    meta tile. Drawing tiles separately is slower, but the painter gets
+    exactly the data a single tile query would return.
+    */
+  void TileRenderer::SetRenderMetaTiles(bool renderMetaTiles)
+  {
+    this->renderMetaTiles=renderMetaTiles;
+  }
+
+  size_t TileRenderer::GetTileWidth() const
+  {
+    return tileWidth;
+  }
+
+  size_t TileRenderer::GetTileHeight() const
+  {
+    return tileHeight;
+  }
+
+  size_t TileRenderer::GetMetaTileSize() const
+  {
+    return metaTileSize;
+  }
+
+  size_t TileRenderer::GetThreadCount() const
+  {
+    return threadCount;
+  }
+
+  bool TileRenderer::GetRenderMetaTiles() const
+  {
+    return renderMetaTiles;
+  }
+
+  size_t TileRenderer::GetTileCount() const
+  {
+    return tileCount;
+  }
+
+  /**
+    Load the data of the meta tile, draw it and write all its tiles.
+    */
+  bool TileRenderer::RenderMetaTile(Job& job,
+                                    const MetaTile& metaTile,
+                                    Worker& worker,
+                                    MapData& data)
+  {
+    const ZoomTypes&   types=job.types[metaTile.zoom-job.startZoom];
+    size_t             maxTile=(size_t)pow(2.0,(double)metaTile.zoom)-1;
+    size_t             xCount=metaTile.xEnd-metaTile.xStart+1;
+    size_t             yCount=metaTile.yEnd-metaTile.yStart+1;
+    Magnification      magnification;
+    MercatorProjection projection;
+
+    magnification.SetLevel((unsigned long)metaTile.zoom);
+
+    double minLon=TiledObjects::GetTileLon(metaTile.xStart,metaTile.zoom);
+    double maxLon=TiledObjects::GetTileLon(metaTile.xEnd+1,metaTile.zoom);
+    double minLat=TiledObjects::GetTileLat(metaTile.yEnd+1,metaTile.zoom);
+    double maxLat=TiledObjects::GetTileLat(metaTile.yStart,metaTile.zoom);
+
+    // To get accurate label drawing at the borders, we also load nodes and
+    // areas of the surrounding tiles
+    double minLon2=TiledObjects::GetTileLon(metaTile.xStart>0 ? metaTile.xStart-1 : 0,metaTile.zoom);
+    double maxLon2=TiledObjects::GetTileLon(std::min(metaTile.xEnd+1,maxTile)+1,metaTile.zoom);
+    double minLat2=TiledObjects::GetTileLat(std::min(metaTile.yEnd+1,maxTile)+1,metaTile.zoom);
+    double maxLat2=TiledObjects::GetTileLat(metaTile.yStart>0 ? metaTile.yStart-1 : 0,metaTile.zoom);
+
+    data.nodes.clear();
+    data.ways.clear();
+    data.areas.clear();
+
+    if (!database.GetObjects(*job.searchParameter,
+                             magnification,
+                             types.nodeTypes,
+                             minLon2,
+                             minLat2,
+                             maxLon2,
+                             maxLat2,
+                             data.nodes,
+                             types.wayTypes,
+                             minLon,
+                             minLat,
+                             maxLon,
+                             maxLat,
+                             data.ways,
+                             types.areaTypes,
+                             minLon2,
+                             minLat2,
+                             maxLon2,
+                             maxLat2,
+                             data.areas)) {
+      std::cerr << "Cannot load data for meta tile " << metaTile.zoom << "/" << metaTile.xStart << "/" << metaTile.yStart << std::endl;
+      return false;
+    }
+
+    size_t width=xCount*tileWidth;
+    size_t height=yCount*tileHeight;
+
+    // The projection scales to width-1 pixel, so the tile borders
+    // are exactly at multiples of the tile size
+    projection.Set(minLon,minLat,
+                   maxLon,maxLat,
+                   magnification,
+                   width+1);
+
+    if (!worker.DrawMetaTile(styleConfig,
+                             projection,
+                             *job.parameter,
+                             data,
+                             width,
+                             height)) {
+      std::cerr << "Cannot draw meta tile " << metaTile.zoom << "/" << metaTile.xStart << "/" << metaTile.yStart << std::endl;
+      return false;
+    }
+
+    for (size_t y=metaTile.yStart; y<=metaTile.yEnd; y++) {
+      for (size_t x=metaTile.xStart; x<=metaTile.xEnd; x++) {
+        if (!worker.WriteTile(metaTile.zoom,
+                              x,
+                              y,
+                              (x-metaTile.xStart)*tileWidth,
+                              (y-metaTile.yStart)*tileHeight,
+                              tileWidth,
+                              tileHeight)) {
+          std::cerr << "Cannot write tile " << metaTile.zoom << "/" << x << "/" << y << std::endl;
+          return false;
+        }
+      }
+    }
+
+    return true;
+  }
+
+  /**
+    Load the data of the meta tile once and draw and write each of its tiles
+    separately, using the objects assigned to the tile.
+    */
+  bool TileRenderer::RenderTiles(Job& job,
+                                 const MetaTile& metaTile,
+                                 Worker& worker,
+                                 TiledObjects& objects,
+                                 MapData& data)
+  {
+    const ZoomTypes& types=job.types[metaTile.zoom-job.startZoom];
+    Magnification    magnification;
+
+    magnification.SetLevel((unsigned long)metaTile.zoom);
+
+    if (!database.GetObjectsForTiles(*job.searchParameter,
+                                     magnification,
+                                     types.nodeTypes,
+                                     types.wayTypes,
+                                     types.areaTypes,
+                                     metaTile.zoom,
+                                     metaTile.xStart,
+                                     metaTile.yStart,
+                                     metaTile.xEnd,
+                                     metaTile.yEnd,
+                                     objects)) {
+      std::cerr << "Cannot load data for meta tile " << metaTile.zoom << "/" << metaTile.xStart << "/" << metaTile.yStart << std::endl;
+      return false;
+    }
+
+    for (size_t y=metaTile.yStart; y<=metaTile.yEnd; y++) {
+      for (size_t x=metaTile.xStart; x<=metaTile.xEnd; x++) {
+        MercatorProjection projection;
+
+        objects.GetTileObjects(x,
+                               y,
+                               data.nodes,
+                               data.ways,
+                               data.areas);
+
+        projection.Set(TiledObjects::GetTileLon(x,metaTile.zoom),
+                       TiledObjects::GetTileLat(y+1,metaTile.zoom),
+                       TiledObjects::GetTileLon(x+1,metaTile.zoom),
+                       TiledObjects::GetTileLat(y,metaTile.zoom),
+                       magnification,
+                       tileWidth+1);
+
+        if (!worker.DrawMetaTile(styleConfig,
+                                 projection,
+                                 *job.parameter,
+                                 data,
+                                 tileWidth,
+                                 tileHeight)) {
+          std::cerr << "Cannot draw tile " << metaTile.zoom << "/" << x << "/" << y << std::endl;
+          return false;
+        }
+
+        if (!worker.WriteTile(metaTile.zoom,
+                              x,
+                              y,
+                              0,
+                              0,
+                              tileWidth,
+                              tileHeight)) {
+          std::cerr << "Cannot write tile " << metaTile.zoom << "/" << x << "/" << y << std::endl;
+          return false;
+        }
+      }
+    }
+
+    objects.Clear();
+
+    return true;
+  }
+
+  /**
+    Thread function, renders meta tiles until there are no more meta tiles
+    left or an error occurred.
+    */
+  void TileRenderer::RenderMetaTiles(Job& job,
+                                     Worker* worker)
+  {
+    MapData      data;
+    TiledObjects objects;
+
+    while (true) {
+      size_t index;
+
+      {
+        MutexLocker locker(job.mutex);
+
+        if (!job.success ||
+            job.nextMetaTile>=job.metaTiles.size()) {
+          break;
+        }
+
+        index=job.nextMetaTile;
+        job.nextMetaTile++;
+      }
+
+      const MetaTile& metaTile=job.metaTiles[index];
+
+      bool success;
+
+      if (renderMetaTiles) {
+        success=RenderMetaTile(job,
+                               metaTile,
+                               *worker,
+                               data);
+      }
+      else {
+        success=RenderTiles(job,
+                            metaTile,
+                            *worker,
+                            objects,
+                            data);
+      }
+
+      if (!success) {
+        MutexLocker locker(job.mutex);
+
+        job.success=false;
+
+        break;
+      }
+
+      MutexLocker locker(job.mutex);
+
+      job.tileCount+=(metaTile.xEnd-metaTile.xStart+1)*(metaTile.yEnd-metaTile.yStart+1);
+    }
+  }
+
+  /**
+    Render all tiles of the zoom levels startZoom to endZoom (inclusive)
+    intersecting the given bounding box.
+    */
+  bool TileRenderer::Render(const MapParameter& parameter,
+                            const AreaSearchParameter& searchParameter,
+                            double lonMin, double latMin,
+                            double lonMax, double latMax,
+                            size_t startZoom,
+                            size_t endZoom)
+  {
+    Job job;
+
+    if (startZoom>endZoom) {
+      std::swap(startZoom,endZoom);
+    }
+
+    job.parameter=&parameter;
+    job.searchParameter=&searchParameter;
+    job.startZoom=startZoom;
+    job.nextMetaTile=0;
+    job.success=true;
+    job.tileCount=0;
+
+    tileCount=0;
+
+    for (size_t zoom=startZoom; zoom<=endZoom; zoom++) {
+      Magnification magnification;
+      ZoomTypes     types;
+
+      magnification.SetLevel((unsigned long)zoom);
+
+      styleConfig.GetNodeTypesWithMaxMag(magnification,
+                                         types.nodeTypes);
+      styleConfig.GetWayTypesByPrioWithMaxMag(magnification,
+                                              types.wayTypes);
+      styleConfig.GetAreaTypesWithMaxMag(magnification,
+                                         types.areaTypes);
+
+      job.types.push_back(types);
+
+      size_t xStart=TiledObjects::GetTileX(std::min(lonMin,lonMax),zoom);
+      size_t xEnd=TiledObjects::GetTileX(std::max(lonMin,lonMax),zoom);
+      size_t yStart=TiledObjects::GetTileY(std::max(latMin,latMax),zoom);
+      size_t yEnd=TiledObjects::GetTileY(std::min(latMin,latMax),zoom);
+
+      // Meta tiles are aligned to multiples of the meta tile size, so tiles
+      // rendered by separate calls are part of the same meta tiles
+      for (size_t y=yStart-yStart%metaTileSize; y<=yEnd; y+=metaTileSize) {
+        for (size_t x=xStart-xStart%metaTileSize; x<=xEnd; x+=metaTileSize) {
+          MetaTile metaTile;
+
+          metaTile.zoom=zoom;
+          metaTile.xStart=std::max(x,xStart);
+          metaTile.yStart=std::max(y,yStart);
+          metaTile.xEnd=std::min(x+metaTileSize-1,xEnd);
+          metaTile.yEnd=std::min(y+metaTileSize-1,yEnd);
+
+          job.metaTiles.push_back(metaTile);
+        }
+      }
+    }
+
+#if defined(OSMSCOUT_HAVE_THREAD)
+    size_t threads=std::max((size_t)1,std::min(threadCount,job.metaTiles.size()));
+#else
+    size_t threads=1;
+#endif
+
+    std::vector<Worker*> workers;
+
+    for (size_t i=0; i<threads; i++) {
+      Worker* worker=CreateWorker();
+
+      if (worker==NULL) {
+        std::cerr << "Cannot create tile render worker" << std::endl;
+        job.success=false;
+        break;
+      }
+
+      workers.push_back(worker);
+    }
+
+    if (job.success) {
+#if defined(OSMSCOUT_HAVE_THREAD)
+      if (workers.size()>1) {
+        std::vector<std::thread> threadList;
+
+        for (size_t i=0; i<workers.size(); i++) {
+          threadList.push_back(std::thread(&TileRenderer::RenderMetaTiles,
+                                           this,
+                                           std::ref(job),
+                                           workers[i]));
+        }
+
+        for (size_t i=0; i<threadList.size(); i++) {
+          threadList[i].join();
+        }
+      }
+      else {
+        RenderMetaTiles(job,
+                        workers.front());
+      }
+#else
+      RenderMetaTiles(job,
+                      workers.front());
+#endif
+    }
+
+    for (size_t i=0; i<workers.size(); i++) {
+      delete workers[i];
+    }
+
+    tileCount=job.tileCount;
+
+    return job.success;
+  }
+}
@@ -0,0 +1,1069 @@
+/*
+  This source is part of the libosmscout-map library
+  Copyright (C) 2013  Tim Teulings
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+#include <osmscout/VectorTileRenderer.h>
+
+#include <stdio.h>
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+
+#include <osmscout/TiledObjects.h>
+
+#include <osmscout/system/Math.h>
+
+#include <osmscout/util/File.h>
+#include <osmscout/util/Number.h>
+#include <osmscout/util/String.h>
+
+namespace osmscout {
+
+  // Protocol buffer wire types
+  static const uint32_t wireTypeVarint = 0;
+  static const uint32_t wireTypeBytes  = 2;
+
+  // Geometry commands
+  static const uint32_t commandMoveTo    = 1;
+  static const uint32_t commandLineTo    = 2;
+  static const uint32_t commandClosePath = 7;
+
+  // Layers of the tiles produced by the VectorTileRenderer
+  static const size_t areaLayer = 0;
+  static const size_t wayLayer  = 1;
+  static const size_t nodeLayer = 2;
+
+  static void AppendVarint(std::string& buffer,
+                           uint64_t value)
+  {
+    char         data[10];
+    unsigned int bytes=EncodeNumberUnsigned(value,data);
+
+    buffer.append(data,bytes);
+  }
+
+  static void AppendKey(std::string& buffer,
+                        uint32_t field,
+                        uint32_t wireType)
+  {
+    AppendVarint(buffer,(field << 3) | wireType);
+  }
+
+  static void AppendBytes(std::string& buffer,
+                          uint32_t field,
+                          const std::string& data)
+  {
+    AppendKey(buffer,field,wireTypeBytes);
+    AppendVarint(buffer,data.length());
+    buffer.append(data);
+  }
+
+  static void AppendPacked(std::string& buffer,
+                           uint32_t field,
+                           const std::vector<uint32_t>& values)
+  {
+    std::string packed;
+
+    for (std::vector<uint32_t>::const_iterator value=values.begin();
+         value!=values.end();
+         ++value) {
+      AppendVarint(packed,*value);
+    }
+
+    AppendBytes(buffer,field,packed);
+  }
+
+  static inline uint32_t ZigZag(int32_t value)
+  {
+    return ((uint32_t)value << 1) ^ (uint32_t)(value >> 31);
+  }
+
+  static inline uint32_t Command(uint32_t id,
+                                 uint32_t count)
+  {
+    return (id & 0x7) | (count << 3);
+  }
+
+  /**
+    Area of the polygon by the surveyor's formula, positive for rings
+    that are clockwise in tile coordinates
+    */
+  static int64_t GetSignedArea(const VectorTileEncoder::TilePath& path)
+  {
+    int64_t area=0;
+
+    for (size_t i=0; i<path.size(); i++) {
+      size_t j=(i+1)%path.size();
+
+      area+=(int64_t)path[i].x*path[j].y-(int64_t)path[j].x*path[i].y;
+    }
+
+    return area;
+  }
+
+  VectorTileEncoder::VectorTileEncoder(size_t extent)
+  : extent(extent)
+  {
+    // no code
+  }
+
+  uint32_t VectorTileEncoder::GetIndex(const std::string& entry,
+                                       std::vector<std::string>& entries,
+                                       std::map<std::string,uint32_t>& index)
+  {
+    std::map<std::string,uint32_t>::const_iterator existing=index.find(entry);
+
+    if (existing!=index.end()) {
+      return existing->second;
+    }
+
+    uint32_t newIndex=(uint32_t)entries.size();
+
+    entries.push_back(entry);
+    index.insert(std::make_pair(entry,newIndex));
+
+    return newIndex;
+  }
+
+  void VectorTileEncoder::AddPath(const TilePath& path,
+                                  bool closed,
+                                  bool reverse,
+                                  int32_t& cursorX,
+                                  int32_t& cursorY)
+  {
+    size_t count=path.size();
+
+    for (size_t i=0; i<count; i++) {
+      const TilePoint& point=path[reverse ? count-1-i : i];
+
+      if (i==0) {
+        geometry.push_back(Command(commandMoveTo,1));
+      }
+      else if (i==1) {
+        geometry.push_back(Command(commandLineTo,(uint32_t)(count-1)));
+      }
+
+      geometry.push_back(ZigZag(point.x-cursorX));
+      geometry.push_back(ZigZag(point.y-cursorY));
+
+      cursorX=point.x;
+      cursorY=point.y;
+    }
+
+    if (closed) {
+      geometry.push_back(Command(commandClosePath,1));
+    }
+  }
+
+  size_t VectorTileEncoder::GetExtent() const
+  {
+    return extent;
+  }
+
+  /**
+    Remove all layers
+    */
+  void VectorTileEncoder::Clear()
+  {
+    layers.clear();
+  }
+
+  /**
+    Add a new layer and return its index
+    */
+  size_t VectorTileEncoder::AddLayer(const std::string& name)
+  {
+    Layer layer;
+
+    layer.name=name;
+    layer.featureCount=0;
+
+    layers.push_back(layer);
+
+    return layers.size()-1;
+  }
+
+  /**
+    Add a feature to the given layer. Points and line strings may consist of
+    multiple paths. For polygons the first path is the outer ring, all other
+    paths are holes, rings must not repeat their first point at the end. The
+    winding order required by the format is established by the encoder.
+    */
+  void VectorTileEncoder::AddFeature(size_t layer,
+                                     GeometryType type,
+                                     uint64_t id,
+                                     const std::vector<Property>& properties,
+                                     const std::vector<TilePath>& paths)
+  {
+    assert(layer<layers.size());
+
+    Layer&  l=layers[layer];
+    int32_t cursorX=0;
+    int32_t cursorY=0;
+
+    tags.clear();
+    geometry.clear();
+
+    for (std::vector<Property>::const_iterator property=properties.begin();
+         property!=properties.end();
+         ++property) {
+      tags.push_back(GetIndex(property->first,l.keys,l.keyIndex));
+      tags.push_back(GetIndex(property->second,l.values,l.valueIndex));
+    }
+
+    for (size_t i=0; i<paths.size(); i++) {
+      if (type==polygon) {
+        int64_t area=GetSignedArea(paths[i]);
+
+        // Outer rings are clockwise, holes counter clockwise
+        AddPath(paths[i],
+                true,
+                i==0 ? area<0 : area>0,
+                cursorX,
+                cursorY);
+      }
+      else {
+        AddPath(paths[i],
+                false,
+                false,
+                cursorX,
+                cursorY);
+      }
+    }
+
+    std::string feature;
+
+    AppendKey(feature,1,wireTypeVarint);
+    AppendVarint(feature,id);
+
+    if (!tags.empty()) {
+      AppendPacked(feature,2,tags);
+    }
+
+    AppendKey(feature,3,wireTypeVarint);
+    AppendVarint(feature,type);
+
+    AppendPacked(feature,4,geometry);
+
+    AppendBytes(l.features,2,feature);
+    l.featureCount++;
+  }
+
+  bool VectorTileEncoder::IsEmpty() const
+  {
+    for (std::vector<Layer>::const_iterator layer=layers.begin();
+         layer!=layers.end();
+         ++layer) {
+      if (layer->featureCount>0) {
+        return false;
+      }
+    }
+
+    return true;
+  }
+
+  /**
+    Write the tile message, layers without features are skipped
+    */
+  void VectorTileEncoder::Encode(std::string& tile) const
+  {
+    tile.clear();
+
+    for (std::vector<Layer>::const_iterator layer=layers.begin();
+         layer!=layers.end();
+         ++layer) {
+      if (layer->featureCount==0) {
+        continue;
+      }
+
+      std::string data;
+
+      AppendKey(data,15,wireTypeVarint);
+      AppendVarint(data,2);
+
+      AppendBytes(data,1,layer->name);
+
+      data.append(layer->features);
+
+      for (std::vector<std::string>::const_iterator key=layer->keys.begin();
+           key!=layer->keys.end();
+           ++key) {
+        AppendBytes(data,3,*key);
+      }
+
+      for (std::vector<std::string>::const_iterator value=layer->values.begin();
+           value!=layer->values.end();
+           ++value) {
+        AppendBytes(data,4,*value);
+      }
+
+      AppendKey(data,5,wireTypeVarint);
+      AppendVarint(data,extent);
+
+      AppendBytes(tile,3,data);
+    }
+  }
+
+  std::string VectorTileEncoder::EncodeStringValue(const std::string& value)
+  {
+    std::string result;
+
+    AppendBytes(result,1,value);
+
+    return result;
+  }
+
+  std::string VectorTileEncoder::EncodeIntValue(int64_t value)
+  {
+    std::string result;
+
+    AppendKey(result,6,wireTypeVarint);
+    AppendVarint(result,((uint64_t)value << 1) ^ (uint64_t)(value >> 63));
+
+    return result;
+  }
+
+  std::string VectorTileEncoder::EncodeBoolValue(bool value)
+  {
+    std::string result;
+
+    AppendKey(result,7,wireTypeVarint);
+    AppendVarint(result,value ? 1 : 0);
+
+    return result;
+  }
+
+  /**
+    Liang-Barsky line clipping, returns false if the segment is completely
+    outside, else the visible part of the segment in t0 and t1
+    */
+  static bool ClipSegment(const Vertex2D& a,
+                          const Vertex2D& b,
+                          double xMin,
+                          double yMin,
+                          double xMax,
+                          double yMax,
+                          double& t0,
+                          double& t1)
+  {
+    double dx=b.GetX()-a.GetX();
+    double dy=b.GetY()-a.GetY();
+    double p[4]={-dx,dx,-dy,dy};
+    double q[4]={a.GetX()-xMin,xMax-a.GetX(),a.GetY()-yMin,yMax-a.GetY()};
+
+    t0=0.0;
+    t1=1.0;
+
+    for (size_t i=0; i<4; i++) {
+      if (p[i]==0.0) {
+        if (q[i]<0.0) {
+          return false;
+        }
+      }
+      else {
+        double r=q[i]/p[i];
+
+        if (p[i]<0.0) {
+          if (r>t1) {
+            return false;
+          }
+
+          t0=std::max(t0,r);
+        }
+        else {
+          if (r<t0) {
+            return false;
+          }
+
+          t1=std::min(t1,r);
+        }
+      }
+    }
+
+    return true;
+  }
+
+  /**
+    One step of the Sutherland-Hodgman polygon clipping, clips the polygon
+    against the given edge (0: left, 1: right, 2: top, 3: bottom)
+    */
+  static void ClipPolygonEdge(const std::vector<Vertex2D>& in,
+                              size_t edge,
+                              double value,
+                              std::vector<Vertex2D>& out)
+  {
+    out.clear();
+
+    if (in.empty()) {
+      return;
+    }
+
+    for (size_t i=0; i<in.size(); i++) {
+      const Vertex2D& prev=in[i==0 ? in.size()-1 : i-1];
+      const Vertex2D& current=in[i];
+      double          prevCoord=edge<2 ? prev.GetX() : prev.GetY();
+      double          coord=edge<2 ? current.GetX() : current.GetY();
+      bool            prevInside=(edge%2==0) ? prevCoord>=value : prevCoord<=value;
+      bool            inside=(edge%2==0) ? coord>=value : coord<=value;
+
+      if (inside!=prevInside) {
+        double t=(value-prevCoord)/(coord-prevCoord);
+
+        if (edge<2) {
+          out.push_back(Vertex2D(value,
+                                 prev.GetY()+t*(current.GetY()-prev.GetY())));
+        }
+        else {
+          out.push_back(Vertex2D(prev.GetX()+t*(current.GetX()-prev.GetX()),
+                                 value));
+        }
+      }
+
+      if (inside) {
+        out.push_back(current);
+      }
+    }
+  }
+
+  /**
+    Convert the points to tile coordinates, dropping points that fall onto
+    their predecessor
+    */
+  static void QuantizePath(const std::vector<Vertex2D>& points,
+                           size_t start,
+                           size_t end,
+                           double pixelX,
+                           double pixelY,
+                           double scaleX,
+                           double scaleY,
+                           VectorTileEncoder::TilePath& path)
+  {
+    path.clear();
+
+    for (size_t i=start; i<end; i++) {
+      VectorTileEncoder::TilePoint point;
+
+      point.x=(int32_t)floor((points[i].GetX()-pixelX)*scaleX+0.5);
+      point.y=(int32_t)floor((points[i].GetY()-pixelY)*scaleY+0.5);
+
+      if (path.empty() ||
+          path.back().x!=point.x ||
+          path.back().y!=point.y) {
+        path.push_back(point);
+      }
+    }
+  }
+
+  VectorTileRenderer::VectorTileWorker::VectorTileWorker(VectorTileRenderer& renderer)
+  : renderer(renderer),
+    encoder(renderer.GetExtent())
+  {
+    // no code
+  }
+
+  /**
+    Append the current content of the transPolygon as new path of the
+    feature. Returns false and drops the path, if it has less than minPoints
+    points.
+    */
+  bool VectorTileRenderer::VectorTileWorker::AddPath(Feature& feature,
+                                                     size_t minPoints)
+  {
+    size_t start=feature.points.size();
+
+    if (!transPolygon.IsEmpty()) {
+      for (size_t i=transPolygon.GetStart(); i<=transPolygon.GetEnd(); i++) {
+        if (transPolygon.points[i].draw) {
+          feature.points.push_back(Vertex2D(transPolygon.points[i].x,
+                                            transPolygon.points[i].y));
+        }
+      }
+    }
+
+    if (feature.points.size()-start<minPoints) {
+      feature.points.resize(start);
+
+      return false;
+    }
+
+    if (feature.pathStarts.empty()) {
+      feature.xMin=feature.points[start].GetX();
+      feature.xMax=feature.points[start].GetX();
+      feature.yMin=feature.points[start].GetY();
+      feature.yMax=feature.points[start].GetY();
+    }
+
+    for (size_t i=start; i<feature.points.size(); i++) {
+      feature.xMin=std::min(feature.xMin,feature.points[i].GetX());
+      feature.xMax=std::max(feature.xMax,feature.points[i].GetX());
+      feature.yMin=std::min(feature.yMin,feature.points[i].GetY());
+      feature.yMax=std::max(feature.yMax,feature.points[i].GetY());
+    }
+
+    feature.pathStarts.push_back(start);
+
+    return true;
+  }
+
+  void VectorTileRenderer::VectorTileWorker::SetProperties(const TypeConfig& typeConfig,
+                                                           TypeId type,
+                                                           const std::string& name,
+                                                           Feature& feature)
+  {
+    feature.properties.push_back(VectorTileEncoder::Property("type",
+                                                             VectorTileEncoder::EncodeStringValue(typeConfig.GetTypeInfo(type).GetName())));
+
+    if (!name.empty()) {
+      feature.properties.push_back(VectorTileEncoder::Property("name",
+                                                               VectorTileEncoder::EncodeStringValue(name)));
+    }
+  }
+
+  /**
+    Transform and simplify all objects of the meta tile
+    */
+  bool VectorTileRenderer::VectorTileWorker::DrawMetaTile(const StyleConfig& styleConfig,
+                                                          const Projection& projection,
+                                                          const MapParameter& parameter,
+                                                          const MapData& data,
+                                                          size_t /*width*/,
+                                                          size_t /*height*/)
+  {
+    const TypeConfig& typeConfig=*styleConfig.GetTypeConfig();
+    double            margin=(double)renderer.GetBuffer()*std::max(renderer.GetTileWidth(),renderer.GetTileHeight())/renderer.GetExtent();
+
+    features.clear();
+
+    // WriteTile() clips to each tile and its buffer, so everything outside
+    // the meta tile and the buffer does not need to be transformed at all
+    transPolygon.SetClipRegion(projection,
+                               margin+1);
+
+    for (std::vector<AreaRef>::const_iterator a=data.areas.begin();
+         a!=data.areas.end();
+         ++a) {
+      const AreaRef& area=*a;
+
+      for (size_t i=0; i<area->rings.size(); i++) {
+        const Area::Ring& ring=area->rings[i];
+
+        if (ring.ring==Area::masterRingId ||
+            ring.GetType()==typeIgnore) {
+          continue;
+        }
+
+        features.push_back(Feature());
+
+        Feature& feature=features.back();
+
+        feature.layer=areaLayer;
+        feature.type=VectorTileEncoder::polygon;
+        feature.id=area->GetFileOffset();
+
+        transPolygon.TransformArea(projection,
+                                   parameter.GetOptimizeAreaNodes(),
+                                   ring.nodes,
+                                   parameter.GetOptimizeErrorToleranceDots());
+
+        if (!AddPath(feature,3)) {
+          features.pop_back();
+          continue;
+        }
+
+        // Inner rings of the next level without a type are holes
+        size_t j=i+1;
+        while (j<area->rings.size() &&
+               area->rings[j].ring==ring.ring+1 &&
+               area->rings[j].GetType()==typeIgnore) {
+          transPolygon.TransformArea(projection,
+                                     parameter.GetOptimizeAreaNodes(),
+                                     area->rings[j].nodes,
+                                     parameter.GetOptimizeErrorToleranceDots());
+
+          AddPath(feature,3);
+
+          j++;
+        }
+
+        SetProperties(typeConfig,
+                      ring.GetType(),
+                      ring.GetName(),
+                      feature);
+      }
+    }
+
+    for (std::vector<WayRef>::const_iterator w=data.ways.begin();
+         w!=data.ways.end();
+         ++w) {
+      const WayRef& way=*w;
+
+      features.push_back(Feature());
+
+      Feature& feature=features.back();
+
+      feature.layer=wayLayer;
+      feature.type=VectorTileEncoder::lineString;
+      feature.id=way->GetFileOffset();
+
+      transPolygon.TransformWay(projection,
+                                parameter.GetOptimizeWayNodes(),
+                                way->nodes,
+                                parameter.GetOptimizeErrorToleranceDots());
+
+      if (!AddPath(feature,2)) {
+        features.pop_back();
+        continue;
+      }
+
+      SetProperties(typeConfig,
+                    way->GetType(),
+                    way->GetName(),
+                    feature);
+
+      if (!way->GetRefName().empty()) {
+        feature.properties.push_back(VectorTileEncoder::Property("ref",
+                                                                 VectorTileEncoder::EncodeStringValue(way->GetRefName())));
+      }
+
+      if (way->GetLayer()!=0) {
+        feature.properties.push_back(VectorTileEncoder::Property("layer",
+                                                                 VectorTileEncoder::EncodeIntValue(way->GetLayer())));
+      }
+
+      if (way->IsBridge()) {
+        feature.properties.push_back(VectorTileEncoder::Property("bridge",
+                                                                 VectorTileEncoder::EncodeBoolValue(true)));
+      }
+
+      if (way->IsTunnel()) {
+        feature.properties.push_back(VectorTileEncoder::Property("tunnel",
+                                                                 VectorTileEncoder::EncodeBoolValue(true)));
+      }
+    }
+
+    for (std::vector<NodeRef>::const_iterator n=data.nodes.begin();
+         n!=data.nodes.end();
+         ++n) {
+      const NodeRef& node=*n;
+      double         x,y;
+
+      projection.GeoToPixel(node->GetLon(),
+                            node->GetLat(),
+                            x,y);
+
+      features.push_back(Feature());
+
+      Feature& feature=features.back();
+
+      feature.layer=nodeLayer;
+      feature.type=VectorTileEncoder::point;
+      feature.id=node->GetFileOffset();
+      feature.points.push_back(Vertex2D(x,y));
+      feature.pathStarts.push_back(0);
+      feature.xMin=x;
+      feature.xMax=x;
+      feature.yMin=y;
+      feature.yMax=y;
+
+      SetProperties(typeConfig,
+                    node->GetType(),
+                    node->GetAttributes().GetName(),
+                    feature);
+    }
+
+    return true;
+  }
+
+  /**
+    Clip the feature to the given rectangle, convert it to tile coordinates
+    and add it to the encoder, if anything of it is left
+    */
+  void VectorTileRenderer::VectorTileWorker::AddClippedFeature(const Feature& feature,
+                                                               double pixelX,
+                                                               double pixelY,
+                                                               double scaleX,
+                                                               double scaleY,
+                                                               double xMin,
+                                                               double yMin,
+                                                               double xMax,
+                                                               double yMax)
+  {
+    paths.clear();
+
+    for (size_t p=0; p<feature.pathStarts.size(); p++) {
+      size_t start=feature.pathStarts[p];
+      size_t end=p+1<feature.pathStarts.size() ? feature.pathStarts[p+1] : feature.points.size();
+
+      if (feature.type==VectorTileEncoder::point) {
+        const Vertex2D& point=feature.points[start];
+
+        if (point.GetX()>=xMin && point.GetX()<=xMax &&
+            point.GetY()>=yMin && point.GetY()<=yMax) {
+          paths.push_back(VectorTileEncoder::TilePath());
+          QuantizePath(feature.points,start,end,pixelX,pixelY,scaleX,scaleY,paths.back());
+        }
+      }
+      else if (feature.type==VectorTileEncoder::lineString) {
+        bool open=false;
+
+        clipped.clear();
+        partStarts.clear();
+
+        for (size_t i=start; i+1<end; i++) {
+          const Vertex2D& a=feature.points[i];
+          const Vertex2D& b=feature.points[i+1];
+          double          t0,t1;
+
+          if (!ClipSegment(a,b,xMin,yMin,xMax,yMax,t0,t1)) {
+            open=false;
+            continue;
+          }
+
+          if (!open) {
+            partStarts.push_back(clipped.size());
+            clipped.push_back(Vertex2D(a.GetX()+t0*(b.GetX()-a.GetX()),
+                                       a.GetY()+t0*(b.GetY()-a.GetY())));
+            open=true;
+          }
+
+          clipped.push_back(Vertex2D(a.GetX()+t1*(b.GetX()-a.GetX()),
+                                     a.GetY()+t1*(b.GetY()-a.GetY())));
+
+          // The segment leaves the rectangle
+          if (t1<1.0) {
+            open=false;
+          }
+        }
+
+        for (size_t i=0; i<partStarts.size(); i++) {
+          size_t partEnd=i+1<partStarts.size() ? partStarts[i+1] : clipped.size();
+
+          paths.push_back(VectorTileEncoder::TilePath());
+          QuantizePath(clipped,partStarts[i],partEnd,pixelX,pixelY,scaleX,scaleY,paths.back());
+
+          if (paths.back().size()<2) {
+            paths.pop_back();
+          }
+        }
+      }
+      else {
+        clipped.assign(feature.points.begin()+start,
+                       feature.points.begin()+end);
+
+        ClipPolygonEdge(clipped,0,xMin,clipBuffer);
+        ClipPolygonEdge(clipBuffer,1,xMax,clipped);
+        ClipPolygonEdge(clipped,2,yMin,clipBuffer);
+        ClipPolygonEdge(clipBuffer,3,yMax,clipped);
+
+        paths.push_back(VectorTileEncoder::TilePath());
+        QuantizePath(clipped,0,clipped.size(),pixelX,pixelY,scaleX,scaleY,paths.back());
+
+        VectorTileEncoder::TilePath& path=paths.back();
+
+        if (path.size()>1 &&
+            path.front().x==path.back().x &&
+            path.front().y==path.back().y) {
+          path.pop_back();
+        }
+
+        if (path.size()<3 ||
+            GetSignedArea(path)==0) {
+          paths.pop_back();
+
+          // Without its outer ring, the holes are irrelevant
+          if (p==0) {
+            return;
+          }
+        }
+      }
+    }
+
+    if (paths.empty()) {
+      return;
+    }
+
+    encoder.AddFeature(feature.layer,
+                       feature.type,
+                       feature.id,
+                       feature.properties,
+                       paths);
+  }
+
+  /**
+    Clip the objects of the meta tile to the tile and its buffer and write the
+    resulting vector tile
+    */
+  bool VectorTileRenderer::VectorTileWorker::WriteTile(size_t zoom,
+                                                       size_t x,
+                                                       size_t y,
+                                                       size_t pixelX,
+                                                       size_t pixelY,
+                                                       size_t width,
+                                                       size_t height)
+  {
+    double extent=(double)renderer.GetExtent();
+    double scaleX=extent/width;
+    double scaleY=extent/height;
+    double xMin=pixelX-renderer.GetBuffer()/scaleX;
+    double xMax=pixelX+width+renderer.GetBuffer()/scaleX;
+    double yMin=pixelY-renderer.GetBuffer()/scaleY;
+    double yMax=pixelY+height+renderer.GetBuffer()/scaleY;
+
+    encoder.Clear();
+    encoder.AddLayer("areas");
+    encoder.AddLayer("ways");
+    encoder.AddLayer("nodes");
+
+    for (std::vector<Feature>::const_iterator feature=features.begin();
+         feature!=features.end();
+         ++feature) {
+      if (feature->xMax<xMin ||
+          feature->xMin>xMax ||
+          feature->yMax<yMin ||
+          feature->yMin>yMax) {
+        continue;
+      }
+
+      AddClippedFeature(*feature,
+                        pixelX,
+                        pixelY,
+                        scaleX,
+                        scaleY,
+                        xMin,
+                        yMin,
+                        xMax,
+                        yMax);
+    }
+
+    encoder.Encode(tile);
+
+    return renderer.StoreTile(zoom,
+                              x,
+                              y,
+                              tile);
+  }
+
+  VectorTileRenderer::VectorTileRenderer(const Database& database,
+                                         const StyleConfig& styleConfig)
+  : TileRenderer(database,styleConfig),
+    extent(4096),
+    buffer(64),
+    targetTile(NULL),
+    byteCount(0)
+  {
+    // no code
+  }
+
+  TileRenderer::Worker* VectorTileRenderer::CreateWorker()
+  {
+    return new VectorTileWorker(*this);
+  }
+
+  /**
+    Write the tile to its file in the target directory or to the target of
+    GetTile()
+    */
+  bool VectorTileRenderer::StoreTile(size_t zoom,
+                                     size_t x,
+                                     size_t y,
+                                     const std::string& tile)
+  {
+    if (targetTile!=NULL) {
+      *targetTile=tile;
+
+      return true;
+    }
+
+    std::string zoomDirectory=AppendFileToDir(directory,NumberToString(zoom));
+    std::string xDirectory=AppendFileToDir(zoomDirectory,NumberToString(x));
+
+    if (!MakeDirectory(zoomDirectory) ||
+        !MakeDirectory(xDirectory)) {
+      std::cerr << "Cannot create directory '" << xDirectory << "'" << std::endl;
+      return false;
+    }
+
+    std::string filename=AppendFileToDir(xDirectory,NumberToString(y)+".pbf");
+    FILE*       file=fopen(filename.c_str(),"wb");
+
+    if (file==NULL) {
+      std::cerr << "Cannot open file '" << filename << "'" << std::endl;
+      return false;
+    }
+
+    bool success=fwrite(tile.data(),1,tile.length(),file)==tile.length();
+
+    if (fclose(file)!=0) {
+      success=false;
+    }
+
+    if (!success) {
+      std::cerr << "Cannot write file '" << filename << "'" << std::endl;
+      return false;
+    }
+
+    MutexLocker locker(mutex);
+
+    byteCount+=tile.length();
+
+    return true;
+  }
+
+  /**
+    Write the metadata.json file describing the tile set, containing the
+    fields of the MBTiles metadata table
+    */
+  bool VectorTileRenderer::WriteMetadata(double lonMin, double latMin,
+                                         double lonMax, double latMax,
+                                         size_t startZoom,
+                                         size_t endZoom) const
+  {
+    std::string   filename=AppendFileToDir(directory,"metadata.json");
+    std::ofstream file(filename.c_str());
+
+    file << std::fixed << std::setprecision(6);
+
+    file << "{" << std::endl;
+    file << "  \"name\": \"libosmscout\"," << std::endl;
+    file << "  \"format\": \"pbf\"," << std::endl;
+    file << "  \"type\": \"baselayer\"," << std::endl;
+    file << "  \"version\": \"2\"," << std::endl;
+    file << "  \"minzoom\": \"" << std::min(startZoom,endZoom) << "\"," << std::endl;
+    file << "  \"maxzoom\": \"" << std::max(startZoom,endZoom) << "\"," << std::endl;
+    file << "  \"bounds\": \"" << lonMin << "," << latMin << "," << lonMax << "," << latMax << "\"," << std::endl;
+    file << "  \"center\": \"" << (lonMin+lonMax)/2 << "," << (latMin+latMax)/2 << "," << std::min(startZoom,endZoom) << "\"," << std::endl;
+    file << "  \"vector_layers\": [" << std::endl;
+    file << "    { \"id\": \"areas\", \"fields\": { \"type\": \"String\", \"name\": \"String\" } }," << std::endl;
+    file << "    { \"id\": \"ways\", \"fields\": { \"type\": \"String\", \"name\": \"String\", \"ref\": \"String\", \"layer\": \"Number\", \"bridge\": \"Boolean\", \"tunnel\": \"Boolean\" } }," << std::endl;
+    file << "    { \"id\": \"nodes\", \"fields\": { \"type\": \"String\", \"name\": \"String\" } }" << std::endl;
+    file << "  ]" << std::endl;
+    file << "}" << std::endl;
+
+    file.close();
+
+    if (file.fail()) {
+      std::cerr << "Cannot write file '" << filename << "'" << std::endl;
+      return false;
+    }
+
+    return true;
+  }
+
+  /**
+    Set the size of the tile coordinate system (default 4096)
+    */
+  void VectorTileRenderer::SetExtent(size_t extent)
+  {
+    this->extent=std::max((size_t)1,extent);
+  }
+
+  /**
+    Set the size of the border around each tile that is included in the
+    tile, in tile coordinates (default 64)
+    */
+  void VectorTileRenderer::SetBuffer(size_t buffer)
+  {
+    this->buffer=buffer;
+  }
+
+  size_t VectorTileRenderer::GetExtent() const
+  {
+    return extent;
+  }
+
+  size_t VectorTileRenderer::GetBuffer() const
+  {
+    return buffer;
+  }
+
+  size_t VectorTileRenderer::GetByteCount() const
+  {
+    return byteCount;
+  }
+
+  /**
+    Write all tiles of the zoom levels startZoom to endZoom (inclusive)
+    intersecting the given bounding box to the given directory.
+    */
+  bool VectorTileRenderer::Export(const MapParameter& parameter,
+                                  const AreaSearchParameter& searchParameter,
+                                  double lonMin, double latMin,
+                                  double lonMax, double latMax,
+                                  size_t startZoom,
+                                  size_t endZoom,
+                                  const std::string& directory)
+  {
+    if (!MakeDirectory(directory)) {
+      std::cerr << "Cannot create directory '" << directory << "'" << std::endl;
+      return false;
+    }
+
+    this->directory=directory;
+    byteCount=0;
+
+    if (!Render(parameter,
+                searchParameter,
+                lonMin,latMin,
+                lonMax,latMax,
+                startZoom,
+                endZoom)) {
+      return false;
+    }
+
+    return WriteMetadata(std::min(lonMin,lonMax),
+                         std::min(latMin,latMax),
+                         std::max(lonMin,lonMax),
+                         std::max(latMin,latMax),
+                         startZoom,
+                         endZoom);
+  }
+
+  /**
+    Produce the single tile x,y of the given zoom level, for example for
+    serving tiles on request. Tiles are produced in the calling thread,
+    calls must not overlap with other calls of GetTile() or Export().
+    */
+  bool VectorTileRenderer::GetTile(const MapParameter& parameter,
+                                   const AreaSearchParameter& searchParameter,
+                                   size_t zoom,
+                                   size_t x,
+                                   size_t y,
+                                   std::string& tile)
+  {
+    // The center of the tile selects exactly this tile
+    double lon=(TiledObjects::GetTileLon(x,zoom)+TiledObjects::GetTileLon(x+1,zoom))/2;
+    double lat=(TiledObjects::GetTileLat(y,zoom)+TiledObjects::GetTileLat(y+1,zoom))/2;
+
+    tile.clear();
+    targetTile=&tile;
+
+    bool success=Render(parameter,
+                        searchParameter,
+                        lon,lat,
+                        lon,lat,
+                        zoom,
+                        zoom);
+
+    targetTile=NULL;
+
+    return success &&
+           GetTileCount()==1;
+  }
+}
@@ -64,6 +64,8 @@ namespace osmscout {
                uint8_t flags) const;
 
     friend class Area;
+    friend class AreaRingView;
+    friend class AreaView;
 
   public:
     inline AreaAttributes()
@@ -116,6 +118,8 @@ namespace osmscout {
                  const TypeConfig& typeConfig,
                  std::vector<Tag>& tags);
 
+    unsigned long GetMemorySize() const;
+
     bool operator==(const AreaAttributes& other) const;
     bool operator!=(const AreaAttributes& other) const;
   };
@@ -216,6 +220,8 @@ namespace osmscout {
                         double& minLat,
                         double& maxLat) const;
 
+    unsigned long GetMemorySize() const;
+
     bool ReadIds(FileScanner& scanner,
                  uint32_t nodesCount,
                  std::vector<Id>& ids);
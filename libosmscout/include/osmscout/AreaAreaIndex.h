@@ -26,6 +26,9 @@
 
 #include <osmscout/util/Cache.h>
 #include <osmscout/util/FileScanner.h>
+#include <osmscout/util/FileScannerPool.h>
+#include <osmscout/util/Mutex.h>
+#include <osmscout/util/Reference.h>
 
 namespace osmscout {
 
@@ -40,6 +43,9 @@ namespace osmscout {
 
     Internally the index is implemented as quadtree. As a result each index entry
     has 4 children (besides entries in the lowest level).
+
+    The index can be queried from multiple threads at the same time, the cache
+    of index cells is shared between all threads.
     */
   class OSMSCOUT_API AreaAreaIndex
   {
@@ -56,24 +62,27 @@ namespace osmscout {
     /**
       Datastructure for every index cell of our index.
       */
-    struct IndexCell
+    struct IndexCell : public Referencable
     {
       FileOffset              children[4]; //! File index of each of the four children, or 0 if there is no child
       std::vector<IndexEntry> areas;
     };
 
-    typedef Cache<FileOffset,IndexCell> IndexCache;
+    typedef Ref<IndexCell> IndexCellRef;
+
+    typedef Cache<FileOffset,IndexCellRef> IndexCache;
 
     struct IndexCacheValueSizer : public IndexCache::ValueSizer
     {
-      unsigned long GetSize(const IndexCell& value) const
+      unsigned long GetSize(const IndexCellRef& value) const
       {
         unsigned long memory=0;
 
         memory+=sizeof(value);
+        memory+=sizeof(IndexCell);
 
         // Areas
-        memory+=value.areas.size()*sizeof(IndexEntry);
+        memory+=value->areas.size()*sizeof(IndexEntry);
 
         return memory;
       }
@@ -99,19 +108,21 @@ namespace osmscout {
   private:
     std::string                     filepart;       //! name of the data file
     std::string                     datafilename;   //! Fullpath and name of the data file
-    mutable FileScanner             scanner;        //! Scanner instance for reading this file
+    mutable FileScannerPool         scannerPool;    //! Scanner instances for reading this file
 
     std::vector<double>             cellWidth;      //! Precalculated cellWidth for each level of the quadtree
     std::vector<double>             cellHeight;     //! Precalculated cellHeight for each level of the quadtree
     uint32_t                        maxLevel;       //! Maximum level in index
     FileOffset                      topLevelOffset; //! File offset of the top level index entry
 
+    mutable Mutex                   cacheMutex;     //! Guards access to the index cache
     mutable IndexCache              indexCache;     //! Cached map of all index entries by file offset
 
   private:
-    bool GetIndexCell(uint32_t level,
+    bool GetIndexCell(FileScanner& scanner,
+                      uint32_t level,
                       FileOffset offset,
-                      IndexCache::CacheRef& cacheRef) const;
+                      IndexCellRef& cell) const;
 
   public:
     AreaAreaIndex(size_t cacheSize);
@@ -25,6 +25,7 @@
 #include <osmscout/TypeSet.h>
 
 #include <osmscout/util/FileScanner.h>
+#include <osmscout/util/FileScannerPool.h>
 
 namespace osmscout {
 
@@ -63,14 +64,15 @@ namespace osmscout {
     };
 
   private:
-    std::string           filepart;       //! name of the data file
-    std::string           datafilename;   //! Full path and name of the data file
-    mutable FileScanner   scanner;        //! Scanner instance for reading this file
+    std::string             filepart;       //! name of the data file
+    std::string             datafilename;   //! Full path and name of the data file
+    mutable FileScannerPool scannerPool;    //! Scanner instances for reading this file
 
-    std::vector<TypeData> nodeTypeData;
+    std::vector<TypeData>   nodeTypeData;
 
   private:
-    bool GetOffsets(const TypeData& typeData,
+    bool GetOffsets(FileScanner& scanner,
+                    const TypeData& typeData,
                     double minlon,
                     double minlat,
                     double maxlon,
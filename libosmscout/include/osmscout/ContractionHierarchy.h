@@ -0,0 +1,160 @@
+#ifndef OSMSCOUT_CONTRACTIONHIERARCHY_H
+#define OSMSCOUT_CONTRACTIONHIERARCHY_H
+
+/*
+  This source is part of the libosmscout library
+  Copyright (C) 2013  Tim Teulings
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+#include <string>
+#include <vector>
+
+#include <osmscout/Types.h>
+#include <osmscout/RoutingProfile.h>
+
+#include <osmscout/private/CoreImportExport.h>
+
+#include <osmscout/util/HashMap.h>
+
+namespace osmscout {
+
+  /**
+    A contraction hierarchy over the route nodes of one routing graph
+    (e.g. 'routecar.dat').
+
+    Nodes are identified by a dense index (in the order of the routing graph
+    file), the file offset of the route node is stored for each node. The level
+    of a node in the hierarchy is the position in which it was contracted.
+    For each node we store
+
+    * the forward edges: edges starting at this node and leading to a node
+      with a higher level,
+    * the backward edges: edges ending at this node and coming from a node
+      with a higher level (target is the source node of the edge).
+
+    An edge is either an original path of the routing graph (middle is noNode,
+    pathIndex is the index of the path in the source route node) or a shortcut
+    over the node middle. A shortcut from a to b over m can be unpacked by
+    looking up the backward edge of m coming from a and the forward edge of
+    m leading to b.
+
+    Costs are stored as integers (the costs of the routing profile multiplied
+    by the cost scale), so that the costs of shortcuts are exact.
+
+    The costs are only valid for the routing profile used during import, so
+    its vehicle and speeds are stored, too (see IsCompatible()).
+    */
+  class OSMSCOUT_API ContractionHierarchy
+  {
+  public:
+    static const uint32_t noNode;
+
+    struct OSMSCOUT_API Edge
+    {
+      uint64_t costs;     //! Costs of the edge multiplied by the cost scale
+      uint32_t target;    //! Index of the node at the other end of the edge
+      uint32_t middle;    //! Index of the node skipped by a shortcut, else noNode
+      uint32_t pathIndex; //! Index of the path in the source route node, if not a shortcut
+
+      inline bool IsShortcut() const
+      {
+        return middle!=noNode;
+      }
+    };
+
+  private:
+    typedef OSMSCOUT_HASHMAP<FileOffset,uint32_t> NodeIndexMap;
+
+  private:
+    uint32_t                costScale;      //! Multiplier for the costs of the routing profile
+    uint8_t                 vehicle;        //! Vehicle of the routing profile
+    uint32_t                vehicleMaxSpeed;//! Maximum speed of the vehicle in 1/1000 km/h
+    std::vector<uint32_t>   speeds;         //! Speed by type id in 1/1000 km/h
+    std::vector<FileOffset> nodes;          //! File offset of the route node by index
+    std::vector<uint32_t>   forwardStart;   //! Index of the first forward edge by node index (+1 entry)
+    std::vector<uint32_t>   backwardStart;  //! Index of the first backward edge by node index (+1 entry)
+    std::vector<Edge>       forwardEdges;
+    std::vector<Edge>       backwardEdges;
+    NodeIndexMap            nodeIndexMap;
+
+  public:
+    ContractionHierarchy();
+
+    void Clear();
+
+    inline bool IsEmpty() const
+    {
+      return nodes.empty();
+    }
+
+    inline uint32_t GetCostScale() const
+    {
+      return costScale;
+    }
+
+    inline size_t GetNodeCount() const
+    {
+      return nodes.size();
+    }
+
+    inline FileOffset GetNodeOffset(uint32_t node) const
+    {
+      return nodes[node];
+    }
+
+    bool GetNodeIndex(FileOffset offset,
+                      uint32_t& node) const;
+
+    inline std::vector<Edge>::const_iterator GetForwardEdgesBegin(uint32_t node) const
+    {
+      return forwardEdges.begin()+forwardStart[node];
+    }
+
+    inline std::vector<Edge>::const_iterator GetForwardEdgesEnd(uint32_t node) const
+    {
+      return forwardEdges.begin()+forwardStart[node+1];
+    }
+
+    inline std::vector<Edge>::const_iterator GetBackwardEdgesBegin(uint32_t node) const
+    {
+      return backwardEdges.begin()+backwardStart[node];
+    }
+
+    inline std::vector<Edge>::const_iterator GetBackwardEdgesEnd(uint32_t node) const
+    {
+      return backwardEdges.begin()+backwardStart[node+1];
+    }
+
+    inline size_t GetEdgeCount() const
+    {
+      return forwardEdges.size()+backwardEdges.size();
+    }
+
+    void SetCostScale(uint32_t costScale);
+    void SetProfile(const AbstractRoutingProfile& profile);
+    bool IsCompatible(const RoutingProfile& profile) const;
+
+    void AddNode(FileOffset offset,
+                 const std::vector<Edge>& forward,
+                 const std::vector<Edge>& backward);
+
+    bool Read(const std::string& filename);
+    bool Write(const std::string& filename) const;
+  };
+}
+
+#endif
@@ -33,8 +33,39 @@
 
 namespace osmscout {
 
+  /**
+    Access to the coordinates of all OSM nodes (coord.dat), as written by
+    the Preprocess step of the import.
+
+    The file exists in two formats, the format is detected while opening
+    the file:
+
+    * Pages: The id space is divided into pages of coordPageSize ids. Each
+      page stores a fixed size entry of 8 bytes for every id, missing ids are
+      marked by 0xffffffff. Only pages containing at least one node are
+      stored, a map of page offsets is stored at the end of the file.
+    * Compressed blocks: The coordinates are stored in the order of
+      increasing ids in blocks of blockSize entries. Within a block ids are
+      stored as the difference to the previous id and latitude and longitude
+      as the difference to the previous value, all encoded as variable length
+      numbers. A directory of the first id and the file offset of each
+      block is stored at the end of the file. This format only contains the
+      nodes actually existing and is thus much smaller for sparse ids.
+      Older versions cannot read it, so the import only writes it if
+      requested using ImportParameter::SetCoordDataCompressed().
+
+    Lookups are cheapest if the ids are sorted, since pages resp. blocks are
+    then read in the order of the file.
+    */
   class OSMSCOUT_API CoordDataFile
   {
+  public:
+    /**
+      Value of the first field of the file in the compressed block format
+      (instead of the page size)
+      */
+    static const uint32_t compressedFormatMarker=0;
+
   private:
     typedef OSMSCOUT_HASHMAP<PageId,FileOffset> CoordPageOffsetMap;
 
@@ -55,12 +86,33 @@ namespace osmscout {
     typedef OSMSCOUT_HASHMAP<OSMId,CoordEntry> CoordResultMap;
 
   private:
-    bool                isOpen;             //! If true,the data file is opened
-    std::string         datafile;           //! Basename part of the data file name
-    std::string         datafilename;       //! complete filename for data file
-    mutable FileScanner scanner;            //! File stream to the data file
-    uint32_t            coordPageSize;
-    CoordPageOffsetMap  coordPageOffsetMap;
+    bool                    isOpen;         //! If true,the data file is opened
+    std::string             datafile;       //! Basename part of the data file name
+    std::string             datafilename;   //! complete filename for data file
+    mutable FileScanner     scanner;        //! File stream to the data file
+    uint32_t                coordPageSize;
+    CoordPageOffsetMap      coordPageOffsetMap;
+
+    bool                    compressed;     //! The file uses the compressed block format
+    uint32_t                blockSize;      //! Number of entries in a block
+    uint32_t                coordCount;     //! Number of entries in all blocks
+    std::vector<OSMId>      blockIds;       //! Id of the first entry of each block
+    std::vector<FileOffset> blockOffsets;   //! Offset of each block (plus the offset of the directory)
+
+  private:
+    bool ReadPageIndex();
+    bool ReadBlockDirectory();
+    bool ReadBlock(size_t block,
+                   std::vector<char>& buffer,
+                   std::vector<OSMId>& ids,
+                   std::vector<uint32_t>& lats,
+                   std::vector<uint32_t>& lons) const;
+    bool GetFromPages(const std::vector<OSMId>& ids,
+                      std::vector<Point>& coords,
+                      std::vector<bool>& found) const;
+    bool GetFromBlocks(const std::vector<OSMId>& ids,
+                       std::vector<Point>& coords,
+                       std::vector<bool>& found) const;
 
   public:
     CoordDataFile(const std::string& datafile);
@@ -73,6 +125,9 @@ namespace osmscout {
 
     bool Get(std::set<OSMId>& ids,
              CoordResultMap& coordsMap) const;
+    bool Get(const std::vector<OSMId>& ids,
+             std::vector<Point>& coords,
+             std::vector<bool>& found) const;
   };
 }
 
@@ -25,12 +25,27 @@
 
 #include <osmscout/NumericIndex.h>
 
-#include <osmscout/util/Cache.h>
 #include <osmscout/util/FileScanner.h>
+#include <osmscout/util/FileScannerPool.h>
+#include <osmscout/util/ObjectCache.h>
 #include <osmscout/util/Reference.h>
 
 namespace osmscout {
 
+  /**
+    Access to a file containing objects of type N, addressed by their file offset.
+
+    DataFile can be used from multiple threads at the same time. Each reading thread
+    gets its own FileScanner from an internal pool, the object cache is shared
+    between all threads.
+
+    The size of the object cache is given in bytes, the memory used by an object
+    is taken from its GetMemorySize() method.
+
+    If the data file is memory mapped, GetViewsByOffset() returns read-only views
+    (see ObjectView.h) pointing directly into the mapped file instead of
+    copies of the objects. Views are neither cached nor do they pass the cache.
+    */
   template <class N>
   class DataFile
   {
@@ -38,30 +53,26 @@ namespace osmscout {
     typedef Ref<N> ValueType;
 
   private:
-    typedef Cache<FileOffset,ValueType> DataCache;
-
-    struct DataCacheValueSizer : public DataCache::ValueSizer
-    {
-      unsigned long GetSize(const ValueType& value) const
-      {
-        return sizeof(value);
-      }
-    };
+    typedef ObjectCache<FileOffset,ValueType> DataCache;
 
   private:
-    std::string         datafile;        //! Basename part fo the data file name
-    std::string         datafilename;    //! complete filename for data file
-    FileScanner::Mode   modeData;        //! Type of file access
-    bool                memoryMapedData; //! Use memory mapped files for data access
-    mutable DataCache   cache;           //! Entry cache
-    mutable FileScanner scanner;         //! File stream to the data file
+    std::string             datafile;        //! Basename part fo the data file name
+    std::string             datafilename;    //! complete filename for data file
+    mutable DataCache       cache;           //! Entry cache, internally synchronized
+    mutable FileScannerPool scannerPool;     //! File streams to the data file, one per reading thread
+    FileScanner             viewScanner;     //! Memory mapping of the data file views point into
 
   protected:
-    bool                isOpen;          //! If true,the data file is opened
+    bool                    isOpen;          //! If true,the data file is opened
+
+  private:
+    bool ReadData(FileScanner& scanner,
+                  const FileOffset& offset,
+                  ValueType& entry) const;
 
   public:
     DataFile(const std::string& datafile,
-             unsigned long dataCacheSize);
+             unsigned long dataCacheMemory);
 
     virtual ~DataFile();
 
@@ -83,17 +94,19 @@ namespace osmscout {
     bool GetByOffset(const FileOffset& offset,
                      ValueType& entry) const;
 
+    template<class V>
+    bool GetViewsByOffset(const std::vector<FileOffset>& offsets,
+                          std::vector<V>& views) const;
+
     void FlushCache();
     void DumpStatistics() const;
   };
 
   template <class N>
   DataFile<N>::DataFile(const std::string& datafile,
-                        unsigned long dataCacheSize)
+                        unsigned long dataCacheMemory)
   : datafile(datafile),
-    modeData(FileScanner::LowMemRandom),
-    memoryMapedData(false),
-    cache(dataCacheSize),
+    cache(dataCacheMemory),
     isOpen(false)
 
   {
@@ -115,10 +128,15 @@ namespace osmscout {
   {
     datafilename=AppendFileToDir(path,datafile);
 
-    this->memoryMapedData=memoryMapedData;
-    this->modeData=modeData;
+    isOpen=scannerPool.Open(datafilename,modeData,memoryMapedData);
 
-    isOpen=scanner.Open(datafilename,modeData,memoryMapedData);
+    if (isOpen && memoryMapedData) {
+      if (!viewScanner.Open(datafilename,modeData,true)) {
+        std::cerr << "Cannot open '" << datafilename << "' for object views!" << std::endl;
+        scannerPool.Close();
+        isOpen=false;
+      }
+    }
 
     return isOpen;
   }
@@ -128,78 +146,83 @@ namespace osmscout {
   {
     bool success=true;
 
-    if (scanner.IsOpen()) {
-      if (!scanner.Close()) {
+    if (scannerPool.IsOpen()) {
+      if (!scannerPool.Close()) {
+        success=false;
+      }
+    }
+
+    if (viewScanner.IsOpen()) {
+      if (!viewScanner.Close()) {
         success=false;
       }
     }
 
     isOpen=false;
-    cache.Flush();
+
+    FlushCache();
 
     return success;
   }
 
+  /**
+    Returns the object at the given offset, either from the cache or by reading
+    it using the given scanner. Newly read objects are added to the cache.
+    */
   template <class N>
-  bool DataFile<N>::GetByOffset(const std::vector<FileOffset>& offsets,
-                                std::vector<ValueType>& data) const
+  bool DataFile<N>::ReadData(FileScanner& scanner,
+                             const FileOffset& offset,
+                             ValueType& entry) const
   {
-    assert(isOpen);
+    if (cache.GetEntry(offset,entry)) {
+      return true;
+    }
 
-    if (!scanner.IsOpen()) {
-      if (!scanner.Open(datafilename,modeData,memoryMapedData)) {
-        std::cerr << "Error while opening " << datafilename << " for reading!" << std::endl;
-        return false;
-      }
+    ValueType value=new N();
+
+    scanner.SetPos(offset);
+    value->Read(scanner);
+
+    if (scanner.HasError()) {
+      std::cerr << "Error while reading data from offset " << offset << " of file " << datafilename << "!" << std::endl;
+      return false;
     }
 
-    data.reserve(data.size()+offsets.size());
+    if (cache.IsActive()) {
+      cache.SetEntry(offset,
+                     value,
+                     value->GetMemorySize());
+    }
 
-    if (!cache.IsActive()) {
-      for (std::vector<FileOffset>::const_iterator offset=offsets.begin();
-           offset!=offsets.end();
-           ++offset) {
-        N *value=new N();
+    entry=value;
 
-        scanner.SetPos(*offset);
+    return true;
+  }
 
-        value->Read(scanner);
+  template <class N>
+  bool DataFile<N>::GetByOffset(const std::vector<FileOffset>& offsets,
+                                std::vector<ValueType>& data) const
+  {
+    assert(isOpen);
 
-        if (scanner.HasError()) {
-          std::cerr << "Error while reading data from offset " << *offset << " of file " << datafilename << "!" << std::endl;
-          // TODO: Remove broken entry from cache
-          scanner.Close();
-          return false;
-        }
+    PooledFileScanner scanner(scannerPool);
 
-        data.push_back(value);
-      }
+    if (!scanner.IsValid()) {
+      return false;
     }
-    else {
-      typename DataCache::CacheRef cacheRef;
-
-      for (std::vector<FileOffset>::const_iterator offset=offsets.begin();
-           offset!=offsets.end();
-           ++offset) {
-        if (!cache.GetEntry(*offset,cacheRef)) {
-          typename DataCache::CacheEntry cacheEntry(*offset);
-
-          cacheRef=cache.SetEntry(cacheEntry);
-
-          scanner.SetPos(*offset);
-          cacheRef->value=new N();
-          cacheRef->value->Read(scanner);
-
-          if (scanner.HasError()) {
-            std::cerr << "Error while reading data from offset " << *offset << " of file " << datafilename << "!" << std::endl;
-            // TODO: Remove broken entry from cache
-            scanner.Close();
-            return false;
-          }
-        }
-
-        data.push_back(cacheRef->value);
+
+    data.reserve(data.size()+offsets.size());
+
+    for (std::vector<FileOffset>::const_iterator offset=offsets.begin();
+         offset!=offsets.end();
+         ++offset) {
+      ValueType value;
+
+      if (!ReadData(*scanner,*offset,value)) {
+        return false;
       }
+
+      data.push_back(value);
     }
 
     return true;
@@ -211,59 +234,24 @@ namespace osmscout {
   {
     assert(isOpen);
 
-    if (!scanner.IsOpen()) {
-      if (!scanner.Open(datafilename,modeData,memoryMapedData)) {
-        std::cerr << "Error while opening " << datafilename << " for reading!" << std::endl;
-        return false;
-      }
+    PooledFileScanner scanner(scannerPool);
+
+    if (!scanner.IsValid()) {
+      return false;
     }
 
     data.reserve(data.size()+offsets.size());
 
-    if (!cache.IsActive()) {
-      for (std::list<FileOffset>::const_iterator offset=offsets.begin();
-           offset!=offsets.end();
-           ++offset) {
-        N *value=new N();
-
-        scanner.SetPos(*offset);
-        value->Read(scanner);
-
-        if (scanner.HasError()) {
-          std::cerr << "Error while reading data from offset " << *offset << " of file " << datafilename << "!" << std::endl;
-          // TODO: Remove broken entry from cache
-          scanner.Close();
-          return false;
-        }
+    for (std::list<FileOffset>::const_iterator offset=offsets.begin();
+         offset!=offsets.end();
+         ++offset) {
+      ValueType value;
 
-        data.push_back(value);
-      }
-    }
-    else {
-      typename DataCache::CacheRef cacheRef;
-
-      for (std::list<FileOffset>::const_iterator offset=offsets.begin();
-           offset!=offsets.end();
-           ++offset) {
-        if (!cache.GetEntry(*offset,cacheRef)) {
-          typename DataCache::CacheEntry cacheEntry(*offset);
-
-          cacheRef=cache.SetEntry(cacheEntry);
-
-          scanner.SetPos(*offset);
-          cacheRef->value=new N();
-          cacheRef->value->Read(scanner);
-
-          if (scanner.HasError()) {
-            std::cerr << "Error while reading data from offset " << *offset << " of file " << datafilename << "!" << std::endl;
-            // TODO: Remove broken entry from cache
-            scanner.Close();
-            return false;
-          }
-        }
-
-        data.push_back(cacheRef->value);
+      if (!ReadData(*scanner,*offset,value)) {
+        return false;
       }
+
+      data.push_back(value);
     }
 
     return true;
@@ -275,59 +263,24 @@ namespace osmscout {
   {
     assert(isOpen);
 
-    if (!scanner.IsOpen()) {
-      if (!scanner.Open(datafilename,modeData,memoryMapedData)) {
-        std::cerr << "Error while opening " << datafilename << " for reading!" << std::endl;
-        return false;
-      }
+    PooledFileScanner scanner(scannerPool);
+
+    if (!scanner.IsValid()) {
+      return false;
     }
 
     data.reserve(data.size()+offsets.size());
 
-    if (!cache.IsActive()) {
-      for (std::set<FileOffset>::const_iterator offset=offsets.begin();
-           offset!=offsets.end();
-           ++offset) {
-        N *value=new N();
-
-        scanner.SetPos(*offset);
-        value->Read(scanner);
+    for (std::set<FileOffset>::const_iterator offset=offsets.begin();
+         offset!=offsets.end();
+         ++offset) {
+      ValueType value;
 
-        if (scanner.HasError()) {
-          std::cerr << "Error while reading data from offset " << *offset << " of file " << datafilename << "!" << std::endl;
-          // TODO: Remove broken entry from cache
-          scanner.Close();
-          return false;
-        }
-
-        data.push_back(value);
-      }
-    }
-    else {
-      typename DataCache::CacheRef cacheRef;
-
-      for (std::set<FileOffset>::const_iterator offset=offsets.begin();
-           offset!=offsets.end();
-           ++offset) {
-        if (!cache.GetEntry(*offset,cacheRef)) {
-          typename DataCache::CacheEntry cacheEntry(*offset);
-
-          cacheRef=cache.SetEntry(cacheEntry);
-
-          scanner.SetPos(*offset);
-          cacheRef->value=new N();
-          cacheRef->value->Read(scanner);
-
-          if (scanner.HasError()) {
-            std::cerr << "Error while reading data from offset " << *offset << " of file " << datafilename << "!" << std::endl;
-            // TODO: Remove broken entry from cache
-            scanner.Close();
-            return false;
-          }
-        }
-
-        data.push_back(cacheRef->value);
+      if (!ReadData(*scanner,*offset,value)) {
+        return false;
       }
+
+      data.push_back(value);
     }
 
     return true;
@@ -358,49 +311,49 @@ namespace osmscout {
   {
     assert(isOpen);
 
-    if (!scanner.IsOpen()) {
-      if (!scanner.Open(datafilename,modeData,memoryMapedData)) {
-        std::cerr << "Error while opening " << datafilename << " for reading!" << std::endl;
-        return false;
-      }
+    PooledFileScanner scanner(scannerPool);
+
+    if (!scanner.IsValid()) {
+      return false;
     }
 
-    if (!cache.IsActive()) {
-      N *value=new N();
+    return ReadData(*scanner,offset,entry);
+  }
 
-      scanner.SetPos(offset);
-      value->Read(scanner);
+  /**
+    Returns views of the objects at the given offsets. V must offer a method
+    Read(const char* buffer, FileOffset size, FileOffset offset).
 
-      if (scanner.HasError()) {
-        std::cerr << "Error while reading data from offset " << offset << " of file " << datafilename << "!" << std::endl;
-        // TODO: Remove broken entry from cache
-        scanner.Close();
-        return false;
-      }
+    This only works if the data file has been opened memory mapped and the
+    mapping succeeded. The views stay valid until the data file is closed.
+    */
+  template <class N>
+  template <class V>
+  bool DataFile<N>::GetViewsByOffset(const std::vector<FileOffset>& offsets,
+                                     std::vector<V>& views) const
+  {
+    assert(isOpen);
 
-      entry=value;
-    }
-    else {
-      typename DataCache::CacheRef cacheRef;
+    const char* buffer=viewScanner.GetMappedBuffer();
 
-      if (!cache.GetEntry(offset,cacheRef)) {
-        typename DataCache::CacheEntry cacheEntry(offset);
+    if (buffer==NULL) {
+      std::cerr << "File " << datafilename << " is not memory mapped, cannot return object views!" << std::endl;
+      return false;
+    }
 
-        cacheRef=cache.SetEntry(cacheEntry);
+    views.resize(views.size()+offsets.size());
 
-        scanner.SetPos(offset);
-        cacheRef->value=new N();
-        cacheRef->value->Read(scanner);
+    typename std::vector<V>::iterator view=views.end()-offsets.size();
 
-        if (scanner.HasError()) {
-          std::cerr << "Error while reading data from offset " << offset << " of file " << datafilename << "!" << std::endl;
-          // TODO: Remove broken entry from cache
-          scanner.Close();
-          return false;
-        }
+    for (std::vector<FileOffset>::const_iterator offset=offsets.begin();
+         offset!=offsets.end();
+         ++offset) {
+      if (!view->Read(buffer,viewScanner.GetSize(),*offset)) {
+        std::cerr << "Error while reading data from offset " << *offset << " of file " << datafilename << "!" << std::endl;
+        return false;
       }
 
-      entry=cacheRef->value;
+      ++view;
     }
 
     return true;
@@ -415,7 +368,7 @@ namespace osmscout {
   template <class N>
   void DataFile<N>::DumpStatistics() const
   {
-    cache.DumpStatistics(datafile.c_str(),DataCacheValueSizer());
+    cache.DumpStatistics(datafile.c_str());
   }
 
   template <class I, class N>
@@ -433,7 +386,7 @@ namespace osmscout {
   public:
     IndexedDataFile(const std::string& datafile,
                     const std::string& indexfile,
-                    unsigned long dataCacheSize,
+                    unsigned long dataCacheMemory,
                     unsigned long indexCacheSize);
 
     bool Open(const std::string& path,
@@ -466,9 +419,9 @@ namespace osmscout {
   template <class I, class N>
   IndexedDataFile<I,N>::IndexedDataFile(const std::string& datafile,
                                         const std::string& indexfile,
-                                        unsigned long dataCacheSize,
+                                        unsigned long dataCacheMemory,
                                         unsigned long indexCacheSize)
-  : DataFile<N>(datafile,dataCacheSize),
+  : DataFile<N>(datafile,dataCacheMemory),
     index(indexfile,indexCacheSize)
   {
     // no code
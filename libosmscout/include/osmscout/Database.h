@@ -32,6 +32,9 @@
 #include <osmscout/NodeDataFile.h>
 #include <osmscout/WayDataFile.h>
 
+#include <osmscout/ObjectView.h>
+#include <osmscout/TiledObjects.h>
+
 #include <osmscout/OptimizeAreasLowZoom.h>
 #include <osmscout/OptimizeWaysLowZoom.h>
 
@@ -59,7 +62,8 @@ namespace osmscout {
     instance.
 
     The following groups attributes are currently available:
-    * cache sizes.
+    * cache sizes. The index cache sizes are given as number of entries,
+      the node, way and area cache sizes are given in bytes.
     */
   class OSMSCOUT_API DatabaseParameter
   {
@@ -67,11 +71,11 @@ namespace osmscout {
     unsigned long areaAreaIndexCacheSize;
     unsigned long areaNodeIndexCacheSize;
 
-    unsigned long nodeCacheSize;
+    unsigned long nodeCacheSizeBytes; //! Memory in bytes
 
-    unsigned long wayCacheSize;
+    unsigned long wayCacheSizeBytes;  //! Memory in bytes
 
-    unsigned long areaCacheSize;
+    unsigned long areaCacheSizeBytes; //! Memory in bytes
 
     bool          debugPerformance;
 
@@ -81,22 +85,22 @@ namespace osmscout {
     void SetAreaAreaIndexCacheSize(unsigned long areaAreaIndexCacheSize);
     void SetAreaNodeIndexCacheSize(unsigned long areaNodeIndexCacheSize);
 
-    void SetNodeCacheSize(unsigned long nodeCacheSize);
+    void SetNodeCacheSizeBytes(unsigned long nodeCacheSizeBytes);
 
-    void SetWayCacheSize(unsigned long wayCacheSize);
+    void SetWayCacheSizeBytes(unsigned long wayCacheSizeBytes);
 
-    void SetAreaCacheSize(unsigned long relationCacheSize);
+    void SetAreaCacheSizeBytes(unsigned long areaCacheSizeBytes);
 
     void SetDebugPerformance(bool debug);
 
     unsigned long GetAreaAreaIndexCacheSize() const;
     unsigned long GetAreaNodeIndexCacheSize() const;
 
-    unsigned long GetNodeCacheSize() const;
+    unsigned long GetNodeCacheSizeBytes() const;
 
-    unsigned long GetWayCacheSize() const;
+    unsigned long GetWayCacheSizeBytes() const;
 
-    unsigned long GetAreaCacheSize() const;
+    unsigned long GetAreaCacheSizeBytes() const;
 
     bool IsDebugPerformance() const;
   };
@@ -144,6 +148,21 @@ namespace osmscout {
     bool IsAborted() const;
   };
 
+  /**
+    Access to an imported map database.
+
+    After Open() returned successfully, an instance can be shared between
+    multiple threads: GetObjects() and the Get*ByOffset() methods may be called
+    concurrently. Each reading thread uses its own file handles, while the object
+    caches for nodes, ways and areas are shared between all threads.
+    Open(), Close() and FlushCache() must not be called while other threads
+    access the database.
+
+    The variants of GetObjects(), GetWaysByOffset() and GetAreasByOffset()
+    returning WayView and AreaView do not copy data but point into the memory
+    mapped data files. They bypass the object caches and stay valid until the
+    database is closed.
+    */
   class OSMSCOUT_API Database
   {
   private:
@@ -193,6 +212,7 @@ namespace osmscout {
                          std::string& nodesTime,
                          std::vector<NodeRef>& nodes) const;
 
+    template<class W>
     bool GetObjectsWays(const AreaSearchParameter& parameter,
                         const std::vector<TypeSet>& wayTypes,
                         const Magnification& magnification,
@@ -201,17 +221,34 @@ namespace osmscout {
                         std::string& wayOptimizedTime,
                         std::string& wayIndexTime,
                         std::string& waysTime,
-                        std::vector<WayRef>& ways) const;
+                        std::vector<W>& ways) const;
 
+    template<class A>
     bool GetObjectsAreas(const AreaSearchParameter& parameter,
-                               const TypeSet& areaTypes,
-                               const Magnification& magnification,
-                               double lonMin, double latMin,
-                               double lonMax, double latMax,
-                               std::string& areaOptimizedTime,
-                               std::string& areaIndexTime,
-                               std::string& areasTime,
-                               std::vector<AreaRef>& areas) const;
+                         const TypeSet& areaTypes,
+                         const Magnification& magnification,
+                         double lonMin, double latMin,
+                         double lonMax, double latMax,
+                         std::string& areaOptimizedTime,
+                         std::string& areaIndexTime,
+                         std::string& areasTime,
+                         std::vector<A>& areas) const;
+
+    template<class W, class A>
+    bool CollectObjects(const AreaSearchParameter& parameter,
+                        const Magnification& magnification,
+                        const TypeSet &nodeTypes,
+                        double nodeLonMin, double nodeLatMin,
+                        double nodeLonMax, double nodeLatMax,
+                        std::vector<NodeRef>& nodes,
+                        const std::vector<TypeSet>& wayTypes,
+                        double wayLonMin, double wayLatMin,
+                        double wayLonMax, double wayLatMax,
+                        std::vector<W>& ways,
+                        const TypeSet& areaTypes,
+                        double areaLonMin, double areaLatMin,
+                        double areaLonMax, double areaLatMax,
+                        std::vector<A>& areas) const;
 
     bool HandleAdminRegion(const LocationSearch& search,
                            const LocationSearch::Entry& searchEntry,
@@ -277,6 +314,44 @@ namespace osmscout {
                     double areaLonMax, double areaLatMax,
                     std::vector<AreaRef>& areas) const;
 
+    bool GetObjects(const TypeSet &nodeTypes,
+                    const std::vector<TypeSet>& wayTypes,
+                    const TypeSet& areaTypes,
+                    double lonMin, double latMin,
+                    double lonMax, double latMax,
+                    const Magnification& magnification,
+                    const AreaSearchParameter& parameter,
+                    std::vector<NodeRef>& nodes,
+                    std::vector<WayView>& ways,
+                    std::vector<AreaView>& areas) const;
+
+    bool GetObjects(const AreaSearchParameter& parameter,
+                    const Magnification& magnification,
+                    const TypeSet &nodeTypes,
+                    double nodeLonMin, double nodeLatMin,
+                    double nodeLonMax, double nodeLatMax,
+                    std::vector<NodeRef>& nodes,
+                    const std::vector<TypeSet>& wayTypes,
+                    double wayLonMin, double wayLatMin,
+                    double wayLonMax, double wayLatMax,
+                    std::vector<WayView>& ways,
+                    const TypeSet& areaTypes,
+                    double areaLonMin, double areaLatMin,
+                    double areaLonMax, double areaLatMax,
+                    std::vector<AreaView>& areas) const;
+
+    bool GetObjectsForTiles(const AreaSearchParameter& parameter,
+                            const Magnification& magnification,
+                            const TypeSet &nodeTypes,
+                            const std::vector<TypeSet>& wayTypes,
+                            const TypeSet& areaTypes,
+                            size_t zoom,
+                            size_t xStart,
+                            size_t yStart,
+                            size_t xEnd,
+                            size_t yEnd,
+                            TiledObjects& objects) const;
+
     bool GetObjects(double lonMin, double latMin,
                     double lonMax, double latMax,
                     const TypeSet& types,
@@ -315,6 +390,8 @@ namespace osmscout {
                           std::vector<AreaRef>& areas) const;
     bool GetAreasByOffset(const std::set<FileOffset>& offsets,
                           OSMSCOUT_HASHMAP<FileOffset,AreaRef>& dataMap) const;
+    bool GetAreasByOffset(const std::vector<FileOffset>& offsets,
+                          std::vector<AreaView>& areas) const;
 
     bool GetWayByOffset(const FileOffset& offset,
                         WayRef& way) const;
@@ -326,6 +403,8 @@ namespace osmscout {
                          std::vector<WayRef>& ways) const;
     bool GetWaysByOffset(const std::set<FileOffset>& offsets,
                          OSMSCOUT_HASHMAP<FileOffset,WayRef>& dataMap) const;
+    bool GetWaysByOffset(const std::vector<FileOffset>& offsets,
+                         std::vector<WayView>& ways) const;
 
     bool VisitAdminRegions(AdminRegionVisitor& visitor) const;
 
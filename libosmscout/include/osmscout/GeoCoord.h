@@ -20,16 +20,38 @@
   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
 */
 
+#include <osmscout/CoreFeatures.h>
+
 #include <osmscout/private/CoreImportExport.h>
 
+#include <osmscout/Types.h>
+
+#include <osmscout/system/Math.h>
 #include <osmscout/system/Types.h>
 
 namespace osmscout {
 
+  /**
+    A geographic coordinate.
+
+    By default latitude and longitude are stored as double. If the library
+    is configured with --enable-compact-coords (OSMSCOUT_COMPACT_COORDS),
+    they are stored as two 32 bit fixed point values using conversionFactor,
+    the same representation as used in the data files. This halves the
+    memory needed for each coordinate of a cached way or area. Coordinates
+    read from the data files are identical in both modes, values passed to
+    the constructor or Set() are rounded to the nearest fixed point value in
+    compact mode.
+    */
   struct OSMSCOUT_API GeoCoord
   {
+#if defined(OSMSCOUT_COMPACT_COORDS)
+    uint32_t latValue;
+    uint32_t lonValue;
+#else
     double lat;
     double lon;
+#endif
 
     inline GeoCoord()
     {
@@ -38,28 +60,78 @@ namespace osmscout {
 
     inline GeoCoord(double lat,
                     double lon)
-     :lat(lat),lon(lon)
     {
-      // no code
+      Set(lat,lon);
     }
 
-     inline void Set(double lat,
+    inline void Set(double lat,
                     double lon)
     {
+#if defined(OSMSCOUT_COMPACT_COORDS)
+      latValue=(uint32_t)floor((lat+90.0)*conversionFactor+0.5);
+      lonValue=(uint32_t)floor((lon+180.0)*conversionFactor+0.5);
+#else
       this->lat=lat;
       this->lon=lon;
+#endif
+    }
+
+    /**
+      Set the coordinate from fixed point values as stored in the data files
+      */
+    inline void SetValues(uint32_t latValue,
+                          uint32_t lonValue)
+    {
+#if defined(OSMSCOUT_COMPACT_COORDS)
+      this->latValue=latValue;
+      this->lonValue=lonValue;
+#else
+      lat=latValue/conversionFactor-90.0;
+      lon=lonValue/conversionFactor-180.0;
+#endif
     }
 
     inline double GetLat() const
     {
+#if defined(OSMSCOUT_COMPACT_COORDS)
+      return latValue/conversionFactor-90.0;
+#else
       return lat;
+#endif
     }
 
     inline double GetLon() const
     {
+#if defined(OSMSCOUT_COMPACT_COORDS)
+      return lonValue/conversionFactor-180.0;
+#else
       return lon;
+#endif
     }
 
+#if defined(OSMSCOUT_COMPACT_COORDS)
+    inline bool IsEqual(const GeoCoord& other) const
+    {
+      return latValue==other.latValue && lonValue==other.lonValue;
+    }
+
+    inline bool operator==(const GeoCoord& other) const
+    {
+      return latValue==other.latValue && lonValue==other.lonValue;
+    }
+
+    inline bool operator<(const GeoCoord& other) const
+    {
+      return latValue<other.latValue ||
+      (latValue==other.latValue && lonValue<other.lonValue);
+    }
+
+    inline void operator=(const GeoCoord& other)
+    {
+      this->latValue=other.latValue;
+      this->lonValue=other.lonValue;
+    }
+#else
     inline bool IsEqual(const GeoCoord& other) const
     {
       return lat==other.lat && lon==other.lon;
@@ -81,6 +153,7 @@ namespace osmscout {
       this->lat=other.lat;
       this->lon=other.lon;
     }
+#endif
   };
 }
 
@@ -55,6 +55,8 @@ namespace osmscout {
       return objects;
     }
 
+    unsigned long GetMemorySize() const;
+
     bool Read(FileScanner& scanner);
   };
 
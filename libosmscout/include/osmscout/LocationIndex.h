@@ -46,12 +46,13 @@ namespace osmscout {
 
   private:
     std::string      path;
-    mutable uint8_t  bytesForNodeFileOffset;
-    mutable uint8_t  bytesForAreaFileOffset;
-    mutable uint8_t  bytesForWayFileOffset;
+    uint8_t          bytesForNodeFileOffset;
+    uint8_t          bytesForAreaFileOffset;
+    uint8_t          bytesForWayFileOffset;
+    FileOffset       indexOffset;            //! Offset of the first entry behind the file header
 
   private:
-    bool ReadObjectFileOffsetBytes(FileScanner& scanner) const;
+    bool ReadObjectFileOffsetBytes(FileScanner& scanner);
     bool Read(FileScanner& scanner,
               ObjectFileRef& object) const;
 
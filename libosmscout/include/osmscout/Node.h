@@ -105,6 +105,8 @@ namespace osmscout {
                  const TypeConfig& typeConfig,
                  std::vector<Tag>& tags);
 
+    unsigned long GetMemorySize() const;
+
     bool operator==(const NodeAttributes& other) const;
     bool operator!=(const NodeAttributes& other) const;
   };
@@ -183,6 +185,8 @@ namespace osmscout {
                  const TypeConfig& typeConfig,
                  std::vector<Tag>& tags);
 
+    unsigned long GetMemorySize() const;
+
     bool Read(FileScanner& scanner);
     bool Write(FileWriter& writer) const;
   };
@@ -28,6 +28,7 @@
 #include <osmscout/util/Number.h>
 #include <osmscout/util/File.h>
 #include <osmscout/util/FileScanner.h>
+#include <osmscout/util/Mutex.h>
 #include <osmscout/util/Reference.h>
 #include <osmscout/util/String.h>
 
@@ -36,6 +37,10 @@ namespace osmscout {
   /**
     Numeric index handles an index over instance of class <T> where the index criteria
     is of type <N>, where <N> has a numeric nature (usually Id).
+
+    NumericIndex can be used from multiple threads at the same time. The
+    index pages are read and cached on demand, so lookups are serialized by
+    a mutex.
     */
   template <class N>
   class NumericIndex
@@ -88,10 +93,12 @@ namespace osmscout {
     char                           *buffer;
     PageRef                        root;
     mutable std::vector<PageCache> leafs;
+    mutable Mutex                  mutex;    //! Guards the scanner and the page caches
 
   private:
     size_t GetPageIndex(const PageRef& page, N id) const;
     bool ReadPage(FileOffset offset, PageRef& page) const;
+    bool LookupOffset(const N& id, FileOffset& offset) const;
 
   public:
     NumericIndex(const std::string& filename,
@@ -303,9 +310,12 @@ namespace osmscout {
     return true;
   }
 
+  /**
+    Returns the offset for the given id, the mutex must be locked by the caller
+    */
   template <class N>
-  bool NumericIndex<N>::GetOffset(const N& id,
-                                  FileOffset& offset) const
+  bool NumericIndex<N>::LookupOffset(const N& id,
+                                     FileOffset& offset) const
   {
     size_t r=GetPageIndex(root,id);
 
@@ -347,10 +357,22 @@ namespace osmscout {
     return startId==id;
   }
 
+  template <class N>
+  bool NumericIndex<N>::GetOffset(const N& id,
+                                  FileOffset& offset) const
+  {
+    MutexLocker locker(mutex);
+
+    return LookupOffset(id,
+                        offset);
+  }
+
   template <class N>
   bool NumericIndex<N>::GetOffsets(const std::vector<N>& ids,
                                    std::vector<FileOffset>& offsets) const
   {
+    MutexLocker locker(mutex);
+
     offsets.clear();
     offsets.reserve(ids.size());
 
@@ -359,8 +381,8 @@ namespace osmscout {
          ++id) {
       FileOffset offset;
 
-      if (GetOffset(*id,
-                    offset)) {
+      if (LookupOffset(*id,
+                       offset)) {
         offsets.push_back(offset);
       }
     }
@@ -372,6 +394,8 @@ namespace osmscout {
   bool NumericIndex<N>::GetOffsets(const std::list<N>& ids,
                                    std::vector<FileOffset>& offsets) const
   {
+    MutexLocker locker(mutex);
+
     offsets.clear();
     offsets.reserve(ids.size());
 
@@ -380,8 +404,8 @@ namespace osmscout {
          ++id) {
       FileOffset offset;
 
-      if (GetOffset(*id,
-                    offset)) {
+      if (LookupOffset(*id,
+                       offset)) {
         offsets.push_back(offset);
       }
     }
@@ -393,6 +417,8 @@ namespace osmscout {
   bool NumericIndex<N>::GetOffsets(const std::set<N>& ids,
                                    std::vector<FileOffset>& offsets) const
   {
+    MutexLocker locker(mutex);
+
     offsets.clear();
     offsets.reserve(ids.size());
 
@@ -401,8 +427,8 @@ namespace osmscout {
          ++id) {
       FileOffset offset;
 
-      if (GetOffset(*id,
-                    offset)) {
+      if (LookupOffset(*id,
+                       offset)) {
         offsets.push_back(offset);
       }
     }
@@ -413,8 +439,9 @@ namespace osmscout {
   template <class N>
   void NumericIndex<N>::DumpStatistics() const
   {
-    size_t memory=0;
-    size_t pages=0;
+    MutexLocker locker(mutex);
+    size_t      memory=0;
+    size_t      pages=0;
 
     pages+=1;
     memory+=root->entries.size()*sizeof(Entry);
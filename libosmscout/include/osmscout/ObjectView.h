@@ -0,0 +1,319 @@
+#ifndef OSMSCOUT_OBJECTVIEW_H
+#define OSMSCOUT_OBJECTVIEW_H
+
+/*
+  This source is part of the libosmscout library
+  Copyright (C) 2013  Tim Teulings
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+#include <vector>
+
+#include <osmscout/GeoCoord.h>
+#include <osmscout/Tag.h>
+#include <osmscout/Types.h>
+
+#include <osmscout/private/CoreImportExport.h>
+
+namespace osmscout {
+
+  /**
+    Read-only view of a way stored in a memory mapped data file.
+
+    In contrast to Way, a WayView does not copy any data. Read() only decodes
+    the fixed size attributes and remembers the position of the variable sized data
+    (names, tags, coordinates and ids). Names are returned as pointers into the
+    mapped file, tags, coordinates and ids are decoded on request.
+
+    A WayView is only valid as long as the file it points into is open.
+    */
+  class OSMSCOUT_API WayView
+  {
+  private:
+    FileOffset  fileOffset;
+    const char* end;         //! End of the mapped file
+    bool        optimized;   //! Data was written by Way::WriteOptimized()
+
+    TypeId      type;
+    uint16_t    flags;
+    const char* name;
+    const char* nameAlt;
+    const char* ref;
+    const char* location;
+    const char* address;
+    int8_t      layer;
+    uint8_t     width;
+    uint8_t     maxSpeed;
+    uint8_t     grade;
+    uint32_t    tagCount;
+    const char* tags;        //! Start of the tag data
+    uint32_t    nodeCount;
+    const char* coords;      //! Start of the coordinate data
+
+  private:
+    bool Read(const char* buffer,
+              FileOffset size,
+              FileOffset offset,
+              bool optimized);
+
+  public:
+    WayView();
+
+    inline FileOffset GetFileOffset() const
+    {
+      return fileOffset;
+    }
+
+    inline TypeId GetType() const
+    {
+      return type;
+    }
+
+    inline uint16_t GetFlags() const
+    {
+      return flags;
+    }
+
+    /**
+      Returns the name of the way or an empty string.
+      */
+    inline const char* GetName() const
+    {
+      return name;
+    }
+
+    inline const char* GetNameAlt() const
+    {
+      return nameAlt;
+    }
+
+    inline const char* GetRefName() const
+    {
+      return ref;
+    }
+
+    inline const char* GetLocation() const
+    {
+      return location;
+    }
+
+    inline const char* GetAddress() const
+    {
+      return address;
+    }
+
+    inline int8_t GetLayer() const
+    {
+      return layer;
+    }
+
+    inline uint8_t GetWidth() const
+    {
+      return width;
+    }
+
+    inline uint8_t GetMaxSpeed() const
+    {
+      return maxSpeed;
+    }
+
+    inline uint8_t GetGrade() const
+    {
+      return grade;
+    }
+
+    bool IsBridge() const;
+    bool IsTunnel() const;
+    bool IsRoundabout() const;
+    bool HasAccess() const;
+
+    inline bool HasTags() const
+    {
+      return tagCount>0;
+    }
+
+    inline size_t GetNodeCount() const
+    {
+      return nodeCount;
+    }
+
+    bool GetTags(std::vector<Tag>& tags) const;
+    bool GetNodes(std::vector<GeoCoord>& nodes) const;
+    bool GetIds(std::vector<Id>& ids) const;
+    bool GetBoundingBox(double& minLon,
+                        double& maxLon,
+                        double& minLat,
+                        double& maxLat) const;
+
+    bool Read(const char* buffer,
+              FileOffset size,
+              FileOffset offset);
+    bool ReadOptimized(const char* buffer,
+                       FileOffset size,
+                       FileOffset offset);
+  };
+
+  /**
+    Read-only view of one ring of an area stored in a memory mapped data file.
+    See WayView for details.
+    */
+  class OSMSCOUT_API AreaRingView
+  {
+  private:
+    const char* end;         //! End of the mapped file
+    bool        optimized;   //! Data was written by Area::WriteOptimized()
+
+    TypeId      type;
+    uint8_t     flags;
+    const char* name;
+    const char* nameAlt;
+    const char* location;
+    const char* address;
+    uint32_t    tagCount;
+    const char* tags;        //! Start of the tag data
+    uint8_t     ring;
+    uint32_t    nodeCount;
+    const char* ids;         //! Start of the id data
+    const char* coords;      //! Start of the coordinate data
+    const char* next;        //! Start of the next ring
+
+  private:
+    const char* ReadAttributes(const char* data,
+                               uint8_t flags);
+    const char* ReadNodes(const char* data,
+                          bool hasIds);
+
+    friend class AreaView;
+
+  public:
+    AreaRingView();
+
+    inline TypeId GetType() const
+    {
+      return type;
+    }
+
+    inline uint8_t GetFlags() const
+    {
+      return flags;
+    }
+
+    inline const char* GetName() const
+    {
+      return name;
+    }
+
+    inline const char* GetNameAlt() const
+    {
+      return nameAlt;
+    }
+
+    inline const char* GetLocation() const
+    {
+      return location;
+    }
+
+    inline const char* GetAddress() const
+    {
+      return address;
+    }
+
+    inline uint8_t GetRing() const
+    {
+      return ring;
+    }
+
+    inline bool HasTags() const
+    {
+      return tagCount>0;
+    }
+
+    inline size_t GetNodeCount() const
+    {
+      return nodeCount;
+    }
+
+    bool GetTags(std::vector<Tag>& tags) const;
+    bool GetNodes(std::vector<GeoCoord>& nodes) const;
+    bool GetIds(std::vector<Id>& ids) const;
+    bool GetBoundingBox(double& minLon,
+                        double& maxLon,
+                        double& minLat,
+                        double& maxLat) const;
+  };
+
+  /**
+    Read-only view of an area stored in a memory mapped data file. Read() decodes
+    the header of the first (master or outer) ring only, the other rings are
+    located on request. See WayView for details.
+    */
+  class OSMSCOUT_API AreaView
+  {
+  private:
+    FileOffset   fileOffset;
+    uint32_t     ringCount;
+    AreaRingView master;      //! The first ring
+
+  private:
+    bool Read(const char* buffer,
+              FileOffset size,
+              FileOffset offset,
+              bool optimized);
+
+  public:
+    AreaView();
+
+    inline FileOffset GetFileOffset() const
+    {
+      return fileOffset;
+    }
+
+    inline TypeId GetType() const
+    {
+      return master.GetType();
+    }
+
+    inline bool IsSimple() const
+    {
+      return ringCount==1;
+    }
+
+    inline size_t GetRingCount() const
+    {
+      return ringCount;
+    }
+
+    inline const AreaRingView& GetMasterRing() const
+    {
+      return master;
+    }
+
+    bool GetRings(std::vector<AreaRingView>& rings) const;
+    bool GetBoundingBox(double& minLon,
+                        double& maxLon,
+                        double& minLat,
+                        double& maxLat) const;
+
+    bool Read(const char* buffer,
+              FileOffset size,
+              FileOffset offset);
+    bool ReadOptimized(const char* buffer,
+                       FileOffset size,
+                       FileOffset offset);
+  };
+}
+
+#endif
@@ -23,12 +23,14 @@
 #include <set>
 #include <string>
 
+#include <osmscout/ObjectView.h>
 #include <osmscout/TypeSet.h>
 
 #include <osmscout/Area.h>
 #include <osmscout/Way.h>
 
 #include <osmscout/util/FileScanner.h>
+#include <osmscout/util/FileScannerPool.h>
 #include <osmscout/util/Magnification.h>
 
 namespace osmscout {
@@ -64,7 +66,8 @@ namespace osmscout {
   private:
     std::string                           datafile;      //! Basename part for the data file name
     std::string                           datafilename;  //! complete filename for data file
-    mutable FileScanner                   scanner;       //! File stream to the data file
+    mutable FileScannerPool               scannerPool;   //! File streams to the data file, one per reading thread
+    FileScanner                           viewScanner;   //! Memory mapping of the data file views point into
 
     double                                magnification; //! Magnification, upto which we support optimization
     std::map<TypeId,std::list<TypeData> > wayTypesData;  //! Index information for all way types
@@ -73,13 +76,21 @@ namespace osmscout {
     bool ReadTypeData(FileScanner& scanner,
                       TypeData& data);
 
-    bool GetOffsets(const TypeData& typeData,
+    bool GetOffsets(FileScanner& scanner,
+                    const TypeData& typeData,
                     double minlon,
                     double minlat,
                     double maxlon,
                     double maxlat,
                     std::vector<FileOffset>& offsets) const;
 
+    bool GetOffsets(FileScanner& scanner,
+                    double lonMin, double latMin,
+                    double lonMax, double latMax,
+                    const Magnification& magnification,
+                    std::vector<TypeSet>& wayTypes,
+                    std::vector<FileOffset>& offsets) const;
+
   public:
     OptimizeWaysLowZoom();
     virtual ~OptimizeWaysLowZoom();
@@ -95,6 +106,13 @@ namespace osmscout {
                  size_t maxWayCount,
                  std::vector<TypeSet>& wayTypes,
                  std::vector<WayRef>& ways) const;
+
+    bool GetWays(double lonMin, double latMin,
+                 double lonMax, double latMax,
+                 const Magnification& magnification,
+                 size_t maxWayCount,
+                 std::vector<TypeSet>& wayTypes,
+                 std::vector<WayView>& ways) const;
   };
 }
 
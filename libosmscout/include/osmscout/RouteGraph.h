@@ -0,0 +1,206 @@
+#ifndef OSMSCOUT_ROUTEGRAPH_H
+#define OSMSCOUT_ROUTEGRAPH_H
+
+/*
+  This source is part of the libosmscout library
+  Copyright (C) 2013  Tim Teulings
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+#include <string>
+#include <vector>
+
+#include <osmscout/ObjectRef.h>
+#include <osmscout/RouteNode.h>
+#include <osmscout/Types.h>
+
+#include <osmscout/private/CoreImportExport.h>
+
+#include <osmscout/util/FileScanner.h>
+
+namespace osmscout {
+
+  /**
+    Compact, read-only copy of one routing graph (e.g. 'routecar.dat') in
+    compressed sparse row format.
+
+    The file consists of a header with the number of entries in each array,
+    followed by the arrays themselves:
+
+    * Nodes in the order of the routing graph file, each with the file offset
+      of its route node, its quantized coordinates and the index of its first
+      edge and its first exclude. A final sentinel node closes the ranges of
+      the last node.
+    * Edges, the paths of all route nodes in the same order as in the route
+      node, so the index of an edge relative to the first edge of its node is
+      the path index.
+    * Excludes, the turn restrictions of all route nodes.
+    * Objects, the ways and areas referenced by edges and excludes, sorted.
+
+    All entries are fixed width and are used directly from the memory mapped
+    file, so the file format depends on the byte order of the platform.
+    */
+  class OSMSCOUT_API RouteGraph
+  {
+  public:
+    static const uint32_t noNode;
+    static const uint32_t noObject;
+
+    struct OSMSCOUT_API Node
+    {
+      uint64_t offset;       //! File offset of the route node in the routing graph file
+      uint32_t lat;          //! Latitude, quantized using conversionFactor
+      uint32_t lon;          //! Longitude, quantized using conversionFactor
+      uint32_t firstEdge;    //! Index of the first edge of this node
+      uint32_t firstExclude; //! Index of the first exclude of this node
+    };
+
+    struct OSMSCOUT_API Edge
+    {
+      uint32_t target;       //! Index of the target node
+      uint32_t distance;     //! Distance in centimeters
+      uint32_t object;       //! Index of the way or area of this path
+      uint16_t type;         //! Type of the way or area
+      uint8_t  flags;        //! Flags of the path (see RouteNode)
+      uint8_t  maxSpeed;     //! Maximum speed allowed on the path, or 0
+    };
+
+    struct OSMSCOUT_API Exclude
+    {
+      uint32_t source;       //! Index of the object we come from
+      uint32_t targetEdge;   //! Index of the forbidden edge relative to the first edge of the node
+    };
+
+    struct OSMSCOUT_API Object
+    {
+      uint64_t offset;       //! File offset of the object
+      uint32_t type;         //! RefType of the object
+      uint32_t reserved;
+    };
+
+  private:
+    FileScanner       scanner;
+    std::vector<char> buffer;       //! Content of the file, if it could not be memory mapped
+    uint32_t          nodeCount;
+    uint32_t          edgeCount;
+    uint32_t          excludeCount;
+    uint32_t          objectCount;
+    const Node*       nodes;
+    const Edge*       edges;
+    const Exclude*    excludes;
+    const Object*     objects;
+
+  public:
+    RouteGraph();
+    virtual ~RouteGraph();
+
+    bool Open(const std::string& filename);
+    bool Close();
+
+    inline bool IsOpen() const
+    {
+      return nodes!=NULL;
+    }
+
+    inline uint32_t GetNodeCount() const
+    {
+      return nodeCount;
+    }
+
+    inline const Node& GetNode(uint32_t node) const
+    {
+      return nodes[node];
+    }
+
+    inline uint32_t GetEdgesBegin(uint32_t node) const
+    {
+      return nodes[node].firstEdge;
+    }
+
+    inline uint32_t GetEdgesEnd(uint32_t node) const
+    {
+      return nodes[node+1].firstEdge;
+    }
+
+    inline const Edge& GetEdge(uint32_t edge) const
+    {
+      return edges[edge];
+    }
+
+    inline uint32_t GetExcludesBegin(uint32_t node) const
+    {
+      return nodes[node].firstExclude;
+    }
+
+    inline uint32_t GetExcludesEnd(uint32_t node) const
+    {
+      return nodes[node+1].firstExclude;
+    }
+
+    inline const Exclude& GetExclude(uint32_t exclude) const
+    {
+      return excludes[exclude];
+    }
+
+    inline double GetLat(uint32_t node) const
+    {
+      return nodes[node].lat/conversionFactor-90.0;
+    }
+
+    inline double GetLon(uint32_t node) const
+    {
+      return nodes[node].lon/conversionFactor-180.0;
+    }
+
+    inline ObjectFileRef GetObject(uint32_t object) const
+    {
+      return ObjectFileRef(objects[object].offset,
+                           (RefType)objects[object].type);
+    }
+
+    /**
+      Fill the given path with the data of the edge as far as it is
+      relevant for the routing profile.
+      */
+    inline void GetPath(uint32_t edge,
+                        RouteNode::Path& path) const
+    {
+      const Edge& e=edges[edge];
+
+      path.offset=nodes[e.target].offset;
+      path.objectIndex=0;
+      path.type=e.type;
+      path.maxSpeed=e.maxSpeed;
+      path.grade=0;
+      path.flags=e.flags;
+      path.distance=e.distance/100000.0;
+      path.coord.SetValues(nodes[e.target].lat,
+                           nodes[e.target].lon);
+    }
+
+    bool GetNodeIndex(FileOffset offset,
+                      uint32_t& node) const;
+    uint32_t GetObjectIndex(const ObjectFileRef& object) const;
+
+    static bool Write(const std::string& filename,
+                      const std::vector<Node>& nodes,
+                      const std::vector<Edge>& edges,
+                      const std::vector<Exclude>& excludes,
+                      const std::vector<Object>& objects);
+  };
+}
+
+#endif
@@ -0,0 +1,115 @@
+#ifndef OSMSCOUT_ROUTEMATRIX_H
+#define OSMSCOUT_ROUTEMATRIX_H
+
+/*
+  This source is part of the libosmscout library
+  Copyright (C) 2013  Tim Teulings
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+#include <vector>
+
+#include <osmscout/ObjectRef.h>
+
+#include <osmscout/private/CoreImportExport.h>
+
+namespace osmscout {
+
+  /**
+    A position in the routing graph, given by an object (currently only ways
+    are supported) and the index of a node of this object.
+    */
+  class OSMSCOUT_API RoutePosition
+  {
+  private:
+    ObjectFileRef object;
+    size_t        nodeIndex;
+
+  public:
+    RoutePosition();
+    RoutePosition(const ObjectFileRef& object,
+                  size_t nodeIndex);
+
+    inline const ObjectFileRef& GetObject() const
+    {
+      return object;
+    }
+
+    inline size_t GetNodeIndex() const
+    {
+      return nodeIndex;
+    }
+  };
+
+  /**
+    Dense matrix of the costs and the time from a number of sources (rows)
+    to a number of targets (columns) as calculated by Router::CalculateMatrix().
+    */
+  class OSMSCOUT_API RouteMatrix
+  {
+  private:
+    size_t              sourceCount;
+    size_t              targetCount;
+    std::vector<double> costs;       //! Costs by source*targetCount+target, negative if not reachable
+    std::vector<double> times;       //! Time by source*targetCount+target
+
+  public:
+    RouteMatrix();
+
+    void Clear();
+    void Initialize(size_t sourceCount,
+                    size_t targetCount);
+
+    inline size_t GetSourceCount() const
+    {
+      return sourceCount;
+    }
+
+    inline size_t GetTargetCount() const
+    {
+      return targetCount;
+    }
+
+    inline bool IsReachable(size_t source,
+                            size_t target) const
+    {
+      return costs[source*targetCount+target]>=0.0;
+    }
+
+    inline double GetCosts(size_t source,
+                           size_t target) const
+    {
+      return costs[source*targetCount+target];
+    }
+
+    inline double GetTime(size_t source,
+                          size_t target) const
+    {
+      return times[source*targetCount+target];
+    }
+
+    inline void Set(size_t source,
+                    size_t target,
+                    double costs,
+                    double time)
+    {
+      this->costs[source*targetCount+target]=costs;
+      this->times[source*targetCount+target]=time;
+    }
+  };
+}
+
+#endif
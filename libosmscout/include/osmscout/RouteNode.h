@@ -22,6 +22,7 @@
 
 #include <vector>
 
+#include <osmscout/GeoCoord.h>
 #include <osmscout/ObjectRef.h>
 #include <osmscout/Path.h>
 #include <osmscout/Types.h>
@@ -67,8 +68,7 @@ namespace osmscout {
       //uint8_t         bearing;     //! Encoded initial and final bearing of this path
       uint8_t         flags;       //! Certain flags
       double          distance;    //! Distance from the current route node to the target route node
-      double          lat;         //! Latitude of the target node
-      double          lon;         //! Longitude of the target node
+      GeoCoord        coord;       //! Coordinate of the target node
 
       inline bool HasAccess() const
       {
@@ -95,6 +95,8 @@ namespace osmscout {
 
     uint32_t AddObject(const ObjectFileRef& object);
 
+    unsigned long GetMemorySize() const;
+
     bool Read(FileScanner& scanner);
     bool Write(FileWriter& writer) const;
   };
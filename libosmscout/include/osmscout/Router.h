@@ -38,29 +38,53 @@
 #include <osmscout/Intersection.h>
 #include <osmscout/Route.h>
 #include <osmscout/RouteData.h>
+#include <osmscout/RouteGraph.h>
+#include <osmscout/RouteMatrix.h>
 #include <osmscout/RoutingProfile.h>
 
+#include <osmscout/ContractionHierarchy.h>
+
 #include <osmscout/util/Cache.h>
 #include <osmscout/util/HashMap.h>
 #include <osmscout/util/HashSet.h>
+#include <osmscout/util/Mutex.h>
+#include <osmscout/util/PriorityQueue.h>
 #include <osmscout/util/Reference.h>
 
 namespace osmscout {
 
   typedef DataFile<RouteNode> RouteNodeDataFile;
 
+  /**
+    Priority queue used by the router for the list of open nodes.
+    */
+  enum OpenListType
+  {
+    openListHeap      = 0, //! Indexed 4-ary heap, works for all routing profiles
+    openListRadixHeap = 1  //! Radix heap, faster, but costs are rounded to 1/1000000
+  };
+
   /**
     Database instance initialisation parameter to influence the behaviour of the database
     instance.
 
     The following groups attributes are currently available:
-    * cache sizes.
+    * cache sizes. The way index cache size is given as number of entries,
+      the way cache size is given in bytes.
+    * the priority queue used for the open list during route calculation.
+    * if the compact routing graph (see RouteGraph) should be used, if available
+      (off by default). If used, CalculateRoute() uses the routing graph instead
+      of the route node file.
     */
   class OSMSCOUT_API RouterParameter
   {
   private:
     unsigned long wayIndexCacheSize;
-    unsigned long wayCacheSize;
+    unsigned long wayCacheSizeBytes; //! Memory in bytes
+    unsigned long matrixCacheSize;   //! Memory in bytes for route nodes shared by the searches of a matrix
+
+    OpenListType  openListType;
+    bool          useRouteGraph;
 
     bool          debugPerformance;
 
@@ -68,12 +92,20 @@ namespace osmscout {
     RouterParameter();
 
     void SetWayIndexCacheSize(unsigned long wayIndexCacheSize);
-    void SetWayCacheSize(unsigned long wayCacheSize);
+    void SetWayCacheSizeBytes(unsigned long wayCacheSizeBytes);
+    void SetMatrixCacheSize(unsigned long matrixCacheSize);
+
+    void SetOpenListType(OpenListType openListType);
+    void SetUseRouteGraph(bool useRouteGraph);
 
     void SetDebugPerformance(bool debug);
 
     unsigned long GetWayIndexCacheSize() const;
-    unsigned long GetWayCacheSize() const;
+    unsigned long GetWayCacheSizeBytes() const;
+    unsigned long GetMatrixCacheSize() const;
+
+    OpenListType GetOpenListType() const;
+    bool GetUseRouteGraph() const;
 
     bool IsDebugPerformance() const;
   };
@@ -84,8 +116,11 @@ namespace osmscout {
     /**
      * A path in the routing graph from one node to the next (expressed via the target object)
      * with additional information as required by the A* algorithm.
+     *
+     * RNodes are stored by value in a pool owned by the router, that is reused
+     * for each route calculation.
      */
-    struct RNode : public Referencable
+    struct RNode
     {
       FileOffset    nodeOffset;    //! The file offset of the current route node
       FileOffset    prev;          //! The file offset of the previous route node
@@ -96,9 +131,16 @@ namespace osmscout {
       double        overallCost;   //! The overall costs (currentCost+estimateCost)
 
       bool          access;        //! Flags to signal, if we had access ("access restrictions") to this node
+      bool          closed;        //! The node has been taken from the open list
 
       RNode()
-      : nodeOffset(0)
+      : nodeOffset(0),
+        prev(0),
+        currentCost(0),
+        estimateCost(0),
+        overallCost(0),
+        access(true),
+        closed(false)
       {
         // no code
       }
@@ -111,7 +153,8 @@ namespace osmscout {
         currentCost(0),
         estimateCost(0),
         overallCost(0),
-        access(true)
+        access(true),
+        closed(false)
       {
         // no code
       }
@@ -125,7 +168,8 @@ namespace osmscout {
         currentCost(0),
         estimateCost(0),
         overallCost(0),
-        access(true)
+        access(true),
+        closed(false)
       {
         // no code
       }
@@ -141,26 +185,134 @@ namespace osmscout {
       }
     };
 
-    typedef Ref<RNode> RNodeRef;
+    typedef OSMSCOUT_HASHMAP<FileOffset,size_t> RNodeMap;   //! Index into the RNode pool by file offset
 
-    struct RNodeCostCompare
+    /**
+      Some statistics of a route calculation for performance debugging
+      */
+    struct RouteStatistics
     {
-      inline bool operator()(const RNodeRef& a, const RNodeRef& b) const
+      size_t nodesLoadedCount;
+      size_t nodesIgnoredCount;
+      size_t maxOpenList;
+
+      RouteStatistics()
+      : nodesLoadedCount(0),
+        nodesIgnoredCount(0),
+        maxOpenList(0)
       {
-        if (a->overallCost==b->overallCost) {
-         return a->nodeOffset<b->nodeOffset;
-        }
-        else {
-          return a->overallCost<b->overallCost;
-        }
+        // no code
       }
     };
 
-    typedef std::set<RNodeRef,RNodeCostCompare>              OpenList;
-    typedef std::set<RNodeRef,RNodeCostCompare>::iterator    OpenListRef;
+    /**
+      State of one direction of the search in the contraction hierarchy. The vectors
+      are indexed by the node index of the contraction hierarchy and are reset
+      (using the list of touched nodes) for each route calculation.
+      */
+    struct CHSearch
+    {
+      std::vector<uint64_t> costs;    //! Costs from the origin, or noCosts
+      std::vector<uint32_t> prev;     //! Previous node on the path, or noNode for an origin
+      std::vector<uint32_t> touched;  //! Nodes with costs
+      DAryHeap<4>           heap;     //! Open list
+    };
+
+    static const uint64_t noCosts;
+
+    /**
+      State of a route calculation in the compact routing graph. The vectors are
+      indexed by the node index of the graph, allocated once when the graph is
+      opened and reset (using the list of touched nodes) for each route calculation.
+      */
+    struct GraphSearch
+    {
+      std::vector<double>   costs;    //! Costs from the start, valid for touched nodes
+      std::vector<uint32_t> prev;     //! Previous node on the path, or noNode for a start node
+      std::vector<uint32_t> object;   //! Object of the edge leading to the node, or noObject for a start node
+      std::vector<uint8_t>  state;    //! Combination of the graphNode* flags
+      std::vector<uint32_t> touched;  //! Nodes with costs
+    };
 
-    typedef OSMSCOUT_HASHMAP<FileOffset,Router::OpenListRef> OpenMap;
-    typedef OSMSCOUT_HASHMAP<FileOffset,Router::RNodeRef>    CloseMap;
+    static const uint8_t graphNodeTouched = 1 << 0; //! The node has costs
+    static const uint8_t graphNodeClosed  = 1 << 1; //! The node has been taken from the open list
+    static const uint8_t graphNodeAccess  = 1 << 2; //! We had access to the node
+
+    /**
+      A path of the routing graph, as seen from the route node it leads to.
+      */
+    struct IncomingPath
+    {
+      FileOffset source;    //! File offset of the route node the path starts at
+      uint32_t   pathIndex; //! Index of the path in the source route node
+    };
+
+    /**
+      A route node of the routing graph together with the range of its
+      incoming paths in the list of all incoming paths.
+      */
+    struct IncomingNode
+    {
+      FileOffset offset;    //! File offset of the route node
+      double     lat;       //! Latitude of the route node
+      double     lon;       //! Longitude of the route node
+      uint32_t   firstPath; //! Index of the first incoming path
+      uint32_t   lastPath;  //! Index after the last incoming path
+
+      inline bool operator<(FileOffset other) const
+      {
+        return offset<other;
+      }
+    };
+
+    /**
+      A route node next to a source or target of a matrix calculation, together
+      with the costs and the time between the route node and the position.
+      */
+    struct MatrixNode
+    {
+      FileOffset offset;
+      double     costs;
+      double     time;
+    };
+
+    /**
+      A target of a matrix calculation next to a route node, together with the
+      costs and the time from the route node to the target position.
+      */
+    struct MatrixTarget
+    {
+      size_t     target;
+      double     costs;
+      double     time;
+    };
+
+    typedef OSMSCOUT_HASHMAP<FileOffset,std::vector<MatrixTarget> > MatrixTargetMap; //! Targets by route node
+
+    /**
+      State of a matrix calculation shared by all threads working on it.
+      */
+    struct MatrixJob
+    {
+      const RoutingProfile*                     profile;
+      std::vector<std::vector<MatrixNode> >     sources;     //! Route nodes by source
+      MatrixTargetMap                           targets;     //! Targets by route node
+      size_t                                    targetCount;
+      RouteMatrix*                              matrix;
+
+      Mutex                                     mutex;       //! Guards all following members
+      size_t                                    nextSource;  //! Next source (row) to calculate
+      bool                                      success;
+      RouteStatistics                           statistics;
+
+      ObjectCache<FileOffset,RouteNodeRef>      routeNodes;  //! Route nodes loaded by any search, internally synchronized
+
+      MatrixJob(unsigned long routeNodeCacheSize)
+      : routeNodes(routeNodeCacheSize)
+      {
+        // no code
+      }
+    };
 
   public:
     static const char* const FILENAME_INTERSECTIONS_DAT;
@@ -175,6 +327,14 @@ namespace osmscout {
     static const char* const FILENAME_CAR_DAT;
     static const char* const FILENAME_CAR_IDX;
 
+    static const char* const FILENAME_FOOT_CH_DAT;
+    static const char* const FILENAME_BICYCLE_CH_DAT;
+    static const char* const FILENAME_CAR_CH_DAT;
+
+    static const char* const FILENAME_FOOT_GRAPH_DAT;
+    static const char* const FILENAME_BICYCLE_GRAPH_DAT;
+    static const char* const FILENAME_CAR_GRAPH_DAT;
+
   private:
     Vehicle                              vehicle;           //! We are a router for this vehicle
     bool                                 isOpen;            //! true, if opened
@@ -189,9 +349,33 @@ namespace osmscout {
 
     TypeConfig                           *typeConfig;       //! Type config for the currently opened map
 
+    OpenListType                         openListType;      //! Priority queue to use for the open list
+    bool                                 useRouteGraph;     //! Use the compact routing graph, if available
+    unsigned long                        matrixCacheSize;   //! Memory in bytes for the route nodes of a matrix calculation
+    std::vector<RNode>                   rnodes;            //! Pool of RNodes, reset for each route calculation
+    RNodeMap                             rnodeMap;          //! Index of all nodes in the pool
+    DAryHeap<4>                          heap;              //! Open list for openListHeap
+    RadixHeap                            radixHeap;         //! Open list for openListRadixHeap
+
+    ContractionHierarchy                 ch;                //! Contraction hierarchy, if available
+    CHSearch                             chForward;         //! Forward search in the contraction hierarchy
+    CHSearch                             chBackward;        //! Backward search in the contraction hierarchy
+
+    RouteGraph                           graph;             //! Compact routing graph, if available
+    GraphSearch                          graphSearch;       //! Search in the compact routing graph
+
+    std::vector<IncomingNode>            incomingNodes;     //! Route nodes with incoming paths, sorted by file offset
+    std::vector<IncomingPath>            incomingPaths;     //! Incoming paths of all route nodes
+    std::vector<RNode>                   backwardRNodes;    //! Pool of RNodes of the backward search
+    RNodeMap                             backwardRNodeMap;  //! Index of all nodes in the backward pool
+    DAryHeap<4>                          backwardHeap;      //! Backward open list for openListHeap
+    RadixHeap                            backwardRadixHeap; //! Backward open list for openListRadixHeap
+
   private:
     std::string GetDataFilename(Vehicle vehicle) const;
     std::string GetIndexFilename(Vehicle vehicle) const;
+    std::string GetCHFilename(Vehicle vehicle) const;
+    std::string GetGraphFilename(Vehicle vehicle) const;
 
     void GetClosestForwardRouteNode(const WayRef& way,
                                     size_t nodeIndex,
@@ -205,25 +389,130 @@ namespace osmscout {
     bool GetStartNodes(const RoutingProfile& profile,
                        const ObjectFileRef& object,
                        size_t nodeIndex,
+                       double& startLon,
+                       double& startLat,
                        double& targetLon,
                        double& targetLat,
                        RouteNodeRef& forwardRouteNode,
                        RouteNodeRef& backwardRouteNode,
-                       RNodeRef& forwardRNode,
-                       RNodeRef& backwardRNode);
+                       RNode& forwardRNode,
+                       RNode& backwardRNode);
 
-    bool GetTargetNodes(const ObjectFileRef& object,
+    bool GetTargetNodes(const RoutingProfile& profile,
+                        const ObjectFileRef& object,
                         size_t nodeIndex,
                         double& targetLon,
                         double& targetLat,
                         RouteNodeRef& forwardNode,
-                        RouteNodeRef& backwardNode);
-
-    void ResolveRNodeChainToList(const RNodeRef& end,
-                                 const CloseMap& closeMap,
-                                 std::list<RNodeRef>& nodes);
+                        RouteNodeRef& backwardNode,
+                        double& forwardCosts,
+                        double& backwardCosts);
+
+    void AddStartRNode(const RNode& node);
+
+    template<class OpenList>
+    bool SearchRoute(const RoutingProfile& profile,
+                     double targetLon,
+                     double targetLat,
+                     const RouteNodeRef& targetForwardRouteNode,
+                     const RouteNodeRef& targetBackwardRouteNode,
+                     OpenList& openList,
+                     size_t& current,
+                     RouteNodeRef& currentRouteNode,
+                     RouteStatistics& statistics);
+
+    void ResetGraphSearch();
+    void AddGraphStartNode(const RNode& node,
+                           uint32_t startObject);
+    template<class OpenList>
+    bool SearchRouteGraph(const RoutingProfile& profile,
+                          double startLon,
+                          double startLat,
+                          double targetLon,
+                          double targetLat,
+                          uint32_t targetForwardNode,
+                          uint32_t targetBackwardNode,
+                          OpenList& openList,
+                          uint32_t& current,
+                          RouteStatistics& statistics);
+    void ResolveGraphNodeChainToList(uint32_t end,
+                                     const ObjectFileRef& startObject,
+                                     std::list<RNode>& nodes) const;
+    bool CalculateRouteGraph(const RoutingProfile& profile,
+                             const ObjectFileRef& startObject,
+                             size_t startNodeIndex,
+                             const ObjectFileRef& targetObject,
+                             size_t targetNodeIndex,
+                             RouteData& route);
+
+    bool LoadIncomingPaths();
+    const IncomingNode* GetIncomingNode(FileOffset offset) const;
+    void AddBackwardRNode(const RNode& node);
+    bool IsValidJoin(const RouteNode& routeNode,
+                     const RNode& forwardNode,
+                     const RNode& backwardNode) const;
+    void UpdateBestJoin(const RouteNode& routeNode,
+                        size_t forwardIndex,
+                        size_t backwardIndex,
+                        double& bestCosts,
+                        size_t& bestForward,
+                        size_t& bestBackward) const;
+
+    template<class OpenList>
+    bool SearchRouteBidirectional(const RoutingProfile& profile,
+                                  double startLon,
+                                  double startLat,
+                                  double targetLon,
+                                  double targetLat,
+                                  OpenList& forwardOpenList,
+                                  OpenList& backwardOpenList,
+                                  double& bestCosts,
+                                  size_t& bestForward,
+                                  size_t& bestBackward,
+                                  RouteStatistics& statistics);
+
+    bool GetMatrixNodes(const RoutingProfile& profile,
+                        const RoutePosition& position,
+                        std::vector<MatrixNode>& nodes);
+    bool GetMatrixRouteNode(MatrixJob& job,
+                            FileOffset offset,
+                            RouteNodeRef& routeNode);
+    bool SearchMatrixRow(MatrixJob& job,
+                         size_t source,
+                         std::vector<RNode>& nodes,
+                         RNodeMap& nodeMap,
+                         std::vector<double>& times,
+                         DAryHeap<4>& openList,
+                         DAryHeap<4>& targetList,
+                         RouteStatistics& statistics);
+    void CalculateMatrixRows(MatrixJob& job);
+
+    void ResetCHSearch(CHSearch& search);
+    void AddCHOrigin(CHSearch& search,
+                     uint32_t node,
+                     uint64_t costs);
+    bool IsCHNodeStalled(const CHSearch& search,
+                         uint32_t node,
+                         bool forward) const;
+    void SettleCHNode(CHSearch& search,
+                      const CHSearch& otherSearch,
+                      bool forward,
+                      uint64_t& bestCosts,
+                      uint32_t& meetingNode,
+                      RouteStatistics& statistics);
+    bool GetCHEdge(uint32_t from,
+                   uint32_t to,
+                   bool forward,
+                   ContractionHierarchy::Edge& edge) const;
+    bool UnpackCHEdge(uint32_t from,
+                      uint32_t to,
+                      const ContractionHierarchy::Edge& edge,
+                      std::list<RNode>& nodes);
+
+    void ResolveRNodeChainToList(size_t end,
+                                 std::list<RNode>& nodes);
     bool ResolveRNodesToRouteData(const RoutingProfile& profile,
-                                  const std::list<RNodeRef>& nodes,
+                                  const std::list<RNode>& nodes,
                                   const ObjectFileRef& startObject,
                                   size_t startNodeIndex,
                                   const ObjectFileRef& targetObject,
@@ -262,6 +551,30 @@ namespace osmscout {
                         size_t targetNodeIndex,
                         RouteData& route);
 
+    bool CalculateRouteBidirectional(const RoutingProfile& profile,
+                                     const ObjectFileRef& startObject,
+                                     size_t startNodeIndex,
+                                     const ObjectFileRef& targetObject,
+                                     size_t targetNodeIndex,
+                                     RouteData& route);
+
+    bool CalculateMatrix(const RoutingProfile& profile,
+                         const std::vector<RoutePosition>& sources,
+                         const std::vector<RoutePosition>& targets,
+                         RouteMatrix& matrix,
+                         size_t threadCount=1);
+
+    bool HasRouteGraph() const;
+
+    bool HasContractionHierarchy() const;
+
+    bool CalculateRouteCH(const RoutingProfile& profile,
+                          const ObjectFileRef& startObject,
+                          size_t startNodeIndex,
+                          const ObjectFileRef& targetObject,
+                          size_t targetNodeIndex,
+                          RouteData& route);
+
     bool TransformRouteDataToWay(const RouteData& data,
                                  Way& way);
 
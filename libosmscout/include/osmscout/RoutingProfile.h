@@ -42,6 +42,7 @@ namespace osmscout {
   public:
     virtual ~RoutingProfile();
 
+    virtual bool CanUse(const RouteNode::Path& path) const = 0;
     virtual bool CanUse(const RouteNode& currentNode,
                         size_t pathIndex) const = 0;
     virtual bool CanUse(const Area& area) const = 0;
@@ -49,6 +50,7 @@ namespace osmscout {
     virtual bool CanUseForward(const Way& way) const = 0;
     virtual bool CanUseBackward(const Way& way) const = 0;
 
+    virtual double GetCosts(const RouteNode::Path& path) const = 0;
     virtual double GetCosts(const RouteNode& currentNode,
                             size_t pathIndex) const = 0;
     virtual double GetCosts(const Area& area,
@@ -57,6 +59,9 @@ namespace osmscout {
                             double distance) const = 0;
     virtual double GetCosts(double distance) const = 0;
 
+    virtual double GetTime(const RouteNode::Path& path) const = 0;
+    virtual double GetTime(const RouteNode& currentNode,
+                           size_t pathIndex) const = 0;
     virtual double GetTime(const Area& area,
                            double distance) const = 0;
     virtual double GetTime(const Way& way,
@@ -95,18 +100,34 @@ namespace osmscout {
       return vehicle;
     }
 
+    inline double GetVehicleMaxSpeed() const
+    {
+      return vehicleMaxSpeed;
+    }
+
+    /**
+     * Return the speed by type id (0.0 for types that cannot be used)
+     */
+    inline const std::vector<double>& GetSpeeds() const
+    {
+      return speeds;
+    }
+
     void AddType(TypeId type, double speed);
 
-    inline bool CanUse(const RouteNode& currentNode,
-                       size_t pathIndex) const
+    inline bool CanUse(const RouteNode::Path& path) const
     {
-      if (!(currentNode.paths[pathIndex].flags & vehicleRouteNodeBit)) {
+      if (!(path.flags & vehicleRouteNodeBit)) {
         return false;
       }
 
-      TypeId type=currentNode.paths[pathIndex].type;
+      return path.type<speeds.size() && speeds[path.type]>0.0;
+    }
 
-      return type<speeds.size() && speeds[type]>0.0;
+    inline bool CanUse(const RouteNode& currentNode,
+                       size_t pathIndex) const
+    {
+      return CanUse(currentNode.paths[pathIndex]);
     }
 
     inline bool CanUse(const Area& area) const
@@ -189,6 +210,28 @@ namespace osmscout {
       return false;
     }
 
+    inline double GetTime(const RouteNode::Path& path) const
+    {
+      double speed;
+
+      if (path.maxSpeed>0) {
+        speed=path.maxSpeed;
+      }
+      else {
+        speed=speeds[path.type];
+      }
+
+      speed=std::min(vehicleMaxSpeed,speed);
+
+      return path.distance/speed;
+    }
+
+    inline double GetTime(const RouteNode& currentNode,
+                          size_t pathIndex) const
+    {
+      return GetTime(currentNode.paths[pathIndex]);
+    }
+
     inline double GetTime(const Area& area,
                           double distance) const
     {
@@ -223,6 +266,11 @@ namespace osmscout {
   class OSMSCOUT_API ShortestPathRoutingProfile : public AbstractRoutingProfile
   {
   public:
+    inline double GetCosts(const RouteNode::Path& path) const
+    {
+      return path.distance;
+    }
+
     inline double GetCosts(const RouteNode& currentNode,
                            size_t pathIndex) const
     {
@@ -254,21 +302,26 @@ namespace osmscout {
   class OSMSCOUT_API FastestPathRoutingProfile : public AbstractRoutingProfile
   {
   public:
-    inline double GetCosts(const RouteNode& currentNode,
-                           size_t pathIndex) const
+    inline double GetCosts(const RouteNode::Path& path) const
     {
       double speed;
 
-      if (currentNode.paths[pathIndex].maxSpeed>0) {
-        speed=currentNode.paths[pathIndex].maxSpeed;
+      if (path.maxSpeed>0) {
+        speed=path.maxSpeed;
       }
       else {
-        speed=speeds[currentNode.paths[pathIndex].type];
+        speed=speeds[path.type];
       }
 
       speed=std::min(vehicleMaxSpeed,speed);
 
-      return currentNode.paths[pathIndex].distance/speed;
+      return path.distance/speed;
+    }
+
+    inline double GetCosts(const RouteNode& currentNode,
+                           size_t pathIndex) const
+    {
+      return GetCosts(currentNode.paths[pathIndex]);
     }
 
     inline double GetCosts(const Area& area,
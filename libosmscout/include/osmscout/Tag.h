@@ -20,7 +20,9 @@
   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
 */
 
+#include <cstring>
 #include <string>
+#include <vector>
 
 #include <osmscout/private/CoreImportExport.h>
 
@@ -47,6 +49,137 @@ namespace osmscout {
       // no code
     }
   };
+
+  /**
+    A tag, where the value is not copied but references a string stored
+    elsewhere (for example in the string table of a PBF block).
+    */
+  struct OSMSCOUT_API TagRef
+  {
+    TagId       key;
+    const char* value;
+    size_t      length;
+
+    inline std::string GetValue() const
+    {
+      return std::string(value,length);
+    }
+
+    inline bool operator==(const std::string& other) const
+    {
+      return length==other.length() &&
+             memcmp(value,other.data(),length)==0;
+    }
+
+    inline bool operator==(const char* other) const
+    {
+      return strncmp(value,other,length)==0 &&
+             other[length]=='\0';
+    }
+
+    inline bool operator!=(const std::string& other) const
+    {
+      return !(*this==other);
+    }
+
+    inline bool operator!=(const char* other) const
+    {
+      return !(*this==other);
+    }
+  };
+
+  /**
+    Read only view of the tags of one object, sorted by tag id with each
+    tag id at most once. Used during import instead of a
+    std::map<TagId,std::string>, so evaluating the tags of an object does
+    not require any allocation.
+    */
+  class OSMSCOUT_API TagView
+  {
+  private:
+    const TagRef* tagsBegin;
+    const TagRef* tagsEnd;
+
+  public:
+    inline TagView()
+    : tagsBegin(NULL),
+      tagsEnd(NULL)
+    {
+      // no code
+    }
+
+    inline TagView(const TagRef* begin,
+                   const TagRef* end)
+    : tagsBegin(begin),
+      tagsEnd(end)
+    {
+      // no code
+    }
+
+    inline bool empty() const
+    {
+      return tagsBegin==tagsEnd;
+    }
+
+    inline size_t size() const
+    {
+      return tagsEnd-tagsBegin;
+    }
+
+    inline const TagRef* begin() const
+    {
+      return tagsBegin;
+    }
+
+    inline const TagRef* end() const
+    {
+      return tagsEnd;
+    }
+
+    const TagRef* Find(TagId key) const;
+  };
+
+  /**
+    Storage for the tags of a number of objects. The tags of an object are
+    added one after the other and then sorted using SortTags(). Tag values
+    are not copied, the strings must stay valid as long as views are used.
+
+    Views must only be requested after all tags have been added, since
+    adding tags may move the storage.
+    */
+  class OSMSCOUT_API TagBuffer
+  {
+  private:
+    std::vector<TagRef> tags;
+
+  public:
+    inline void Clear()
+    {
+      tags.clear();
+    }
+
+    inline size_t GetSize() const
+    {
+      return tags.size();
+    }
+
+    inline void AddTag(TagId key,
+                       const std::string& value)
+    {
+      AddTag(key,
+             value.data(),
+             value.length());
+    }
+
+    void AddTag(TagId key,
+                const char* value,
+                size_t length);
+
+    size_t SortTags(size_t start);
+
+    TagView GetView(size_t start,
+                    size_t end) const;
+  };
 }
 
 #endif
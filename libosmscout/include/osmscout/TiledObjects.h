@@ -0,0 +1,178 @@
+#ifndef OSMSCOUT_TILEDOBJECTS_H
+#define OSMSCOUT_TILEDOBJECTS_H
+
+/*
+  This source is part of the libosmscout library
+  Copyright (C) 2013  Tim Teulings
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+#include <vector>
+
+#include <osmscout/Area.h>
+#include <osmscout/Node.h>
+#include <osmscout/Way.h>
+
+#include <osmscout/private/CoreImportExport.h>
+
+#include <osmscout/system/Types.h>
+
+namespace osmscout {
+
+  /**
+    The objects of a rectangular block of slippy map tiles (see
+    http://wiki.openstreetmap.org/wiki/Slippy_map_tilenames), loaded once
+    (see Database::GetObjectsForTiles()) and assigned to the tiles
+    they are relevant for.
+
+    Like a single tile query for drawing, a tile gets
+
+    * all ways intersecting the tile,
+    * all nodes and areas intersecting the tile or one of its eight
+      neighbours, so that labels crossing the tile border are drawn
+      consistently.
+
+    The objects are stored once, each tile holds a list of indexes into the
+    object lists (in the order the objects were loaded).
+    */
+  class OSMSCOUT_API TiledObjects
+  {
+  private:
+    /**
+      Object indexes by tile, in the order of the tiles (line by line)
+      */
+    struct Buckets
+    {
+      std::vector<uint32_t> start;   //! Index of the first entry by tile (+1 entry)
+      std::vector<uint32_t> entries; //! Object indexes
+    };
+
+    /**
+      The range of tiles an object is assigned to
+      */
+    struct TileRange
+    {
+      size_t xStart;
+      size_t yStart;
+      size_t xEnd;
+      size_t yEnd;
+    };
+
+  private:
+    size_t               zoom;
+    size_t               xStart;
+    size_t               yStart;
+    size_t               xCount;
+    size_t               yCount;
+
+    std::vector<NodeRef> nodes;
+    std::vector<WayRef>  ways;
+    std::vector<AreaRef> areas;
+
+    Buckets              nodeBuckets;
+    Buckets              wayBuckets;
+    Buckets              areaBuckets;
+
+  private:
+    bool GetTileRange(double minLon,
+                      double maxLon,
+                      double minLat,
+                      double maxLat,
+                      size_t border,
+                      TileRange& range) const;
+    void FillBuckets(const std::vector<TileRange>& ranges,
+                     const std::vector<bool>& valid,
+                     Buckets& buckets) const;
+
+  public:
+    TiledObjects();
+
+    void Clear();
+
+    void Set(size_t zoom,
+             size_t xStart,
+             size_t yStart,
+             size_t xEnd,
+             size_t yEnd,
+             std::vector<NodeRef>& nodes,
+             std::vector<WayRef>& ways,
+             std::vector<AreaRef>& areas);
+
+    inline size_t GetZoom() const
+    {
+      return zoom;
+    }
+
+    inline size_t GetXStart() const
+    {
+      return xStart;
+    }
+
+    inline size_t GetYStart() const
+    {
+      return yStart;
+    }
+
+    inline size_t GetXEnd() const
+    {
+      return xStart+xCount-1;
+    }
+
+    inline size_t GetYEnd() const
+    {
+      return yStart+yCount-1;
+    }
+
+    inline bool IsInRange(size_t x,
+                          size_t y) const
+    {
+      return x>=xStart && x<xStart+xCount &&
+             y>=yStart && y<yStart+yCount;
+    }
+
+    inline const std::vector<NodeRef>& GetNodes() const
+    {
+      return nodes;
+    }
+
+    inline const std::vector<WayRef>& GetWays() const
+    {
+      return ways;
+    }
+
+    inline const std::vector<AreaRef>& GetAreas() const
+    {
+      return areas;
+    }
+
+    void GetTileObjects(size_t x,
+                        size_t y,
+                        std::vector<NodeRef>& nodes,
+                        std::vector<WayRef>& ways,
+                        std::vector<AreaRef>& areas) const;
+
+    static size_t GetTileX(double lon,
+                           size_t zoom);
+    static size_t GetTileY(double lat,
+                           size_t zoom);
+    static double GetTileLon(size_t x,
+                             size_t zoom);
+    static double GetTileLat(size_t y,
+                             size_t zoom);
+  };
+}
+
+#endif
@@ -45,7 +45,7 @@ namespace osmscout {
   public:
     virtual ~TagCondition();
 
-    virtual bool Evaluate(const std::map<TagId,std::string>& tagMap) const = 0;
+    virtual bool Evaluate(const TagView& tags) const = 0;
   };
 
   typedef Ref<TagCondition> TagConditionRef;
@@ -58,7 +58,7 @@ namespace osmscout {
   public:
     TagNotCondition(TagCondition* condition);
 
-    bool Evaluate(const std::map<TagId,std::string>& tagMap) const;
+    bool Evaluate(const TagView& tags) const;
   };
 
   class OSMSCOUT_API TagBoolCondition : public TagCondition
@@ -78,7 +78,7 @@ namespace osmscout {
 
     void AddCondition(TagCondition* condition);
 
-    bool Evaluate(const std::map<TagId,std::string>& tagMap) const;
+    bool Evaluate(const TagView& tags) const;
   };
 
   class OSMSCOUT_API TagExistsCondition : public TagCondition
@@ -89,7 +89,7 @@ namespace osmscout {
   public:
     TagExistsCondition(TagId tag);
 
-    bool Evaluate(const std::map<TagId,std::string>& tagMap) const;
+    bool Evaluate(const TagView& tags) const;
   };
 
   class OSMSCOUT_API TagBinaryCondition : public TagCondition
@@ -104,21 +104,21 @@ namespace osmscout {
                        BinaryOperator binaryOperator,
                        const std::string& tagValue);
 
-    bool Evaluate(const std::map<TagId,std::string>& tagMap) const;
+    bool Evaluate(const TagView& tags) const;
   };
 
   class OSMSCOUT_API TagIsInCondition : public TagCondition
   {
   private:
     TagId                 tag;
-    std::set<std::string> tagValues;
+    std::vector<std::string> tagValues; //! Sorted
 
   public:
     TagIsInCondition(TagId tag);
 
     void AddTagValue(const std::string& tagValue);
 
-    bool Evaluate(const std::map<TagId,std::string>& tagMap) const;
+    bool Evaluate(const TagView& tags) const;
   };
 
   class OSMSCOUT_API TagInfo
@@ -527,18 +527,18 @@ namespace osmscout {
     const TagInfo& GetTagInfo(TagId id) const;
     const TypeInfo& GetTypeInfo(TypeId id) const;
 
-    void ResolveTags(const std::map<TagId,std::string>& map,
+    void ResolveTags(const TagView& view,
                      std::vector<Tag>& tags) const;
 
     bool IsNameTag(TagId tag, uint32_t& priority) const;
     bool IsNameAltTag(TagId tag, uint32_t& priority) const;
 
-    bool GetNodeTypeId(const std::map<TagId,std::string>& tagMap,
+    bool GetNodeTypeId(const TagView& tags,
                        TypeId &typeId) const;
-    bool GetWayAreaTypeId(const std::map<TagId,std::string>& tagMap,
+    bool GetWayAreaTypeId(const TagView& tags,
                           TypeId &wayType,
                           TypeId &areaType) const;
-    bool GetRelationTypeId(const std::map<TagId,std::string>& tagMap,
+    bool GetRelationTypeId(const TagView& tags,
                            TypeId &typeId) const;
 
     TypeId GetTypeId(const std::string& name) const;
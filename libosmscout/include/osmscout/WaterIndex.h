@@ -28,6 +28,7 @@
 #include <osmscout/Types.h>
 
 #include <osmscout/util/FileScanner.h>
+#include <osmscout/util/FileScannerPool.h>
 #include <osmscout/util/Magnification.h>
 
 namespace osmscout {
@@ -55,7 +56,7 @@ namespace osmscout {
   private:
     std::string                filepart;       //! name of the data file
     std::string                datafilename;   //! Fullpath and name of the data file
-    mutable FileScanner        scanner;        //! Scanner instance for reading this file
+    mutable FileScannerPool    scannerPool;    //! Scanner instances for reading this file
 
     uint32_t                   waterIndexMinMag;
     uint32_t                   waterIndexMaxMag;
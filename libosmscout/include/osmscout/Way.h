@@ -70,6 +70,8 @@ namespace osmscout {
     uint8_t          grade;    //! Quality of road/track 1 (good)...5 (bad)
     std::vector<Tag> tags;     //! list of preparsed tags
 
+    friend class WayView;
+
   public:
     inline WayAttributes()
     : type(typeIgnore),
@@ -182,6 +184,8 @@ namespace osmscout {
     bool Read(FileScanner& scanner);
     bool Write(FileWriter& writer) const;
 
+    unsigned long GetMemorySize() const;
+
     bool operator==(const WayAttributes& other) const;
     bool operator!=(const WayAttributes& other) const;
   };
@@ -326,6 +330,8 @@ namespace osmscout {
 
     void SetLayerToMax();
 
+    unsigned long GetMemorySize() const;
+
     bool Read(FileScanner& scanner);
     bool ReadOptimized(FileScanner& scanner);
 
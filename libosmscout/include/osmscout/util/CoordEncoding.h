@@ -0,0 +1,90 @@
+#ifndef OSMSCOUT_UTIL_COORDENCODING_H
+#define OSMSCOUT_UTIL_COORDENCODING_H
+
+/*
+  This source is part of the libosmscout library
+  Copyright (C) 2013  Tim Teulings
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+#include <vector>
+
+#include <osmscout/private/CoreImportExport.h>
+
+#include <osmscout/GeoCoord.h>
+#include <osmscout/Types.h>
+
+namespace osmscout {
+
+  /**
+    Encoding of a sequence of coordinates (the nodes of a way or an area
+    ring) as deltas.
+
+    Coordinates are quantized using conversionFactor. The first coordinate
+    is stored as two uint32 values, with coordDeltaEncodingFlag set in the
+    latitude value. Since a quantized latitude never uses the highest bit,
+    this distinguishes the encoding from the older encoding (two uint32
+    values for the minimum latitude and longitude followed by a varint
+    pair per node relative to it).
+
+    The following coordinates are stored as the differences to their
+    predecessor, latitude and longitude alternating, zigzag encoded and
+    grouped in the stream-vbyte format: A control byte holds the byte
+    length (1 to 4) of four values (2 bits per value, starting with the
+    lowest bits), followed by the data bytes of all values. All control
+    bytes are stored in front of the data bytes.
+
+    Decoding of four values at once uses SSSE3 if available.
+    */
+
+  /**
+    Flag set in the latitude of the first coordinate
+    */
+  extern OSMSCOUT_API const uint32_t coordDeltaEncodingFlag;
+
+  /**
+    Number of bytes behind the data bytes, that must be readable by
+    DecodeCoordDeltas()
+    */
+  extern OSMSCOUT_API const size_t coordDeltaPadding;
+
+  /**
+    Return the number of control bytes for the given number of coordinates
+    */
+  inline size_t GetCoordDeltaControlSize(size_t coordCount)
+  {
+    if (coordCount<=1) {
+      return 0;
+    }
+
+    return ((coordCount-1)*2+3)/4;
+  }
+
+  extern OSMSCOUT_API size_t GetCoordDeltaDataSize(const unsigned char* control,
+                                                   size_t coordCount);
+
+  extern OSMSCOUT_API void EncodeCoords(const std::vector<GeoCoord>& coords,
+                                        std::vector<unsigned char>& buffer);
+
+  extern OSMSCOUT_API void DecodeCoordDeltas(uint32_t latValue,
+                                             uint32_t lonValue,
+                                             const unsigned char* control,
+                                             const unsigned char* data,
+                                             size_t coordCount,
+                                             std::vector<GeoCoord>& coords);
+}
+
+#endif
@@ -45,6 +45,12 @@ namespace osmscout {
   extern OSMSCOUT_API bool RenameFile(const std::string& oldFilename,
                                       const std::string& newFilename);
 
+  /**
+   * Create the given directory, if it does not already exist. Parent
+   * directories are not created.
+   */
+  extern OSMSCOUT_API bool MakeDirectory(const std::string& directory);
+
   /**
    * Append the filename 'name' to the directory name 'name' correctly adding directory
    * delimiter if necessary.
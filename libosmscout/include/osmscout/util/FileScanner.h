@@ -22,6 +22,7 @@
 
 #include <cstdio>
 #include <string>
+#include <vector>
 
 #include <osmscout/CoreFeatures.h>
 
@@ -66,6 +67,8 @@ namespace osmscout {
     FileOffset   size;
     FileOffset   offset;
 
+    std::vector<unsigned char> coordBuffer; //! Buffer for reading coordinate sequences
+
     // For Windows mmap usage
 #if defined(__WIN32__) || defined(WIN32)
     HANDLE       mmfHandle;
@@ -97,6 +100,23 @@ namespace osmscout {
 
     std::string GetFilename() const;
 
+    /**
+      Returns the start of the memory mapped file or NULL, if the file
+      is not memory mapped.
+      */
+    inline const char* GetMappedBuffer() const
+    {
+      return buffer;
+    }
+
+    /**
+      Returns the size of the file, if the file is memory mapped.
+      */
+    inline FileOffset GetSize() const
+    {
+      return size;
+    }
+
     bool GotoBegin();
     bool SetPos(FileOffset pos);
     bool GetPos(FileOffset &pos) const;
@@ -138,6 +158,8 @@ namespace osmscout {
 #endif
 
     bool ReadCoord(GeoCoord& coord);
+    bool ReadCoords(size_t count,
+                    std::vector<GeoCoord>& coords);
   };
 }
 
@@ -0,0 +1,121 @@
+#ifndef OSMSCOUT_UTIL_FILESCANNERPOOL_H
+#define OSMSCOUT_UTIL_FILESCANNERPOOL_H
+
+/*
+  This source is part of the libosmscout library
+  Copyright (C) 2013  Tim Teulings
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+#include <string>
+#include <vector>
+
+#include <osmscout/util/FileScanner.h>
+#include <osmscout/util/Mutex.h>
+
+namespace osmscout {
+
+  /**
+    FileScannerPool hands out opened FileScanner instances for one file. Every
+    caller gets its own instance with its own file position, so multiple threads
+    can read from the same file at the same time. Instances are recycled after
+    they have been released.
+
+    Using memory mapped files all instances share the same pages of the operating
+    system file cache, so the additional cost of an instance is only its address
+    space mapping.
+    */
+  class OSMSCOUT_API FileScannerPool
+  {
+  private:
+    std::string               filename; //! Name of the file to read
+    FileScanner::Mode         mode;     //! Access mode for opening the file
+    bool                      useMmap;  //! Use memory mapped file access
+    bool                      isOpen;   //! If true, the pool hands out scanners
+    Mutex                     mutex;    //! Guards access to the list of unused scanners
+    std::vector<FileScanner*> scanners; //! Opened but currently unused scanners
+
+  private:
+    FileScannerPool(const FileScannerPool& other);
+    FileScannerPool& operator=(const FileScannerPool& other);
+
+  public:
+    FileScannerPool();
+    virtual ~FileScannerPool();
+
+    bool Open(const std::string& filename,
+              FileScanner::Mode mode,
+              bool useMmap);
+    bool Close();
+
+    inline bool IsOpen() const
+    {
+      return isOpen;
+    }
+
+    std::string GetFilename() const;
+
+    FileScanner* Acquire();
+    void Release(FileScanner* scanner);
+  };
+
+  /**
+    Acquires a FileScanner from the given pool on construction and releases
+    it on destruction. Check IsValid() before accessing the scanner.
+    */
+  class OSMSCOUT_API PooledFileScanner
+  {
+  private:
+    FileScannerPool& pool;
+    FileScanner*     scanner;
+
+  private:
+    PooledFileScanner(const PooledFileScanner& other);
+    PooledFileScanner& operator=(const PooledFileScanner& other);
+
+  public:
+    inline PooledFileScanner(FileScannerPool& pool)
+    : pool(pool),
+      scanner(pool.Acquire())
+    {
+      // no code
+    }
+
+    inline ~PooledFileScanner()
+    {
+      if (scanner!=NULL) {
+        pool.Release(scanner);
+      }
+    }
+
+    inline bool IsValid() const
+    {
+      return scanner!=NULL;
+    }
+
+    inline FileScanner* operator->() const
+    {
+      return scanner;
+    }
+
+    inline FileScanner& operator*() const
+    {
+      return *scanner;
+    }
+  };
+}
+
+#endif
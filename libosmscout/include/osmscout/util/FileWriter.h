@@ -22,6 +22,7 @@
 
 #include <cstdio>
 #include <string>
+#include <vector>
 
 #include <osmscout/CoreFeatures.h>
 
@@ -33,9 +34,11 @@ namespace osmscout {
   class OSMSCOUT_API FileWriter
   {
   private:
-    std::string filename;
-    std::FILE   *file;
-    bool        hasError;
+    std::string                filename;
+    std::FILE                  *file;
+    bool                       hasError;
+    bool                       coordDeltaEncoding; //! Write coordinate sequences delta encoded
+    std::vector<unsigned char> coordBuffer; //! Buffer for writing coordinate sequences
 
   public:
     FileWriter();
@@ -55,6 +58,8 @@ namespace osmscout {
 
     std::string GetFilename() const;
 
+    void SetCoordDeltaEncoding(bool coordDeltaEncoding);
+
     bool GetPos(FileOffset &pos);
     bool SetPos(FileOffset pos);
 
@@ -96,6 +101,7 @@ namespace osmscout {
 
     bool WriteCoord(const GeoCoord& coord);
     bool WriteCoord(double lat, double lon);
+    bool WriteCoords(const std::vector<GeoCoord>& coords);
 
     bool Flush();
     bool FlushCurrentBlockWithZeros(size_t blockSize);
@@ -0,0 +1,450 @@
+#ifndef OSMSCOUT_UTIL_OBJECTCACHE_H
+#define OSMSCOUT_UTIL_OBJECTCACHE_H
+
+/*
+  This source is part of the libosmscout library
+  Copyright (C) 2013  Tim Teulings
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+#include <osmscout/CoreFeatures.h>
+
+#include <algorithm>
+#include <iostream>
+#include <list>
+#include <vector>
+
+#include <osmscout/system/Assert.h>
+#include <osmscout/system/Types.h>
+
+#include <osmscout/util/HashMap.h>
+#include <osmscout/util/Mutex.h>
+
+namespace osmscout {
+
+  /**
+    Thread safe object cache with a memory based capacity.
+
+    Template parameter class K holds the key value (must be a numerical value),
+    parameter class V holds the data class that is to be cached (normally
+    a Ref<> to a Referencable object).
+
+    * The capacity of the cache is the number of bytes used by the cached
+      values (as passed to SetEntry()) plus the administrative overhead of
+      each entry.
+    * The cache is divided into a number of shards, each shard being guarded
+      by its own mutex. Entries are distributed over the shards by a hash of
+      their key, so threads accessing different entries rarely block each other.
+    * Each shard implements a 2Q like replacement policy: New entries are placed
+      into a probation FIFO. Only entries that are requested again while being in the
+      probation list get promoted into the protected LRU list. Keys recently evicted
+      from the probation list are remembered (without their value), if they get
+      inserted again they go to the protected list directly. A single scan over
+      a large number of objects thus cannot evict the working set.
+    */
+  template <class K, class V>
+  class ObjectCache
+  {
+  private:
+    /**
+      An individual entry in the cache.
+      */
+    struct CacheEntry
+    {
+      K             key;
+      V             value;
+      unsigned long size;      //! Size of the value plus the overhead of the entry
+      bool          protect;   //! Entry is in the protected list
+
+      CacheEntry(const K& key,
+                 const V& value,
+                 unsigned long size)
+      : key(key),
+        value(value),
+        size(size),
+        protect(false)
+      {
+        // no code
+      }
+    };
+
+    typedef std::list<CacheEntry>                            EntryList;
+    typedef OSMSCOUT_HASHMAP<K,typename EntryList::iterator> EntryMap;
+    typedef std::list<K>                                     GhostList;
+    typedef OSMSCOUT_HASHMAP<K,typename GhostList::iterator> GhostMap;
+
+    /**
+      One independently locked part of the cache.
+      */
+    struct Shard
+    {
+      Mutex         mutex;
+      EntryList     probation;       //! FIFO of entries requested only once
+      EntryList     protect;         //! LRU of entries requested more than once
+      EntryMap      entries;         //! Index over both lists
+      GhostList     ghosts;          //! Keys of entries recently evicted from the probation list
+      GhostMap      ghostMap;        //! Index over the ghost keys
+      unsigned long probationMemory;
+      unsigned long protectMemory;
+      unsigned long hits;
+      unsigned long misses;
+
+      Shard()
+      : probationMemory(0),
+        protectMemory(0),
+        hits(0),
+        misses(0)
+      {
+        // no code
+      }
+    };
+
+  private:
+    unsigned long       maxMemory;
+    unsigned long       maxShardMemory;
+    unsigned long       maxProbationMemory;
+    size_t              shardBits;
+    std::vector<Shard*> shards;
+
+  private:
+    ObjectCache(const ObjectCache& other);
+    ObjectCache& operator=(const ObjectCache& other);
+
+    inline Shard& GetShard(const K& key) const
+    {
+      if (shardBits==0) {
+        return *shards[0];
+      }
+
+      // Fibonacci hashing, file offsets and ids are not evenly distributed in the lower bits
+      uint64_t hash=(uint64_t)key*0x9E3779B97F4A7C15ULL;
+
+      return *shards[(size_t)(hash >> (64-shardBits))];
+    }
+
+    static inline unsigned long GetEntryOverhead()
+    {
+      return sizeof(CacheEntry)+
+             sizeof(typename EntryMap::value_type)+
+             4*sizeof(void*);
+    }
+
+    void RememberGhost(Shard& shard,
+                       const K& key)
+    {
+      shard.ghosts.push_front(key);
+      shard.ghostMap[key]=shard.ghosts.begin();
+
+      // We remember about as many evicted keys as we hold entries
+      size_t maxGhosts=std::max(shard.entries.size(),(size_t)64);
+
+      while (shard.ghosts.size()>maxGhosts) {
+        shard.ghostMap.erase(shard.ghosts.back());
+        shard.ghosts.pop_back();
+      }
+    }
+
+    /**
+      Evict entries until the shard fits into its memory limit again. Entries
+      from the probation list are evicted first, as long as the probation list
+      is larger than its share or the protected list is empty.
+      */
+    void StripShard(Shard& shard)
+    {
+      while (shard.probationMemory+shard.protectMemory>maxShardMemory) {
+        if (!shard.probation.empty() &&
+            (shard.probationMemory>maxProbationMemory ||
+             shard.protect.empty())) {
+          CacheEntry& entry=shard.probation.back();
+
+          shard.probationMemory-=entry.size;
+          shard.entries.erase(entry.key);
+          RememberGhost(shard,entry.key);
+          shard.probation.pop_back();
+        }
+        else {
+          CacheEntry& entry=shard.protect.back();
+
+          shard.protectMemory-=entry.size;
+          shard.entries.erase(entry.key);
+          shard.protect.pop_back();
+        }
+      }
+    }
+
+  public:
+    /**
+      Create a new cache object with the given maximum memory usage (in bytes).
+      The cache will be split into 2^shardBits shards.
+      */
+    ObjectCache(unsigned long maxMemory,
+                size_t shardBits=4)
+    : maxMemory(0),
+      maxShardMemory(0),
+      maxProbationMemory(0),
+      shardBits(shardBits)
+    {
+      assert(shardBits<16);
+
+      shards.resize((size_t)1 << shardBits);
+
+      for (size_t i=0; i<shards.size(); i++) {
+        shards[i]=new Shard();
+      }
+
+      SetMaxMemory(maxMemory);
+    }
+
+    virtual ~ObjectCache()
+    {
+      for (size_t i=0; i<shards.size(); i++) {
+        delete shards[i];
+      }
+    }
+
+    /**
+     * Returns if the cache is active (maxMemory > 0)
+     */
+    inline bool IsActive() const
+    {
+      return maxMemory>0;
+    }
+
+    /**
+      Getting the value with the given key from cache.
+
+      If there is no value stored with the given key, false will be
+      returned and value will be untouched.
+
+      If there is a value with the given key, a copy of it will be returned
+      in value. The entry will be promoted to the protected list (or moved to
+      the front of the protected list, if it is already there).
+      */
+    bool GetEntry(const K& key,
+                  V& value) const
+    {
+      if (!IsActive()) {
+        return false;
+      }
+
+      Shard&      shard=GetShard(key);
+      MutexLocker locker(shard.mutex);
+
+      typename EntryMap::iterator iter=shard.entries.find(key);
+
+      if (iter==shard.entries.end()) {
+        shard.misses++;
+
+        return false;
+      }
+
+      typename EntryList::iterator entry=iter->second;
+
+      if (entry->protect) {
+        shard.protect.splice(shard.protect.begin(),shard.protect,entry);
+      }
+      else {
+        entry->protect=true;
+        shard.probationMemory-=entry->size;
+        shard.protectMemory+=entry->size;
+        shard.protect.splice(shard.protect.begin(),shard.probation,entry);
+      }
+
+      shard.hits++;
+
+      value=entry->value;
+
+      return true;
+    }
+
+    /**
+      Set or update the cache with the given value for the given key. size is the
+      size of the value in bytes.
+
+      New keys are placed into the probation list, unless they have been evicted
+      from it recently. Existing entries are updated in place.
+      */
+    void SetEntry(const K& key,
+                  const V& value,
+                  unsigned long size)
+    {
+      if (!IsActive()) {
+        return;
+      }
+
+      Shard&        shard=GetShard(key);
+      MutexLocker   locker(shard.mutex);
+      unsigned long entrySize=size+GetEntryOverhead();
+
+      typename EntryMap::iterator iter=shard.entries.find(key);
+
+      if (iter!=shard.entries.end()) {
+        typename EntryList::iterator entry=iter->second;
+
+        if (entry->protect) {
+          shard.protectMemory=shard.protectMemory-entry->size+entrySize;
+        }
+        else {
+          shard.probationMemory=shard.probationMemory-entry->size+entrySize;
+        }
+
+        entry->value=value;
+        entry->size=entrySize;
+      }
+      else {
+        typename GhostMap::iterator ghost=shard.ghostMap.find(key);
+
+        if (ghost!=shard.ghostMap.end()) {
+          shard.ghosts.erase(ghost->second);
+          shard.ghostMap.erase(ghost);
+
+          shard.protect.push_front(CacheEntry(key,value,entrySize));
+          shard.protect.front().protect=true;
+          shard.protectMemory+=entrySize;
+          shard.entries[key]=shard.protect.begin();
+        }
+        else {
+          shard.probation.push_front(CacheEntry(key,value,entrySize));
+          shard.probationMemory+=entrySize;
+          shard.entries[key]=shard.probation.begin();
+        }
+      }
+
+      StripShard(shard);
+    }
+
+    /**
+      Set a new maximum memory usage, possibly evicting entries
+      if the new size is smaller than the old one.
+      */
+    void SetMaxMemory(unsigned long maxMemory)
+    {
+      this->maxMemory=maxMemory;
+
+      maxShardMemory=maxMemory/shards.size();
+      maxProbationMemory=maxShardMemory/4;
+
+      for (size_t i=0; i<shards.size(); i++) {
+        MutexLocker locker(shards[i]->mutex);
+
+        if (maxMemory==0) {
+          FlushShard(*shards[i]);
+        }
+        else {
+          StripShard(*shards[i]);
+        }
+      }
+    }
+
+    /**
+      Completely flush the cache removing all entries from it.
+      */
+    void Flush()
+    {
+      for (size_t i=0; i<shards.size(); i++) {
+        MutexLocker locker(shards[i]->mutex);
+
+        FlushShard(*shards[i]);
+      }
+    }
+
+    /**
+      Returns the current number of entries in the cache.
+      */
+    unsigned long GetSize() const
+    {
+      unsigned long size=0;
+
+      for (size_t i=0; i<shards.size(); i++) {
+        MutexLocker locker(shards[i]->mutex);
+
+        size+=shards[i]->entries.size();
+      }
+
+      return size;
+    }
+
+    /**
+      Returns the current memory usage of the cache in bytes.
+      */
+    unsigned long GetMemory() const
+    {
+      unsigned long memory=0;
+
+      for (size_t i=0; i<shards.size(); i++) {
+        MutexLocker locker(shards[i]->mutex);
+
+        memory+=shards[i]->probationMemory+shards[i]->protectMemory;
+      }
+
+      return memory;
+    }
+
+    /**
+      Returns the maximum memory usage of the cache in bytes.
+      */
+    unsigned long GetMaxMemory() const
+    {
+      return maxMemory;
+    }
+
+    /**
+      Returns the number of successful and failed lookups since the creation of the
+      cache.
+      */
+    void GetHitStatistics(unsigned long& hits,
+                          unsigned long& misses) const
+    {
+      hits=0;
+      misses=0;
+
+      for (size_t i=0; i<shards.size(); i++) {
+        MutexLocker locker(shards[i]->mutex);
+
+        hits+=shards[i]->hits;
+        misses+=shards[i]->misses;
+      }
+    }
+
+    /**
+      Dump some cache statistics to std::cout.
+      */
+    void DumpStatistics(const char* cacheName) const
+    {
+      unsigned long hits;
+      unsigned long misses;
+
+      GetHitStatistics(hits,misses);
+
+      std::cout << cacheName << " entries: " << GetSize() << ", memory " << GetMemory() << "/" << maxMemory;
+      std::cout << ", hits " << hits << ", misses " << misses << std::endl;
+    }
+
+  private:
+    void FlushShard(Shard& shard)
+    {
+      shard.probation.clear();
+      shard.protect.clear();
+      shard.entries.clear();
+      shard.ghosts.clear();
+      shard.ghostMap.clear();
+      shard.probationMemory=0;
+      shard.protectMemory=0;
+    }
+  };
+}
+
+#endif
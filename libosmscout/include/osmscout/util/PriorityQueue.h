@@ -0,0 +1,482 @@
+#ifndef OSMSCOUT_UTIL_PRIORITYQUEUE_H
+#define OSMSCOUT_UTIL_PRIORITYQUEUE_H
+
+/*
+  This source is part of the libosmscout library
+  Copyright (C) 2013  Tim Teulings
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+#include <algorithm>
+#include <vector>
+
+#include <osmscout/private/CoreImportExport.h>
+
+#include <osmscout/system/Assert.h>
+#include <osmscout/system/Types.h>
+
+namespace osmscout {
+
+  /**
+    Indexed d-ary min heap.
+
+    Elements are identified by a dense index (0...n), normally the position of
+    the actual data in some external array. The heap only stores the index and the
+    priority. Since the heap knows the position of each index in the heap, the
+    priority of an element already in the heap can be changed in O(log n).
+
+    Elements with the same priority are returned in order of their index.
+
+    Clear() keeps the allocated memory, so an instance can be reused without
+    reallocation.
+    */
+  template <size_t D=4>
+  class DAryHeap
+  {
+  private:
+    struct Entry
+    {
+      double priority;
+      size_t index;
+    };
+
+    static const size_t noPosition=(size_t)-1;
+
+  private:
+    std::vector<Entry>  heap;
+    std::vector<size_t> positions; //! Position in the heap by index, or noPosition
+
+  private:
+    static inline bool IsLess(const Entry& a,
+                              const Entry& b)
+    {
+      if (a.priority==b.priority) {
+        return a.index<b.index;
+      }
+
+      return a.priority<b.priority;
+    }
+
+    inline void Place(size_t pos,
+                      const Entry& entry)
+    {
+      heap[pos]=entry;
+      positions[entry.index]=pos;
+    }
+
+    void SiftUp(size_t pos)
+    {
+      Entry entry=heap[pos];
+
+      while (pos>0) {
+        size_t parent=(pos-1)/D;
+
+        if (!IsLess(entry,heap[parent])) {
+          break;
+        }
+
+        Place(pos,heap[parent]);
+        pos=parent;
+      }
+
+      Place(pos,entry);
+    }
+
+    void SiftDown(size_t pos)
+    {
+      Entry entry=heap[pos];
+
+      while (true) {
+        size_t first=pos*D+1;
+
+        if (first>=heap.size()) {
+          break;
+        }
+
+        size_t last=std::min(first+D,heap.size());
+        size_t best=first;
+
+        for (size_t child=first+1; child<last; child++) {
+          if (IsLess(heap[child],heap[best])) {
+            best=child;
+          }
+        }
+
+        if (!IsLess(heap[best],entry)) {
+          break;
+        }
+
+        Place(pos,heap[best]);
+        pos=best;
+      }
+
+      Place(pos,entry);
+    }
+
+  public:
+    /**
+      Remove all elements from the heap. Only the elements still in the heap
+      are touched, so clearing a heap after a short search is cheap.
+      */
+    void Clear()
+    {
+      for (typename std::vector<Entry>::const_iterator entry=heap.begin();
+           entry!=heap.end();
+           ++entry) {
+        positions[entry->index]=noPosition;
+      }
+
+      heap.clear();
+    }
+
+    inline bool IsEmpty() const
+    {
+      return heap.empty();
+    }
+
+    inline size_t GetSize() const
+    {
+      return heap.size();
+    }
+
+    inline bool Contains(size_t index) const
+    {
+      return index<positions.size() &&
+             positions[index]!=noPosition;
+    }
+
+    /**
+      Return the lowest priority in the heap. The heap must not be empty.
+      */
+    inline double GetMinPriority() const
+    {
+      assert(!heap.empty());
+
+      return heap.front().priority;
+    }
+
+    /**
+      Add a new element to the heap. The index must not be in the heap already.
+      */
+    void Push(size_t index,
+              double priority)
+    {
+      if (index>=positions.size()) {
+        positions.resize(index+1,noPosition);
+      }
+
+      assert(positions[index]==noPosition);
+
+      Entry entry;
+
+      entry.priority=priority;
+      entry.index=index;
+
+      heap.push_back(entry);
+      positions[index]=heap.size()-1;
+
+      SiftUp(heap.size()-1);
+    }
+
+    /**
+      Change the priority of an element already in the heap.
+      */
+    void Update(size_t index,
+                double priority)
+    {
+      assert(Contains(index));
+
+      size_t pos=positions[index];
+
+      if (priority<=heap[pos].priority) {
+        heap[pos].priority=priority;
+        SiftUp(pos);
+      }
+      else {
+        heap[pos].priority=priority;
+        SiftDown(pos);
+      }
+    }
+
+    /**
+      Remove the element with the lowest priority from the heap and
+      return its index. The heap must not be empty.
+      */
+    size_t Pop()
+    {
+      assert(!heap.empty());
+
+      size_t index=heap.front().index;
+
+      positions[index]=noPosition;
+
+      if (heap.size()>1) {
+        Entry last=heap.back();
+
+        heap.pop_back();
+        Place(0,last);
+        SiftDown(0);
+      }
+      else {
+        heap.pop_back();
+      }
+
+      return index;
+    }
+  };
+
+  template <size_t D>
+  const size_t DAryHeap<D>::noPosition;
+
+  /**
+    Monotone radix heap.
+
+    Priorities are converted to integer keys by multiplying them with the
+    scale given in the constructor. The heap requires that no element is pushed
+    with a key smaller than the key of the last element popped, which is the case
+    for Dijkstra and for A* with a consistent estimate. Smaller keys (as caused by
+    rounding) are raised to the key of the last element popped.
+
+    Push and Update are O(1), Pop is amortized O(log C), with C being the
+    maximum difference between keys. Update adds a new entry and drops the
+    old one lazily on Pop().
+
+    Like DAryHeap, elements are identified by a dense index and Clear() keeps
+    the allocated memory.
+    */
+  class OSMSCOUT_API RadixHeap
+  {
+  private:
+    struct Entry
+    {
+      uint64_t key;
+      size_t   index;
+    };
+
+    typedef std::vector<Entry> Bucket;
+
+    static const uint64_t noKey=(uint64_t)-1;
+
+  private:
+    double              scale;
+    uint64_t            last;     //! Key of the last element popped
+    size_t              size;     //! Number of elements in the heap
+    std::vector<Bucket> buckets;  //! Bucket i holds keys differing from last in bit i-1 at most
+    std::vector<uint64_t> keys;   //! Current key by index, or noKey
+
+  private:
+    inline size_t GetBucket(uint64_t key) const
+    {
+      uint64_t diff=key ^ last;
+
+      if (diff==0) {
+        return 0;
+      }
+
+#if defined(__GNUC__)
+      return 64-__builtin_clzll(diff);
+#else
+      size_t bucket=0;
+
+      while (diff!=0) {
+        diff >>= 1;
+        bucket++;
+      }
+
+      return bucket;
+#endif
+    }
+
+    inline uint64_t GetKey(double priority) const
+    {
+      double value=priority*scale;
+
+      if (value<=(double)last) {
+        return last;
+      }
+
+      if (value>=(double)(noKey-1)) {
+        return noKey-1;
+      }
+
+      return (uint64_t)value;
+    }
+
+    inline bool IsCurrent(const Entry& entry) const
+    {
+      return keys[entry.index]==entry.key;
+    }
+
+    inline void Insert(size_t index,
+                       uint64_t key)
+    {
+      Entry entry;
+
+      entry.key=key;
+      entry.index=index;
+
+      keys[index]=key;
+      buckets[GetBucket(key)].push_back(entry);
+    }
+
+    /**
+      Redistribute the buckets until the last entry of bucket 0 is a current
+      entry with the lowest key. Outdated entries are dropped on the way.
+      */
+    void MoveMinToFront()
+    {
+      while (true) {
+        while (!buckets[0].empty() &&
+               !IsCurrent(buckets[0].back())) {
+          buckets[0].pop_back();
+        }
+
+        if (!buckets[0].empty()) {
+          return;
+        }
+
+        size_t current=1;
+
+        while (buckets[current].empty()) {
+          current++;
+        }
+
+        uint64_t minKey=noKey;
+
+        for (Bucket::const_iterator entry=buckets[current].begin();
+             entry!=buckets[current].end();
+             ++entry) {
+          if (IsCurrent(*entry) &&
+              entry->key<minKey) {
+            minKey=entry->key;
+          }
+        }
+
+        if (minKey!=noKey) {
+          last=minKey;
+
+          for (Bucket::const_iterator entry=buckets[current].begin();
+               entry!=buckets[current].end();
+               ++entry) {
+            if (IsCurrent(*entry)) {
+              buckets[GetBucket(entry->key)].push_back(*entry);
+            }
+          }
+        }
+
+        buckets[current].clear();
+      }
+    }
+
+  public:
+    RadixHeap(double scale=1000000.0)
+    : scale(scale),
+      last(0),
+      size(0),
+      buckets(65)
+    {
+      // no code
+    }
+
+    void Clear()
+    {
+      for (size_t i=0; i<buckets.size(); i++) {
+        for (Bucket::const_iterator entry=buckets[i].begin();
+             entry!=buckets[i].end();
+             ++entry) {
+          keys[entry->index]=noKey;
+        }
+
+        buckets[i].clear();
+      }
+
+      last=0;
+      size=0;
+    }
+
+    inline bool IsEmpty() const
+    {
+      return size==0;
+    }
+
+    inline size_t GetSize() const
+    {
+      return size;
+    }
+
+    inline bool Contains(size_t index) const
+    {
+      return index<keys.size() &&
+             keys[index]!=noKey;
+    }
+
+    void Push(size_t index,
+              double priority)
+    {
+      if (index>=keys.size()) {
+        keys.resize(index+1,noKey);
+      }
+
+      assert(keys[index]==noKey);
+
+      Insert(index,GetKey(priority));
+      size++;
+    }
+
+    void Update(size_t index,
+                double priority)
+    {
+      assert(Contains(index));
+
+      uint64_t key=GetKey(priority);
+
+      if (key!=keys[index]) {
+        Insert(index,key);
+      }
+    }
+
+    /**
+      Return the lowest priority in the heap (rounded to the key). The heap
+      must not be empty.
+      */
+    double GetMinPriority()
+    {
+      assert(size>0);
+
+      MoveMinToFront();
+
+      return last/scale;
+    }
+
+    size_t Pop()
+    {
+      assert(size>0);
+
+      MoveMinToFront();
+
+      Entry entry=buckets[0].back();
+
+      buckets[0].pop_back();
+
+      keys[entry.index]=noKey;
+      size--;
+
+      return entry.index;
+    }
+  };
+}
+
+#endif
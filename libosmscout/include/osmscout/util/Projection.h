@@ -22,6 +22,8 @@
 
 #include <osmscout/private/CoreImportExport.h>
 
+#include <osmscout/GeoCoord.h>
+
 #include <osmscout/system/SSEMathPublic.h>
 
 #include <osmscout/util/Magnification.h>
@@ -88,6 +90,16 @@ namespace osmscout {
 #endif
       }
 
+      inline bool GeoToPixel(const GeoCoord& coord,
+                             double& x,
+                             double& y)
+      {
+        return GeoToPixel(coord.GetLon(),
+                          coord.GetLat(),
+                          x,
+                          y);
+      }
+
       void Flush()
       {
 #ifdef OSMSCOUT_HAVE_SSE2
@@ -171,6 +183,29 @@ namespace osmscout {
     virtual bool GeoToPixel(double lon, double lat,
                             double& x, double& y) const = 0;
 
+    /**
+     * Converts a geo coordinate to a pixel coordinate. Uses the batch
+     * transformation, so for compact coordinates the fixed point values
+     * are transformed directly.
+     */
+    inline bool GeoToPixel(const GeoCoord& coord,
+                           double& x, double& y) const
+    {
+      return GeoToPixel(&coord,1,
+                        &x,&y,0);
+    }
+
+    /**
+     * Converts count geo coordinates to pixel coordinates. The pixel
+     * coordinate of coords[i] is stored in the doubles i*stride bytes
+     * behind x and y.
+     */
+    virtual bool GeoToPixel(const GeoCoord* coords,
+                            size_t count,
+                            double* x,
+                            double* y,
+                            size_t stride) const;
+
     /**
      * Returns the bounding box of the area covered
      */
@@ -285,9 +320,17 @@ namespace osmscout {
     bool PixelToGeo(double x, double y,
                     double& lon, double& lat) const;
 
+    using Projection::GeoToPixel;
+
     bool GeoToPixel(double lon, double lat,
                     double& x, double& y) const;
 
+    bool GeoToPixel(const GeoCoord* coords,
+                    size_t count,
+                    double* x,
+                    double* y,
+                    size_t stride) const;
+
     bool GetDimensions(double& lonMin, double& latMin,
                        double& lonMax, double& latMax) const;
 
@@ -303,6 +346,11 @@ namespace osmscout {
   private:
     bool PixelToGeo(double x, double y, double& lon, double& lat) const;
     bool GeoToPixel(double lon, double lat, double& x, double& y) const;
+    bool GeoToPixel(const GeoCoord* coords,
+                    size_t count,
+                    double* x,
+                    double* y,
+                    size_t stride) const;
   protected:
     bool GeoToPixel(const BatchTransformer& transformData) const;
   };
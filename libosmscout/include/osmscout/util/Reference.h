@@ -20,6 +20,12 @@
   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
 */
 
+#include <osmscout/CoreFeatures.h>
+
+#if defined(OSMSCOUT_HAVE_THREAD)
+#include <atomic>
+#endif
+
 #include <osmscout/system/Assert.h>
 #include <osmscout/system/Types.h>
 
@@ -29,6 +35,13 @@ namespace osmscout {
 
   /**
     Baseclass for all classes that support reference counting.
+
+    If the library was build with thread support, the reference counter
+    is atomic, so references to the same object can be copied and destroyed
+    in different threads.
+
+    Copying a Referencable does not copy the reference count, the copy starts
+    without any references.
   */
   class OSMSCOUT_API Referencable
   {
@@ -39,6 +52,18 @@ namespace osmscout {
       // no code
     }
 
+    Referencable(const Referencable& /*other*/)
+      : count(0)
+    {
+      // no code
+    }
+
+    Referencable& operator=(const Referencable& /*other*/)
+    {
+      // The reference count belongs to the instance, not to its value
+      return *this;
+    }
+
     /**
       Add a reference to this object.
 
@@ -56,9 +81,7 @@ namespace osmscout {
     */
     inline unsigned long RemoveReference()
     {
-      count--;
-
-      return count;
+      return --count;
     }
 
     /**
@@ -70,7 +93,11 @@ namespace osmscout {
     }
 
   private:
-    unsigned long count;
+#if defined(OSMSCOUT_HAVE_THREAD)
+    std::atomic<unsigned long> count;
+#else
+    unsigned long              count;
+#endif
   };
 
   /**
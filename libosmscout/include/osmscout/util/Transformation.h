@@ -20,9 +20,7 @@
   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
 */
 
-// For memcpy
-#include <string.h>
-
+#include <algorithm>
 #include <iostream>
 #include <vector>
 
@@ -39,6 +37,20 @@
 
 namespace osmscout {
 
+  /**
+    Transforms areas and ways from geo coordinates to pixel coordinates and
+    optionally reduces the number of points.
+
+    If a clip region is set (see SetClipRegion()), areas and ways are
+    clipped to it before transformation, so only nodes in or close to the
+    visible region get transformed and optimized. Areas are clipped using
+    the Sutherland-Hodgman algorithm, the start and end of ways using the
+    Liang-Barsky algorithm. Since ways have to stay one path, runs of
+    invisible nodes within a way that stay on the outer side of the same
+    edge of the clip region (compare Cohen-Sutherland) are reduced to their
+    first and last node. Nodes are classified in geo coordinates, only the
+    intersections with the clip region are calculated in pixel space.
+    */
   class OSMSCOUT_API TransPolygon
   {
   private:
@@ -47,6 +59,18 @@ namespace osmscout {
     size_t  start;
     size_t  end;
 
+    bool                  clip;       //! Clip to the clip region before transformation
+    double                clipLonMin;
+    double                clipLatMin;
+    double                clipLonMax;
+    double                clipLatMax;
+    double                clipLonMinX; //! Pixel coordinate of the edge at clipLonMin
+    double                clipLonMaxX; //! Pixel coordinate of the edge at clipLonMax
+    double                clipLatMinY; //! Pixel coordinate of the edge at clipLatMin
+    double                clipLatMaxY; //! Pixel coordinate of the edge at clipLatMax
+    std::vector<GeoCoord> clipNodes;  //! Scratch buffer for the clipped nodes
+    std::vector<GeoCoord> clipBuffer; //! Scratch buffer for clipping
+
   public:
     enum OptimizeMethod
     {
@@ -66,6 +90,23 @@ namespace osmscout {
     TransPoint* points;
 
   private:
+    unsigned int GetOutCode(const GeoCoord& coord) const;
+    bool ClipSegment(const Projection& projection,
+                     const GeoCoord& a,
+                     const GeoCoord& b,
+                     unsigned int codeA,
+                     unsigned int codeB,
+                     GeoCoord& start,
+                     GeoCoord& end) const;
+    void ClipAreaEdge(const Projection& projection,
+                      const std::vector<GeoCoord>& in,
+                      unsigned int edge,
+                      std::vector<GeoCoord>& out) const;
+    const std::vector<GeoCoord>& ClipArea(const Projection& projection,
+                                          const std::vector<GeoCoord>& nodes);
+    const std::vector<GeoCoord>& ClipWay(const Projection& projection,
+                                         const std::vector<GeoCoord>& nodes);
+
     void TransformGeoToPixel(const Projection& projection,
                              const std::vector<GeoCoord>& nodes);
     void DropSimilarPoints(double optimizeErrorTolerance);
@@ -96,6 +137,15 @@ namespace osmscout {
       return end;
     }
 
+    inline bool HasClipRegion() const
+    {
+      return clip;
+    }
+
+    bool SetClipRegion(const Projection& projection,
+                       double margin);
+    void ClearClipRegion();
+
     void TransformArea(const Projection& projection,
                        OptimizeMethod optimize,
                        const std::vector<GeoCoord>& nodes,
@@ -199,7 +249,7 @@ namespace osmscout {
 
       P* newBuffer=new P[bufferSize];
 
-      memcpy(newBuffer,buffer,sizeof(P)*usedPoints);
+      std::copy(buffer,buffer+usedPoints,newBuffer);
 
       std::cout << "*** Buffer reallocation: " << bufferSize << std::endl;
 
@@ -359,7 +409,7 @@ namespace osmscout {
 
     void Reset();
 
-    void TransformArea(const Projection& projection,
+    bool TransformArea(const Projection& projection,
                        TransPolygon::OptimizeMethod optimize,
                        const std::vector<GeoCoord>& nodes,
                        size_t& start, size_t &end,
@@ -227,6 +227,27 @@ namespace osmscout {
     return !writer.HasError();
   }
 
+  /**
+    Returns the memory used by the dynamically allocated data of the attributes,
+    excluding the size of the object itself.
+    */
+  unsigned long AreaAttributes::GetMemorySize() const
+  {
+    unsigned long memory=name.capacity()+
+                         nameAlt.capacity()+
+                         location.capacity()+
+                         address.capacity()+
+                         tags.capacity()*sizeof(Tag);
+
+    for (std::vector<Tag>::const_iterator tag=tags.begin();
+         tag!=tags.end();
+         ++tag) {
+      memory+=tag->value.capacity();
+    }
+
+    return memory;
+  }
+
   bool AreaAttributes::operator==(const AreaAttributes& other) const
   {
     if (name!=other.name ||
@@ -381,6 +402,26 @@ namespace osmscout {
     }
   }
 
+  /**
+    Returns the estimated memory used by the area, including all rings with their
+    node ids, coordinates and attributes.
+    */
+  unsigned long Area::GetMemorySize() const
+  {
+    unsigned long memory=sizeof(Area)+
+                         rings.capacity()*sizeof(Ring);
+
+    for (std::vector<Ring>::const_iterator ring=rings.begin();
+         ring!=rings.end();
+         ++ring) {
+      memory+=ring->ids.capacity()*sizeof(Id)+
+              ring->nodes.capacity()*sizeof(GeoCoord)+
+              ring->attributes.GetMemorySize();
+    }
+
+    return memory;
+  }
+
   bool Area::ReadIds(FileScanner& scanner,
                      uint32_t nodesCount,
                      std::vector<Id>& ids)
@@ -405,26 +446,8 @@ namespace osmscout {
                         uint32_t nodesCount,
                         std::vector<GeoCoord>& coords)
   {
-    uint32_t minLat;
-    uint32_t minLon;
-
-    coords.resize(nodesCount);
-
-    scanner.Read(minLat);
-    scanner.Read(minLon);
-
-    for (size_t j=0; j<nodesCount; j++) {
-      uint32_t latValue;
-      uint32_t lonValue;
-
-      scanner.ReadNumber(latValue);
-      scanner.ReadNumber(lonValue);
-
-      coords[j].Set((minLat+latValue)/conversionFactor-90.0,
-                     (minLon+lonValue)/conversionFactor-180.0);
-    }
-
-    return !scanner.HasError();
+    return scanner.ReadCoords(nodesCount,
+                              coords);
   }
 
   bool Area::Read(FileScanner& scanner)
@@ -607,26 +630,7 @@ namespace osmscout {
   bool Area::WriteCoords(FileWriter& writer,
                          const std::vector<GeoCoord>& coords) const
   {
-    uint32_t minLat=std::numeric_limits<uint32_t>::max();
-    uint32_t minLon=std::numeric_limits<uint32_t>::max();
-
-    for (size_t j=0; j<coords.size(); j++) {
-      minLat=std::min(minLat,(uint32_t)round((coords[j].GetLat()+90.0)*conversionFactor));
-      minLon=std::min(minLon,(uint32_t)round((coords[j].GetLon()+180.0)*conversionFactor));
-    }
-
-    writer.Write(minLat);
-    writer.Write(minLon);
-
-    for (size_t j=0; j<coords.size(); j++) {
-      uint32_t latValue=(uint32_t)round((coords[j].GetLat()+90.0)*conversionFactor);
-      uint32_t lonValue=(uint32_t)round((coords[j].GetLon()+180.0)*conversionFactor);
-
-      writer.WriteNumber(latValue-minLat);
-      writer.WriteNumber(lonValue-minLon);
-    }
-
-    return !writer.HasError();
+    return writer.WriteCoords(coords);
   }
 
   bool Area::Write(FileWriter& writer) const
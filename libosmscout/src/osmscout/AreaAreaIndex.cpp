@@ -36,76 +36,86 @@ namespace osmscout {
 
   void AreaAreaIndex::Close()
   {
-    if (scanner.IsOpen()) {
-      scanner.Close();
+    if (scannerPool.IsOpen()) {
+      scannerPool.Close();
     }
   }
 
-  bool AreaAreaIndex::GetIndexCell(uint32_t level,
+  bool AreaAreaIndex::GetIndexCell(FileScanner& scanner,
+                                   uint32_t level,
                                    FileOffset offset,
-                                   IndexCache::CacheRef& cacheRef) const
+                                   IndexCellRef& cell) const
   {
-    if (!indexCache.GetEntry(offset,cacheRef)) {
-      IndexCache::CacheEntry cacheEntry(offset);
+    {
+      MutexLocker          locker(cacheMutex);
+      IndexCache::CacheRef cacheRef;
 
-      cacheRef=indexCache.SetEntry(cacheEntry);
+      if (indexCache.GetEntry(offset,cacheRef)) {
+        cell=cacheRef->value;
 
-      if (!scanner.IsOpen()) {
-        if (!scanner.Open(datafilename,FileScanner::LowMemRandom,true)) {
-          std::cerr << "Error while opening " << datafilename << " for reading!" << std::endl;
-          return false;
-        }
+        return true;
       }
+    }
 
-      scanner.SetPos(offset);
+    IndexCellRef newCell=new IndexCell();
 
-      // Read offsets of children if not in the bottom level
+    scanner.SetPos(offset);
 
-      if (level<maxLevel) {
-        for (size_t c=0; c<4; c++) {
-          if (!scanner.ReadNumber(cacheRef->value.children[c])) {
-            std::cerr << "Cannot read index data at offset " << offset << std::endl;
-            return false;
-          }
+    // Read offsets of children if not in the bottom level
+
+    if (level<maxLevel) {
+      for (size_t c=0; c<4; c++) {
+        if (!scanner.ReadNumber(newCell->children[c])) {
+          std::cerr << "Cannot read index data at offset " << offset << std::endl;
+          return false;
         }
       }
-      else {
-        for (size_t c=0; c<4; c++) {
-          cacheRef->value.children[c]=0;
-        }
+    }
+    else {
+      for (size_t c=0; c<4; c++) {
+        newCell->children[c]=0;
       }
+    }
 
-      // Now read the way offsets by type in this index entry
+    // Now read the way offsets by type in this index entry
 
-      uint32_t offsetCount;
+    uint32_t offsetCount;
 
-      // Areas
+    // Areas
 
-      if (!scanner.ReadNumber(offsetCount)) {
+    if (!scanner.ReadNumber(offsetCount)) {
+      std::cerr << "Cannot read index data for level " << level << " at offset " << offset << std::endl;
+      return false;
+    }
+
+    newCell->areas.resize(offsetCount);
+
+    FileOffset prevOffset=0;
+
+    for (size_t c=0; c<offsetCount; c++) {
+      if (!scanner.ReadNumber(newCell->areas[c].type)) {
+        std::cerr << "Cannot read index data for level " << level << " at offset " << offset << std::endl;
+        return false;
+      }
+      if (!scanner.ReadNumber(newCell->areas[c].offset)) {
         std::cerr << "Cannot read index data for level " << level << " at offset " << offset << std::endl;
         return false;
       }
 
-      cacheRef->value.areas.resize(offsetCount);
-
-      FileOffset prevOffset=0;
+      newCell->areas[c].offset+=prevOffset;
 
-      for (size_t c=0; c<offsetCount; c++) {
-        if (!scanner.ReadNumber(cacheRef->value.areas[c].type)) {
-          std::cerr << "Cannot read index data for level " << level << " at offset " << offset << std::endl;
-          return false;
-        }
-        if (!scanner.ReadNumber(cacheRef->value.areas[c].offset)) {
-          std::cerr << "Cannot read index data for level " << level << " at offset " << offset << std::endl;
-          return false;
-        }
+      prevOffset=newCell->areas[c].offset;
+    }
 
-        cacheRef->value.areas[c].offset+=prevOffset;
+    {
+      MutexLocker            locker(cacheMutex);
+      IndexCache::CacheEntry cacheEntry(offset,newCell);
 
-        prevOffset=cacheRef->value.areas[c].offset;
-      }
+      indexCache.SetEntry(cacheEntry);
     }
 
+    cell=newCell;
+
     return true;
   }
 
@@ -113,17 +123,23 @@ namespace osmscout {
   {
     datafilename=path+"/"+filepart;
 
-    if (!scanner.Open(datafilename,FileScanner::LowMemRandom,true)) {
+    if (!scannerPool.Open(datafilename,FileScanner::LowMemRandom,true)) {
       std::cerr << "Cannot open file '" << datafilename << "'" << std::endl;
       return false;
     }
 
-    if (!scanner.ReadNumber(maxLevel)) {
+    PooledFileScanner scanner(scannerPool);
+
+    if (!scanner.IsValid()) {
+      return false;
+    }
+
+    if (!scanner->ReadNumber(maxLevel)) {
       std::cerr << "Cannot read data" << std::endl;
       return false;
     }
 
-    if (!scanner.ReadFileOffset(topLevelOffset)) {
+    if (!scanner->ReadFileOffset(topLevelOffset)) {
       std::cerr << "Cannot read data" << std::endl;
       return false;
     }
@@ -140,7 +156,7 @@ namespace osmscout {
       cellHeight[i]=180.0/pow(2.0,(int)i);
     }
 
-    return !scanner.HasError() && scanner.Close();
+    return !scanner->HasError();
   }
 
   bool AreaAreaIndex::GetOffsets(double minlon,
@@ -155,6 +171,11 @@ namespace osmscout {
     std::vector<CellRef>    cellRefs;     // cells to scan in this level
     std::vector<CellRef>    nextCellRefs; // cells to scan for the next level
     std::vector<FileOffset> newOffsets;   // offsets collected in the current level
+    PooledFileScanner       scanner(scannerPool);
+
+    if (!scanner.IsValid()) {
+      return false;
+    }
 
     minlon+=180;
     maxlon+=180;
@@ -197,22 +218,22 @@ namespace osmscout {
         size_t               cy;
         double               x;
         double               y;
-        IndexCache::CacheRef cell;
+        IndexCellRef         cell;
 
-        if (!GetIndexCell(level,cellRefs[i].offset,cell)) {
+        if (!GetIndexCell(*scanner,level,cellRefs[i].offset,cell)) {
           std::cerr << "Cannot find offset " << cellRefs[i].offset << " in level " << level << " => aborting!" << std::endl;
           return false;
         }
 
         if (offsets.size()+
             newOffsets.size()+
-            cell->value.areas.size()>=maxCount) {
+            cell->areas.size()>=maxCount) {
           stopArea=true;
           continue;
         }
 
-        for (std::vector<IndexEntry>::const_iterator entry=cell->value.areas.begin();
-             entry!=cell->value.areas.end();
+        for (std::vector<IndexEntry>::const_iterator entry=cell->areas.begin();
+             entry!=cell->areas.end();
              ++entry) {
           if (types.IsTypeSet(entry->type)) {
             newOffsets.push_back(entry->offset);
@@ -222,7 +243,7 @@ namespace osmscout {
         cx=cellRefs[i].x*2;
         cy=cellRefs[i].y*2;
 
-        if (cell->value.children[0]!=0) {
+        if (cell->children[0]!=0) {
           // top left
 
           x=cx*cellWidth[level+1];
@@ -232,11 +253,11 @@ namespace osmscout {
                 y>maxlat+cellHeight[level+1]/2 ||
                 x+cellWidth[level+1]<minlon-cellWidth[level+1]/2 ||
                 y+cellHeight[level+1]<minlat-cellHeight[level+1]/2)) {
-            nextCellRefs.push_back(CellRef(cell->value.children[0],cx,cy+1));
+            nextCellRefs.push_back(CellRef(cell->children[0],cx,cy+1));
           }
         }
 
-        if (cell->value.children[1]!=0) {
+        if (cell->children[1]!=0) {
           // top right
           x=(cx+1)*cellWidth[level+1];
           y=(cy+1)*cellHeight[level+1];
@@ -245,11 +266,11 @@ namespace osmscout {
                 y>maxlat+cellHeight[level+1]/2 ||
                 x+cellWidth[level+1]<minlon-cellWidth[level+1]/2 ||
                 y+cellHeight[level+1]<minlat-cellHeight[level+1]/2)) {
-            nextCellRefs.push_back(CellRef(cell->value.children[1],cx+1,cy+1));
+            nextCellRefs.push_back(CellRef(cell->children[1],cx+1,cy+1));
           }
         }
 
-        if (cell->value.children[2]!=0) {
+        if (cell->children[2]!=0) {
           // bottom left
           x=cx*cellWidth[level+1];
           y=cy*cellHeight[level+1];
@@ -258,11 +279,11 @@ namespace osmscout {
                 y>maxlat+cellHeight[level+1]/2 ||
                 x+cellWidth[level+1]<minlon-cellWidth[level+1]/2 ||
                 y+cellHeight[level+1]<minlat-cellHeight[level+1]/2)) {
-            nextCellRefs.push_back(CellRef(cell->value.children[2],cx,cy));
+            nextCellRefs.push_back(CellRef(cell->children[2],cx,cy));
           }
         }
 
-        if (cell->value.children[3]!=0) {
+        if (cell->children[3]!=0) {
           // bottom right
           x=(cx+1)*cellWidth[level+1];
           y=cy*cellHeight[level+1];
@@ -271,7 +292,7 @@ namespace osmscout {
                 y>maxlat+cellHeight[level+1]/2 ||
                 x+cellWidth[level+1]<minlon-cellWidth[level+1]/2 ||
                 y+cellHeight[level+1]<minlat-cellHeight[level+1]/2)) {
-            nextCellRefs.push_back(CellRef(cell->value.children[3],cx+1,cy));
+            nextCellRefs.push_back(CellRef(cell->children[3],cx+1,cy));
           }
         }
       }
@@ -288,6 +309,8 @@ namespace osmscout {
 
   void AreaAreaIndex::DumpStatistics()
   {
+    MutexLocker locker(cacheMutex);
+
     indexCache.DumpStatistics(filepart.c_str(),IndexCacheValueSizer());
   }
 }
@@ -52,8 +52,8 @@ namespace osmscout {
 
   void AreaNodeIndex::Close()
   {
-    if (scanner.IsOpen()) {
-      scanner.Close();
+    if (scannerPool.IsOpen()) {
+      scannerPool.Close();
     }
   }
 
@@ -61,33 +61,39 @@ namespace osmscout {
   {
     datafilename=path+"/"+filepart;
 
-    if (!scanner.Open(datafilename,FileScanner::LowMemRandom,true)) {
+    if (!scannerPool.Open(datafilename,FileScanner::LowMemRandom,true)) {
       std::cerr << "Cannot open file '" << datafilename << "'" << std::endl;
       return false;
     }
 
+    PooledFileScanner scanner(scannerPool);
+
+    if (!scanner.IsValid()) {
+      return false;
+    }
+
     uint32_t indexEntries;
 
-    scanner.Read(indexEntries);
+    scanner->Read(indexEntries);
 
     for (size_t i=0; i<indexEntries; i++) {
       TypeId type;
 
-      scanner.ReadNumber(type);
+      scanner->ReadNumber(type);
 
       if (type>=nodeTypeData.size()) {
         nodeTypeData.resize(type+1);
       }
 
-      scanner.ReadFileOffset(nodeTypeData[type].indexOffset);
-      scanner.Read(nodeTypeData[type].dataOffsetBytes);
+      scanner->ReadFileOffset(nodeTypeData[type].indexOffset);
+      scanner->Read(nodeTypeData[type].dataOffsetBytes);
 
-      scanner.ReadNumber(nodeTypeData[type].indexLevel);
+      scanner->ReadNumber(nodeTypeData[type].indexLevel);
 
-      scanner.ReadNumber(nodeTypeData[type].cellXStart);
-      scanner.ReadNumber(nodeTypeData[type].cellXEnd);
-      scanner.ReadNumber(nodeTypeData[type].cellYStart);
-      scanner.ReadNumber(nodeTypeData[type].cellYEnd);
+      scanner->ReadNumber(nodeTypeData[type].cellXStart);
+      scanner->ReadNumber(nodeTypeData[type].cellXEnd);
+      scanner->ReadNumber(nodeTypeData[type].cellYStart);
+      scanner->ReadNumber(nodeTypeData[type].cellYEnd);
 
       nodeTypeData[type].cellXCount=nodeTypeData[type].cellXEnd-nodeTypeData[type].cellXStart+1;
       nodeTypeData[type].cellYCount=nodeTypeData[type].cellYEnd-nodeTypeData[type].cellYStart+1;
@@ -101,10 +107,11 @@ namespace osmscout {
       nodeTypeData[type].maxLat=(nodeTypeData[type].cellYEnd+1)*nodeTypeData[type].cellHeight-90.0;
     }
 
-    return !scanner.HasError() && scanner.Close();
+    return !scanner->HasError();
   }
 
-  bool AreaNodeIndex::GetOffsets(const TypeData& typeData,
+  bool AreaNodeIndex::GetOffsets(FileScanner& scanner,
+                                 const TypeData& typeData,
                                  double minlon,
                                  double minlat,
                                  double maxlon,
@@ -235,18 +242,18 @@ namespace osmscout {
                                  size_t maxNodeCount,
                                  std::vector<FileOffset>& nodeOffsets) const
   {
-    if (!scanner.IsOpen()) {
-      if (!scanner.Open(datafilename,FileScanner::LowMemRandom,true)) {
-        std::cerr << "Error while opening " << datafilename << " for reading!" << std::endl;
-        return false;
-      }
+    PooledFileScanner scanner(scannerPool);
+
+    if (!scanner.IsValid()) {
+      return false;
     }
 
     bool sizeExceeded=false;
 
     for (size_t i=0; i<nodeTypeData.size(); i++) {
       if (nodeTypes.IsTypeSet(i)) {
-        if (!GetOffsets(nodeTypeData[i],
+        if (!GetOffsets(*scanner,
+                        nodeTypeData[i],
                         minlon,
                         minlat,
                         maxlon,
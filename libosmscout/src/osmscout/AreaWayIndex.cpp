@@ -52,8 +52,8 @@ namespace osmscout {
 
   void AreaWayIndex::Close()
   {
-    if (scanner.IsOpen()) {
-      scanner.Close();
+    if (scannerPool.IsOpen()) {
+      scannerPool.Close();
     }
   }
 
@@ -61,35 +61,41 @@ namespace osmscout {
   {
     datafilename=path+"/"+filepart;
 
-    if (!scanner.Open(datafilename,FileScanner::LowMemRandom,true)) {
+    if (!scannerPool.Open(datafilename,FileScanner::LowMemRandom,true)) {
       std::cerr << "Cannot open file '" << datafilename << "'" << std::endl;
       return false;
     }
 
+    PooledFileScanner scanner(scannerPool);
+
+    if (!scanner.IsValid()) {
+      return false;
+    }
+
     uint32_t indexEntries;
 
-    scanner.Read(indexEntries);
+    scanner->Read(indexEntries);
 
     for (size_t i=0; i<indexEntries; i++) {
       TypeId type;
 
-      scanner.ReadNumber(type);
+      scanner->ReadNumber(type);
 
       if (type>=wayTypeData.size()) {
         wayTypeData.resize(type+1);
       }
 
-      scanner.ReadFileOffset(wayTypeData[type].bitmapOffset);
+      scanner->ReadFileOffset(wayTypeData[type].bitmapOffset);
 
       if (wayTypeData[type].bitmapOffset>0) {
-        scanner.Read(wayTypeData[type].dataOffsetBytes);
+        scanner->Read(wayTypeData[type].dataOffsetBytes);
 
-        scanner.ReadNumber(wayTypeData[type].indexLevel);
+        scanner->ReadNumber(wayTypeData[type].indexLevel);
 
-        scanner.ReadNumber(wayTypeData[type].cellXStart);
-        scanner.ReadNumber(wayTypeData[type].cellXEnd);
-        scanner.ReadNumber(wayTypeData[type].cellYStart);
-        scanner.ReadNumber(wayTypeData[type].cellYEnd);
+        scanner->ReadNumber(wayTypeData[type].cellXStart);
+        scanner->ReadNumber(wayTypeData[type].cellXEnd);
+        scanner->ReadNumber(wayTypeData[type].cellYStart);
+        scanner->ReadNumber(wayTypeData[type].cellYEnd);
 
         wayTypeData[type].cellXCount=wayTypeData[type].cellXEnd-wayTypeData[type].cellXStart+1;
         wayTypeData[type].cellYCount=wayTypeData[type].cellYEnd-wayTypeData[type].cellYStart+1;
@@ -104,10 +110,11 @@ namespace osmscout {
       }
     }
 
-    return !scanner.HasError() && scanner.Close();
+    return !scanner->HasError();
   }
 
-  bool AreaWayIndex::GetOffsets(const TypeData& typeData,
+  bool AreaWayIndex::GetOffsets(FileScanner& scanner,
+                                const TypeData& typeData,
                                 double minlon,
                                 double minlat,
                                 double maxlon,
@@ -238,11 +245,10 @@ namespace osmscout {
                                 size_t maxWayCount,
                                 std::vector<FileOffset>& offsets) const
   {
-    if (!scanner.IsOpen()) {
-      if (!scanner.Open(datafilename,FileScanner::LowMemRandom,true)) {
-        std::cerr << "Error while opening " << datafilename << " for reading!" << std::endl;
-        return false;
-      }
+    PooledFileScanner scanner(scannerPool);
+
+    if (!scanner.IsValid()) {
+      return false;
     }
 
     bool                         sizeExceeded=false;
@@ -261,7 +267,8 @@ namespace osmscout {
           type<wayTypeData.size();
           ++type) {
         if (wayTypes[i].IsTypeSet(type)) {
-          if (!GetOffsets(wayTypeData[type],
+          if (!GetOffsets(*scanner,
+                          wayTypeData[type],
                           minlon,
                           minlat,
                           maxlon,
@@ -0,0 +1,335 @@
+/*
+  This source is part of the libosmscout library
+  Copyright (C) 2013  Tim Teulings
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+#include <osmscout/ContractionHierarchy.h>
+
+#include <iostream>
+#include <limits>
+
+#include <osmscout/util/FileScanner.h>
+#include <osmscout/util/FileWriter.h>
+
+namespace osmscout {
+
+  const uint32_t ContractionHierarchy::noNode=(uint32_t)-1;
+
+  /**
+    Read the edges of one node. The middle node is stored incremented by one,
+    0 signals an original edge, which is followed by the path index.
+    */
+  static bool ReadEdges(FileScanner& scanner,
+                        std::vector<ContractionHierarchy::Edge>& edges,
+                        std::vector<uint32_t>& start)
+  {
+    uint32_t edgeCount;
+
+    if (!scanner.ReadNumber(edgeCount)) {
+      return false;
+    }
+
+    for (size_t i=0; i<edgeCount; i++) {
+      ContractionHierarchy::Edge edge;
+      uint32_t                   middle;
+
+      if (!scanner.ReadNumber(edge.target) ||
+          !scanner.ReadNumber(edge.costs) ||
+          !scanner.ReadNumber(middle)) {
+        return false;
+      }
+
+      if (middle==0) {
+        edge.middle=ContractionHierarchy::noNode;
+
+        if (!scanner.ReadNumber(edge.pathIndex)) {
+          return false;
+        }
+      }
+      else {
+        edge.middle=middle-1;
+        edge.pathIndex=0;
+      }
+
+      edges.push_back(edge);
+    }
+
+    start.push_back((uint32_t)edges.size());
+
+    return true;
+  }
+
+  static bool WriteEdges(FileWriter& writer,
+                         std::vector<ContractionHierarchy::Edge>::const_iterator begin,
+                         std::vector<ContractionHierarchy::Edge>::const_iterator end)
+  {
+    writer.WriteNumber((uint32_t)(end-begin));
+
+    for (std::vector<ContractionHierarchy::Edge>::const_iterator edge=begin;
+         edge!=end;
+         ++edge) {
+      writer.WriteNumber(edge->target);
+      writer.WriteNumber(edge->costs);
+
+      if (edge->IsShortcut()) {
+        writer.WriteNumber((uint32_t)(edge->middle+1));
+      }
+      else {
+        writer.WriteNumber((uint32_t)0);
+        writer.WriteNumber(edge->pathIndex);
+      }
+    }
+
+    return !writer.HasError();
+  }
+
+  /**
+    Speeds are stored with a fixed precision, so that they can be compared
+    after reading them from file.
+    */
+  static uint32_t EncodeSpeed(double speed)
+  {
+    if (speed*1000.0>=std::numeric_limits<uint32_t>::max()) {
+      return std::numeric_limits<uint32_t>::max();
+    }
+
+    return (uint32_t)(speed*1000.0+0.5);
+  }
+
+  static void EncodeSpeeds(const AbstractRoutingProfile& profile,
+                           std::vector<uint32_t>& speeds)
+  {
+    speeds.resize(profile.GetSpeeds().size());
+
+    for (size_t i=0; i<profile.GetSpeeds().size(); i++) {
+      speeds[i]=EncodeSpeed(profile.GetSpeeds()[i]);
+    }
+  }
+
+  ContractionHierarchy::ContractionHierarchy()
+  : costScale(1),
+    vehicle(vehicleCar),
+    vehicleMaxSpeed(0)
+  {
+    forwardStart.push_back(0);
+    backwardStart.push_back(0);
+  }
+
+  void ContractionHierarchy::Clear()
+  {
+    costScale=1;
+    vehicle=vehicleCar;
+    vehicleMaxSpeed=0;
+    speeds.clear();
+    nodes.clear();
+    forwardStart.clear();
+    backwardStart.clear();
+    forwardEdges.clear();
+    backwardEdges.clear();
+    nodeIndexMap.clear();
+
+    forwardStart.push_back(0);
+    backwardStart.push_back(0);
+  }
+
+  bool ContractionHierarchy::GetNodeIndex(FileOffset offset,
+                                          uint32_t& node) const
+  {
+    NodeIndexMap::const_iterator entry=nodeIndexMap.find(offset);
+
+    if (entry==nodeIndexMap.end()) {
+      return false;
+    }
+
+    node=entry->second;
+
+    return true;
+  }
+
+  void ContractionHierarchy::SetCostScale(uint32_t costScale)
+  {
+    this->costScale=costScale;
+  }
+
+  /**
+    Store the routing profile the costs were calculated with.
+    */
+  void ContractionHierarchy::SetProfile(const AbstractRoutingProfile& profile)
+  {
+    vehicle=(uint8_t)profile.GetVehicle();
+    vehicleMaxSpeed=EncodeSpeed(profile.GetVehicleMaxSpeed());
+    EncodeSpeeds(profile,speeds);
+  }
+
+  /**
+    Return true, if the costs of the contraction hierarchy are the costs of
+    the given routing profile. This is only the case for a
+    FastestPathRoutingProfile with the same vehicle and speeds as used during
+    import.
+    */
+  bool ContractionHierarchy::IsCompatible(const RoutingProfile& profile) const
+  {
+    const FastestPathRoutingProfile* fastestProfile=dynamic_cast<const FastestPathRoutingProfile*>(&profile);
+
+    if (fastestProfile==NULL) {
+      return false;
+    }
+
+    if ((uint8_t)fastestProfile->GetVehicle()!=vehicle ||
+        EncodeSpeed(fastestProfile->GetVehicleMaxSpeed())!=vehicleMaxSpeed) {
+      return false;
+    }
+
+    std::vector<uint32_t> profileSpeeds;
+
+    EncodeSpeeds(*fastestProfile,profileSpeeds);
+
+    return profileSpeeds==speeds;
+  }
+
+  /**
+    Add the next node (nodes must be added in the order of their index)
+    together with its forward and backward edges.
+    */
+  void ContractionHierarchy::AddNode(FileOffset offset,
+                                     const std::vector<Edge>& forward,
+                                     const std::vector<Edge>& backward)
+  {
+    nodeIndexMap[offset]=(uint32_t)nodes.size();
+    nodes.push_back(offset);
+
+    forwardEdges.insert(forwardEdges.end(),forward.begin(),forward.end());
+    forwardStart.push_back((uint32_t)forwardEdges.size());
+
+    backwardEdges.insert(backwardEdges.end(),backward.begin(),backward.end());
+    backwardStart.push_back((uint32_t)backwardEdges.size());
+  }
+
+  bool ContractionHierarchy::Read(const std::string& filename)
+  {
+    FileScanner scanner;
+    uint32_t    speedCount;
+    uint32_t    nodeCount;
+    FileOffset  lastOffset=0;
+
+    Clear();
+
+    if (!scanner.Open(filename,FileScanner::Sequential,true)) {
+      std::cerr << "Cannot open file '" << scanner.GetFilename() << "'!" << std::endl;
+      return false;
+    }
+
+    if (!scanner.Read(costScale) ||
+        !scanner.Read(vehicle) ||
+        !scanner.Read(vehicleMaxSpeed) ||
+        !scanner.ReadNumber(speedCount)) {
+      std::cerr << "Error while reading header of file '" << scanner.GetFilename() << "'!" << std::endl;
+      scanner.Close();
+      Clear();
+      return false;
+    }
+
+    speeds.resize(speedCount);
+
+    for (uint32_t s=0; s<speedCount; s++) {
+      if (!scanner.ReadNumber(speeds[s])) {
+        std::cerr << "Error while reading header of file '" << scanner.GetFilename() << "'!" << std::endl;
+        scanner.Close();
+        Clear();
+        return false;
+      }
+    }
+
+    if (!scanner.Read(nodeCount)) {
+      std::cerr << "Error while reading header of file '" << scanner.GetFilename() << "'!" << std::endl;
+      scanner.Close();
+      Clear();
+      return false;
+    }
+
+    nodes.reserve(nodeCount);
+    forwardStart.reserve(nodeCount+1);
+    backwardStart.reserve(nodeCount+1);
+#if defined(OSMSCOUT_HASHMAP_HAS_RESERVE)
+    nodeIndexMap.reserve(nodeCount);
+#endif
+
+    for (uint32_t n=0; n<nodeCount; n++) {
+      FileOffset offset;
+
+      if (!scanner.ReadNumber(offset) ||
+          !ReadEdges(scanner,forwardEdges,forwardStart) ||
+          !ReadEdges(scanner,backwardEdges,backwardStart)) {
+        std::cerr << "Error while reading node " << n << " of file '" << scanner.GetFilename() << "'!" << std::endl;
+        scanner.Close();
+        Clear();
+        return false;
+      }
+
+      offset+=lastOffset;
+
+      nodeIndexMap[offset]=n;
+      nodes.push_back(offset);
+
+      lastOffset=offset;
+    }
+
+    return scanner.Close();
+  }
+
+  bool ContractionHierarchy::Write(const std::string& filename) const
+  {
+    FileWriter writer;
+    FileOffset lastOffset=0;
+
+    if (!writer.Open(filename)) {
+      std::cerr << "Cannot create file '" << filename << "'!" << std::endl;
+      return false;
+    }
+
+    writer.Write(costScale);
+    writer.Write(vehicle);
+    writer.Write(vehicleMaxSpeed);
+    writer.WriteNumber((uint32_t)speeds.size());
+
+    for (size_t s=0; s<speeds.size(); s++) {
+      writer.WriteNumber(speeds[s]);
+    }
+
+    writer.Write((uint32_t)nodes.size());
+
+    for (size_t n=0; n<nodes.size(); n++) {
+      // Nodes are in the order of the routing graph, so offsets are ascending
+      writer.WriteNumber(nodes[n]-lastOffset);
+
+      if (!WriteEdges(writer,
+                      forwardEdges.begin()+forwardStart[n],
+                      forwardEdges.begin()+forwardStart[n+1]) ||
+          !WriteEdges(writer,
+                      backwardEdges.begin()+backwardStart[n],
+                      backwardEdges.begin()+backwardStart[n+1])) {
+        std::cerr << "Error while writing file '" << filename << "'!" << std::endl;
+        writer.Close();
+        return false;
+      }
+
+      lastOffset=nodes[n];
+    }
+
+    return writer.Close();
+  }
+}
@@ -19,16 +19,29 @@
 
 #include "osmscout/CoordDataFile.h"
 
+#include <algorithm>
+#include <iostream>
+#include <limits>
+
 #include <osmscout/system/Assert.h>
 
 #include <osmscout/util/File.h>
+#include <osmscout/util/Number.h>
 
 namespace osmscout {
 
+  /**
+    Maximum size of an entry of a block (id delta and two coordinate deltas)
+    */
+  static const size_t maxEntrySize=30;
+
   CoordDataFile::CoordDataFile(const std::string& datafile)
   : isOpen(false),
     datafile(datafile),
-    coordPageSize(0)
+    coordPageSize(0),
+    compressed(false),
+    blockSize(0),
+    coordCount(0)
   {
     // no code
   }
@@ -40,57 +53,121 @@ namespace osmscout {
     }
   }
 
-  bool CoordDataFile::Open(const std::string& path,
-                           bool memoryMapedData)
+  bool CoordDataFile::ReadPageIndex()
   {
-    datafilename=AppendFileToDir(path,datafile);
+    FileOffset mapOffset;
 
-    isOpen=false;
-    coordPageOffsetMap.clear();
+    if (!scanner.Read(mapOffset)) {
+      return false;
+    }
 
-    if (scanner.Open(datafilename,
-                     FileScanner::FastRandom,
-                     memoryMapedData)) {
-      FileOffset mapOffset;
+    if (!scanner.SetPos(mapOffset)) {
+      return false;
+    }
 
-      if (!scanner.Read(coordPageSize)) {
-        Close();
+    uint32_t mapSize;
 
-        return false;
-      }
+    if (!scanner.Read(mapSize)) {
+      return false;
+    }
 
-      if (!scanner.Read(mapOffset)) {
-        Close();
+    for (size_t i=1; i<=mapSize; i++) {
+      PageId     id;
+      FileOffset offset;
 
+      if (!scanner.Read(id) ||
+          !scanner.Read(offset)) {
         return false;
       }
 
-      if (!scanner.SetPos(mapOffset)) {
-        Close();
+      coordPageOffsetMap[id]=offset;
+    }
+
+    return true;
+  }
+
+  bool CoordDataFile::ReadBlockDirectory()
+  {
+    FileOffset directoryOffset;
+    uint32_t   blockCount;
+
+    if (!scanner.Read(blockSize) ||
+        !scanner.Read(directoryOffset)) {
+      return false;
+    }
+
+    if (!scanner.SetPos(directoryOffset)) {
+      return false;
+    }
+
+    if (!scanner.Read(blockCount) ||
+        !scanner.Read(coordCount)) {
+      return false;
+    }
 
+    // All blocks but the last one are full
+    if (blockCount>0 &&
+        (blockSize==0 ||
+         coordCount<=(uint64_t)(blockCount-1)*blockSize ||
+         coordCount>(uint64_t)blockCount*blockSize)) {
+      return false;
+    }
+
+    if (blockCount==0 &&
+        coordCount>0) {
+      return false;
+    }
+
+    blockIds.resize(blockCount);
+    blockOffsets.resize(blockCount+1);
+
+    for (size_t i=0; i<blockCount; i++) {
+      if (!scanner.Read(blockIds[i]) ||
+          !scanner.Read(blockOffsets[i])) {
         return false;
       }
+    }
+
+    blockOffsets[blockCount]=directoryOffset;
+
+    return true;
+  }
+
+  bool CoordDataFile::Open(const std::string& path,
+                           bool memoryMapedData)
+  {
+    datafilename=AppendFileToDir(path,datafile);
 
-      uint32_t mapSize;
+    isOpen=false;
+    coordPageOffsetMap.clear();
+    blockIds.clear();
+    blockOffsets.clear();
 
-      if (!scanner.Read(mapSize)) {
+    if (scanner.Open(datafilename,
+                     FileScanner::FastRandom,
+                     memoryMapedData)) {
+      if (!scanner.Read(coordPageSize)) {
         Close();
 
         return false;
       }
 
-      for (size_t i=1; i<=mapSize; i++) {
-        PageId     id;
-        FileOffset offset;
+      compressed=coordPageSize==compressedFormatMarker;
 
-        if (!scanner.Read(id) ||
-            !scanner.Read(offset)) {
+      if (compressed) {
+        if (!ReadBlockDirectory()) {
+          std::cerr << "Error while reading block directory of file " << datafilename << "!" << std::endl;
           Close();
 
           return false;
         }
+      }
+      else {
+        if (!ReadPageIndex()) {
+          Close();
 
-        coordPageOffsetMap[id]=offset;
+          return false;
+        }
       }
 
       isOpen=true;
@@ -104,6 +181,8 @@ namespace osmscout {
     bool success=true;
 
     coordPageOffsetMap.clear();
+    blockIds.clear();
+    blockOffsets.clear();
 
     if (scanner.IsOpen()) {
       if (!scanner.Close()) {
@@ -116,20 +195,75 @@ namespace osmscout {
     return success;
   }
 
-  bool CoordDataFile::Get(std::set<OSMId>& ids,
-                          CoordResultMap& coordsMap) const
+  /**
+    Read and decode the given block.
+    */
+  bool CoordDataFile::ReadBlock(size_t block,
+                                std::vector<char>& buffer,
+                                std::vector<OSMId>& ids,
+                                std::vector<uint32_t>& lats,
+                                std::vector<uint32_t>& lons) const
   {
-    assert(isOpen);
+    size_t entryCount=std::min((size_t)blockSize,
+                               (size_t)coordCount-block*blockSize);
+    size_t bytes=(size_t)(blockOffsets[block+1]-blockOffsets[block]);
+
+    // Padding with zeros, so that decoding of a corrupt block stops at the
+    // end of the buffer
+    buffer.assign(bytes+maxEntrySize,0);
+    ids.resize(entryCount);
+    lats.resize(entryCount);
+    lons.resize(entryCount);
+
+    if (!scanner.SetPos(blockOffsets[block]) ||
+        (bytes>0 && !scanner.Read(&buffer[0],bytes))) {
+      std::cerr << "Error while reading data from offset " << blockOffsets[block] << " of file " << datafilename << "!" << std::endl;
+      return false;
+    }
 
-    coordsMap.clear();
-#if defined(OSMSCOUT_HASHMAP_HAS_RESERVE)
-    coordsMap.reserve(ids.size());
-#endif
+    const char* data=&buffer[0];
+    const char* end=data+bytes;
+    OSMId       id=blockIds[block];
+    int64_t     lat=0;
+    int64_t     lon=0;
+
+    for (size_t i=0; i<entryCount; i++) {
+      if (i>0) {
+        uint64_t idDelta;
+
+        data+=DecodeNumber(data,idDelta);
+
+        id+=(OSMId)idDelta;
+      }
+
+      int64_t latDelta;
+      int64_t lonDelta;
+
+      data+=DecodeNumber(data,latDelta);
+      data+=DecodeNumber(data,lonDelta);
+
+      lat+=latDelta;
+      lon+=lonDelta;
 
-    for (std::set<OSMId>::const_iterator id=ids.begin();
-         id!=ids.end();
-         ++id) {
-      PageId pageId=*id-std::numeric_limits<Id>::min();
+      ids[i]=id;
+      lats[i]=(uint32_t)lat;
+      lons[i]=(uint32_t)lon;
+    }
+
+    if (data>end) {
+      std::cerr << "Block at offset " << blockOffsets[block] << " of file " << datafilename << " is corrupt!" << std::endl;
+      return false;
+    }
+
+    return true;
+  }
+
+  bool CoordDataFile::GetFromPages(const std::vector<OSMId>& ids,
+                                   std::vector<Point>& coords,
+                                   std::vector<bool>& found) const
+  {
+    for (size_t i=0; i<ids.size(); i++) {
+      PageId pageId=ids[i]-std::numeric_limits<Id>::min();
       PageId coordPageId=pageId/coordPageSize;
 
       CoordPageOffsetMap::const_iterator pageOffset=coordPageOffsetMap.find(coordPageId);
@@ -156,10 +290,138 @@ namespace osmscout {
           return false;
         }
 
-        coordsMap.insert(std::make_pair(*id,
-                                        CoordEntry(substituteId,
-                                                   latDat/conversionFactor-90.0,
-                                                   lonDat/conversionFactor-180.0)));
+        coords[i]=Point(substituteId,
+                        latDat/conversionFactor-90.0,
+                        lonDat/conversionFactor-180.0);
+        found[i]=true;
+      }
+    }
+
+    return true;
+  }
+
+  /**
+    Walk the sorted list of ids and the blocks in parallel, each block
+    required is read and decoded once. The substitute id of a coordinate is
+    its (1 based) index in the file.
+    */
+  bool CoordDataFile::GetFromBlocks(const std::vector<OSMId>& ids,
+                                    std::vector<Point>& coords,
+                                    std::vector<bool>& found) const
+  {
+    std::vector<char>     buffer;
+    std::vector<OSMId>    blockEntryIds;
+    std::vector<uint32_t> lats;
+    std::vector<uint32_t> lons;
+    size_t                currentBlock=blockIds.size();
+    size_t                entry=0;
+
+    for (size_t i=0; i<ids.size(); i++) {
+      OSMId id=ids[i];
+
+      if (blockIds.empty() ||
+          id<blockIds.front()) {
+        continue;
+      }
+
+      size_t block=currentBlock;
+
+      if (currentBlock==blockIds.size() ||
+          id<blockIds[currentBlock] ||
+          (currentBlock+1<blockIds.size() && id>=blockIds[currentBlock+1])) {
+        // The last block with a first id <= id
+        block=std::upper_bound(blockIds.begin(),
+                               blockIds.end(),
+                               id)-blockIds.begin()-1;
+      }
+
+      if (block!=currentBlock) {
+        if (!ReadBlock(block,
+                       buffer,
+                       blockEntryIds,
+                       lats,
+                       lons)) {
+          return false;
+        }
+
+        currentBlock=block;
+        entry=0;
+      }
+      else if (entry<blockEntryIds.size() &&
+               blockEntryIds[entry]>id) {
+        // ids are not sorted, restart at the beginning of the block
+        entry=0;
+      }
+
+      while (entry<blockEntryIds.size() &&
+             blockEntryIds[entry]<id) {
+        entry++;
+      }
+
+      if (entry<blockEntryIds.size() &&
+          blockEntryIds[entry]==id) {
+        coords[i]=Point(currentBlock*blockSize+entry+1,
+                        lats[entry]/conversionFactor-90.0,
+                        lons[entry]/conversionFactor-180.0);
+        found[i]=true;
+      }
+    }
+
+    return true;
+  }
+
+  /**
+    Return the coordinates of the given ids. coords[n] holds the
+    coordinate of ids[n], if found[n] is true. The ids should be sorted,
+    in this case the file is read sequentially.
+    */
+  bool CoordDataFile::Get(const std::vector<OSMId>& ids,
+                          std::vector<Point>& coords,
+                          std::vector<bool>& found) const
+  {
+    assert(isOpen);
+
+    coords.assign(ids.size(),Point());
+    found.assign(ids.size(),false);
+
+    if (compressed) {
+      return GetFromBlocks(ids,
+                           coords,
+                           found);
+    }
+    else {
+      return GetFromPages(ids,
+                          coords,
+                          found);
+    }
+  }
+
+  bool CoordDataFile::Get(std::set<OSMId>& ids,
+                          CoordResultMap& coordsMap) const
+  {
+    assert(isOpen);
+
+    std::vector<OSMId> idList(ids.begin(),ids.end());
+    std::vector<Point> coords;
+    std::vector<bool>  found;
+
+    coordsMap.clear();
+#if defined(OSMSCOUT_HASHMAP_HAS_RESERVE)
+    coordsMap.reserve(ids.size());
+#endif
+
+    if (!Get(idList,
+             coords,
+             found)) {
+      return false;
+    }
+
+    for (size_t i=0; i<idList.size(); i++) {
+      if (found[i]) {
+        coordsMap.insert(std::make_pair(idList[i],
+                                        CoordEntry(coords[i].GetId(),
+                                                   coords[i].GetLat(),
+                                                   coords[i].GetLon())));
       }
     }
 
@@ -38,9 +38,9 @@ namespace osmscout {
   DatabaseParameter::DatabaseParameter()
   : areaAreaIndexCacheSize(1000),
     areaNodeIndexCacheSize(1000),
-    nodeCacheSize(1000),
-    wayCacheSize(4000),
-    areaCacheSize(4000),
+    nodeCacheSizeBytes(1024*1024),
+    wayCacheSizeBytes(4*1024*1024),
+    areaCacheSizeBytes(4*1024*1024),
     debugPerformance(false)
   {
     // no code
@@ -56,19 +56,19 @@ namespace osmscout {
     this->areaNodeIndexCacheSize=areaNodeIndexCacheSize;
   }
 
-  void DatabaseParameter::SetNodeCacheSize(unsigned long nodeCacheSize)
+  void DatabaseParameter::SetNodeCacheSizeBytes(unsigned long nodeCacheSizeBytes)
   {
-    this->nodeCacheSize=nodeCacheSize;
+    this->nodeCacheSizeBytes=nodeCacheSizeBytes;
   }
 
-  void DatabaseParameter::SetWayCacheSize(unsigned long wayCacheSize)
+  void DatabaseParameter::SetWayCacheSizeBytes(unsigned long wayCacheSizeBytes)
   {
-    this->wayCacheSize=wayCacheSize;
+    this->wayCacheSizeBytes=wayCacheSizeBytes;
   }
 
-  void DatabaseParameter::SetAreaCacheSize(unsigned long areaCacheSize)
+  void DatabaseParameter::SetAreaCacheSizeBytes(unsigned long areaCacheSizeBytes)
   {
-    this->areaCacheSize=areaCacheSize;
+    this->areaCacheSizeBytes=areaCacheSizeBytes;
   }
 
   void DatabaseParameter::SetDebugPerformance(bool debug)
@@ -86,19 +86,19 @@ namespace osmscout {
     return areaNodeIndexCacheSize;
   }
 
-  unsigned long DatabaseParameter::GetNodeCacheSize() const
+  unsigned long DatabaseParameter::GetNodeCacheSizeBytes() const
   {
-    return nodeCacheSize;
+    return nodeCacheSizeBytes;
   }
 
-  unsigned long DatabaseParameter::GetWayCacheSize() const
+  unsigned long DatabaseParameter::GetWayCacheSizeBytes() const
   {
-    return wayCacheSize;
+    return wayCacheSizeBytes;
   }
 
-  unsigned long DatabaseParameter::GetAreaCacheSize() const
+  unsigned long DatabaseParameter::GetAreaCacheSizeBytes() const
   {
-    return areaCacheSize;
+    return areaCacheSizeBytes;
   }
 
   bool DatabaseParameter::IsDebugPerformance() const
@@ -203,11 +203,11 @@ namespace osmscout {
      areaWayIndex(),
      areaAreaIndex(parameter.GetAreaAreaIndexCacheSize()),
      nodeDataFile("nodes.dat",
-                  parameter.GetNodeCacheSize()),
+                  parameter.GetNodeCacheSizeBytes()),
      areaDataFile("areas.dat",
-                  parameter.GetAreaCacheSize()),
+                  parameter.GetAreaCacheSizeBytes()),
      wayDataFile("ways.dat",
-                  parameter.GetWayCacheSize()),
+                  parameter.GetWayCacheSizeBytes()),
      typeConfig(NULL)
   {
     // no code
@@ -457,6 +457,7 @@ namespace osmscout {
     return true;
   }
 
+  template<class A>
   bool Database::GetObjectsAreas(const AreaSearchParameter& parameter,
                                  const TypeSet& areaTypes,
                                  const Magnification& magnification,
@@ -465,7 +466,7 @@ namespace osmscout {
                                  std::string& areaOptimizedTime,
                                  std::string& areaIndexTime,
                                  std::string& areasTime,
-                                 std::vector<AreaRef>& areas) const
+                                 std::vector<A>& areas) const
   {
     TypeSet internalAreaTypes(areaTypes);
 
@@ -544,6 +545,7 @@ namespace osmscout {
     return !parameter.IsAborted();
   }
 
+  template<class W>
   bool Database::GetObjectsWays(const AreaSearchParameter& parameter,
                                 const std::vector<TypeSet>& wayTypes,
                                 const Magnification& magnification,
@@ -552,7 +554,7 @@ namespace osmscout {
                                 std::string& wayOptimizedTime,
                                 std::string& wayIndexTime,
                                 std::string& waysTime,
-                                std::vector<WayRef>& ways) const
+                                std::vector<W>& ways) const
   {
     std::vector<TypeSet> internalWayTypes(wayTypes);
 
@@ -628,44 +630,21 @@ namespace osmscout {
     return !parameter.IsAborted();
   }
 
-  bool Database::GetObjects(const TypeSet &nodeTypes,
-                            const std::vector<TypeSet>& wayTypes,
-                            const TypeSet& areaTypes,
-                            double lonMin, double latMin,
-                            double lonMax, double latMax,
-                            const Magnification& magnification,
-                            const AreaSearchParameter& parameter,
-                            std::vector<NodeRef>& nodes,
-                            std::vector<WayRef>& ways,
-                            std::vector<AreaRef>& areas) const
-  {
-    return GetObjects(parameter,
-                      magnification,
-                      nodeTypes,
-                      lonMin,latMin,lonMax,latMax,
-                      nodes,
-                      wayTypes,
-                      lonMin,latMin,lonMax,latMax,
-                      ways,
-                      areaTypes,
-                      lonMin,latMin,lonMax,latMax,
-                      areas);
-  }
-
-  bool Database::GetObjects(const AreaSearchParameter& parameter,
-                            const Magnification& magnification,
-                            const TypeSet &nodeTypes,
-                            double nodeLonMin, double nodeLatMin,
-                            double nodeLonMax, double nodeLatMax,
-                            std::vector<NodeRef>& nodes,
-                            const std::vector<TypeSet>& wayTypes,
-                            double wayLonMin, double wayLatMin,
-                            double wayLonMax, double wayLatMax,
-                            std::vector<WayRef>& ways,
-                            const TypeSet& areaTypes,
-                            double areaLonMin, double areaLatMin,
-                            double areaLonMax, double areaLatMax,
-                            std::vector<AreaRef>& areas) const
+  template<class W, class A>
+  bool Database::CollectObjects(const AreaSearchParameter& parameter,
+                                const Magnification& magnification,
+                                const TypeSet &nodeTypes,
+                                double nodeLonMin, double nodeLatMin,
+                                double nodeLonMax, double nodeLatMax,
+                                std::vector<NodeRef>& nodes,
+                                const std::vector<TypeSet>& wayTypes,
+                                double wayLonMin, double wayLatMin,
+                                double wayLonMax, double wayLatMax,
+                                std::vector<W>& ways,
+                                const TypeSet& areaTypes,
+                                double areaLonMin, double areaLatMin,
+                                double areaLonMax, double areaLatMax,
+                                std::vector<A>& areas) const
   {
     std::string nodeIndexTime;
     std::string nodesTime;
@@ -757,6 +736,171 @@ namespace osmscout {
     return true;
   }
 
+  bool Database::GetObjects(const AreaSearchParameter& parameter,
+                            const Magnification& magnification,
+                            const TypeSet &nodeTypes,
+                            double nodeLonMin, double nodeLatMin,
+                            double nodeLonMax, double nodeLatMax,
+                            std::vector<NodeRef>& nodes,
+                            const std::vector<TypeSet>& wayTypes,
+                            double wayLonMin, double wayLatMin,
+                            double wayLonMax, double wayLatMax,
+                            std::vector<WayRef>& ways,
+                            const TypeSet& areaTypes,
+                            double areaLonMin, double areaLatMin,
+                            double areaLonMax, double areaLatMax,
+                            std::vector<AreaRef>& areas) const
+  {
+    return CollectObjects(parameter,
+                          magnification,
+                          nodeTypes,
+                          nodeLonMin,nodeLatMin,nodeLonMax,nodeLatMax,
+                          nodes,
+                          wayTypes,
+                          wayLonMin,wayLatMin,wayLonMax,wayLatMax,
+                          ways,
+                          areaTypes,
+                          areaLonMin,areaLatMin,areaLonMax,areaLatMax,
+                          areas);
+  }
+
+  bool Database::GetObjects(const AreaSearchParameter& parameter,
+                            const Magnification& magnification,
+                            const TypeSet &nodeTypes,
+                            double nodeLonMin, double nodeLatMin,
+                            double nodeLonMax, double nodeLatMax,
+                            std::vector<NodeRef>& nodes,
+                            const std::vector<TypeSet>& wayTypes,
+                            double wayLonMin, double wayLatMin,
+                            double wayLonMax, double wayLatMax,
+                            std::vector<WayView>& ways,
+                            const TypeSet& areaTypes,
+                            double areaLonMin, double areaLatMin,
+                            double areaLonMax, double areaLatMax,
+                            std::vector<AreaView>& areas) const
+  {
+    return CollectObjects(parameter,
+                          magnification,
+                          nodeTypes,
+                          nodeLonMin,nodeLatMin,nodeLonMax,nodeLatMax,
+                          nodes,
+                          wayTypes,
+                          wayLonMin,wayLatMin,wayLonMax,wayLatMax,
+                          ways,
+                          areaTypes,
+                          areaLonMin,areaLatMin,areaLonMax,areaLatMax,
+                          areas);
+  }
+
+  bool Database::GetObjects(const TypeSet &nodeTypes,
+                            const std::vector<TypeSet>& wayTypes,
+                            const TypeSet& areaTypes,
+                            double lonMin, double latMin,
+                            double lonMax, double latMax,
+                            const Magnification& magnification,
+                            const AreaSearchParameter& parameter,
+                            std::vector<NodeRef>& nodes,
+                            std::vector<WayRef>& ways,
+                            std::vector<AreaRef>& areas) const
+  {
+    return GetObjects(parameter,
+                      magnification,
+                      nodeTypes,
+                      lonMin,latMin,lonMax,latMax,
+                      nodes,
+                      wayTypes,
+                      lonMin,latMin,lonMax,latMax,
+                      ways,
+                      areaTypes,
+                      lonMin,latMin,lonMax,latMax,
+                      areas);
+  }
+
+  bool Database::GetObjects(const TypeSet &nodeTypes,
+                            const std::vector<TypeSet>& wayTypes,
+                            const TypeSet& areaTypes,
+                            double lonMin, double latMin,
+                            double lonMax, double latMax,
+                            const Magnification& magnification,
+                            const AreaSearchParameter& parameter,
+                            std::vector<NodeRef>& nodes,
+                            std::vector<WayView>& ways,
+                            std::vector<AreaView>& areas) const
+  {
+    return GetObjects(parameter,
+                      magnification,
+                      nodeTypes,
+                      lonMin,latMin,lonMax,latMax,
+                      nodes,
+                      wayTypes,
+                      lonMin,latMin,lonMax,latMax,
+                      ways,
+                      areaTypes,
+                      lonMin,latMin,lonMax,latMax,
+                      areas);
+  }
+
+  /**
+    Load the objects for the slippy map tiles xStart...xEnd, yStart...yEnd
+    of the given zoom level at once and assign them to the individual tiles
+    (see TiledObjects). Nodes and areas are also loaded for the tiles
+    around the block.
+    */
+  bool Database::GetObjectsForTiles(const AreaSearchParameter& parameter,
+                                    const Magnification& magnification,
+                                    const TypeSet &nodeTypes,
+                                    const std::vector<TypeSet>& wayTypes,
+                                    const TypeSet& areaTypes,
+                                    size_t zoom,
+                                    size_t xStart,
+                                    size_t yStart,
+                                    size_t xEnd,
+                                    size_t yEnd,
+                                    TiledObjects& objects) const
+  {
+    std::vector<NodeRef> nodes;
+    std::vector<WayRef>  ways;
+    std::vector<AreaRef> areas;
+    size_t               maxTile=(size_t)pow(2.0,(double)zoom)-1;
+
+    objects.Clear();
+
+    double lonMin=TiledObjects::GetTileLon(xStart,zoom);
+    double lonMax=TiledObjects::GetTileLon(xEnd+1,zoom);
+    double latMin=TiledObjects::GetTileLat(yEnd+1,zoom);
+    double latMax=TiledObjects::GetTileLat(yStart,zoom);
+
+    double lonMin2=TiledObjects::GetTileLon(xStart>0 ? xStart-1 : 0,zoom);
+    double lonMax2=TiledObjects::GetTileLon(std::min(xEnd+1,maxTile)+1,zoom);
+    double latMin2=TiledObjects::GetTileLat(std::min(yEnd+1,maxTile)+1,zoom);
+    double latMax2=TiledObjects::GetTileLat(yStart>0 ? yStart-1 : 0,zoom);
+
+    if (!CollectObjects(parameter,
+                        magnification,
+                        nodeTypes,
+                        lonMin2,latMin2,lonMax2,latMax2,
+                        nodes,
+                        wayTypes,
+                        lonMin,latMin,lonMax,latMax,
+                        ways,
+                        areaTypes,
+                        lonMin2,latMin2,lonMax2,latMax2,
+                        areas)) {
+      return false;
+    }
+
+    objects.Set(zoom,
+                xStart,
+                yStart,
+                xEnd,
+                yEnd,
+                nodes,
+                ways,
+                areas);
+
+    return true;
+  }
+
   bool Database::GetObjects(double lonMin, double latMin,
                             double lonMax, double latMax,
                             const TypeSet& types,
@@ -1068,6 +1212,16 @@ namespace osmscout {
     return areaDataFile.GetByOffset(offsets,dataMap);
   }
 
+  bool Database::GetAreasByOffset(const std::vector<FileOffset>& offsets,
+                                  std::vector<AreaView>& areas) const
+  {
+    if (!IsOpen()) {
+      return false;
+    }
+
+    return areaDataFile.GetViewsByOffset(offsets,areas);
+  }
+
   bool Database::GetWayByOffset(const FileOffset& offset,
                                 WayRef& way) const
   {
@@ -1130,6 +1284,16 @@ namespace osmscout {
     return wayDataFile.GetByOffset(offsets,dataMap);
   }
 
+  bool Database::GetWaysByOffset(const std::vector<FileOffset>& offsets,
+                                 std::vector<WayView>& ways) const
+  {
+    if (!IsOpen()) {
+      return false;
+    }
+
+    return wayDataFile.GetViewsByOffset(offsets,ways);
+  }
+
   bool Database::VisitAdminRegions(AdminRegionVisitor& visitor) const
   {
     if (!IsOpen()) {
@@ -32,6 +32,16 @@ namespace osmscout {
     // no code
   }
 
+  /**
+    Returns the estimated memory used by the intersection, including all
+    dynamically allocated data.
+    */
+  unsigned long Intersection::GetMemorySize() const
+  {
+    return sizeof(Intersection)+
+           objects.capacity()*sizeof(ObjectFileRef);
+  }
+
   bool Intersection::Read(FileScanner& scanner)
   {
     if (!scanner.ReadNumber(nodeId)) {
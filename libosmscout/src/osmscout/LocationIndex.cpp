@@ -31,6 +31,10 @@ namespace osmscout {
   const char* const LocationIndex::FILENAME_LOCATION_IDX = "location.idx";
 
   LocationIndex::LocationIndex()
+  : bytesForNodeFileOffset(0),
+    bytesForAreaFileOffset(0),
+    bytesForWayFileOffset(0),
+    indexOffset(0)
   {
     // no code
   }
@@ -42,12 +46,30 @@ namespace osmscout {
 
   bool LocationIndex::Load(const std::string& path)
   {
+    FileScanner scanner;
+
     this->path=path;
 
-    return true;
+    if (!scanner.Open(AppendFileToDir(path,
+                                      FILENAME_LOCATION_IDX),
+                      FileScanner::LowMemRandom,
+                      false)) {
+      std::cerr << "Cannot open file '" << scanner.GetFilename() << "'!" << std::endl;
+      return false;
+    }
+
+    if (!ReadObjectFileOffsetBytes(scanner)) {
+      return false;
+    }
+
+    if (!scanner.GetPos(indexOffset)) {
+      return false;
+    }
+
+    return !scanner.HasError() && scanner.Close();
   }
 
-  bool LocationIndex::ReadObjectFileOffsetBytes(FileScanner& scanner) const
+  bool LocationIndex::ReadObjectFileOffsetBytes(FileScanner& scanner)
   {
     return scanner.Read(bytesForNodeFileOffset) &&
            scanner.Read(bytesForAreaFileOffset) &&
@@ -454,7 +476,7 @@ namespace osmscout {
       return false;
     }
 
-    if (!ReadObjectFileOffsetBytes(scanner)) {
+    if (!scanner.SetPos(indexOffset)) {
       return false;
     }
 
@@ -508,7 +530,7 @@ namespace osmscout {
       return false;
     }
 
-    if (!ReadObjectFileOffsetBytes(scanner)) {
+    if (!scanner.SetPos(indexOffset)) {
       return false;
     }
 
@@ -541,7 +563,7 @@ namespace osmscout {
       return false;
     }
 
-    if (!ReadObjectFileOffsetBytes(scanner)) {
+    if (!scanner.SetPos(indexOffset)) {
       return false;
     }
 
@@ -569,7 +591,7 @@ namespace osmscout {
       return false;
     }
 
-    if (!ReadObjectFileOffsetBytes(scanner)) {
+    if (!scanner.SetPos(indexOffset)) {
       return false;
     }
 
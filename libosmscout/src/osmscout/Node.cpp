@@ -180,6 +180,27 @@ namespace osmscout {
     return !writer.HasError();
   }
 
+  /**
+    Returns the memory used by the dynamically allocated data of the attributes,
+    excluding the size of the object itself.
+    */
+  unsigned long NodeAttributes::GetMemorySize() const
+  {
+    unsigned long memory=name.capacity()+
+                         nameAlt.capacity()+
+                         location.capacity()+
+                         address.capacity()+
+                         tags.capacity()*sizeof(Tag);
+
+    for (std::vector<Tag>::const_iterator tag=tags.begin();
+         tag!=tags.end();
+         ++tag) {
+      memory+=tag->value.capacity();
+    }
+
+    return memory;
+  }
+
   bool NodeAttributes::operator==(const NodeAttributes& other) const
   {
     if (name!=other.name ||
@@ -235,6 +256,16 @@ namespace osmscout {
                               tags);
   }
 
+  /**
+    Returns the estimated memory used by the node, including all dynamically
+    allocated data.
+    */
+  unsigned long Node::GetMemorySize() const
+  {
+    return sizeof(Node)+
+           attributes.GetMemorySize();
+  }
+
   bool Node::Read(FileScanner& scanner)
   {
     uint32_t tmpType;
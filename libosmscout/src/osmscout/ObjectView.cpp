@@ -0,0 +1,1035 @@
+/*
+  This source is part of the libosmscout library
+  Copyright (C) 2013  Tim Teulings
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+#include <osmscout/ObjectView.h>
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+#include <osmscout/Area.h>
+#include <osmscout/Way.h>
+
+#include <osmscout/util/CoordEncoding.h>
+#include <osmscout/util/Number.h>
+
+#include <osmscout/system/Math.h>
+
+namespace osmscout {
+
+  static const char* const emptyString="";
+
+  namespace {
+
+  /**
+    Bounds checked decoding of data written by FileWriter from a memory buffer.
+    */
+  class MemoryScanner
+  {
+  public:
+    const char* pos;
+    const char* end;
+    bool        error;
+
+  public:
+    inline MemoryScanner(const char* pos,
+                         const char* end)
+    : pos(pos),
+      end(end),
+      error(pos==NULL || pos>=end)
+    {
+      // no code
+    }
+
+    inline bool Read(uint8_t& number)
+    {
+      if (error || pos+1>end) {
+        error=true;
+        return false;
+      }
+
+      number=(uint8_t)*pos;
+      pos++;
+
+      return true;
+    }
+
+    inline bool Read(int8_t& number)
+    {
+      if (error || pos+1>end) {
+        error=true;
+        return false;
+      }
+
+      number=(int8_t)*pos;
+      pos++;
+
+      return true;
+    }
+
+    inline bool Read(uint16_t& number)
+    {
+      if (error || pos+2>end) {
+        error=true;
+        return false;
+      }
+
+      number=(uint16_t)((unsigned char)pos[0] |
+                        ((unsigned char)pos[1] << 8));
+      pos+=2;
+
+      return true;
+    }
+
+    inline bool Read(uint32_t& number)
+    {
+      if (error || pos+4>end) {
+        error=true;
+        return false;
+      }
+
+      number=(uint32_t)(unsigned char)pos[0] |
+             ((uint32_t)(unsigned char)pos[1] << 8) |
+             ((uint32_t)(unsigned char)pos[2] << 16) |
+             ((uint32_t)(unsigned char)pos[3] << 24);
+      pos+=4;
+
+      return true;
+    }
+
+    /**
+      Checks that the variable length encoded number at the current position
+      ends before the end of the buffer.
+      */
+    inline bool CheckNumber()
+    {
+      if (error) {
+        return false;
+      }
+
+      const char* current=pos;
+
+      while (current<end &&
+             (*current & 0x80)!=0) {
+        current++;
+      }
+
+      if (current>=end) {
+        error=true;
+        return false;
+      }
+
+      return true;
+    }
+
+    template<typename N>
+    inline bool ReadNumber(N& number)
+    {
+      if (!CheckNumber()) {
+        return false;
+      }
+
+      pos+=DecodeNumber(pos,number);
+
+      return true;
+    }
+
+    inline bool SkipNumber()
+    {
+      if (!CheckNumber()) {
+        return false;
+      }
+
+      while ((*pos & 0x80)!=0) {
+        pos++;
+      }
+
+      pos++;
+
+      return true;
+    }
+
+    inline bool SkipNumbers(size_t count)
+    {
+      for (size_t i=0; i<count; i++) {
+        if (!SkipNumber()) {
+          return false;
+        }
+      }
+
+      return true;
+    }
+
+    /**
+      Returns a pointer to the '\0' terminated string at the current position.
+      */
+    inline bool ReadString(const char*& value)
+    {
+      if (error) {
+        return false;
+      }
+
+      const char* terminator=(const char*)memchr(pos,'\0',end-pos);
+
+      if (terminator==NULL) {
+        error=true;
+        return false;
+      }
+
+      value=pos;
+      pos=terminator+1;
+
+      return true;
+    }
+
+    inline bool ReadTags(uint32_t tagCount,
+                         std::vector<Tag>& tags)
+    {
+      tags.resize(tagCount);
+
+      for (size_t i=0; i<tagCount; i++) {
+        const char* value;
+
+        ReadNumber(tags[i].key);
+
+        if (!ReadString(value)) {
+          return false;
+        }
+
+        tags[i].value=value;
+      }
+
+      return !error;
+    }
+
+    inline bool SkipTags(uint32_t tagCount)
+    {
+      for (size_t i=0; i<tagCount; i++) {
+        const char* value;
+
+        SkipNumber();
+
+        if (!ReadString(value)) {
+          return false;
+        }
+      }
+
+      return !error;
+    }
+
+    /**
+      Locates the control and data bytes of delta encoded coordinates (see
+      CoordEncoding.h) at the current position and skips them.
+      */
+    inline bool ReadCoordDeltas(uint32_t nodeCount,
+                                const unsigned char*& control,
+                                const unsigned char*& data)
+    {
+      size_t controlSize=GetCoordDeltaControlSize(nodeCount);
+
+      if (error || controlSize>(size_t)(end-pos)) {
+        error=true;
+        return false;
+      }
+
+      control=reinterpret_cast<const unsigned char*>(pos);
+
+      size_t dataSize=controlSize>0 ? GetCoordDeltaDataSize(control,nodeCount) : 0;
+
+      if (controlSize+dataSize>(size_t)(end-pos)) {
+        error=true;
+        return false;
+      }
+
+      data=control+controlSize;
+      pos+=controlSize+dataSize;
+
+      return true;
+    }
+
+    inline bool ReadCoords(uint32_t nodeCount,
+                           std::vector<GeoCoord>& nodes)
+    {
+      uint32_t minLat;
+      uint32_t minLon;
+
+      if (!Read(minLat) ||
+          !Read(minLon)) {
+        return false;
+      }
+
+      if (minLat & coordDeltaEncodingFlag) {
+        const unsigned char* control;
+        const unsigned char* data;
+
+        if (!ReadCoordDeltas(nodeCount,
+                             control,
+                             data)) {
+          return false;
+        }
+
+        // The decoder may read some bytes behind the data
+        if ((size_t)(end-pos)<coordDeltaPadding) {
+          std::vector<unsigned char> buffer(data,
+                                            reinterpret_cast<const unsigned char*>(pos));
+
+          buffer.resize(buffer.size()+coordDeltaPadding,0);
+
+          DecodeCoordDeltas(minLat & ~coordDeltaEncodingFlag,
+                            minLon,
+                            control,
+                            &buffer[0],
+                            nodeCount,
+                            nodes);
+        }
+        else {
+          DecodeCoordDeltas(minLat & ~coordDeltaEncodingFlag,
+                            minLon,
+                            control,
+                            data,
+                            nodeCount,
+                            nodes);
+        }
+
+        return true;
+      }
+
+      nodes.resize(nodeCount);
+
+      for (size_t i=0; i<nodeCount; i++) {
+        uint32_t latValue;
+        uint32_t lonValue;
+
+        ReadNumber(latValue);
+
+        if (!ReadNumber(lonValue)) {
+          return false;
+        }
+
+        nodes[i].SetValues(minLat+latValue,
+                           minLon+lonValue);
+      }
+
+      return !error;
+    }
+
+    inline bool SkipCoords(uint32_t nodeCount)
+    {
+      uint32_t minLat;
+      uint32_t minLon;
+
+      if (!Read(minLat) ||
+          !Read(minLon)) {
+        return false;
+      }
+
+      if (minLat & coordDeltaEncodingFlag) {
+        const unsigned char* control;
+        const unsigned char* data;
+
+        return ReadCoordDeltas(nodeCount,
+                               control,
+                               data);
+      }
+
+      return SkipNumbers(2*(size_t)nodeCount);
+    }
+
+    inline bool GetBoundingBox(uint32_t nodeCount,
+                               double& minLon,
+                               double& maxLon,
+                               double& minLat,
+                               double& maxLat)
+    {
+      uint32_t minLatBase;
+      uint32_t minLonBase;
+      uint32_t minLatValue=std::numeric_limits<uint32_t>::max();
+      uint32_t maxLatValue=0;
+      uint32_t minLonValue=std::numeric_limits<uint32_t>::max();
+      uint32_t maxLonValue=0;
+
+      if (nodeCount==0) {
+        return false;
+      }
+
+      if (error || pos+4>end) {
+        error=true;
+        return false;
+      }
+
+      if ((unsigned char)pos[3] & (coordDeltaEncodingFlag >> 24)) {
+        std::vector<GeoCoord> nodes;
+
+        if (!ReadCoords(nodeCount,
+                        nodes)) {
+          return false;
+        }
+
+        minLat=nodes[0].GetLat();
+        maxLat=nodes[0].GetLat();
+        minLon=nodes[0].GetLon();
+        maxLon=nodes[0].GetLon();
+
+        for (size_t i=1; i<nodes.size(); i++) {
+          minLat=std::min(minLat,nodes[i].GetLat());
+          maxLat=std::max(maxLat,nodes[i].GetLat());
+          minLon=std::min(minLon,nodes[i].GetLon());
+          maxLon=std::max(maxLon,nodes[i].GetLon());
+        }
+
+        return true;
+      }
+
+      if (!Read(minLatBase) ||
+          !Read(minLonBase)) {
+        return false;
+      }
+
+      for (size_t i=0; i<nodeCount; i++) {
+        uint32_t latValue;
+        uint32_t lonValue;
+
+        ReadNumber(latValue);
+
+        if (!ReadNumber(lonValue)) {
+          return false;
+        }
+
+        minLatValue=std::min(minLatValue,latValue);
+        maxLatValue=std::max(maxLatValue,latValue);
+        minLonValue=std::min(minLonValue,lonValue);
+        maxLonValue=std::max(maxLonValue,lonValue);
+      }
+
+      minLat=(minLatBase+minLatValue)/conversionFactor-90.0;
+      maxLat=(minLatBase+maxLatValue)/conversionFactor-90.0;
+      minLon=(minLonBase+minLonValue)/conversionFactor-180.0;
+      maxLon=(minLonBase+maxLonValue)/conversionFactor-180.0;
+
+      return !error;
+    }
+  };
+
+  }
+
+  WayView::WayView()
+  : fileOffset(0),
+    end(NULL),
+    optimized(false),
+    type(typeIgnore),
+    flags(0),
+    name(emptyString),
+    nameAlt(emptyString),
+    ref(emptyString),
+    location(emptyString),
+    address(emptyString),
+    layer(0),
+    width(0),
+    maxSpeed(0),
+    grade(1),
+    tagCount(0),
+    tags(NULL),
+    nodeCount(0),
+    coords(NULL)
+  {
+    // no code
+  }
+
+  bool WayView::IsBridge() const
+  {
+    return (flags & WayAttributes::isBridge)!=0;
+  }
+
+  bool WayView::IsTunnel() const
+  {
+    return (flags & WayAttributes::isTunnel)!=0;
+  }
+
+  bool WayView::IsRoundabout() const
+  {
+    return (flags & WayAttributes::isRoundabout)!=0;
+  }
+
+  bool WayView::HasAccess() const
+  {
+    return (flags & WayAttributes::hasAccess)!=0;
+  }
+
+  bool WayView::GetTags(std::vector<Tag>& tags) const
+  {
+    if (tagCount==0) {
+      tags.clear();
+
+      return true;
+    }
+
+    MemoryScanner scanner(this->tags,end);
+
+    return scanner.ReadTags(tagCount,
+                            tags);
+  }
+
+  bool WayView::GetNodes(std::vector<GeoCoord>& nodes) const
+  {
+    MemoryScanner scanner(coords,end);
+
+    return scanner.ReadCoords(nodeCount,
+                              nodes);
+  }
+
+  bool WayView::GetIds(std::vector<Id>& ids) const
+  {
+    if (optimized) {
+      ids.clear();
+
+      return true;
+    }
+
+    MemoryScanner scanner(coords,end);
+    uint32_t      idCount;
+
+    if (!scanner.SkipCoords(nodeCount)) {
+      return false;
+    }
+
+    ids.assign(nodeCount,0);
+
+    if (!scanner.ReadNumber(idCount)) {
+      return false;
+    }
+
+    if (idCount>0) {
+      Id minId=0;
+
+      if (!scanner.ReadNumber(minId)) {
+        return false;
+      }
+
+      for (size_t i=1; i<=idCount; i++) {
+        uint32_t index=0;
+        Id       id=0;
+
+        if (!scanner.ReadNumber(index) ||
+            !scanner.ReadNumber(id) ||
+            index>=nodeCount) {
+          return false;
+        }
+
+        ids[index]=id+minId;
+      }
+    }
+
+    return !scanner.error;
+  }
+
+  bool WayView::GetBoundingBox(double& minLon,
+                               double& maxLon,
+                               double& minLat,
+                               double& maxLat) const
+  {
+    MemoryScanner scanner(coords,end);
+
+    return scanner.GetBoundingBox(nodeCount,
+                                  minLon,
+                                  maxLon,
+                                  minLat,
+                                  maxLat);
+  }
+
+  bool WayView::Read(const char* buffer,
+                     FileOffset size,
+                     FileOffset offset,
+                     bool optimized)
+  {
+    if (buffer==NULL ||
+        offset>=size) {
+      return false;
+    }
+
+    MemoryScanner scanner(buffer+offset,buffer+size);
+    uint8_t       access;
+
+    this->fileOffset=offset;
+    this->end=buffer+size;
+    this->optimized=optimized;
+
+    scanner.ReadNumber(type);
+    scanner.Read(flags);
+    scanner.Read(access);
+
+    name=emptyString;
+    nameAlt=emptyString;
+    ref=emptyString;
+    location=emptyString;
+    address=emptyString;
+
+    if (flags & WayAttributes::hasName) {
+      scanner.ReadString(name);
+    }
+
+    if (flags & WayAttributes::hasNameAlt) {
+      scanner.ReadString(nameAlt);
+    }
+
+    if (flags & WayAttributes::hasRef) {
+      scanner.ReadString(ref);
+    }
+
+    if (flags & WayAttributes::hasLocation) {
+      scanner.ReadString(location);
+    }
+
+    if (flags & WayAttributes::hasAddress) {
+      scanner.ReadString(address);
+    }
+
+    layer=0;
+    width=0;
+    maxSpeed=0;
+    grade=1;
+
+    if (flags & WayAttributes::hasLayer) {
+      scanner.Read(layer);
+    }
+
+    if (flags & WayAttributes::hasWidth) {
+      scanner.Read(width);
+    }
+
+    if (flags & WayAttributes::hasMaxSpeed) {
+      scanner.Read(maxSpeed);
+    }
+
+    if (flags & WayAttributes::hasGrade) {
+      scanner.Read(grade);
+    }
+
+    tagCount=0;
+    tags=NULL;
+
+    if (flags & WayAttributes::hasTags) {
+      scanner.ReadNumber(tagCount);
+      tags=scanner.pos;
+      scanner.SkipTags(tagCount);
+    }
+
+    uint32_t minLat;
+    uint32_t minLon;
+
+    scanner.ReadNumber(nodeCount);
+
+    coords=scanner.pos;
+
+    scanner.Read(minLat);
+    scanner.Read(minLon);
+
+    return !scanner.error;
+  }
+
+  /**
+    Initializes the view for the way at the given offset of a file written
+    by Way::Write(). buffer is the memory mapped content of the file with the
+    given size.
+    */
+  bool WayView::Read(const char* buffer,
+                     FileOffset size,
+                     FileOffset offset)
+  {
+    return Read(buffer,
+                size,
+                offset,
+                false);
+  }
+
+  /**
+    Initializes the view for the way at the given offset of a file written
+    by Way::WriteOptimized().
+    */
+  bool WayView::ReadOptimized(const char* buffer,
+                              FileOffset size,
+                              FileOffset offset)
+  {
+    return Read(buffer,
+                size,
+                offset,
+                true);
+  }
+
+  AreaRingView::AreaRingView()
+  : end(NULL),
+    optimized(false),
+    type(typeIgnore),
+    flags(0),
+    name(emptyString),
+    nameAlt(emptyString),
+    location(emptyString),
+    address(emptyString),
+    tagCount(0),
+    tags(NULL),
+    ring(0),
+    nodeCount(0),
+    ids(NULL),
+    coords(NULL),
+    next(NULL)
+  {
+    // no code
+  }
+
+  /**
+    Reads the attributes following the given flags, returns the position
+    after the attributes or NULL on error.
+    */
+  const char* AreaRingView::ReadAttributes(const char* data,
+                                           uint8_t flags)
+  {
+    MemoryScanner scanner(data,end);
+
+    this->flags=flags;
+
+    if (flags & AreaAttributes::hasName) {
+      scanner.ReadString(name);
+    }
+
+    if (flags & AreaAttributes::hasNameAlt) {
+      scanner.ReadString(nameAlt);
+    }
+
+    if (flags & AreaAttributes::hasLocation) {
+      scanner.ReadString(location);
+    }
+
+    if (flags & AreaAttributes::hasAddress) {
+      scanner.ReadString(address);
+    }
+
+    if (flags & AreaAttributes::hasTags) {
+      scanner.ReadNumber(tagCount);
+      tags=scanner.pos;
+      scanner.SkipTags(tagCount);
+    }
+
+    if (scanner.error) {
+      return NULL;
+    }
+
+    return scanner.pos;
+  }
+
+  /**
+    Reads the node count and locates ids and coordinates. Returns the position
+    after the ring or NULL on error.
+    */
+  const char* AreaRingView::ReadNodes(const char* data,
+                                      bool hasIds)
+  {
+    MemoryScanner scanner(data,end);
+
+    scanner.ReadNumber(nodeCount);
+
+    if (nodeCount>0) {
+      if (hasIds) {
+        ids=scanner.pos;
+        scanner.SkipNumbers(1+(size_t)nodeCount);
+      }
+
+      coords=scanner.pos;
+      scanner.SkipCoords(nodeCount);
+    }
+
+    if (scanner.error) {
+      return NULL;
+    }
+
+    next=scanner.pos;
+
+    return next;
+  }
+
+  bool AreaRingView::GetTags(std::vector<Tag>& tags) const
+  {
+    if (tagCount==0) {
+      tags.clear();
+
+      return true;
+    }
+
+    MemoryScanner scanner(this->tags,end);
+
+    return scanner.ReadTags(tagCount,
+                            tags);
+  }
+
+  bool AreaRingView::GetNodes(std::vector<GeoCoord>& nodes) const
+  {
+    if (nodeCount==0) {
+      nodes.clear();
+
+      return true;
+    }
+
+    MemoryScanner scanner(coords,end);
+
+    return scanner.ReadCoords(nodeCount,
+                              nodes);
+  }
+
+  bool AreaRingView::GetIds(std::vector<Id>& ids) const
+  {
+    if (this->ids==NULL) {
+      ids.clear();
+
+      return true;
+    }
+
+    MemoryScanner scanner(this->ids,end);
+    Id            minId=0;
+
+    if (!scanner.ReadNumber(minId)) {
+      return false;
+    }
+
+    ids.resize(nodeCount);
+
+    for (size_t i=0; i<nodeCount; i++) {
+      Id id;
+
+      if (!scanner.ReadNumber(id)) {
+        return false;
+      }
+
+      ids[i]=minId+id;
+    }
+
+    return !scanner.error;
+  }
+
+  bool AreaRingView::GetBoundingBox(double& minLon,
+                                    double& maxLon,
+                                    double& minLat,
+                                    double& maxLat) const
+  {
+    MemoryScanner scanner(coords,end);
+
+    return scanner.GetBoundingBox(nodeCount,
+                                  minLon,
+                                  maxLon,
+                                  minLat,
+                                  maxLat);
+  }
+
+  AreaView::AreaView()
+  : fileOffset(0),
+    ringCount(0)
+  {
+    // no code
+  }
+
+  /**
+    Returns views for all rings of the area, the first one being the master ring.
+    */
+  bool AreaView::GetRings(std::vector<AreaRingView>& rings) const
+  {
+    const char* pos=master.next;
+
+    rings.clear();
+    rings.reserve(ringCount);
+    rings.push_back(master);
+
+    for (size_t i=1; i<ringCount; i++) {
+      AreaRingView  ring;
+      MemoryScanner scanner(pos,master.end);
+
+      ring.end=master.end;
+      ring.optimized=master.optimized;
+
+      if (!scanner.ReadNumber(ring.type)) {
+        return false;
+      }
+
+      pos=scanner.pos;
+
+      if (ring.type!=typeIgnore) {
+        uint8_t flags;
+
+        if (!scanner.Read(flags)) {
+          return false;
+        }
+
+        pos=ring.ReadAttributes(scanner.pos,
+                                flags);
+
+        if (pos==NULL) {
+          return false;
+        }
+      }
+
+      MemoryScanner ringScanner(pos,master.end);
+
+      if (!ringScanner.Read(ring.ring)) {
+        return false;
+      }
+
+      pos=ring.ReadNodes(ringScanner.pos,
+                         !ring.optimized && ring.type!=typeIgnore);
+
+      if (pos==NULL) {
+        return false;
+      }
+
+      rings.push_back(ring);
+    }
+
+    return true;
+  }
+
+  /**
+    Returns the bounding box of all outer rings of the area.
+    */
+  bool AreaView::GetBoundingBox(double& minLon,
+                                double& maxLon,
+                                double& minLat,
+                                double& maxLat) const
+  {
+    if (IsSimple()) {
+      return master.GetBoundingBox(minLon,
+                                   maxLon,
+                                   minLat,
+                                   maxLat);
+    }
+
+    std::vector<AreaRingView> rings;
+    bool                      found=false;
+
+    if (!GetRings(rings)) {
+      return false;
+    }
+
+    for (std::vector<AreaRingView>::const_iterator ring=rings.begin();
+         ring!=rings.end();
+         ++ring) {
+      double ringMinLon;
+      double ringMaxLon;
+      double ringMinLat;
+      double ringMaxLat;
+
+      if (ring->GetRing()!=Area::outerRingId ||
+          !ring->GetBoundingBox(ringMinLon,
+                                ringMaxLon,
+                                ringMinLat,
+                                ringMaxLat)) {
+        continue;
+      }
+
+      if (found) {
+        minLon=std::min(minLon,ringMinLon);
+        maxLon=std::max(maxLon,ringMaxLon);
+        minLat=std::min(minLat,ringMinLat);
+        maxLat=std::max(maxLat,ringMaxLat);
+      }
+      else {
+        minLon=ringMinLon;
+        maxLon=ringMaxLon;
+        minLat=ringMinLat;
+        maxLat=ringMaxLat;
+        found=true;
+      }
+    }
+
+    return found;
+  }
+
+  bool AreaView::Read(const char* buffer,
+                      FileOffset size,
+                      FileOffset offset,
+                      bool optimized)
+  {
+    if (buffer==NULL ||
+        offset>=size) {
+      return false;
+    }
+
+    MemoryScanner scanner(buffer+offset,buffer+size);
+    uint8_t       outerFlags;
+
+    fileOffset=offset;
+    ringCount=1;
+    master=AreaRingView();
+    master.end=buffer+size;
+    master.optimized=optimized;
+
+    if (!scanner.Read(outerFlags)) {
+      return false;
+    }
+
+    if (!(outerFlags & AreaAttributes::isSimple)) {
+      scanner.ReadNumber(ringCount);
+      ringCount++;
+    }
+
+    if (!scanner.ReadNumber(master.type)) {
+      return false;
+    }
+
+    const char* pos=master.ReadAttributes(scanner.pos,
+                                          outerFlags);
+
+    if (pos==NULL) {
+      return false;
+    }
+
+    if (ringCount>1) {
+      master.ring=Area::masterRingId;
+    }
+    else {
+      master.ring=Area::outerRingId;
+    }
+
+    return master.ReadNodes(pos,
+                            !optimized)!=NULL;
+  }
+
+  /**
+    Initializes the view for the area at the given offset of a file written
+    by Area::Write(). buffer is the memory mapped content of the file with the
+    given size.
+    */
+  bool AreaView::Read(const char* buffer,
+                      FileOffset size,
+                      FileOffset offset)
+  {
+    return Read(buffer,
+                size,
+                offset,
+                false);
+  }
+
+  /**
+    Initializes the view for the area at the given offset of a file written
+    by Area::WriteOptimized().
+    */
+  bool AreaView::ReadOptimized(const char* buffer,
+                               FileOffset size,
+                               FileOffset offset)
+  {
+    return Read(buffer,
+                size,
+                offset,
+                true);
+  }
+}
@@ -43,7 +43,7 @@ namespace osmscout
 
   OptimizeWaysLowZoom::~OptimizeWaysLowZoom()
   {
-    if (scanner.IsOpen()) {
+    if (scannerPool.IsOpen()) {
       Close();
     }
   }
@@ -79,19 +79,35 @@ namespace osmscout
   {
     datafilename=AppendFileToDir(path,datafile);
 
-    if (!scanner.Open(datafilename,FileScanner::LowMemRandom,true)) {
-      std::cout << "Cannot open file '" << scanner.GetFilename() << "'!" << std::endl;
+    if (!scannerPool.Open(datafilename,FileScanner::LowMemRandom,true)) {
+      std::cout << "Cannot open file '" << datafilename << "'!" << std::endl;
+      return false;
+    }
+
+    // Object views are optional, without a memory mapping the ways are
+    // still read using the scanner pool
+    if (!viewScanner.Open(datafilename,FileScanner::LowMemRandom,true)) {
+      std::cerr << "Cannot open file '" << datafilename << "' for object views, reading ways only!" << std::endl;
+    }
+    else if (viewScanner.GetMappedBuffer()==NULL) {
+      std::cerr << "File '" << datafilename << "' is not memory mapped, reading ways only!" << std::endl;
+      viewScanner.Close();
+    }
+
+    PooledFileScanner scanner(scannerPool);
+
+    if (!scanner.IsValid()) {
       return false;
     }
 
     FileOffset indexOffset;
 
-    if (!scanner.ReadFileOffset(indexOffset)) {
+    if (!scanner->ReadFileOffset(indexOffset)) {
       std::cout << "Cannot read index offset!" << std::endl;
       return false;
     }
 
-    if (!scanner.SetPos(indexOffset)) {
+    if (!scanner->SetPos(indexOffset)) {
       std::cout << "Cannot goto to start of index at position " << indexOffset << "!" << std::endl;
       return false;
     }
@@ -99,10 +115,10 @@ namespace osmscout
     uint32_t optimizationMaxMag;
     uint32_t wayTypeCount;
 
-    scanner.Read(optimizationMaxMag);
-    scanner.Read(wayTypeCount);
+    scanner->Read(optimizationMaxMag);
+    scanner->Read(wayTypeCount);
 
-    if (scanner.HasError()) {
+    if (scanner->HasError()) {
       return false;
     }
 
@@ -111,11 +127,11 @@ namespace osmscout
     for (size_t i=1; i<=wayTypeCount; i++) {
       TypeId typeId;
 
-      scanner.Read(typeId);
+      scanner->Read(typeId);
 
       TypeData typeData;
 
-      if (!ReadTypeData(scanner,
+      if (!ReadTypeData(*scanner,
                         typeData)) {
         return false;
       }
@@ -123,15 +139,21 @@ namespace osmscout
       wayTypesData[typeId].push_back(typeData);
     }
 
-    return !scanner.HasError();
+    return !scanner->HasError();
   }
 
   bool OptimizeWaysLowZoom::Close()
   {
     bool success=true;
 
-    if (scanner.IsOpen()) {
-      if (!scanner.Close()) {
+    if (scannerPool.IsOpen()) {
+      if (!scannerPool.Close()) {
+        success=false;
+      }
+    }
+
+    if (viewScanner.IsOpen()) {
+      if (!viewScanner.Close()) {
         success=false;
       }
     }
@@ -144,7 +166,8 @@ namespace osmscout
     return magnification<=this->magnification;
   }
 
-  bool OptimizeWaysLowZoom::GetOffsets(const TypeData& typeData,
+  bool OptimizeWaysLowZoom::GetOffsets(FileScanner& scanner,
+                                       const TypeData& typeData,
                                        double minlon,
                                        double minlat,
                                        double maxlon,
@@ -260,24 +283,19 @@ namespace osmscout
     return true;
   }
 
-  bool OptimizeWaysLowZoom::GetWays(double lonMin, double latMin,
-                                    double lonMax, double latMax,
-                                    const Magnification& magnification,
-                                    size_t /*maxWayCount*/,
-                                    std::vector<TypeSet>& wayTypes,
-                                    std::vector<WayRef>& ways) const
+  /**
+    Collects the offsets of all objects of the given types within the given
+    bounding box, that have optimized data for the given magnification or
+    the next optimized magnification level above it. Types handled are
+    removed from wayTypes.
+    */
+  bool OptimizeWaysLowZoom::GetOffsets(FileScanner& scanner,
+                                       double lonMin, double latMin,
+                                       double lonMax, double latMax,
+                                       const Magnification& magnification,
+                                       std::vector<TypeSet>& wayTypes,
+                                       std::vector<FileOffset>& offsets) const
   {
-    std::vector<FileOffset> offsets;
-
-    if (!scanner.IsOpen()) {
-      if (!scanner.Open(datafilename,FileScanner::LowMemRandom,true)) {
-        std::cerr << "Error while opening " << datafilename << " for reading!" << std::endl;
-        return false;
-      }
-    }
-
-    offsets.reserve(20000);
-
     for (size_t i=0; i<wayTypes.size(); i++) {
       for (std::map<TypeId,std::list<TypeData> >::const_iterator type=wayTypesData.begin();
           type!=wayTypesData.end();
@@ -288,14 +306,19 @@ namespace osmscout
           for (std::list<TypeData>::const_iterator typeData=type->second.begin();
               typeData!=type->second.end();
               ++typeData) {
-            if (typeData->optLevel==magnification.GetLevel()) {
+            // The data of the next level not below the requested level, types
+            // may not have data for every level
+            if (typeData->optLevel>=magnification.GetLevel() &&
+                (match==type->second.end() ||
+                 typeData->optLevel<match->optLevel)) {
               match=typeData;
             }
           }
 
           if (match!=type->second.end()) {
             if (match->bitmapOffset!=0) {
-              if (!GetOffsets(*match,
+              if (!GetOffsets(scanner,
+                              *match,
                               lonMin,
                               latMin,
                               lonMax,
@@ -303,35 +326,123 @@ namespace osmscout
                               offsets)) {
                 return false;
               }
+            }
 
-              for (std::vector<FileOffset>::const_iterator offset=offsets.begin();
-                  offset!=offsets.end();
-                  ++offset) {
-                if (!scanner.SetPos(*offset)) {
-                  std::cerr << "Error while positioning in file " << datafilename  << std::endl;
-                  type++;
-                  continue;
-                }
+            wayTypes[i].UnsetType(type->first);
+          }
+        }
+      }
+    }
 
-                WayRef way=new Way();
+    return true;
+  }
 
-                if (!way->ReadOptimized(scanner)) {
-                  std::cerr << "Error while reading data entry of type " << type->first << " from file " << datafilename  << std::endl;
-                  continue;
-                }
+  bool OptimizeWaysLowZoom::GetWays(double lonMin, double latMin,
+                                    double lonMax, double latMax,
+                                    const Magnification& magnification,
+                                    size_t /*maxWayCount*/,
+                                    std::vector<TypeSet>& wayTypes,
+                                    std::vector<WayRef>& ways) const
+  {
+    std::vector<FileOffset> offsets;
 
-                ways.push_back(way);
-              }
+    PooledFileScanner scanner(scannerPool);
 
-              offsets.clear();
-            }
-          }
+    if (!scanner.IsValid()) {
+      return false;
+    }
 
-          if (match!=type->second.end()) {
-            wayTypes[i].UnsetType(type->first);
-          }
-        }
+    offsets.reserve(20000);
+
+    if (!GetOffsets(*scanner,
+                    lonMin,
+                    latMin,
+                    lonMax,
+                    latMax,
+                    magnification,
+                    wayTypes,
+                    offsets)) {
+      return false;
+    }
+
+    ways.reserve(ways.size()+offsets.size());
+
+    for (std::vector<FileOffset>::const_iterator offset=offsets.begin();
+        offset!=offsets.end();
+        ++offset) {
+      if (!scanner->SetPos(*offset)) {
+        std::cerr << "Error while positioning in file " << datafilename  << std::endl;
+        continue;
+      }
+
+      WayRef way=new Way();
+
+      if (!way->ReadOptimized(*scanner)) {
+        std::cerr << "Error while reading data entry at offset " << *offset << " from file " << datafilename  << std::endl;
+        continue;
+      }
+
+      ways.push_back(way);
+    }
+
+    return true;
+  }
+
+  /**
+    Like GetWays() above, but returns views into the memory mapped data file
+    instead of copies. The views are valid until Close() is called.
+
+    If the data file is not memory mapped, false is returned and wayTypes is
+    left unchanged, so the caller reads all requested ways from the
+    regular data file instead.
+    */
+  bool OptimizeWaysLowZoom::GetWays(double lonMin, double latMin,
+                                    double lonMax, double latMax,
+                                    const Magnification& magnification,
+                                    size_t /*maxWayCount*/,
+                                    std::vector<TypeSet>& wayTypes,
+                                    std::vector<WayView>& ways) const
+  {
+    const char* buffer=viewScanner.GetMappedBuffer();
+
+    if (buffer==NULL) {
+      return false;
+    }
+
+    std::vector<FileOffset> offsets;
+
+    PooledFileScanner scanner(scannerPool);
+
+    if (!scanner.IsValid()) {
+      return false;
+    }
+
+    offsets.reserve(20000);
+
+    if (!GetOffsets(*scanner,
+                    lonMin,
+                    latMin,
+                    lonMax,
+                    latMax,
+                    magnification,
+                    wayTypes,
+                    offsets)) {
+      return false;
+    }
+
+    ways.reserve(ways.size()+offsets.size());
+
+    for (std::vector<FileOffset>::const_iterator offset=offsets.begin();
+        offset!=offsets.end();
+        ++offset) {
+      WayView way;
+
+      if (!way.ReadOptimized(buffer,viewScanner.GetSize(),*offset)) {
+        std::cerr << "Error while reading data entry at offset " << *offset << " from file " << datafilename  << std::endl;
+        continue;
       }
+
+      ways.push_back(way);
     }
 
     return true;
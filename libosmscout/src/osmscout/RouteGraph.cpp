@@ -0,0 +1,247 @@
+/*
+  This source is part of the libosmscout library
+  Copyright (C) 2013  Tim Teulings
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+#include <osmscout/RouteGraph.h>
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+#include <osmscout/system/Assert.h>
+
+#include <osmscout/util/File.h>
+#include <osmscout/util/FileWriter.h>
+
+namespace osmscout {
+
+  const uint32_t RouteGraph::noNode=(uint32_t)-1;
+  const uint32_t RouteGraph::noObject=(uint32_t)-1;
+
+  static inline bool IsNodeOffsetLess(const RouteGraph::Node& node,
+                                      FileOffset offset)
+  {
+    return node.offset<offset;
+  }
+
+  static inline bool IsObjectLess(const RouteGraph::Object& object,
+                                  const ObjectFileRef& ref)
+  {
+    return ObjectFileRef(object.offset,(RefType)object.type)<ref;
+  }
+
+  RouteGraph::RouteGraph()
+  : nodeCount(0),
+    edgeCount(0),
+    excludeCount(0),
+    objectCount(0),
+    nodes(NULL),
+    edges(NULL),
+    excludes(NULL),
+    objects(NULL)
+  {
+    // no code
+  }
+
+  RouteGraph::~RouteGraph()
+  {
+    Close();
+  }
+
+  bool RouteGraph::Open(const std::string& filename)
+  {
+    FileOffset  fileSize;
+    const char* data;
+    uint32_t    header[4];
+
+    Close();
+
+    if (!GetFileSize(filename,fileSize)) {
+      std::cerr << "Cannot get size of file '" << filename << "'!" << std::endl;
+      return false;
+    }
+
+    if (fileSize<sizeof(header)) {
+      std::cerr << "File '" << filename << "' is too small!" << std::endl;
+      return false;
+    }
+
+    if (!scanner.Open(filename,FileScanner::FastRandom,true)) {
+      std::cerr << "Cannot open file '" << filename << "'!" << std::endl;
+      return false;
+    }
+
+    data=scanner.GetMappedBuffer();
+
+    // If the file cannot be mapped, we load it completely
+    if (data==NULL) {
+      buffer.resize(fileSize);
+
+      if (!scanner.Read(&buffer[0],fileSize)) {
+        std::cerr << "Cannot read file '" << filename << "'!" << std::endl;
+        scanner.Close();
+        buffer.clear();
+        return false;
+      }
+
+      scanner.Close();
+      data=&buffer[0];
+    }
+
+    memcpy(header,data,sizeof(header));
+
+    nodeCount=header[0];
+    edgeCount=header[1];
+    excludeCount=header[2];
+    objectCount=header[3];
+
+    FileOffset expectedSize=sizeof(header)+
+                            (FileOffset)(nodeCount+1)*sizeof(Node)+
+                            (FileOffset)edgeCount*sizeof(Edge)+
+                            (FileOffset)excludeCount*sizeof(Exclude)+
+                            (FileOffset)objectCount*sizeof(Object);
+
+    if (fileSize!=expectedSize) {
+      std::cerr << "File '" << filename << "' has an unexpected size!" << std::endl;
+      Close();
+      return false;
+    }
+
+    data+=sizeof(header);
+    nodes=reinterpret_cast<const Node*>(data);
+    data+=(nodeCount+1)*sizeof(Node);
+    edges=reinterpret_cast<const Edge*>(data);
+    data+=edgeCount*sizeof(Edge);
+    excludes=reinterpret_cast<const Exclude*>(data);
+    data+=excludeCount*sizeof(Exclude);
+    objects=reinterpret_cast<const Object*>(data);
+
+    return true;
+  }
+
+  bool RouteGraph::Close()
+  {
+    bool result=true;
+
+    if (scanner.IsOpen()) {
+      result=scanner.Close();
+    }
+
+    std::vector<char>().swap(buffer);
+
+    nodeCount=0;
+    edgeCount=0;
+    excludeCount=0;
+    objectCount=0;
+    nodes=NULL;
+    edges=NULL;
+    excludes=NULL;
+    objects=NULL;
+
+    return result;
+  }
+
+  /**
+    Return the index of the node for the route node with the given file offset.
+    Nodes are sorted by file offset, so this is a binary search.
+    */
+  bool RouteGraph::GetNodeIndex(FileOffset offset,
+                                uint32_t& node) const
+  {
+    const Node* entry=std::lower_bound(nodes,
+                                       nodes+nodeCount,
+                                       offset,
+                                       IsNodeOffsetLess);
+
+    if (entry==nodes+nodeCount ||
+        entry->offset!=offset) {
+      return false;
+    }
+
+    node=(uint32_t)(entry-nodes);
+
+    return true;
+  }
+
+  /**
+    Return the index of the given object, or noObject, if the object is not
+    referenced by the graph.
+    */
+  uint32_t RouteGraph::GetObjectIndex(const ObjectFileRef& object) const
+  {
+    const Object* entry=std::lower_bound(objects,
+                                         objects+objectCount,
+                                         object,
+                                         IsObjectLess);
+
+    if (entry==objects+objectCount ||
+        GetObject((uint32_t)(entry-objects))!=object) {
+      return noObject;
+    }
+
+    return (uint32_t)(entry-objects);
+  }
+
+  /**
+    Write a graph file. Nodes must already contain the sentinel node.
+    */
+  bool RouteGraph::Write(const std::string& filename,
+                         const std::vector<Node>& nodes,
+                         const std::vector<Edge>& edges,
+                         const std::vector<Exclude>& excludes,
+                         const std::vector<Object>& objects)
+  {
+    FileWriter writer;
+    uint32_t   header[4];
+
+    assert(!nodes.empty());
+
+    header[0]=(uint32_t)nodes.size()-1;
+    header[1]=(uint32_t)edges.size();
+    header[2]=(uint32_t)excludes.size();
+    header[3]=(uint32_t)objects.size();
+
+    if (!writer.Open(filename)) {
+      std::cerr << "Cannot create file '" << filename << "'!" << std::endl;
+      return false;
+    }
+
+    writer.Write((const char*)header,sizeof(header));
+    writer.Write((const char*)&nodes[0],nodes.size()*sizeof(Node));
+
+    if (!edges.empty()) {
+      writer.Write((const char*)&edges[0],edges.size()*sizeof(Edge));
+    }
+
+    if (!excludes.empty()) {
+      writer.Write((const char*)&excludes[0],excludes.size()*sizeof(Exclude));
+    }
+
+    if (!objects.empty()) {
+      writer.Write((const char*)&objects[0],objects.size()*sizeof(Object));
+    }
+
+    if (writer.HasError()) {
+      std::cerr << "Error while writing file '" << filename << "'!" << std::endl;
+      writer.Close();
+      return false;
+    }
+
+    return writer.Close();
+  }
+}
@@ -0,0 +1,65 @@
+/*
+  This source is part of the libosmscout library
+  Copyright (C) 2013  Tim Teulings
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+#include <osmscout/RouteMatrix.h>
+
+namespace osmscout {
+
+  RoutePosition::RoutePosition()
+  : nodeIndex(0)
+  {
+    // no code
+  }
+
+  RoutePosition::RoutePosition(const ObjectFileRef& object,
+                               size_t nodeIndex)
+  : object(object),
+    nodeIndex(nodeIndex)
+  {
+    // no code
+  }
+
+  RouteMatrix::RouteMatrix()
+  : sourceCount(0),
+    targetCount(0)
+  {
+    // no code
+  }
+
+  void RouteMatrix::Clear()
+  {
+    sourceCount=0;
+    targetCount=0;
+    costs.clear();
+    times.clear();
+  }
+
+  /**
+    Resize the matrix, all entries are marked as not reachable.
+    */
+  void RouteMatrix::Initialize(size_t sourceCount,
+                               size_t targetCount)
+  {
+    this->sourceCount=sourceCount;
+    this->targetCount=targetCount;
+
+    costs.assign(sourceCount*targetCount,-1.0);
+    times.assign(sourceCount*targetCount,-1.0);
+  }
+}
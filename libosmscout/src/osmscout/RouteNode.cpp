@@ -43,6 +43,18 @@ namespace osmscout {
   }
 
 
+  /**
+    Returns the estimated memory used by the route node, including all
+    dynamically allocated data.
+    */
+  unsigned long RouteNode::GetMemorySize() const
+  {
+    return sizeof(RouteNode)+
+           objects.capacity()*sizeof(ObjectFileRef)+
+           paths.capacity()*sizeof(Path)+
+           excludes.capacity()*sizeof(Exclude);
+  }
+
   bool RouteNode::Read(FileScanner& scanner)
   {
     uint32_t objectCount;
@@ -109,8 +121,8 @@ namespace osmscout {
       scanner.ReadNumber(lonValue);
 
       paths[i].distance=distanceValue/(1000.0*100.0);
-      paths[i].lat=(latValue+minLat)/conversionFactor-90.0;
-      paths[i].lon=(lonValue+minLon)/conversionFactor-180.0;
+      paths[i].coord.SetValues(latValue+minLat,
+                               lonValue+minLon);
     }
 
     excludes.resize(excludesCount);
@@ -140,8 +152,8 @@ namespace osmscout {
     uint32_t minLon=std::numeric_limits<uint32_t>::max();
 
     for (size_t i=0; i<paths.size(); i++) {
-      minLat=std::min(minLat,(uint32_t)floor((paths[i].lat+90.0)*conversionFactor+0.5));
-      minLon=std::min(minLon,(uint32_t)floor((paths[i].lon+180.0)*conversionFactor+0.5));
+      minLat=std::min(minLat,(uint32_t)floor((paths[i].coord.GetLat()+90.0)*conversionFactor+0.5));
+      minLon=std::min(minLon,(uint32_t)floor((paths[i].coord.GetLon()+180.0)*conversionFactor+0.5));
     }
 
     writer.Write(minLat);
@@ -159,8 +171,8 @@ namespace osmscout {
     }
 
     for (size_t i=0; i<paths.size(); i++) {
-      uint32_t latValue=(uint32_t)floor((paths[i].lat+90.0)*conversionFactor+0.5);
-      uint32_t lonValue=(uint32_t)floor((paths[i].lon+180.0)*conversionFactor+0.5);
+      uint32_t latValue=(uint32_t)floor((paths[i].coord.GetLat()+90.0)*conversionFactor+0.5);
+      uint32_t lonValue=(uint32_t)floor((paths[i].coord.GetLon()+180.0)*conversionFactor+0.5);
       uint32_t distanceValue=(uint32_t)floor(paths[i].distance*(1000.0*100.0)+0.5);
 
       writer.WriteFileOffset(paths[i].offset);
@@ -418,8 +418,8 @@ namespace osmscout {
 
       assert(entry!=areaMap.end());
 
-      lat=entry->second->rings.front().nodes[nodeIndex].lat;
-      lon=entry->second->rings.front().nodes[nodeIndex].lon;
+      lat=entry->second->rings.front().nodes[nodeIndex].GetLat();
+      lon=entry->second->rings.front().nodes[nodeIndex].GetLon();
     }
     else if (object.GetType()==refWay) {
       OSMSCOUT_HASHMAP<FileOffset,WayRef>::const_iterator entry=wayMap.find(object.GetFileOffset());
@@ -20,13 +20,21 @@
 #include <osmscout/Router.h>
 
 #include <algorithm>
+#include <functional>
 #include <iostream>
+#include <limits>
+
+#if defined(OSMSCOUT_HAVE_THREAD)
+#include <thread>
+#endif
 
 #include <osmscout/RoutingProfile.h>
 #include <osmscout/TypeConfigLoader.h>
 
 #include <osmscout/system/Assert.h>
 
+#include <osmscout/util/File.h>
+#include <osmscout/util/FileScanner.h>
 #include <osmscout/util/Geometry.h>
 #include <osmscout/util/StopClock.h>
 
@@ -36,7 +44,10 @@ namespace osmscout {
 
   RouterParameter::RouterParameter()
   : wayIndexCacheSize(10000),
-    wayCacheSize(0),
+    wayCacheSizeBytes(0),
+    matrixCacheSize(64*1024*1024),
+    openListType(openListHeap),
+    useRouteGraph(false),
     debugPerformance(false)
   {
     // no code
@@ -47,9 +58,24 @@ namespace osmscout {
     this->wayIndexCacheSize=wayIndexCacheSize;
   }
 
-  void RouterParameter::SetWayCacheSize(unsigned long wayCacheSize)
+  void RouterParameter::SetWayCacheSizeBytes(unsigned long wayCacheSizeBytes)
+  {
+    this->wayCacheSizeBytes=wayCacheSizeBytes;
+  }
+
+  void RouterParameter::SetMatrixCacheSize(unsigned long matrixCacheSize)
+  {
+    this->matrixCacheSize=matrixCacheSize;
+  }
+
+  void RouterParameter::SetOpenListType(OpenListType openListType)
   {
-    this->wayCacheSize=wayCacheSize;
+    this->openListType=openListType;
+  }
+
+  void RouterParameter::SetUseRouteGraph(bool useRouteGraph)
+  {
+    this->useRouteGraph=useRouteGraph;
   }
 
   void RouterParameter::SetDebugPerformance(bool debug)
@@ -62,9 +88,24 @@ namespace osmscout {
     return wayIndexCacheSize;
   }
 
-  unsigned long RouterParameter::GetWayCacheSize() const
+  unsigned long RouterParameter::GetWayCacheSizeBytes() const
+  {
+    return wayCacheSizeBytes;
+  }
+
+  unsigned long RouterParameter::GetMatrixCacheSize() const
+  {
+    return matrixCacheSize;
+  }
+
+  OpenListType RouterParameter::GetOpenListType() const
+  {
+    return openListType;
+  }
+
+  bool RouterParameter::GetUseRouteGraph() const
   {
-    return wayCacheSize;
+    return useRouteGraph;
   }
 
   bool RouterParameter::IsDebugPerformance() const
@@ -84,15 +125,25 @@ namespace osmscout {
   const char* const Router::FILENAME_CAR_DAT           = "routecar.dat";
   const char* const Router::FILENAME_CAR_IDX           = "routecar.idx";
 
+  const char* const Router::FILENAME_FOOT_CH_DAT       = "routefootch.dat";
+  const char* const Router::FILENAME_BICYCLE_CH_DAT    = "routebicyclech.dat";
+  const char* const Router::FILENAME_CAR_CH_DAT        = "routecarch.dat";
+
+  const char* const Router::FILENAME_FOOT_GRAPH_DAT    = "routefootgraph.dat";
+  const char* const Router::FILENAME_BICYCLE_GRAPH_DAT = "routebicyclegraph.dat";
+  const char* const Router::FILENAME_CAR_GRAPH_DAT     = "routecargraph.dat";
+
+  const uint64_t Router::noCosts=(uint64_t)-1;
+
   Router::Router(const RouterParameter& parameter,
                  Vehicle vehicle)
    : vehicle(vehicle),
      isOpen(false),
      debugPerformance(parameter.IsDebugPerformance()),
      areaDataFile("areas.dat",
-                  parameter.GetWayCacheSize()),
+                  parameter.GetWayCacheSizeBytes()),
      wayDataFile("ways.dat",
-                  parameter.GetWayCacheSize()),
+                  parameter.GetWayCacheSizeBytes()),
      routeNodeDataFile(GetDataFilename(vehicle),
                        GetIndexFilename(vehicle),
                        0,
@@ -101,7 +152,10 @@ namespace osmscout {
                       Router::FILENAME_INTERSECTIONS_IDX,
                       0,
                       6000),
-     typeConfig(NULL)
+     typeConfig(NULL),
+     openListType(parameter.GetOpenListType()),
+     useRouteGraph(parameter.GetUseRouteGraph()),
+     matrixCacheSize(parameter.GetMatrixCacheSize())
   {
     // no code
   }
@@ -147,6 +201,38 @@ namespace osmscout {
     return ""; // make the compiler happy
   }
 
+  std::string Router::GetCHFilename(Vehicle vehicle) const
+  {
+    switch (vehicle) {
+    case vehicleFoot:
+      return FILENAME_FOOT_CH_DAT;
+    case vehicleBicycle:
+      return FILENAME_BICYCLE_CH_DAT;
+    case vehicleCar:
+      return FILENAME_CAR_CH_DAT;
+    default:
+      assert(false);
+    }
+
+    return ""; // make the compiler happy
+  }
+
+  std::string Router::GetGraphFilename(Vehicle vehicle) const
+  {
+    switch (vehicle) {
+    case vehicleFoot:
+      return FILENAME_FOOT_GRAPH_DAT;
+    case vehicleBicycle:
+      return FILENAME_BICYCLE_GRAPH_DAT;
+    case vehicleCar:
+      return FILENAME_CAR_GRAPH_DAT;
+    default:
+      assert(false);
+    }
+
+    return ""; // make the compiler happy
+  }
+
   Vehicle Router::GetVehicle() const
   {
     return vehicle;
@@ -192,6 +278,48 @@ namespace osmscout {
       return false;
     }
 
+    // The contraction hierarchy is optional
+    std::string chFilename=AppendFileToDir(path,
+                                           GetCHFilename(vehicle));
+    FileOffset  chFileSize;
+
+    if (GetFileSize(chFilename,chFileSize)) {
+      if (!ch.Read(chFilename)) {
+        std::cerr << "Cannot load '" << GetCHFilename(vehicle) << "'!" << std::endl;
+        routeNodeDataFile.Close();
+        delete typeConfig;
+        typeConfig=NULL;
+        return false;
+      }
+
+      chForward.costs.assign(ch.GetNodeCount(),noCosts);
+      chForward.prev.assign(ch.GetNodeCount(),ContractionHierarchy::noNode);
+      chBackward.costs.assign(ch.GetNodeCount(),noCosts);
+      chBackward.prev.assign(ch.GetNodeCount(),ContractionHierarchy::noNode);
+    }
+
+    // The compact routing graph is optional, too
+    std::string graphFilename=AppendFileToDir(path,
+                                              GetGraphFilename(vehicle));
+    FileOffset  graphFileSize;
+
+    if (useRouteGraph &&
+        GetFileSize(graphFilename,graphFileSize)) {
+      if (!graph.Open(graphFilename)) {
+        std::cerr << "Cannot load '" << GetGraphFilename(vehicle) << "'!" << std::endl;
+        ch.Clear();
+        routeNodeDataFile.Close();
+        delete typeConfig;
+        typeConfig=NULL;
+        return false;
+      }
+
+      graphSearch.costs.assign(graph.GetNodeCount(),0.0);
+      graphSearch.prev.assign(graph.GetNodeCount(),RouteGraph::noNode);
+      graphSearch.object.assign(graph.GetNodeCount(),RouteGraph::noObject);
+      graphSearch.state.assign(graph.GetNodeCount(),0);
+    }
+
     isOpen=true;
 
     return true;
@@ -209,6 +337,16 @@ namespace osmscout {
     wayDataFile.Close();
     areaDataFile.Close();
 
+    ch.Clear();
+    chForward=CHSearch();
+    chBackward=CHSearch();
+
+    graph.Close();
+    graphSearch=GraphSearch();
+
+    std::vector<IncomingNode>().swap(incomingNodes);
+    std::vector<IncomingPath>().swap(incomingPaths);
+
     isOpen=false;
   }
 
@@ -216,6 +354,16 @@ namespace osmscout {
   {
     areaDataFile.FlushCache();
     wayDataFile.FlushCache();
+
+    // Also release the memory kept for the next route calculation
+    std::vector<RNode>().swap(rnodes);
+    RNodeMap().swap(rnodeMap);
+    heap=DAryHeap<4>();
+    radixHeap=RadixHeap();
+    std::vector<RNode>().swap(backwardRNodes);
+    RNodeMap().swap(backwardRNodeMap);
+    backwardHeap=DAryHeap<4>();
+    backwardRadixHeap=RadixHeap();
   }
 
   TypeConfig* Router::GetTypeConfig() const
@@ -266,21 +414,22 @@ namespace osmscout {
     }
   }
 
-  void Router::ResolveRNodeChainToList(const RNodeRef& end,
-                                       const CloseMap& closeMap,
-                                       std::list<RNodeRef>& nodes)
+  void Router::ResolveRNodeChainToList(size_t end,
+                                       std::list<RNode>& nodes)
   {
-    CloseMap::const_iterator current=closeMap.find(end->nodeOffset);
+    size_t current=end;
 
-    while (current->second->prev!=0) {
-      CloseMap::const_iterator prev=closeMap.find(current->second->prev);
+    while (rnodes[current].prev!=0) {
+      RNodeMap::const_iterator prev=rnodeMap.find(rnodes[current].prev);
 
-      nodes.push_back(current->second);
+      assert(prev!=rnodeMap.end());
 
-      current=prev;
+      nodes.push_back(rnodes[current]);
+
+      current=prev->second;
     }
 
-    nodes.push_back(current->second);
+    nodes.push_back(rnodes[current]);
 
     std::reverse(nodes.begin(),nodes.end());
   }
@@ -387,7 +536,7 @@ namespace osmscout {
   }
 
   bool Router::ResolveRNodesToRouteData(const RoutingProfile& profile,
-                                        const std::list<RNodeRef>& nodes,
+                                        const std::list<RNode>& nodes,
                                         const ObjectFileRef& startObject,
                                         size_t startNodeIndex,
                                         const ObjectFileRef& targetObject,
@@ -408,11 +557,9 @@ namespace osmscout {
 
     // Collect all route node file offsets on the path and also
     // all area/way file offsets on the path
-    for (std::list<RNodeRef>::const_iterator n=nodes.begin();
-        n!=nodes.end();
-        n++) {
-      RNodeRef node(*n);
-
+    for (std::list<RNode>::const_iterator node=nodes.begin();
+        node!=nodes.end();
+        node++) {
       routeNodeOffsets.insert(node->nodeOffset);
 
       if (node->object.Valid()) {
@@ -505,7 +652,7 @@ namespace osmscout {
       return true;
     }
 
-    RouteNodeRef initialNode=routeNodeMap.find(nodes.front()->nodeOffset)->second;
+    RouteNodeRef initialNode=routeNodeMap.find(nodes.front().nodeOffset)->second;
 
     //
     // Add The path from the start node to the first routing node
@@ -533,14 +680,14 @@ namespace osmscout {
     // Walk the routing path from route node to the next route node
     // and build entries.
     //
-    for (std::list<RNodeRef>::const_iterator n=nodes.begin();
+    for (std::list<RNode>::const_iterator n=nodes.begin();
         n!=nodes.end();
         n++) {
-      std::list<RNodeRef>::const_iterator nn=n;
+      std::list<RNode>::const_iterator nn=n;
 
       nn++;
 
-      RouteNodeRef node=routeNodeMap.find((*n)->nodeOffset)->second;
+      RouteNodeRef node=routeNodeMap.find(n->nodeOffset)->second;
 
       //
       // The path from the last routing node to the target node and the
@@ -593,18 +740,18 @@ namespace osmscout {
         break;
       }
 
-      RouteNodeRef nextNode=routeNodeMap.find((*nn)->nodeOffset)->second;
+      RouteNodeRef nextNode=routeNodeMap.find(nn->nodeOffset)->second;
 
-      if ((*nn)->object.GetType()==refArea) {
-        OSMSCOUT_HASHMAP<FileOffset,AreaRef>::const_iterator entry=areaMap.find((*nn)->object.GetFileOffset());
+      if (nn->object.GetType()==refArea) {
+        OSMSCOUT_HASHMAP<FileOffset,AreaRef>::const_iterator entry=areaMap.find(nn->object.GetFileOffset());
 
         assert(entry!=areaMap.end());
 
         ids=&entry->second->rings.front().ids;
         oneway=false;
       }
-      else if ((*nn)->object.GetType()==refWay) {
-        OSMSCOUT_HASHMAP<FileOffset,WayRef>::const_iterator entry=wayMap.find((*nn)->object.GetFileOffset());
+      else if (nn->object.GetType()==refWay) {
+        OSMSCOUT_HASHMAP<FileOffset,WayRef>::const_iterator entry=wayMap.find(nn->object.GetFileOffset());
 
         assert(entry!=wayMap.end());
 
@@ -634,7 +781,7 @@ namespace osmscout {
       AddNodes(route,
                (*ids)[currentNodeIndex],
                currentNodeIndex,
-               (*nn)->object,
+               nn->object,
                ids->size(),
                oneway,
                nextNodeIndex);
@@ -701,12 +848,14 @@ namespace osmscout {
   bool Router::GetStartNodes(const RoutingProfile& profile,
                              const ObjectFileRef& object,
                              size_t nodeIndex,
+                             double& startLon,
+                             double& startLat,
                              double& targetLon,
                              double& targetLat,
                              RouteNodeRef& forwardRouteNode,
                              RouteNodeRef& backwardRouteNode,
-                             RNodeRef& forwardRNode,
-                             RNodeRef& backwardRNode)
+                             RNode& forwardRNode,
+                             RNode& backwardRNode)
   {
     if (object.GetType()==refArea) {
       // TODO:
@@ -714,8 +863,6 @@ namespace osmscout {
     }
     else if (object.GetType()==refWay) {
       WayRef        way;
-      double        startLon=0.0L;
-      double        startLat=0.0L;
       size_t        forwardNodePos;
       FileOffset    forwardOffset;
       size_t        backwardNodePos;
@@ -757,20 +904,20 @@ namespace osmscout {
           std::cerr << "Cannot get offset of startForwardRouteNode" << std::endl;
         }
 
-        RNodeRef node=new RNode(forwardOffset,
-                                object);
+        RNode node(forwardOffset,
+                   object);
 
-        node->currentCost=profile.GetCosts(way,
-                                           GetSphericalDistance(startLon,
+        node.currentCost=profile.GetCosts(way,
+                                          GetSphericalDistance(startLon,
+                                                               startLat,
+                                                               way->nodes[forwardNodePos].GetLon(),
+                                                               way->nodes[forwardNodePos].GetLat()));
+        node.estimateCost=profile.GetCosts(GetSphericalDistance(startLon,
                                                                 startLat,
-                                                                way->nodes[forwardNodePos].GetLon(),
-                                                                way->nodes[forwardNodePos].GetLat()));
-        node->estimateCost=profile.GetCosts(GetSphericalDistance(startLon,
-                                                                 startLat,
-                                                                 targetLon,
-                                                                 targetLat));
+                                                                targetLon,
+                                                                targetLat));
 
-        node->overallCost=node->currentCost+node->estimateCost;
+        node.overallCost=node.currentCost+node.estimateCost;
 
         forwardRNode=node;
       }
@@ -781,20 +928,20 @@ namespace osmscout {
           std::cerr << "Cannot get offset of startBackwardRouteNode" << std::endl;
         }
 
-        RNodeRef node=new RNode(backwardOffset,
-                                object);
+        RNode node(backwardOffset,
+                   object);
 
-        node->currentCost=profile.GetCosts(way,
-                                           GetSphericalDistance(startLon,
+        node.currentCost=profile.GetCosts(way,
+                                          GetSphericalDistance(startLon,
+                                                               startLat,
+                                                               way->nodes[backwardNodePos].GetLon(),
+                                                               way->nodes[backwardNodePos].GetLat()));
+        node.estimateCost=profile.GetCosts(GetSphericalDistance(startLon,
                                                                 startLat,
-                                                                way->nodes[backwardNodePos].GetLon(),
-                                                                way->nodes[backwardNodePos].GetLat()));
-        node->estimateCost=profile.GetCosts(GetSphericalDistance(startLon,
-                                                                 startLat,
-                                                                 targetLon,
-                                                                 targetLat));
+                                                                targetLon,
+                                                                targetLat));
 
-        node->overallCost=node->currentCost+node->estimateCost;
+        node.overallCost=node.currentCost+node.estimateCost;
 
         backwardRNode=node;
       }
@@ -806,13 +953,25 @@ namespace osmscout {
     }
   }
 
-  bool Router::GetTargetNodes(const ObjectFileRef& object,
+  /**
+    Return the route nodes next to the target position on the target way.
+    forwardCosts and backwardCosts return the costs from the route node to the
+    target position (in the same way as GetStartNodes() calculates the costs from
+    the start position to the start route nodes).
+    */
+  bool Router::GetTargetNodes(const RoutingProfile& profile,
+                              const ObjectFileRef& object,
                               size_t nodeIndex,
                               double& targetLon,
                               double& targetLat,
                               RouteNodeRef& forwardNode,
-                              RouteNodeRef& backwardNode)
+                              RouteNodeRef& backwardNode,
+                              double& forwardCosts,
+                              double& backwardCosts)
   {
+    forwardCosts=0.0;
+    backwardCosts=0.0;
+
     if (object.GetType()==refArea) {
       // TODO:
       return false;
@@ -858,6 +1017,12 @@ namespace osmscout {
                                          forwardRouteNodeOffset)) {
           std::cerr << "Cannot get offset of targetForwardRouteNode" << std::endl;
         }
+
+        forwardCosts=profile.GetCosts(way,
+                                      GetSphericalDistance(targetLon,
+                                                           targetLat,
+                                                           way->nodes[forwardNodePos].GetLon(),
+                                                           way->nodes[forwardNodePos].GetLat()));
       }
 
       if (backwardNode.Valid()) {
@@ -867,6 +1032,12 @@ namespace osmscout {
                                          backwardRouteNodeOffset)) {
           std::cerr << "Cannot get offset of targetBackwardRouteNode" << std::endl;
         }
+
+        backwardCosts=profile.GetCosts(way,
+                                       GetSphericalDistance(targetLon,
+                                                            targetLat,
+                                                            way->nodes[backwardNodePos].GetLon(),
+                                                            way->nodes[backwardNodePos].GetLat()));
       }
 
       return true;
@@ -876,119 +1047,95 @@ namespace osmscout {
     }
   }
 
-
-  bool Router::CalculateRoute(const RoutingProfile& profile,
-                              const ObjectFileRef& startObject,
-                              size_t startNodeIndex,
-                              const ObjectFileRef& targetObject,
-                              size_t targetNodeIndex,
-                              RouteData& route)
+  /**
+    Add a start node to the (empty) pool. If there already is a start node
+    for the same route node, the cheaper one is kept.
+    */
+  void Router::AddStartRNode(const RNode& node)
   {
-    RouteNodeRef             startForwardRouteNode;
-    RouteNodeRef             startBackwardRouteNode;
-    RNodeRef                 startForwardNode;
-    RNodeRef                 startBackwardNode;
-
-    double                   targetLon=0.0L,targetLat=0.0L;
+    RNodeMap::iterator entry=rnodeMap.find(node.nodeOffset);
 
-    RouteNodeRef             targetForwardRouteNode;
-    RouteNodeRef             targetBackwardRouteNode;
-
-    // Sorted list (smallest cost first) of ways to check (we are using a std::set)
-    OpenList                 openList;
-    // Map routing nodes by id
-    OpenMap                  openMap;
-    CloseMap                 closeMap;
-
-    size_t                   nodesLoadedCount=0;
-    size_t                   nodesIgnoredCount=0;
-    size_t                   maxOpenList=0;
-    size_t                   maxCloseMap=0;
-
-    route.Clear();
-
-#if defined(OSMSCOUT_HASHMAP_HAS_RESERVE)
-    openMap.reserve(10000);
-    closeMap.reserve(300000);
-#endif
-
-    if (!GetTargetNodes(targetObject,
-                        targetNodeIndex,
-                        targetLon,
-                        targetLat,
-                        targetForwardRouteNode,
-                        targetBackwardRouteNode)) {
-      return false;
+    if (entry==rnodeMap.end()) {
+      rnodeMap[node.nodeOffset]=rnodes.size();
+      rnodes.push_back(node);
     }
-
-    if (!GetStartNodes(profile,
-                       startObject,
-                       startNodeIndex,
-                       targetLon,
-                       targetLat,
-                       startForwardRouteNode,
-                       startBackwardRouteNode,
-                       startForwardNode,
-                       startBackwardNode)) {
-      return false;
+    else if (node.overallCost<rnodes[entry->second].overallCost) {
+      rnodes[entry->second]=node;
     }
+  }
 
-    if (startForwardNode.Valid()) {
-      std::pair<OpenListRef,bool> result=openList.insert(startForwardNode);
-      openMap[startForwardNode->nodeOffset]=result.first;
-    }
+  /**
+    The A* search itself. The start nodes must already be in the RNode pool.
+
+    OpenList is the priority queue for the open nodes (DAryHeap or RadixHeap),
+    it holds indexes into the pool. On return current is the index of the last
+    node taken from the open list (the target, if a route was found).
+    */
+  template<class OpenList>
+  bool Router::SearchRoute(const RoutingProfile& profile,
+                           double targetLon,
+                           double targetLat,
+                           const RouteNodeRef& targetForwardRouteNode,
+                           const RouteNodeRef& targetBackwardRouteNode,
+                           OpenList& openList,
+                           size_t& current,
+                           RouteNodeRef& currentRouteNode,
+                           RouteStatistics& statistics)
+  {
+    openList.Clear();
 
-    if (startBackwardNode.Valid()) {
-      std::pair<OpenListRef,bool> result=openList.insert(startBackwardNode);
-      openMap[startBackwardNode->nodeOffset]=result.first;
+    for (size_t i=0; i<rnodes.size(); i++) {
+      openList.Push(i,rnodes[i].overallCost);
     }
 
-    StopClock    clock;
-    RNodeRef     current;
-    RouteNodeRef currentRouteNode;
-
     do {
       //
       // Take entry from open list with lowest cost
       //
 
-      current=*openList.begin();
+      current=openList.Pop();
+
+      rnodes[current].closed=true;
 
-      openMap.erase(current->nodeOffset);
-      openList.erase(openList.begin());
+      // Copy what we need, the pool may get reallocated while adding new nodes
+      FileOffset    currentOffset=rnodes[current].nodeOffset;
+      FileOffset    currentPrev=rnodes[current].prev;
+      ObjectFileRef currentObject=rnodes[current].object;
+      double        currentCurrentCost=rnodes[current].currentCost;
+      bool          currentAccess=rnodes[current].access;
 
-      if (!routeNodeDataFile.GetByOffset(current->nodeOffset,
+      if (!routeNodeDataFile.GetByOffset(currentOffset,
                                          currentRouteNode)) {
-        std::cerr << "Cannot load route node with id " << current->nodeOffset << std::endl;
+        std::cerr << "Cannot load route node with id " << currentOffset << std::endl;
         return false;
       }
 
-      nodesLoadedCount++;
+      statistics.nodesLoadedCount++;
 
       // Get potential follower in the current way
 
 #if defined(DEBUG_ROUTING)
       std::cout << "Analysing follower of node " << currentRouteNode->GetFileOffset();
-      std::cout << " (" << current->object.GetTypeName() << " " << current->object.GetFileOffset() << "["  << currentRouteNode->GetId() << "]" << ")";
-      std::cout << " " << current->currentCost << " " << current->estimateCost << " " << current->overallCost << std::endl;
+      std::cout << " (" << currentObject.GetTypeName() << " " << currentObject.GetFileOffset() << "["  << currentRouteNode->GetId() << "]" << ")";
+      std::cout << " " << currentCurrentCost << " " << rnodes[current].estimateCost << " " << rnodes[current].overallCost << std::endl;
 #endif
       size_t i=0;
       for (std::vector<osmscout::RouteNode::Path>::const_iterator path=currentRouteNode->paths.begin();
            path!=currentRouteNode->paths.end();
            ++path,
            ++i) {
-        if (path->offset==current->prev) {
+        if (path->offset==currentPrev) {
 #if defined(DEBUG_ROUTING)
           std::cout << "  Skipping route";
           std::cout << " to " << path->offset;
           std::cout << " (" << currentRouteNode->objects[path->objectIndex].GetTypeName() << " " << currentRouteNode->objects[path->objectIndex].GetFileOffset() << ")";
           std::cout << " => back to the last node visited" << std::endl;
 #endif
-          nodesIgnoredCount++;
+          statistics.nodesIgnoredCount++;
           continue;
         }
 
-        if (!current->access &&
+        if (!currentAccess &&
             path->HasAccess()) {
 #if defined(DEBUG_ROUTING)
           std::cout << "  Skipping route";
@@ -996,7 +1143,7 @@ namespace osmscout {
           std::cout << " (" << currentRouteNode->objects[path->objectIndex].GetTypeName() << " " << currentRouteNode->objects[path->objectIndex].GetFileOffset() << ")";
           std::cout << " => moving from non-accessible way back to accessible way" << std::endl;
 #endif
-          nodesIgnoredCount++;
+          statistics.nodesIgnoredCount++;
           continue;
         }
 
@@ -1007,11 +1154,14 @@ namespace osmscout {
           std::cout << " (" << currentRouteNode->objects[path->objectIndex].GetTypeName() << " " << currentRouteNode->objects[path->objectIndex].GetFileOffset() << ")";
           std::cout << " => Cannot be used"<< std::endl;
 #endif
-          nodesIgnoredCount++;
+          statistics.nodesIgnoredCount++;
           continue;
         }
 
-        if (closeMap.find(path->offset)!=closeMap.end()) {
+        RNodeMap::iterator entry=rnodeMap.find(path->offset);
+
+        if (entry!=rnodeMap.end() &&
+            rnodes[entry->second].closed) {
 #if defined(DEBUG_ROUTING)
           std::cout << "  Skipping route";
           std::cout << " to " << path->offset;
@@ -1024,7 +1174,7 @@ namespace osmscout {
         if (!currentRouteNode->excludes.empty()) {
           bool canTurnedInto=true;
           for (size_t e=0; e<currentRouteNode->excludes.size(); e++) {
-            if (currentRouteNode->excludes[e].source==current->object &&
+            if (currentRouteNode->excludes[e].source==currentObject &&
                 currentRouteNode->excludes[e].targetIndex==i) {
 #if defined(DEBUG_ROUTING)
               std::cout << "  Skipping route";
@@ -1038,31 +1188,29 @@ namespace osmscout {
           }
 
           if (!canTurnedInto) {
-            nodesIgnoredCount++;
+            statistics.nodesIgnoredCount++;
             continue;
           }
         }
 
-        double currentCost=current->currentCost+
+        double currentCost=currentCurrentCost+
                            profile.GetCosts(*currentRouteNode,i);
 
-        OpenMap::iterator openEntry=openMap.find(path->offset);
-
         // Check, if we already have a cheaper path to the new node. If yes, do not put the new path
         // into the open list
-        if (openEntry!=openMap.end() &&
-            (*openEntry->second)->currentCost<=currentCost) {
+        if (entry!=rnodeMap.end() &&
+            rnodes[entry->second].currentCost<=currentCost) {
 #if defined(DEBUG_ROUTING)
           std::cout << "  Skipping route";
           std::cout << " to " << path->offset;
           std::cout << " (" << currentRouteNode->objects[path->objectIndex].GetTypeName() << " " << currentRouteNode->objects[path->objectIndex].GetFileOffset() << ")";
-          std::cout << "  => cheaper route exists " << currentCost << "<=>" << (*openEntry->second)->currentCost << std::endl;
+          std::cout << "  => cheaper route exists " << currentCost << "<=>" << rnodes[entry->second].currentCost << std::endl;
 #endif
           continue;
         }
 
-        double distanceToTarget=GetSphericalDistance(path->lon,
-                                                     path->lat,
+        double distanceToTarget=GetSphericalDistance(path->coord.GetLon(),
+                                                     path->coord.GetLat(),
                                                      targetLon,
                                                      targetLat);
         // Estimate costs for the rest of the distance to the target
@@ -1071,75 +1219,176 @@ namespace osmscout {
 
         // If we already have the node in the open list, but the new path is cheaper,
         // update the existing entry
-        if (openEntry!=openMap.end()) {
-          RNodeRef node=*openEntry->second;
+        if (entry!=rnodeMap.end()) {
+          RNode& node=rnodes[entry->second];
 
-          node->prev=current->nodeOffset;
-          node->object=currentRouteNode->objects[path->objectIndex];
+          node.prev=currentOffset;
+          node.object=currentRouteNode->objects[path->objectIndex];
 
-          node->currentCost=currentCost;
-          node->estimateCost=estimateCost;
-          node->overallCost=overallCost;
-          node->access=currentRouteNode->paths[i].HasAccess();
+          node.currentCost=currentCost;
+          node.estimateCost=estimateCost;
+          node.overallCost=overallCost;
+          node.access=path->HasAccess();
 
 #if defined(DEBUG_ROUTING)
-          std::cout << "  Updating route " << current->nodeOffset << " via " << node->object.GetTypeName() << " " << node->object.GetFileOffset() << " " << currentCost << " " << estimateCost << " " << overallCost << " " << currentRouteNode->id << std::endl;
+          std::cout << "  Updating route " << currentOffset << " via " << node.object.GetTypeName() << " " << node.object.GetFileOffset() << " " << currentCost << " " << estimateCost << " " << overallCost << " " << currentRouteNode->id << std::endl;
 #endif
 
-          openList.erase(openEntry->second);
-
-          std::pair<OpenListRef,bool> result=openList.insert(node);
-          openEntry->second=result.first;
+          openList.Update(entry->second,overallCost);
         }
         else {
-          RNodeRef node=new RNode(path->offset,
-                                  currentRouteNode->objects[path->objectIndex],
-                                  current->nodeOffset);
+          RNode node(path->offset,
+                     currentRouteNode->objects[path->objectIndex],
+                     currentOffset);
 
-          node->currentCost=currentCost;
-          node->estimateCost=estimateCost;
-          node->overallCost=overallCost;
-          node->access=path->HasAccess();
+          node.currentCost=currentCost;
+          node.estimateCost=estimateCost;
+          node.overallCost=overallCost;
+          node.access=path->HasAccess();
 
 #if defined(DEBUG_ROUTING)
           std::cout << "  Inserting route to " << path->offset;
-          std::cout <<  " (" << node->object.GetTypeName() << " " << node->object.GetFileOffset() << ")";
+          std::cout <<  " (" << node.object.GetTypeName() << " " << node.object.GetFileOffset() << ")";
           std::cout << " " << currentCost << " " << estimateCost << " " << overallCost << " " << currentRouteNode->id << std::endl;
 #endif
 
-          std::pair<OpenListRef,bool> result=openList.insert(node);
-          openMap[node->nodeOffset]=result.first;
+          rnodeMap[node.nodeOffset]=rnodes.size();
+          rnodes.push_back(node);
+
+          openList.Push(rnodes.size()-1,overallCost);
         }
       }
 
-      //
-      // Added current node to close map
-      //
-
-      closeMap[current->nodeOffset]=current;
-
-      maxOpenList=std::max(maxOpenList,openMap.size());
-      maxCloseMap=std::max(maxCloseMap,closeMap.size());
+      statistics.maxOpenList=std::max(statistics.maxOpenList,openList.GetSize());
 
 #if defined(DEBUG_ROUTING)
-      if (openList.empty()) {
+      if (openList.IsEmpty()) {
         std::cout << "No more alternatives, stopping" << std::endl;
       }
 
-      if ((targetForwardRouteNode.Valid() && current->nodeOffset==targetForwardRouteNode->fileOffset)) {
-        std::cout << "Reached target: " << current->nodeOffset << " == " << targetForwardRouteNode->fileOffset << " (forward)" << std::endl;
+      if ((targetForwardRouteNode.Valid() && currentOffset==targetForwardRouteNode->fileOffset)) {
+        std::cout << "Reached target: " << currentOffset << " == " << targetForwardRouteNode->fileOffset << " (forward)" << std::endl;
       }
 
-      if (targetBackwardRouteNode.Valid() && current->nodeOffset==targetBackwardRouteNode->fileOffset) {
-        std::cout << "Reached target: " << current->nodeOffset << " == " << targetBackwardRouteNode->fileOffset << " (backward)" << std::endl;
+      if (targetBackwardRouteNode.Valid() && currentOffset==targetBackwardRouteNode->fileOffset) {
+        std::cout << "Reached target: " << currentOffset << " == " << targetBackwardRouteNode->fileOffset << " (backward)" << std::endl;
       }
 #endif
-    } while (!openList.empty() &&
-             (targetForwardRouteNode.Invalid() || current->nodeOffset!=targetForwardRouteNode->fileOffset) &&
-             (targetBackwardRouteNode.Invalid() || current->nodeOffset!=targetBackwardRouteNode->fileOffset));
+    } while (!openList.IsEmpty() &&
+             (targetForwardRouteNode.Invalid() || rnodes[current].nodeOffset!=targetForwardRouteNode->fileOffset) &&
+             (targetBackwardRouteNode.Invalid() || rnodes[current].nodeOffset!=targetBackwardRouteNode->fileOffset));
+
+    return true;
+  }
+
+  bool Router::CalculateRoute(const RoutingProfile& profile,
+                              const ObjectFileRef& startObject,
+                              size_t startNodeIndex,
+                              const ObjectFileRef& targetObject,
+                              size_t targetNodeIndex,
+                              RouteData& route)
+  {
+    if (graph.IsOpen()) {
+      return CalculateRouteGraph(profile,
+                                 startObject,
+                                 startNodeIndex,
+                                 targetObject,
+                                 targetNodeIndex,
+                                 route);
+    }
+
+    RouteNodeRef             startForwardRouteNode;
+    RouteNodeRef             startBackwardRouteNode;
+    RNode                    startForwardNode;
+    RNode                    startBackwardNode;
+
+    double                   startLon=0.0L,startLat=0.0L;
+    double                   targetLon=0.0L,targetLat=0.0L;
+
+    RouteNodeRef             targetForwardRouteNode;
+    RouteNodeRef             targetBackwardRouteNode;
+    double                   targetForwardCosts=0.0;
+    double                   targetBackwardCosts=0.0;
+
+    RouteStatistics          statistics;
+
+    route.Clear();
+
+    if (!GetTargetNodes(profile,
+                        targetObject,
+                        targetNodeIndex,
+                        targetLon,
+                        targetLat,
+                        targetForwardRouteNode,
+                        targetBackwardRouteNode,
+                        targetForwardCosts,
+                        targetBackwardCosts)) {
+      return false;
+    }
+
+    if (!GetStartNodes(profile,
+                       startObject,
+                       startNodeIndex,
+                       startLon,
+                       startLat,
+                       targetLon,
+                       targetLat,
+                       startForwardRouteNode,
+                       startBackwardRouteNode,
+                       startForwardNode,
+                       startBackwardNode)) {
+      return false;
+    }
+
+    // Reset the pool, this keeps the memory allocated by the last calculation
+    rnodes.clear();
+    rnodeMap.clear();
+
+    if (startForwardRouteNode.Valid()) {
+      AddStartRNode(startForwardNode);
+    }
+
+    if (startBackwardRouteNode.Valid()) {
+      AddStartRNode(startBackwardNode);
+    }
+
+    StopClock    clock;
+    size_t       current=0;
+    RouteNodeRef currentRouteNode;
+    bool         success;
+
+    switch (openListType) {
+    case openListRadixHeap:
+      success=SearchRoute(profile,
+                          targetLon,
+                          targetLat,
+                          targetForwardRouteNode,
+                          targetBackwardRouteNode,
+                          radixHeap,
+                          current,
+                          currentRouteNode,
+                          statistics);
+      break;
+    case openListHeap:
+    default:
+      success=SearchRoute(profile,
+                          targetLon,
+                          targetLat,
+                          targetForwardRouteNode,
+                          targetBackwardRouteNode,
+                          heap,
+                          current,
+                          currentRouteNode,
+                          statistics);
+      break;
+    }
 
     clock.Stop();
 
+    if (!success) {
+      return false;
+    }
+
     if (debugPerformance) {
       std::cout << "From:                " << startObject.GetTypeName() << " " << startObject.GetFileOffset();
       std::cout << "[";
@@ -1165,10 +1414,10 @@ namespace osmscout {
 
       std::cout << "Time:                " << clock << std::endl;
 
-      std::cout << "Route nodes loaded:  " << nodesLoadedCount << std::endl;
-      std::cout << "Route nodes ignored: " << nodesIgnoredCount << std::endl;
-      std::cout << "Max. OpenList size:  " << maxOpenList << std::endl;
-      std::cout << "Max. CloseMap size:  " << maxCloseMap << std::endl;
+      std::cout << "Route nodes loaded:  " << statistics.nodesLoadedCount << std::endl;
+      std::cout << "Route nodes ignored: " << statistics.nodesIgnoredCount << std::endl;
+      std::cout << "Max. OpenList size:  " << statistics.maxOpenList << std::endl;
+      std::cout << "RNode pool size:     " << rnodes.size() << std::endl;
     }
 
     if (!((targetForwardRouteNode.Valid() && currentRouteNode->GetId()==targetForwardRouteNode->id) ||
@@ -1179,10 +1428,9 @@ namespace osmscout {
       return true;
     }
 
-    std::list<RNodeRef> nodes;
+    std::list<RNode> nodes;
 
     ResolveRNodeChainToList(current,
-                            closeMap,
                             nodes);
 
     if (!ResolveRNodesToRouteData(profile,
@@ -1201,6 +1449,2111 @@ namespace osmscout {
     return true;
   }
 
+  bool Router::HasRouteGraph() const
+  {
+    return graph.IsOpen();
+  }
+
+  void Router::ResetGraphSearch()
+  {
+    for (std::vector<uint32_t>::const_iterator node=graphSearch.touched.begin();
+         node!=graphSearch.touched.end();
+         ++node) {
+      graphSearch.prev[*node]=RouteGraph::noNode;
+      graphSearch.object[*node]=RouteGraph::noObject;
+      graphSearch.state[*node]=0;
+    }
+
+    graphSearch.touched.clear();
+  }
+
+  /**
+    Add a start node (as returned by GetStartNodes()) to the graph search. If
+    there already is a start node for the same route node, the cheaper one is kept.
+    */
+  void Router::AddGraphStartNode(const RNode& node,
+                                 uint32_t startObject)
+  {
+    uint32_t index;
+
+    if (!graph.GetNodeIndex(node.nodeOffset,index)) {
+      std::cerr << "Cannot find start route node " << node.nodeOffset << " in routing graph" << std::endl;
+      return;
+    }
+
+    if (graphSearch.state[index] & graphNodeTouched) {
+      if (node.currentCost>=graphSearch.costs[index]) {
+        return;
+      }
+    }
+    else {
+      graphSearch.touched.push_back(index);
+    }
+
+    graphSearch.costs[index]=node.currentCost;
+    graphSearch.prev[index]=RouteGraph::noNode;
+    graphSearch.object[index]=startObject;
+    graphSearch.state[index]=graphNodeTouched | graphNodeAccess;
+  }
+
+  /**
+    The A* search in the compact routing graph. Same rules as SearchRoute(), but
+    all state is held in the preallocated vectors of graphSearch and the
+    route nodes are read directly from the memory mapped graph, so no memory is
+    allocated while searching. The start nodes must already be touched.
+
+    On return current is the index of the last node taken from the open list
+    (the target, if a route was found).
+    */
+  template<class OpenList>
+  bool Router::SearchRouteGraph(const RoutingProfile& profile,
+                                double startLon,
+                                double startLat,
+                                double targetLon,
+                                double targetLat,
+                                uint32_t targetForwardNode,
+                                uint32_t targetBackwardNode,
+                                OpenList& openList,
+                                uint32_t& current,
+                                RouteStatistics& statistics)
+  {
+    RouteNode::Path path;
+
+    double startEstimateCosts=profile.GetCosts(GetSphericalDistance(startLon,
+                                                                    startLat,
+                                                                    targetLon,
+                                                                    targetLat));
+
+    openList.Clear();
+
+    for (std::vector<uint32_t>::const_iterator node=graphSearch.touched.begin();
+         node!=graphSearch.touched.end();
+         ++node) {
+      openList.Push(*node,
+                    graphSearch.costs[*node]+startEstimateCosts);
+    }
+
+    while (!openList.IsEmpty()) {
+      current=(uint32_t)openList.Pop();
+
+      graphSearch.state[current]|=graphNodeClosed;
+
+      statistics.nodesLoadedCount++;
+
+      if (current==targetForwardNode ||
+          current==targetBackwardNode) {
+        return true;
+      }
+
+      uint32_t currentPrev=graphSearch.prev[current];
+      uint32_t currentObject=graphSearch.object[current];
+      double   currentCosts=graphSearch.costs[current];
+      bool     currentAccess=(graphSearch.state[current] & graphNodeAccess)!=0;
+      uint32_t edgesBegin=graph.GetEdgesBegin(current);
+      uint32_t edgesEnd=graph.GetEdgesEnd(current);
+      uint32_t excludesBegin=graph.GetExcludesBegin(current);
+      uint32_t excludesEnd=graph.GetExcludesEnd(current);
+
+      for (uint32_t e=edgesBegin; e<edgesEnd; e++) {
+        const RouteGraph::Edge& edge=graph.GetEdge(e);
+        uint32_t                target=edge.target;
+
+        if (target==currentPrev) {
+          statistics.nodesIgnoredCount++;
+          continue;
+        }
+
+        if (!currentAccess &&
+            (edge.flags & RouteNode::hasAccess)) {
+          statistics.nodesIgnoredCount++;
+          continue;
+        }
+
+        graph.GetPath(e,path);
+
+        if (!profile.CanUse(path)) {
+          statistics.nodesIgnoredCount++;
+          continue;
+        }
+
+        if (graphSearch.state[target] & graphNodeClosed) {
+          continue;
+        }
+
+        bool canTurnInto=true;
+
+        for (uint32_t x=excludesBegin; x<excludesEnd; x++) {
+          const RouteGraph::Exclude& exclude=graph.GetExclude(x);
+
+          if (exclude.source==currentObject &&
+              exclude.targetEdge==e-edgesBegin) {
+            canTurnInto=false;
+            break;
+          }
+        }
+
+        if (!canTurnInto) {
+          statistics.nodesIgnoredCount++;
+          continue;
+        }
+
+        double costs=currentCosts+profile.GetCosts(path);
+        bool   touched=(graphSearch.state[target] & graphNodeTouched)!=0;
+
+        // Check, if we already have a cheaper path to the new node
+        if (touched &&
+            graphSearch.costs[target]<=costs) {
+          continue;
+        }
+
+        double overallCosts=costs+
+                            profile.GetCosts(GetSphericalDistance(path.coord.GetLon(),
+                                                                  path.coord.GetLat(),
+                                                                  targetLon,
+                                                                  targetLat));
+
+        graphSearch.costs[target]=costs;
+        graphSearch.prev[target]=current;
+        graphSearch.object[target]=edge.object;
+        graphSearch.state[target]=graphNodeTouched;
+
+        if (path.HasAccess()) {
+          graphSearch.state[target]|=graphNodeAccess;
+        }
+
+        if (!touched) {
+          graphSearch.touched.push_back(target);
+          openList.Push(target,overallCosts);
+        }
+        else {
+          openList.Update(target,overallCosts);
+        }
+      }
+
+      statistics.maxOpenList=std::max(statistics.maxOpenList,openList.GetSize());
+    }
+
+    return true;
+  }
+
+  /**
+    Convert the chain of graph nodes ending at the given node to a list of
+    RNodes as expected by ResolveRNodesToRouteData().
+    */
+  void Router::ResolveGraphNodeChainToList(uint32_t end,
+                                           const ObjectFileRef& startObject,
+                                           std::list<RNode>& nodes) const
+  {
+    uint32_t current=end;
+
+    while (true) {
+      uint32_t      prev=graphSearch.prev[current];
+      ObjectFileRef object=startObject;
+
+      if (prev!=RouteGraph::noNode) {
+        object=graph.GetObject(graphSearch.object[current]);
+      }
+
+      RNode node(graph.GetNode(current).offset,
+                 object,
+                 prev!=RouteGraph::noNode ? graph.GetNode(prev).offset : 0);
+
+      node.currentCost=graphSearch.costs[current];
+      node.overallCost=graphSearch.costs[current];
+      node.closed=true;
+
+      nodes.push_front(node);
+
+      if (prev==RouteGraph::noNode) {
+        break;
+      }
+
+      current=prev;
+    }
+  }
+
+  bool Router::CalculateRouteGraph(const RoutingProfile& profile,
+                                   const ObjectFileRef& startObject,
+                                   size_t startNodeIndex,
+                                   const ObjectFileRef& targetObject,
+                                   size_t targetNodeIndex,
+                                   RouteData& route)
+  {
+    RouteNodeRef    startForwardRouteNode;
+    RouteNodeRef    startBackwardRouteNode;
+    RNode           startForwardNode;
+    RNode           startBackwardNode;
+
+    double          startLon=0.0L,startLat=0.0L;
+    double          targetLon=0.0L,targetLat=0.0L;
+
+    RouteNodeRef    targetForwardRouteNode;
+    RouteNodeRef    targetBackwardRouteNode;
+    double          targetForwardCosts=0.0;
+    double          targetBackwardCosts=0.0;
+    uint32_t        targetForwardNode=RouteGraph::noNode;
+    uint32_t        targetBackwardNode=RouteGraph::noNode;
+
+    RouteStatistics statistics;
+
+    route.Clear();
+
+    if (!GetTargetNodes(profile,
+                        targetObject,
+                        targetNodeIndex,
+                        targetLon,
+                        targetLat,
+                        targetForwardRouteNode,
+                        targetBackwardRouteNode,
+                        targetForwardCosts,
+                        targetBackwardCosts)) {
+      return false;
+    }
+
+    if (!GetStartNodes(profile,
+                       startObject,
+                       startNodeIndex,
+                       startLon,
+                       startLat,
+                       targetLon,
+                       targetLat,
+                       startForwardRouteNode,
+                       startBackwardRouteNode,
+                       startForwardNode,
+                       startBackwardNode)) {
+      return false;
+    }
+
+    if (targetForwardRouteNode.Valid() &&
+        !graph.GetNodeIndex(targetForwardRouteNode->GetFileOffset(),
+                            targetForwardNode)) {
+      std::cerr << "Cannot find target route node in routing graph" << std::endl;
+      return false;
+    }
+
+    if (targetBackwardRouteNode.Valid() &&
+        !graph.GetNodeIndex(targetBackwardRouteNode->GetFileOffset(),
+                            targetBackwardNode)) {
+      std::cerr << "Cannot find target route node in routing graph" << std::endl;
+      return false;
+    }
+
+    uint32_t startObjectIndex=graph.GetObjectIndex(startObject);
+
+    ResetGraphSearch();
+
+    if (startForwardRouteNode.Valid()) {
+      AddGraphStartNode(startForwardNode,
+                        startObjectIndex);
+    }
+
+    if (startBackwardRouteNode.Valid()) {
+      AddGraphStartNode(startBackwardNode,
+                        startObjectIndex);
+    }
+
+    StopClock clock;
+    uint32_t  current=RouteGraph::noNode;
+    bool      success;
+
+    switch (openListType) {
+    case openListRadixHeap:
+      success=SearchRouteGraph(profile,
+                               startLon,
+                               startLat,
+                               targetLon,
+                               targetLat,
+                               targetForwardNode,
+                               targetBackwardNode,
+                               radixHeap,
+                               current,
+                               statistics);
+      break;
+    case openListHeap:
+    default:
+      success=SearchRouteGraph(profile,
+                               startLon,
+                               startLat,
+                               targetLon,
+                               targetLat,
+                               targetForwardNode,
+                               targetBackwardNode,
+                               heap,
+                               current,
+                               statistics);
+      break;
+    }
+
+    clock.Stop();
+
+    if (!success) {
+      return false;
+    }
+
+    if (debugPerformance) {
+      std::cout << "From:                " << startObject.GetTypeName() << " " << startObject.GetFileOffset();
+      std::cout << "[";
+      if (startForwardRouteNode.Valid()) {
+        std::cout << startForwardRouteNode->GetId() << " - ";
+      }
+      std::cout << startNodeIndex;
+      if (startBackwardRouteNode.Valid()) {
+        std::cout << " - " << startBackwardRouteNode->GetId();
+      }
+      std::cout << "]" << std::endl;
+
+      std::cout << "To:                  " << targetObject.GetTypeName() <<  " " << targetObject.GetFileOffset();
+      std::cout << "[";
+      if (targetForwardRouteNode.Valid()) {
+        std::cout << targetForwardRouteNode->GetId() << " - ";
+      }
+      std::cout << targetNodeIndex;
+      if (targetBackwardRouteNode.Valid()) {
+        std::cout << " - " << targetBackwardRouteNode->GetId();
+      }
+      std::cout << "]" << std::endl;
+
+
+      std::cout << "Time:                " << clock << std::endl;
+
+      std::cout << "Route nodes loaded:  " << statistics.nodesLoadedCount << std::endl;
+      std::cout << "Route nodes ignored: " << statistics.nodesIgnoredCount << std::endl;
+      std::cout << "Max. OpenList size:  " << statistics.maxOpenList << std::endl;
+      std::cout << "Nodes touched:       " << graphSearch.touched.size() << std::endl;
+    }
+
+    if (current==RouteGraph::noNode ||
+        (current!=targetForwardNode &&
+         current!=targetBackwardNode)) {
+      std::cout << "No route found!" << std::endl;
+      route.Clear();
+
+      return true;
+    }
+
+    std::list<RNode> nodes;
+
+    ResolveGraphNodeChainToList(current,
+                                startObject,
+                                nodes);
+
+    if (!ResolveRNodesToRouteData(profile,
+                                  nodes,
+                                  startObject,
+                                  startNodeIndex,
+                                  targetObject,
+                                  targetNodeIndex,
+                                  route)) {
+      return false;
+    }
+
+    ResolveRouteDataJunctions(route);
+
+    return true;
+  }
+
+  /**
+    A path of the routing graph while building the list of incoming paths
+    */
+  struct IncomingPathEntry
+  {
+    FileOffset target;
+    FileOffset source;
+    uint32_t   pathIndex;
+    double     lat;
+    double     lon;
+
+    inline bool operator<(const IncomingPathEntry& other) const
+    {
+      if (target!=other.target) {
+        return target<other.target;
+      }
+
+      if (source!=other.source) {
+        return source<other.source;
+      }
+
+      return pathIndex<other.pathIndex;
+    }
+  };
+
+  /**
+    Potential of a position for the bidirectional search: the average of the
+    estimated costs to the target and the negated estimated costs from the start.
+    Using this potential for the forward search and its negation for the backward
+    search keeps both searches consistent with each other.
+    */
+  static inline double GetBidirectionalPotential(const RoutingProfile& profile,
+                                                 double lon,
+                                                 double lat,
+                                                 double startLon,
+                                                 double startLat,
+                                                 double targetLon,
+                                                 double targetLat)
+  {
+    return (profile.GetCosts(GetSphericalDistance(lon,lat,targetLon,targetLat))-
+            profile.GetCosts(GetSphericalDistance(lon,lat,startLon,startLat)))/2;
+  }
+
+  /**
+    Scan the routing graph once and build the list of incoming paths for
+    each route node. The route data file only stores outgoing paths, but the
+    backward search must find the paths leading to a route node.
+    */
+  bool Router::LoadIncomingPaths()
+  {
+    FileScanner                    scanner;
+    uint32_t                       nodeCount;
+    RouteNode                      node;
+    std::vector<IncomingPathEntry> entries;
+
+    if (!scanner.Open(AppendFileToDir(path,
+                                      GetDataFilename(vehicle)),
+                      FileScanner::Sequential,
+                      true)) {
+      std::cerr << "Cannot open '" << scanner.GetFilename() << "'!" << std::endl;
+      return false;
+    }
+
+    if (!scanner.Read(nodeCount)) {
+      std::cerr << "Error while reading number of data entries in file '" << scanner.GetFilename() << "'!" << std::endl;
+      scanner.Close();
+      return false;
+    }
+
+    for (uint32_t n=0; n<nodeCount; n++) {
+      if (!node.Read(scanner)) {
+        std::cerr << "Error while reading data entry " << n << " of file '" << scanner.GetFilename() << "'!" << std::endl;
+        scanner.Close();
+        return false;
+      }
+
+      for (size_t p=0; p<node.paths.size(); p++) {
+        IncomingPathEntry entry;
+
+        entry.target=node.paths[p].offset;
+        entry.source=node.GetFileOffset();
+        entry.pathIndex=(uint32_t)p;
+        entry.lat=node.paths[p].coord.GetLat();
+        entry.lon=node.paths[p].coord.GetLon();
+
+        entries.push_back(entry);
+      }
+    }
+
+    scanner.Close();
+
+    std::sort(entries.begin(),entries.end());
+
+    incomingNodes.clear();
+    incomingPaths.clear();
+    incomingPaths.reserve(entries.size());
+
+    for (std::vector<IncomingPathEntry>::const_iterator entry=entries.begin();
+         entry!=entries.end();
+         ++entry) {
+      if (incomingNodes.empty() ||
+          incomingNodes.back().offset!=entry->target) {
+        IncomingNode incomingNode;
+
+        incomingNode.offset=entry->target;
+        incomingNode.lat=entry->lat;
+        incomingNode.lon=entry->lon;
+        incomingNode.firstPath=(uint32_t)incomingPaths.size();
+        incomingNode.lastPath=(uint32_t)incomingPaths.size();
+
+        incomingNodes.push_back(incomingNode);
+      }
+
+      IncomingPath incomingPath;
+
+      incomingPath.source=entry->source;
+      incomingPath.pathIndex=entry->pathIndex;
+
+      incomingPaths.push_back(incomingPath);
+      incomingNodes.back().lastPath++;
+    }
+
+    return true;
+  }
+
+  /**
+    Return the incoming paths of the given route node, or NULL, if there are none.
+    */
+  const Router::IncomingNode* Router::GetIncomingNode(FileOffset offset) const
+  {
+    std::vector<IncomingNode>::const_iterator node=std::lower_bound(incomingNodes.begin(),
+                                                                    incomingNodes.end(),
+                                                                    offset);
+
+    if (node==incomingNodes.end() ||
+        node->offset!=offset) {
+      return NULL;
+    }
+
+    return &(*node);
+  }
+
+  /**
+    Add a target node to the (empty) backward pool. If there already is a
+    node for the same route node, the cheaper one is kept.
+    */
+  void Router::AddBackwardRNode(const RNode& node)
+  {
+    RNodeMap::iterator entry=backwardRNodeMap.find(node.nodeOffset);
+
+    if (entry==backwardRNodeMap.end()) {
+      backwardRNodeMap[node.nodeOffset]=backwardRNodes.size();
+      backwardRNodes.push_back(node);
+    }
+    else if (node.overallCost<backwardRNodes[entry->second].overallCost) {
+      backwardRNodes[entry->second]=node;
+    }
+  }
+
+  /**
+    Check, if the path of the forward search to the given route node can be
+    continued by the path of the backward search from this node. The same rules
+    as in the forward search apply: no turning back, no turns forbidden by an
+    exclude and no move from a non-accessible way back to an accessible way.
+    */
+  bool Router::IsValidJoin(const RouteNode& routeNode,
+                           const RNode& forwardNode,
+                           const RNode& backwardNode) const
+  {
+    // Target of the backward search, the route ends here
+    if (backwardNode.prev==0) {
+      return true;
+    }
+
+    if (forwardNode.prev==backwardNode.prev) {
+      return false;
+    }
+
+    if (!forwardNode.access &&
+        backwardNode.access) {
+      return false;
+    }
+
+    for (std::vector<RouteNode::Exclude>::const_iterator exclude=routeNode.excludes.begin();
+         exclude!=routeNode.excludes.end();
+         ++exclude) {
+      if (exclude->source==forwardNode.object &&
+          exclude->targetIndex<routeNode.paths.size()) {
+        const RouteNode::Path& path=routeNode.paths[exclude->targetIndex];
+
+        if (path.offset==backwardNode.prev &&
+            routeNode.objects[path.objectIndex]==backwardNode.object) {
+          return false;
+        }
+      }
+    }
+
+    return true;
+  }
+
+  void Router::UpdateBestJoin(const RouteNode& routeNode,
+                              size_t forwardIndex,
+                              size_t backwardIndex,
+                              double& bestCosts,
+                              size_t& bestForward,
+                              size_t& bestBackward) const
+  {
+    double costs=rnodes[forwardIndex].currentCost+backwardRNodes[backwardIndex].currentCost;
+
+    if (costs<bestCosts &&
+        IsValidJoin(routeNode,
+                    rnodes[forwardIndex],
+                    backwardRNodes[backwardIndex])) {
+      bestCosts=costs;
+      bestForward=forwardIndex;
+      bestBackward=backwardIndex;
+    }
+  }
+
+  /**
+    The bidirectional A* search. The start nodes must already be in the RNode
+    pool, the target nodes in the backward pool.
+
+    The forward search runs from the start nodes along the paths of the routing
+    graph, the backward search from the target nodes along the incoming paths.
+    In the backward pool prev is the next route node on the way to the target
+    and object the object used to get there.
+
+    Both searches use the same potential (negated for the backward search), so
+    a node is reached by both searches with the overall cost of the route via
+    this node. Every time a node is reached or settled by one search and is
+    already known to the other search, the joined route is a candidate for the
+    best route. The search stops as soon as the sum of the lowest costs in both
+    open lists is not lower than the costs of the best route found, since no
+    route not found yet can be cheaper.
+    */
+  template<class OpenList>
+  bool Router::SearchRouteBidirectional(const RoutingProfile& profile,
+                                        double startLon,
+                                        double startLat,
+                                        double targetLon,
+                                        double targetLat,
+                                        OpenList& forwardOpenList,
+                                        OpenList& backwardOpenList,
+                                        double& bestCosts,
+                                        size_t& bestForward,
+                                        size_t& bestBackward,
+                                        RouteStatistics& statistics)
+  {
+    RouteNodeRef currentRouteNode;
+    RouteNodeRef otherRouteNode;
+
+    forwardOpenList.Clear();
+    backwardOpenList.Clear();
+
+    for (size_t i=0; i<rnodes.size(); i++) {
+      forwardOpenList.Push(i,rnodes[i].overallCost);
+    }
+
+    for (size_t i=0; i<backwardRNodes.size(); i++) {
+      backwardOpenList.Push(i,backwardRNodes[i].overallCost);
+    }
+
+    // A start node may also be a target node
+    for (size_t i=0; i<rnodes.size(); i++) {
+      RNodeMap::const_iterator entry=backwardRNodeMap.find(rnodes[i].nodeOffset);
+
+      if (entry!=backwardRNodeMap.end() &&
+          rnodes[i].currentCost+backwardRNodes[entry->second].currentCost<bestCosts) {
+        bestCosts=rnodes[i].currentCost+backwardRNodes[entry->second].currentCost;
+        bestForward=i;
+        bestBackward=entry->second;
+      }
+    }
+
+    while (!forwardOpenList.IsEmpty() &&
+           !backwardOpenList.IsEmpty()) {
+      if (forwardOpenList.GetMinPriority()+backwardOpenList.GetMinPriority()>=bestCosts) {
+        break;
+      }
+
+      // Expand the search with the smaller open list
+      bool forward=forwardOpenList.GetSize()<=backwardOpenList.GetSize();
+
+      if (forward) {
+        size_t current=forwardOpenList.Pop();
+
+        rnodes[current].closed=true;
+
+        // Copy what we need, the pool may get reallocated while adding new nodes
+        FileOffset    currentOffset=rnodes[current].nodeOffset;
+        FileOffset    currentPrev=rnodes[current].prev;
+        ObjectFileRef currentObject=rnodes[current].object;
+        double        currentCurrentCost=rnodes[current].currentCost;
+        bool          currentAccess=rnodes[current].access;
+
+        if (!routeNodeDataFile.GetByOffset(currentOffset,
+                                           currentRouteNode)) {
+          std::cerr << "Cannot load route node with id " << currentOffset << std::endl;
+          return false;
+        }
+
+        statistics.nodesLoadedCount++;
+
+        // Check, if the settled node joins with the backward search
+        RNodeMap::const_iterator settled=backwardRNodeMap.find(currentOffset);
+
+        if (settled!=backwardRNodeMap.end()) {
+          UpdateBestJoin(*currentRouteNode,
+                         current,
+                         settled->second,
+                         bestCosts,
+                         bestForward,
+                         bestBackward);
+        }
+
+        size_t i=0;
+        for (std::vector<RouteNode::Path>::const_iterator path=currentRouteNode->paths.begin();
+             path!=currentRouteNode->paths.end();
+             ++path,
+             ++i) {
+          if (path->offset==currentPrev ||
+              (!currentAccess && path->HasAccess()) ||
+              !profile.CanUse(*currentRouteNode,i)) {
+            statistics.nodesIgnoredCount++;
+            continue;
+          }
+
+          RNodeMap::iterator entry=rnodeMap.find(path->offset);
+
+          if (entry!=rnodeMap.end() &&
+              rnodes[entry->second].closed) {
+            continue;
+          }
+
+          bool canTurnedInto=true;
+          for (size_t e=0; e<currentRouteNode->excludes.size(); e++) {
+            if (currentRouteNode->excludes[e].source==currentObject &&
+                currentRouteNode->excludes[e].targetIndex==i) {
+              canTurnedInto=false;
+              break;
+            }
+          }
+
+          if (!canTurnedInto) {
+            statistics.nodesIgnoredCount++;
+            continue;
+          }
+
+          double currentCost=currentCurrentCost+
+                             profile.GetCosts(*currentRouteNode,i);
+
+          if (entry!=rnodeMap.end() &&
+              rnodes[entry->second].currentCost<=currentCost) {
+            continue;
+          }
+
+          double estimateCost=GetBidirectionalPotential(profile,
+                                                        path->coord.GetLon(),
+                                                        path->coord.GetLat(),
+                                                        startLon,
+                                                        startLat,
+                                                        targetLon,
+                                                        targetLat);
+          double overallCost=currentCost+estimateCost;
+          size_t index;
+
+          if (entry!=rnodeMap.end()) {
+            index=entry->second;
+
+            RNode& node=rnodes[index];
+
+            node.prev=currentOffset;
+            node.object=currentRouteNode->objects[path->objectIndex];
+
+            node.currentCost=currentCost;
+            node.estimateCost=estimateCost;
+            node.overallCost=overallCost;
+            node.access=path->HasAccess();
+
+            forwardOpenList.Update(index,overallCost);
+          }
+          else {
+            RNode node(path->offset,
+                       currentRouteNode->objects[path->objectIndex],
+                       currentOffset);
+
+            node.currentCost=currentCost;
+            node.estimateCost=estimateCost;
+            node.overallCost=overallCost;
+            node.access=path->HasAccess();
+
+            index=rnodes.size();
+
+            rnodeMap[node.nodeOffset]=index;
+            rnodes.push_back(node);
+
+            forwardOpenList.Push(index,overallCost);
+          }
+
+          // Check, if we found a better connection to the backward search
+          RNodeMap::const_iterator other=backwardRNodeMap.find(path->offset);
+
+          if (other!=backwardRNodeMap.end() &&
+              currentCost+backwardRNodes[other->second].currentCost<bestCosts) {
+            if (!routeNodeDataFile.GetByOffset(path->offset,
+                                               otherRouteNode)) {
+              std::cerr << "Cannot load route node with id " << path->offset << std::endl;
+              return false;
+            }
+
+            UpdateBestJoin(*otherRouteNode,
+                           index,
+                           other->second,
+                           bestCosts,
+                           bestForward,
+                           bestBackward);
+          }
+        }
+
+        statistics.maxOpenList=std::max(statistics.maxOpenList,forwardOpenList.GetSize());
+      }
+      else {
+        size_t current=backwardOpenList.Pop();
+
+        backwardRNodes[current].closed=true;
+
+        // Copy what we need, the pool may get reallocated while adding new nodes
+        FileOffset    currentOffset=backwardRNodes[current].nodeOffset;
+        FileOffset    currentNext=backwardRNodes[current].prev;
+        double        currentCurrentCost=backwardRNodes[current].currentCost;
+
+        const IncomingNode* incomingNode=GetIncomingNode(currentOffset);
+
+        statistics.nodesLoadedCount++;
+
+        if (incomingNode==NULL) {
+          continue;
+        }
+
+        if (!routeNodeDataFile.GetByOffset(currentOffset,
+                                           currentRouteNode)) {
+          std::cerr << "Cannot load route node with id " << currentOffset << std::endl;
+          return false;
+        }
+
+        // Check, if the settled node joins with the forward search
+        RNodeMap::const_iterator settled=rnodeMap.find(currentOffset);
+
+        if (settled!=rnodeMap.end()) {
+          UpdateBestJoin(*currentRouteNode,
+                         settled->second,
+                         current,
+                         bestCosts,
+                         bestForward,
+                         bestBackward);
+        }
+
+        for (uint32_t p=incomingNode->firstPath; p<incomingNode->lastPath; p++) {
+          const IncomingPath& incomingPath=incomingPaths[p];
+
+          if (incomingPath.source==currentNext) {
+            statistics.nodesIgnoredCount++;
+            continue;
+          }
+
+          RNodeMap::iterator entry=backwardRNodeMap.find(incomingPath.source);
+
+          if (entry!=backwardRNodeMap.end() &&
+              backwardRNodes[entry->second].closed) {
+            continue;
+          }
+
+          RouteNodeRef sourceRouteNode;
+
+          if (!routeNodeDataFile.GetByOffset(incomingPath.source,
+                                             sourceRouteNode)) {
+            std::cerr << "Cannot load route node with id " << incomingPath.source << std::endl;
+            return false;
+          }
+
+          if (incomingPath.pathIndex>=sourceRouteNode->paths.size()) {
+            std::cerr << "Path index " << incomingPath.pathIndex << " of route node " << sourceRouteNode->GetId() << " is not valid" << std::endl;
+            return false;
+          }
+
+          const RouteNode::Path& path=sourceRouteNode->paths[incomingPath.pathIndex];
+          ObjectFileRef          object=sourceRouteNode->objects[path.objectIndex];
+
+          if (!profile.CanUse(*sourceRouteNode,incomingPath.pathIndex)) {
+            statistics.nodesIgnoredCount++;
+            continue;
+          }
+
+          // Excludes are stored in the current node, so check if we may continue
+          // from the incoming path to the path of the backward search
+          RNode via(currentOffset,
+                    object,
+                    incomingPath.source);
+
+          via.access=path.HasAccess();
+
+          if (!IsValidJoin(*currentRouteNode,
+                           via,
+                           backwardRNodes[current])) {
+            statistics.nodesIgnoredCount++;
+            continue;
+          }
+
+          double currentCost=currentCurrentCost+
+                             profile.GetCosts(*sourceRouteNode,incomingPath.pathIndex);
+
+          if (entry!=backwardRNodeMap.end() &&
+              backwardRNodes[entry->second].currentCost<=currentCost) {
+            continue;
+          }
+
+          const IncomingNode* sourceNode=GetIncomingNode(incomingPath.source);
+          double              sourceLon=sourceNode!=NULL ? sourceNode->lon : incomingNode->lon;
+          double              sourceLat=sourceNode!=NULL ? sourceNode->lat : incomingNode->lat;
+          double              estimateCost=-GetBidirectionalPotential(profile,
+                                                                      sourceLon,
+                                                                      sourceLat,
+                                                                      startLon,
+                                                                      startLat,
+                                                                      targetLon,
+                                                                      targetLat);
+          double              overallCost=currentCost+estimateCost;
+          size_t              index;
+
+          if (entry!=backwardRNodeMap.end()) {
+            index=entry->second;
+
+            RNode& node=backwardRNodes[index];
+
+            node.prev=currentOffset;
+            node.object=object;
+
+            node.currentCost=currentCost;
+            node.estimateCost=estimateCost;
+            node.overallCost=overallCost;
+            node.access=path.HasAccess();
+
+            backwardOpenList.Update(index,overallCost);
+          }
+          else {
+            RNode node(incomingPath.source,
+                       object,
+                       currentOffset);
+
+            node.currentCost=currentCost;
+            node.estimateCost=estimateCost;
+            node.overallCost=overallCost;
+            node.access=path.HasAccess();
+
+            index=backwardRNodes.size();
+
+            backwardRNodeMap[node.nodeOffset]=index;
+            backwardRNodes.push_back(node);
+
+            backwardOpenList.Push(index,overallCost);
+          }
+
+          // Check, if we found a better connection to the forward search
+          RNodeMap::const_iterator other=rnodeMap.find(incomingPath.source);
+
+          if (other!=rnodeMap.end()) {
+            UpdateBestJoin(*sourceRouteNode,
+                           other->second,
+                           index,
+                           bestCosts,
+                           bestForward,
+                           bestBackward);
+          }
+        }
+
+        statistics.maxOpenList=std::max(statistics.maxOpenList,backwardOpenList.GetSize());
+      }
+    }
+
+    return true;
+  }
+
+  /**
+    Calculate a route like CalculateRoute(), but search from the start and
+    from the target at the same time. On long routes this visits far less
+    route nodes.
+
+    The incoming paths of all route nodes are required for the search from
+    the target, they are loaded by the first call.
+    */
+  bool Router::CalculateRouteBidirectional(const RoutingProfile& profile,
+                                           const ObjectFileRef& startObject,
+                                           size_t startNodeIndex,
+                                           const ObjectFileRef& targetObject,
+                                           size_t targetNodeIndex,
+                                           RouteData& route)
+  {
+    RouteNodeRef    startForwardRouteNode;
+    RouteNodeRef    startBackwardRouteNode;
+    RNode           startForwardNode;
+    RNode           startBackwardNode;
+
+    double          startLon=0.0L,startLat=0.0L;
+    double          targetLon=0.0L,targetLat=0.0L;
+
+    RouteNodeRef    targetForwardRouteNode;
+    RouteNodeRef    targetBackwardRouteNode;
+    double          targetForwardCosts=0.0;
+    double          targetBackwardCosts=0.0;
+
+    RouteStatistics statistics;
+
+    route.Clear();
+
+    if (incomingNodes.empty() &&
+        !LoadIncomingPaths()) {
+      return false;
+    }
+
+    if (!GetTargetNodes(profile,
+                        targetObject,
+                        targetNodeIndex,
+                        targetLon,
+                        targetLat,
+                        targetForwardRouteNode,
+                        targetBackwardRouteNode,
+                        targetForwardCosts,
+                        targetBackwardCosts)) {
+      return false;
+    }
+
+    if (!GetStartNodes(profile,
+                       startObject,
+                       startNodeIndex,
+                       startLon,
+                       startLat,
+                       targetLon,
+                       targetLat,
+                       startForwardRouteNode,
+                       startBackwardRouteNode,
+                       startForwardNode,
+                       startBackwardNode)) {
+      return false;
+    }
+
+    // Reset the pools, this keeps the memory allocated by the last calculation
+    rnodes.clear();
+    rnodeMap.clear();
+    backwardRNodes.clear();
+    backwardRNodeMap.clear();
+
+    RouteNodeRef startRouteNodes[]={startForwardRouteNode,startBackwardRouteNode};
+    RNode        startNodes[]={startForwardNode,startBackwardNode};
+
+    for (size_t i=0; i<2; i++) {
+      if (startRouteNodes[i].Invalid()) {
+        continue;
+      }
+
+      const IncomingNode* incomingNode=GetIncomingNode(startNodes[i].nodeOffset);
+
+      startNodes[i].estimateCost=GetBidirectionalPotential(profile,
+                                                           incomingNode!=NULL ? incomingNode->lon : startLon,
+                                                           incomingNode!=NULL ? incomingNode->lat : startLat,
+                                                           startLon,
+                                                           startLat,
+                                                           targetLon,
+                                                           targetLat);
+      startNodes[i].overallCost=startNodes[i].currentCost+startNodes[i].estimateCost;
+
+      AddStartRNode(startNodes[i]);
+    }
+
+    RouteNodeRef targetRouteNodes[]={targetForwardRouteNode,targetBackwardRouteNode};
+    double       targetCosts[]={targetForwardCosts,targetBackwardCosts};
+
+    for (size_t i=0; i<2; i++) {
+      if (targetRouteNodes[i].Invalid()) {
+        continue;
+      }
+
+      const IncomingNode* incomingNode=GetIncomingNode(targetRouteNodes[i]->GetFileOffset());
+      RNode               node(targetRouteNodes[i]->GetFileOffset(),
+                               targetObject);
+
+      // There is no next path, so there are no restrictions for entering the target
+      node.access=false;
+      // The costs of the rest of the target way must be part of the route costs,
+      // else a target route node cheap to reach but far from the target wins
+      node.currentCost=targetCosts[i];
+      node.estimateCost=-GetBidirectionalPotential(profile,
+                                                   incomingNode!=NULL ? incomingNode->lon : targetLon,
+                                                   incomingNode!=NULL ? incomingNode->lat : targetLat,
+                                                   startLon,
+                                                   startLat,
+                                                   targetLon,
+                                                   targetLat);
+      node.overallCost=node.currentCost+node.estimateCost;
+
+      AddBackwardRNode(node);
+    }
+
+    StopClock clock;
+    double    bestCosts=std::numeric_limits<double>::max();
+    size_t    bestForward=0;
+    size_t    bestBackward=0;
+    bool      success;
+
+    switch (openListType) {
+    case openListRadixHeap:
+      success=SearchRouteBidirectional(profile,
+                                       startLon,
+                                       startLat,
+                                       targetLon,
+                                       targetLat,
+                                       radixHeap,
+                                       backwardRadixHeap,
+                                       bestCosts,
+                                       bestForward,
+                                       bestBackward,
+                                       statistics);
+      break;
+    case openListHeap:
+    default:
+      success=SearchRouteBidirectional(profile,
+                                       startLon,
+                                       startLat,
+                                       targetLon,
+                                       targetLat,
+                                       heap,
+                                       backwardHeap,
+                                       bestCosts,
+                                       bestForward,
+                                       bestBackward,
+                                       statistics);
+      break;
+    }
+
+    clock.Stop();
+
+    if (!success) {
+      return false;
+    }
+
+    if (debugPerformance) {
+      std::cout << "From:                " << startObject.GetTypeName() << " " << startObject.GetFileOffset();
+      std::cout << "[";
+      if (startForwardRouteNode.Valid()) {
+        std::cout << startForwardRouteNode->GetId() << " - ";
+      }
+      std::cout << startNodeIndex;
+      if (startBackwardRouteNode.Valid()) {
+        std::cout << " - " << startBackwardRouteNode->GetId();
+      }
+      std::cout << "]" << std::endl;
+
+      std::cout << "To:                  " << targetObject.GetTypeName() <<  " " << targetObject.GetFileOffset();
+      std::cout << "[";
+      if (targetForwardRouteNode.Valid()) {
+        std::cout << targetForwardRouteNode->GetId() << " - ";
+      }
+      std::cout << targetNodeIndex;
+      if (targetBackwardRouteNode.Valid()) {
+        std::cout << " - " << targetBackwardRouteNode->GetId();
+      }
+      std::cout << "]" << std::endl;
+
+
+      std::cout << "Time:                " << clock << std::endl;
+
+      std::cout << "Route nodes loaded:  " << statistics.nodesLoadedCount << std::endl;
+      std::cout << "Route nodes ignored: " << statistics.nodesIgnoredCount << std::endl;
+      std::cout << "Max. OpenList size:  " << statistics.maxOpenList << std::endl;
+      std::cout << "RNode pool size:     " << rnodes.size()+backwardRNodes.size() << std::endl;
+    }
+
+    if (bestCosts==std::numeric_limits<double>::max()) {
+      std::cout << "No route found!" << std::endl;
+
+      return true;
+    }
+
+    std::list<RNode> nodes;
+
+    ResolveRNodeChainToList(bestForward,
+                            nodes);
+
+    // Append the path of the backward search, turning it around
+    size_t current=bestBackward;
+
+    while (backwardRNodes[current].prev!=0) {
+      RNodeMap::const_iterator next=backwardRNodeMap.find(backwardRNodes[current].prev);
+
+      assert(next!=backwardRNodeMap.end());
+
+      nodes.push_back(RNode(backwardRNodes[current].prev,
+                            backwardRNodes[current].object,
+                            backwardRNodes[current].nodeOffset));
+
+      current=next->second;
+    }
+
+    if (!ResolveRNodesToRouteData(profile,
+                                  nodes,
+                                  startObject,
+                                  startNodeIndex,
+                                  targetObject,
+                                  targetNodeIndex,
+                                  route)) {
+      return false;
+    }
+
+    ResolveRouteDataJunctions(route);
+
+    return true;
+  }
+
+  /**
+    Return the route nodes next to the given source or target position together
+    with the costs and the time between the position and the route node (see
+    GetStartNodes() and GetTargetNodes()).
+    */
+  bool Router::GetMatrixNodes(const RoutingProfile& profile,
+                              const RoutePosition& position,
+                              std::vector<MatrixNode>& nodes)
+  {
+    nodes.clear();
+
+    if (position.GetObject().GetType()!=refWay) {
+      // TODO: areas
+      std::cerr << "Only ways are supported as matrix source or target" << std::endl;
+      return false;
+    }
+
+    WayRef       way;
+    RouteNodeRef routeNodes[2];
+    size_t       routeNodePos[2];
+
+    if (!wayDataFile.GetByOffset(position.GetObject().GetFileOffset(),
+                                 way)) {
+      std::cerr << "Cannot get way of matrix position!" << std::endl;
+      return false;
+    }
+
+    if (position.GetNodeIndex()>=way->nodes.size()) {
+      std::cerr << "Given node index " << position.GetNodeIndex() << " is not within valid range [0," << way->nodes.size()-1 << std::endl;
+      return false;
+    }
+
+    GetClosestForwardRouteNode(way,
+                               position.GetNodeIndex(),
+                               routeNodes[0],
+                               routeNodePos[0]);
+    GetClosestBackwardRouteNode(way,
+                                position.GetNodeIndex(),
+                                routeNodes[1],
+                                routeNodePos[1]);
+
+    for (size_t i=0; i<2; i++) {
+      if (routeNodes[i].Invalid()) {
+        continue;
+      }
+
+      MatrixNode node;
+      double     distance=GetSphericalDistance(way->nodes[position.GetNodeIndex()].GetLon(),
+                                               way->nodes[position.GetNodeIndex()].GetLat(),
+                                               way->nodes[routeNodePos[i]].GetLon(),
+                                               way->nodes[routeNodePos[i]].GetLat());
+
+      if (!routeNodeDataFile.GetOffset(routeNodes[i]->GetId(),
+                                       node.offset)) {
+        std::cerr << "Cannot get offset of route node " << routeNodes[i]->GetId() << std::endl;
+        return false;
+      }
+
+      node.costs=profile.GetCosts(way,distance);
+      node.time=profile.GetTime(way,distance);
+
+      nodes.push_back(node);
+    }
+
+    if (nodes.empty()) {
+      std::cerr << "No route node found for way of matrix position" << std::endl;
+      return false;
+    }
+
+    return true;
+  }
+
+  /**
+    Return the route node at the given offset. Route nodes are shared by all
+    searches of a matrix calculation, as long as they fit into the cache of the
+    job (see RouterParameter::SetMatrixCacheSize()).
+    */
+  bool Router::GetMatrixRouteNode(MatrixJob& job,
+                                  FileOffset offset,
+                                  RouteNodeRef& routeNode)
+  {
+    if (job.routeNodes.GetEntry(offset,
+                                routeNode)) {
+      return true;
+    }
+
+    if (!routeNodeDataFile.GetByOffset(offset,
+                                       routeNode)) {
+      std::cerr << "Cannot load route node with id " << offset << std::endl;
+      return false;
+    }
+
+    job.routeNodes.SetEntry(offset,
+                            routeNode,
+                            routeNode->GetMemorySize());
+
+    return true;
+  }
+
+  /**
+    Dijkstra search from one source to all targets of the matrix. The costs of
+    a target are the costs of one of its route nodes plus the costs from this
+    route node to the target position. The cheapest costs found so far are kept
+    in the target list. A target is final as soon as the open list holds no
+    node cheaper than its costs, the search stops when all targets are final.
+
+    The pool, the heaps and the vector of times are owned by the calling thread and
+    reused for all its searches.
+    */
+  bool Router::SearchMatrixRow(MatrixJob& job,
+                               size_t source,
+                               std::vector<RNode>& nodes,
+                               RNodeMap& nodeMap,
+                               std::vector<double>& times,
+                               DAryHeap<4>& openList,
+                               DAryHeap<4>& targetList,
+                               RouteStatistics& statistics)
+  {
+    const RoutingProfile& profile=*job.profile;
+    std::vector<bool>     reached(job.targetCount,false);
+    std::vector<double>   targetCosts(job.targetCount,0.0);
+    std::vector<double>   targetTimes(job.targetCount,0.0);
+    size_t                remaining=job.targetCount;
+    RouteNodeRef          currentRouteNode;
+
+    nodes.clear();
+    nodeMap.clear();
+    times.clear();
+    openList.Clear();
+    targetList.Clear();
+
+    for (std::vector<MatrixNode>::const_iterator start=job.sources[source].begin();
+         start!=job.sources[source].end();
+         ++start) {
+      RNodeMap::const_iterator entry=nodeMap.find(start->offset);
+
+      if (entry!=nodeMap.end()) {
+        if (start->costs<nodes[entry->second].currentCost) {
+          nodes[entry->second].currentCost=start->costs;
+          times[entry->second]=start->time;
+          openList.Update(entry->second,start->costs);
+        }
+
+        continue;
+      }
+
+      RNode node(start->offset,
+                 ObjectFileRef());
+
+      node.currentCost=start->costs;
+      node.overallCost=start->costs;
+
+      nodeMap[node.nodeOffset]=nodes.size();
+      nodes.push_back(node);
+      times.push_back(start->time);
+
+      openList.Push(nodes.size()-1,node.overallCost);
+    }
+
+    while (!openList.IsEmpty() &&
+           remaining>0) {
+      // Targets not more expensive than the cheapest open node cannot get cheaper
+      while (!targetList.IsEmpty() &&
+             targetList.GetMinPriority()<=openList.GetMinPriority()) {
+        size_t target=targetList.Pop();
+
+        reached[target]=true;
+        remaining--;
+
+        job.matrix->Set(source,target,targetCosts[target],targetTimes[target]);
+      }
+
+      if (remaining==0) {
+        break;
+      }
+
+      size_t current=openList.Pop();
+
+      nodes[current].closed=true;
+
+      FileOffset    currentOffset=nodes[current].nodeOffset;
+      FileOffset    currentPrev=nodes[current].prev;
+      ObjectFileRef currentObject=nodes[current].object;
+      double        currentCurrentCost=nodes[current].currentCost;
+      double        currentTime=times[current];
+      bool          currentAccess=nodes[current].access;
+
+      MatrixTargetMap::const_iterator target=job.targets.find(currentOffset);
+
+      if (target!=job.targets.end()) {
+        for (std::vector<MatrixTarget>::const_iterator t=target->second.begin();
+             t!=target->second.end();
+             ++t) {
+          if (reached[t->target]) {
+            continue;
+          }
+
+          double costs=currentCurrentCost+t->costs;
+
+          if (targetList.Contains(t->target)) {
+            if (targetCosts[t->target]<=costs) {
+              continue;
+            }
+
+            targetList.Update(t->target,costs);
+          }
+          else {
+            targetList.Push(t->target,costs);
+          }
+
+          targetCosts[t->target]=costs;
+          targetTimes[t->target]=currentTime+t->time;
+        }
+      }
+
+      if (!GetMatrixRouteNode(job,
+                              currentOffset,
+                              currentRouteNode)) {
+        return false;
+      }
+
+      statistics.nodesLoadedCount++;
+
+      for (size_t i=0; i<currentRouteNode->paths.size(); i++) {
+        const RouteNode::Path& path=currentRouteNode->paths[i];
+
+        if (path.offset==currentPrev ||
+            (!currentAccess && path.HasAccess()) ||
+            !profile.CanUse(*currentRouteNode,i)) {
+          statistics.nodesIgnoredCount++;
+          continue;
+        }
+
+        RNodeMap::iterator entry=nodeMap.find(path.offset);
+
+        if (entry!=nodeMap.end() &&
+            nodes[entry->second].closed) {
+          continue;
+        }
+
+        bool canTurnedInto=true;
+        for (size_t e=0; e<currentRouteNode->excludes.size(); e++) {
+          if (currentRouteNode->excludes[e].source==currentObject &&
+              currentRouteNode->excludes[e].targetIndex==i) {
+            canTurnedInto=false;
+            break;
+          }
+        }
+
+        if (!canTurnedInto) {
+          statistics.nodesIgnoredCount++;
+          continue;
+        }
+
+        double currentCost=currentCurrentCost+
+                           profile.GetCosts(*currentRouteNode,i);
+
+        if (entry!=nodeMap.end() &&
+            nodes[entry->second].currentCost<=currentCost) {
+          continue;
+        }
+
+        double time=currentTime+
+                    profile.GetTime(*currentRouteNode,i);
+
+        if (entry!=nodeMap.end()) {
+          RNode& node=nodes[entry->second];
+
+          node.prev=currentOffset;
+          node.object=currentRouteNode->objects[path.objectIndex];
+          node.currentCost=currentCost;
+          node.overallCost=currentCost;
+          node.access=path.HasAccess();
+
+          times[entry->second]=time;
+
+          openList.Update(entry->second,currentCost);
+        }
+        else {
+          RNode node(path.offset,
+                     currentRouteNode->objects[path.objectIndex],
+                     currentOffset);
+
+          node.currentCost=currentCost;
+          node.overallCost=currentCost;
+          node.access=path.HasAccess();
+
+          nodeMap[node.nodeOffset]=nodes.size();
+          nodes.push_back(node);
+          times.push_back(time);
+
+          openList.Push(nodes.size()-1,currentCost);
+        }
+      }
+
+      statistics.maxOpenList=std::max(statistics.maxOpenList,openList.GetSize());
+    }
+
+    // Nothing left in the open list, that could make the remaining targets cheaper
+    while (!targetList.IsEmpty()) {
+      size_t target=targetList.Pop();
+
+      job.matrix->Set(source,target,targetCosts[target],targetTimes[target]);
+    }
+
+    return true;
+  }
+
+  /**
+    Worker for CalculateMatrix(): Take the next source from the job and calculate
+    its row of the matrix until all rows are done.
+    */
+  void Router::CalculateMatrixRows(MatrixJob& job)
+  {
+    std::vector<RNode>  nodes;
+    RNodeMap            nodeMap;
+    std::vector<double> times;
+    DAryHeap<4>         openList;
+    DAryHeap<4>         targetList;
+    RouteStatistics     statistics;
+
+    while (true) {
+      size_t source;
+
+      {
+        MutexLocker locker(job.mutex);
+
+        if (!job.success ||
+            job.nextSource>=job.sources.size()) {
+          break;
+        }
+
+        source=job.nextSource;
+        job.nextSource++;
+      }
+
+      if (!SearchMatrixRow(job,
+                           source,
+                           nodes,
+                           nodeMap,
+                           times,
+                           openList,
+                           targetList,
+                           statistics)) {
+        MutexLocker locker(job.mutex);
+
+        job.success=false;
+      }
+    }
+
+    MutexLocker locker(job.mutex);
+
+    job.statistics.nodesLoadedCount+=statistics.nodesLoadedCount;
+    job.statistics.nodesIgnoredCount+=statistics.nodesIgnoredCount;
+    job.statistics.maxOpenList=std::max(job.statistics.maxOpenList,statistics.maxOpenList);
+  }
+
+  /**
+    Calculate the costs and the time from each source to each target.
+
+    Instead of a route calculation for each pair, a single search from each source
+    is done, which stops as soon as all targets are reached. Route nodes are shared
+    by all searches by means of a cache of limited size. The sources are distributed over the given number
+    of threads (if the library has been built with thread support).
+
+    As for CalculateRoute() the costs and the time start at the source position and
+    end at the target position, including the costs and the time between the
+    positions and their nearest route nodes. Targets that cannot be reached are
+    marked as such in the matrix.
+    */
+  bool Router::CalculateMatrix(const RoutingProfile& profile,
+                               const std::vector<RoutePosition>& sources,
+                               const std::vector<RoutePosition>& targets,
+                               RouteMatrix& matrix,
+                               size_t threadCount)
+  {
+    MatrixJob job(matrixCacheSize);
+
+    matrix.Initialize(sources.size(),
+                      targets.size());
+
+    job.profile=&profile;
+    job.targetCount=targets.size();
+    job.matrix=&matrix;
+    job.nextSource=0;
+    job.success=true;
+
+    job.sources.resize(sources.size());
+
+    for (size_t s=0; s<sources.size(); s++) {
+      if (!GetMatrixNodes(profile,
+                          sources[s],
+                          job.sources[s])) {
+        return false;
+      }
+    }
+
+    for (size_t t=0; t<targets.size(); t++) {
+      std::vector<MatrixNode> targetNodes;
+
+      if (!GetMatrixNodes(profile,
+                          targets[t],
+                          targetNodes)) {
+        return false;
+      }
+
+      for (std::vector<MatrixNode>::const_iterator node=targetNodes.begin();
+           node!=targetNodes.end();
+           ++node) {
+        std::vector<MatrixTarget>& entry=job.targets[node->offset];
+        bool                       found=false;
+
+        // Both route nodes next to a target may be the same, keep the cheaper one
+        for (std::vector<MatrixTarget>::iterator target=entry.begin();
+             target!=entry.end();
+             ++target) {
+          if (target->target==t) {
+            if (node->costs<target->costs) {
+              target->costs=node->costs;
+              target->time=node->time;
+            }
+
+            found=true;
+            break;
+          }
+        }
+
+        if (!found) {
+          MatrixTarget target;
+
+          target.target=t;
+          target.costs=node->costs;
+          target.time=node->time;
+
+          entry.push_back(target);
+        }
+      }
+    }
+
+    StopClock clock;
+
+#if defined(OSMSCOUT_HAVE_THREAD)
+    threadCount=std::max((size_t)1,std::min(threadCount,sources.size()));
+
+    std::vector<std::thread> threads;
+
+    for (size_t i=1; i<threadCount; i++) {
+      threads.push_back(std::thread(&Router::CalculateMatrixRows,
+                                    this,
+                                    std::ref(job)));
+    }
+
+    CalculateMatrixRows(job);
+
+    for (size_t i=0; i<threads.size(); i++) {
+      threads[i].join();
+    }
+#else
+    CalculateMatrixRows(job);
+#endif
+
+    clock.Stop();
+
+    if (debugPerformance) {
+      std::cout << "Matrix:              " << sources.size() << "x" << targets.size() << std::endl;
+      std::cout << "Time:                " << clock << std::endl;
+      std::cout << "Route nodes loaded:  " << job.statistics.nodesLoadedCount << std::endl;
+      std::cout << "Route nodes ignored: " << job.statistics.nodesIgnoredCount << std::endl;
+      std::cout << "Max. OpenList size:  " << job.statistics.maxOpenList << std::endl;
+    }
+
+    return job.success;
+  }
+
+  bool Router::HasContractionHierarchy() const
+  {
+    return !ch.IsEmpty();
+  }
+
+  void Router::ResetCHSearch(CHSearch& search)
+  {
+    for (std::vector<uint32_t>::const_iterator node=search.touched.begin();
+         node!=search.touched.end();
+         ++node) {
+      search.costs[*node]=noCosts;
+      search.prev[*node]=ContractionHierarchy::noNode;
+    }
+
+    search.touched.clear();
+    search.heap.Clear();
+  }
+
+  void Router::AddCHOrigin(CHSearch& search,
+                           uint32_t node,
+                           uint64_t costs)
+  {
+    if (search.costs[node]==noCosts) {
+      search.costs[node]=costs;
+      search.touched.push_back(node);
+      search.heap.Push(node,(double)costs);
+    }
+    else if (costs<search.costs[node]) {
+      search.costs[node]=costs;
+      search.heap.Update(node,(double)costs);
+    }
+  }
+
+  /**
+    "Stall-on-demand": A node is reached with non-optimal costs, if a node of
+    a higher level that has already been reached has a cheaper edge down to
+    this node. Such a node does not need to be expanded.
+    */
+  bool Router::IsCHNodeStalled(const CHSearch& search,
+                               uint32_t node,
+                               bool forward) const
+  {
+    std::vector<ContractionHierarchy::Edge>::const_iterator begin=forward ? ch.GetBackwardEdgesBegin(node) : ch.GetForwardEdgesBegin(node);
+    std::vector<ContractionHierarchy::Edge>::const_iterator end=forward ? ch.GetBackwardEdgesEnd(node) : ch.GetForwardEdgesEnd(node);
+
+    for (std::vector<ContractionHierarchy::Edge>::const_iterator edge=begin;
+         edge!=end;
+         ++edge) {
+      if (search.costs[edge->target]!=noCosts &&
+          search.costs[edge->target]+edge->costs<search.costs[node]) {
+        return true;
+      }
+    }
+
+    return false;
+  }
+
+  /**
+    Take the cheapest node from the open list of the given search, check if it
+    results in a better connection to the other search and expand it.
+    */
+  void Router::SettleCHNode(CHSearch& search,
+                            const CHSearch& otherSearch,
+                            bool forward,
+                            uint64_t& bestCosts,
+                            uint32_t& meetingNode,
+                            RouteStatistics& statistics)
+  {
+    uint32_t node=(uint32_t)search.heap.Pop();
+    uint64_t costs=search.costs[node];
+
+    statistics.nodesLoadedCount++;
+
+    if (otherSearch.costs[node]!=noCosts &&
+        costs+otherSearch.costs[node]<bestCosts) {
+      bestCosts=costs+otherSearch.costs[node];
+      meetingNode=node;
+    }
+
+    if (IsCHNodeStalled(search,node,forward)) {
+      statistics.nodesIgnoredCount++;
+      return;
+    }
+
+    std::vector<ContractionHierarchy::Edge>::const_iterator begin=forward ? ch.GetForwardEdgesBegin(node) : ch.GetBackwardEdgesBegin(node);
+    std::vector<ContractionHierarchy::Edge>::const_iterator end=forward ? ch.GetForwardEdgesEnd(node) : ch.GetBackwardEdgesEnd(node);
+
+    for (std::vector<ContractionHierarchy::Edge>::const_iterator edge=begin;
+         edge!=end;
+         ++edge) {
+      uint64_t targetCosts=costs+edge->costs;
+
+      if (search.costs[edge->target]==noCosts) {
+        search.costs[edge->target]=targetCosts;
+        search.prev[edge->target]=node;
+        search.touched.push_back(edge->target);
+        search.heap.Push(edge->target,(double)targetCosts);
+      }
+      else if (targetCosts<search.costs[edge->target] &&
+               search.heap.Contains(edge->target)) {
+        search.costs[edge->target]=targetCosts;
+        search.prev[edge->target]=node;
+        search.heap.Update(edge->target,(double)targetCosts);
+      }
+    }
+
+    statistics.maxOpenList=std::max(statistics.maxOpenList,search.heap.GetSize());
+  }
+
+  /**
+    Return the cheapest edge of the contraction hierarchy leading from node 'from'
+    to node 'to'. If forward is true, the edge is a forward edge of 'from', else
+    a backward edge of 'to'.
+    */
+  bool Router::GetCHEdge(uint32_t from,
+                         uint32_t to,
+                         bool forward,
+                         ContractionHierarchy::Edge& edge) const
+  {
+    std::vector<ContractionHierarchy::Edge>::const_iterator begin=forward ? ch.GetForwardEdgesBegin(from) : ch.GetBackwardEdgesBegin(to);
+    std::vector<ContractionHierarchy::Edge>::const_iterator end=forward ? ch.GetForwardEdgesEnd(from) : ch.GetBackwardEdgesEnd(to);
+    uint32_t                                                other=forward ? to : from;
+    bool                                                    found=false;
+
+    for (std::vector<ContractionHierarchy::Edge>::const_iterator e=begin;
+         e!=end;
+         ++e) {
+      if (e->target==other &&
+          (!found || e->costs<edge.costs)) {
+        edge=*e;
+        found=true;
+      }
+    }
+
+    return found;
+  }
+
+  /**
+    Recursively replace the given edge of the contraction hierarchy by the original
+    paths of the routing graph and append a RNode for each path to the list.
+    */
+  bool Router::UnpackCHEdge(uint32_t from,
+                            uint32_t to,
+                            const ContractionHierarchy::Edge& edge,
+                            std::list<RNode>& nodes)
+  {
+    if (edge.IsShortcut()) {
+      ContractionHierarchy::Edge first;
+      ContractionHierarchy::Edge second;
+
+      // The middle node has a lower level than both ends
+      if (!GetCHEdge(from,edge.middle,false,first) ||
+          !GetCHEdge(edge.middle,to,true,second)) {
+        std::cerr << "Cannot unpack shortcut over node " << edge.middle << std::endl;
+        return false;
+      }
+
+      return UnpackCHEdge(from,edge.middle,first,nodes) &&
+             UnpackCHEdge(edge.middle,to,second,nodes);
+    }
+
+    RouteNodeRef routeNode;
+
+    if (!routeNodeDataFile.GetByOffset(ch.GetNodeOffset(from),
+                                       routeNode)) {
+      std::cerr << "Cannot load route node with offset " << ch.GetNodeOffset(from) << std::endl;
+      return false;
+    }
+
+    if (edge.pathIndex>=routeNode->paths.size()) {
+      std::cerr << "Path index " << edge.pathIndex << " of route node " << routeNode->GetId() << " is not valid" << std::endl;
+      return false;
+    }
+
+    nodes.push_back(RNode(ch.GetNodeOffset(to),
+                          routeNode->objects[routeNode->paths[edge.pathIndex].objectIndex],
+                          ch.GetNodeOffset(from)));
+
+    return true;
+  }
+
+  /**
+    Calculate a route using the contraction hierarchy generated during import
+    (see HasContractionHierarchy()).
+
+    The costs are taken from the contraction hierarchy and thus from the routing
+    profile used during import, the given profile is only used for the costs
+    between the start and target positions and their nearest route nodes and
+    for the conversion of the result into RouteData. Turn restrictions are not respected.
+
+    If the given profile differs from the profile used during import (another
+    profile type, vehicle or speed table), the route is calculated by
+    CalculateRoute() instead.
+    */
+  bool Router::CalculateRouteCH(const RoutingProfile& profile,
+                                const ObjectFileRef& startObject,
+                                size_t startNodeIndex,
+                                const ObjectFileRef& targetObject,
+                                size_t targetNodeIndex,
+                                RouteData& route)
+  {
+    RouteNodeRef    startForwardRouteNode;
+    RouteNodeRef    startBackwardRouteNode;
+    RNode           startForwardNode;
+    RNode           startBackwardNode;
+
+    double          startLon=0.0L,startLat=0.0L;
+    double          targetLon=0.0L,targetLat=0.0L;
+
+    RouteNodeRef    targetForwardRouteNode;
+    RouteNodeRef    targetBackwardRouteNode;
+    double          targetForwardCosts=0.0;
+    double          targetBackwardCosts=0.0;
+
+    RouteStatistics statistics;
+    uint32_t        node;
+
+    route.Clear();
+
+    if (ch.IsEmpty()) {
+      std::cerr << "No contraction hierarchy available!" << std::endl;
+      return false;
+    }
+
+    if (!ch.IsCompatible(profile)) {
+      std::cerr << "Contraction hierarchy was generated for another routing profile, falling back to A*" << std::endl;
+
+      return CalculateRoute(profile,
+                            startObject,
+                            startNodeIndex,
+                            targetObject,
+                            targetNodeIndex,
+                            route);
+    }
+
+    if (!GetTargetNodes(profile,
+                        targetObject,
+                        targetNodeIndex,
+                        targetLon,
+                        targetLat,
+                        targetForwardRouteNode,
+                        targetBackwardRouteNode,
+                        targetForwardCosts,
+                        targetBackwardCosts)) {
+      return false;
+    }
+
+    if (!GetStartNodes(profile,
+                       startObject,
+                       startNodeIndex,
+                       startLon,
+                       startLat,
+                       targetLon,
+                       targetLat,
+                       startForwardRouteNode,
+                       startBackwardRouteNode,
+                       startForwardNode,
+                       startBackwardNode)) {
+      return false;
+    }
+
+    ResetCHSearch(chForward);
+    ResetCHSearch(chBackward);
+
+    if (startForwardRouteNode.Valid() &&
+        ch.GetNodeIndex(startForwardNode.nodeOffset,node)) {
+      AddCHOrigin(chForward,
+                  node,
+                  (uint64_t)(startForwardNode.currentCost*ch.GetCostScale()+0.5));
+    }
+
+    if (startBackwardRouteNode.Valid() &&
+        ch.GetNodeIndex(startBackwardNode.nodeOffset,node)) {
+      AddCHOrigin(chForward,
+                  node,
+                  (uint64_t)(startBackwardNode.currentCost*ch.GetCostScale()+0.5));
+    }
+
+    // The backward search starts with the costs from the target route nodes
+    // to the target position, else it prefers target route nodes that are
+    // cheap to reach but far away from the target
+    if (targetForwardRouteNode.Valid() &&
+        ch.GetNodeIndex(targetForwardRouteNode->GetFileOffset(),node)) {
+      AddCHOrigin(chBackward,
+                  node,
+                  (uint64_t)(targetForwardCosts*ch.GetCostScale()+0.5));
+    }
+
+    if (targetBackwardRouteNode.Valid() &&
+        ch.GetNodeIndex(targetBackwardRouteNode->GetFileOffset(),node)) {
+      AddCHOrigin(chBackward,
+                  node,
+                  (uint64_t)(targetBackwardCosts*ch.GetCostScale()+0.5));
+    }
+
+    StopClock clock;
+    uint64_t  bestCosts=noCosts;
+    uint32_t  meetingNode=ContractionHierarchy::noNode;
+    bool      forward=true;
+
+    // Both searches only go upwards in the hierarchy, a search can be stopped
+    // as soon as its cheapest open node is not cheaper than the best connection found
+    while (true) {
+      bool forwardActive=!chForward.heap.IsEmpty() &&
+                         chForward.heap.GetMinPriority()<(double)bestCosts;
+      bool backwardActive=!chBackward.heap.IsEmpty() &&
+                          chBackward.heap.GetMinPriority()<(double)bestCosts;
+
+      if (!forwardActive && !backwardActive) {
+        break;
+      }
+
+      if ((forward && forwardActive) || !backwardActive) {
+        SettleCHNode(chForward,chBackward,true,bestCosts,meetingNode,statistics);
+      }
+      else {
+        SettleCHNode(chBackward,chForward,false,bestCosts,meetingNode,statistics);
+      }
+
+      forward=!forward;
+    }
+
+    clock.Stop();
+
+    if (debugPerformance) {
+      std::cout << "From:                " << startObject.GetTypeName() << " " << startObject.GetFileOffset();
+      std::cout << "[";
+      if (startForwardRouteNode.Valid()) {
+        std::cout << startForwardRouteNode->GetId() << " - ";
+      }
+      std::cout << startNodeIndex;
+      if (startBackwardRouteNode.Valid()) {
+        std::cout << " - " << startBackwardRouteNode->GetId();
+      }
+      std::cout << "]" << std::endl;
+
+      std::cout << "To:                  " << targetObject.GetTypeName() <<  " " << targetObject.GetFileOffset();
+      std::cout << "[";
+      if (targetForwardRouteNode.Valid()) {
+        std::cout << targetForwardRouteNode->GetId() << " - ";
+      }
+      std::cout << targetNodeIndex;
+      if (targetBackwardRouteNode.Valid()) {
+        std::cout << " - " << targetBackwardRouteNode->GetId();
+      }
+      std::cout << "]" << std::endl;
+
+
+      std::cout << "Time:                " << clock << std::endl;
+
+      std::cout << "Route nodes settled: " << statistics.nodesLoadedCount << std::endl;
+      std::cout << "Route nodes stalled: " << statistics.nodesIgnoredCount << std::endl;
+      std::cout << "Max. OpenList size:  " << statistics.maxOpenList << std::endl;
+    }
+
+    if (meetingNode==ContractionHierarchy::noNode) {
+      std::cout << "No route found!" << std::endl;
+
+      return true;
+    }
+
+    // Collect the nodes of the upward path from the start and the downward path to the target
+    std::vector<uint32_t> path;
+
+    for (node=meetingNode;
+         node!=ContractionHierarchy::noNode;
+         node=chForward.prev[node]) {
+      path.push_back(node);
+    }
+
+    std::reverse(path.begin(),path.end());
+
+    size_t meetingIndex=path.size()-1;
+
+    for (node=chBackward.prev[meetingNode];
+         node!=ContractionHierarchy::noNode;
+         node=chBackward.prev[node]) {
+      path.push_back(node);
+    }
+
+    std::list<RNode> nodes;
+
+    nodes.push_back(RNode(ch.GetNodeOffset(path.front()),
+                          startObject));
+
+    for (size_t i=0; i+1<path.size(); i++) {
+      ContractionHierarchy::Edge edge;
+
+      if (!GetCHEdge(path[i],path[i+1],i<meetingIndex,edge) ||
+          !UnpackCHEdge(path[i],path[i+1],edge,nodes)) {
+        std::cerr << "Cannot resolve route in contraction hierarchy" << std::endl;
+        return false;
+      }
+    }
+
+    if (!ResolveRNodesToRouteData(profile,
+                                  nodes,
+                                  startObject,
+                                  startNodeIndex,
+                                  targetObject,
+                                  targetNodeIndex,
+                                  route)) {
+      return false;
+    }
+
+    ResolveRouteDataJunctions(route);
+
+    return true;
+  }
+
   bool Router::TransformRouteDataToWay(const RouteData& data,
                                        Way& way)
   {
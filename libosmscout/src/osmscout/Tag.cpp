@@ -21,4 +21,94 @@
 
 namespace osmscout {
 
+  /**
+    Return the tag with the given id or NULL, if the object does not have
+    the tag.
+    */
+  const TagRef* TagView::Find(TagId key) const
+  {
+    const TagRef* first=tagsBegin;
+    const TagRef* last=tagsEnd;
+
+    while (first<last) {
+      const TagRef* middle=first+(last-first)/2;
+
+      if (middle->key<key) {
+        first=middle+1;
+      }
+      else {
+        last=middle;
+      }
+    }
+
+    if (first!=tagsEnd &&
+        first->key==key) {
+      return first;
+    }
+
+    return NULL;
+  }
+
+  void TagBuffer::AddTag(TagId key,
+                         const char* value,
+                         size_t length)
+  {
+    TagRef tag;
+
+    tag.key=key;
+    tag.value=value;
+    tag.length=length;
+
+    tags.push_back(tag);
+  }
+
+  /**
+    Sort the tags added since start by tag id. If a tag id was added
+    multiple times, the value added last is kept. Returns the new end of
+    the tags of the object.
+    */
+  size_t TagBuffer::SortTags(size_t start)
+  {
+    // Objects only have a few tags, so we use a stable insertion sort
+    for (size_t i=start+1; i<tags.size(); i++) {
+      TagRef tag=tags[i];
+      size_t j=i;
+
+      while (j>start &&
+             tags[j-1].key>tag.key) {
+        tags[j]=tags[j-1];
+        j--;
+      }
+
+      tags[j]=tag;
+    }
+
+    size_t end=start;
+
+    for (size_t i=start; i<tags.size(); i++) {
+      if (end>start &&
+          tags[end-1].key==tags[i].key) {
+        tags[end-1]=tags[i];
+      }
+      else {
+        tags[end]=tags[i];
+        end++;
+      }
+    }
+
+    tags.resize(end);
+
+    return end;
+  }
+
+  TagView TagBuffer::GetView(size_t start,
+                             size_t end) const
+  {
+    if (start>=end) {
+      return TagView();
+    }
+
+    return TagView(&tags[0]+start,
+                   &tags[0]+end);
+  }
 }
@@ -0,0 +1,330 @@
+/*
+  This source is part of the libosmscout library
+  Copyright (C) 2013  Tim Teulings
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+#include <osmscout/TiledObjects.h>
+
+#include <algorithm>
+#include <limits>
+
+#include <osmscout/system/Assert.h>
+#include <osmscout/system/Math.h>
+
+namespace osmscout {
+
+  /**
+    Maximum latitude of the slippy map tiles
+    */
+  static const double maxTileLat=85.0511;
+
+  static void GetAreaBoundingBox(const Area& area,
+                                 double& minLon,
+                                 double& maxLon,
+                                 double& minLat,
+                                 double& maxLat)
+  {
+    minLon=std::numeric_limits<double>::max();
+    maxLon=-std::numeric_limits<double>::max();
+    minLat=std::numeric_limits<double>::max();
+    maxLat=-std::numeric_limits<double>::max();
+
+    for (std::vector<Area::Ring>::const_iterator ring=area.rings.begin();
+         ring!=area.rings.end();
+         ++ring) {
+      for (std::vector<GeoCoord>::const_iterator node=ring->nodes.begin();
+           node!=ring->nodes.end();
+           ++node) {
+        minLon=std::min(minLon,node->GetLon());
+        maxLon=std::max(maxLon,node->GetLon());
+        minLat=std::min(minLat,node->GetLat());
+        maxLat=std::max(maxLat,node->GetLat());
+      }
+    }
+  }
+
+  TiledObjects::TiledObjects()
+  : zoom(0),
+    xStart(0),
+    yStart(0),
+    xCount(0),
+    yCount(0)
+  {
+    // no code
+  }
+
+  void TiledObjects::Clear()
+  {
+    zoom=0;
+    xStart=0;
+    yStart=0;
+    xCount=0;
+    yCount=0;
+
+    nodes.clear();
+    ways.clear();
+    areas.clear();
+
+    nodeBuckets.start.clear();
+    nodeBuckets.entries.clear();
+    wayBuckets.start.clear();
+    wayBuckets.entries.clear();
+    areaBuckets.start.clear();
+    areaBuckets.entries.clear();
+  }
+
+  /**
+    Calculate the range of tiles within the block for the given bounding box,
+    extended by border tiles in each direction. Returns false, if the range
+    is empty.
+    */
+  bool TiledObjects::GetTileRange(double minLon,
+                                  double maxLon,
+                                  double minLat,
+                                  double maxLat,
+                                  size_t border,
+                                  TileRange& range) const
+  {
+    if (minLon>maxLon ||
+        minLat>maxLat) {
+      return false;
+    }
+
+    size_t maxTile=(size_t)pow(2.0,(double)zoom)-1;
+
+    minLon=std::max(-180.0,std::min(180.0,minLon));
+    maxLon=std::max(-180.0,std::min(180.0,maxLon));
+    minLat=std::max(-maxTileLat,std::min(maxTileLat,minLat));
+    maxLat=std::max(-maxTileLat,std::min(maxTileLat,maxLat));
+
+    size_t minX=std::min(GetTileX(minLon,zoom),maxTile);
+    size_t maxX=std::min(GetTileX(maxLon,zoom),maxTile);
+    size_t minY=std::min(GetTileY(maxLat,zoom),maxTile);
+    size_t maxY=std::min(GetTileY(minLat,zoom),maxTile);
+
+    minX=minX>=border ? minX-border : 0;
+    minY=minY>=border ? minY-border : 0;
+    maxX+=border;
+    maxY+=border;
+
+    if (maxX<xStart ||
+        maxY<yStart ||
+        minX>=xStart+xCount ||
+        minY>=yStart+yCount) {
+      return false;
+    }
+
+    range.xStart=std::max(minX,xStart);
+    range.yStart=std::max(minY,yStart);
+    range.xEnd=std::min(maxX,xStart+xCount-1);
+    range.yEnd=std::min(maxY,yStart+yCount-1);
+
+    return true;
+  }
+
+  /**
+    Assign each object to the tiles of its range. The entries of a tile are
+    in the order of the objects.
+    */
+  void TiledObjects::FillBuckets(const std::vector<TileRange>& ranges,
+                                 const std::vector<bool>& valid,
+                                 Buckets& buckets) const
+  {
+    buckets.start.assign(xCount*yCount+1,0);
+
+    // Count the entries of each tile
+    for (size_t i=0; i<ranges.size(); i++) {
+      if (!valid[i]) {
+        continue;
+      }
+
+      for (size_t y=ranges[i].yStart; y<=ranges[i].yEnd; y++) {
+        for (size_t x=ranges[i].xStart; x<=ranges[i].xEnd; x++) {
+          buckets.start[(y-yStart)*xCount+(x-xStart)+1]++;
+        }
+      }
+    }
+
+    for (size_t t=1; t<buckets.start.size(); t++) {
+      buckets.start[t]+=buckets.start[t-1];
+    }
+
+    std::vector<uint32_t> next(buckets.start.begin(),buckets.start.end()-1);
+
+    buckets.entries.resize(buckets.start.back());
+
+    for (size_t i=0; i<ranges.size(); i++) {
+      if (!valid[i]) {
+        continue;
+      }
+
+      for (size_t y=ranges[i].yStart; y<=ranges[i].yEnd; y++) {
+        for (size_t x=ranges[i].xStart; x<=ranges[i].xEnd; x++) {
+          size_t tile=(y-yStart)*xCount+(x-xStart);
+
+          buckets.entries[next[tile]]=(uint32_t)i;
+          next[tile]++;
+        }
+      }
+    }
+  }
+
+  /**
+    Take over the given objects (the vectors are swapped and thus empty
+    afterwards) and assign them to the tiles xStart...xEnd, yStart...yEnd of
+    the given zoom level.
+    */
+  void TiledObjects::Set(size_t zoom,
+                         size_t xStart,
+                         size_t yStart,
+                         size_t xEnd,
+                         size_t yEnd,
+                         std::vector<NodeRef>& nodes,
+                         std::vector<WayRef>& ways,
+                         std::vector<AreaRef>& areas)
+  {
+    assert(xStart<=xEnd);
+    assert(yStart<=yEnd);
+
+    Clear();
+
+    this->zoom=zoom;
+    this->xStart=xStart;
+    this->yStart=yStart;
+    this->xCount=xEnd-xStart+1;
+    this->yCount=yEnd-yStart+1;
+
+    this->nodes.swap(nodes);
+    this->ways.swap(ways);
+    this->areas.swap(areas);
+
+    std::vector<TileRange> ranges;
+    std::vector<bool>      valid;
+
+    ranges.resize(this->nodes.size());
+    valid.resize(this->nodes.size());
+
+    for (size_t i=0; i<this->nodes.size(); i++) {
+      const NodeRef& node=this->nodes[i];
+
+      valid[i]=GetTileRange(node->GetLon(),
+                            node->GetLon(),
+                            node->GetLat(),
+                            node->GetLat(),
+                            1,
+                            ranges[i]);
+    }
+
+    FillBuckets(ranges,valid,nodeBuckets);
+
+    ranges.resize(this->ways.size());
+    valid.resize(this->ways.size());
+
+    for (size_t i=0; i<this->ways.size(); i++) {
+      double minLon,maxLon,minLat,maxLat;
+
+      this->ways[i]->GetBoundingBox(minLon,maxLon,minLat,maxLat);
+
+      valid[i]=GetTileRange(minLon,
+                            maxLon,
+                            minLat,
+                            maxLat,
+                            0,
+                            ranges[i]);
+    }
+
+    FillBuckets(ranges,valid,wayBuckets);
+
+    ranges.resize(this->areas.size());
+    valid.resize(this->areas.size());
+
+    for (size_t i=0; i<this->areas.size(); i++) {
+      double minLon,maxLon,minLat,maxLat;
+
+      GetAreaBoundingBox(*this->areas[i],minLon,maxLon,minLat,maxLat);
+
+      valid[i]=GetTileRange(minLon,
+                            maxLon,
+                            minLat,
+                            maxLat,
+                            1,
+                            ranges[i]);
+    }
+
+    FillBuckets(ranges,valid,areaBuckets);
+  }
+
+  /**
+    Return the objects of the given tile. The tile must be within the block.
+    */
+  void TiledObjects::GetTileObjects(size_t x,
+                                    size_t y,
+                                    std::vector<NodeRef>& nodes,
+                                    std::vector<WayRef>& ways,
+                                    std::vector<AreaRef>& areas) const
+  {
+    assert(IsInRange(x,y));
+
+    size_t tile=(y-yStart)*xCount+(x-xStart);
+
+    nodes.clear();
+    ways.clear();
+    areas.clear();
+
+    nodes.reserve(nodeBuckets.start[tile+1]-nodeBuckets.start[tile]);
+    ways.reserve(wayBuckets.start[tile+1]-wayBuckets.start[tile]);
+    areas.reserve(areaBuckets.start[tile+1]-areaBuckets.start[tile]);
+
+    for (uint32_t i=nodeBuckets.start[tile]; i<nodeBuckets.start[tile+1]; i++) {
+      nodes.push_back(this->nodes[nodeBuckets.entries[i]]);
+    }
+
+    for (uint32_t i=wayBuckets.start[tile]; i<wayBuckets.start[tile+1]; i++) {
+      ways.push_back(this->ways[wayBuckets.entries[i]]);
+    }
+
+    for (uint32_t i=areaBuckets.start[tile]; i<areaBuckets.start[tile+1]; i++) {
+      areas.push_back(this->areas[areaBuckets.entries[i]]);
+    }
+  }
+
+  size_t TiledObjects::GetTileX(double lon,
+                                size_t zoom)
+  {
+    return (size_t)(floor((lon + 180.0) / 360.0 *pow(2.0,(double)zoom)));
+  }
+
+  size_t TiledObjects::GetTileY(double lat,
+                                size_t zoom)
+  {
+    return (size_t)(floor((1.0 - log( tan(lat * M_PI/180.0) + 1.0 / cos(lat * M_PI/180.0)) / M_PI) / 2.0 * pow(2.0,(double)zoom)));
+  }
+
+  double TiledObjects::GetTileLon(size_t x,
+                                  size_t zoom)
+  {
+    return x / pow(2.0,(double)zoom) * 360.0 - 180;
+  }
+
+  double TiledObjects::GetTileLat(size_t y,
+                                  size_t zoom)
+  {
+    double n = M_PI - 2.0 * M_PI * y / pow(2.0,(double)zoom);
+
+    return 180.0 / M_PI * atan(0.5 * (exp(n) - exp(-n)));
+  }
+}
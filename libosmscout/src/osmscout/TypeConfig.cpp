@@ -19,6 +19,9 @@
 
 #include <osmscout/TypeConfig.h>
 
+#include <algorithm>
+#include <cstring>
+
 #include <osmscout/system/Assert.h>
 
 #include <iostream>
@@ -35,9 +38,9 @@ namespace osmscout {
     // no code
   }
 
-  bool TagNotCondition::Evaluate(const std::map<TagId,std::string>& tagMap) const
+  bool TagNotCondition::Evaluate(const TagView& tags) const
   {
-    return !condition->Evaluate(tagMap);
+    return !condition->Evaluate(tags);
   }
 
   TagBoolCondition::TagBoolCondition(Type type)
@@ -51,14 +54,14 @@ namespace osmscout {
     conditions.push_back(condition);
   }
 
-  bool TagBoolCondition::Evaluate(const std::map<TagId,std::string>& tagMap) const
+  bool TagBoolCondition::Evaluate(const TagView& tags) const
   {
     switch (type) {
     case boolAnd:
       for (std::list<TagConditionRef>::const_iterator condition=conditions.begin();
            condition!=conditions.end();
            ++condition) {
-        if (!(*condition)->Evaluate(tagMap)) {
+        if (!(*condition)->Evaluate(tags)) {
           return false;
         }
       }
@@ -68,7 +71,7 @@ namespace osmscout {
       for (std::list<TagConditionRef>::const_iterator condition=conditions.begin();
            condition!=conditions.end();
            ++condition) {
-        if ((*condition)->Evaluate(tagMap)) {
+        if ((*condition)->Evaluate(tags)) {
           return true;
         }
       }
@@ -87,9 +90,9 @@ namespace osmscout {
     // no code
   }
 
-  bool TagExistsCondition::Evaluate(const std::map<TagId,std::string>& tagMap) const
+  bool TagExistsCondition::Evaluate(const TagView& tags) const
   {
-    return tagMap.find(tag)!=tagMap.end();
+    return tags.Find(tag)!=NULL;
   }
 
   TagBinaryCondition::TagBinaryCondition(TagId tag,
@@ -102,23 +105,21 @@ namespace osmscout {
     // no code
   }
 
-  bool TagBinaryCondition::Evaluate(const std::map<TagId,std::string>& tagMap) const
+  bool TagBinaryCondition::Evaluate(const TagView& tags) const
   {
-    std::map<TagId,std::string>::const_iterator t;
-
-    t=tagMap.find(tag);
+    const TagRef* t=tags.Find(tag);
 
     switch (binaryOperator) {
     case  operatorEqual:
-      if (t==tagMap.end()) {
+      if (t==NULL) {
         return false;
       }
-      return t->second==tagValue;
+      return *t==tagValue;
     case operatorNotEqual:
-      if (t==tagMap.end()) {
+      if (t==NULL) {
         return true;
       }
-      return t->second!=tagValue;
+      return *t!=tagValue;
     default:
       assert(false);
 
@@ -134,20 +135,68 @@ namespace osmscout {
 
   void TagIsInCondition::AddTagValue(const std::string& tagValue)
   {
-    tagValues.insert(tagValue);
+    std::vector<std::string>::iterator pos=std::lower_bound(tagValues.begin(),
+                                                            tagValues.end(),
+                                                            tagValue);
+
+    if (pos==tagValues.end() ||
+        *pos!=tagValue) {
+      tagValues.insert(pos,tagValue);
+    }
   }
 
-  bool TagIsInCondition::Evaluate(const std::map<TagId,std::string>& tagMap) const
+  /**
+    Compare the value of the tag with the given string like
+    std::string::compare() does.
+    */
+  static int CompareTagValue(const TagRef& tag,
+                             const std::string& value)
   {
-    std::map<TagId,std::string>::const_iterator t;
+    int result=memcmp(tag.value,
+                      value.data(),
+                      std::min(tag.length,value.length()));
+
+    if (result!=0) {
+      return result;
+    }
 
-    t=tagMap.find(tag);
+    if (tag.length<value.length()) {
+      return -1;
+    }
+    else if (tag.length>value.length()) {
+      return 1;
+    }
+
+    return 0;
+  }
+
+  bool TagIsInCondition::Evaluate(const TagView& tags) const
+  {
+    const TagRef* t=tags.Find(tag);
 
-    if (t==tagMap.end()) {
+    if (t==NULL) {
       return false;
     }
 
-    return tagValues.find(t->second)!=tagValues.end();
+    size_t first=0;
+    size_t last=tagValues.size();
+
+    while (first<last) {
+      size_t middle=first+(last-first)/2;
+      int    result=CompareTagValue(*t,tagValues[middle]);
+
+      if (result==0) {
+        return true;
+      }
+      else if (result>0) {
+        first=middle+1;
+      }
+      else {
+        last=middle;
+      }
+    }
+
+    return false;
   }
 
   TagInfo::TagInfo()
@@ -600,25 +649,28 @@ namespace osmscout {
     return types[id];
   }
 
-  void TypeConfig::ResolveTags(const std::map<TagId,std::string>& map,
+  void TypeConfig::ResolveTags(const TagView& view,
                                std::vector<Tag>& tags) const
   {
-    tags.clear();
+    size_t count=0;
 
-    for (std::map<TagId,std::string>::const_iterator t=map.begin();
-         t!=map.end();
+    // Assign to existing entries to reuse their memory
+    tags.resize(view.size());
+
+    for (const TagRef* t=view.begin();
+         t!=view.end();
          ++t) {
-      if (GetTagInfo(t->first).IsInternalOnly()) {
+      if (GetTagInfo(t->key).IsInternalOnly()) {
         continue;
       }
 
-      Tag tag;
-
-      tag.key=t->first;
-      tag.value=t->second;
+      tags[count].key=t->key;
+      tags[count].value.assign(t->value,t->length);
 
-      tags.push_back(tag);
+      count++;
     }
+
+    tags.resize(count);
   }
 
   bool TypeConfig::IsNameTag(TagId tag, uint32_t& priority) const
@@ -655,12 +707,12 @@ namespace osmscout {
     return true;
   }
 
-  bool TypeConfig::GetNodeTypeId(const std::map<TagId,std::string>& tagMap,
+  bool TypeConfig::GetNodeTypeId(const TagView& tags,
                                  TypeId &typeId) const
   {
     typeId=typeIgnore;
 
-    if (tagMap.empty()) {
+    if (tags.empty()) {
       return false;
     }
 
@@ -677,7 +729,7 @@ namespace osmscout {
           continue;
         }
 
-        if (cond->condition->Evaluate(tagMap)) {
+        if (cond->condition->Evaluate(tags)) {
           typeId=types[i].GetId();
           return true;
         }
@@ -687,14 +739,14 @@ namespace osmscout {
     return false;
   }
 
-  bool TypeConfig::GetWayAreaTypeId(const std::map<TagId,std::string>& tagMap,
+  bool TypeConfig::GetWayAreaTypeId(const TagView& tags,
                                     TypeId &wayType,
                                     TypeId &areaType) const
   {
     wayType=typeIgnore;
     areaType=typeIgnore;
 
-    if (tagMap.empty()) {
+    if (tags.empty()) {
       return false;
     }
 
@@ -712,7 +764,7 @@ namespace osmscout {
           continue;
         }
 
-        if (cond->condition->Evaluate(tagMap)) {
+        if (cond->condition->Evaluate(tags)) {
           if (wayType==typeIgnore &&
               (cond->types & TypeInfo::typeWay)) {
             wayType=types[i].GetId();
@@ -734,19 +786,19 @@ namespace osmscout {
     return false;
   }
 
-  bool TypeConfig::GetRelationTypeId(const std::map<TagId,std::string>& tagMap,
+  bool TypeConfig::GetRelationTypeId(const TagView& tags,
                                      TypeId &typeId) const
   {
     typeId=typeIgnore;
 
-    if (tagMap.empty()) {
+    if (tags.empty()) {
       return false;
     }
 
-    std::map<TagId,std::string>::const_iterator relationType=tagMap.find(tagType);
+    const TagRef* relationType=tags.Find(tagType);
 
-    if (relationType!=tagMap.end() &&
-        relationType->second=="multipolygon") {
+    if (relationType!=NULL &&
+        *relationType=="multipolygon") {
       for (size_t i=0; i<types.size(); i++) {
         if (!types[i].HasConditions() ||
             !types[i].CanBeArea()) {
@@ -760,7 +812,7 @@ namespace osmscout {
             continue;
           }
 
-          if (cond->condition->Evaluate(tagMap)) {
+          if (cond->condition->Evaluate(tags)) {
             typeId=types[i].GetId();
             return true;
           }
@@ -781,7 +833,7 @@ namespace osmscout {
             continue;
           }
 
-          if (cond->condition->Evaluate(tagMap)) {
+          if (cond->condition->Evaluate(tags)) {
             typeId=types[i].GetId();
             return true;
           }
@@ -37,17 +37,23 @@ namespace osmscout {
   {
     datafilename=path+"/"+filepart;
 
-    if (!scanner.Open(datafilename,FileScanner::LowMemRandom,true)) {
+    if (!scannerPool.Open(datafilename,FileScanner::LowMemRandom,true)) {
       std::cerr << "Cannot open file '" << datafilename << "'" << std::endl;
       return false;
     }
 
-    if (!scanner.ReadNumber(waterIndexMinMag)) {
+    PooledFileScanner scanner(scannerPool);
+
+    if (!scanner.IsValid()) {
+      return false;
+    }
+
+    if (!scanner->ReadNumber(waterIndexMinMag)) {
       std::cerr << "Error while reading from file '" << datafilename << "'" << std::endl;
       return false;
     }
 
-    if (!scanner.ReadNumber(waterIndexMaxMag)) {
+    if (!scanner->ReadNumber(waterIndexMaxMag)) {
       std::cerr << "Error while reading from file '" << datafilename << "'" << std::endl;
       return false;
     }
@@ -72,23 +78,23 @@ namespace osmscout {
     for (size_t level=waterIndexMinMag; level<=waterIndexMaxMag; level++){
       size_t idx=level-waterIndexMinMag;
 
-      scanner.ReadFileOffset(levels[idx].offset);
+      scanner->ReadFileOffset(levels[idx].offset);
 
-      scanner.ReadNumber(levels[idx].cellXStart);
-      scanner.ReadNumber(levels[idx].cellXEnd);
-      scanner.ReadNumber(levels[idx].cellYStart);
-      scanner.ReadNumber(levels[idx].cellYEnd);
+      scanner->ReadNumber(levels[idx].cellXStart);
+      scanner->ReadNumber(levels[idx].cellXEnd);
+      scanner->ReadNumber(levels[idx].cellYStart);
+      scanner->ReadNumber(levels[idx].cellYEnd);
 
       levels[idx].cellXCount=levels[idx].cellXEnd-levels[idx].cellXStart+1;
       levels[idx].cellYCount=levels[idx].cellYEnd-levels[idx].cellYStart+1;
     }
 
-    if (scanner.HasError()) {
+    if (scanner->HasError()) {
       std::cerr << "Error while reading from file '" << datafilename << "'" << std::endl;
       return false;
     }
 
-    return scanner.Close();
+    return true;
   }
 
   bool WaterIndex::GetRegions(double minlon,
@@ -114,11 +120,10 @@ namespace osmscout {
 
     tiles.clear();
 
-    if (!scanner.IsOpen()) {
-      if (!scanner.Open(datafilename,FileScanner::LowMemRandom,true)) {
-        std::cerr << "Error while opening " << datafilename << " for reading!" << std::endl;
-        return false;
-      }
+    PooledFileScanner scanner(scannerPool);
+
+    if (!scanner.IsValid()) {
+      return false;
     }
 
     cx1=(uint32_t)floor((minlon+180.0)/levels[idx].cellWidth);
@@ -161,9 +166,9 @@ namespace osmscout {
           uint32_t   index=cellId*8;
           FileOffset cell;
 
-          scanner.SetPos(levels[idx].offset+index);
+          scanner->SetPos(levels[idx].offset+index);
 
-          if (!scanner.Read(cell)) {
+          if (!scanner->Read(cell)) {
             std::cerr << "Error while reading from file '" << datafilename << "'" << std::endl;
             return false;
           }
@@ -185,18 +190,18 @@ namespace osmscout {
 
             tiles.push_back(tile);
 
-            scanner.SetPos(cell);
-            scanner.ReadNumber(tileCount);
+            scanner->SetPos(cell);
+            scanner->ReadNumber(tileCount);
 
             for (size_t t=1; t<=tileCount; t++) {
               uint8_t    tileType;
               uint32_t   coordCount;
 
-              scanner.Read(tileType);
+              scanner->Read(tileType);
 
               tile.type=(GroundTile::Type)tileType;
 
-              scanner.ReadNumber(coordCount);
+              scanner->ReadNumber(coordCount);
 
               tile.coords.resize(coordCount);
 
@@ -204,8 +209,8 @@ namespace osmscout {
                 uint16_t x;
                 uint16_t y;
 
-                scanner.Read(x);
-                scanner.Read(y);
+                scanner->Read(x);
+                scanner->Read(y);
 
                 tile.coords[n].Set(x & ~(1 << 15),
                                    y,
@@ -513,6 +513,28 @@ namespace osmscout {
     return !writer.HasError();
   }
 
+  /**
+    Returns the memory used by the dynamically allocated data of the attributes,
+    excluding the size of the object itself.
+    */
+  unsigned long WayAttributes::GetMemorySize() const
+  {
+    unsigned long memory=name.capacity()+
+                         nameAlt.capacity()+
+                         ref.capacity()+
+                         location.capacity()+
+                         address.capacity()+
+                         tags.capacity()*sizeof(Tag);
+
+    for (std::vector<Tag>::const_iterator tag=tags.begin();
+         tag!=tags.end();
+         ++tag) {
+      memory+=tag->value.capacity();
+    }
+
+    return memory;
+  }
+
   bool WayAttributes::operator==(const WayAttributes& other) const
   {
     if (type!=other.type) {
@@ -608,6 +630,18 @@ namespace osmscout {
     attributes.SetLayer(std::numeric_limits<int8_t>::max());
   }
 
+  /**
+    Returns the estimated memory used by the way, including the node ids,
+    coordinates and all other dynamically allocated data.
+    */
+  unsigned long Way::GetMemorySize() const
+  {
+    return sizeof(Way)+
+           ids.capacity()*sizeof(Id)+
+           nodes.capacity()*sizeof(GeoCoord)+
+           attributes.GetMemorySize();
+  }
+
   void Way::GetBoundingBox(double& minLon,
                            double& maxLon,
                            double& minLat,
@@ -668,22 +702,9 @@ namespace osmscout {
       return false;
     }
 
-    uint32_t minLat;
-    uint32_t minLon;
-
-    scanner.Read(minLat);
-    scanner.Read(minLon);
-
-    nodes.resize(nodeCount);
-    for (size_t i=0; i<nodeCount; i++) {
-      uint32_t latValue;
-      uint32_t lonValue;
-
-      scanner.ReadNumber(latValue);
-      scanner.ReadNumber(lonValue);
-
-      nodes[i].Set((minLat+latValue)/conversionFactor-90.0,
-                   (minLon+lonValue)/conversionFactor-180.0);
+    if (!scanner.ReadCoords(nodeCount,
+                            nodes)) {
+      return false;
     }
 
     ids.resize(nodeCount,0);
@@ -727,22 +748,9 @@ namespace osmscout {
       return false;
     }
 
-    uint32_t minLat;
-    uint32_t minLon;
-
-    scanner.Read(minLat);
-    scanner.Read(minLon);
-
-    nodes.resize(nodeCount);
-    for (size_t i=0; i<nodeCount; i++) {
-      uint32_t latValue;
-      uint32_t lonValue;
-
-      scanner.ReadNumber(latValue);
-      scanner.ReadNumber(lonValue);
-
-      nodes[i].Set((minLat+latValue)/conversionFactor-90.0,
-                   (minLon+lonValue)/conversionFactor-180.0);
+    if (!scanner.ReadCoords(nodeCount,
+                            nodes)) {
+      return false;
     }
 
     return !scanner.HasError();
@@ -758,28 +766,8 @@ namespace osmscout {
 
     writer.WriteNumber((uint32_t)nodes.size());
 
-    double   minLat=nodes[0].GetLat();
-    double   minLon=nodes[0].GetLon();
-    uint32_t minLatValue;
-    uint32_t minLonValue;
-
-    for (size_t i=1; i<nodes.size(); i++) {
-      minLat=std::min(minLat,nodes[i].GetLat());
-      minLon=std::min(minLon,nodes[i].GetLon());
-    }
-
-    minLatValue=(uint32_t)round((minLat+90.0)*conversionFactor);
-    minLonValue=(uint32_t)round((minLon+180.0)*conversionFactor);
-
-    writer.Write(minLatValue);
-    writer.Write(minLonValue);
-
-    for (size_t i=0; i<nodes.size(); i++) {
-      uint32_t latValue=(uint32_t)round((nodes[i].GetLat()-minLat)*conversionFactor);
-      uint32_t lonValue=(uint32_t)round((nodes[i].GetLon()-minLon)*conversionFactor);
-
-      writer.WriteNumber(latValue);
-      writer.WriteNumber(lonValue);
+    if (!writer.WriteCoords(nodes)) {
+      return false;
     }
 
     uint32_t idCount=0;
@@ -824,26 +812,8 @@ namespace osmscout {
 
     writer.WriteNumber((uint32_t)nodes.size());
 
-    double minLat=nodes[0].GetLat();
-    double minLon=nodes[0].GetLon();
-
-    for (size_t i=1; i<nodes.size(); i++) {
-      minLat=std::min(minLat,nodes[i].GetLat());
-      minLon=std::min(minLon,nodes[i].GetLon());
-    }
-
-    uint32_t minLatValue=(uint32_t)round((minLat+90.0)*conversionFactor);
-    uint32_t minLonValue=(uint32_t)round((minLon+180.0)*conversionFactor);
-
-    writer.Write(minLatValue);
-    writer.Write(minLonValue);
-
-    for (size_t i=0; i<nodes.size(); i++) {
-      uint32_t latValue=(uint32_t)round((nodes[i].GetLat()-minLat)*conversionFactor);
-      uint32_t lonValue=(uint32_t)round((nodes[i].GetLon()-minLon)*conversionFactor);
-
-      writer.WriteNumber(latValue);
-      writer.WriteNumber(lonValue);
+    if (!writer.WriteCoords(nodes)) {
+      return false;
     }
 
     return !writer.HasError();
@@ -0,0 +1,286 @@
+/*
+  This source is part of the libosmscout library
+  Copyright (C) 2013  Tim Teulings
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+#include <osmscout/util/CoordEncoding.h>
+
+#include <osmscout/CoreFeatures.h>
+
+#if defined(OSMSCOUT_HAVE_SSSE3)
+  #include <emmintrin.h>
+  #include <tmmintrin.h>
+#endif
+
+#include <osmscout/system/Assert.h>
+#include <osmscout/system/Math.h>
+
+namespace osmscout {
+
+  const uint32_t coordDeltaEncodingFlag=0x80000000;
+  const size_t   coordDeltaPadding=16;
+
+  /**
+    Tables for decoding of a control byte
+    */
+  struct CoordDeltaTables
+  {
+    unsigned char length[256];      //! Number of data bytes of the four values
+    unsigned char shuffle[256][16]; //! Shuffle mask moving the data bytes into four uint32 values
+
+    CoordDeltaTables()
+    {
+      for (size_t control=0; control<256; control++) {
+        size_t pos=0;
+
+        for (size_t value=0; value<4; value++) {
+          size_t bytes=((control >> (2*value)) & 0x03)+1;
+
+          for (size_t byte=0; byte<4; byte++) {
+            if (byte<bytes) {
+              shuffle[control][value*4+byte]=(unsigned char)(pos+byte);
+            }
+            else {
+              shuffle[control][value*4+byte]=0x80;
+            }
+          }
+
+          pos+=bytes;
+        }
+
+        length[control]=(unsigned char)pos;
+      }
+    }
+  };
+
+  static const CoordDeltaTables coordDeltaTables;
+
+  static inline uint32_t GetCoordValue(double value,
+                                       double offset)
+  {
+    return (uint32_t)floor((value+offset)*conversionFactor+0.5);
+  }
+
+  static inline uint32_t ZigZagEncode(uint32_t value)
+  {
+    return (value << 1) ^ (uint32_t)((int32_t)value >> 31);
+  }
+
+  static inline uint32_t ZigZagDecode(uint32_t value)
+  {
+    return (value >> 1) ^ (0-(value & 1));
+  }
+
+  /**
+    Return the number of data bytes for the given number of coordinates
+    (including the first one, which is not part of the deltas).
+    */
+  size_t GetCoordDeltaDataSize(const unsigned char* control,
+                               size_t coordCount)
+  {
+    if (coordCount<=1) {
+      return 0;
+    }
+
+    size_t valueCount=(coordCount-1)*2;
+    size_t size=0;
+
+    for (size_t i=0; i<valueCount/4; i++) {
+      size+=coordDeltaTables.length[control[i]];
+    }
+
+    for (size_t i=valueCount/4*4; i<valueCount; i++) {
+      size+=((control[i/4] >> (2*(i%4))) & 0x03)+1;
+    }
+
+    return size;
+  }
+
+  /**
+    Append the encoded coordinates to the buffer. There must be at least
+    one coordinate.
+    */
+  void EncodeCoords(const std::vector<GeoCoord>& coords,
+                    std::vector<unsigned char>& buffer)
+  {
+    assert(!coords.empty());
+
+    uint32_t lastLat=GetCoordValue(coords[0].GetLat(),90.0);
+    uint32_t lastLon=GetCoordValue(coords[0].GetLon(),180.0);
+    uint32_t first[2];
+
+    first[0]=lastLat | coordDeltaEncodingFlag;
+    first[1]=lastLon;
+
+    for (size_t i=0; i<2; i++) {
+      buffer.push_back((unsigned char)((first[i] >>  0) & 0xff));
+      buffer.push_back((unsigned char)((first[i] >>  8) & 0xff));
+      buffer.push_back((unsigned char)((first[i] >> 16) & 0xff));
+      buffer.push_back((unsigned char)((first[i] >> 24) & 0xff));
+    }
+
+    size_t controlPos=buffer.size();
+    size_t valueCount=0;
+
+    buffer.resize(buffer.size()+GetCoordDeltaControlSize(coords.size()),0);
+
+    for (size_t i=1; i<coords.size(); i++) {
+      uint32_t lat=GetCoordValue(coords[i].GetLat(),90.0);
+      uint32_t lon=GetCoordValue(coords[i].GetLon(),180.0);
+      uint32_t values[2];
+
+      // Differences are calculated modulo 2^32, so they always fit
+      values[0]=ZigZagEncode(lat-lastLat);
+      values[1]=ZigZagEncode(lon-lastLon);
+
+      for (size_t v=0; v<2; v++) {
+        uint32_t value=values[v];
+        size_t   bytes=1;
+
+        if (value>=0x1000000) {
+          bytes=4;
+        }
+        else if (value>=0x10000) {
+          bytes=3;
+        }
+        else if (value>=0x100) {
+          bytes=2;
+        }
+
+        buffer[controlPos+valueCount/4]|=(unsigned char)((bytes-1) << (2*(valueCount%4)));
+
+        for (size_t byte=0; byte<bytes; byte++) {
+          buffer.push_back((unsigned char)((value >> (8*byte)) & 0xff));
+        }
+
+        valueCount++;
+      }
+
+      lastLat=lat;
+      lastLon=lon;
+    }
+  }
+
+  /**
+    Decode the coordinates, given the first coordinate (with the encoding flag
+    removed), the control bytes and the data bytes. coordDeltaPadding bytes
+    behind the data bytes must be readable.
+    */
+  void DecodeCoordDeltas(uint32_t latValue,
+                         uint32_t lonValue,
+                         const unsigned char* control,
+                         const unsigned char* data,
+                         size_t coordCount,
+                         std::vector<GeoCoord>& coords)
+  {
+    coords.resize(coordCount);
+
+    if (coordCount==0) {
+      return;
+    }
+
+    coords[0].SetValues(latValue,
+                        lonValue);
+
+    size_t valueCount=(coordCount-1)*2;
+    size_t coord=1;
+    size_t value=0;
+
+#if defined(OSMSCOUT_HAVE_SSSE3)
+    // Four values (two coordinates) per control byte
+    __m128i last=_mm_set_epi32((int)lonValue,(int)latValue,(int)lonValue,(int)latValue);
+    __m128i one=_mm_set1_epi32(1);
+#if !defined(OSMSCOUT_COMPACT_COORDS)
+    __m128i signFlip=_mm_set1_epi32((int)0x80000000);
+    __m128d signOffset=_mm_set1_pd(2147483648.0);
+    __m128d factor=_mm_set1_pd(conversionFactor);
+    __m128d offset=_mm_set_pd(180.0,90.0);
+#endif
+
+    for (size_t c=0; c<valueCount/4; c++) {
+      __m128i values=_mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data)),
+                                      _mm_loadu_si128(reinterpret_cast<const __m128i*>(coordDeltaTables.shuffle[control[c]])));
+
+      data+=coordDeltaTables.length[control[c]];
+
+      // zigzag decoding
+      values=_mm_xor_si128(_mm_srli_epi32(values,1),
+                           _mm_sub_epi32(_mm_setzero_si128(),
+                                         _mm_and_si128(values,one)));
+
+      // prefix sum of the (lat,lon) pairs
+      values=_mm_add_epi32(values,_mm_slli_si128(values,8));
+      values=_mm_add_epi32(values,last);
+      last=_mm_shuffle_epi32(values,_MM_SHUFFLE(3,2,3,2));
+
+#if defined(OSMSCOUT_COMPACT_COORDS)
+      uint32_t result[4];
+
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(result),values);
+
+      coords[coord].SetValues(result[0],result[1]);
+      coords[coord+1].SetValues(result[2],result[3]);
+#else
+      // unsigned to double conversion
+      values=_mm_xor_si128(values,signFlip);
+
+      __m128d first=_mm_add_pd(_mm_cvtepi32_pd(values),signOffset);
+      __m128d second=_mm_add_pd(_mm_cvtepi32_pd(_mm_srli_si128(values,8)),signOffset);
+      double  result[4];
+
+      _mm_storeu_pd(&result[0],_mm_sub_pd(_mm_div_pd(first,factor),offset));
+      _mm_storeu_pd(&result[2],_mm_sub_pd(_mm_div_pd(second,factor),offset));
+
+      coords[coord].Set(result[0],result[1]);
+      coords[coord+1].Set(result[2],result[3]);
+#endif
+
+      coord+=2;
+    }
+
+    value=valueCount/4*4;
+
+    latValue=(uint32_t)_mm_cvtsi128_si32(last);
+    lonValue=(uint32_t)_mm_cvtsi128_si32(_mm_srli_si128(last,4));
+#endif
+
+    while (value<valueCount) {
+      uint32_t values[2];
+
+      for (size_t v=0; v<2; v++) {
+        size_t bytes=((control[value/4] >> (2*(value%4))) & 0x03)+1;
+
+        values[v]=0;
+
+        for (size_t byte=0; byte<bytes; byte++) {
+          values[v]|=((uint32_t)data[byte]) << (8*byte);
+        }
+
+        data+=bytes;
+        value++;
+      }
+
+      latValue+=ZigZagDecode(values[0]);
+      lonValue+=ZigZagDecode(values[1]);
+
+      coords[coord].SetValues(latValue,
+                              lonValue);
+
+      coord++;
+    }
+  }
+}
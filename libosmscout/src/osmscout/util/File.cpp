@@ -21,9 +21,17 @@
 
 #include <osmscout/util/File.h>
 
+#include <errno.h>
 #include <stdio.h>
 #include <stdlib.h>
 
+#if defined(__WIN32__) || defined(WIN32)
+  #include <direct.h>
+#else
+  #include <sys/stat.h>
+  #include <sys/types.h>
+#endif
+
 namespace osmscout {
 
   bool GetFileSize(const std::string& filename, FileOffset& size)
@@ -91,6 +99,15 @@ namespace osmscout {
                   newFilename.c_str())==0;
   }
 
+  bool MakeDirectory(const std::string& directory)
+  {
+#if defined(__WIN32__) || defined(WIN32)
+    return _mkdir(directory.c_str())==0 || errno==EEXIST;
+#else
+    return mkdir(directory.c_str(),0777)==0 || errno==EEXIST;
+#endif
+  }
+
   std::string AppendFileToDir(const std::string& dir, const std::string& file)
   {
 #if defined(__WIN32__) || defined(WIN32)
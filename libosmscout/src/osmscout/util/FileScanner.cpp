@@ -47,6 +47,7 @@
 
 #include <osmscout/system/Assert.h>
 
+#include <osmscout/util/CoordEncoding.h>
 #include <osmscout/util/Number.h>
 
 namespace osmscout {
@@ -1864,8 +1865,8 @@ namespace osmscout {
 
       offset+=2*4;
 
-      coord.Set(latDat/conversionFactor-90.0,
-                lonDat/conversionFactor-180.0);
+      coord.SetValues(latDat,
+                      lonDat);
 
       return true;
     }
@@ -1927,8 +1928,126 @@ namespace osmscout {
     lonDat|=add;
     dataPtr++;
 
-    coord.Set(latDat/conversionFactor-90.0,
-              lonDat/conversionFactor-180.0);
+    coord.SetValues(latDat,
+                    lonDat);
+
+    return true;
+  }
+
+  /**
+    Read a sequence of count coordinates as written by
+    FileWriter::WriteCoords(). The older encoding relative to the minimum
+    coordinate is supported, too.
+    */
+  bool FileScanner::ReadCoords(size_t count,
+                               std::vector<GeoCoord>& coords)
+  {
+    uint32_t latValue;
+    uint32_t lonValue;
+
+    if (!Read(latValue) ||
+        !Read(lonValue)) {
+      return false;
+    }
+
+    if (!(latValue & coordDeltaEncodingFlag)) {
+      coords.resize(count);
+
+      for (size_t i=0; i<count; i++) {
+        uint32_t latDelta;
+        uint32_t lonDelta;
+
+        ReadNumber(latDelta);
+        ReadNumber(lonDelta);
+
+        coords[i].SetValues(latValue+latDelta,
+                            lonValue+lonDelta);
+      }
+
+      return !HasError();
+    }
+
+    latValue&=~coordDeltaEncodingFlag;
+
+    size_t controlSize=GetCoordDeltaControlSize(count);
+
+    if (controlSize==0) {
+      DecodeCoordDeltas(latValue,
+                        lonValue,
+                        NULL,
+                        NULL,
+                        count,
+                        coords);
+
+      return true;
+    }
+
+#if defined(HAVE_MMAP) || defined(__WIN32__) || defined(WIN32)
+    if (buffer!=NULL) {
+      if (offset+(FileOffset)controlSize-1>=size) {
+        std::cerr << "Cannot read coordinates beyond file end!" << std::endl;
+        hasError=true;
+        return false;
+      }
+
+      const unsigned char* control=reinterpret_cast<const unsigned char*>(&buffer[offset]);
+      size_t               dataSize=GetCoordDeltaDataSize(control,count);
+
+      if (offset+(FileOffset)(controlSize+dataSize)-1>=size) {
+        std::cerr << "Cannot read coordinates beyond file end!" << std::endl;
+        hasError=true;
+        return false;
+      }
+
+      const unsigned char* data=control+controlSize;
+
+      // The decoder may read some bytes behind the data
+      if (offset+(FileOffset)(controlSize+dataSize+coordDeltaPadding)>size) {
+        coordBuffer.assign(data,data+dataSize);
+        coordBuffer.resize(dataSize+coordDeltaPadding,0);
+
+        data=&coordBuffer[0];
+      }
+
+      DecodeCoordDeltas(latValue,
+                        lonValue,
+                        control,
+                        data,
+                        count,
+                        coords);
+
+      offset+=controlSize+dataSize;
+
+      return true;
+    }
+#endif
+
+    coordBuffer.resize(controlSize);
+
+    hasError=fread(&coordBuffer[0],1,controlSize,file)!=controlSize;
+
+    if (hasError) {
+      std::cerr << "Cannot read coordinates beyond file end!" << std::endl;
+      return false;
+    }
+
+    size_t dataSize=GetCoordDeltaDataSize(&coordBuffer[0],count);
+
+    coordBuffer.resize(controlSize+dataSize+coordDeltaPadding,0);
+
+    hasError=fread(&coordBuffer[controlSize],1,dataSize,file)!=dataSize;
+
+    if (hasError) {
+      std::cerr << "Cannot read coordinates beyond file end!" << std::endl;
+      return false;
+    }
+
+    DecodeCoordDeltas(latValue,
+                      lonValue,
+                      &coordBuffer[0],
+                      &coordBuffer[controlSize],
+                      count,
+                      coords);
 
     return true;
   }
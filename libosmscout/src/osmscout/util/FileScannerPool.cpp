@@ -0,0 +1,167 @@
+/*
+  This source is part of the libosmscout library
+  Copyright (C) 2013  Tim Teulings
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+#include <osmscout/util/FileScannerPool.h>
+
+#include <iostream>
+
+#include <osmscout/system/Assert.h>
+
+namespace osmscout {
+
+  FileScannerPool::FileScannerPool()
+  : mode(FileScanner::LowMemRandom),
+    useMmap(false),
+    isOpen(false)
+  {
+    // no code
+  }
+
+  FileScannerPool::~FileScannerPool()
+  {
+    if (isOpen) {
+      Close();
+    }
+  }
+
+  /**
+    Opens the pool for the given file. The file is opened once to make
+    sure that it is accessible. The resulting scanner is the first
+    member of the pool.
+    */
+  bool FileScannerPool::Open(const std::string& filename,
+                             FileScanner::Mode mode,
+                             bool useMmap)
+  {
+    if (isOpen) {
+      std::cerr << "File '" << filename << "' already opened, cannot open it again!" << std::endl;
+      return false;
+    }
+
+    FileScanner *scanner=new FileScanner();
+
+    if (!scanner->Open(filename,mode,useMmap)) {
+      delete scanner;
+      return false;
+    }
+
+    this->filename=filename;
+    this->mode=mode;
+    this->useMmap=useMmap;
+
+    MutexLocker locker(mutex);
+
+    scanners.push_back(scanner);
+    isOpen=true;
+
+    return true;
+  }
+
+  /**
+    Closes all unused scanners. Scanners currently in use are closed
+    when they get released.
+    */
+  bool FileScannerPool::Close()
+  {
+    MutexLocker locker(mutex);
+    bool        success=true;
+
+    for (std::vector<FileScanner*>::iterator scanner=scanners.begin();
+         scanner!=scanners.end();
+         ++scanner) {
+      if ((*scanner)->IsOpen() &&
+          !(*scanner)->Close()) {
+        success=false;
+      }
+
+      delete *scanner;
+    }
+
+    scanners.clear();
+    isOpen=false;
+
+    return success;
+  }
+
+  std::string FileScannerPool::GetFilename() const
+  {
+    return filename;
+  }
+
+  /**
+    Returns an opened scanner for exclusive use by the caller or NULL, if the
+    pool is not opened or the file cannot be opened. The scanner
+    must be returned to the pool by calling Release().
+    */
+  FileScanner* FileScannerPool::Acquire()
+  {
+    {
+      MutexLocker locker(mutex);
+
+      if (!isOpen) {
+        return NULL;
+      }
+
+      if (!scanners.empty()) {
+        FileScanner *scanner=scanners.back();
+
+        scanners.pop_back();
+
+        return scanner;
+      }
+    }
+
+    FileScanner *scanner=new FileScanner();
+
+    if (!scanner->Open(filename,mode,useMmap)) {
+      std::cerr << "Error while opening " << filename << " for reading!" << std::endl;
+      delete scanner;
+      return NULL;
+    }
+
+    return scanner;
+  }
+
+  /**
+    Returns the given scanner to the pool. Scanners that are in an error state
+    are closed and deleted instead, so the next caller gets a freshly opened
+    instance.
+    */
+  void FileScannerPool::Release(FileScanner* scanner)
+  {
+    assert(scanner!=NULL);
+
+    {
+      MutexLocker locker(mutex);
+
+      if (isOpen &&
+          !scanner->HasError()) {
+        scanners.push_back(scanner);
+
+        return;
+      }
+    }
+
+    if (scanner->IsOpen()) {
+      scanner->Close();
+    }
+
+    delete scanner;
+  }
+}
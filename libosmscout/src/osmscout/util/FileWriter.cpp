@@ -23,6 +23,9 @@
 
 #include <osmscout/util/FileWriter.h>
 
+#include <algorithm>
+#include <limits>
+
 #include <string.h>
 
 #include <stdio.h>
@@ -30,13 +33,15 @@
 #include <osmscout/system/Assert.h>
 #include <osmscout/system/Math.h>
 
+#include <osmscout/util/CoordEncoding.h>
 #include <osmscout/util/Number.h>
 
 namespace osmscout {
 
   FileWriter::FileWriter()
    : file(NULL),
-     hasError(true)
+     hasError(true),
+     coordDeltaEncoding(false)
   {
     // no code
   }
@@ -523,6 +528,59 @@ namespace osmscout {
     return !hasError;
   }
 
+  /**
+    Write coordinate sequences (see WriteCoords()) using the delta encoding of
+    CoordEncoding.h instead of the encoding relative to the minimum coordinate.
+    The delta encoding cannot be read by older versions of the library.
+    */
+  void FileWriter::SetCoordDeltaEncoding(bool coordDeltaEncoding)
+  {
+    this->coordDeltaEncoding=coordDeltaEncoding;
+  }
+
+  /**
+    Write a non-empty sequence of coordinates, either relative to the minimum
+    coordinate or delta encoded (see SetCoordDeltaEncoding() and CoordEncoding.h)
+    */
+  bool FileWriter::WriteCoords(const std::vector<GeoCoord>& coords)
+  {
+    if (HasError()) {
+      return false;
+    }
+
+    if (!coordDeltaEncoding) {
+      uint32_t minLat=std::numeric_limits<uint32_t>::max();
+      uint32_t minLon=std::numeric_limits<uint32_t>::max();
+
+      for (size_t i=0; i<coords.size(); i++) {
+        minLat=std::min(minLat,(uint32_t)floor((coords[i].GetLat()+90.0)*conversionFactor+0.5));
+        minLon=std::min(minLon,(uint32_t)floor((coords[i].GetLon()+180.0)*conversionFactor+0.5));
+      }
+
+      Write(minLat);
+      Write(minLon);
+
+      for (size_t i=0; i<coords.size(); i++) {
+        uint32_t latValue=(uint32_t)floor((coords[i].GetLat()+90.0)*conversionFactor+0.5);
+        uint32_t lonValue=(uint32_t)floor((coords[i].GetLon()+180.0)*conversionFactor+0.5);
+
+        WriteNumber(latValue-minLat);
+        WriteNumber(lonValue-minLon);
+      }
+
+      return !HasError();
+    }
+
+    coordBuffer.clear();
+
+    EncodeCoords(coords,
+                 coordBuffer);
+
+    hasError=fwrite(&coordBuffer[0],1,coordBuffer.size(),file)!=coordBuffer.size();
+
+    return !hasError;
+  }
+
   bool FileWriter::Flush()
   {
     if (HasError()) {
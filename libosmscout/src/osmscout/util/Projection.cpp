@@ -26,6 +26,10 @@
 #include <osmscout/system/SSEMath.h>
 #endif
 
+#if defined(OSMSCOUT_HAVE_CPU_DISPATCH)
+#include <immintrin.h>
+#endif
+
 namespace osmscout {
 
 #ifdef OSMSCOUT_HAVE_SSE2
@@ -34,11 +38,374 @@ namespace osmscout {
 
   static const double gradtorad=2*M_PI/360;
 
+  /**
+    Linear parts of the mercator transformation of a batch of coordinates:
+
+    x=lon*lonFactor-lonOffset
+    y=atanh(sin(lat*latFactor-latOffset))*yFactor+yOffset
+
+    lon and lat are the values as stored in the GeoCoord (see GetBatchLon()
+    and GetBatchLat()), for compact coordinates the conversion from fixed
+    point is part of the factors and offsets.
+    */
+  struct MercatorBatchParameter
+  {
+    double lonFactor;
+    double lonOffset;
+    double latFactor;
+    double latOffset;
+    double yFactor;
+    double yOffset;
+  };
+
+  typedef void (*MercatorBatchFunction)(const MercatorBatchParameter& parameter,
+                                        const GeoCoord* coords,
+                                        size_t count,
+                                        double* x,
+                                        double* y,
+                                        size_t stride);
+
+  static inline double* GetStrided(double* base,
+                                   size_t index,
+                                   size_t stride)
+  {
+    return reinterpret_cast<double*>(reinterpret_cast<char*>(base)+index*stride);
+  }
+
+  static inline double GetBatchLon(const GeoCoord& coord)
+  {
+#if defined(OSMSCOUT_COMPACT_COORDS)
+    return coord.lonValue;
+#else
+    return coord.lon;
+#endif
+  }
+
+  static inline double GetBatchLat(const GeoCoord& coord)
+  {
+#if defined(OSMSCOUT_COMPACT_COORDS)
+    return coord.latValue;
+#else
+    return coord.lat;
+#endif
+  }
+
+  /**
+    Initializes the batch parameter for the given linear transformation of
+    lon and lat in degrees. For compact coordinates the conversion of the
+    fixed point values is merged into the factors and offsets, so the
+    stored integers are transformed without converting them to degrees
+    first.
+    */
+  static void InitializeBatchParameter(MercatorBatchParameter& parameter,
+                                       double lonFactor,
+                                       double lonOffset,
+                                       double yFactor,
+                                       double yOffset)
+  {
+#if defined(OSMSCOUT_COMPACT_COORDS)
+    parameter.lonFactor=lonFactor/conversionFactor;
+    parameter.lonOffset=lonOffset+180.0*lonFactor;
+    parameter.latFactor=gradtorad/conversionFactor;
+    parameter.latOffset=90.0*gradtorad;
+#else
+    parameter.lonFactor=lonFactor;
+    parameter.lonOffset=lonOffset;
+    parameter.latFactor=gradtorad;
+    parameter.latOffset=0.0;
+#endif
+    parameter.yFactor=yFactor;
+    parameter.yOffset=yOffset;
+  }
+
+  /**
+    Transformation without runtime specific code, using SSE2 for pairs of
+    coordinates if available
+    */
+  static void MercatorGeoToPixel(const MercatorBatchParameter& parameter,
+                                 const GeoCoord* coords,
+                                 size_t count,
+                                 double* x,
+                                 double* y,
+                                 size_t stride)
+  {
+    size_t i=0;
+
+#ifdef OSMSCOUT_HAVE_SSE2
+    v2df lonFactor=_mm_set1_pd(parameter.lonFactor);
+    v2df lonOffset=_mm_set1_pd(parameter.lonOffset);
+    v2df latFactor=_mm_set1_pd(parameter.latFactor);
+    v2df latOffset=_mm_set1_pd(parameter.latOffset);
+    v2df yFactor=_mm_set1_pd(parameter.yFactor);
+    v2df yOffset=_mm_set1_pd(parameter.yOffset);
+
+    for (; i+2<=count; i+=2) {
+      v2df lon=_mm_setr_pd(GetBatchLon(coords[i]),GetBatchLon(coords[i+1]));
+      v2df lat=_mm_setr_pd(GetBatchLat(coords[i]),GetBatchLat(coords[i+1]));
+      v2df xs=_mm_sub_pd(_mm_mul_pd(lon,lonFactor),lonOffset);
+      v2df ys=_mm_add_pd(_mm_mul_pd(atanh_sin_pd(_mm_sub_pd(_mm_mul_pd(lat,latFactor),latOffset)),yFactor),yOffset);
+
+      _mm_storel_pd(GetStrided(x,i,stride),xs);
+      _mm_storeh_pd(GetStrided(x,i+1,stride),xs);
+      _mm_storel_pd(GetStrided(y,i,stride),ys);
+      _mm_storeh_pd(GetStrided(y,i+1,stride),ys);
+    }
+#endif
+
+    for (; i<count; i++) {
+      *GetStrided(x,i,stride)=GetBatchLon(coords[i])*parameter.lonFactor-parameter.lonOffset;
+      *GetStrided(y,i,stride)=atanh(sin(GetBatchLat(coords[i])*parameter.latFactor-parameter.latOffset))*parameter.yFactor+parameter.yOffset;
+    }
+  }
+
+#if defined(OSMSCOUT_HAVE_CPU_DISPATCH)
+
+  // Coefficients of the polynomial approximation of sin(x) on [-Pi/2,Pi/2]
+  // (see SINECOEFF_SSE)
+  static const double sineCoeff[] = {
+    -1.666666666666581208932767360735836413787e-1,
+     8.333333333262878969283334152712679345090e-3,
+    -1.984126982009420841621862535256836970687e-4,
+     2.755731607700772351872307094572902723297e-6,
+    -2.505185149701259571358956642584298321640e-8,
+     1.604730119668575379135607736724374349864e-10,
+    -7.364646450221048096686073152326538711869e-13
+  };
+
+  // Coefficients of the series atanh(t)=t+t^3/3+t^5/5+...
+  static const double atanhCoeff[] = {
+    1/3.0, 1/5.0, 1/7.0, 1/9.0, 1/11.0, 1/13.0
+  };
+
+  static const double sqrt2=1.4142135623730950488;
+  static const double ln2=0.6931471805599453094;
+
+  /**
+    atanh(sin(x)) for four values in [-Pi/2,Pi/2].
+
+    atanh(sin(x))=log(v)/2 with v=(1+sin(x))/(1-sin(x)). v is split into
+    m*2^e with m in [sqrt(2)/2,sqrt(2)[, so that log(v)/2=e*log(2)/2+atanh(t)
+    with t=(m-1)/(m+1) and |t|<0.172, where the series converges fast.
+    */
+  __attribute__((target("avx2,fma")))
+  static inline __m256d AtanhSinAVX2(__m256d x)
+  {
+    __m256d one=_mm256_set1_pd(1.0);
+    __m256d xx=_mm256_mul_pd(x,x);
+    __m256d p=_mm256_set1_pd(sineCoeff[6]);
+
+    for (int c=5; c>=0; c--) {
+      p=_mm256_fmadd_pd(p,xx,_mm256_set1_pd(sineCoeff[c]));
+    }
+
+    __m256d s=_mm256_fmadd_pd(_mm256_mul_pd(p,xx),x,x);
+    __m256d v=_mm256_div_pd(_mm256_add_pd(one,s),_mm256_sub_pd(one,s));
+
+    __m256i bits=_mm256_castpd_si256(v);
+    __m256d m=_mm256_castsi256_pd(_mm256_or_si256(_mm256_and_si256(bits,_mm256_set1_epi64x(0x000FFFFFFFFFFFFFLL)),
+                                                  _mm256_set1_epi64x(0x3FF0000000000000LL)));
+    // biased exponent to double by placing it into the mantissa of 2^52
+    __m256d e=_mm256_sub_pd(_mm256_castsi256_pd(_mm256_or_si256(_mm256_srli_epi64(bits,52),
+                                                                _mm256_set1_epi64x(0x4330000000000000LL))),
+                            _mm256_set1_pd(4503599627370496.0+1023.0));
+    __m256d big=_mm256_cmp_pd(m,_mm256_set1_pd(sqrt2),_CMP_GE_OQ);
+
+    m=_mm256_blendv_pd(m,_mm256_mul_pd(m,_mm256_set1_pd(0.5)),big);
+    e=_mm256_add_pd(e,_mm256_and_pd(big,one));
+
+    __m256d t=_mm256_div_pd(_mm256_sub_pd(m,one),_mm256_add_pd(m,one));
+    __m256d tt=_mm256_mul_pd(t,t);
+    __m256d q=_mm256_set1_pd(atanhCoeff[5]);
+
+    for (int c=4; c>=0; c--) {
+      q=_mm256_fmadd_pd(q,tt,_mm256_set1_pd(atanhCoeff[c]));
+    }
+
+    return _mm256_fmadd_pd(e,
+                           _mm256_set1_pd(ln2/2),
+                           _mm256_fmadd_pd(_mm256_mul_pd(q,tt),t,t));
+  }
+
+  __attribute__((target("avx2,fma")))
+  static void MercatorGeoToPixelAVX2(const MercatorBatchParameter& parameter,
+                                     const GeoCoord* coords,
+                                     size_t count,
+                                     double* x,
+                                     double* y,
+                                     size_t stride)
+  {
+    __m256d lonFactor=_mm256_set1_pd(parameter.lonFactor);
+    __m256d lonOffset=_mm256_set1_pd(parameter.lonOffset);
+    __m256d latFactor=_mm256_set1_pd(parameter.latFactor);
+    __m256d latOffset=_mm256_set1_pd(parameter.latOffset);
+    __m256d yFactor=_mm256_set1_pd(parameter.yFactor);
+    __m256d yOffset=_mm256_set1_pd(parameter.yOffset);
+    size_t  i=0;
+
+    for (; i+4<=count; i+=4) {
+      double lon[4];
+      double lat[4];
+      double xs[4];
+      double ys[4];
+
+      for (size_t j=0; j<4; j++) {
+        lon[j]=GetBatchLon(coords[i+j]);
+        lat[j]=GetBatchLat(coords[i+j]);
+      }
+
+      _mm256_storeu_pd(xs,_mm256_fmsub_pd(_mm256_loadu_pd(lon),lonFactor,lonOffset));
+      _mm256_storeu_pd(ys,_mm256_fmadd_pd(AtanhSinAVX2(_mm256_fmsub_pd(_mm256_loadu_pd(lat),latFactor,latOffset)),yFactor,yOffset));
+
+      for (size_t j=0; j<4; j++) {
+        *GetStrided(x,i+j,stride)=xs[j];
+        *GetStrided(y,i+j,stride)=ys[j];
+      }
+    }
+
+    MercatorGeoToPixel(parameter,
+                       coords+i,
+                       count-i,
+                       GetStrided(x,i,stride),
+                       GetStrided(y,i,stride),
+                       stride);
+  }
+
+  /**
+    AVX-512 variant of AtanhSinAVX2() for eight values
+    */
+  __attribute__((target("avx512f")))
+  static inline __m512d AtanhSinAVX512(__m512d x)
+  {
+    __m512d one=_mm512_set1_pd(1.0);
+    __m512d xx=_mm512_mul_pd(x,x);
+    __m512d p=_mm512_set1_pd(sineCoeff[6]);
+
+    for (int c=5; c>=0; c--) {
+      p=_mm512_fmadd_pd(p,xx,_mm512_set1_pd(sineCoeff[c]));
+    }
+
+    __m512d s=_mm512_fmadd_pd(_mm512_mul_pd(p,xx),x,x);
+    __m512d v=_mm512_div_pd(_mm512_add_pd(one,s),_mm512_sub_pd(one,s));
+
+    __m512i bits=_mm512_castpd_si512(v);
+    // _mm512_srli_epi64() passes an undefined vector through the (unused)
+    // write mask, which makes gcc warn, the zero masked variant does not
+    __m512i exponent=_mm512_maskz_srli_epi64((__mmask8)0xFF,bits,52);
+    __m512d m=_mm512_castsi512_pd(_mm512_or_si512(_mm512_and_si512(bits,_mm512_set1_epi64(0x000FFFFFFFFFFFFFLL)),
+                                                  _mm512_set1_epi64(0x3FF0000000000000LL)));
+    __m512d e=_mm512_sub_pd(_mm512_castsi512_pd(_mm512_or_si512(exponent,
+                                                                _mm512_set1_epi64(0x4330000000000000LL))),
+                            _mm512_set1_pd(4503599627370496.0+1023.0));
+    __mmask8 big=_mm512_cmp_pd_mask(m,_mm512_set1_pd(sqrt2),_CMP_GE_OQ);
+
+    m=_mm512_mask_mul_pd(m,big,m,_mm512_set1_pd(0.5));
+    e=_mm512_mask_add_pd(e,big,e,one);
+
+    __m512d t=_mm512_div_pd(_mm512_sub_pd(m,one),_mm512_add_pd(m,one));
+    __m512d tt=_mm512_mul_pd(t,t);
+    __m512d q=_mm512_set1_pd(atanhCoeff[5]);
+
+    for (int c=4; c>=0; c--) {
+      q=_mm512_fmadd_pd(q,tt,_mm512_set1_pd(atanhCoeff[c]));
+    }
+
+    return _mm512_fmadd_pd(e,
+                           _mm512_set1_pd(ln2/2),
+                           _mm512_fmadd_pd(_mm512_mul_pd(q,tt),t,t));
+  }
+
+  __attribute__((target("avx512f")))
+  static void MercatorGeoToPixelAVX512(const MercatorBatchParameter& parameter,
+                                       const GeoCoord* coords,
+                                       size_t count,
+                                       double* x,
+                                       double* y,
+                                       size_t stride)
+  {
+    __m512d lonFactor=_mm512_set1_pd(parameter.lonFactor);
+    __m512d lonOffset=_mm512_set1_pd(parameter.lonOffset);
+    __m512d latFactor=_mm512_set1_pd(parameter.latFactor);
+    __m512d latOffset=_mm512_set1_pd(parameter.latOffset);
+    __m512d yFactor=_mm512_set1_pd(parameter.yFactor);
+    __m512d yOffset=_mm512_set1_pd(parameter.yOffset);
+    size_t  i=0;
+
+    for (; i+8<=count; i+=8) {
+      double lon[8];
+      double lat[8];
+      double xs[8];
+      double ys[8];
+
+      for (size_t j=0; j<8; j++) {
+        lon[j]=GetBatchLon(coords[i+j]);
+        lat[j]=GetBatchLat(coords[i+j]);
+      }
+
+      _mm512_storeu_pd(xs,_mm512_fmsub_pd(_mm512_loadu_pd(lon),lonFactor,lonOffset));
+      _mm512_storeu_pd(ys,_mm512_fmadd_pd(AtanhSinAVX512(_mm512_fmsub_pd(_mm512_loadu_pd(lat),latFactor,latOffset)),yFactor,yOffset));
+
+      for (size_t j=0; j<8; j++) {
+        *GetStrided(x,i+j,stride)=xs[j];
+        *GetStrided(y,i+j,stride)=ys[j];
+      }
+    }
+
+    MercatorGeoToPixel(parameter,
+                       coords+i,
+                       count-i,
+                       GetStrided(x,i,stride),
+                       GetStrided(y,i,stride),
+                       stride);
+  }
+
+#endif
+
+  /**
+    Return the fastest batch transformation supported by the CPU
+    */
+  static MercatorBatchFunction GetMercatorBatchFunction()
+  {
+#if defined(OSMSCOUT_HAVE_CPU_DISPATCH)
+    __builtin_cpu_init();
+
+    if (__builtin_cpu_supports("avx512f")) {
+      return MercatorGeoToPixelAVX512;
+    }
+
+    if (__builtin_cpu_supports("avx2") &&
+        __builtin_cpu_supports("fma")) {
+      return MercatorGeoToPixelAVX2;
+    }
+#endif
+
+    return MercatorGeoToPixel;
+  }
+
+  static const MercatorBatchFunction mercatorBatchFunction=GetMercatorBatchFunction();
+
   Projection::~Projection()
   {
     // no code
   }
 
+  bool Projection::GeoToPixel(const GeoCoord* coords,
+                              size_t count,
+                              double* x,
+                              double* y,
+                              size_t stride) const
+  {
+    for (size_t i=0; i<count; i++) {
+      if (!GeoToPixel(coords[i].GetLon(),
+                      coords[i].GetLat(),
+                      *GetStrided(x,i,stride),
+                      *GetStrided(y,i,stride))) {
+        return false;
+      }
+    }
+
+    return true;
+  }
+
   MercatorProjection::MercatorProjection()
   : valid(false),
     lon(0),
@@ -267,6 +634,32 @@ namespace osmscout {
 
 #endif
 
+  bool MercatorProjection::GeoToPixel(const GeoCoord* coords,
+                                      size_t count,
+                                      double* x,
+                                      double* y,
+                                      size_t stride) const
+  {
+    assert(valid);
+
+    MercatorBatchParameter parameter;
+
+    InitializeBatchParameter(parameter,
+                             scaleGradtorad,
+                             lonOffset,
+                             -scale,
+                             height+latOffset);
+
+    mercatorBatchFunction(parameter,
+                          coords,
+                          count,
+                          x,
+                          y,
+                          stride);
+
+    return true;
+  }
+
   bool MercatorProjection::GetDimensions(double& lonMin, double& latMin,
                                          double& lonMax, double& latMax) const
   {
@@ -297,7 +690,33 @@ namespace osmscout {
         assert(valid);
 
         lon=(x+lonOffset)/(scale*gradtorad);
-        lat=atan(sinh((height-y+latOffset)/scale))/gradtorad;
+        lat=atan(sinh((y+latOffset)/scale))/gradtorad;
+
+        return true;
+    }
+
+    bool ReversedYAxisMercatorProjection::GeoToPixel(const GeoCoord* coords,
+                                                     size_t count,
+                                                     double* x,
+                                                     double* y,
+                                                     size_t stride) const
+    {
+        assert(valid);
+
+        MercatorBatchParameter parameter;
+
+        InitializeBatchParameter(parameter,
+                                 scaleGradtorad,
+                                 lonOffset,
+                                 scale,
+                                 -latOffset);
+
+        mercatorBatchFunction(parameter,
+                              coords,
+                              count,
+                              x,
+                              y,
+                              stride);
 
         return true;
     }
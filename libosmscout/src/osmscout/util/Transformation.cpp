@@ -156,11 +156,26 @@ namespace osmscout {
                                    optimizeErrorToleranceSquared);
   }
 
+  // Out codes of the clip region
+  static const unsigned int outLeft   = 1;
+  static const unsigned int outRight  = 2;
+  static const unsigned int outBottom = 4;
+  static const unsigned int outTop    = 8;
+
   TransPolygon::TransPolygon()
   : pointsSize(0),
     length(0),
     start(0),
     end(0),
+    clip(false),
+    clipLonMin(0.0),
+    clipLatMin(0.0),
+    clipLonMax(0.0),
+    clipLatMax(0.0),
+    clipLonMinX(0.0),
+    clipLonMaxX(0.0),
+    clipLatMinY(0.0),
+    clipLatMaxY(0.0),
     points(NULL)
   {
     // no code
@@ -171,21 +186,403 @@ namespace osmscout {
     delete [] points;
   }
 
+  unsigned int TransPolygon::GetOutCode(const GeoCoord& coord) const
+  {
+    unsigned int code=0;
+
+    if (coord.GetLon()<clipLonMin) {
+      code|=outLeft;
+    }
+    else if (coord.GetLon()>clipLonMax) {
+      code|=outRight;
+    }
+
+    if (coord.GetLat()<clipLatMin) {
+      code|=outBottom;
+    }
+    else if (coord.GetLat()>clipLatMax) {
+      code|=outTop;
+    }
+
+    return code;
+  }
+
+  /**
+    Liang-Barsky clipping of the segment a-b to the clip region. Returns
+    false, if the segment is completely outside, else the start and the end
+    of the visible part of the segment.
+
+    Since the segment is drawn as a straight line in pixel space, clipping
+    happens in pixel space. Segments, that are trivially invisible because
+    both ends are on the outer side of the same edge, are rejected without
+    transformation.
+    */
+  bool TransPolygon::ClipSegment(const Projection& projection,
+                                 const GeoCoord& a,
+                                 const GeoCoord& b,
+                                 unsigned int codeA,
+                                 unsigned int codeB,
+                                 GeoCoord& start,
+                                 GeoCoord& end) const
+  {
+    if ((codeA & codeB)!=0) {
+      return false;
+    }
+
+    double ax,ay;
+    double bx,by;
+
+    projection.GeoToPixel(a,ax,ay);
+    projection.GeoToPixel(b,bx,by);
+
+    double dx=bx-ax;
+    double dy=by-ay;
+    double p[4]={-dx,dx,-dy,dy};
+    double q[4]={ax-std::min(clipLonMinX,clipLonMaxX),
+                 std::max(clipLonMinX,clipLonMaxX)-ax,
+                 ay-std::min(clipLatMinY,clipLatMaxY),
+                 std::max(clipLatMinY,clipLatMaxY)-ay};
+    double t0=0.0;
+    double t1=1.0;
+
+    for (size_t i=0; i<4; i++) {
+      if (p[i]==0.0) {
+        if (q[i]<0.0) {
+          return false;
+        }
+      }
+      else {
+        double r=q[i]/p[i];
+
+        if (p[i]<0.0) {
+          if (r>t1) {
+            return false;
+          }
+
+          t0=std::max(t0,r);
+        }
+        else {
+          if (r<t0) {
+            return false;
+          }
+
+          t1=std::min(t1,r);
+        }
+      }
+    }
+
+    double lon,lat;
+
+    if (t0>0.0) {
+      projection.PixelToGeo(ax+t0*dx,ay+t0*dy,lon,lat);
+      start.Set(lat,lon);
+    }
+    else {
+      start=a;
+    }
+
+    if (t1<1.0) {
+      projection.PixelToGeo(ax+t1*dx,ay+t1*dy,lon,lat);
+      end.Set(lat,lon);
+    }
+    else {
+      end=b;
+    }
+
+    return true;
+  }
+
+  /**
+    One step of the Sutherland-Hodgman algorithm, clipping the polygon in
+    to the inner side of the given edge of the clip region. The
+    intersections with the edge are calculated in pixel space.
+    */
+  void TransPolygon::ClipAreaEdge(const Projection& projection,
+                                  const std::vector<GeoCoord>& in,
+                                  unsigned int edge,
+                                  std::vector<GeoCoord>& out) const
+  {
+    bool   isLon=edge==outLeft || edge==outRight;
+    double value;
+    double pixelValue;
+
+    switch (edge) {
+    case outLeft:
+      value=clipLonMin;
+      pixelValue=clipLonMinX;
+      break;
+    case outRight:
+      value=clipLonMax;
+      pixelValue=clipLonMaxX;
+      break;
+    case outBottom:
+      value=clipLatMin;
+      pixelValue=clipLatMinY;
+      break;
+    default:
+      value=clipLatMax;
+      pixelValue=clipLatMaxY;
+      break;
+    }
+
+    out.clear();
+
+    for (size_t i=0; i<in.size(); i++) {
+      const GeoCoord& prev=in[i==0 ? in.size()-1 : i-1];
+      const GeoCoord& current=in[i];
+      double          prevValue=isLon ? prev.GetLon() : prev.GetLat();
+      double          currentValue=isLon ? current.GetLon() : current.GetLat();
+      bool            prevInside;
+      bool            currentInside;
+
+      if (edge==outLeft || edge==outBottom) {
+        prevInside=prevValue>=value;
+        currentInside=currentValue>=value;
+      }
+      else {
+        prevInside=prevValue<=value;
+        currentInside=currentValue<=value;
+      }
+
+      if (prevInside!=currentInside) {
+        double px,py;
+        double cx,cy;
+        double lon,lat;
+
+        projection.GeoToPixel(prev,px,py);
+        projection.GeoToPixel(current,cx,cy);
+
+        if (isLon) {
+          double t=(pixelValue-px)/(cx-px);
+
+          projection.PixelToGeo(pixelValue,py+t*(cy-py),lon,lat);
+          out.push_back(GeoCoord(lat,value));
+        }
+        else {
+          double t=(pixelValue-py)/(cy-py);
+
+          projection.PixelToGeo(px+t*(cx-px),pixelValue,lon,lat);
+          out.push_back(GeoCoord(value,lon));
+        }
+      }
+
+      if (currentInside) {
+        out.push_back(current);
+      }
+    }
+  }
+
+  /**
+    Return the part of the area within the clip region. Returns the
+    given nodes unchanged, if they are completely within the clip region.
+    */
+  const std::vector<GeoCoord>& TransPolygon::ClipArea(const Projection& projection,
+                                                      const std::vector<GeoCoord>& nodes)
+  {
+    unsigned int allCodes=0;
+    unsigned int commonCodes=outLeft | outRight | outBottom | outTop;
+
+    for (size_t i=0; i<nodes.size(); i++) {
+      unsigned int code=GetOutCode(nodes[i]);
+
+      allCodes|=code;
+      commonCodes&=code;
+    }
+
+    if (allCodes==0) {
+      return nodes;
+    }
+
+    clipNodes.clear();
+
+    if (commonCodes!=0) {
+      // All nodes are on the outer side of the same edge
+      return clipNodes;
+    }
+
+    clipNodes.assign(nodes.begin(),nodes.end());
+
+    if (allCodes & outLeft) {
+      ClipAreaEdge(projection,clipNodes,outLeft,clipBuffer);
+      clipNodes.swap(clipBuffer);
+    }
+
+    if (allCodes & outRight) {
+      ClipAreaEdge(projection,clipNodes,outRight,clipBuffer);
+      clipNodes.swap(clipBuffer);
+    }
+
+    if (allCodes & outBottom) {
+      ClipAreaEdge(projection,clipNodes,outBottom,clipBuffer);
+      clipNodes.swap(clipBuffer);
+    }
+
+    if (allCodes & outTop) {
+      ClipAreaEdge(projection,clipNodes,outTop,clipBuffer);
+      clipNodes.swap(clipBuffer);
+    }
+
+    return clipNodes;
+  }
+
+  /**
+    Return the part of the way within the clip region. Returns the given
+    nodes unchanged, if they are completely within the clip region.
+    */
+  const std::vector<GeoCoord>& TransPolygon::ClipWay(const Projection& projection,
+                                                     const std::vector<GeoCoord>& nodes)
+  {
+    bool inside=true;
+
+    for (size_t i=0; i<nodes.size(); i++) {
+      if (GetOutCode(nodes[i])!=0) {
+        inside=false;
+        break;
+      }
+    }
+
+    if (inside) {
+      return nodes;
+    }
+
+    clipNodes.clear();
+
+    // Find the first and the last visible segment
+    size_t   first=nodes.size();
+    size_t   last;
+    GeoCoord start;
+    GeoCoord end;
+    GeoCoord lastStart;
+
+    for (size_t i=0; i+1<nodes.size(); i++) {
+      if (ClipSegment(projection,
+                      nodes[i],nodes[i+1],
+                      GetOutCode(nodes[i]),GetOutCode(nodes[i+1]),
+                      start,end)) {
+        first=i;
+        break;
+      }
+    }
+
+    if (first>=nodes.size()) {
+      return clipNodes;
+    }
+
+    last=first;
+
+    for (size_t i=nodes.size()-1; i>first+1; i--) {
+      if (ClipSegment(projection,
+                      nodes[i-1],nodes[i],
+                      GetOutCode(nodes[i-1]),GetOutCode(nodes[i]),
+                      lastStart,end)) {
+        last=i-1;
+        break;
+      }
+    }
+
+    clipNodes.push_back(start);
+
+    // Nodes between the two clipped end points. A node can be dropped, if it
+    // and all nodes since the last node kept and its successor are on the
+    // outer side of the same edge, since then the shortcut is invisible, too.
+    unsigned int runCodes=0;
+
+    for (size_t i=first+1; i<=last; i++) {
+      unsigned int code=GetOutCode(nodes[i]);
+      unsigned int nextCode=i<last ? GetOutCode(nodes[i+1]) : 0;
+
+      if ((runCodes & code & nextCode)!=0) {
+        runCodes&=code;
+      }
+      else {
+        clipNodes.push_back(nodes[i]);
+        runCodes=code;
+      }
+    }
+
+    clipNodes.push_back(end);
+
+    return clipNodes;
+  }
+
+  /**
+    Clip all following transformations to the region covered by the
+    projection, extended by the given margin in pixel on each side. The
+    margin should be large enough to hide line caps and borders drawn at
+    the clipped ends. Transformations must use the same projection.
+
+    Nodes are classified in geo coordinates, so the projection must map
+    lines of constant longitude and latitude to vertical and horizontal
+    lines (like the MercatorProjection).
+    */
+  bool TransPolygon::SetClipRegion(const Projection& projection,
+                                   double margin)
+  {
+    double x1=-margin;
+    double y1=-margin;
+    double x2=projection.GetWidth()+margin;
+    double y2=projection.GetHeight()+margin;
+    double lon1,lat1;
+    double lon2,lat2;
+
+    if (!projection.PixelToGeo(x1,y1,lon1,lat1) ||
+        !projection.PixelToGeo(x2,y2,lon2,lat2)) {
+      clip=false;
+
+      return false;
+    }
+
+    clip=true;
+
+    if (lon1<=lon2) {
+      clipLonMin=lon1;
+      clipLonMinX=x1;
+      clipLonMax=lon2;
+      clipLonMaxX=x2;
+    }
+    else {
+      clipLonMin=lon2;
+      clipLonMinX=x2;
+      clipLonMax=lon1;
+      clipLonMaxX=x1;
+    }
+
+    if (lat1<=lat2) {
+      clipLatMin=lat1;
+      clipLatMinY=y1;
+      clipLatMax=lat2;
+      clipLatMaxY=y2;
+    }
+    else {
+      clipLatMin=lat2;
+      clipLatMinY=y2;
+      clipLatMax=lat1;
+      clipLatMaxY=y1;
+    }
+
+    return true;
+  }
+
+  void TransPolygon::ClearClipRegion()
+  {
+    clip=false;
+  }
+
   void TransPolygon::TransformGeoToPixel(const Projection& projection,
                                          const std::vector<GeoCoord>& nodes)
   {
-    Projection::BatchTransformer batchTransformer(projection);
-
     if (!nodes.empty()) {
       start=0;
       length=nodes.size();
       end=length-1;
 
+      projection.GeoToPixel(&nodes[0],
+                            nodes.size(),
+                            &points[0].x,
+                            &points[0].y,
+                            sizeof(TransPoint));
+
       for (size_t i=start; i<=end; i++) {
-         batchTransformer.GeoToPixel(nodes[i].GetLon(),
-                                     nodes[i].GetLat(),
-                                     points[i].x,
-                                     points[i].y);
         points[i].draw=true;
       }
     }
@@ -340,9 +737,11 @@ namespace osmscout {
 
   void TransPolygon::TransformArea(const Projection& projection,
                                    OptimizeMethod optimize,
-                                   const std::vector<GeoCoord>& nodes,
+                                   const std::vector<GeoCoord>& areaNodes,
                                    double optimizeErrorTolerance)
   {
+    const std::vector<GeoCoord>& nodes=clip ? ClipArea(projection,areaNodes) : areaNodes;
+
     if (nodes.size()<2) {
       length=0;
 
@@ -394,9 +793,11 @@ namespace osmscout {
 
   void TransPolygon::TransformWay(const Projection& projection,
                                   OptimizeMethod optimize,
-                                  const std::vector<GeoCoord>& nodes,
+                                  const std::vector<GeoCoord>& wayNodes,
                                   double optimizeErrorTolerance)
   {
+    const std::vector<GeoCoord>& nodes=clip ? ClipWay(projection,wayNodes) : wayNodes;
+
     if (nodes.empty()) {
       length=0;
 
@@ -516,7 +917,7 @@ namespace osmscout {
     buffer->Reset();
   }
 
-  void TransBuffer::TransformArea(const Projection& projection,
+  bool TransBuffer::TransformArea(const Projection& projection,
                                   TransPolygon::OptimizeMethod optimize,
                                   const std::vector<GeoCoord>& nodes,
                                   size_t& start, size_t &end,
@@ -527,7 +928,10 @@ namespace osmscout {
                                nodes,
                                optimizeErrorTolerance);
 
-    assert(!transPolygon.IsEmpty());
+    // Only possible, if the area is clipped away
+    if (transPolygon.IsEmpty()) {
+      return false;
+    }
 
     bool isStart=true;
     for (size_t i=transPolygon.GetStart(); i<=transPolygon.GetEnd(); i++) {
@@ -541,6 +945,8 @@ namespace osmscout {
         }
       }
     }
+
+    return true;
   }
 
   bool TransBuffer::TransformWay(const Projection& projection,
@@ -0,0 +1,215 @@
+#include <iostream>
+#include <vector>
+
+#include <osmscout/util/CoordEncoding.h>
+#include <osmscout/util/FileScanner.h>
+#include <osmscout/util/FileWriter.h>
+
+#include <osmscout/system/Math.h>
+
+int errors=0;
+
+static uint32_t seed=4711;
+
+uint32_t NextRandom()
+{
+  seed=seed*1103515245+12345;
+
+  return seed >> 8;
+}
+
+/**
+  Return the coordinate as it is returned after quantization
+  */
+osmscout::GeoCoord Quantize(const osmscout::GeoCoord& coord)
+{
+  uint32_t latValue=(uint32_t)floor((coord.GetLat()+90.0)*osmscout::conversionFactor+0.5);
+  uint32_t lonValue=(uint32_t)floor((coord.GetLon()+180.0)*osmscout::conversionFactor+0.5);
+
+  return osmscout::GeoCoord(latValue/osmscout::conversionFactor-90.0,
+                            lonValue/osmscout::conversionFactor-180.0);
+}
+
+/**
+  Coordinates with small steps and some large jumps (including jumps
+  between both ends of the value range)
+  */
+std::vector<osmscout::GeoCoord> CreateCoords(size_t count)
+{
+  std::vector<osmscout::GeoCoord> coords;
+  double                          lat=(NextRandom()%1800000)/10000.0-90.0;
+  double                          lon=(NextRandom()%3600000)/10000.0-180.0;
+
+  for (size_t i=0; i<count; i++) {
+    switch (NextRandom()%8) {
+    case 0:
+      lat=-90.0;
+      lon=180.0;
+      break;
+    case 1:
+      lat=90.0;
+      lon=-180.0;
+      break;
+    case 2:
+      lat=(NextRandom()%1800000)/10000.0-90.0;
+      lon=(NextRandom()%3600000)/10000.0-180.0;
+      break;
+    default:
+      lat=std::max(-90.0,std::min(90.0,lat+((int)(NextRandom()%2001)-1000)/10000000.0));
+      lon=std::max(-180.0,std::min(180.0,lon+((int)(NextRandom()%200001)-100000)/10000000.0));
+      break;
+    }
+
+    coords.push_back(osmscout::GeoCoord(lat,lon));
+  }
+
+  return coords;
+}
+
+bool Compare(const std::vector<osmscout::GeoCoord>& expected,
+             const std::vector<osmscout::GeoCoord>& actual)
+{
+  if (expected.size()!=actual.size()) {
+    std::cerr << "Expected " << expected.size() << " coordinates, actual " << actual.size() << std::endl;
+    return false;
+  }
+
+  for (size_t i=0; i<expected.size(); i++) {
+    osmscout::GeoCoord coord=Quantize(expected[i]);
+
+    if (coord.GetLat()!=actual[i].GetLat() ||
+        coord.GetLon()!=actual[i].GetLon()) {
+      std::cerr << "Coordinate " << i << " of " << expected.size() << ": expected " << coord.GetLat() << "," << coord.GetLon() << " actual " << actual[i].GetLat() << "," << actual[i].GetLon() << std::endl;
+      return false;
+    }
+  }
+
+  return true;
+}
+
+int main()
+{
+  std::vector<std::vector<osmscout::GeoCoord> > sequences;
+
+  for (size_t count=1; count<=40; count++) {
+    sequences.push_back(CreateCoords(count));
+  }
+
+  sequences.push_back(CreateCoords(10000));
+
+  // Buffer based encoding and decoding
+
+  for (size_t s=0; s<sequences.size(); s++) {
+    std::vector<unsigned char>      buffer;
+    std::vector<osmscout::GeoCoord> coords;
+    size_t                          count=sequences[s].size();
+
+    osmscout::EncodeCoords(sequences[s],buffer);
+
+    uint32_t latValue=buffer[0] | buffer[1] << 8 | buffer[2] << 16 | (uint32_t)buffer[3] << 24;
+    uint32_t lonValue=buffer[4] | buffer[5] << 8 | buffer[6] << 16 | (uint32_t)buffer[7] << 24;
+
+    if (!(latValue & osmscout::coordDeltaEncodingFlag)) {
+      std::cerr << "Encoding flag not set" << std::endl;
+      errors++;
+      continue;
+    }
+
+    size_t controlSize=osmscout::GetCoordDeltaControlSize(count);
+    size_t dataSize=osmscout::GetCoordDeltaDataSize(&buffer[8],count);
+
+    if (8+controlSize+dataSize!=buffer.size()) {
+      std::cerr << "Expected " << buffer.size() << " bytes, calculated " << 8+controlSize+dataSize << std::endl;
+      errors++;
+      continue;
+    }
+
+    buffer.resize(buffer.size()+osmscout::coordDeltaPadding,0);
+
+    osmscout::DecodeCoordDeltas(latValue & ~osmscout::coordDeltaEncodingFlag,
+                                lonValue,
+                                &buffer[8],
+                                &buffer[8+controlSize],
+                                count,
+                                coords);
+
+    if (!Compare(sequences[s],coords)) {
+      errors++;
+    }
+  }
+
+  // Reading from file, including the older encoding
+
+  osmscout::FileWriter writer;
+
+  if (writer.Open("coords.dat")) {
+    writer.SetCoordDeltaEncoding(true);
+
+    for (size_t s=0; s<sequences.size(); s++) {
+      writer.WriteCoords(sequences[s]);
+    }
+
+    writer.SetCoordDeltaEncoding(false);
+
+    for (size_t s=0; s<sequences.size(); s++) {
+      writer.WriteCoords(sequences[s]);
+    }
+
+    uint32_t minLat=(uint32_t)floor((sequences[2][0].GetLat()+90.0)*osmscout::conversionFactor+0.5);
+    uint32_t minLon=(uint32_t)floor((sequences[2][0].GetLon()+180.0)*osmscout::conversionFactor+0.5);
+
+    for (size_t i=1; i<sequences[2].size(); i++) {
+      minLat=std::min(minLat,(uint32_t)floor((sequences[2][i].GetLat()+90.0)*osmscout::conversionFactor+0.5));
+      minLon=std::min(minLon,(uint32_t)floor((sequences[2][i].GetLon()+180.0)*osmscout::conversionFactor+0.5));
+    }
+
+    writer.Write(minLat);
+    writer.Write(minLon);
+
+    for (size_t i=0; i<sequences[2].size(); i++) {
+      writer.WriteNumber((uint32_t)floor((sequences[2][i].GetLat()+90.0)*osmscout::conversionFactor+0.5)-minLat);
+      writer.WriteNumber((uint32_t)floor((sequences[2][i].GetLon()+180.0)*osmscout::conversionFactor+0.5)-minLon);
+    }
+
+    writer.Close();
+  }
+  else {
+    std::cerr << "Cannot create 'coords.dat'" << std::endl;
+    errors++;
+  }
+
+  for (size_t mmap=0; mmap<=1; mmap++) {
+    osmscout::FileScanner scanner;
+
+    if (!scanner.Open("coords.dat",osmscout::FileScanner::Sequential,mmap==1)) {
+      std::cerr << "Cannot open 'coords.dat'" << std::endl;
+      errors++;
+      continue;
+    }
+
+    for (size_t s=0; s<2*sequences.size(); s++) {
+      std::vector<osmscout::GeoCoord> coords;
+
+      if (!scanner.ReadCoords(sequences[s%sequences.size()].size(),coords) ||
+          !Compare(sequences[s%sequences.size()],coords)) {
+        errors++;
+      }
+    }
+
+    std::vector<osmscout::GeoCoord> coords;
+
+    if (!scanner.ReadCoords(sequences[2].size(),coords) ||
+        !Compare(sequences[2],coords)) {
+      errors++;
+    }
+
+    scanner.Close();
+  }
+
+  if (errors!=0) {
+    return 1;
+  }
+  else {
+    return 0;
+  }
+}
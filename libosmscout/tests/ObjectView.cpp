@@ -0,0 +1,304 @@
+#include <cmath>
+#include <cstring>
+#include <iostream>
+
+#include <osmscout/Area.h>
+#include <osmscout/ObjectView.h>
+#include <osmscout/TypeConfig.h>
+#include <osmscout/Way.h>
+
+#include <osmscout/util/FileScanner.h>
+#include <osmscout/util/FileWriter.h>
+#include <osmscout/util/Progress.h>
+
+int errors=0;
+
+void Check(bool condition,
+           const char* message)
+{
+  if (!condition) {
+    std::cerr << "Check failed: " << message << std::endl;
+    errors++;
+  }
+}
+
+bool Equals(const std::vector<osmscout::GeoCoord>& a,
+            const std::vector<osmscout::GeoCoord>& b)
+{
+  if (a.size()!=b.size()) {
+    return false;
+  }
+
+  for (size_t i=0; i<a.size(); i++) {
+    if (a[i].GetLat()!=b[i].GetLat() ||
+        a[i].GetLon()!=b[i].GetLon()) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+bool Equals(const std::vector<osmscout::Tag>& a,
+            const std::vector<osmscout::Tag>& b)
+{
+  if (a.size()!=b.size()) {
+    return false;
+  }
+
+  for (size_t i=0; i<a.size(); i++) {
+    if (a[i].key!=b[i].key ||
+        a[i].value!=b[i].value) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+void CheckWay(const osmscout::Way& way,
+              const osmscout::WayView& view,
+              bool optimized)
+{
+  std::vector<osmscout::GeoCoord> nodes;
+  std::vector<osmscout::Id>       ids;
+  std::vector<osmscout::Tag>      tags;
+
+  Check(view.GetType()==way.GetType(),"Way type");
+  Check(view.GetFlags()==way.GetAttributes().GetFlags(),"Way flags");
+  Check(way.GetName()==view.GetName(),"Way name");
+  Check(way.GetRefName()==view.GetRefName(),"Way ref");
+  Check(way.GetAttributes().GetLocation()==view.GetLocation(),"Way location");
+  Check(view.GetLayer()==way.GetLayer(),"Way layer");
+  Check(view.GetMaxSpeed()==way.GetMaxSpeed(),"Way max speed");
+  Check(view.GetGrade()==way.GetGrade(),"Way grade");
+  Check(view.IsBridge()==way.IsBridge(),"Way bridge");
+
+  Check(view.GetTags(tags),"Way tags decoding");
+  Check(Equals(tags,way.GetAttributes().GetTags()),"Way tags");
+
+  Check(view.GetNodeCount()==way.nodes.size(),"Way node count");
+  Check(view.GetNodes(nodes),"Way nodes decoding");
+  Check(Equals(nodes,way.nodes),"Way nodes");
+
+  Check(view.GetIds(ids),"Way ids decoding");
+  Check(optimized ? ids.empty() : ids==way.ids,"Way ids");
+
+  double minLon,maxLon,minLat,maxLat;
+  double viewMinLon,viewMaxLon,viewMinLat,viewMaxLat;
+
+  way.GetBoundingBox(minLon,maxLon,minLat,maxLat);
+  Check(view.GetBoundingBox(viewMinLon,viewMaxLon,viewMinLat,viewMaxLat),"Way bounding box decoding");
+  Check(minLon==viewMinLon && maxLon==viewMaxLon &&
+        minLat==viewMinLat && maxLat==viewMaxLat,"Way bounding box");
+}
+
+void CheckArea(const osmscout::Area& area,
+               const osmscout::AreaView& view,
+               bool optimized)
+{
+  std::vector<osmscout::AreaRingView> rings;
+
+  Check(view.GetType()==area.GetType(),"Area type");
+  Check(view.IsSimple()==area.IsSimple(),"Area simple");
+  Check(view.GetRingCount()==area.rings.size(),"Area ring count");
+  Check(view.GetRings(rings),"Area rings decoding");
+
+  if (rings.size()!=area.rings.size()) {
+    Check(false,"Area rings");
+    return;
+  }
+
+  for (size_t r=0; r<rings.size(); r++) {
+    std::vector<osmscout::GeoCoord> nodes;
+    std::vector<osmscout::Id>       ids;
+    std::vector<osmscout::Tag>      tags;
+
+    Check(rings[r].GetType()==area.rings[r].GetType(),"Ring type");
+    Check(rings[r].GetRing()==area.rings[r].ring,"Ring ring");
+    Check(area.rings[r].GetName()==rings[r].GetName(),"Ring name");
+
+    Check(rings[r].GetTags(tags),"Ring tags decoding");
+    Check(Equals(tags,area.rings[r].GetAttributes().GetTags()),"Ring tags");
+
+    Check(rings[r].GetNodes(nodes),"Ring nodes decoding");
+    Check(Equals(nodes,area.rings[r].nodes),"Ring nodes");
+
+    Check(rings[r].GetIds(ids),"Ring ids decoding");
+    Check(optimized ? ids.empty() : ids==area.rings[r].ids,"Ring ids");
+  }
+}
+
+int main()
+{
+  osmscout::TypeConfig     typeConfig;
+  osmscout::SilentProgress progress;
+  osmscout::TypeInfo       highway;
+  osmscout::TypeInfo       building;
+
+  typeConfig.RegisterNameTag("name",1);
+  typeConfig.RegisterTagForExternalUse("note");
+
+  highway.SetType("highway_primary").CanBeWay(true);
+  building.SetType("building").CanBeArea(true);
+
+  typeConfig.AddTypeInfo(highway);
+  typeConfig.AddTypeInfo(building);
+
+  osmscout::Way                 way;
+  std::vector<osmscout::Tag>    wayTags;
+
+  wayTags.push_back(osmscout::Tag(typeConfig.GetTagId("name"),"Main Street"));
+  wayTags.push_back(osmscout::Tag(typeConfig.tagRef,"B 1"));
+  wayTags.push_back(osmscout::Tag(typeConfig.tagLayer,"2"));
+  wayTags.push_back(osmscout::Tag(typeConfig.tagBridge,"yes"));
+  wayTags.push_back(osmscout::Tag(typeConfig.tagMaxSpeed,"50"));
+  wayTags.push_back(osmscout::Tag(typeConfig.GetTagId("note"),"Test"));
+
+  way.SetType(typeConfig.GetTypeId("highway_primary"));
+  way.SetTags(progress,typeConfig,1,wayTags);
+
+  for (size_t i=0; i<5; i++) {
+    way.nodes.push_back(osmscout::GeoCoord(51.5+i*0.001,7.4-i*0.002));
+    way.ids.push_back(i==2 ? 0 : 1000+i);
+  }
+
+  osmscout::Area                area;
+  osmscout::Area::Ring          master;
+  osmscout::Area::Ring          outer;
+  osmscout::Area::Ring          inner;
+  std::vector<osmscout::Tag>    areaTags;
+
+  areaTags.push_back(osmscout::Tag(typeConfig.GetTagId("name"),"Town Hall"));
+  areaTags.push_back(osmscout::Tag(typeConfig.GetTagId("note"),"Test"));
+
+  master.SetType(typeConfig.GetTypeId("building"));
+  master.attributes.SetTags(progress,typeConfig,areaTags);
+  master.ring=osmscout::Area::masterRingId;
+
+  outer.SetType(typeConfig.GetTypeId("building"));
+  outer.ring=osmscout::Area::outerRingId;
+
+  inner.SetType(osmscout::typeIgnore);
+  inner.ring=osmscout::Area::outerRingId+1;
+
+  for (size_t i=0; i<4; i++) {
+    outer.nodes.push_back(osmscout::GeoCoord(51.5+(i/2)*0.01,7.4+((i+1)/2%2)*0.01));
+    outer.ids.push_back(2000+i);
+    inner.nodes.push_back(osmscout::GeoCoord(51.502+(i/2)*0.001,7.402+((i+1)/2%2)*0.001));
+    inner.ids.push_back(3000+i);
+  }
+
+  area.rings.push_back(master);
+  area.rings.push_back(outer);
+  area.rings.push_back(inner);
+
+  osmscout::FileWriter writer;
+  osmscout::FileOffset wayOffset;
+  osmscout::FileOffset wayOptOffset;
+  osmscout::FileOffset areaOffset;
+  osmscout::FileOffset areaOptOffset;
+  osmscout::FileOffset wayDeltaOffset;
+  osmscout::FileOffset areaDeltaOffset;
+
+  if (!writer.Open("objectview.dat")) {
+    std::cerr << "Cannot create test file!" << std::endl;
+    return 1;
+  }
+
+  writer.GetPos(wayOffset);
+  way.Write(writer);
+  writer.GetPos(wayOptOffset);
+  way.WriteOptimized(writer);
+  writer.GetPos(areaOffset);
+  area.Write(writer);
+  writer.GetPos(areaOptOffset);
+  area.WriteOptimized(writer);
+
+  // The same objects with delta encoded nodes
+  writer.SetCoordDeltaEncoding(true);
+
+  writer.GetPos(wayDeltaOffset);
+  way.Write(writer);
+  writer.GetPos(areaDeltaOffset);
+  area.Write(writer);
+
+  if (!writer.Close()) {
+    std::cerr << "Cannot write test file!" << std::endl;
+    return 1;
+  }
+
+  osmscout::FileScanner scanner;
+  osmscout::Way         readWay;
+  osmscout::Way         readWayOpt;
+  osmscout::Area        readArea;
+  osmscout::Area        readAreaOpt;
+  osmscout::Way         readWayDelta;
+  osmscout::Area        readAreaDelta;
+
+  if (!scanner.Open("objectview.dat",osmscout::FileScanner::Normal,true) ||
+      scanner.GetMappedBuffer()==NULL) {
+    std::cerr << "Cannot map test file!" << std::endl;
+    return 1;
+  }
+
+  scanner.SetPos(wayOffset);
+  readWay.Read(scanner);
+  scanner.SetPos(wayOptOffset);
+  readWayOpt.ReadOptimized(scanner);
+  scanner.SetPos(areaOffset);
+  readArea.Read(scanner);
+  scanner.SetPos(areaOptOffset);
+  readAreaOpt.ReadOptimized(scanner);
+  scanner.SetPos(wayDeltaOffset);
+  readWayDelta.Read(scanner);
+  scanner.SetPos(areaDeltaOffset);
+  readAreaDelta.Read(scanner);
+
+  Check(!scanner.HasError(),"Reading objects");
+
+  const char* buffer=scanner.GetMappedBuffer();
+  osmscout::FileOffset size=scanner.GetSize();
+
+  osmscout::WayView  wayView;
+  osmscout::WayView  wayOptView;
+  osmscout::AreaView areaView;
+  osmscout::AreaView areaOptView;
+  osmscout::WayView  wayDeltaView;
+  osmscout::AreaView areaDeltaView;
+
+  Check(wayView.Read(buffer,size,wayOffset),"WayView::Read");
+  Check(wayOptView.ReadOptimized(buffer,size,wayOptOffset),"WayView::ReadOptimized");
+  Check(areaView.Read(buffer,size,areaOffset),"AreaView::Read");
+  Check(areaOptView.ReadOptimized(buffer,size,areaOptOffset),"AreaView::ReadOptimized");
+  Check(wayDeltaView.Read(buffer,size,wayDeltaOffset),"WayView::Read delta encoded");
+  Check(areaDeltaView.Read(buffer,size,areaDeltaOffset),"AreaView::Read delta encoded");
+
+  CheckWay(readWay,wayView,false);
+  CheckWay(readWayOpt,wayOptView,true);
+  CheckArea(readArea,areaView,false);
+  CheckArea(readAreaOpt,areaOptView,true);
+  CheckWay(readWayDelta,wayDeltaView,false);
+  CheckArea(readAreaDelta,areaDeltaView,false);
+
+  Check(Equals(readWayDelta.nodes,readWay.nodes),"Delta encoded way nodes");
+
+  Check(wayView.GetFileOffset()==wayOffset,"Way file offset");
+  Check(areaView.GetFileOffset()==areaOffset,"Area file offset");
+  Check(strcmp(wayView.GetName(),"Main Street")==0,"Way name value");
+  Check(strcmp(areaView.GetMasterRing().GetName(),"Town Hall")==0,"Area name value");
+
+  // Data truncated in the middle of the way must be detected
+  osmscout::WayView truncatedView;
+
+  Check(!truncatedView.Read(buffer,wayOffset+4,wayOffset),"Truncated way");
+
+  scanner.Close();
+
+  if (errors!=0) {
+    return 1;
+  }
+  else {
+    return 0;
+  }
+}
@@ -0,0 +1,141 @@
+#include <iostream>
+#include <vector>
+
+#include <osmscout/util/Projection.h>
+
+#include <osmscout/system/Math.h>
+
+int errors=0;
+
+static uint32_t seed=4711;
+
+uint32_t NextRandom()
+{
+  seed=seed*1103515245+12345;
+
+  return seed >> 8;
+}
+
+struct Result
+{
+  bool   flag;
+  double x;
+  double y;
+};
+
+/**
+  Coordinates around the given center and some spread over the world
+  */
+std::vector<osmscout::GeoCoord> CreateCoords(double lat,
+                                             double lon,
+                                             size_t count)
+{
+  std::vector<osmscout::GeoCoord> coords;
+
+  for (size_t i=0; i<count; i++) {
+    if (NextRandom()%4==0) {
+      coords.push_back(osmscout::GeoCoord((NextRandom()%1700000)/10000.0-85.0,
+                                          (NextRandom()%3600000)/10000.0-180.0));
+    }
+    else {
+      coords.push_back(osmscout::GeoCoord(lat+((int)(NextRandom()%20001)-10000)/1000000.0,
+                                          lon+((int)(NextRandom()%20001)-10000)/1000000.0));
+    }
+  }
+
+  return coords;
+}
+
+void Check(const osmscout::Projection& projection,
+           const std::vector<osmscout::GeoCoord>& coords)
+{
+  std::vector<Result> results(coords.size()+1);
+
+  for (size_t i=0; i<results.size(); i++) {
+    results[i].flag=true;
+  }
+
+  if (!projection.GeoToPixel(coords.empty() ? NULL : &coords[0],
+                             coords.size(),
+                             &results[0].x,
+                             &results[0].y,
+                             sizeof(Result))) {
+    std::cerr << "Batch transformation of " << coords.size() << " coordinates failed" << std::endl;
+    errors++;
+    return;
+  }
+
+  for (size_t i=0; i<coords.size(); i++) {
+    double x;
+    double y;
+
+    projection.GeoToPixel(coords[i].GetLon(),
+                          coords[i].GetLat(),
+                          x,
+                          y);
+
+    if (fabs(x-results[i].x)>0.05 ||
+        fabs(y-results[i].y)>0.05 ||
+        !results[i].flag) {
+      std::cerr << "Coordinate " << i << " of " << coords.size() << " (" << coords[i].GetLat() << "," << coords[i].GetLon() << "): expected " << x << "," << y << " actual " << results[i].x << "," << results[i].y << std::endl;
+      errors++;
+      return;
+    }
+
+    double coordX;
+    double coordY;
+
+    projection.GeoToPixel(coords[i],
+                          coordX,
+                          coordY);
+
+    if (fabs(x-coordX)>0.05 ||
+        fabs(y-coordY)>0.05) {
+      std::cerr << "Coordinate " << i << " (" << coords[i].GetLat() << "," << coords[i].GetLon() << "): expected " << x << "," << y << " actual " << coordX << "," << coordY << std::endl;
+      errors++;
+      return;
+    }
+  }
+
+  if (!results[coords.size()].flag) {
+    std::cerr << "Batch transformation of " << coords.size() << " coordinates wrote behind the end" << std::endl;
+    errors++;
+  }
+}
+
+int main()
+{
+  uint32_t levels[]={4,12,20};
+
+  for (size_t l=0; l<3; l++) {
+    osmscout::MercatorProjection              projection;
+    osmscout::ReversedYAxisMercatorProjection reversedProjection;
+    osmscout::Magnification                   magnification;
+    double                                    lat=51.57;
+    double                                    lon=7.46;
+
+    magnification.SetLevel(levels[l]);
+
+    projection.Set(lon,lat,magnification,800,600);
+    reversedProjection.Set(lon,lat,magnification,800,600);
+
+    for (size_t count=0; count<=20; count++) {
+      std::vector<osmscout::GeoCoord> coords=CreateCoords(lat,lon,count);
+
+      Check(projection,coords);
+      Check(reversedProjection,coords);
+    }
+
+    std::vector<osmscout::GeoCoord> coords=CreateCoords(lat,lon,10000);
+
+    Check(projection,coords);
+    Check(reversedProjection,coords);
+  }
+
+  if (errors!=0) {
+    return 1;
+  }
+  else {
+    return 0;
+  }
+}
@@ -0,0 +1,316 @@
+#include <iostream>
+#include <vector>
+
+#include <osmscout/util/Projection.h>
+#include <osmscout/util/Transformation.h>
+
+#include <osmscout/system/Math.h>
+
+int errors=0;
+
+static uint32_t seed=4711;
+
+uint32_t NextRandom()
+{
+  seed=seed*1103515245+12345;
+
+  return seed >> 8;
+}
+
+struct Point
+{
+  double x;
+  double y;
+
+  Point(double x, double y)
+  : x(x),
+    y(y)
+  {
+    // no code
+  }
+};
+
+/**
+  Coordinates around the given center, covering a region a multiple of the
+  size of the visible region
+  */
+std::vector<osmscout::GeoCoord> CreateCoords(double lat,
+                                             double lon,
+                                             double spread,
+                                             size_t count)
+{
+  std::vector<osmscout::GeoCoord> coords;
+
+  for (size_t i=0; i<count; i++) {
+    coords.push_back(osmscout::GeoCoord(lat+((int)(NextRandom()%20001)-10000)*spread/10000.0,
+                                        lon+((int)(NextRandom()%20001)-10000)*spread/10000.0));
+  }
+
+  return coords;
+}
+
+std::vector<Point> GetPoints(const osmscout::TransPolygon& polygon)
+{
+  std::vector<Point> points;
+
+  if (polygon.IsEmpty()) {
+    return points;
+  }
+
+  for (size_t i=polygon.GetStart(); i<=polygon.GetEnd(); i++) {
+    if (polygon.points[i].draw) {
+      points.push_back(Point(polygon.points[i].x,
+                             polygon.points[i].y));
+    }
+  }
+
+  return points;
+}
+
+/**
+  Length of the part of the path within the given rectangle
+  */
+double GetVisibleLength(const std::vector<Point>& points,
+                        double width,
+                        double height)
+{
+  double length=0.0;
+
+  for (size_t i=0; i+1<points.size(); i++) {
+    const Point& a=points[i];
+    const Point& b=points[i+1];
+    double       dx=b.x-a.x;
+    double       dy=b.y-a.y;
+    double       p[4]={-dx,dx,-dy,dy};
+    double       q[4]={a.x,width-a.x,a.y,height-a.y};
+    double       t0=0.0;
+    double       t1=1.0;
+    bool         visible=true;
+
+    for (size_t j=0; j<4 && visible; j++) {
+      if (p[j]==0.0) {
+        visible=q[j]>=0.0;
+      }
+      else if (p[j]<0.0) {
+        t0=std::max(t0,q[j]/p[j]);
+      }
+      else {
+        t1=std::min(t1,q[j]/p[j]);
+      }
+    }
+
+    if (visible && t0<t1) {
+      length+=(t1-t0)*sqrt(dx*dx+dy*dy);
+    }
+  }
+
+  return length;
+}
+
+/**
+  Area of the part of the polygon within the given rectangle
+  */
+double GetVisibleArea(const std::vector<Point>& points,
+                      double width,
+                      double height)
+{
+  std::vector<Point> polygon(points);
+
+  for (size_t edge=0; edge<4; edge++) {
+    std::vector<Point> clipped;
+
+    for (size_t i=0; i<polygon.size(); i++) {
+      const Point& prev=polygon[i==0 ? polygon.size()-1 : i-1];
+      const Point& current=polygon[i];
+      double       prevValue=edge<2 ? prev.x : prev.y;
+      double       currentValue=edge<2 ? current.x : current.y;
+      double       value=edge==1 ? width : (edge==3 ? height : 0.0);
+      bool         prevInside=edge%2==0 ? prevValue>=value : prevValue<=value;
+      bool         currentInside=edge%2==0 ? currentValue>=value : currentValue<=value;
+
+      if (prevInside!=currentInside) {
+        double t=(value-prevValue)/(currentValue-prevValue);
+
+        clipped.push_back(Point(prev.x+t*(current.x-prev.x),
+                                prev.y+t*(current.y-prev.y)));
+      }
+
+      if (currentInside) {
+        clipped.push_back(current);
+      }
+    }
+
+    polygon.swap(clipped);
+  }
+
+  double area=0.0;
+
+  for (size_t i=0; i<polygon.size(); i++) {
+    const Point& a=polygon[i];
+    const Point& b=polygon[(i+1)%polygon.size()];
+
+    area+=a.x*b.y-b.x*a.y;
+  }
+
+  return fabs(area)/2;
+}
+
+#if defined(OSMSCOUT_COMPACT_COORDS)
+/**
+  Distance in pixel between neighbouring compact coordinates at the center
+  of the projection
+  */
+double GetFixedPointStep(const osmscout::Projection& projection)
+{
+  double step=1.0/osmscout::conversionFactor;
+  double x,y;
+  double lonX,lonY;
+  double latX,latY;
+
+  projection.GeoToPixel(projection.GetLon(),projection.GetLat(),x,y);
+  projection.GeoToPixel(projection.GetLon()+step,projection.GetLat(),lonX,lonY);
+  projection.GeoToPixel(projection.GetLon(),projection.GetLat()+step,latX,latY);
+
+  return fabs(lonX-x)+fabs(latY-y);
+}
+#endif
+
+bool IsInRegion(const std::vector<Point>& points,
+                double width,
+                double height,
+                double margin)
+{
+  for (size_t i=0; i<points.size(); i++) {
+    if (points[i].x<-margin-1.0 ||
+        points[i].x>width+margin+1.0 ||
+        points[i].y<-margin-1.0 ||
+        points[i].y>height+margin+1.0) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+void Check(const osmscout::Projection& projection,
+           const std::vector<osmscout::GeoCoord>& nodes,
+           bool isArea)
+{
+  double                 margin=10.0;
+  double                 width=projection.GetWidth();
+  double                 height=projection.GetHeight();
+  osmscout::TransPolygon polygon;
+  osmscout::TransPolygon clippedPolygon;
+
+  clippedPolygon.SetClipRegion(projection,
+                               margin);
+
+  if (isArea) {
+    polygon.TransformArea(projection,osmscout::TransPolygon::none,nodes,1.0);
+    clippedPolygon.TransformArea(projection,osmscout::TransPolygon::none,nodes,1.0);
+  }
+  else {
+    polygon.TransformWay(projection,osmscout::TransPolygon::none,nodes,1.0);
+    clippedPolygon.TransformWay(projection,osmscout::TransPolygon::none,nodes,1.0);
+  }
+
+  std::vector<Point> points=GetPoints(polygon);
+  std::vector<Point> clippedPoints=GetPoints(clippedPolygon);
+  double             expected;
+  double             actual;
+
+  if (isArea) {
+    expected=GetVisibleArea(points,width,height);
+    actual=GetVisibleArea(clippedPoints,width,height);
+  }
+  else {
+    expected=GetVisibleLength(points,width,height);
+    actual=GetVisibleLength(clippedPoints,width,height);
+  }
+
+  double tolerance=0.001*expected+1.0;
+
+#if defined(OSMSCOUT_COMPACT_COORDS)
+  // Intersections with the clip region are rounded to compact coordinates,
+  // which moves the clipped edges within the visible region
+  if (isArea) {
+    tolerance+=clippedPoints.size()*GetFixedPointStep(projection)*(width+height);
+  }
+  else {
+    tolerance+=clippedPoints.size()*GetFixedPointStep(projection);
+  }
+#endif
+
+  if (fabs(expected-actual)>tolerance) {
+    std::cerr << (isArea ? "Area" : "Way") << " with " << nodes.size() << " nodes: expected visible " << expected << " actual " << actual << std::endl;
+    errors++;
+  }
+
+  // Ways may keep invisible nodes between two visible parts, but must start
+  // and end in the clip region
+  if (!isArea &&
+      clippedPoints.size()>2) {
+    clippedPoints.erase(clippedPoints.begin()+1,clippedPoints.end()-1);
+  }
+
+  if (!IsInRegion(clippedPoints,width,height,margin)) {
+    std::cerr << (isArea ? "Area" : "Way") << " with " << nodes.size() << " nodes is not clipped" << std::endl;
+    errors++;
+  }
+}
+
+void CheckProjection(const osmscout::Projection& projection)
+{
+  double spreads[]={0.01,0.1,1.0};
+
+  for (size_t s=0; s<3; s++) {
+    for (size_t count=2; count<=50; count++) {
+      for (size_t i=0; i<20; i++) {
+        std::vector<osmscout::GeoCoord> nodes=CreateCoords(projection.GetLat(),
+                                                           projection.GetLon(),
+                                                           spreads[s],
+                                                           count);
+
+        Check(projection,nodes,false);
+
+        if (count>=3) {
+          Check(projection,nodes,true);
+        }
+      }
+    }
+  }
+
+  // An area covering the complete visible region
+  std::vector<osmscout::GeoCoord> nodes;
+
+  nodes.push_back(osmscout::GeoCoord(projection.GetLat()-1.0,projection.GetLon()-1.0));
+  nodes.push_back(osmscout::GeoCoord(projection.GetLat()-1.0,projection.GetLon()+1.0));
+  nodes.push_back(osmscout::GeoCoord(projection.GetLat()+1.0,projection.GetLon()+1.0));
+  nodes.push_back(osmscout::GeoCoord(projection.GetLat()+1.0,projection.GetLon()-1.0));
+
+  Check(projection,nodes,true);
+}
+
+int main()
+{
+  osmscout::MercatorProjection              projection;
+  osmscout::ReversedYAxisMercatorProjection reversedProjection;
+  osmscout::Magnification                   magnification;
+  double                                    lat=51.57;
+  double                                    lon=7.46;
+
+  magnification.SetLevel(14);
+
+  projection.Set(lon,lat,magnification,800,600);
+  reversedProjection.Set(lon,lat,magnification,800,600);
+
+  CheckProjection(projection);
+  CheckProjection(reversedProjection);
+
+  if (errors!=0) {
+    return 1;
+  }
+  else {
+    return 0;
+  }
+}